@@ -68,6 +68,7 @@ MACRO(NL_SETUP_DEFAULT_OPTIONS)
   OPTION(WITH_DRIVER_FMOD         "Build FMOD Driver (Sound)"                     OFF)
   OPTION(WITH_DRIVER_DSOUND       "Build DirectSound Driver (Sound)"              OFF)
   OPTION(WITH_DRIVER_XAUDIO2      "Build XAudio2 Driver (Sound)"                  OFF)
+  OPTION(WITH_DRIVER_SOFTWARE     "Build Software Driver (Sound)"                 ON )
 
   ###
   # Optional support
@@ -157,6 +157,13 @@ public:
 	  */
 	void	applyTrackQuatHeaderCompression();
 
+	/** For CTrackSampledQuat compressed by applyTrackQuatHeaderCompression() only, get the track sample pack
+	  *	and the id of a track in it, to eval several tracks at once with CTrackSamplePack::evalTracks().
+	  *	\return CAnimation::NotFound if the track is not in the track sample pack, or if it has no key
+	  */
+	uint	getTrackSamplePackId(uint trackId) const;
+	class CTrackSamplePack	*getTrackSamplePack() const {return _TrackSamplePack;}
+
 	/** Used by CAnimationSet to lower the memory Size. After this, you can
 	  *	(and should for better performances) use getIdTrackByChannelId()
 	  *	Does not support more than 65536 channels (nlassert)
@@ -195,6 +202,8 @@ private:
 
 	/// CTrackSampledQuat header compression
 	class CTrackSamplePack			*_TrackSamplePack;
+	// Id of each track in _TrackSamplePack, NotFound if not in. EMPTY if _TrackSamplePack is NULL
+	std::vector<uint32>				_TrackSamplePackIds;
 
 	// Sorted array of ChannelId. Same size as _TrackVector. EMPTY if applyAnimHeaderCompression() NOT called
 	std::vector<uint16>	_IdByChannelId;
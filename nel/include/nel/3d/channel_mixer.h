@@ -27,6 +27,7 @@
 #include "nel/misc/types_nl.h"
 #include "nel/misc/debug.h"
 #include "nel/misc/smart_ptr.h"
+#include "nel/misc/quat.h"
 #include "nel/3d/animation_time.h"
 #include "nel/3d/animation_set.h"
 #include <map>
@@ -193,6 +194,12 @@ private:
 		  */
 		const ITrack*		_Tracks[NumAnimationSlot];
 
+		/**
+		  * For each slot, the id of the track in the CTrackSamplePack of the animation, to eval it
+		  * with the other packed tracks of the slot. CAnimation::NotFound if the track is not packed.
+		  */
+		uint32				_TrackSamplePackIds[NumAnimationSlot];
+
 		/**
 		  * A weight array for to blend each slot.
 		  * This value must be between 0.f and 1.f. If it is 0.f, the slot is not used. If it is 1.f,
@@ -468,8 +475,21 @@ private:
 	  * \param chan			  the channel to eval
 	  * \param numActiveSlots number of active slots
 	  * \param activeSlot array of contiguous slots ids (there are 'numActiveSlots' of them)
+	  * \param packedValues for each slot, the next value evaluated by evalPackedTracks(), or NULL.
+	  */
+	void evalSingleChannel (CChannel &chan, uint numActiveSlots, uint activeSlot[NumAnimationSlot], const NLMISC::CQuat *packedValues[NumAnimationSlot]);
+
+	/**
+	  * Eval at once the packed tracks (see CTrackSamplePack) of a slot, for the channels of a list
+	  * whose weight is not 0. Return NULL if the animation of the slot has no packed track.
+	  *
+	  * \param slot the slot to eval.
+	  * \param channels the channels.
+	  * \param numChannels the number of channels.
+	  * \param blendWithSlot true to test the channel weight multiplied by the slot weight, like evalSingleChannel().
+	  * \return the values of the packed tracks, in the order of the channels.
 	  */
-	void evalSingleChannel (CChannel &chan, uint numActiveSlots, uint activeSlot[NumAnimationSlot]);
+	const NLMISC::CQuat	*evalPackedTracks (uint slot, CChannel **channels, uint numChannels, bool blendWithSlot);
 };
 
 
@@ -30,6 +30,9 @@
 #include "nel/misc/vector.h"
 #include "nel/misc/plane.h"
 #include "nel/misc/matrix.h"
+#include "nel/misc/bsphere.h"
+#include "nel/misc/mutex.h"
+#include "nel/misc/worker_pool.h"
 
 
 namespace	NL3D
@@ -134,6 +137,34 @@ public:
 	//@}
 
 
+	/// \name Sphere batch clip. Used by CQuadGridClipManager.
+	//@{
+	/// A packed array of world spheres, and where to store their clip result.
+	struct CSphereClipBatch
+	{
+		const NLMISC::CBSphere	*Spheres;
+		uint8					*Visible;
+		uint					NumSpheres;
+	};
+
+	/** Clip the spheres of all the batches against WorldPyramid : Visible[i] is set to 0 if Spheres[i] is fully
+	 *	out of one plane (the test done first by the mesh clip()), else to 1.
+	 *	The work is shared with the clip worker threads if any, and if there is enough spheres.
+	 */
+	void				clipSphereBatches(const std::vector<CSphereClipBatch> &batches);
+
+	/** Share the sphere batch clip between numThreads threads of the NLMISC::CWorkerPool and the calling thread.
+	 *	0 disables it (the default).
+	 *	Results are the same, and the models are still traversed in the same order, in the calling thread.
+	 */
+	void				enableParallelClip(uint numThreads);
+	uint				getParallelClipThreads() const {return (uint)_ClipJobs.size();}
+
+	/// Clip numSpheres spheres against numPlanes planes. see clipSphereBatches(). Use SSE2 if available.
+	static void			clipSpheres(const CPlane *planes, uint numPlanes, const NLMISC::CBSphere *spheres, uint numSpheres, uint8 *visible);
+	//@}
+
+
 public:
 
 	/** \name FOR MODEL TRAVERSAL ONLY.  (Read only)
@@ -153,6 +184,10 @@ public:
 	CCamera				*Camera;
 
 	CQuadGrid<CCluster*> Accel;
+	/** Incremented each time a cluster is registered, unregistered (ie moved or deleted) or linked to a new father.
+	 *	Used by the users of the cluster graph to know when their cached data must be computed again.
+	 */
+	uint32				ClusterSystemDate;
 
 	/** for CQuadGridClipClusterClip only. This flag means models traversed do not need to clip,
 	 *	they are sure to be visible.
@@ -183,6 +218,17 @@ private:
 
 	void	loadBalanceSkeletonCLod();
 
+	// Sphere batch clip
+	class CClipJob;
+	std::vector<CSphereClipBatch>	_ClipChunks;
+	std::vector<CClipJob*>			_ClipJobs;			// one per thread of the pool
+	NLMISC::CWorkerJobGroup			_ClipGroup;
+	NLMISC::CFastMutex				_ClipMutex;			// protect the 2 fields below
+	uint							_NumChunksToClip;	// number of chunks published to the jobs
+	uint							_NextChunkToClip;
+	// Clip chunks until there are none left to claim. Called by the calling thread and the jobs.
+	void	clipChunks();
+
 	// clip the shadow casters to know if they still need some process
 	void	clipShadowCasters();
 };
@@ -39,6 +39,7 @@
 #include "nel/3d/texture_near.h"
 #include "nel/3d/quad_grid.h"
 #include "nel/misc/block_memory.h"
+#include "nel/misc/worker_pool.h"
 #include "nel/3d/landscapevb_allocator.h"
 #include "nel/3d/landscape_face_vector_manager.h"
 #include "nel/3d/tess_face_priority_list.h"
@@ -260,6 +261,33 @@ public:
 	// @}
 
 
+	/// \name Asynchronous refine.
+	// @{
+	/** Enable/Disable the asynchronous refine mode. Default is false.
+	 *	When enabled, the refine of the next frame (priority lists, split/merge and vertices generation) is computed
+	 *	in a worker thread, from the refineCenter given to startAsyncRefine(), while the rest of the frame is processed.
+	 *	refine() then only commits this result: the tesselation has at most one frame of latency on the refineCenter.
+	 *	Any method which reads or modifies the tesselation waits for the worker first (see waitAsyncRefine()).
+	 *	NB: the worker may load tiles and call the tile callbacks: flush the tiles before (see flushTiles()),
+	 *	and ULandscapeTileCallback implementations must not rely on being called from the main thread.
+	 *	NB: in this mode, the landscape VertexBuffers are allocated in RAM, so they can be filled while the GPU renders.
+	 *	NB: the refine uses the CLandscapeGlobals, shared by all the landscapes: only one landscape can be in this mode
+	 *	(enableAsyncRefine(true) fails with a warning else), and the other landscapes wait for its refine before
+	 *	setting up the globals.
+	 */
+	void			enableAsyncRefine(bool enable);
+	bool			isAsyncRefineEnabled() const {return _AsyncRefineEnabled;}
+	/** Start the refine of the next frame in the worker thread. nop if AsyncRefine is disabled, or if !RefineMode.
+	 *	Buffers are locked here, and unlocked by waitAsyncRefine(). Called by CLandscapeModel after render().
+	 */
+	void			startAsyncRefine(const CVector &refineCenter);
+	/// Wait for the worker refine to complete (if any), and commit it. Must be called from the main thread.
+	void			waitAsyncRefine();
+	/// Wait for the refine of the landscape in async refine mode, if any, before using the CLandscapeGlobals.
+	static void		waitAsyncRefineGlobals();
+	// @}
+
+
 	/// \name Collision methods.
 	// @{
 	/** Build the set of faces of landscape, which are IN a bbox. Useful for collisions.
@@ -706,6 +734,10 @@ private:
 
 	// Update globals value to CTessFace, and lock Buffers if possible.
 	void updateGlobalsAndLockBuffers (const CVector &refineCenter);
+	// Refine part of refine(): update priority lists and split/merge faces. Buffers must be locked. Run by the async worker.
+	void refineTesselation(const CVector &refineCenter);
+	// Vegetable part of refine(): test vegetable IG creation. Buffers must be locked. Always run in main thread.
+	void refineVegetables(const CVector &refineCenter);
 	// update TheFaceVector for which the faces may have been modified during refine(), refineAll() etc....
 	void updateTessBlocksFaceVector();
 
@@ -922,6 +954,24 @@ private:
 	// @}
 
 
+	/// \name Asynchronous refine.
+	// @{
+	class CAsyncRefineJob;
+	friend class CAsyncRefineJob;
+	/// The refine job, run by the CWorkerPool. NULL if AsyncRefine is disabled.
+	CAsyncRefineJob				*_AsyncRefineJob;
+	NLMISC::CWorkerJobGroup		_AsyncRefineGroup;
+	bool						_AsyncRefineEnabled;
+	/// The landscape in AsyncRefine mode, which uses the CLandscapeGlobals in the worker. NULL if none.
+	static CLandscape			*_AsyncRefineLandscape;
+	/// true between startAsyncRefine() and waitAsyncRefine().
+	bool						_AsyncRefineRunning;
+	/// true if a refine has been commited by waitAsyncRefine() since the last refine().
+	bool						_AsyncRefineDone;
+	CVector						_AsyncRefineCenter;
+	// @}
+
+
 	/// Micro-Vegetation.
 	// @{
 	/// The VegetableManager. (ptr only for include speed).
@@ -133,6 +133,8 @@ public:
 	virtual	uint 	getTileMaxSubdivision ();
 	/// Set all zones monochromatic or colored
 	virtual	void 	setTileColor (bool monochrome, float factor) { _ZoneManager.setZoneTileColor(monochrome, factor); }
+	virtual	void	enableAsyncRefine(bool enable);
+	virtual	bool	isAsyncRefineEnabled() const;
 	// @}
 
 
@@ -81,6 +81,12 @@ public:
 	// delete all VB, and free driver ressources (if RefPtr driver not deleted). clear list too.
 	void			clear();
 
+	/** Set the memory where the VB is allocated. Default is AGPPreferred.
+	 *	Use RAMPreferred if the buffer must be locked while the GPU may still render it (async refine).
+	 *	If changed, the VB is reallocated (see reallocationOccurs()).
+	 */
+	void			setPreferredMemory(CVertexBuffer::TPreferredMemory preferredMemory);
+
 
 	/// \name Allocation.
 	// @{
@@ -147,6 +153,7 @@ private:
 	// tell if VBHard is possible. NB: for ATI, it is false because of slow unlock.
 	CVertexBuffer						_VB;
 	bool								_BufferLocked;
+	CVertexBuffer::TPreferredMemory		_PreferredMemory;
 
 	/* try to create a vertexBufferHard or a vbSoft if not possible.
 		After this call, the vertexBufferHard may be NULL.
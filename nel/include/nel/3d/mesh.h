@@ -260,6 +260,9 @@ public:
 	/// clip this mesh in a driver.
 	virtual bool	clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix) ;
 
+	/// see IShape::getClipSphere()
+	virtual bool	getClipSphere(NLMISC::CBSphere &localSphere) const;
+
 	/// render() this mesh in a driver.
 	virtual void	render(IDriver *drv, CTransformShape *trans, bool opaquePass);
 
@@ -367,6 +370,9 @@ public:
 	/// clip this mesh
 	virtual bool	clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix) ;
 
+	/// the sphere of the bounding box, see IShape::getClipSphere()
+	virtual bool	getClipSphere(NLMISC::CBSphere &localSphere) const;
+
 	/// render() this mesh in a driver.
 	virtual void	render(IDriver *drv, CTransformShape *trans, float polygonCount, uint32 rdrFlags, float globalAlpha);
 
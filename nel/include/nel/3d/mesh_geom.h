@@ -34,6 +34,7 @@
 namespace NLMISC
 {
 	class CAABBoxExt;
+	class CBSphere;
 }
 
 namespace NL3D
@@ -107,6 +108,9 @@ public:
 	 */
 	virtual bool	clip(const std::vector<CPlane>	&/* pyramid */, const CMatrix &/* worldMatrix */) {return true;}
 
+	/// see IShape::getClipSphere(). Default is to return false.
+	virtual bool	getClipSphere(NLMISC::CBSphere &/* localSphere */) const {return false;}
+
 	/** render() this meshGeom in a driver, with the specified TransformShape instance information.
 	 *	NB: the meshGeom is ensured to not be skinned to a skeleton, but CMeshGeom may still have skin information.
 	 */
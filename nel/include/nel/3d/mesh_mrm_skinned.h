@@ -121,6 +121,9 @@ public:
 	/// clip this mesh in a driver. true if visible.
 	virtual bool	clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix) ;
 
+	/// the sphere of the bounding box, see IShape::getClipSphere()
+	virtual bool	getClipSphere(NLMISC::CBSphere &localSphere) const;
+
 	/// render() this mesh in a driver, given an instance and his materials.
 	virtual void	render(IDriver *drv, CTransformShape *trans, float polygonCount, uint32 rdrFlags, float globalAlpha);
 
@@ -687,6 +690,9 @@ public:
 	/// clip this mesh in a driver.
 	virtual bool	clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix) ;
 
+	/// see IShape::getClipSphere()
+	virtual bool	getClipSphere(NLMISC::CBSphere &localSphere) const;
+
 	/// render() this mesh in a driver.
 	virtual void	render(IDriver *drv, CTransformShape *trans, bool passOpaque);
 
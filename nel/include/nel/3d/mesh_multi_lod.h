@@ -123,6 +123,9 @@ public:
 	/// clip this mesh in a driver.
 	virtual bool	clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix) ;
 
+	/// see IShape::getClipSphere()
+	virtual bool	getClipSphere(NLMISC::CBSphere &localSphere) const;
+
 	/// render() this mesh in a driver.
 	virtual void	render(IDriver *drv, CTransformShape *trans, bool passOpaque);
 
@@ -458,6 +458,19 @@ public:
 
 	//*****************************************************************************************************
 
+	///\name Concurrent animation
+	// @{
+		/** Returns 'true' if the Anim step of this system doesn't touch anything but the system itself, so that it can be
+		  * stepped in a worker thread concurrently with other systems (see CParticleSystemManager::enableParallelAnimate()).
+		  * This is not the case for shared systems, systems using global user params, and systems containing sounds, lights or meshs
+		  * (those create objects in the scene or in the sound server).
+		  * The test of the bindables is done again only when they have changed (see bindablesChanged()).
+		  */
+		bool canStepConcurrently() const;
+	// @}
+
+	//*****************************************************************************************************
+
 	///\name Integration parameters
 	// @{
 		/** This enable for more accurate integrations of movement. When this is activated,
@@ -1213,6 +1226,10 @@ private:
 	bool										_HiddenAtCurrentFrame				 : 1;
 	bool										_HiddenAtPreviousFrame				 : 1;
 
+	// result of the test of the bindables done by canStepConcurrently(), computed again when the bindables have changed
+	mutable bool								_BindablesCanStepConcurrently;
+	mutable bool								_BindablesTouched;
+
 	static bool									_SerialIdentifiers;
 	static bool									_ForceDisplayBBox;
 
@@ -1227,6 +1244,8 @@ public:
 	void		interpolateUserPosDelta(NLMISC::CVector &dest, TAnimationTime deltaT);
 	// For use by emitters only : Get the current emit ratio when auto-LOD is used. Valid only during the 'Emit' pass
 	float		getAutoLODEmitRatio() const { return _AutoLODEmitRatio; }
+	// For private used by CPSLocated instances : should be called when a bindable has been bound to or removed from a located of the system
+	void		bindablesChanged() { _BindablesTouched = true; }
 	// For private used by CPSLocated instances : should be called when the matrix mode of a located has changed
 	void		matrixModeChanged(CParticleSystemProcess *proc, TPSMatrixMode oldMode, TPSMatrixMode newMode);
 	// FOR PRIVATE USE : called when one more object of the system needs the _UserCoordSystemInfo field => so allocate it if needed.
@@ -1236,32 +1255,23 @@ public:
 	// tmp for debug : dump hierarchy of fx
 	void		dumpHierarchy();
 public:
-	// spawn info. They are shared by all PS ! This is because there can be only one PS processed at a time in the lib, so no need to store that per instance
+	// spawn info. The spawn lists are per thread (see CPSSimBuffers), because only one PS can be processed at a time in a given thread.
 	typedef std::vector<CPSSpawnInfo> TSpawnInfoVect;
 	struct CSpawnVect : public NLMISC::CRefCount
 	{
 		TSpawnInfoVect SpawnInfos;
 		uint		   MaxNumSpawns;
 	};
-	static std::vector<NLMISC::CSmartPtr<CSpawnVect> > _Spawns; // for each process of the system (the array is ordered as CParticleSystem::_ProcessVect is) , store a list of particles to spawn. We can't spawn them directly,
-															    // because ageing particle must be processed and removed first to make room
-															    // for new particles and thus avoid a 'pulse' effect when framerate is low or when spawning is fast  (see the update loop CParticleSystem::step for details)
-															    // NB : we use a smart pointer to avoid resize of a vector of vector, which is baaad...
-															    // This is public but intended to be used by CPSLocated only.
-	static std::vector<uint>						   _ParticleToRemove;			// used during the update step, contains the indices of the particles to remove
-	static std::vector<sint>						   _ParticleRemoveListIndex; 	// for each particle, -1 if it hasn't been removed, or else give the insertion number in _ParticleToRemove
-	static std::vector<uint>						   _CollidingParticles; // index of particle that collided
-	static std::vector<NLMISC::CVector>				   _SpawnPos;			// spawn position of newly created particles
 public:
-	// current sim steps infos
-	static TAnimationTime								EllapsedTime;
-	static TAnimationTime								InverseTotalEllapsedTime;
-	static TAnimationTime								RealEllapsedTime;
-	static float										RealEllapsedTimeRatio;
-	static bool											InsideSimLoop;
-	static bool											InsideRemoveLoop;
-	static bool											InsideNewElementsLoop;
-	static CParticleSystemModel							*OwnerModel; // owner model for that system
+	// current sim steps infos. They have one instance per thread, so that several systems can be stepped concurrently (see CParticleSystemManager::enableParallelAnimate)
+	static NL_THREAD_LOCAL TAnimationTime				EllapsedTime;
+	static NL_THREAD_LOCAL TAnimationTime				InverseTotalEllapsedTime;
+	static NL_THREAD_LOCAL TAnimationTime				RealEllapsedTime;
+	static NL_THREAD_LOCAL float						RealEllapsedTimeRatio;
+	static NL_THREAD_LOCAL bool							InsideSimLoop;
+	static NL_THREAD_LOCAL bool							InsideRemoveLoop;
+	static NL_THREAD_LOCAL bool							InsideNewElementsLoop;
+	static NL_THREAD_LOCAL CParticleSystemModel			*OwnerModel; // owner model for that system
 };
 
 // NOT USED FOR NOW
@@ -26,6 +26,8 @@
 
 #include "nel/misc/types_nl.h"
 #include "nel/misc/plane.h"
+#include "nel/misc/mutex.h"
+#include "nel/misc/worker_pool.h"
 #include "nel/3d/animation_time.h"
 #include "nel/3d/particle_system_process.h"
 
@@ -74,6 +76,24 @@ public:
 	/// perform animation on systems that should be animated even if not parsed (temporary spells for example)
 	void	processAnimate(TAnimationTime deltaT);
 
+	/** Step the systems that are independent from each other concurrently (see CParticleSystem::canStepConcurrently()).
+	  * When enabled, the Anim step of those systems is deferred until flushAnimate(), where it is shared between
+	  * numThreads threads of the NLMISC::CWorkerPool and the calling thread. 0 disables it (the default).
+	  * Nothing is done if the compiler doesn't support thread local storage (see NL_HAS_THREAD_LOCAL).
+	  */
+	void	enableParallelAnimate(uint numThreads);
+
+	/// get the number of worker threads used to step the systems, or 0 if parallel animation is disabled
+	uint	getParallelAnimateThreads() const { return (uint) _AnimateJobs.size(); }
+
+	bool	isParallelAnimateEnabled() const { return !_AnimateJobs.empty(); }
+
+	/** Step all the systems whose animation has been deferred, and wait for them. This is the sync point
+	  * before anything may read the systems (load balancing, lighting, render, sound).
+	  * Called by CScene after the AnimDetail traversal, and by processAnimate().
+	  */
+	void	flushAnimate();
+
 	// stop sound for all particle systems in this manager
 	void    stopSound();
 
@@ -143,6 +163,14 @@ private:
 	/// Remove a permanenlty animated system
 	void			removePermanentlyAnimatedSystem(TAlwaysAnimatedModelHandle &handle);
 
+	/// Should be called by a model that has been setup for animation, and whose step can be done concurrently. \see flushAnimate
+	void			deferAnimate(CParticleSystemModel *model) { _DeferredModels.push_back(model); }
+
+	/// Step deferred models until there are none left to claim. Called by the main thread and the jobs during flushAnimate().
+	void			stepDeferredModels();
+
+	class CAnimateJob;
+
 private:
 
 	TModelList::iterator	_CurrListIterator; /// the current element being processed
@@ -153,6 +181,13 @@ private:
 	static TManagerList     &getManagerList();
 	// link into the global manager list for that manager
 	TManagerList::iterator	_GlobalListHandle;
+	// parallel animation
+	std::vector<CParticleSystemModel *>	_DeferredModels;
+	std::vector<CAnimateJob *>			_AnimateJobs;		// one per thread of the pool
+	NLMISC::CWorkerJobGroup				_AnimateGroup;
+	NLMISC::CFastMutex					_AnimateMutex;		// protect the 2 fields below
+	uint								_NumModelsToStep;	// number of deferred models published to the jobs
+	uint								_NextModelToStep;
 };
 
 
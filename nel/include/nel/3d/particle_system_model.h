@@ -345,8 +345,10 @@ private:
 		}
 	}
 	bool checkDestroyCondition(CParticleSystem *ps);
-	// perform actual animation of the particles
+	// perform actual animation of the particles. The step may be deferred to CParticleSystemManager::flushAnimate()
 	void	doAnimate();
+	// step the particles, once doAnimate() has setup the system
+	void	stepAnimate();
 
 private:
 	CParticleSystemManager::TModelHandle    _ModelHandle; /** a handle to say when the resources
@@ -371,6 +373,7 @@ private:
 	bool									_InClusterAndVisible        : 1;
 	bool                                    _EmitterActive			    : 1;
 	bool									_SoundActive				: 1;
+	bool									_AnimateDeferred			: 1;  /// doAnimate() has been done, but not the step (see CParticleSystemManager::deferAnimate)
 
 	std::vector<IPSModelObserver *>			_Observers;
 	CAnimatedValueBool						_TriggerAnimatedValue;
@@ -1212,7 +1212,7 @@ T  CPSAttribMakerT<T, F>::get(CPSLocated *loc, uint32 index)
 		break;
 		case CPSInputType::attrLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			loc->getLODVect(lodVect, lodOffset, loc->getMatrixMode());
 			float r = fabsf(loc->getPos()[index] * lodVect + lodOffset);
@@ -1226,7 +1226,7 @@ T  CPSAttribMakerT<T, F>::get(CPSLocated *loc, uint32 index)
 		break;
 		case CPSInputType::attrSquareLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			loc->getLODVect(lodVect, lodOffset, loc->getMatrixMode());
 			float r = loc->getPos()[index] * lodVect + lodOffset;
@@ -1241,7 +1241,7 @@ T  CPSAttribMakerT<T, F>::get(CPSLocated *loc, uint32 index)
 		break;
 		case CPSInputType::attrClampedLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			loc->getLODVect(lodVect, lodOffset, loc->getMatrixMode());
 
@@ -1261,7 +1261,7 @@ T  CPSAttribMakerT<T, F>::get(CPSLocated *loc, uint32 index)
 		break;
 		case CPSInputType::attrClampedSquareLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			loc->getLODVect(lodVect, lodOffset, loc->getMatrixMode());
 
@@ -1327,7 +1327,7 @@ T  CPSAttribMakerT<T, F>::get(const CPSEmitterInfo &infos)
 		break;
 		case CPSInputType::attrLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			infos.Loc->getLODVect(lodVect, lodOffset, infos.Loc->getMatrixMode());
 			float r = fabsf(infos.Pos * lodVect + lodOffset);
@@ -1341,7 +1341,7 @@ T  CPSAttribMakerT<T, F>::get(const CPSEmitterInfo &infos)
 		break;
 		case CPSInputType::attrSquareLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			infos.Loc->getLODVect(lodVect, lodOffset, infos.Loc->getMatrixMode());
 			float r = infos.Pos * lodVect + lodOffset;
@@ -1356,7 +1356,7 @@ T  CPSAttribMakerT<T, F>::get(const CPSEmitterInfo &infos)
 		break;
 		case CPSInputType::attrClampedLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			infos.Loc->getLODVect(lodVect, lodOffset, infos.Loc->getMatrixMode());
 			float r = infos.Pos * lodVect + lodOffset;
@@ -1375,7 +1375,7 @@ T  CPSAttribMakerT<T, F>::get(const CPSEmitterInfo &infos)
 		break;
 		case CPSInputType::attrClampedSquareLOD:
 		{
-			static NLMISC::CVector lodVect;
+			NLMISC::CVector lodVect;
 			float lodOffset;
 			infos.Loc->getLODVect(lodVect, lodOffset, infos.Loc->getMatrixMode());
 
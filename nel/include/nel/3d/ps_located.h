@@ -695,9 +695,8 @@ private:
 	// create a new element
 	sint32   newElement(const CPSSpawnInfo &si, bool doEmitOnce, TAnimationTime ellapsedTime);
 public:
-	static CPSCollisionInfo				 *_FirstCollision;
-	// collisions infos, made public to access by collision zones
-	static std::vector<CPSCollisionInfo> _Collisions;
+	// first active collision of the located being processed (one per thread). Collisions infos are in CPSSimBuffers::Collisions
+	static NL_THREAD_LOCAL CPSCollisionInfo	*_FirstCollision;
 };
 
 
@@ -0,0 +1,98 @@
+/** \file ps_sim_buffers.h
+ * Per thread scratch buffers used while stepping a particle system.
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_PS_SIM_BUFFERS_H
+#define NL_PS_SIM_BUFFERS_H
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/vector.h"
+#include "nel/misc/smart_ptr.h"
+#include "nel/3d/particle_system.h"
+#include "nel/3d/ps_located.h"
+
+
+namespace NL3D
+{
+
+
+/**
+ * Scratch buffers used during CParticleSystem::step(). They are only valid for the system being processed.
+ * Only one system can be processed at a time in a given thread, so there is one instance of this struct per thread :
+ * this allows several independent systems to be stepped concurrently (see CParticleSystemManager::enableParallelAnimate()).
+ * The instance of the main thread is created the first time get() is called, and released with the last CParticleSystemManager.
+ * The jobs of the parallel animation bring their own buffers, set with setCurrent() in the thread which runs them.
+ *
+ * \author Nevrax France
+ * \date 2001
+ */
+struct CPSSimBuffers
+{
+	// For each process of the system (the array is ordered as CParticleSystem::_ProcessVect is), store a list of particles to spawn. We can't spawn them directly,
+	// because ageing particle must be processed and removed first to make room
+	// for new particles and thus avoid a 'pulse' effect when framerate is low or when spawning is fast  (see the update loop CParticleSystem::step for details)
+	// NB : we use a smart pointer to avoid resize of a vector of vector, which is baaad...
+	std::vector<NLMISC::CSmartPtr<CParticleSystem::CSpawnVect> >	Spawns;
+	// contains the indices of the particles to remove
+	std::vector<uint>					ParticleToRemove;
+	// for each particle, -1 if it hasn't been removed, or else give the insertion number in ParticleToRemove
+	std::vector<sint>					ParticleRemoveListIndex;
+	// spawn position of newly created particles
+	std::vector<NLMISC::CVector>		SpawnPos;
+	// collisions infos of the located being processed, accessed by collision zones
+	std::vector<CPSCollisionInfo>		Collisions;
+	// emitter positions, interpolated during an emission step
+	std::vector<NLMISC::CVector>		EmitterPositions;
+
+	/// get the buffers of the calling thread
+	static CPSSimBuffers	&get()
+	{
+		if (!_Current) _Current = new CPSSimBuffers;
+		return *_Current;
+	}
+
+	/// use the given buffers in the calling thread, and return the previous ones. Must not be called while a system is being stepped in that thread
+	static CPSSimBuffers	*setCurrent(CPSSimBuffers *buffers)
+	{
+		CPSSimBuffers *previous = _Current;
+		_Current = buffers;
+		return previous;
+	}
+
+	/// delete the buffers of the calling thread. Must not be called while a system is being stepped in that thread
+	static void				release()
+	{
+		delete _Current;
+		_Current = NULL;
+	}
+
+private:
+	static NL_THREAD_LOCAL CPSSimBuffers	*_Current;
+};
+
+
+} // NL3D
+
+
+#endif // NL_PS_SIM_BUFFERS_H
+
+/* End of ps_sim_buffers.h */
@@ -0,0 +1,87 @@
+/** \file ps_simd.h
+ * Vector kernels used by the particle system simulation (integration, forces, zones).
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_PS_SIMD_H
+#define NL_PS_SIMD_H
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/vector.h"
+#include "nel/misc/plane.h"
+
+
+namespace NL3D
+{
+
+
+/**
+ * Batch operations on the attributes of a located (positions, speeds, inverse masses).
+ * Those attributes are contiguous arrays of CVector / float, so they are processed as flat float streams :
+ * 4 vectors (= 3 SSE registers) at a time when NL_HAS_SSE2 is defined, one by one otherwise.
+ * No alignment is required.
+ *
+ * All the kernels do the same float operations, in the same order, than the scalar code they replace,
+ * so the results don't depend on whether SSE2 is used or not.
+ *
+ * \author Nevrax France
+ * \date 2001
+ */
+struct CPSSimd
+{
+	/// dest[k]= src1[k] + dt * src2[k], for numFloats floats. dest may be equal to src1 (but may not overlap it otherwise).
+	static void	integrate(float *dest, const float *src1, const float *src2, uint numFloats, float dt);
+
+	/// dest[k]+= v
+	static void	addVector(NLMISC::CVector *dest, uint count, const NLMISC::CVector &v);
+
+	/// dest[k]+= scale[k] * v
+	static void	addScaledVector(NLMISC::CVector *dest, const float *scale, uint count, const NLMISC::CVector &v);
+
+	/// dest[k]+= (factor * scale[k]) * src[k]. If scale is NULL, dest[k]+= factor * src[k]
+	static void	addScaledVectors(NLMISC::CVector *dest, const NLMISC::CVector *src, const float *scale, uint count, float factor);
+
+	/// spring equation : speed[k]+= (invMass[k] * k) * (center - pos[k])
+	static void	addSpringForce(NLMISC::CVector *speed, const NLMISC::CVector *pos, const float *invMass, uint count,
+							   const NLMISC::CVector &center, float k);
+
+	/** Select the particles that go through a plane, ie (p * before[k] >= -epsilon && p * after[k] <= epsilon).
+	  * Index (relative to before) of the particles selected are written in dest, that must have room for count entries.
+	  * \return the number of particles selected
+	  */
+	static uint	selectPlaneCrossings(const NLMISC::CPlane &p, const NLMISC::CVector *before, const NLMISC::CVector *after,
+									 uint count, float epsilon, uint32 *dest);
+
+	/** Select the particles that enter a sphere, ie ((before[k] - center)^2 > r2 && (after[k] - center)^2 <= r2).
+	  * Index (relative to before) of the particles selected are written in dest, that must have room for count entries.
+	  * \return the number of particles selected
+	  */
+	static uint	selectSphereEntries(const NLMISC::CVector &center, float r2, const NLMISC::CVector *before, const NLMISC::CVector *after,
+									uint count, uint32 *dest);
+};
+
+
+} // NL3D
+
+
+#endif // NL_PS_SIMD_H
+
+/* End of ps_simd.h */
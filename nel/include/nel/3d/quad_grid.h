@@ -37,6 +37,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 namespace NL3D
 {
@@ -53,8 +54,6 @@ using NLMISC::CVector;
 class CQuadGridBase
 {
 protected:
-	static NLMISC::CPolygon2D				_ScaledPoly;		// for polygon selection
-	static NLMISC::CPolygon2D::TRasterVect  _PolyBorders;		// for polygon selection
 	static std::vector<uint>				_AlreadySelected;	// During some selection operations, mark the cells that have already been visited.
 																// may happen if the selection shape can overlap itself due to the grid vrapiing.
 																// A cell is known to be selected if its uint "timestamp" is equal to _SelectStamp.
@@ -79,6 +78,10 @@ protected:
  *
  * For maximum allocation speed Efficiency, it uses a CBlockMemory<CNode> to allocate elements at insert().
  * DefaultBlockSize is 16, but you can change it at construction.
+ * Each cell of the grid is an array of pointers on the elements that intersect it.
+ *
+ * The select() methods that take a result vector are const and don't use the selection list: they can be called
+ * by several threads at the same time, as long as the grid is not modified.
  *
  * \author Lionel Berenguier
  * \author Nevrax France
@@ -216,6 +219,21 @@ public:
 	  */
 	void			select(const TSelectionShape &shape);
 
+	/** Append the elements intersecting a bounding box to result. Each element is appended once.
+	  *	The selection list is not used nor modified.
+	  */
+	void			select(const NLMISC::CVector &bboxmin, const NLMISC::CVector &bboxmax, std::vector<T> &result) const;
+
+	/** Append the elements intersecting a selection shape to result. Each element is appended once.
+	  *	The selection list is not used nor modified.
+	  */
+	void			select(const TSelectionShape &shape, std::vector<T> &result) const;
+
+	/** Append the elements intersecting a ray to result. Each element is appended once.
+	  *	The selection list is not used nor modified.
+	  */
+	void			selectRay(const NLMISC::CVector &rayStart, const NLMISC::CVector &rayEnd, std::vector<T> &result) const;
+
 
 	/** Return the first iterator of the selected element list. begin and end are valid till the next insert.
 	  *	Speed is in O(1)
@@ -235,27 +253,6 @@ public:
 // =================
 // =================
 private:// Classes.
-	class CNode;
-
-	/** A circular list node for the list of node per Quad element.
-	 *	The root node have Node==NULL
-	 */
-	class	CQuadNode
-	{
-	public:
-		CQuadNode	*Prev,*Next;
-		CNode		*Node;
-
-		CQuadNode() : Prev(NULL), Next(NULL), Node(NULL) {}
-
-		// can't call this at ctor since copied in array
-		void	initRoot()
-		{
-			Prev= this;
-			Next= this;
-			Node= NULL;
-		}
-	};
 
 	/** A base node (not circular) for the list of selected or unselected node
 	 */
@@ -267,18 +264,22 @@ private:// Classes.
 		CBaseNode() {Prev= Next= NULL;}
 	};
 
-	/** An element inserted in the quadGrid. T + Link-list variables (CBaseNode and QuadNodes)
+	/** An element inserted in the quadGrid. T + Link-list variables (CBaseNode) + the squares it is in
 	 */
 	class	CNode : public CBaseNode
 	{
 	public:
 		T		Elt;
-		// A node can be contained in L*H squares. This vector is a place holder for each node of each quad list
-		NLMISC::CObjectVector<CQuadNode>	QuadNodes;
+		// The node is in the squares [X0, X0+Width[ * [Y0, Y0+Height[, modulo the grid size.
+		uint16	X0, Y0;
+		uint16	Width, Height;
 	};
 
+	// A square of the grid: the nodes that are in it.
+	typedef	std::vector<CNode*>	TCell;
+
 private:// Atttributes.
-	std::vector<CQuadNode>	_Grid;
+	std::vector<TCell>	_Grid;
 	sint				_Size;
 	sint				_SizePower;
 	float				_EltSize;
@@ -320,7 +321,7 @@ private:// Methods.
 	}
 
 	// return the coordinates on the grid of what include the bbox.
-	void		selectQuads(CVector bmin, CVector bmax, sint &x0, sint &x1, sint &y0, sint &y1)
+	void		selectQuads(CVector bmin, CVector bmax, sint &x0, sint &x1, sint &y0, sint &y1) const
 	{
 		CVector		bminp, bmaxp;
 		bminp= bmin;
@@ -380,19 +381,42 @@ private:// Methods.
 		}
 	}
 
-	// Try to add each node of the quad node list.
-	void		addQuadNodeToSelection(CQuadNode	&quad)
+	// Try to add each node of the square.
+	void		addQuadNodeToSelection(TCell &cell)
+	{
+		for(uint i=0;i<cell.size();i++)
+			addToSelection(cell[i]);
+	}
+
+	// true if the ranges of squares [a, a+la[ and [b, b+lb[ intersect, modulo the grid size.
+	bool		intersectRange(sint a, sint la, sint b, sint lb) const
 	{
-		// NB: the root quadNode does not contains any Node
-		nlassert(quad.Node==NULL);
-		CQuadNode	*qn= quad.Next;
-		// until we roll all the circular list
-		while(qn!=&quad)
+		if(la==0 || lb==0)
+			return false;
+		return ((b-a)&(_Size-1)) < la || ((a-b)&(_Size-1)) < lb;
+	}
+
+	// Append the elements of a list of squares (without duplicates) to result. Each element is appended once.
+	void		appendSquares(const std::vector<uint> &squares, std::vector<T> &result) const
+	{
+		// The nodes in several squares may be seen several times
+		std::vector<CNode*>	multiSquareNodes;
+		for(uint i=0;i<squares.size();i++)
 		{
-			nlassert(qn->Node);
-			addToSelection(qn->Node);
-			qn= qn->Next;
+			const TCell	&cell= _Grid[squares[i]];
+			for(uint j=0;j<cell.size();j++)
+			{
+				CNode	*node= cell[j];
+				if(node->Width==1 && node->Height==1)
+					result.push_back(node->Elt);
+				else
+					multiSquareNodes.push_back(node);
+			}
 		}
+		std::sort(multiSquareNodes.begin(), multiSquareNodes.end());
+		typename std::vector<CNode*>::iterator	last= std::unique(multiSquareNodes.begin(), multiSquareNodes.end());
+		for(typename std::vector<CNode*>::iterator it= multiSquareNodes.begin(); it!=last; ++it)
+			result.push_back((*it)->Elt);
 	}
 
 
@@ -513,20 +537,16 @@ template<class T>	CQuadGrid<T> &CQuadGrid<T>::operator=(const CQuadGrid<T> &o)
 	// copy basis
 	_ChangeBasis= o._ChangeBasis;
 
-	// Fill with copy of elements of other grid. Complex copy...
+	// Fill with copy of elements of other grid. The squares keep the same order.
 	std::map<const CNode*, CNode *>	srcNodeToDestNode;
-	std::map<const CNode*, uint>		srcNodeToIndexInQuadNodes;
-	// NB: the order of nodes in CNode::QuadNodes is not important (may be different from src to dst)
 	for(uint i=0;i<_Grid.size();i++)
 	{
-		const CQuadNode		&quadSrcRoot= o._Grid[i];
-		CQuadNode			&quadDstRoot= _Grid[i];
-		const CQuadNode		*quadSrcCur= quadSrcRoot.Next;
-		// until we roll all the circular list
-		while(quadSrcCur!=&quadSrcRoot)
+		const TCell		&cellSrc= o._Grid[i];
+		TCell			&cellDst= _Grid[i];
+		cellDst.reserve(cellSrc.size());
+		for(uint j=0;j<cellSrc.size();j++)
 		{
-			const CNode	*srcNode= quadSrcCur->Node;
-			nlassert(srcNode);
+			const CNode	*srcNode= cellSrc[j];
 
 			// get the dest node created for this src node
 			CNode	*dstNode= NULL;
@@ -538,10 +558,13 @@ template<class T>	CQuadGrid<T> &CQuadGrid<T>::operator=(const CQuadGrid<T> &o)
 			// else this src node had not already been created
 			else
 			{
-				// create a new node, copy content, and resize place holder
+				// create a new node, copy content
 				dstNode=_NodeBlockMemory.allocate();
 				dstNode->Elt= srcNode->Elt;
-				dstNode->QuadNodes.resize(srcNode->QuadNodes.size());
+				dstNode->X0= srcNode->X0;
+				dstNode->Y0= srcNode->Y0;
+				dstNode->Width= srcNode->Width;
+				dstNode->Height= srcNode->Height;
 
 				// Link to _Unselected list.
 				linkToRoot(_UnSelectedList, dstNode);
@@ -550,27 +573,9 @@ template<class T>	CQuadGrid<T> &CQuadGrid<T>::operator=(const CQuadGrid<T> &o)
 
 				// insert in the map
 				srcNodeToDestNode[srcNode]= dstNode;
-
-				// insert in the map of "index in quad node array"
-				srcNodeToIndexInQuadNodes[srcNode]= 0;
 			}
 
-			// get the quadnode to insert in, and increment index
-			uint	index= srcNodeToIndexInQuadNodes[srcNode]++;
-			nlassert(index<dstNode->QuadNodes.size());
-			CQuadNode	&quadDstCur= dstNode->QuadNodes[index];
-
-			// link
-			quadDstCur.Node= dstNode;
-			// insert in back of list
-			quadDstCur.Next= &quadDstRoot;
-			quadDstCur.Prev= quadDstRoot.Prev;
-			quadDstRoot.Prev->Next= &quadDstCur;
-			quadDstRoot.Prev= &quadDstCur;
-
-
-			// next
-			quadSrcCur= quadSrcCur->Next;
+			cellDst.push_back(dstNode);
 		}
 	}
 
@@ -600,9 +605,6 @@ template<class T>	void		CQuadGrid<T>::create(uint size, float eltSize)
 	_SizePower= NLMISC::getPowerOf2(size);
 	_Size=1<<_SizePower;
 	_Grid.resize(_Size*_Size);
-	// Init QuadNode Root (can't be done in ctor() because of vector<> copy)
-	for(uint i=0;i<_Grid.size();i++)
-		_Grid[i].initRoot();
 
 	nlassert(eltSize>0);
 	_EltSize= eltSize;
@@ -636,16 +638,22 @@ template<class T>	typename CQuadGrid<T>::CIterator	CQuadGrid<T>::erase(typename
 	if(!ptr)
 		return end();
 
-	// First erase from all QuadNode list
+	// First erase from all the squares
 	//==================================
-	for(uint i=0;i<ptr->QuadNodes.size();i++)
+	for(sint y= 0;y<ptr->Height;y++)
 	{
-		CQuadNode	&qn= ptr->QuadNodes[i];
-		// unlink from circular list
-		qn.Next->Prev= qn.Prev;
-		qn.Prev->Next= qn.Next;
+		sint	yg= (ptr->Y0+y) &(_Size-1);
+		for(sint x= 0;x<ptr->Width;x++)
+		{
+			sint	xg= (ptr->X0+x) &(_Size-1);
+			TCell	&cell= _Grid[(yg<<_SizePower)+xg];
+			// the order in a square is not important
+			typename TCell::iterator	itCell= std::find(cell.begin(), cell.end(), ptr);
+			nlassert(itCell!=cell.end());
+			*itCell= cell.back();
+			cell.pop_back();
+		}
 	}
-	ptr->QuadNodes.clear();
 
 
 	// Then delete it..., and update selection linked list.
@@ -691,32 +699,22 @@ template<class T>	typename CQuadGrid<T>::CIterator	CQuadGrid<T>::insert(const NL
 	sint	wn= x1-x0;
 	sint	hn= y1-y0;
 	nlassert(wn>0 && hn>0);
-	// NB: this allocation may be slow (don't use BlockMemory system). But STLPort smallblock alloc
-	// works quite well (if <128 bytes, ie a block of 10 squares)
-	ptr->QuadNodes.resize(wn*hn);
+	ptr->X0= (uint16)x0;
+	ptr->Y0= (uint16)y0;
+	ptr->Width= (uint16)wn;
+	ptr->Height= (uint16)hn;
 
-	// Then for all of them, insert the node in their list.
+	// Then for all of them, insert the node in their square.
 	//=====================================================
 	sint	x,y;
 	for(y= y0;y<y1;y++)
 	{
 		sint	xg,yg;		// x,y in grid (_Grid[])
-		sint	xn,yn;		// x,y in node array (ptr->QuadNodes[])
 		yg= y &(_Size-1);
-		yn= y-y0;
 		for(x= x0;x<x1;x++)
 		{
 			xg= x &(_Size-1);
-			xn= x-x0;
-			CQuadNode	&quadRoot= _Grid[(yg<<_SizePower)+xg];
-			CQuadNode	&quadNew= ptr->QuadNodes[yn*wn+xn];
-			// let point on the node created
-			quadNew.Node= ptr;
-			// insert in back of list
-			quadNew.Next= &quadRoot;
-			quadNew.Prev= quadRoot.Prev;
-			quadRoot.Prev->Next= &quadNew;
-			quadRoot.Prev= &quadNew;
+			_Grid[(yg<<_SizePower)+xg].push_back(ptr);
 		}
 	}
 
@@ -797,8 +795,7 @@ template<class T>	void			CQuadGrid<T>::select(const NLMISC::CVector &bboxmin, co
 		for(x= x0;x<x1;x++)
 		{
 			xe= x &(_Size-1);
-			CQuadNode	&quad= _Grid[(ye<<_SizePower)+xe];
-			addQuadNodeToSelection(quad);
+			addQuadNodeToSelection(_Grid[(ye<<_SizePower)+xe]);
 		}
 	}
 
@@ -810,33 +807,30 @@ template<class T> void	CQuadGrid<T>::buildSelectionShape(TSelectionShape &dest,
 	dest.clear();
 	sint minY;
 	uint numVerts = poly.Vertices.size();
-	_ScaledPoly.Vertices.resize(numVerts);
+	NLMISC::CPolygon2D scaledPoly;
+	NLMISC::CPolygon2D::TRasterVect polyBorders;
+	scaledPoly.Vertices.resize(numVerts);
 	nlassert(_EltSize != 0.f);
 	float invScale = 1.f / _EltSize;
 	for(uint k = 0; k < numVerts; ++k)
 	{
-		CVector xformPos = _ChangeBasis * CVector(poly.Vertices[k]);
-		_ScaledPoly.Vertices[k].set(poly.Vertices[k].x * invScale, poly.Vertices[k].y * invScale);
+		scaledPoly.Vertices[k].set(poly.Vertices[k].x * invScale, poly.Vertices[k].y * invScale);
 	}
-	_ScaledPoly.computeOuterBorders(_PolyBorders, minY);
-	if (_PolyBorders.empty()) return;
-	initSelectStamps();
-	sint numSegs = _PolyBorders.size();
+	scaledPoly.computeOuterBorders(polyBorders, minY);
+	if (polyBorders.empty()) return;
+	sint numSegs = polyBorders.size();
 	for (sint y = 0; y < numSegs; ++y)
 	{
 		sint currIndex = ((minY + y) & (_Size - 1)) << _SizePower;
-		for (sint x = _PolyBorders[y].first; x <= _PolyBorders[y].second; ++x)
+		for (sint x = polyBorders[y].first; x <= polyBorders[y].second; ++x)
 		{
 			sint currX = x & (_Size - 1);
-			uint index = (uint) (currX + currIndex);
-			if (_AlreadySelected[index] != _SelectStamp)
-			{
-				_AlreadySelected[index] = _SelectStamp; // update stamp, so that won't be selected twice if
-												// there's an overlap
-				dest.push_back(index);
-			}
+			dest.push_back((uint) (currX + currIndex));
 		}
 	}
+	// a square may be seen twice if the polygon overlaps itself due to the grid wrapping
+	std::sort(dest.begin(), dest.end());
+	dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
 }
 
 // ***************************************************************************
@@ -875,6 +869,69 @@ void CQuadGrid<T>::selectRay(const NLMISC::CVector &rayStart, const NLMISC::CVec
 	while (NLMISC::CGridTraversal::traverse(localRayStart2f, localRayDir, x, y));
 }
 
+// ***************************************************************************
+template<class T>	void			CQuadGrid<T>::select(const NLMISC::CVector &bboxmin, const NLMISC::CVector &bboxmax, std::vector<T> &result) const
+{
+	CVector		bmin,bmax;
+	bmin= _ChangeBasis*bboxmin;
+	bmax= _ChangeBasis*bboxmax;
+
+	// What are the quads to access?
+	sint	x0,y0;
+	sint	x1,y1;
+	selectQuads(bmin, bmax, x0,x1, y0,y1);
+
+	sint	x,y;
+	for(y= y0;y<y1;y++)
+	{
+		sint	xe,ye;
+		ye= y &(_Size-1);
+		for(x= x0;x<x1;x++)
+		{
+			xe= x &(_Size-1);
+			const TCell	&cell= _Grid[(ye<<_SizePower)+xe];
+			for(uint i=0;i<cell.size();i++)
+			{
+				const CNode	*node= cell[i];
+				// Append the node only in the first selected square it is in:
+				// it must not be in a previous column nor in a previous row of the selection
+				if( intersectRange(x0, x-x0, node->X0, node->Width) || intersectRange(y0, y-y0, node->Y0, node->Height) )
+					continue;
+				result.push_back(node->Elt);
+			}
+		}
+	}
+}
+
+// ***************************************************************************
+template<class T>	void			CQuadGrid<T>::select(const TSelectionShape &shape, std::vector<T> &result) const
+{
+	appendSquares(shape, result);
+}
+
+// ***************************************************************************
+template<class T>	void			CQuadGrid<T>::selectRay(const NLMISC::CVector &rayStart, const NLMISC::CVector &rayEnd, std::vector<T> &result) const
+{
+	CVector localRayStart = _ChangeBasis * rayStart;
+	CVector localRayEnd = _ChangeBasis * rayEnd;
+	float invScale = 1.f / _EltSize;
+	NLMISC::CVector2f localRayStart2f(localRayStart.x * invScale, localRayStart.y * invScale);
+	NLMISC::CVector2f localRayEnd2f(localRayEnd.x * invScale, localRayEnd.y * invScale);
+	NLMISC::CVector2f localRayDir = localRayEnd2f - localRayStart2f;
+	std::vector<uint> squares;
+	sint x, y;
+	NLMISC::CGridTraversal::startTraverse(localRayStart2f, x, y);
+	do
+	{
+		squares.push_back((x & (_Size - 1)) + ((y & (_Size - 1))  << _SizePower));
+	}
+	while (NLMISC::CGridTraversal::traverse(localRayStart2f, localRayDir, x, y));
+	// the ray may cross a square twice because of the grid wrapping
+	std::sort(squares.begin(), squares.end());
+	squares.erase(std::unique(squares.begin(), squares.end()), squares.end());
+	appendSquares(squares, result);
+}
+
 
 // ***************************************************************************
 template<class T>	typename CQuadGrid<T>::CIterator		CQuadGrid<T>::begin()
@@ -27,6 +27,7 @@
 #include "nel/misc/types_nl.h"
 #include "nel/3d/clip_trav.h"
 #include "nel/misc/aabbox.h"
+#include "nel/misc/bsphere.h"
 #include "nel/3d/fast_ptr_list.h"
 
 
@@ -35,6 +36,18 @@ namespace NL3D
 
 
 class	CQuadGridClipCluster;
+class	CQuadGridClipClusterListDist;
+
+
+// ***************************************************************************
+// The sons of a leaf to traverse, recorded during the quadtree clip. See CQuadGridClipManager::traverseClip()
+struct CQuadGridClipJob
+{
+	CQuadGridClipClusterListDist	*List;
+	uint							MinDistSetup;
+	// false if the leaf is fully in the pyramid: the sons are traversed with ForceNoFrustumClip.
+	bool							FrustumClip;
+};
 
 
 // ***************************************************************************
@@ -44,10 +57,24 @@ public:
 	// An entry for each distance setup.
 	std::vector<CFastPtrList<CTransformShape> >		Models;
 
+	/* An entry for each distance setup. The world clip sphere of the models, packed in the same order than Models,
+		for the sphere batch clip. Cleared by insertModel(), and rebuilt by updateClipSpheres() when its size is
+		not the one of Models (models can only be removed from outside, see CFastPtrListNode::unlink()).
+	*/
+	std::vector<std::vector<NLMISC::CBSphere> >		ClipSpheres;
+	// Result of the sphere batch clip. see CClipTrav::clipSphereBatches()
+	std::vector<std::vector<uint8> >				ClipVisible;
+
 public:
 	// If 0 clipSons of all dist Setup, esle start from minDistSetup
 	void		clipSons(uint minDistSetup);
 
+	// Same as clipSons(), but the models whose ClipVisible is 0 are not clipped (see CTransform::traverseClipCulled())
+	void		clipSonsCulled(uint minDistSetup);
+
+	// rebuild ClipSpheres[distSetup] if Models[distSetup] has changed, and resize ClipVisible[distSetup]
+	void		updateClipSpheres(uint distSetup);
+
 	// insert a model in this listDist at the good place
 	void		insertModel(uint distSetup, CTransformShape *model);
 
@@ -89,11 +116,11 @@ public:
 	// init me and sons
 	void		init(CQuadGridClipCluster *owner, uint level, bool rootNode, const NLMISC::CAABBox &pivot);
 
-	// clip the cluster or his sons
-	void		clip(CClipTrav *clipTrav);
+	// clip the cluster or his sons. The leaves to traverse are appended to jobs.
+	void		clip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs);
 
 	// No cluster clip
-	void		noFrustumClip(CClipTrav *clipTrav);
+	void		noFrustumClip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs);
 
 	// insert a model in this listDist at the good place
 	void		insertModel(const NLMISC::CAABBox &worldBBox, uint distSetup, CTransformShape *model);
@@ -129,7 +156,8 @@ public:
 	// NB: the BBox is not recomputed.
 	void		removeModel(CTransformShape *model);
 
-	void		clip(CClipTrav *clipTrav);
+	// The leaves to traverse are appended to jobs.
+	void		clip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs);
 
 	// NB it is possible that profileNumChildren()==0 and isEmpty()==false!!
 	bool					isEmpty() const {return _Root.Empty;}
@@ -120,6 +120,10 @@ private:
 	typedef CFastPtrList<CQuadGridClipCluster>	TClusterList;
 	TClusterList					_NotEmptyQuadGridClipClusters;
 
+	// traverseClip() temporaries
+	std::vector<CQuadGridClipJob>				_ClipJobs;
+	std::vector<CClipTrav::CSphereClipBatch>	_ClipBatches;
+
 
 	void				deleteCaseModels(CClipTrav *pClipTrav, sint x, sint y);
 	void				newCaseModels(CQuadGridClipCluster	*&clusterCase, const NLMISC::CAABBox &pivotBbox);
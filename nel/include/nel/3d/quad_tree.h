@@ -31,6 +31,7 @@
 #include "nel/misc/matrix.h"
 #include <list>
 #include <vector>
+#include <algorithm>
 
 
 namespace	NL3D
@@ -52,6 +53,9 @@ namespace	NL3D
   * which is out this zone is inserted, then it will ALWAYS be considered selected in select*() methods.
   * By default, the quad tree is aligned on XZ.
   *
+  * The select() methods that take a result vector are const and don't use the selection list: they can be called
+  * by several threads at the same time, as long as the quad tree is not modified.
+  *
   * Sample code using CQuadTree:
   * \code
   * // My quad tree
@@ -202,6 +206,16 @@ public:
 	  */
 	void		selectSegment(const NLMISC::CVector& source, const NLMISC::CVector& dest);
 
+	/** Append the elements intersecting a bounding box to result. Each element is appended once.
+	  *	The selection list is not used nor modified.
+	  */
+	void		select(const NLMISC::CVector &bboxmin, const NLMISC::CVector &bboxmax, std::vector<T> &result) const;
+
+	/** Append the elements intersecting a convex polytope made of planes to result. Each element is appended once.
+	  *	The selection list is not used nor modified.
+	  */
+	void		select(const std::vector<NLMISC::CPlane> &BVolume, std::vector<T> &result) const;
+
 	/** Return the first iterator of the selected element list. begin and end are valid till the next insert.
 	  */
 	CIterator	begin();
@@ -312,7 +326,7 @@ private:// Classes.
 			BBoxNeverRescale=true;
 		}
 		// ============================================================================================
-		bool	isLeaf()
+		bool	isLeaf() const
 		{
 			return Sons[0]==NULL;
 		}
@@ -388,7 +402,7 @@ private:// Classes.
 			return true;
 		}
 		// ============================================================================================
-		bool	intersectBox(const NLMISC::CVector &boxmin, const NLMISC::CVector &boxmax)
+		bool	intersectBox(const NLMISC::CVector &boxmin, const NLMISC::CVector &boxmax) const
 		{
 			// inequality and equality is very important, to ensure that a element box will not fit in too many quad boxes.
 			if(boxmin.x > BBoxMax.x)	return false;
@@ -400,7 +414,7 @@ private:// Classes.
 			return true;
 		}
 		// ============================================================================================
-		bool	intersectBox(std::vector<NLMISC::CPlane> &BVolume)
+		bool	intersectBox(const std::vector<NLMISC::CPlane> &BVolume) const
 		{
 			const	NLMISC::CVector	&b1=BBoxMin;
 			const	NLMISC::CVector	&b2=BBoxMax;
@@ -562,6 +576,56 @@ private:// Classes.
 				Sons[3]->select(selroot, BVolume);
 			}
 		}
+
+		// ============================================================================================
+		// Reentrant selection.
+		// The nodes in several quads are appended to multiQuadNodes, and must be made unique by the caller.
+		void	selectLocalNodes(std::vector<T> &result, std::vector<CNode*> &multiQuadNodes) const
+		{
+			CBaseNode	*p= RootNode.QuadNexts[ListIndex];
+			while(p)
+			{
+				uint	numQuads= 0;
+				for(uint i=0;i<4;i++)
+				{
+					if(p->QuadPrevs[i])
+						numQuads++;
+				}
+				if(numQuads==1)
+					result.push_back(static_cast<CNode*>(p)->Value);
+				else
+					multiQuadNodes.push_back(static_cast<CNode*>(p));
+				p=p->QuadNexts[ListIndex];
+			}
+		}
+		// ============================================================================================
+		void	select(std::vector<T> &result, std::vector<CNode*> &multiQuadNodes, const NLMISC::CVector &bboxmin, const NLMISC::CVector &bboxmax) const
+		{
+			if(!intersectBox(bboxmin, bboxmax))
+				return;
+			selectLocalNodes(result, multiQuadNodes);
+			if(!isLeaf())
+			{
+				Sons[0]->select(result, multiQuadNodes, bboxmin, bboxmax);
+				Sons[1]->select(result, multiQuadNodes, bboxmin, bboxmax);
+				Sons[2]->select(result, multiQuadNodes, bboxmin, bboxmax);
+				Sons[3]->select(result, multiQuadNodes, bboxmin, bboxmax);
+			}
+		}
+		// ============================================================================================
+		void	select(std::vector<T> &result, std::vector<CNode*> &multiQuadNodes, const std::vector<NLMISC::CPlane> &BVolume) const
+		{
+			if(!intersectBox(BVolume))
+				return;
+			selectLocalNodes(result, multiQuadNodes);
+			if(!isLeaf())
+			{
+				Sons[0]->select(result, multiQuadNodes, BVolume);
+				Sons[1]->select(result, multiQuadNodes, BVolume);
+				Sons[2]->select(result, multiQuadNodes, BVolume);
+				Sons[3]->select(result, multiQuadNodes, BVolume);
+			}
+		}
 	};
 
 
@@ -580,6 +644,8 @@ private:// Attributes.
 
 private:// Methods.
 
+	// Append the nodes in several quads to result, each once.
+	static void	appendMultiQuadNodes(std::vector<CNode*> &multiQuadNodes, std::vector<T> &result);
 
 
 public:
@@ -879,6 +945,41 @@ template<class T>	void		CQuadTree<T>::selectSegment(const NLMISC::CVector& sourc
 	select (BVolume);
 }
 // ============================================================================================
+template<class T>	void		CQuadTree<T>::appendMultiQuadNodes(std::vector<CNode*> &multiQuadNodes, std::vector<T> &result)
+{
+	std::sort(multiQuadNodes.begin(), multiQuadNodes.end());
+	typename std::vector<CNode*>::iterator	last= std::unique(multiQuadNodes.begin(), multiQuadNodes.end());
+	for(typename std::vector<CNode*>::iterator it= multiQuadNodes.begin(); it!=last; ++it)
+		result.push_back((*it)->Value);
+}
+// ============================================================================================
+template<class T>	void		CQuadTree<T>::select(const NLMISC::CVector &bboxmin, const NLMISC::CVector &bboxmax, std::vector<T> &result) const
+{
+	NLMISC::CVector myboxmin2=_ChangeBasis*bboxmin;
+	NLMISC::CVector myboxmax2=_ChangeBasis*bboxmax;
+	NLMISC::CVector bboxminCopy (std::min (myboxmin2.x, myboxmax2.x), std::min (myboxmin2.y, myboxmax2.y), std::min (myboxmin2.z, myboxmax2.z));
+	NLMISC::CVector bboxmaxCopy (std::max (myboxmin2.x, myboxmax2.x), std::max (myboxmin2.y, myboxmax2.y), std::max (myboxmin2.z, myboxmax2.z));
+
+	std::vector<CNode*>	multiQuadNodes;
+	_QuadRoot.select(result, multiQuadNodes, bboxminCopy, bboxmaxCopy);
+	appendMultiQuadNodes(multiQuadNodes, result);
+}
+// ============================================================================================
+template<class T>	void		CQuadTree<T>::select(const std::vector<NLMISC::CPlane> &BVolume, std::vector<T> &result) const
+{
+	std::vector<NLMISC::CPlane> BVolumeCopy;
+	BVolumeCopy.resize (BVolume.size());
+	NLMISC::CMatrix	invBasis= _ChangeBasis.inverted();
+	for (int i=0; i<(int)BVolumeCopy.size(); i++)
+	{
+		BVolumeCopy[i]=BVolume[i]*invBasis;
+	}
+
+	std::vector<CNode*>	multiQuadNodes;
+	_QuadRoot.select(result, multiQuadNodes, BVolumeCopy);
+	appendMultiQuadNodes(multiQuadNodes, result);
+}
+// ============================================================================================
 template<class T>	typename CQuadTree<T>::CIterator	CQuadTree<T>::begin()
 {
 	return (CNode*)(_Selection.Next);
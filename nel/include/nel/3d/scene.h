@@ -497,6 +497,7 @@ public:
 	//@{
 	CHrcTrav			&getHrcTrav() {return HrcTrav;}
 	CClipTrav			&getClipTrav() {return ClipTrav;}
+	const CClipTrav		&getClipTrav() const {return ClipTrav;}
 	CLightTrav			&getLightTrav() {return LightTrav;}
 	CAnimDetailTrav		&getAnimDetailTrav() {return AnimDetailTrav;}
 	CLoadBalancingTrav	&getLoadBalancingTrav() {return LoadBalancingTrav;}
@@ -512,6 +513,7 @@ public:
 
 	/// Get a ref. to the particle system manager. You shouldn't call this (has methods for private processing)
 	CParticleSystemManager &getParticleSystemManager();
+	const CParticleSystemManager &getParticleSystemManager() const { return _ParticleSystemManager; }
 
 
 	/// set the automatic animation set used by this scene. It is stored as a smart pointer
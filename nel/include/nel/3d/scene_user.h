@@ -198,6 +198,10 @@ public:
 
 	virtual void				setMaxSkeletonsInNotCLodForm(uint m);
 	virtual uint				getMaxSkeletonsInNotCLodForm() const;
+	virtual void				enableParallelParticleSystemAnimate(uint numThreads);
+	virtual uint				getParallelParticleSystemAnimateThreads() const;
+	virtual void				enableParallelClip(uint numThreads);
+	virtual uint				getParallelClipThreads() const;
 
 	//@}
 
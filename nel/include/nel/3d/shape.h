@@ -95,6 +95,13 @@ public:
 	 */
 	virtual bool				clip(const std::vector<CPlane>& /* pyramid */, const CMatrix &/* worldMatrix */) {return true;}
 
+	/** get the local sphere that clip() tests first against each plane of the pyramid, once transformed by the worldMatrix
+	 *	(see NLMISC::CBSphere::applyTransform()): if this world sphere is fully out of one plane, clip() must return false.
+	 *	This allows to clip many instances in batch, without calling clip() (see CQuadGridClipManager).
+	 *	Default is to return false, meaning no such sphere.
+	 */
+	virtual bool				getClipSphere(NLMISC::CBSphere &/* localSphere */) const {return false;}
+
 	/** render() this shape in a driver, with the specified TransformShape information.
 	 * CTransfromShape call this method in the render traversal.
 	 * if opaquePass render the opaque materials else render the transparent materials.
@@ -188,6 +188,15 @@ private:
 	uint			_MaskQuadrant;
 	uint			_QuarterQuadrantStart[4];
 	uint			_QuarterQuadrantEnd[4];
+	// QuadrantDirection of each rolling table, stored as separate X/Y arrays (padded to a multiple of 4)
+	// so the dot products against a direction are computed 4 at a time.
+	std::vector<float>	_QuadrantDirX;
+	std::vector<float>	_QuadrantDirY;
+	// Scratch results of computeQuadrantDots().
+	std::vector<float>	_QuadrantDots;
+
+	// dots[i-start]= direction*_RollingTables[i].QuadrantDirection for i in [start, end[. Only XY are used.
+	void			computeQuadrantDots(const NLMISC::CVector &direction, uint start, uint end, float *dots) const;
 
 
 	/// \name The rolling tables
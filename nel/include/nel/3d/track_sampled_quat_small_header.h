@@ -27,6 +27,8 @@
 #include "nel/misc/types_nl.h"
 #include "nel/3d/track_sampled_quat.h"
 
+#include <vector>
+
 
 namespace NL3D
 {
@@ -67,14 +69,86 @@ public:
 
 
 // ***************************************************************************
-/** see CTrackSampledQuatSmallHeader usage
+/** The keys of all the CTrackSampledQuatSmallHeader of an animation, see CTrackSampledQuatSmallHeader usage.
+ *
+ *	The tracks are grouped by header, and the time of a header is cut in blocks of BlockSize frames.
+ *	The keys are stored block by block: the keys of all the tracks of the block 0, then of the block 1...
+ *	Hence, the keys used to eval all the tracks at a given date are close in memory.
+ *	The keys of a track in a block are the keys in the block, plus the last key before the
+ *	block and the first key after it, so that a block is enough to interpolate.
+ *
+ *	evalTracks() evals several tracks at once, without virtual call. It gives the same results
+ *	as CTrackSampledQuatSmallHeader::eval().
  */
 class CTrackSamplePack
 {
 public:
+	/// Number of frames in a time block
+	enum	{BlockSize= 64};
+
+	/// The keys of a track in a block
+	class	CBlockKeys
+	{
+	public:
+		// Index of the first key in Times and Keys
+		uint32		KeyIndex;
+		// Number of keys
+		uint8		NumKeys;
+	};
+
+	/// The tracks of a header
+	class	CHeaderTracks
+	{
+	public:
+		// Index in BlockKeys of the first track of the first block
+		uint32		BlockKeysIndex;
+		uint16		NumTracks;
+		uint16		NumBlocks;
+	};
+
 	NLMISC::CObjectVector<CTrackSampleHeader, false>	TrackHeaders;
+	// Same size as TrackHeaders.
+	NLMISC::CObjectVector<CHeaderTracks, false>			HeaderTracks;
+	// For each header, NumBlocks*NumTracks entries: the tracks of the block 0, then of the block 1...
+	NLMISC::CObjectVector<CBlockKeys, false>			BlockKeys;
 	NLMISC::CObjectVector<uint8, false>					Times;
 	NLMISC::CObjectVector<CQuatPack, false>				Keys;
+
+	/// \name Build. TrackHeaders must be filled first.
+	// @{
+	/** Add a track. Return its index in the tracks of its header.
+	 *	\param times the key times, in frames (see CTrackSampledCommon::CTimeBlock).
+	 */
+	uint	addTrack(uint headerIndex, const uint8 *times, const CQuatPack *keys, uint numKeys);
+	/// Build the blocks from the added tracks
+	void	build();
+	// @}
+
+	/// \name Eval
+	// @{
+	/** Eval several tracks at the same date.
+	 *	\param tracks the tracks to eval, see getTrackId(). They must have at least one key.
+	 *	\param result receives the value of each track.
+	 */
+	void	evalTracks(const TAnimationTime &date, const uint32 *tracks, uint numTracks, CQuat *result);
+
+	/// The id of a track for evalTracks()
+	static uint32	getTrackId(uint headerIndex, uint trackIndex) { return (headerIndex<<16) | trackIndex; }
+	// @}
+
+private:
+	// A track added, until build()
+	class	CBuildTrack
+	{
+	public:
+		uint					HeaderIndex;
+		std::vector<uint8>		Times;
+		std::vector<CQuatPack>	Keys;
+	};
+	std::vector<CBuildTrack>	_BuildTracks;
+
+	// Get the local time and the frame of a header at a date. Same code as CTrackSampledCommon
+	void	evalHeaderTime(const CTrackSampleHeader &trackHeader, const TAnimationTime &date, float &localTime, uint8 &frame);
 };
 
 
@@ -85,14 +159,14 @@ public:
  *	The final size of this class is:
  *		4		(vtable)
  *		4		ptr on CTrackSamplePack
- *		1+1+2	offset in CTrackSamplePack
+ *		1+1+2	index in CTrackSamplePack
  */
 class CTrackSampledQuatSmallHeader : public ITrack
 {
 public:
 
 	/// Constructor
-	CTrackSampledQuatSmallHeader(CTrackSamplePack *pack, uint8 headerIndex, uint8 numKeys, uint16 keyIndex);
+	CTrackSampledQuatSmallHeader(CTrackSamplePack *pack, uint8 headerIndex, uint8 numKeys, uint16 trackIndex);
 	virtual ~CTrackSampledQuatSmallHeader();
 	// not designed to be serialized
 	CTrackSampledQuatSmallHeader() {nlstop;}
@@ -109,6 +183,9 @@ public:
 	// NB: do not support sample division: it must be applied before compression
 	// @}
 
+	/// The id of the track for CTrackSamplePack::evalTracks(). 0xffffffff if the track has no key.
+	uint32							getTrackSamplePackId() const;
+
 protected:
 	// Ptr on global data. only one in CAnimation
 	CTrackSamplePack				*_TrackSamplePack;
@@ -116,12 +193,8 @@ protected:
 	uint8							_IndexTrackHeader;
 	// The Number of Keys of this track
 	uint8							_NumKeys;
-	// The index of starting key in _TrackSamplePack->Times and in _TrackSamplePack->Keys
-	uint16							_KeyIndex;
-
-	// same code than CTrackSampledCommon
-	enum	TEvalType	{EvalDiscard, EvalKey0, EvalInterpolate};
-	TEvalType						evalTime (const TAnimationTime& date, uint &keyId0, uint &keyId1, float &interpValue);
+	// The index of the track in the tracks of its header in _TrackSamplePack
+	uint16							_TrackIndex;
 
 };
 
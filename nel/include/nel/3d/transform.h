@@ -141,6 +141,11 @@ public:
 	 *	- always traverseSons(), to clip the sons.
 	 */
 	virtual void	traverseClip();
+	/** Same result as traverseClip(), but for a model known to be out of the pyramid : clip() is not called.
+	 *	Used by batch clip (see CQuadGridClipManager). Fall back to traverseClip() when clip() would not be called
+	 *	(user clipping, ancestor skeleton), or when the model has clip sons.
+	 */
+	void			traverseClipCulled();
 	/// call updateWorldMatrixFromFather(), then traverseAnimDetailWithoutUpdateWorldMatrix()
 	virtual void	traverseAnimDetail();
 	/// no-op by default
@@ -26,6 +26,7 @@
 
 #include "nel/misc/types_nl.h"
 #include "nel/misc/matrix.h"
+#include "nel/misc/bsphere.h"
 #include "nel/3d/transform.h"
 #include "nel/3d/shape.h"
 #include "nel/3d/load_balancing_trav.h"
@@ -188,6 +189,8 @@ private:
 	// @{
 	// Link to QuadGridCluster
 	CFastPtrListNode		_QuadClusterListNode;
+	// World sphere for the batch clip of the QuadGridCluster. Computed when linked, see CQuadGridClipCluster::addModel()
+	NLMISC::CBSphere		_QuadClusterClipSphere;
 	// @}
 
 	/// \name LoadBalancing Traversal
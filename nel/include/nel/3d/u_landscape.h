@@ -191,6 +191,12 @@ public:
 	virtual	uint 	getTileMaxSubdivision () =0;
 	/// Set all zones monochromatic or colored
 	virtual	void 	setTileColor (bool mono, float factor) =0;
+	/** Enable the asynchronous refine: the tesselation of the next frame is computed in a worker thread,
+	 *	with one frame of latency. Default: false. Tile callbacks may then be called from this thread.
+	 */
+	virtual	void	enableAsyncRefine(bool enable) =0;
+	/// Tells if the asynchronous refine is enabled.
+	virtual	bool	isAsyncRefineEnabled() const =0;
 	// @}
 
 
@@ -338,6 +338,20 @@ public:
 	/// see setMaxSkeletonsInNotCLodForm()
 	virtual uint				getMaxSkeletonsInNotCLodForm() const =0;
 
+	/** Step the particle systems that don't depend on each other on numThreads worker threads, in parallel with
+	 *	the main thread. 0 (the default) steps all the systems in the main thread.
+	 */
+	virtual void				enableParallelParticleSystemAnimate(uint numThreads) =0;
+	/// see enableParallelParticleSystemAnimate()
+	virtual uint				getParallelParticleSystemAnimateThreads() const =0;
+
+	/** Share the batch clip of the frozen models (see UTransform::freezeHRC()) between numThreads worker threads
+	 *	and the main thread. 0 (the default) clips them in the main thread only.
+	 */
+	virtual void				enableParallelClip(uint numThreads) =0;
+	/// see enableParallelClip()
+	virtual uint				getParallelClipThreads() const =0;
+
 	//@}
 
 	/// \name Coarse meshes Mgt.
@@ -0,0 +1,143 @@
+/** \file form_elm_path.h
+ * Georges form element path, compiled against a dfn
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_FORM_ELM_PATH_H
+#define NL_FORM_ELM_PATH_H
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/smart_ptr.h"
+#include "nel/georges/u_form_elm.h"
+#include "nel/georges/u_form_dfn.h"
+
+#include <string>
+#include <vector>
+
+
+namespace NLGEORGES
+{
+
+class CFormDfn;
+class CType;
+class CForm;
+class CFormElm;
+
+/**
+ * A form element name (see UFormElm::getNodeByName(), ie "entities[2].color") compiled against the dfn of a form.
+ * Looking for it in a form of this dfn doesn't parse the name nor look for the dfn entries by name: the struct
+ * elements and the array cells are directly indexed.
+ *
+ * The path is evaluated from the root node of a form, with the same results as getValueByName() and getNodeByName()
+ * on the root node, parent forms and default values included.
+ * The path is evaluated by name if the form doesn't have the dfn it has been compiled for (ie. loaded by
+ * another form loader), or if it goes through a virtual struct, whose dfn depends on the form.
+ *
+ * Like the form loader, a compiled path must be used by one thread only.
+ *
+ * Exemple:
+
+	CFormElmPath	walkSpeed;
+	for (uint i=0; i<forms.size(); i++)
+	{
+		const UFormElm &root = forms[i]->getRootNode ();
+		if (!walkSpeed.isCompiledFor (root))
+			walkSpeed.compile (root, "Basics.MovementSpeeds.WalkSpeed");
+		walkSpeed.getValue (root, speeds[i]);
+	}
+
+ * \author Nevrax France
+ * \date 2002
+ */
+class CFormElmPath
+{
+public:
+	CFormElmPath ();
+	~CFormElmPath ();
+
+	/** Compile a path for the dfn of the root node of a form.
+	  * Return false if the path can't be compiled: it will be evaluated by name.
+	  */
+	bool			compile (const UFormElm &root, const std::string &path);
+
+	/// Return true if compile() has been called for the dfn of this root node
+	bool			isCompiledFor (const UFormElm &root) const;
+
+	/// The path, as given to compile()
+	const std::string	&getPath () const { return _Path; }
+
+	/// Same as root.getNodeByName (result, getPath (), where)
+	bool			getNode (const UFormElm &root, const UFormElm **result, UFormElm::TWhereIsNode *where = NULL) const;
+
+	/// Same as root.getValueByName (result, getPath (), evaluate, where)
+	bool			getValue (const UFormElm &root, std::string &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, sint8 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, uint8 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, sint16 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, uint16 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, sint32 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, uint32 &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, float &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, double &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+	bool			getValue (const UFormElm &root, bool &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+
+	/// Warning, only R, G and B members are filled, not A.
+	bool			getValue (const UFormElm &root, NLMISC::CRGBA &result, UFormElm::TEval evaluate = UFormElm::Eval, UFormElm::TWhereIsValue *where = NULL) const;
+
+private:
+
+	// A step of the path
+	class CStep
+	{
+	public:
+		// Index of the element in the struct, or index of the cell in the array
+		uint32		Index;
+		bool		Array;
+	};
+
+	std::string					_Path;
+	std::vector<CStep>			_Steps;
+
+	// The dfn of the root node the path has been compiled for. NULL if not compiled.
+	NLMISC::CRefPtr<CFormDfn>	_RootDfn;
+	// false if the path must be evaluated by name
+	bool						_Compiled;
+
+	// The dfn entry of the node
+	const CFormDfn				*_ParentDfn;
+	uint						_IndexDfn;
+	const CType					*_NodeType;
+	UFormDfn::TEntryType		_Type;
+
+	// Look for the node in a form and its parents. *node is NULL if the node is not defined.
+	bool			findNode (const CForm *form, const CFormElm **node, bool verbose, uint32 round) const;
+
+	template <class T>
+	bool			getConvertedValue (const UFormElm &root, T &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const;
+};
+
+
+} // NLGEORGES
+
+
+#endif // NL_FORM_ELM_PATH_H
+
+/* End of form_elm_path.h */
@@ -0,0 +1,475 @@
+/** \file indexed_packed_sheets.h
+ * Packed sheets with an index by sheet id, whose sheets are deserialized on first access
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_INDEXED_PACKED_SHEETS_H
+#define NL_INDEXED_PACKED_SHEETS_H
+
+#include "nel/misc/types_nl.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "nel/misc/path.h"
+#include "nel/misc/file.h"
+#include "nel/misc/mem_stream.h"
+#include "nel/misc/mapped_file.h"
+#include "nel/misc/sheet_id.h"
+
+#include "load_form.h"
+
+
+namespace NLGEORGES
+{
+
+
+const uint32		PACKED_SHEET_INDEXED_HEADER = 'PKSI';
+const uint32		PACKED_SHEET_INDEXED_VERSION = 1;
+const uint32		PACKED_SHEET_INDEXED_VERSION_COMPATIBLE = 0;
+
+
+// ***************************************************************************
+/**
+ * The file part of CIndexedPackedSheets : the index of an indexed packed sheet file, and the access to the
+ * serialized sheets.
+ *
+ * File format :
+ *	- the header, the dictionnary and the dependencies, as in a loadForm() packed sheet file
+ *	- the number of sheets and the version of the sheet class
+ *	- the index : for each sheet, sorted by sheet id, the sheet id, the position and the size of the serialized sheet
+ *	- the serialized sheets
+ *
+ * \author Nevrax France
+ * \date 2001
+ */
+class CIndexedPackedSheetsBase
+{
+public:
+	/// An entry of the index
+	struct CEntry
+	{
+		NLMISC::CSheetId	SheetId;
+		// Position of the serialized sheet in the file
+		uint32				Offset;
+		uint32				Size;
+
+		void	serial(NLMISC::IStream &f)
+		{
+			f.serial(SheetId);
+			f.serial(Offset);
+			f.serial(Size);
+		}
+	};
+
+	typedef std::map<NLMISC::CSheetId, std::vector<uint32> >	TDependencies;
+
+public:
+	CIndexedPackedSheetsBase();
+	virtual ~CIndexedPackedSheetsBase();
+
+	/** Open a packed sheet file and read its index. Throw an exception if the file can't be read, or
+	 *	if dataVersion is not the version of the sheets in the file.
+	 *	\param useMMap map the file in memory instead of reading the sheets with a CIFile. Ignored for files in a bnp.
+	 *	\param dictionnary if not NULL, filled with the dictionnary of the dependencies. Else they are skipped.
+	 *	\param dependencies if not NULL, filled with the dependencies of each sheet.
+	 */
+	void			open(const std::string &path, uint32 dataVersion, bool useMMap,
+						 std::vector<std::string> *dictionnary= NULL, TDependencies *dependencies= NULL);
+
+	/// Release all the sheets, and close the file
+	void			close();
+
+	bool			isOpen() const { return _Opened; }
+	bool			isMapped() const { return _MappedFile.isOpen(); }
+	const std::string	&getPath() const { return _Path; }
+
+	/// Number of sheets in the file
+	uint			size() const { return (uint)_Index.size(); }
+	const CEntry	&getEntry(uint index) const { return _Index[index]; }
+	/// Index of a sheet in the file, -1 if not found (binary search)
+	sint			find(const NLMISC::CSheetId &sheetId) const;
+	bool			contains(const NLMISC::CSheetId &sheetId) const { return find(sheetId) >= 0; }
+
+	/// Fill an input stream with the serialized sheet
+	void			readEntry(uint index, NLMISC::CMemStream &dest);
+
+	/** Write a new packed sheet file, then reopen it.
+	 *	\param sheets the sheets of the file, sorted by sheet id.
+	 *	\param isNew for each sheet, true if it must be serialized with serialNewSheet(), false if it is copied
+	 *	from the current file.
+	 */
+	void			rebuild(const std::string &path, uint32 dataVersion, bool useMMap,
+							const std::vector<std::string> &dictionnary, const TDependencies &dependencies,
+							const std::vector<NLMISC::CSheetId> &sheets, const std::vector<bool> &isNew);
+
+protected:
+	/// Called at open(), to setup the sheet cache for the new index
+	virtual void	indexLoaded() =0;
+	/// Called at close(), to release the sheet cache
+	virtual void	releaseSheets() =0;
+	/// Called by rebuild() to write the new sheets
+	virtual void	serialNewSheet(const NLMISC::CSheetId &sheetId, NLMISC::IStream &f) =0;
+
+private:
+	std::string				_Path;
+	bool					_Opened;
+	std::vector<CEntry>		_Index;
+	// Where to read the sheets from : _MappedFile if open, else _File.
+	NLMISC::CIFile			_File;
+	NLMISC::CMappedFile		_MappedFile;
+
+	void			closeFile();
+};
+
+
+// ***************************************************************************
+/**
+ * A container of sheets read from an indexed packed sheet file (see loadFormIndexed()).
+ * Only the index is read at loading. Each sheet is deserialized the first time it is accessed,
+ * and kept until unloadAll() or close().
+ *
+ * T is the same class as for loadForm() : it must have serial(), readGeorges(), removed() and getVersion().
+ *
+ * \author Nevrax France
+ * \date 2001
+ */
+template <class T>
+class CIndexedPackedSheets : public CIndexedPackedSheetsBase
+{
+public:
+	CIndexedPackedSheets() : _NumLoaded(0) {}
+	~CIndexedPackedSheets() { close(); }
+
+	/// Get a sheet, deserialized on first access. NULL if the sheet is not in the packed sheets.
+	T				*get(const NLMISC::CSheetId &sheetId)
+	{
+		sint	index= find(sheetId);
+		if (index < 0)
+			return NULL;
+		return getByIndex(index);
+	}
+
+	/// Get the sheet of an entry of the index, deserialized on first access.
+	T				*getByIndex(uint index)
+	{
+		nlassert(index < _Sheets.size());
+		T	*&sheet= _Sheets[index];
+		if (sheet == NULL)
+		{
+			NLMISC::CMemStream	stream(true);
+			readEntry(index, stream);
+			sheet= new T;
+			sheet->serial(stream);
+			_NumLoaded++;
+		}
+		return sheet;
+	}
+
+	/// true if the sheet has already been deserialized
+	bool			isLoaded(const NLMISC::CSheetId &sheetId) const
+	{
+		sint	index= find(sheetId);
+		return index >= 0 && _Sheets[index] != NULL;
+	}
+
+	/// Number of sheets deserialized
+	uint			getNumLoaded() const { return _NumLoaded; }
+
+	/// Release all the sheets deserialized. They will be deserialized again on next access.
+	void			unloadAll()
+	{
+		for (uint i=0; i<_Sheets.size(); ++i)
+		{
+			delete _Sheets[i];
+			_Sheets[i]= NULL;
+		}
+		_NumLoaded= 0;
+	}
+
+	/// The sheets to write at next rebuild() (see loadFormIndexed()). The container owns them.
+	std::map<NLMISC::CSheetId, T*>	NewSheets;
+
+protected:
+	virtual void	indexLoaded()
+	{
+		unloadAll();
+		_Sheets.resize(size(), NULL);
+	}
+
+	virtual void	releaseSheets()
+	{
+		unloadAll();
+		_Sheets.clear();
+		for (typename std::map<NLMISC::CSheetId, T*>::iterator it= NewSheets.begin(); it != NewSheets.end(); ++it)
+			delete it->second;
+		NewSheets.clear();
+	}
+
+	virtual void	serialNewSheet(const NLMISC::CSheetId &sheetId, NLMISC::IStream &f)
+	{
+		typename std::map<NLMISC::CSheetId, T*>::iterator it= NewSheets.find(sheetId);
+		nlassert(it != NewSheets.end());
+		it->second->serial(f);
+	}
+
+private:
+	// For each entry of the index, the sheet if deserialized, else NULL
+	std::vector<T*>		_Sheets;
+	uint				_NumLoaded;
+};
+
+
+} // NLGEORGES
+
+
+// ***************************************************************************
+/** Same as loadForm(), but for an indexed packed sheet file : only the index of the file is read, and
+ * the sheets are deserialized on first access (see NLGEORGES::CIndexedPackedSheets).
+ * When the packed sheet file must be updated, only the sheets that changed are read with georges,
+ * the others are copied from the old file without being deserialized.
+ *
+ * The file format is not the one of loadForm() : use a different packedFilename (extension must be "packed_sheets").
+ *
+ * \param sheetFilters a vector of string to filter the sheet in the case you need more than one filter
+ * \param packedFilename the name of the file that this function will generate (extension must be "packed_sheets")
+ * \param container the container that will be opened on the file
+ * \param useMMap map the file in memory to read the sheets, instead of using a CIFile
+ */
+template <class T>
+void loadFormIndexed (const std::vector<std::string> &sheetFilters, const std::string &packedFilename, NLGEORGES::CIndexedPackedSheets<T> &container, bool updatePackedSheet=true, bool errorIfPackedSheetNotGood=true, bool useMMap=false)
+{
+	std::vector<std::string>								dictionnary;
+	std::map<std::string, uint>								dictionnaryIndex;
+	NLGEORGES::CIndexedPackedSheetsBase::TDependencies		dependencies;
+	std::vector<uint32>										dependencyDates;
+
+	// check the extension (i know that file like "foo.packed_sheetsbar" will be accepted but this check is enough...)
+	nlassert (packedFilename.find (".packed_sheets") != std::string::npos);
+
+	std::string packedFilenamePath = NLMISC::CPath::lookup(NLMISC::CFile::getFilename(packedFilename), false, false);
+	if (packedFilenamePath.empty())
+	{
+		packedFilenamePath = packedFilename;
+	}
+
+	// make sure the CSheetId singleton has been properly initialised
+	NLMISC::CSheetId::init(updatePackedSheet);
+
+	// open the packed sheet if exists
+	try
+	{
+		nlinfo ("loadFormIndexed(): Opening packed file '%s'", packedFilename.c_str());
+
+		// Read the dependencies only if update packed sheet
+		if (updatePackedSheet)
+			container.open(packedFilenamePath, T::getVersion(), useMMap, &dictionnary, &dependencies);
+		else
+			container.open(packedFilenamePath, T::getVersion(), useMMap);
+	}
+	catch (NLMISC::Exception &e)
+	{
+		container.close ();
+		dictionnary.clear ();
+		dependencies.clear ();
+		if (!updatePackedSheet)
+		{
+			if (errorIfPackedSheetNotGood)
+				nlerror ("loadFormIndexed(): Exception during reading the packed file and can't reconstruct them (%s)", e.what());
+			else
+				nlinfo ("loadFormIndexed(): Exception during reading the packed file and can't reconstruct them (%s)", e.what());
+
+			return;
+		}
+		else
+		{
+			nlinfo ("loadFormIndexed(): Exception during reading the packed file, I'll reconstruct it (%s)", e.what());
+		}
+	}
+
+	// if we don't want to update packed sheet, we have nothing more to do
+	if (!updatePackedSheet)
+	{
+		nlinfo ("Don't update the packed sheet with real sheet");
+		return;
+	}
+
+	// retreive the date of all dependency file
+	for (uint i=0; i<dictionnary.size(); ++i)
+	{
+		dictionnaryIndex.insert(std::make_pair(dictionnary[i], i));
+		std::string p = NLMISC::CPath::lookup (dictionnary[i], false, false);
+		if (!p.empty())
+		{
+			uint32 d = NLMISC::CFile::getFileModificationDate(p);
+			dependencyDates.push_back(d);
+		}
+		else
+		{
+			// file not found !
+			// write a future date to invalidate any file dependent on it
+			nldebug("Can't find dependent file %s !", dictionnary[i].c_str());
+			dependencyDates.push_back(0xffffffff);
+		}
+	}
+
+	// build a vector of the sheetFilters sheet ids (ie: "item")
+	std::vector<NLMISC::CSheetId> sheetIds;
+	std::vector<std::string> filenames;
+	for (uint i = 0; i < sheetFilters.size(); i++)
+		NLMISC::CSheetId::buildIdVector(sheetIds, filenames, sheetFilters[i]);
+
+	// if there's no file, nothing to do
+	if (sheetIds.empty())
+		return;
+
+	// the sheets of the file, to remove those that are not in the directory anymore
+	std::set<NLMISC::CSheetId> sheetToRemove;
+	for (uint i = 0; i < container.size(); i++)
+		sheetToRemove.insert (container.getEntry(i).SheetId);
+
+	// check if we need to create a new file or just read it
+	uint32 packedFiledate = container.isOpen() ? NLMISC::CFile::getFileModificationDate(packedFilenamePath) : 0;
+
+	std::vector<uint> NeededToRecompute;
+
+	for (uint k = 0; k < filenames.size(); k++)
+	{
+		std::string p = NLMISC::CPath::lookup (filenames[k], false, false);
+		if (p.empty()) continue;
+		uint32 d = NLMISC::CFile::getFileModificationDate(p);
+
+		// no need to remove this sheet
+		sheetToRemove.erase(sheetIds[k]);
+
+		if( d > packedFiledate || !container.contains (sheetIds[k]))
+		{
+			NeededToRecompute.push_back(k);
+		}
+		else
+		{
+			// check the date of each parent
+			nlassert(dependencies.find(sheetIds[k]) != dependencies.end());
+			std::vector<uint32> &depends = dependencies[sheetIds[k]];
+
+			for (uint i=0; i<depends.size(); ++i)
+			{
+				if (dependencyDates[depends[i]] > packedFiledate)
+				{
+					nldebug("Dependency on %s for %s not up to date !",
+						dictionnary[depends[i]].c_str(), sheetIds[k].toString().c_str());
+					NeededToRecompute.push_back(k);
+					break;
+				}
+			}
+		}
+	}
+
+	nlinfo ("%d sheets checked, %d need to be recomputed", filenames.size(), NeededToRecompute.size());
+
+	// read the sheets to recompute, the new sheets will be written instead of the ones of the file
+	std::vector<NLMISC::CSheetId>		sheetsToLoad;
+	NLGEORGES::CPackedSheetReader<T>	reader;
+	for (uint j = 0; j < NeededToRecompute.size(); j++)
+	{
+		const NLMISC::CSheetId	&sheetId = sheetIds[NeededToRecompute[j]];
+		T	*&sheet= container.NewSheets[sheetId];
+		if (sheet == NULL)
+			sheet= new T;
+		sheetsToLoad.push_back(sheetId);
+		reader.Sheets.push_back(sheet);
+	}
+
+	std::vector<bool>	loaded;
+	NLGEORGES::loadPackedSheetForms(sheetsToLoad, reader, dictionnary, dictionnaryIndex, dependencies, loaded);
+
+	// the forms that can't be loaded keep their old sheet, if any
+	for (uint j = 0; j < sheetsToLoad.size(); j++)
+	{
+		if (!loaded[j])
+		{
+			delete container.NewSheets[sheetsToLoad[j]];
+			container.NewSheets.erase(sheetsToLoad[j]);
+		}
+	}
+
+	// we have now to remove sheets that are in the file and not exist anymore in the sheet directories
+	for (std::set<NLMISC::CSheetId>::iterator it2 = sheetToRemove.begin(); it2 != sheetToRemove.end(); it2++)
+	{
+		nlinfo ("the sheet '%s' is not in the directory, remove it from container", (*it2).toString().c_str());
+		container.get(*it2)->removed();
+		dependencies.erase(*it2);
+	}
+
+	// nothing changed
+	if (container.NewSheets.empty() && sheetToRemove.empty())
+		return;
+
+	// build the list of sheets of the new file, sorted by id
+	std::vector<NLMISC::CSheetId>	sheets;
+	std::vector<bool>				isNew;
+	{
+		std::map<NLMISC::CSheetId, bool>	allSheets;
+		uint i;
+		for (i = 0; i < container.size(); i++)
+		{
+			const NLMISC::CSheetId	&sheetId= container.getEntry(i).SheetId;
+			if (sheetToRemove.find(sheetId) == sheetToRemove.end())
+				allSheets[sheetId]= false;
+		}
+		for (typename std::map<NLMISC::CSheetId, T*>::iterator it= container.NewSheets.begin(); it != container.NewSheets.end(); ++it)
+			allSheets[it->first]= true;
+		for (std::map<NLMISC::CSheetId, bool>::iterator it= allSheets.begin(); it != allSheets.end(); ++it)
+		{
+			sheets.push_back(it->first);
+			isNew.push_back(it->second);
+		}
+	}
+
+	// now, save the new file, and reopen it
+	try
+	{
+		container.rebuild(packedFilenamePath, T::getVersion(), useMMap, dictionnary, dependencies, sheets, isNew);
+	}
+	catch (NLMISC::Exception &e)
+	{
+		nlinfo ("loadFormIndexed(): Exception during saving the packed file, it will be recreated next launch (%s)", e.what());
+	}
+}
+
+// ***************************************************************************
+/** see loadFormIndexed() above
+ * \param sheetFilter a string to filter the sheet (ie: ".item")
+ */
+template <class T>
+void loadFormIndexed (const std::string &sheetFilter, const std::string &packedFilename, NLGEORGES::CIndexedPackedSheets<T> &container, bool updatePackedSheet=true, bool errorIfPackedSheetNotGood=true, bool useMMap=false)
+{
+	std::vector<std::string> vs;
+	vs.push_back(sheetFilter);
+	loadFormIndexed(vs, packedFilename, container, updatePackedSheet, errorIfPackedSheetNotGood, useMMap);
+}
+
+
+#endif // NL_INDEXED_PACKED_SHEETS_H
+
+/* End of indexed_packed_sheets.h */
@@ -99,6 +99,9 @@
 
  * Now you can access the Container (using the CSheedId) to know the WalkSpeed and RunSpeed of all creatures.
  *
+ * When there are a lot of sheets and only a few of them are used at a time, use loadFormIndexed() instead
+ * (see indexed_packed_sheets.h): the sheets are only deserialized when first accessed.
+ *
  */
 
 
@@ -121,6 +124,53 @@ const uint32		PACKED_SHEET_VERSION = 5;
 // This Version may be used if you want to use the serialVersion() system in loadForm()
 const uint32		PACKED_SHEET_VERSION_COMPATIBLE = 0;
 
+
+namespace NLGEORGES
+{
+
+/** Number of worker threads used, in addition to the main thread, to read the sheets when a packed sheet
+ * is rebuilt by loadForm(), loadForm2() or loadFormIndexed(). 0 (default) reads them in the main thread only.
+ * When it is not 0, T::readGeorges() is called from several threads at once on different sheets, so it must
+ * only modify its own object.
+ */
+void	setPackedSheetRebuildThreads(uint numThreads);
+uint	getPackedSheetRebuildThreads();
+
+/// Called by loadPackedSheetForms() for each form loaded
+class IPackedSheetReader
+{
+public:
+	virtual ~IPackedSheetReader() {}
+	virtual void	readSheet(uint index, const NLMISC::CSmartPtr<UForm> &form, const NLMISC::CSheetId &sheetId) =0;
+};
+
+/// An IPackedSheetReader calling readGeorges() on the objects of the sheets
+template <class T>
+class CPackedSheetReader : public IPackedSheetReader
+{
+public:
+	/// For each sheet given to loadPackedSheetForms(), the object to fill
+	std::vector<T*>		Sheets;
+
+	virtual void	readSheet(uint index, const NLMISC::CSmartPtr<UForm> &form, const NLMISC::CSheetId &sheetId)
+	{
+		Sheets[index]->readGeorges (form, sheetId);
+	}
+};
+
+/** Load the forms of the sheets to recompute during a packed sheet rebuild, call reader.readSheet() for each form
+ * loaded, and update the dependencies of the sheets loaded.
+ * The sheets are shared between getPackedSheetRebuildThreads() worker threads and the main thread, each one with
+ * its own UFormLoader. The dictionnary and the dependencies are then built in the order of the sheets, so the
+ * packed sheet is the same whatever the number of threads.
+ * \param loaded filled with, for each sheet, true if its form has been loaded and read.
+ */
+void	loadPackedSheetForms(const std::vector<NLMISC::CSheetId> &sheets, IPackedSheetReader &reader,
+							 std::vector<std::string> &dictionnary, std::map<std::string, uint> &dictionnaryIndex,
+							 std::map<NLMISC::CSheetId, std::vector<uint32> > &dependencies, std::vector<bool> &loaded);
+
+} // NLGEORGES
+
 // ***************************************************************************
 /** This function is used to load values from georges sheet in a quick way.
  * \param sheetFilter a vector of string to filter the sheet in the case you need more than one filter
@@ -276,8 +326,6 @@ void loadForm (const std::vector<std::string> &sheetFilters, const std::string &
 
 	bool containerChanged = false;
 
-	NLGEORGES::UFormLoader *formLoader = NULL;
-
 	std::vector<uint> NeededToRecompute;
 
 	for (uint k = 0; k < filenames.size(); k++)
@@ -314,92 +362,31 @@ void loadForm (const std::vector<std::string> &sheetFilters, const std::string &
 
 	nlinfo ("%d sheets checked, %d need to be recomputed", filenames.size(), NeededToRecompute.size());
 
-	NLMISC::TTime last = NLMISC::CTime::getLocalTime ();
-	NLMISC::TTime start = NLMISC::CTime::getLocalTime ();
-
-	NLMISC::CSmartPtr<NLGEORGES::UForm> form;
-	std::vector<NLMISC::CSmartPtr<NLGEORGES::UForm> >	cacheFormList;
-
+	// read the sheets to recompute, they could be already loaded by the packed sheets but will be overwritten with the new ones
+	std::vector<NLMISC::CSheetId>		sheetsToLoad;
+	std::vector<bool>					newSheets;
+	NLGEORGES::CPackedSheetReader<T>	reader;
 	for (uint j = 0; j < NeededToRecompute.size(); j++)
 	{
-		if(NLMISC::CTime::getLocalTime () > last + 5000)
-		{
-			last = NLMISC::CTime::getLocalTime ();
-			if(j>0)
-				nlinfo ("%.0f%% completed (%d/%d), %d seconds remaining", (float)j*100.0/NeededToRecompute.size(),j,NeededToRecompute.size(), (NeededToRecompute.size()-j)*(last-start)/j/1000);
-		}
-
-		// create the georges loader if necessary
-		if (formLoader == NULL)
-		{
-			NLMISC::WarningLog->addNegativeFilter("CFormLoader: Can't open the form file");
-			formLoader = NLGEORGES::UFormLoader::createLoader ();
-		}
-
-		//	cache used to retain information (to optimize time).
-		if (form)
-			cacheFormList.push_back	(form);
-
-		// Load the form with given sheet id
-		form = formLoader->loadForm (sheetIds[NeededToRecompute[j]].toString().c_str ());
-		if (form)
-		{
-			// build the dependency data
-			{
-				std::vector<uint32>		depends;
-				std::set<std::string>	dependFiles;
-				form->getDependencies (dependFiles);
-				nlassert(dependFiles.find(sheetIds[NeededToRecompute[j]].toString()) != dependFiles.end());
-				// remove the sheet itself from the container
-				dependFiles.erase(sheetIds[NeededToRecompute[j]].toString());
-
-				std::set<std::string>::iterator first(dependFiles.begin()), last(dependFiles.end());
-				for (; first != last; ++first)
-				{
-					const	std::string filename = NLMISC::CFile::getFilename(*first);
-					std::map<std::string,uint>::iterator	findDicIt=dictionnaryIndex.find(filename);
-
-					if	(findDicIt!=dictionnaryIndex.end())
-					{
-						depends.push_back(findDicIt->second);
-						continue;
-					}
-
-					std::string p = NLMISC::CPath::lookup (*first, false, false);
-					if	(!p.empty())
-					{
-						uint dicIndex;
-						// add a new dictionnary entry
-						dicIndex = dictionnary.size();
-						dictionnaryIndex.insert(std::make_pair(filename, dictionnary.size()));
-						dictionnary.push_back(filename);
-
-						// add the dependecy index
-						depends.push_back(dicIndex);
-					}
-				}
-				// store the dependency list with the sheet ID
-				dependencies[sheetIds[NeededToRecompute[j]]] = depends;
-			}
-
-			// add the new creature, it could be already loaded by the packed sheets but will be overwritten with the new one
-			typedef typename std::map<NLMISC::CSheetId, T>::iterator TType1;
-            typedef typename std::pair<TType1, bool> TType2;
-			TType2 res = container.insert(std::make_pair(sheetIds[NeededToRecompute[j]],T()));
-
-			(*res.first).second.readGeorges (form, sheetIds[NeededToRecompute[j]]);
-			containerChanged = true;
-		}
+		const NLMISC::CSheetId	&sheetId = sheetIds[NeededToRecompute[j]];
+		typedef typename std::map<NLMISC::CSheetId, T>::iterator TType1;
+		typedef typename std::pair<TType1, bool> TType2;
+		TType2 res = container.insert(std::make_pair(sheetId, T()));
+		sheetsToLoad.push_back(sheetId);
+		newSheets.push_back(res.second);
+		reader.Sheets.push_back(&(*res.first).second);
 	}
 
-	if(NeededToRecompute.size() > 0)
-		nlinfo ("%d seconds to recompute %d sheets", (uint32)(NLMISC::CTime::getLocalTime()-start)/1000, NeededToRecompute.size());
+	std::vector<bool>	loaded;
+	NLGEORGES::loadPackedSheetForms(sheetsToLoad, reader, dictionnary, dictionnaryIndex, dependencies, loaded);
 
-	// free the georges loader if necessary
-	if (formLoader != NULL)
+	for (uint j = 0; j < sheetsToLoad.size(); j++)
 	{
-		NLGEORGES::UFormLoader::releaseLoader (formLoader);
-		NLMISC::WarningLog->removeFilter ("CFormLoader: Can't open the form file");
+		if (loaded[j])
+			containerChanged = true;
+		// the form can't be loaded, don't add it to the container
+		else if (newSheets[j])
+			container.erase(sheetsToLoad[j]);
 	}
 
 	// we have now to remove sheets that are in the container and not exist anymore in the sheet directories
@@ -639,8 +626,6 @@ void loadForm2(const std::vector<std::string> &sheetFilters, const std::string &
 
 	bool containerChanged = false;
 
-	NLGEORGES::UFormLoader *formLoader = NULL;
-
 	std::vector<uint> NeededToRecompute;
 
 	for (uint k = 0; k < filenames.size(); k++)
@@ -677,92 +662,31 @@ void loadForm2(const std::vector<std::string> &sheetFilters, const std::string &
 
 	nlinfo ("%d sheets checked, %d need to be recomputed", filenames.size(), NeededToRecompute.size());
 
-	NLMISC::TTime last = NLMISC::CTime::getLocalTime ();
-	NLMISC::TTime start = NLMISC::CTime::getLocalTime ();
-
-	NLMISC::CSmartPtr<NLGEORGES::UForm> form;
-	std::vector<NLMISC::CSmartPtr<NLGEORGES::UForm> >	cacheFormList;
-
+	// read the sheets to recompute, they could be already loaded by the packed sheets but will be overwritten with the new ones
+	std::vector<NLMISC::CSheetId>		sheetsToLoad;
+	std::vector<bool>					newSheets;
+	NLGEORGES::CPackedSheetReader<T>	reader;
 	for (uint j = 0; j < NeededToRecompute.size(); j++)
 	{
-		if(NLMISC::CTime::getLocalTime () > last + 5000)
-		{
-			last = NLMISC::CTime::getLocalTime ();
-			if(j>0)
-				nlinfo ("%.0f%% completed (%d/%d), %d seconds remaining", (float)j*100.0/NeededToRecompute.size(),j,NeededToRecompute.size(), (NeededToRecompute.size()-j)*(last-start)/j/1000);
-		}
-
-		// create the georges loader if necessary
-		if (formLoader == NULL)
-		{
-			NLMISC::WarningLog->addNegativeFilter("CFormLoader: Can't open the form file");
-			formLoader = NLGEORGES::UFormLoader::createLoader ();
-		}
-
-		//	cache used to retain information (to optimize time).
-		if (form)
-			cacheFormList.push_back	(form);
-
-		// Load the form with given sheet id
-		form = formLoader->loadForm (sheetIds[NeededToRecompute[j]].toString().c_str ());
-		if (form)
-		{
-			// build the dependency data
-			{
-				std::vector<uint32>		depends;
-				std::set<std::string>	dependFiles;
-				form->getDependencies (dependFiles);
-				nlassert(dependFiles.find(sheetIds[NeededToRecompute[j]].toString()) != dependFiles.end());
-				// remove the sheet itself from the container
-				dependFiles.erase(sheetIds[NeededToRecompute[j]].toString());
-
-				std::set<std::string>::iterator first(dependFiles.begin()), last(dependFiles.end());
-				for (; first != last; ++first)
-				{
-					const	std::string filename = NLMISC::CFile::getFilename(*first);
-					std::map<std::string,uint>::iterator	findDicIt=dictionnaryIndex.find(filename);
-
-					if	(findDicIt!=dictionnaryIndex.end())
-					{
-						depends.push_back(findDicIt->second);
-						continue;
-					}
-
-					std::string p = NLMISC::CPath::lookup (*first, false, false);
-					if	(!p.empty())
-					{
-						uint dicIndex;
-						// add a new dictionnary entry
-						dicIndex = dictionnary.size();
-						dictionnaryIndex.insert(std::make_pair(filename, dictionnary.size()));
-						dictionnary.push_back(filename);
-
-						// add the dependency index
-						depends.push_back(dicIndex);
-					}
-				}
-				// store the dependency list with the sheet ID
-				dependencies[sheetIds[NeededToRecompute[j]]] = depends;
-			}
-
-			// add the new creature, it could be already loaded by the packed sheets but will be overwritten with the new one
-			typedef typename std::map<NLMISC::CSheetId, NLMISC::CSmartPtr<T> >::iterator TType1;
-            typedef typename std::pair<TType1, bool> TType2;
-			TType2 res = container.insert(std::make_pair(sheetIds[NeededToRecompute[j]], NLMISC::CSmartPtr<T>(new T())));
-
-			(*res.first).second->readGeorges (form, sheetIds[NeededToRecompute[j]]);
-			containerChanged = true;
-		}
+		const NLMISC::CSheetId	&sheetId = sheetIds[NeededToRecompute[j]];
+		typedef typename std::map<NLMISC::CSheetId, NLMISC::CSmartPtr<T> >::iterator TType1;
+		typedef typename std::pair<TType1, bool> TType2;
+		TType2 res = container.insert(std::make_pair(sheetId, NLMISC::CSmartPtr<T>(new T())));
+		sheetsToLoad.push_back(sheetId);
+		newSheets.push_back(res.second);
+		reader.Sheets.push_back((T*)(*res.first).second);
 	}
 
-	if(NeededToRecompute.size() > 0)
-		nlinfo ("%d seconds to recompute %d sheets", (uint32)(NLMISC::CTime::getLocalTime()-start)/1000, NeededToRecompute.size());
+	std::vector<bool>	loaded;
+	NLGEORGES::loadPackedSheetForms(sheetsToLoad, reader, dictionnary, dictionnaryIndex, dependencies, loaded);
 
-	// free the georges loader if necessary
-	if (formLoader != NULL)
+	for (uint j = 0; j < sheetsToLoad.size(); j++)
 	{
-		NLGEORGES::UFormLoader::releaseLoader (formLoader);
-		NLMISC::WarningLog->removeFilter ("CFormLoader: Can't open the form file");
+		if (loaded[j])
+			containerChanged = true;
+		// the form can't be loaded, don't add it to the container
+		else if (newSheets[j])
+			container.erase(sheetsToLoad[j]);
 	}
 
 	// we have now to remove sheets that are in the container and not exist anymore in the sheet directories
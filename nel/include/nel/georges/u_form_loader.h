@@ -37,6 +37,9 @@ class UFormDfn;
 /**
  * Georges form loader interface
  *
+ * The loader caches the forms, dfn and types it loads. They are ref counted and not thread safe, so a loader and
+ * the forms it returns must be used by one thread only: create a loader per thread (see loadPackedSheetForms()).
+ *
  * \author Cyril 'Hulud' Corvazier
  * \author Nevrax France
  * \date 2002
@@ -51,6 +51,7 @@ namespace NLLIGO
 
 class CPrimitives;
 class CLigoConfig;
+class CPrimitiveIndex;
 
 // ***************************************************************************
 
@@ -393,6 +394,9 @@ private:
 	// Update child Id
 	void updateChildId (uint index);
 
+	// Get the index of the tree of this primitive, NULL if not indexed
+	CPrimitiveIndex	*getTreeIndex () const;
+
 	// Child id
 	uint32									_ChildId;
 
@@ -408,6 +412,9 @@ private:
 	// Editor specific properties (unparsed)
 	mutable std::string						_UnparsedProperties;
 
+	// Index of the tree, set on the root node only (see CPrimitives::buildIndex)
+	CPrimitiveIndex							*_Index;
+
 
 #ifdef NLLIGO_DEBUG
 	std::string								_DebugClassName;
@@ -699,6 +706,20 @@ public:
 	// serial the primitive. Used for binary files.
 	void			serial(NLMISC::IStream &f);
 
+	/** Write the primitive in the compact binary format.
+	  * The class names, property names and string values are stored once in a string pool,
+	  * the primitive tree is written node by node in depth first order and refers to the pool by index.
+	  * Unlike serial(), the unparsed properties are kept, so the file can be converted back to xml.
+	  */
+	void			writeBinary(NLMISC::IStream &f) const;
+
+	/** Read the primitive from the compact binary format written by writeBinary().
+	  * The stream is read sequentially, once. As with read(), the primitive context must
+	  * be set if the primitive contains aliases.
+	  * Return false if the stream is not a valid binary primitive.
+	  */
+	bool			readBinary(NLMISC::IStream &f);
+
 	// Root primitive hierarchy
 	CPrimNode		*RootNode;
 
@@ -731,6 +752,18 @@ public:
 	// Build the complete list of indexed primitive (ie all primitive that have a primalias child)
 	void			buildPrimitiveWithAliasList(std::map<uint32, IPrimitive*> &result);
 
+	/** Build an index over the primitive tree, see CPrimitiveIndex. The index is then kept up to
+	  * date when primitives are inserted or removed in the tree, until releaseIndex() is called.
+	  */
+	CPrimitiveIndex	*buildIndex(float cellSize = 64.f, uint gridSize = 128);
+
+	// Release the index of the primitive tree
+	void			releaseIndex();
+
+	// Get the index of the primitive tree, NULL if buildIndex() has not been called
+	CPrimitiveIndex	*getIndex() { return _Index; }
+	const CPrimitiveIndex	*getIndex() const { return _Index; }
+
 
 private:
 	// Conversion internal methods
@@ -748,6 +781,8 @@ private:
 	// Store the filename
 	// This allows to retrieve the static alias when reloading from binary file
 	std::string			_Filename;
+	/// Optional index of the primitive tree
+	CPrimitiveIndex		*_Index;
 };
 
 // ***************************************************************************
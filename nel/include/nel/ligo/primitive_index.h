@@ -0,0 +1,151 @@
+/** \file primitive_index.h
+ * Spatial and property index over a ligo primitive tree
+ */
+
+/* Copyright, 2000-2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_PRIMITIVE_INDEX_H
+#define NL_PRIMITIVE_INDEX_H
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/vector.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace NLLIGO
+{
+
+class IPrimitive;
+class CPrimZone;
+
+/**
+ * Index over a primitive tree, to avoid walking the whole tree with predicates to find primitives.
+ *
+ * The primitives are indexed by their "class" and "name" properties, and the primitives with
+ * vertices (points, pathes and zones) are put in a 2d grid by their bounding box.
+ * The grid wraps around like the NL3D quad grid: a cell holds the primitives of all the areas
+ * that map on it, the candidates are then checked against their bounding box.
+ *
+ * An index is built by CPrimitives::buildIndex(). It is then kept up to date when primitives are
+ * inserted, unlinked or removed in the tree. It is not when the properties or the vertices of an
+ * indexed primitive are modified: call update() for it.
+ *
+ * The queries are const, they can be called by several threads as long as the tree is not modified.
+ * The primitives are returned sorted by address: the order is not the order of the tree.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CPrimitiveIndex
+{
+public:
+
+	/** Constructor
+	  * \param cellSize is the size of a grid cell, in meters.
+	  * \param gridSize is the number of cells on a side of the grid, rounded up to a power of 2.
+	  */
+	CPrimitiveIndex (float cellSize = 64.f, uint gridSize = 128);
+
+	/// \name Indexation
+
+	/// Clear the index and index a primitive tree. The root itself is indexed.
+	void		build (IPrimitive *root);
+
+	/// Clear the index
+	void		clear ();
+
+	/// Index a primitive and all its children
+	void		addBranch (IPrimitive *primitive);
+
+	/// Remove a primitive and all its children from the index
+	void		removeBranch (IPrimitive *primitive);
+
+	/// Index again a primitive whose class, name or vertices have been modified. Its children are not updated.
+	void		update (IPrimitive *primitive);
+
+	/// Number of primitives in the index
+	uint		size () const { return (uint)_Entries.size (); }
+
+	/// \name Queries, append the primitives found to the result
+
+	/// Primitives of a class
+	void		selectByClass (const std::string &className, std::vector<IPrimitive*> &result) const;
+
+	/// Primitives with a name
+	void		selectByName (const std::string &name, std::vector<IPrimitive*> &result) const;
+
+	/// Primitives of a class with a name
+	void		selectByClassAndName (const std::string &className, const std::string &name, std::vector<IPrimitive*> &result) const;
+
+	/// Primitives whose bounding box intersects a box. z is ignored.
+	void		selectInBox (const NLMISC::CVector &cornerMin, const NLMISC::CVector &cornerMax, std::vector<IPrimitive*> &result) const;
+
+	/// Zones that contain a position. If className is not NULL, only the zones of this class are returned.
+	void		selectZonesContaining (const NLMISC::CVector &pos, std::vector<CPrimZone*> &result, const std::string *className = NULL) const;
+
+private:
+
+	typedef std::set<IPrimitive*>						TPrimitiveSet;
+	typedef CHashMap<std::string, TPrimitiveSet>		TPrimitiveByKey;
+
+	// An indexed primitive
+	class CEntry
+	{
+	public:
+		std::string			Class;
+		std::string			Name;
+		// Bounding box, only if the primitive has vertices
+		bool				InGrid;
+		float				MinX, MinY, MaxX, MaxY;
+	};
+	typedef std::map<IPrimitive*, CEntry>				TEntries;
+
+	// The cells
+	typedef std::vector<IPrimitive*>					TCell;
+
+	void		addPrimitive (IPrimitive *primitive);
+	void		removePrimitive (IPrimitive *primitive);
+
+	// Get the cell range of a box, clamped to the grid size
+	void		getCellRange (float minX, float minY, float maxX, float maxY, sint &x0, sint &y0, sint &x1, sint &y1) const;
+	TCell		&getCell (sint x, sint y) { return _Grid[(x & _GridMask) + (y & _GridMask) * _GridSize]; }
+	const TCell	&getCell (sint x, sint y) const { return _Grid[(x & _GridMask) + (y & _GridMask) * _GridSize]; }
+
+	static void	select (const TPrimitiveByKey &index, const std::string &key, std::vector<IPrimitive*> &result);
+
+	float					_CellSize;
+	float					_OOCellSize;
+	uint					_GridSize;
+	uint					_GridMask;
+	std::vector<TCell>		_Grid;
+
+	TEntries				_Entries;
+	TPrimitiveByKey			_ByClass;
+	TPrimitiveByKey			_ByName;
+};
+
+
+} // namespace NLLIGO
+
+#endif // NL_PRIMITIVE_INDEX_H
+
+/* End of primitive_index.h */
@@ -334,6 +334,60 @@ inline bool saveXmlPrimitiveFile(CPrimitives &primDoc, const std::string &fileNa
 	}
 }
 
+/** Utility function that load a binary primitive file (see CPrimitives::writeBinary) into a CPrimitives object.
+ *	The file is read at once before being parsed.
+ *	Return false if the loading fail for some reason, true otherwise.
+ */
+inline bool loadBinaryPrimitiveFile(CPrimitives &primDoc, const std::string &fileName)
+{
+	try
+	{
+		NLMISC::CIFile	fileIn;
+		fileIn.setCacheFileOnOpen(true);
+		if (!fileIn.open(fileName))
+		{
+			nlwarning("Error opening input file '%s'", fileName.c_str());
+			return false;
+		}
+
+		// Read it
+		return primDoc.readBinary(fileIn);
+	}
+	catch(NLMISC::Exception e)
+	{
+		nlwarning("Error reading input file '%s': '%s'", fileName.c_str(), e.what());
+		return false;
+	}
+}
+
+/** Utility function that save a CPrimitives object into a binary primitive file.
+ *	Return false if the saving fail for some reason, true otherwise.
+ */
+inline bool saveBinaryPrimitiveFile(const CPrimitives &primDoc, const std::string &fileName)
+{
+	try
+	{
+		NLMISC::COFile	fileOut;
+		if (!fileOut.open(fileName))
+		{
+			nlwarning("Error opening output file '%s'", fileName.c_str());
+			return false;
+		}
+
+		// Write it
+		primDoc.writeBinary(fileOut);
+
+		fileOut.close();
+
+		return true;
+	}
+	catch(NLMISC::Exception e)
+	{
+		nlwarning("Error writing output file '%s': '%s'", fileName.c_str(), e.what());
+		return false;
+	}
+}
+
 /** Utility function to look for the first child of a primitive node that
  *	match the predicate.
  *	Return NULL if none of the child match the predicate.
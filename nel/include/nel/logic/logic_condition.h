@@ -215,6 +215,16 @@ public:
 		Type = TERMINATOR;
 	}
 
+	/**
+	 * Copy constructor, the sub nodes are copied
+	 */
+	CLogicConditionNode( const CLogicConditionNode& node );
+
+	/**
+	 * Copy operator, the sub nodes are copied
+	 */
+	CLogicConditionNode& operator=( const CLogicConditionNode& node );
+
 	/**
 	 *	Set the logic state machine
 	 *
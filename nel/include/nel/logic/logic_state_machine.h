@@ -71,6 +71,97 @@ class CLogicStateMachine
 	/// name of this sate machine
 	std::string _Name;
 
+	/// \name Compiled state machine, see compile()
+	// @{
+
+	/// blocks of a compiled condition node
+	enum TCompiledBlock
+	{
+		BLOCK_TRUE = 0,
+		BLOCK_FALSE,
+		BLOCK_COMPARISON,
+		BLOCK_CONDITION,
+	};
+
+	/// comparison operators
+	enum TCompiledComparison
+	{
+		CMP_LESS = 0,
+		CMP_LESS_EQUAL,
+		CMP_GREATER,
+		CMP_GREATER_EQUAL,
+		CMP_EQUAL,
+		CMP_NOT_EQUAL,
+	};
+
+	/// a condition node, its sub nodes are contiguous in _CompiledNodes
+	class CCompiledNode
+	{
+	public:
+		uint8	Block;
+		uint8	Comparison;
+		/// true if the sub nodes are negated (NOT block)
+		bool	Not;
+		/// variable index for a comparison, condition index for a sub condition
+		uint32	Index;
+		sint64	Comparand;
+		uint32	FirstChild;
+		uint32	ChildCount;
+	};
+
+	/// a condition, its top level nodes are contiguous in _CompiledNodes, followed by their sub nodes
+	class CCompiledCondition
+	{
+	public:
+		uint32	FirstNode;
+		uint32	NodeCount;
+		uint32	EndNode;
+	};
+
+	/// an event of a state
+	class CCompiledEvent
+	{
+	public:
+		/// condition index, NoIndex if the condition is unknown
+		uint32	Condition;
+		/// index of the next state for a state change, NoIndex if unknown
+		uint32	State;
+	};
+
+	enum { NoIndex = 0xffffffff };
+
+	/// true if the compiled data are up to date
+	bool _Compiled;
+
+	/// variables then counters
+	std::vector<CLogicVariable *> _VariableTable;
+	std::vector<CLogicCounter *> _CounterTable;
+	std::vector<CLogicState *> _StateTable;
+	/// index of the first event of each state in _CompiledEvents
+	std::vector<uint32> _StateFirstEvent;
+	std::vector<CCompiledEvent> _CompiledEvents;
+	std::vector<CCompiledCondition> _CompiledConditions;
+	std::vector<CCompiledNode> _CompiledNodes;
+
+	/// index of the current state, NoIndex if none
+	uint32 _CurrentStateIndex;
+
+	// compile a list of condition nodes in the slots [first, first+nodes.size()[
+	void compileNodes( const std::vector<const CLogicConditionNode *>& nodes, uint32 first,
+					   const std::map<std::string, uint32>& varIndex, const std::map<std::string, uint32>& condIndex );
+
+	// break the sub condition cycles
+	void checkConditionCycle( uint32 condition, std::vector<uint8>& visited );
+
+	// evaluate a compiled condition
+	bool testCompiledCondition( uint32 condition ) const;
+	bool testCompiledNode( const CCompiledNode& node ) const;
+
+	// switch to a state by index
+	void switchToState( uint32 stateIndex );
+
+	// @}
+
 public:
 
 	const std::map<std::string, CLogicVariable> &getVariables () { return _Variables; }
@@ -82,7 +173,29 @@ public:
 	/**
 	 *	Default constructor
 	 */
-	CLogicStateMachine() { _Name = "no_name"; }
+	CLogicStateMachine() { _Name = "no_name"; _Compiled = false; _CurrentStateIndex = NoIndex; }
+
+	/**
+	 *	Copy constructor, the copy is not compiled
+	 */
+	CLogicStateMachine( const CLogicStateMachine& other );
+
+	/**
+	 *	Copy operator, the copy is not compiled
+	 */
+	CLogicStateMachine& operator=( const CLogicStateMachine& other );
+
+	/**
+	 *	Compile the state machine.
+	 *	The variables, counters, conditions and states are resolved to indices, and the conditions are
+	 *	flattened to a node array. processLogic() then runs without looking up names nor allocating memory.
+	 *	The unknown names are reported once here, and evaluated as false.
+	 *	processLogic() compiles the state machine if it has been modified since the last compilation.
+	 */
+	void compile();
+
+	/// Return true if the state machine is compiled
+	bool isCompiled() const { return _Compiled; }
 
 	/**
 	 * Set the state machine name
@@ -129,7 +242,7 @@ public:
 	 *
 	 * \param var is the new variable to add in this state machine
 	 */
-	void addVariable( CLogicVariable var ) { _Variables.insert( std::make_pair(var.getName(),var) ); }
+	void addVariable( CLogicVariable var ) { _Variables.insert( std::make_pair(var.getName(),var) ); _Compiled = false; }
 
 	/**
 	 *	Get the variable
@@ -145,7 +258,7 @@ public:
 	 *
 	 * \param counter is the new counter to add in this state machine
 	 */
-	void addCounter( CLogicCounter counter ) { _Counters.insert( std::make_pair(counter.getName(),counter) ); }
+	void addCounter( CLogicCounter counter ) { _Counters.insert( std::make_pair(counter.getName(),counter) ); _Compiled = false; }
 
 	/**
 	 * Add a condition in the state machine
@@ -186,6 +299,24 @@ public:
 	 */
 	void modifyVariable( std::string varName, std::string modifOperator, sint64 value );
 
+	/**
+	 *	Get the index of a variable or a counter, to modify it with modifyVariable() without looking for its name.
+	 *	The state machine is compiled if needed. The index is valid until the state machine is modified.
+	 *
+	 * \param varName is the name of the variable
+	 * \return the index of the variable, -1 if not found
+	 */
+	sint32 getVariableIndex( const std::string& varName );
+
+	/**
+	 *	modify a variable
+	 *
+	 * \param varIndex is the index of the variable, given by getVariableIndex()
+	 * \param modifOperator is the modification operator
+	 * \param value is the value to use along with the modificator
+	 */
+	void modifyVariable( uint32 varIndex, CLogicVariable::TModifOperator modifOperator, sint64 value );
+
 	/**
 	 * serial
 	 */
@@ -54,6 +54,17 @@ protected:
 
 public:
 
+	/// modification operators
+	enum TModifOperator
+	{
+		MODIF_SET = 0,
+		MODIF_ADD,
+		MODIF_SUB,
+		MODIF_MUL,
+		MODIF_DIV,
+		MODIF_UNKNOWN,
+	};
+
 	/**
 	 * Default constructor
 	 */
@@ -103,6 +114,22 @@ public:
 	 */
 	void applyModification( std::string op, sint64 value );
 
+	/**
+	 * Apply modifications on a variable
+	 *
+	 * \param op is the modification operator
+	 * \param value is the value to use along with the modificator
+	 */
+	void applyModification( TModifOperator op, sint64 value );
+
+	/**
+	 * Get a modification operator from its name
+	 *
+	 * \param op can be one of these operators :"SET"("set"),"ADD"("add"),"SUB"("sub"),"MUL"("mul"),"DIV"("div")
+	 * \return the operator, MODIF_UNKNOWN if the name is unknown
+	 */
+	static TModifOperator getModifOperator( const std::string& op );
+
 	/**
 	 * update the variable
 	 */
@@ -30,6 +30,8 @@
 namespace NLMISC
 {
 
+class CBatchFileReader;
+
 /**
  * CAsyncFileManager is a class that manage file loading in a seperate thread
  * \author Matthieu Besson
@@ -39,7 +41,8 @@ namespace NLMISC
 class CAsyncFileManager : public CTaskManager
 {
 	NLMISC_SAFE_SINGLETON_DECL(CAsyncFileManager);
-	CAsyncFileManager() {}
+	CAsyncFileManager() : _Reader (NULL) {}
+	~CAsyncFileManager();
 public:
 
 	// Must be called instead of constructing the object
@@ -48,7 +51,10 @@ public:
 	// Each system that use the async file manager should ensure it has no more pending task in it
 	static void terminate ();
 
-	// Do not use these methods with the bigfile manager
+	/** Load files in memory, the files on the disk or in the bnps ("bnp@file"), with a CBatchFileReader.
+	  * Each pointer is set to a new[] buffer when its file is loaded, or to (uint8*)-1 on an error.
+	  * The reads are not throttled, unless CBatchFileReader::setBandwidth() is called.
+	  */
 	void loadFile (const std::string &fileName, uint8 **pPtr);
 	void loadFiles (const std::vector<std::string> &vFileNames, const std::vector<uint8**> &vPtrs);
 
@@ -84,6 +90,10 @@ private:
 
 //	static CAsyncFileManager *_Singleton;
 
+	// The reader of the loading thread, created at the first load and kept for its io_uring ring
+	CBatchFileReader	*_Reader;
+	CBatchFileReader	&getReader ();
+
 	// All the tasks
 	// -------------
 
@@ -0,0 +1,175 @@
+/** \file batch_file_reader.h
+ * Read a batch of files with asynchronous reads
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_BATCH_FILE_READER_H
+#define NL_BATCH_FILE_READER_H
+
+#include "types_nl.h"
+
+#include <string>
+#include <deque>
+#include <vector>
+
+
+namespace NLMISC
+{
+
+struct CBigFileBlocks;
+
+/**
+ * Read a batch of whole files in memory, the files on the disk and the files in the bnps ("bnp@file").
+ *
+ * The files are cut in reads of ReadSize bytes, or in the blocks of a compressed file in a bnp, and
+ * QueueDepth reads are kept in flight: the disk can reorder and merge them, and a small file is not
+ * delayed by the whole batch. The files are completed in the order of the completion of their reads.
+ *
+ * On Linux, the reads are submitted with io_uring when the kernel supports it, else they are done
+ * one after another with pread().
+ *
+ * The reads can be throttled by a bandwidth budget shared by all the threads (see setBandwidth()): a
+ * read only waits when the budget is exhausted, for the time needed to refill it. There is no limit
+ * by default.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CBatchFileReader
+{
+public:
+
+	enum TBackend { IOUring, PRead };
+
+	enum { ReadSize = 256*1024, QueueDepth = 32 };
+
+	/// The default bandwidth of the async loading of CIFile, 64 KB every 5 ms like before the budget (12.8 MB/s)
+	enum { DefaultCacheLoadBandwidth = 64*1024*200 };
+
+	/// Constructor. If useIOUring is false, the reads are done with pread() even if io_uring is available.
+	CBatchFileReader (bool useIOUring = true);
+	~CBatchFileReader ();
+
+	/** Add a file to the batch. When it is read, *ppFile is set to a new[] buffer with its content, or to
+	  * (uint8*)-1 if it can't be read, like in CAsyncFileManager::loadFile().
+	  */
+	void			addFile (const std::string &fileName, uint8 **ppFile);
+
+	/// Read all the files added, then empty the batch. Return the number of files read successfully.
+	uint			read ();
+
+	/// The backend used by read()
+	TBackend		getBackend () const { return _Ring ? IOUring : PRead; }
+
+	/** \name Bandwidth budget, shared by all the readers and the async loading of CIFile
+	  */
+	// @{
+	/// Set the read bandwidth in bytes per second, 0 for no limit. No limit by default.
+	static void		setBandwidth (uint32 bytesPerSecond);
+	static uint32	getBandwidth ();
+	/// Wait until size bytes can be read in the budget
+	static void		consumeBandwidth (uint32 size);
+	// @}
+
+	/** \name Bandwidth budget of the async loading of CIFile only, so it doesn't slow down the game
+	  */
+	// @{
+	/// Set the bandwidth in bytes per second, 0 for no limit. DefaultCacheLoadBandwidth by default.
+	static void		setCacheLoadBandwidth (uint32 bytesPerSecond);
+	static uint32	getCacheLoadBandwidth ();
+	/// Wait until size bytes can be read in this budget and in the shared one
+	static void		consumeCacheLoadBandwidth (uint32 size);
+	// @}
+
+private:
+
+	class CRing;
+
+	// A file of the batch
+	struct CFileToRead
+	{
+		std::string				FileName;
+		uint8					**PtrFile;
+		uint8					*Buffer;
+		uint32					Size;
+		// Index of the file handle
+		uint					Handle;
+		uint64					Offset;
+		const CBigFileBlocks	*Blocks;
+		// Number of reads not completed
+		uint					PendingReads;
+		bool					Failed;
+	};
+
+	// An opened file, a disk file or a bnp shared by its files
+	struct CHandle
+	{
+		std::string				Name;
+		sint					Handle;
+		// Number of files not completed, the handle of a disk file is closed when its file is completed
+		uint					Users;
+		bool					BigFile;
+	};
+
+	// A read of a part of a file
+	struct CRead
+	{
+		uint					File;
+		uint64					Pos;
+		uint8					*Dest;
+		uint32					Size;
+		uint32					Done;
+		bool					Completed;
+		// Compressed block: read in Compressed, then decompressed in Target. Target is NULL if not compressed.
+		uint8					*Target;
+		uint32					BlockLength;
+		std::vector<uint8>		Compressed;
+	};
+
+	// Open the next file and cut it in reads, false if all the files are prepared
+	bool			prepareNextFile (std::deque<CRead> &reads);
+	// Get the read at index, preparing the files until it exists. NULL if there is no more read.
+	CRead			*getRead (std::deque<CRead> &reads, uint index);
+	// Complete a read, ok is false if it failed
+	void			complete (CRead &read, bool ok);
+	// Complete a file when its last read is completed
+	void			completeFile (CFileToRead &file);
+	// The reads with each backend
+	void			readWithRing (std::deque<CRead> &reads);
+	void			readWithPRead (std::deque<CRead> &reads);
+	// Close the file handles
+	void			closeHandles ();
+
+	std::vector<CFileToRead>	_Files;
+	uint						_NextFile;
+	std::vector<CHandle>		_Handles;
+	// NULL if io_uring is not used
+	CRing						*_Ring;
+	uint						_NumRead;
+};
+
+
+} // NLMISC
+
+
+#endif // NL_BATCH_FILE_READER_H
+
+/* End of batch_file_reader.h */
@@ -25,21 +25,52 @@
 #define NL_BIG_FILE_H
 
 #include "types_nl.h"
+#include "debug.h"
 #include "tds.h"
 
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
 
 namespace NLMISC {
 
+const uint32 BF_ALWAYS_OPENED		=	0x00000001;
+const uint32 BF_CACHE_FILE_ON_OPEN	=	0x00000002;
+
+/**
+ * Blocks of a compressed file in a bnp v2. The file is cut in blocks of BlockSize bytes, compressed
+ * separately so that a read only decompresses the blocks it overlaps.
+ * The arrays point in the directory of the bnp: they are valid until the bnp is removed.
+ */
+struct CBigFileBlocks
+{
+	uint32			BlockSize;
+	uint32			NumBlocks;
+	// Compressed size of each block, with CBigFile::RawBlockFlag if the block is not compressed
+	const uint32	*Sizes;
+	// Position of each block in the bnp
+	const uint64	*Positions;
+};
+
 /**
  * Big file management
+ *
+ * Two formats of bnp are read:
+ * - v1: the files, then a directory of names, uint32 sizes and uint32 offsets, then the uint32 offset
+ *   of the directory. The directory is sorted at loading.
+ * - v2: the files, then the directory described by the CBNP2 structures, then a CBNP2Footer. The
+ *   offsets are 64 bits, so a bnp can be larger than 4 GB. The files can be compressed by blocks in the
+ *   LZ4 format (see lz4_block.h). The directory is an open addressing hash table of the lower case file
+ *   names, loaded in one read and used as is. Each file has the SHA1 of its content: bnp_make stores the
+ *   files with the same content only once.
+ *
  * \author Matthieu Besson
  * \author Nevrax France
  * \date 2002
  */
 
-const uint32 BF_ALWAYS_OPENED		=	0x00000001;
-const uint32 BF_CACHE_FILE_ON_OPEN	=	0x00000002;
-
 // ***************************************************************************
 class CBigFile
 {
@@ -79,16 +110,88 @@ public:
 	void currentThreadFinished();
 
 
-	// Used by CIFile to get information about the files within the big file
-	FILE* getFile (const std::string &sFileName, uint32 &rFileSize, uint32 &rBigFileOffset,
-					bool &rCacheFileOnOpen, bool &rAlwaysOpened);
+	/** Used by CIFile to get information about the files within the big file.
+	  * rBlocks is NULL if the file is stored, else the file must be read with readBlocks().
+	  */
+	FILE* getFile (const std::string &sFileName, uint32 &rFileSize, uint64 &rBigFileOffset,
+					bool &rCacheFileOnOpen, bool &rAlwaysOpened, const CBigFileBlocks *&rBlocks);
 
-	// Used by Sound to get information for async loading of mp3 in .bnp. Return false if file not found in registered bnps
+	/** Used by Sound to get information for async loading of mp3 in .bnp. Return false if file not found in registered bnps,
+	  * or if it can't be read directly: compressed or beyond 4 GB.
+	  */
 	bool getFileInfo (const std::string &sFileName, uint32 &rFileSize, uint32 &rBigFileOffset);
 
+	/** Used by CBatchFileReader to read a file with its own handle on the bnp. rBlocks is NULL if the file is
+	  * stored, else the blocks must be read at their positions in the bnp and decompressed.
+	  */
+	bool getFileLocation (const std::string &sFileName, std::string &rBigFilePath, uint64 &rBigFileOffset,
+						  uint32 &rFileSize, const CBigFileBlocks *&rBlocks);
+
+	/** Read len bytes at pos in a compressed file. block is a buffer with the last block decompressed, and
+	  * blockIndex its index (NoBlock at first), kept between the reads of the file. Return false on a read error
+	  * or a corrupted block.
+	  */
+	static bool readBlocks (FILE *file, const CBigFileBlocks &blocks, uint32 fileSize, uint32 pos, uint8 *dest, uint32 len,
+							std::vector<uint8> &block, uint32 &blockIndex);
+
 	// Used for CPath only for the moment !
 	char *getFileNamePtr(const std::string &sFileName, const std::string &sBigFileName);
 
+	/// \name BNP v2 format
+	// @{
+
+	enum { BNP2Magic = 0x32504e42 };	// "BNP2"
+	enum { BNP2Version = 1 };
+	enum TCompression { Stored = 0, LZ4Blocks = 1 };
+	enum { RawBlockFlag = 0x80000000 };
+	enum { NoBlock = 0xffffffff };
+
+	/** Directory layout: the header, the entries, the hash table (HashSize uint32, index of an entry + 1 or
+	  * 0 if empty), the compressed size of the blocks (NumBlocks uint32) and the names (NamesSize chars).
+	  */
+	struct CBNP2Header
+	{
+		uint32		Magic;
+		uint32		Version;
+		uint32		NumFiles;
+		// Power of 2, larger than NumFiles
+		uint32		HashSize;
+		uint32		BlockSize;
+		uint32		NumBlocks;
+		uint32		NamesSize;
+		uint32		Pad;
+	};
+
+	struct CBNP2Entry
+	{
+		// hashFileName() of the name
+		uint64		NameHash;
+		uint64		Pos;
+		uint64		Size;
+		// Size in the bnp, blocks included
+		uint64		StoredSize;
+		// Lower case name, in the names
+		uint32		NameOffset;
+		// First block in the block sizes, NoBlock if the file is stored
+		uint32		FirstBlock;
+		uint8		ContentHash[20];
+		uint8		Compression;
+		uint8		Pad[3];
+	};
+
+	// At the end of the bnp
+	struct CBNP2Footer
+	{
+		uint64		DirOffset;
+		uint32		DirSize;
+		uint32		Magic;
+	};
+
+	/// Hash of a lower case file name in the directory
+	static uint64 hashFileName (const char *name);
+
+	// @}
+
 // ***************
 private:
 	class	CThreadFileArray;
@@ -141,13 +244,22 @@ private:
 	// A BNP structure
 	struct BNP
 	{
-		BNP() : FileNames(NULL) { }
+		BNP() : FileNames(NULL), Directory(NULL), Header2(NULL), Entries2(NULL), HashTable2(NULL), Names2(NULL) { }
 
 		// FileName of the BNP. important to open it in getFile() (for other threads or if not always opened).
 		std::string						BigFileName;
 		// map of files in the BNP.
 		char							*FileNames;
 		std::vector<BNPFile>			Files;
+		// v2 directory, as read in the bnp. NULL for a v1 bnp.
+		uint8							*Directory;
+		const CBNP2Header				*Header2;
+		const CBNP2Entry				*Entries2;
+		const uint32					*HashTable2;
+		char							*Names2;
+		std::vector<uint64>				BlockPositions2;
+		// Blocks of each entry, NumBlocks is 0 if the entry is stored
+		std::vector<CBigFileBlocks>		Blocks2;
 		// Since many seek may be done on a FILE*, each thread should have its own FILE opened.
 		uint32							ThreadFileId;
 		bool							CacheFileOnOpen;
@@ -164,8 +276,23 @@ private:
 
 	std::map<std::string, BNP> _BNPs;
 
+	// A file found in a bnp
+	struct CFileInfo
+	{
+		uint64					Pos;
+		uint64					Size;
+		const CBigFileBlocks	*Blocks;
+	};
+
 	// common for getFile and getFileInfo
-	bool getFileInternal (const std::string &sFileName, BNP *&zeBnp, BNPFile *&zeBnpFile);
+	bool getFileInternal (const std::string &sFileName, BNP *&zeBnp, CFileInfo &zeFileInfo);
+
+	// Find an entry of a v2 bnp, -1 if not found
+	static sint findEntry2 (const BNP &bnp, const std::string &lwrFileName);
+
+	// Read a directory of each version. The file is at the beginning of the directory.
+	static bool readDirectory1 (FILE *file, BNP &bnp);
+	static bool readDirectory2 (FILE *file, BNP &bnp, const CBNP2Footer &footer);
 };
 
 } // NLMISC
@@ -486,6 +486,9 @@ public:
 	/// Serialize one bit
 	virtual void	serialBit( bool& bit );
 
+	/// The base types are serialized bit per bit, not as their memory
+	virtual bool	canSerialPODBuffer() const { return false; }
+
 #ifdef LOG_ALL_TRAFFIC
 	void			_serialAndLog( const char *argstr, uint32& value, uint nbits );
 	void			_serialAndLog( const char *argstr, uint64& value, uint nbits );
@@ -570,6 +573,8 @@ public:
 	void			serialCont(std::map<K, T> &cont) 		{CMemStream::serialCont(cont);}
 	template<class K, class T>
 	void			serialCont(std::multimap<K, T> &cont) 	{CMemStream::serialCont(cont);}
+	template<class T>
+	void			serialCont(CEntityIdMap<T> &cont) 	{CMemStream::serialCont(cont);}
 
 	/*template<class T0,class T1>
 	void			serial(T0 &a, T1 &b)
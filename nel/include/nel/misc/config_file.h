@@ -28,8 +28,10 @@
 #include "common.h"
 #include "debug.h"
 #include "log.h"
+#include "sha1.h"
 
 #include <vector>
+#include <deque>
 #include <string>
 #include <cstdio>
 
@@ -108,6 +110,14 @@ namespace NLMISC
  * You can't use operators on a array variable, for example, you can't do \cvar13=var12+1.
  * If you have 2 variables with the same name, the first value will be remplaced by the second one.
  *
+ * The variables are found by name with a hash table, getVar() can be called in the update loops.
+ *
+ * The loaded files are checked by checkConfigFiles(). On Linux, the changes are notified by inotify,
+ * elsewhere the file dates are polled. A file is parsed again only if its content changed, and the
+ * callbacks are only called for the variables whose value changed, once all the variables are updated.
+ * The result of a parse is cached by file content: loading the same files in another CConfigFile
+ * doesn't parse them again.
+ *
  * \bug if you terminate the config file with a comment without carriage returns it'll generate an exception, add a carriage returns
  *
  * \author Vianney Lecroart
@@ -247,7 +257,10 @@ public:
 	/// Returns the number of variables in the configuration
 	uint32 getVarCount();
 
-	/// reload and reparse the file
+	/** reload and reparse the file.
+	 * The variables of the files are updated, the variables that are not in the files anymore are kept.
+	 * Then the callbacks of the variables that changed are called, and the global callback.
+	 */
 	void reparse (bool lookupPaths = false);
 
 	/// display all variables with nlinfo (debug use)
@@ -280,8 +293,12 @@ private:
 	/// Internal use only
 	void (*_Callback)();
 
-	/// Internal use only
-	std::vector<CVar>	_Vars;
+	/// Internal use only, a deque: the references on the variables stay valid when variables are added
+	std::deque<CVar>	_Vars;
+
+	// index of the variables by name
+	typedef CHashMap<std::string, uint>	TVarIndex;
+	TVarIndex			_VarIndex;
 
 	// contains the configfilename (0) and roots configfilenames
 //	std::string	_FileName;
@@ -290,10 +307,22 @@ private:
 	// contains the configfilename (0) and roots configfilenames
 	std::vector<std::string>	FileNames;
 	std::vector<uint32>			LastModified;
+	// sha1 of the content of the files, to not parse again a file saved without modification
+	std::vector<CHashKey>		FileHashes;
 
 	static uint32	_Timeout;
 
 	static std::vector<CConfigFile *> *_ConfigFiles;
+
+	// Return the index of a variable in _Vars, -1 if not found
+	sint	findVar (const std::string &varName) const;
+	void	addVar (const CVar &var);
+
+	// Update the variables with the ones of a parse and call the callbacks of the variables that changed
+	void	updateVars (std::vector<CVar> &vars);
+
+	// Return true if the content of a loaded file is not the one that was parsed
+	bool	isFileModified (uint fileIndex) const;
 };
 
 struct EConfigFile : public Exception
@@ -57,6 +57,9 @@ public:
 	/// Display the string where it does.
 	void display( const CLog::TDisplayInfo& args, const char *message );
 
+	/// Flush the output buffered by the displayer. Called by the asynchronous log writer after a batch of deferred lines.
+	void flush();
+
 	/// This is the identifier for a displayer, it is used to find or remove a displayer
 	std::string DisplayerName;
 
@@ -65,6 +68,9 @@ protected:
 	/// Method to implement in the derived class
 	virtual void doDisplay( const CLog::TDisplayInfo& args, const char *message) = 0;
 
+	/// Flush the output, if the displayer doesn't flush the deferred lines (see CLog::TDisplayInfo::Deferred)
+	virtual void doFlush() {}
+
 
 	// Return the header string with date (for the first line of the log)
 	static const char *HeaderString ();
@@ -107,6 +113,9 @@ protected:
 	/// Display the string to stdout and OutputDebugString on Windows
 	virtual void doDisplay ( const CLog::TDisplayInfo& args, const char *message );
 
+	/// Flush stdout
+	virtual void doFlush ();
+
 };
 
 
@@ -135,6 +144,9 @@ protected:
 	/// Put the string into the file.
     virtual void doDisplay ( const CLog::TDisplayInfo& args, const char *message );
 
+	/// Flush the file
+	virtual void doFlush ();
+
 private:
 	std::string _FileName;
 
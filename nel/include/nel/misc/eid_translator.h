@@ -30,6 +30,7 @@
 
 #include "types_nl.h"
 #include "entity_id.h"
+#include "entity_id_map.h"
 #include "ucstring.h"
 #include "command.h"
 
@@ -82,7 +83,8 @@ public:
 		void serial (NLMISC::IStream &s);
 	};
 
-	typedef std::map<NLMISC::CEntityId, CEntity>	TEntityCont;
+	/// The registered entities, in no particular order
+	typedef CEntityIdMap<CEntity>	TEntityCont;
 
 	/// clear all the registered entities from the translator.
 	void				clear();
@@ -0,0 +1,344 @@
+/** \file entity_id_map.h
+ * Open addressing hash map keyed by CEntityId
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_ENTITY_ID_MAP_H
+#define NL_ENTITY_ID_MAP_H
+
+#include "types_nl.h"
+#include "entity_id.h"
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+
+namespace NLMISC {
+
+/**
+ * A hash map keyed by CEntityId, to replace CHashMap<CEntityId, T, CEntityIdHashMapTraits> and
+ * std::map<CEntityId, T> on the hot paths.
+ *
+ * The keys are compared like CEntityId::operator ==, the dynamic id is ignored.
+ *
+ * The table is split in arrays: the slots hold the 64 bits unique ids of the keys and are probed
+ * linearly, with an index in a dense vector of the (key, value) pairs. A lookup reads one or two
+ * cache lines of the slots and then the value, and an iteration is a walk on the dense vector.
+ *
+ * The interface is the subset of std::map used by the services, with these differences:
+ *	\li the order of the iteration is not the order of the keys, it changes when an element is erased.
+ *	\li erasing an element moves the last element in its place: the iterators and the references on
+ *		the last element are invalidated. erase() returns the iterator to continue an iteration with.
+ *	\li inserting an element may invalidate all the iterators and the references.
+ *	\li the key of an element must not be modified through an iterator.
+ *
+ * \author Nevrax France
+ * \date 2001
+ */
+template <class T>
+class CEntityIdMap
+{
+public:
+	typedef CEntityId									key_type;
+	typedef T											mapped_type;
+	typedef std::pair<CEntityId, T>						value_type;
+	typedef typename std::vector<value_type>::iterator			iterator;
+	typedef typename std::vector<value_type>::const_iterator	const_iterator;
+	typedef uint32										size_type;
+
+	CEntityIdMap() : _Mask(0) { }
+
+	/// \name Size
+	// @{
+	size_type		size() const { return (size_type)_Values.size(); }
+	bool			empty() const { return _Values.empty(); }
+	/// Remove all the elements, the memory is kept
+	void			clear();
+	/// Allocate the slots for count elements
+	void			reserve(uint count);
+	// @}
+
+	/// \name Iteration
+	// @{
+	iterator		begin() { return _Values.begin(); }
+	iterator		end() { return _Values.end(); }
+	const_iterator	begin() const { return _Values.begin(); }
+	const_iterator	end() const { return _Values.end(); }
+	// @}
+
+	/// \name Lookup
+	// @{
+	iterator		find(const CEntityId &id);
+	const_iterator	find(const CEntityId &id) const;
+	size_type		count(const CEntityId &id) const { return findIndex(id) != NotFound ? 1 : 0; }
+	/// Find the value of a key, NULL if not found
+	T				*findValue(const CEntityId &id);
+	const T			*findValue(const CEntityId &id) const;
+	// @}
+
+	/// \name Modification
+	// @{
+	/// Insert an element if its key is not in the map. Return the element of the key and true if inserted.
+	std::pair<iterator, bool>	insert(const value_type &value);
+	/// Return the value of a key, inserted with a default value if not found
+	T				&operator [] (const CEntityId &id);
+	/// Erase an element, return the iterator on the next element to visit
+	iterator		erase(iterator it);
+	/// Erase an element by key, return the number of elements erased
+	size_type		erase(const CEntityId &id);
+	// @}
+
+	void			swap(CEntityIdMap &other);
+
+private:
+	enum { NotFound = 0xffffffff };
+
+	// The key of an id, like CEntityId::getUniqueId() without the store of the bit field
+	static uint64	uniqueKey(const CEntityId &id) { return id.getRawId() & ~CEntityId(0, 0, 0, 0xff).getRawId(); }
+
+	// Empty slot. A unique id has its dynamic id set to 0, it can't be ~0.
+	static uint64	emptyKey() { return UINT64_CONSTANT(0xffffffffffffffff); }
+
+	// Mix the bits of the packed fields, the low bits of the short id are the most variable but they are in the high bits of the raw id
+	static uint32	hash(uint64 key)
+	{
+		key ^= key >> 33;
+		key *= UINT64_CONSTANT(0xff51afd7ed558ccd);
+		key ^= key >> 33;
+		key *= UINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+		key ^= key >> 33;
+		return (uint32)key;
+	}
+
+	// Index of a key in the dense vector, or NotFound
+	uint32			findIndex(const CEntityId &id) const;
+	// Slot of a key, or the empty slot where to insert it
+	uint32			findSlot(uint64 key) const;
+	// Insert a key which is not in the map
+	uint32			insertNew(const value_type &value);
+	void			rehash(uint numSlots);
+
+	// The slots, open addressing with linear probing
+	std::vector<uint64>		_Keys;
+	std::vector<uint32>		_Indices;
+	uint32					_Mask;
+	// The elements
+	std::vector<value_type>	_Values;
+};
+
+
+// ***************************************************************************
+template <class T>
+void CEntityIdMap<T>::clear()
+{
+	_Values.clear();
+	std::fill(_Keys.begin(), _Keys.end(), emptyKey());
+}
+
+// ***************************************************************************
+template <class T>
+void CEntityIdMap<T>::reserve(uint count)
+{
+	_Values.reserve(count);
+	// keep the load under 3/4
+	uint numSlots = raiseToNextPowerOf2(std::max((uint)16, count + count/3 + 1));
+	if (numSlots > _Keys.size())
+		rehash(numSlots);
+}
+
+// ***************************************************************************
+template <class T>
+uint32 CEntityIdMap<T>::findSlot(uint64 key) const
+{
+	uint32 slot = hash(key) & _Mask;
+	for (;;)
+	{
+		uint64 k = _Keys[slot];
+		if (k == key || k == emptyKey())
+			return slot;
+		slot = (slot + 1) & _Mask;
+	}
+}
+
+// ***************************************************************************
+template <class T>
+uint32 CEntityIdMap<T>::findIndex(const CEntityId &id) const
+{
+	if (_Values.empty())
+		return NotFound;
+	uint32 slot = findSlot(uniqueKey(id));
+	return _Keys[slot] == emptyKey() ? (uint32)NotFound : _Indices[slot];
+}
+
+// ***************************************************************************
+template <class T>
+typename CEntityIdMap<T>::iterator CEntityIdMap<T>::find(const CEntityId &id)
+{
+	uint32 index = findIndex(id);
+	return index == NotFound ? _Values.end() : _Values.begin() + index;
+}
+
+// ***************************************************************************
+template <class T>
+typename CEntityIdMap<T>::const_iterator CEntityIdMap<T>::find(const CEntityId &id) const
+{
+	uint32 index = findIndex(id);
+	return index == NotFound ? _Values.end() : _Values.begin() + index;
+}
+
+// ***************************************************************************
+template <class T>
+T *CEntityIdMap<T>::findValue(const CEntityId &id)
+{
+	uint32 index = findIndex(id);
+	return index == NotFound ? NULL : &_Values[index].second;
+}
+
+// ***************************************************************************
+template <class T>
+const T *CEntityIdMap<T>::findValue(const CEntityId &id) const
+{
+	uint32 index = findIndex(id);
+	return index == NotFound ? NULL : &_Values[index].second;
+}
+
+// ***************************************************************************
+template <class T>
+uint32 CEntityIdMap<T>::insertNew(const value_type &value)
+{
+	// keep the load under 3/4
+	if ((_Values.size() + 1) * 4 > _Keys.size() * 3)
+		rehash(std::max((uint)16, (uint)_Keys.size() * 2));
+
+	uint64 key = uniqueKey(value.first);
+	uint32 slot = findSlot(key);
+	nlassert(_Keys[slot] == emptyKey());
+	uint32 index = (uint32)_Values.size();
+	_Values.push_back(value);
+	_Keys[slot] = key;
+	_Indices[slot] = index;
+	return index;
+}
+
+// ***************************************************************************
+template <class T>
+std::pair<typename CEntityIdMap<T>::iterator, bool> CEntityIdMap<T>::insert(const value_type &value)
+{
+	uint32 index = findIndex(value.first);
+	if (index != NotFound)
+		return std::make_pair(_Values.begin() + index, false);
+	index = insertNew(value);
+	return std::make_pair(_Values.begin() + index, true);
+}
+
+// ***************************************************************************
+template <class T>
+T &CEntityIdMap<T>::operator [] (const CEntityId &id)
+{
+	uint32 index = findIndex(id);
+	if (index == NotFound)
+		index = insertNew(value_type(id, T()));
+	return _Values[index].second;
+}
+
+// ***************************************************************************
+template <class T>
+typename CEntityIdMap<T>::iterator CEntityIdMap<T>::erase(iterator it)
+{
+	uint32 index = (uint32)(it - _Values.begin());
+	nlassert(index < _Values.size());
+
+	// Remove the slot, and shift back the following slots of the cluster that can move in the hole
+	uint32 hole = findSlot(uniqueKey(it->first));
+	nlassert(_Keys[hole] != emptyKey() && _Indices[hole] == index);
+	uint32 slot = hole;
+	for (;;)
+	{
+		slot = (slot + 1) & _Mask;
+		uint64 key = _Keys[slot];
+		if (key == emptyKey())
+			break;
+		uint32 ideal = hash(key) & _Mask;
+		// the key can move if its ideal slot is not in ]hole, slot]
+		if (((slot - ideal) & _Mask) >= ((slot - hole) & _Mask))
+		{
+			_Keys[hole] = key;
+			_Indices[hole] = _Indices[slot];
+			hole = slot;
+		}
+	}
+	_Keys[hole] = emptyKey();
+
+	// Move the last element in the erased one
+	uint32 last = (uint32)_Values.size() - 1;
+	if (index != last)
+	{
+		_Indices[findSlot(uniqueKey(_Values[last].first))] = index;
+		_Values[index] = _Values[last];
+	}
+	_Values.pop_back();
+	return _Values.begin() + index;
+}
+
+// ***************************************************************************
+template <class T>
+typename CEntityIdMap<T>::size_type CEntityIdMap<T>::erase(const CEntityId &id)
+{
+	iterator it = find(id);
+	if (it == _Values.end())
+		return 0;
+	erase(it);
+	return 1;
+}
+
+// ***************************************************************************
+template <class T>
+void CEntityIdMap<T>::rehash(uint numSlots)
+{
+	_Keys.assign(numSlots, emptyKey());
+	_Indices.resize(numSlots);
+	_Mask = numSlots - 1;
+	for (uint32 i=0; i<_Values.size(); ++i)
+	{
+		uint64 key = uniqueKey(_Values[i].first);
+		uint32 slot = findSlot(key);
+		_Keys[slot] = key;
+		_Indices[slot] = i;
+	}
+}
+
+// ***************************************************************************
+template <class T>
+void CEntityIdMap<T>::swap(CEntityIdMap &other)
+{
+	_Keys.swap(other._Keys);
+	_Indices.swap(other._Indices);
+	std::swap(_Mask, other._Mask);
+	_Values.swap(other._Values);
+}
+
+
+} // NLMISC
+
+
+#endif // NL_ENTITY_ID_MAP_H
+
+/* End of entity_id_map.h */
@@ -31,6 +31,8 @@
 namespace NLMISC
 {
 
+struct CBigFileBlocks;
+
 // ======================================================================================================
 /**
  * File Exception.
@@ -165,7 +167,6 @@ private:
 
 	// Async
 	static uint32 _NbBytesSerialized;
-	static uint32 _NbBytesLoaded;
 
 	// Stats
 	static uint32 _FileOpened;
@@ -190,7 +191,12 @@ private:
 	/// Flag true if file is in an xml pack
 	bool	_IsInXMLPackFile;
 	//// Offset in bnp or xml pack
-	uint32	_BigFileOffset;
+	uint64	_BigFileOffset;
+	/// Blocks of a file compressed in a bnp, NULL if the file is stored
+	const CBigFileBlocks	*_BigFileBlocks;
+	/// Last block of the compressed file read, and its index
+	std::vector<uint8>		_BigFileBlock;
+	uint32					_BigFileBlockIndex;
 
 	// Load async if needed in the cache.
 	void	loadIntoCache();
@@ -27,9 +27,11 @@
 #include "types_nl.h"
 #include "debug.h"
 #include "file.h"
+#include "mapped_file.h"
 
 #include <string>
 #include <map>
+#include <vector>
 #include <algorithm>
 
 
@@ -61,6 +63,9 @@ namespace NLMISC {
  *	traditional or simplified form. So we append the country code :
  *	zh-CN (china) for simplified, zh for traditional).
  *
+ *	The strings of a language are stored in a single block: a hashed index, the labels and the texts.
+ *	A language file can be compiled with compileStringFile(). load() then maps the compiled file
+ *	in memory instead of parsing the text.
  *
  * \author Vianney Lecroart
  * \author Nevrax France
@@ -126,9 +131,23 @@ public:
 	/// Returns the code of the language ("fr", "en", ...)
 	static std::string getCurrentLanguageCode ();
 
-	/// Find a string in the selected language and return his association.
+	/** Find a string in the selected language and return his association.
+	 *	The reference is valid till the next load() or loadFromFilename().
+	 */
 	static const ucstring &get (const std::string &label);
 
+	/** Find a string in the selected language, or in the fallback one, without copy.
+	 *	Return NULL if it is not found. The text is not NULL terminated.
+	 *	The buffer is valid till the next load() or loadFromFilename().
+	 */
+	static const ucchar *getBuffer (const std::string &label, uint &size);
+
+	/** Compile a language file into a string table that can be mapped in memory.
+	 *	load() uses the compiled file "<code>.uxb" instead of "<code>.uxt" when it is found and is not older,
+	 *	and when no load proxy is set. Return false if the language file can't be read or the output can't be written.
+	 */
+	static bool compileStringFile (const std::string &filename, const std::string &outputFilename);
+
 	// Test if a string has a translation in the selected language.
 	// NB : The empty string is considered to have a translation
 	static bool			   hasTranslation(const std::string &label);
@@ -215,7 +234,94 @@ public:
 
 private:
 
-	typedef std::map<std::string, ucstring>						StrMapContainer;
+	/** A table of translated strings in a single block: a hashed index, the labels and the texts.
+	 *	The block is built in memory from a language file, or mapped from a compiled file.
+	 */
+	class CStringTable
+	{
+	public:
+		CStringTable();
+
+		void			clear();
+
+		/// Add a string. The index must be rebuilt before any lookup.
+		void			add(const std::string &label, const ucchar *text, uint size);
+
+		/** Build the index. When a label was added several times, the last text is kept if replace is true, else the first one.
+		 *	If duplicates is not NULL, the labels added several times are appended to it.
+		 */
+		void			buildIndex(bool replace, std::vector<std::string> *duplicates);
+
+		/// Map a compiled table
+		bool			map(const std::string &filename);
+
+		/// Write the table in a compiled file
+		bool			save(const std::string &filename) const;
+
+		/// Number of strings
+		uint			size() const { return _NumEntries; }
+
+		/// Find a string, return -1 if not found
+		sint			find(const std::string &label) const;
+
+		std::string		getLabel(uint index) const;
+		const ucchar	*getText(uint index, uint &size) const;
+
+		/// The text as a ucstring, built at the first call
+		const ucstring	&getString(uint index) const;
+
+	private:
+		enum { Magic = 0x54383149 };	// "I18T"
+		enum { Version = 1 };
+
+		struct CHeader
+		{
+			uint32		Magic;
+			uint32		Version;
+			uint32		NumEntries;
+			uint32		NumSlots;
+			uint32		NumTextChars;
+			uint32		NumLabelChars;
+		};
+
+		struct CEntry
+		{
+			uint32		Hash;
+			uint32		Label;
+			uint32		LabelSize;
+			uint32		Text;
+			uint32		TextSize;
+		};
+
+		// The block, in the vectors or in the mapped file. The slots are open addressed entry index+1, 0 if empty.
+		const CEntry	*_Entries;
+		const uint32	*_Slots;
+		const ucchar	*_Texts;
+		const char		*_Labels;
+		uint32			_NumEntries;
+		uint32			_NumSlots;
+		uint32			_NumTextChars;
+		uint32			_NumLabelChars;
+
+		std::vector<CEntry>		_EntryVector;
+		std::vector<uint32>		_SlotVector;
+		std::vector<ucchar>		_TextVector;
+		std::string				_LabelVector;
+		CMappedFile				_File;
+
+		mutable std::vector<ucstring>	_Strings;
+
+		// Copy the mapped block in the vectors
+		void			makeEditable();
+		void			updatePointers();
+		static uint32	hash(const char *label, uint size);
+
+		// forbidden
+		CStringTable(const CStringTable &);
+		CStringTable	&operator=(const CStringTable &);
+	};
+
+	typedef CStringTable										StrMapContainer;
 
 	static ILoadProxy											*_LoadProxy;
 
@@ -250,6 +356,9 @@ private:
 
 	static bool loadFileIntoMap(const std::string &filename, StrMapContainer &dest);
 
+	/// Map the compiled language file if it is up to date, else load the language file
+	static bool loadLanguage(const std::string &languageCode, StrMapContainer &dest);
+
 	/// The internal read function, it does the real job of readTextFile
 	static void _readTextFile(const std::string &filename,
 								ucstring &result, bool forceUtf8,
@@ -29,12 +29,14 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 
 namespace NLMISC
 {
 
 class IDisplayer;
+class CAsyncLogWriter;
 
 
 /**
@@ -42,6 +44,12 @@ class IDisplayer;
  * The positive filters, if any, are applied first, then the negative filters.
  * See the nldebug/nlinfo... macros in debug.h.
  *
+ * In asynchronous mode (see setAsync() and startAsyncWriter()), the complete lines are pushed in a
+ * ring owned by the calling thread, and a writer thread sends them to the displayers. The calling
+ * thread still formats the message, but the decoration and the output are done by the writer,
+ * which flushes the file displayers once per batch of lines. The errors and the asserts are always
+ * displayed synchronously, after the pending lines.
+ *
  * \ref log_howto
  * \author Vianney Lecroart, Olivier Cado
  * \author Nevrax France
@@ -55,7 +63,7 @@ public:
 	// Debug information
 	struct TDisplayInfo
 	{
-		TDisplayInfo() : Date(0), LogType(CLog::LOG_NO), ThreadId(0), FileName(NULL), Line(-1), FuncName(NULL) {}
+		TDisplayInfo() : Date(0), LogType(CLog::LOG_NO), ThreadId(0), FileName(NULL), Line(-1), FuncName(NULL), Deferred(false) {}
 
 		time_t				Date;
 		TLogType			LogType;
@@ -66,10 +74,23 @@ public:
 		const char			*FuncName;
 
 		std::string			CallstackAndLog;	// contains the callstack and a log with not filter of N last line (only in error/assert log type)
+
+		bool				Deferred;			// displayed by the asynchronous log writer, the displayer can wait for IDisplayer::flush() to flush its output
+	};
+
+	/// What to do with a line when the asynchronous ring of the thread is full
+	enum TAsyncOverflow
+	{
+		AsyncDrop,		// Drop the line, the writer reports the number of lines dropped
+		AsyncBlock,		// Wait for the writer
+		AsyncDisplay	// Display the line synchronously
 	};
 
 	CLog (TLogType logType = LOG_NO);
 
+	/// Destructor. Flushes the asynchronous lines of the log.
+	~CLog ();
+
 	/// Add a new displayer in the log. You have to create the displayer, remove it and delete it when you have finish with it.
 	/// For example, in a 3dDisplayer, you can add the displayer when you want, and the displayer displays the string if the 3d
 	/// screen is available and do nothing otherwise. In this case, if you want, you could leave the displayer all the time.
@@ -191,6 +212,35 @@ public:
 	/// Do not call this unless you know why you're doing it, it kills the debug/log system!
 	static void releaseProcessName();
 
+
+	/// \name Asynchronous mode
+
+	/// Send the lines of this log to the asynchronous writer, if it is running
+	void setAsync (bool async) { _Async = async; }
+
+	/// Returns true if the lines of this log are sent to the asynchronous writer
+	bool isAsync () const { return _Async; }
+
+	/** Start the thread that displays the lines of the asynchronous logs.
+	  * \param ringSize is the number of lines that a thread can push before the writer displays them, rounded up to a power of 2.
+	  * A ring is allocated for each thread that logs asynchronously, it is kept until the end of the process, with its size.
+	  * \param overflow is what to do when the ring of a thread is full.
+	  */
+	static void startAsyncWriter (uint ringSize = 1024, TAsyncOverflow overflow = AsyncDrop);
+
+	/// Display the pending lines and stop the writer thread. The asynchronous logs are displayed synchronously until the writer is started again.
+	static void stopAsyncWriter ();
+
+	/// Returns true if the writer thread is running
+	static bool isAsyncWriterRunning ();
+
+	/** Wait until the lines pushed before the call are displayed and flushed.
+	  * If crash is true, the pending lines are displayed by the calling thread without waiting for the writer, which may be
+	  * stuck or dead: only the line the writer is displaying is left to it. The writer is then stopped for good. Use it only
+	  * when the process is dying. It doesn't wait for a lock of the writer, it can be called in a signal handler.
+	  */
+	static void flushAsync (bool crash = false);
+
 protected:
 
 	/// Symetric to setPosition(). Automatically called by display...(). Do not call if noDisplayer().
@@ -199,6 +249,14 @@ protected:
 	/// Returns true if the string must be logged, according to the current filter
 	bool passFilter( const char *filter );
 
+	/// Push a complete line in the asynchronous ring of the thread. Returns false if it must be displayed synchronously.
+	bool pushAsync (const TDisplayInfo &args, const char *str, bool filterPassed);
+
+	/// Send a line to the displayers, called by the asynchronous writer. The displayers used are appended to usedDisplayers.
+	void displayDeferred (const TDisplayInfo &args, const char *str, bool filterPassed, std::vector<IDisplayer *> &usedDisplayers);
+
+	friend class CAsyncLogWriter;
+
 	TLogType							 _LogType;
 	static std::string					*_ProcessName;
 
@@ -216,6 +274,11 @@ protected:
 
 	uint32								 _PosSet;
 
+	bool								 _Async;
+
+	/// Protects the displayer lists against the asynchronous writer
+	CMutex								 _DisplayersMutex;
+
 	/// "Discard" filter
 	std::list<std::string>				 _NegativeFilter;
 
@@ -0,0 +1,63 @@
+/** \file lz4_block.h
+ * Compression of memory blocks in the LZ4 block format
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_LZ4_BLOCK_H
+#define NL_LZ4_BLOCK_H
+
+#include "types_nl.h"
+
+
+namespace NLMISC
+{
+
+/**
+ * Compress and decompress memory blocks in the LZ4 block format (no frame header nor checksum).
+ * The output can be read by any LZ4 implementation. The compressor is a simple greedy one: it
+ * favours the decompression speed, for data packed once and read many times (ie. bnp files).
+ *
+ * The compressed size is not stored in the block, nor the uncompressed one: the caller must keep them.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+
+/// Maximum size of a compressed block, for srcSize bytes of uncompressed data
+inline uint32	lz4CompressBound (uint32 srcSize) { return srcSize + srcSize / 255 + 16; }
+
+/** Compress srcSize bytes of src in dest.
+  * Return the compressed size, or 0 if it doesn't fit in destCapacity bytes.
+  */
+uint32			lz4Compress (const uint8 *src, uint32 srcSize, uint8 *dest, uint32 destCapacity);
+
+/** Decompress a block of srcSize bytes in destSize bytes.
+  * Return false if the block is corrupted, or if it doesn't decompress in exactly destSize bytes.
+  */
+bool			lz4Decompress (const uint8 *src, uint32 srcSize, uint8 *dest, uint32 destSize);
+
+
+} // NLMISC
+
+
+#endif // NL_LZ4_BLOCK_H
+
+/* End of lz4_block.h */
@@ -0,0 +1,86 @@
+/** \file mapped_file.h
+ * Read only memory mapping of a file
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_MAPPED_FILE_H
+#define NL_MAPPED_FILE_H
+
+#include "types_nl.h"
+#include <string>
+
+
+namespace NLMISC {
+
+
+/**
+ * Map a whole file in memory, read only.
+ * Using file mapping under Windows, mmap() under Linux.
+ * Pages are only loaded by the system when accessed, so this is a cheap way to read
+ * a few parts of a big file.
+ *
+ * NB: files in a big file (BNP) can't be mapped, see CPath::lookup().
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CMappedFile
+{
+public:
+
+	/// Constructor
+	CMappedFile();
+	/// Destructor. close() the file.
+	~CMappedFile();
+
+	/// Map a file. Return false if the file can't be opened or mapped. Any previously mapped file is closed.
+	bool			open(const std::string &path);
+
+	/// Unmap the file
+	void			close();
+
+	bool			isOpen() const { return _Data != NULL; }
+
+	/// The content of the file, or NULL if not open (or if the file is empty)
+	const uint8		*getData() const { return _Data; }
+
+	uint32			getSize() const { return _Size; }
+
+private:
+	const uint8		*_Data;
+	uint32			_Size;
+#ifdef NL_OS_WINDOWS
+	void			*_File;
+	void			*_Mapping;
+#endif
+
+	// forbidden
+	CMappedFile(const CMappedFile &);
+	CMappedFile		&operator=(const CMappedFile &);
+};
+
+
+} // NLMISC
+
+
+#endif // NL_MAPPED_FILE_H
+
+/* End of mapped_file.h */
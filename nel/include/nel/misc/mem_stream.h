@@ -188,6 +188,9 @@ public:
 	/// Method inherited from IStream
 	virtual void	serialBit(bool &bit);
 
+	/// Method inherited from IStream, the string mode serializes the base types as text
+	virtual bool	canSerialPODBuffer() const { return !_StringMode && IStream::canSerialPODBuffer(); }
+
 	/**
 	 * Moves the stream pointer to a specified location.
 	 *
@@ -476,6 +479,8 @@ public:
 	void			serialCont(std::map<K, T> &cont) 		{IStream::serialCont(cont);}
 	template<class K, class T>
 	void			serialCont(std::multimap<K, T> &cont) 	{IStream::serialCont(cont);}
+	template<class T>
+	void			serialCont(CEntityIdMap<T> &cont) 	{IStream::serialCont(cont);}
 	/// Specialisation of serialCont() for vector<uint8>
 	virtual void			serialCont(std::vector<uint8> &cont) {IStream::serialCont(cont);}
 	/// Specialisation of serialCont() for vector<sint8>
@@ -28,6 +28,7 @@
 #include "types_nl.h"
 #include "time_nl.h"
 #include <map>
+#include <vector>
 
 #ifdef NL_OS_UNIX
 //#include <iostream>
@@ -539,6 +540,75 @@ private:
 };
 
 
+/**
+ * Condition variable with its mutex. A thread enters the mutex and wait() until a condition on the
+ * data protected by the mutex is true, another thread changes the data in the mutex and calls
+ * notifyOne() or notifyAll() to wake it up. Use it instead of polling a flag with nlSleep().
+ * wait() may return without a notification: always test the condition in a loop.
+ *
+ * Windows: uses a critical section and an event per waiting thread.
+ * Linux: uses a PThread POSIX mutex and condition.
+ *
+ *\code
+ CCondition c;
+ // thread 1
+ c.enter ();
+ while (!ready)
+	c.wait ();
+ c.leave ();
+ // thread 2
+ c.enter ();
+ ready = true;
+ c.notifyAll ();
+ c.leave ();
+ *\endcode
+ * \author Nevrax France
+ * \date 2002
+ */
+class CCondition
+{
+public:
+
+	/// Constructor
+	CCondition();
+
+	/// Destructor. No thread must wait on the condition.
+	~CCondition();
+
+	/// Enter the mutex
+	void	enter ();
+
+	/// Enter the mutex if it is free, returns false without waiting if another thread has it
+	bool	tryEnter ();
+
+	/// Leave the mutex
+	void	leave ();
+
+	/// Leave the mutex and wait to be notified, then enter the mutex again. Must be called in the mutex.
+	void	wait ();
+
+	/// Wake up one of the waiting threads, if any. Must be called in the mutex.
+	void	notifyOne ();
+
+	/// Wake up all the waiting threads. Must be called in the mutex.
+	void	notifyAll ();
+
+private:
+
+#ifdef NL_OS_WINDOWS
+	TNelRtlCriticalSection	_Cs;
+	// The events of the waiting threads
+	std::vector<void*>		_Waiters;
+#elif defined NL_OS_UNIX
+	pthread_mutex_t			_Mutex;
+	pthread_cond_t			_Cond;
+#else
+#	error "No condition implementation for this OS"
+#endif
+
+};
+
+
 /*
  * Debug info
  */
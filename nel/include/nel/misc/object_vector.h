@@ -291,13 +291,20 @@ public:
 			resize (len);
 
 			// Read the vector
-			for(sint i=0;i<len;i++)
+			if (len > 0 && CStreamPOD<T>::Value && f.canSerialPODBuffer())
 			{
-				f.xmlPush ("ELM");
+				f.serialBuffer ((uint8*)_Ptr, len*sizeof(T));
+			}
+			else
+			{
+				for(sint i=0;i<len;i++)
+				{
+					f.xmlPush ("ELM");
 
-				f.serial(_Ptr[i]);
+					f.serial(_Ptr[i]);
 
-				f.xmlPop ();
+					f.xmlPop ();
+				}
 			}
 		}
 		else
@@ -309,13 +316,20 @@ public:
 			f.xmlPushEnd ();
 
 			// Write the vector
-			for(sint i=0;i<len;i++)
+			if (len > 0 && CStreamPOD<T>::Value && f.canSerialPODBuffer())
+			{
+				f.serialBuffer ((uint8*)_Ptr, len*sizeof(T));
+			}
+			else
 			{
-				f.xmlPush ("ELM");
+				for(sint i=0;i<len;i++)
+				{
+					f.xmlPush ("ELM");
 
-				f.serial(_Ptr[i]);
+					f.serial(_Ptr[i]);
 
-				f.xmlPop ();
+					f.xmlPop ();
+				}
 			}
 		}
 
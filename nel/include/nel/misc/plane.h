@@ -168,6 +168,9 @@ public:
 
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CPlane, sizeof(float))
+
 
 }
 
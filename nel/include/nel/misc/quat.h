@@ -510,6 +510,9 @@ public:
 
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CQuat, sizeof(float))
+
 
 // ***************************************************************************
 /**
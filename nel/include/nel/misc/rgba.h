@@ -34,6 +34,7 @@ namespace NLMISC
 {
 
 class	IStream;
+template <class T> struct CStreamPOD;
 
 /**
  * Class pixel RGBA
@@ -357,6 +358,9 @@ public:
 	static const CRGBA White ;
 };
 
+// Serialized as its memory, see NLMISC_STREAM_POD in stream.h
+template <> struct CStreamPOD<CRGBA> { enum { Value = true }; };
+
 
 /**
  * Class pixel BGRA, Windows style pixel.
@@ -0,0 +1,169 @@
+/** \file rope_stream.h
+ * Memory stream stored in a list of shared fixed size chunks
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_ROPE_STREAM_H
+#define NL_ROPE_STREAM_H
+
+#include "types_nl.h"
+#include "stream.h"
+#include "smart_ptr.h"
+
+#include <vector>
+
+
+namespace NLMISC
+{
+
+/**
+ * A chunk of a CRopeStream. The chunks are allocated in a pool shared by all the rope streams,
+ * and shared by the streams copied or sliced from the same stream until one of them writes in it.
+ */
+struct CRopeChunk : public CRefCount
+{
+	enum { Size = 16*1024 };
+
+	uint8	Data[Size];
+
+	/// Allocation in the chunk pool
+	static void	*operator new (size_t size);
+	static void	operator delete (void *p);
+};
+
+
+/**
+ * Memory stream stored in a list of fixed size chunks instead of one contiguous buffer.
+ *
+ * Use it instead of CMemStream to build a large stream of unknown size: writing never moves the data
+ * already written, where a CMemStream reallocates and copies its whole buffer each time it grows.
+ * Copying a rope stream or taking a slice of it shares the chunks, a chunk is copied the first time
+ * one of the streams which share it writes in it (copy on write, like CMemStreamBuffer).
+ *
+ * The interface is the one of CMemStream except buffer(): the data is not contiguous. Use writeTo()
+ * to serialize it in another stream, one serialBuffer() per chunk.
+ *
+ * Unlike CMemStream, length() is the end of the data in both modes, and seek(end) goes there: after
+ * a reserve()/poke() or a seek back, the data written after the position is not lost.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CRopeStream : public NLMISC::IStream
+{
+public:
+
+	/// Initialization constructor
+	CRopeStream( bool inputStream=false );
+
+	/// Copy constructor, the chunks are shared
+	CRopeStream( const CRopeStream& other );
+
+	/// Assignment operator, the chunks are shared
+	CRopeStream&	operator=( const CRopeStream& other );
+
+	/// Exchange the content of two streams
+	void			swap( CRopeStream &other );
+
+	/// Method inherited from IStream
+	virtual void	serialBuffer(uint8 *buf, uint len);
+
+	/// Method inherited from IStream
+	virtual void	serialBit(bool &bit);
+
+	/// Method inherited from IStream
+	virtual bool	seek (sint32 offset, TSeekOrigin origin) const throw(EStream);
+
+	/// Method inherited from IStream
+	virtual sint32	getPos () const throw(EStream)
+	{
+		return sint32(_Pos);
+	}
+
+	/**
+	 * When writing, skip 'len' bytes and return the position of the blank space for a future poke().
+	 */
+	sint32			reserve( uint len );
+
+	/**
+	 * When writing, fill a value previously reserved by reserve()
+	 * (warning: you MUST have called reserve() with sizeof(T) before poking).
+	 */
+	template <class T>
+	void			poke( T value, sint32 pos )
+	{
+		if ( ! isReading() )
+		{
+			nlassert( pos >= 0 && uint32(pos) + sizeof(T) <= _Length );
+			write( uint32(pos), (const uint8*)&value, sizeof(T) );
+		}
+	}
+
+	/// Clear the stream, the chunks are released
+	virtual void	clear();
+
+	/// Returns the length of the data, in bytes
+	virtual uint32	length() const
+	{
+		return _Length;
+	}
+
+	/// Transforms the message from input to output or from output to input
+	virtual void	invert();
+
+	/// Force to reset the ptr table
+	void			resetPtrTable() { IStream::resetPtrTable() ; }
+
+	/**
+	 * Return an input stream on 'len' bytes of the data from 'pos'. The chunks are shared, no data is copied.
+	 */
+	CRopeStream		slice( uint32 pos, uint32 len ) const;
+
+	/// Write the data in another stream, one serialBuffer() per chunk
+	void			writeTo( IStream &dest ) const;
+
+	/// Returns the number of chunks used by the stream
+	uint			getNumChunks() const { return (uint)_Chunks.size(); }
+
+private:
+
+	typedef CSmartPtr<CRopeChunk>	TChunkPtr;
+
+	// Write at a position, the chunks up to pos+len must be allocated
+	void			write( uint32 pos, const uint8 *buf, uint32 len );
+
+	// Allocate the chunks to store 'length' bytes
+	void			grow( uint32 length );
+
+	// The chunks, the data starts at _Offset in the first chunk
+	std::vector<TChunkPtr>	_Chunks;
+	uint32					_Offset;
+	uint32					_Length;
+	mutable uint32			_Pos;
+};
+
+
+} // NLMISC
+
+
+#endif // NL_ROPE_STREAM_H
+
+/* End of rope_stream.h */
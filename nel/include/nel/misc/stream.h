@@ -42,6 +42,7 @@ namespace	NLMISC
 
 class	IStream;
 class	CMemStream;
+template <class T> class CEntityIdMap;
 
 
 // ======================================================================================================
@@ -134,6 +135,41 @@ struct EStreamOverflow : public EStream
 class	IStreamable;
 
 
+// ======================================================================================================
+/**
+ * Trait of the types whose serialization is a copy of their memory: the base types, and the structs of
+ * them, without padding, whose serial() serializes all their members in order.
+ * serialCont() of a vector of those types is done with one serialBuffer() call, if the stream serializes
+ * the base types as their memory (see IStream::canSerialPODBuffer()).
+ * The streams are little endian: on a big endian processor, only the types made of bytes are.
+ *
+ * A type is declared with NLMISC_STREAM_POD(type, size of its members), in the NLMISC namespace.
+ */
+template <class T>
+struct CStreamPOD
+{
+	enum { Value = false };
+};
+
+#ifdef NL_LITTLE_ENDIAN
+#	define NLMISC_STREAM_POD(__type, __memberSize) template <> struct CStreamPOD<__type> { enum { Value = true }; };
+#else // NL_LITTLE_ENDIAN
+#	define NLMISC_STREAM_POD(__type, __memberSize) template <> struct CStreamPOD<__type> { enum { Value = (__memberSize == 1) }; };
+#endif // NL_LITTLE_ENDIAN
+
+NLMISC_STREAM_POD(uint8, 1)
+NLMISC_STREAM_POD(sint8, 1)
+NLMISC_STREAM_POD(char, 1)
+NLMISC_STREAM_POD(uint16, 2)
+NLMISC_STREAM_POD(sint16, 2)
+NLMISC_STREAM_POD(uint32, 4)
+NLMISC_STREAM_POD(sint32, 4)
+NLMISC_STREAM_POD(uint64, 8)
+NLMISC_STREAM_POD(sint64, 8)
+NLMISC_STREAM_POD(float, 4)
+NLMISC_STREAM_POD(double, 8)
+
+
 // ======================================================================================================
 /**
  * A IO stream interface.
@@ -382,7 +418,7 @@ public:
 
 
 	/** \name standard STL containers serialisation.
-	 * Known Supported containers: vector<>, list<>, deque<>, set<>, multiset<>, map<>, multimap<>
+	 * Known Supported containers: vector<>, list<>, deque<>, set<>, multiset<>, map<>, multimap<>, CEntityIdMap<>
 	 * Support up to sint32 length containers.
 	 * \see serialContPtr() serialContPolyPtr()
 	 */
@@ -400,6 +436,8 @@ public:
 	void			serialCont(std::map<K, T> &cont) 			{serialMap(cont);}
 	template<class K, class T, class H>
 	void			serialCont(CHashMap<K, T, H> &cont) 			{serialMap(cont);}
+	template<class T>
+	void			serialCont(CEntityIdMap<T> &cont) 			{serialMap(cont);}
 	template<class K, class T>
 	void			serialCont(std::multimap<K, T> &cont) 	{serialMultimap(cont);}
 
@@ -965,6 +1003,12 @@ public:
 	virtual void		serialBit(bool &bit) =0;
 	//@}
 
+	/** Return true if the base types are serialized as their memory, so an array of CStreamPOD types can
+	 *	be serialized with one serialBuffer(). The streams that serialize the base types in another way
+	 *	(text, bits) must return false. Default is true, except in XML mode.
+	 */
+	virtual bool		canSerialPODBuffer() const { return !_XML; }
+
 	/// This method first serializes the size of the buffer and after the buffer itself, it enables
 	/// the possibility to serial with a serialCont() on the other side.
 	virtual void		serialBufferWithSize(uint8 *buf, uint32 len)
@@ -1109,16 +1153,25 @@ protected:
 
 			// special version for vector: adjut good size.
 			contReset(cont);
-			cont.resize (len);
 
 			// Read the vector
-			for(sint i=0;i<len;i++)
+			if (len > 0 && CStreamPOD<__value_type>::Value && canSerialPODBuffer())
 			{
-				xmlPush ("ELM");
+				checkStreamSize(len*sizeof(__value_type));
+				cont.resize (len);
+				serialBuffer ((uint8*)&cont[0], len*sizeof(__value_type));
+			}
+			else
+			{
+				cont.resize (len);
+				for(sint i=0;i<len;i++)
+				{
+					xmlPush ("ELM");
 
-				serial(cont[i]);
+					serial(cont[i]);
 
-				xmlPop ();
+					xmlPop ();
+				}
 			}
 		}
 		else
@@ -1130,14 +1183,21 @@ protected:
 			xmlPushEnd ();
 
 			// Write the vector
-			__iterator		it= cont.begin();
-			for(sint i=0;i<len;i++, it++)
+			if (len > 0 && CStreamPOD<__value_type>::Value && canSerialPODBuffer())
 			{
-				xmlPush ("ELM");
+				serialBuffer ((uint8*)&cont[0], len*sizeof(__value_type));
+			}
+			else
+			{
+				__iterator		it= cont.begin();
+				for(sint i=0;i<len;i++, it++)
+				{
+					xmlPush ("ELM");
 
-				serial(const_cast<__value_type&>(*it));
+					serial(const_cast<__value_type&>(*it));
 
-				xmlPop ();
+					xmlPop ();
+				}
 			}
 		}
 
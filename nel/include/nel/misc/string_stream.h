@@ -62,6 +62,9 @@ public:
 	/// Method inherited from IStream
 	virtual void	serialBit(bool &bit);
 
+	/// The base types are serialized as text
+	virtual bool	canSerialPODBuffer() const { return false; }
+
 	/// Template serialisation (should take the one from IStream)
     template<class T>
 	void			serial(T &obj)							{ obj.serial(*this); }
@@ -80,6 +83,8 @@ public:
 	void			serialCont(std::map<K, T> &cont) 		{CMemStream::serialCont(cont);}
 	template<class K, class T>
 	void			serialCont(std::multimap<K, T> &cont) 	{CMemStream::serialCont(cont);}
+	template<class T>
+	void			serialCont(CEntityIdMap<T> &cont) 	{CMemStream::serialCont(cont);}
 
 	template<class T0,class T1>
 	void			serial(T0 &a, T1 &b)
@@ -179,6 +179,26 @@
 #	endif // NL_CPU_INTEL
 #endif // NL_NO_ASM
 
+// Setup SSE2 intrinsics. Define NL_NO_SSE2 externally to get the plain C++ code.
+
+#ifndef NL_NO_SSE2
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define NL_HAS_SSE2						// SSE2 intrinsics (emmintrin.h) may be used.
+#	endif
+#endif // NL_NO_SSE2
+
+// NL_THREAD_LOCAL : storage class for static POD variables with one instance per thread.
+// NL_HAS_THREAD_LOCAL is defined when the compiler supports it (else NL_THREAD_LOCAL is empty and the variable is shared).
+#if defined(NL_OS_WINDOWS) && defined(_MSC_VER)
+#	define NL_THREAD_LOCAL __declspec(thread)
+#	define NL_HAS_THREAD_LOCAL
+#elif defined(__GNUC__)
+#	define NL_THREAD_LOCAL __thread
+#	define NL_HAS_THREAD_LOCAL
+#else
+#	define NL_THREAD_LOCAL
+#endif
+
 
 // Define this if you want to use GTK for gtk_displayer
 
@@ -30,6 +30,27 @@
 
 #include <string>
 
+namespace NLMISC
+{
+
+/// Returned by convertUtf8ToUtf16() when the source is not valid UTF-8
+const uint	InvalidUtf8 = 0xffffffff;
+
+/** Convert size bytes of UTF-8 into dest, which must have room for size characters.
+ *	Return the number of characters written, or InvalidUtf8 if src is not valid UTF-8.
+ *	As for ucstring::fromUtf8(), the characters out of the 16 bits range are truncated.
+ *	The ASCII runs are converted 16 bytes at a time.
+ */
+uint		convertUtf8ToUtf16 (const char *src, uint size, ucchar *dest);
+
+/** Convert size characters into dest as UTF-8, dest must have room for 3*size bytes.
+ *	Return the number of bytes written.
+ *	The ASCII runs are converted 8 characters at a time.
+ */
+uint		convertUtf16ToUtf8 (const ucchar *src, uint size, char *dest);
+
+}
+
 /**
  * \typedef ucstring
  * An unicode string class (16 bits per character).
@@ -157,37 +178,10 @@ public:
 	std::string toUtf8() const
 	{
 		std::string	res;
-		ucstring::const_iterator first(begin()), last(end());
-		for (; first != last; ++first)
+		if (!empty())
 		{
-			//ucchar	c = *first;
-			uint nbLoop = 0;
-			if (*first < 0x80)
-				res += char(*first);
-			else if (*first < 0x800)
-			{
-				ucchar c = *first;
-				c = c >> 6;
-				c = c & 0x1F;
-				res += char(c) | 0xC0;
-				nbLoop = 1;
-			}
-			else /*if (*first < 0x10000)*/
-			{
-				ucchar c = *first;
-				c = c >> 12;
-				c = c & 0x0F;
-				res += char(c) | 0xE0;
-				nbLoop = 2;
-			}
-
-			for (uint i=0; i<nbLoop; ++i)
-			{
-				ucchar	c = *first;
-				c = c >> ((nbLoop - i - 1) * 6);
-				c = c & 0x3F;
-				res += char(c) | 0x80;
-			}
+			res.resize(size()*3);
+			res.resize(NLMISC::convertUtf16ToUtf8(data(), (uint)size(), &res[0]));
 		}
 		return res;
 	}
@@ -201,83 +195,21 @@ public:
 	/// Convert the utf8 string into this ucstring (16 bits char)
 	void fromUtf8(const std::string &stringUtf8)
 	{
-		// clear the string
-		erase();
-
-		uint8 c;
-		ucchar code;
-		sint iterations = 0;
+		if (stringUtf8.empty())
+		{
+			erase();
+			return;
+		}
 
-		std::string::const_iterator first(stringUtf8.begin()), last(stringUtf8.end());
-		for (; first != last; )
+		resize(stringUtf8.size());
+		uint	length = NLMISC::convertUtf8ToUtf16(stringUtf8.data(), (uint)stringUtf8.size(), &(*this)[0]);
+		if (length == NLMISC::InvalidUtf8)
 		{
-			c = *first++;
-			code = c;
-
-			if ((code & 0xFE) == 0xFC)
-			{
-				code &= 0x01;
-				iterations = 5;
-			}
-			else if ((code & 0xFC) == 0xF8)
-			{
-				code &= 0x03;
-				iterations = 4;
-			}
-			else if ((code & 0xF8) == 0xF0)
-			{
-				code &= 0x07;
-				iterations = 3;
-			}
-			else if ((code & 0xF0) == 0xE0)
-			{
-				code &= 0x0F;
-				iterations = 2;
-			}
-			else if ((code & 0xE0) == 0xC0)
-			{
-				code &= 0x1F;
-				iterations = 1;
-			}
-			else if ((code & 0x80) == 0x80)
-			{
-				// If it's not a valid UTF8 string, just copy the line without utf8 conversion
-				rawCopy(stringUtf8);
-				return;
-			}
-			else
-			{
-				push_back(code);
-				iterations = 0;
-			}
-
-			if (iterations)
-			{
-				for (sint i = 0; i < iterations; i++)
-				{
-					if (first == last)
-					{
-						// If it's not a valid UTF8 string, just copy the line without utf8 conversion
-						rawCopy(stringUtf8);
-						return;
-					}
-
-					uint8 ch;
-					ch = *first ++;
-
-					if ((ch & 0xC0) != 0x80)
-					{
-						// If it's not a valid UTF8 string, just copy the line without utf8 conversion
-						rawCopy(stringUtf8);
-						return;
-					}
-
-					code <<= 6;
-					code |= (ucchar)(ch & 0x3F);
-				}
-				push_back(code);
-			}
+			// If it's not a valid UTF8 string, just copy the line without utf8 conversion
+			rawCopy(stringUtf8);
+			return;
 		}
+		resize(length);
 	}
 
 	static ucstring makeFromUtf8(const std::string &stringUtf8)
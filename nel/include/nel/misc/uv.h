@@ -80,6 +80,9 @@ public:
 	void	serial(NLMISC::IStream &f)	{f.serial(U,V);}
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CUV, sizeof(float))
+
 
 inline CUV operator * (float f, const CUV &uv)
 {
@@ -150,6 +153,9 @@ public:
 	operator CUV() const { return CUV(U, V); }
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CUVW, sizeof(float))
+
 
 } // NLMISC
 
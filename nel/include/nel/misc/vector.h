@@ -143,6 +143,9 @@ public:		// Methods.
 	friend	CVector	operator*(float f, const CVector &v0);
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CVector, sizeof(float))
+
 // blend (faster version than the generic version found in algo.h)
 inline CVector blend(const CVector &v0, const CVector &v1, float lambda)
 {
@@ -134,6 +134,9 @@ public:		// Methods.
 	//@}
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CVector2f, sizeof(float))
+
 
 inline	CVector2f	operator*(float f, const CVector2f &v)
 {
@@ -133,6 +133,9 @@ public:		// Methods.
 	friend	CVectorD	operator*(double f, const CVectorD &v0);
 };
 
+// Serialized as its memory
+NLMISC_STREAM_POD(CVectorD, sizeof(double))
+
 
 }
 
@@ -0,0 +1,149 @@
+/** \file worker_pool.h
+ * A pool of threads which run jobs
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_WORKER_POOL_H
+#define NL_WORKER_POOL_H
+
+#include "types_nl.h"
+#include "app_context.h"
+#include "debug.h"
+#include "mutex.h"
+
+#include <deque>
+#include <vector>
+
+
+namespace NLMISC
+{
+
+class IThread;
+
+/**
+ * A job run by a CWorkerPool
+ */
+class IWorkerJob
+{
+public:
+	virtual ~IWorkerJob() {}
+
+	/// Run the job, in a thread of the pool or in the thread which waits for it
+	virtual void	run () =0;
+};
+
+
+/**
+ * The jobs a thread waits for with CWorkerPool::wait()
+ */
+class CWorkerJobGroup
+{
+public:
+	CWorkerJobGroup () : _NumPending (0) { }
+	~CWorkerJobGroup () { nlassert (_NumPending == 0); }
+
+private:
+	friend class CWorkerPool;
+
+	// Number of jobs added and not finished, in the mutex of the pool
+	uint	_NumPending;
+};
+
+
+/**
+ * A pool of threads which run the jobs added by the other threads, in the order they are added.
+ * The threads of the pool wait for the jobs on a condition: they don't use the CPU when there is
+ * nothing to do.
+ *
+ * A thread adds jobs in a group, then waits for the group: it runs the jobs of the group which are
+ * not started yet instead of sleeping, so a job is never delayed by a busy pool.
+ *
+ * The instance is shared by the systems which run jobs in parallel with the main thread (the async
+ * refine of the landscape, the particle systems, the clip): each one reserves the threads it needs.
+ *
+ *\code
+ CWorkerJobGroup group;
+ CWorkerPool::getInstance ().addJob (&job0, group);
+ CWorkerPool::getInstance ().addJob (&job1, group);
+ // ...
+ CWorkerPool::getInstance ().wait (group);
+ *\endcode
+ * \author Nevrax France
+ * \date 2002
+ */
+class CWorkerPool
+{
+	NLMISC_SAFE_SINGLETON_DECL(CWorkerPool);
+	CWorkerPool ();
+	~CWorkerPool ();
+public:
+
+	/// Release the singleton. No job must be pending.
+	static void		terminate ();
+
+	/// Start threads until the pool has at least numThreads threads
+	void			reserveThreads (uint numThreads);
+
+	/// The number of threads of the pool
+	uint			getNumThreads ();
+
+	/// Add a job in a group. The job must stay valid until the group is finished.
+	void			addJob (IWorkerJob *job, CWorkerJobGroup &group);
+
+	/// Wait until all the jobs of a group are finished. The calling thread runs the jobs of the group not started yet.
+	void			wait (CWorkerJobGroup &group);
+
+	/// True if all the jobs of a group are finished
+	bool			isFinished (const CWorkerJobGroup &group);
+
+private:
+
+	class CWorkerThread;
+	friend class CWorkerThread;
+
+	struct CJob
+	{
+		IWorkerJob			*Job;
+		CWorkerJobGroup		*Group;
+	};
+
+	// The loop of the threads
+	void			runJobs ();
+	// Run a job and finish it, called in the condition
+	void			runJob (const CJob &job);
+
+	// Protect all the fields below, notified when a job is added or when a group is finished
+	CCondition						_Condition;
+	std::deque<CJob>				_Jobs;
+	// Number of threads waiting in wait()
+	uint							_NumWaiting;
+	bool							_Exit;
+	std::vector<CWorkerThread*>		_Workers;
+	std::vector<IThread*>			_Threads;
+};
+
+
+} // NLMISC
+
+
+#endif // NL_WORKER_POOL_H
+
+/* End of worker_pool.h */
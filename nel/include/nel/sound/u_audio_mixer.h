@@ -89,6 +89,7 @@ public:
 		DriverOpenAl,
 		DriverDSound,
 		DriverXAudio2,
+		DriverSoftware,
 		NumDrivers
 	};
 
@@ -145,6 +146,11 @@ public:
 	 *	Default is to store packed sheet in the current directory.
 	 */
 	virtual void		setPackedSheetOption(const std::string &path, bool update) =0;
+	/** Set the device the driver is initialized with. Default is empty, the default device.
+	 *	This must be set BEFORE calling init. See the driver documentation for the device names
+	 *	(ie. DriverSoftware takes a wav file name).
+	 */
+	virtual void		setDriverDevice(const std::string &device) =0;
 	/** Initialization
 	 *
 	 * In case of failure, can throw one of these ESoundDriver (Exception) objects:
@@ -230,6 +236,14 @@ public:
 	/** Return a list of loaded sample bank with their size.
 	*/
 	virtual void		getLoadedSampleBankInfo(std::vector<std::pair<std::string, uint> > &result) =0;
+	/** Set the memory budget of the samples, in bytes. Call before loading the sample banks.
+	 *	With a budget, a sample is loaded on its first play (the first play is then skipped unless
+	 *	the source has the HighestPri priority), and the least recently played samples are unloaded
+	 *	to stay in the budget. 0 (the default) loads all the samples with their bank.
+	 *	\param decodeADPCM If the driver doesn't play ADPCM, read the ADPCM samples and decode them
+	 *	instead of reading the 16 bits PCM samples (four times less data read, with the ADPCM quality).
+	 */
+	virtual void		setSampleBankBudget(uint32 budget, bool decodeADPCM = false) =0;
 	//@}
 
 	/// Get a TSoundId from a name (returns NULL if not found)
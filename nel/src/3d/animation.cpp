@@ -57,6 +57,16 @@ CAnimation::CAnimation() : _BeginTimeTouched(true), _EndTimeTouched(true), _Anim
 
 // ***************************************************************************
 
+uint	CAnimation::getTrackSamplePackId(uint trackId) const
+{
+	// NB: tracks added after applyTrackQuatHeaderCompression() are not in the pack
+	if(trackId>=_TrackSamplePackIds.size())
+		return NotFound;
+	return _TrackSamplePackIds[trackId];
+}
+
+// ***************************************************************************
+
 CAnimation::~CAnimation ()
 {
 	// Delete all the pointers in the array
@@ -406,12 +416,9 @@ void	CAnimation::applyTrackQuatHeaderCompression()
 			_TrackSamplePack->TrackHeaders[i]= sampleCounter.TrackHeaders[i];
 		}
 
-		// and allocate keys
-		_TrackSamplePack->Times.resize(sampleCounter.NumKeys);
-		_TrackSamplePack->Keys.resize(sampleCounter.NumKeys);
-
 		// start the counter for Pass1 to work
 		uint	globalKeyOffset= 0;
+		_TrackSamplePackIds.resize(_TrackVector.size(), NotFound);
 
 		// fill it for each track
 		for(i=0;i<_TrackVector.size();i++)
@@ -426,11 +433,17 @@ void	CAnimation::applyTrackQuatHeaderCompression()
 					// delete the old track, and replace with compressed one
 					delete _TrackVector[i];
 					_TrackVector[i]= newTrack;
+
+					// NB: Pass1 only builds CTrackSampledQuatSmallHeader
+					_TrackSamplePackIds[i]= static_cast<CTrackSampledQuatSmallHeader*>(newTrack)->getTrackSamplePackId();
 				}
 			}
 		}
 
-		nlassert(globalKeyOffset == _TrackSamplePack->Keys.size());
+		nlassert(globalKeyOffset == sampleCounter.NumKeys);
+
+		// lay out the keys by time blocks
+		_TrackSamplePack->build();
 	}
 
 
@@ -442,6 +455,7 @@ struct CTempTrackInfo
 {
 	uint16	ChannelId;
 	ITrack	*Track;
+	uint32	TrackSamplePackId;
 
 	bool operator<(const CTempTrackInfo &o) const
 	{
@@ -461,6 +475,7 @@ void	CAnimation::applyAnimHeaderCompression(CAnimationSet *animationSetOwner, co
 	for(i=0;i<tempTrackInfo.size();i++)
 	{
 		tempTrackInfo[i].Track= _TrackVector[i];
+		tempTrackInfo[i].TrackSamplePackId= getTrackSamplePackId(i);
 	}
 
 	// fill the track info, with ChannelId
@@ -483,6 +498,8 @@ void	CAnimation::applyAnimHeaderCompression(CAnimationSet *animationSetOwner, co
 	{
 		_TrackVector[i]= tempTrackInfo[i].Track;
 		_IdByChannelId[i]= tempTrackInfo[i].ChannelId;
+		if(!_TrackSamplePackIds.empty())
+			_TrackSamplePackIds[i]= tempTrackInfo[i].TrackSamplePackId;
 	}
 
 	// clear the no more needed track map
@@ -27,6 +27,7 @@
 #include "nel/3d/track.h"
 #include "nel/3d/animatable.h"
 #include "nel/3d/skeleton_weight.h"
+#include "nel/3d/track_sampled_quat_small_header.h"
 #include "nel/misc/debug.h"
 #include "nel/misc/common.h"
 #include "nel/misc/hierarchical_timer.h"
@@ -85,10 +86,41 @@ const CAnimationSet* CChannelMixer::getAnimationSet () const
 // ***************************************************************************
 // Temp Data
 static CAnimatedValueBlock	TempAnimatedValueBlock;
+static std::vector<uint32>	TempPackedTrackIds;
+static std::vector<CQuat>	TempPackedValues[CChannelMixer::NumAnimationSlot];
 
 
 // ***************************************************************************
-void CChannelMixer::evalSingleChannel(CChannel &chan, uint numActive, uint activeSlot[NumAnimationSlot])
+const CQuat	*CChannelMixer::evalPackedTracks (uint slot, CChannel **channels, uint numChannels, bool blendWithSlot)
+{
+	CTrackSamplePack	*pack= _SlotArray[slot]._Animation->getTrackSamplePack();
+	if(!pack)
+		return NULL;
+
+	// Get the packed tracks to eval, with the same tests as when the channels are evaluated
+	float	slotWeight= blendWithSlot ? _SlotArray[slot]._Weight : 1.f;
+	TempPackedTrackIds.clear();
+	for(uint i=0; i<numChannels; i++)
+	{
+		CChannel	&chan= *channels[i];
+		if(chan._Object && chan._TrackSamplePackIds[slot]!=CAnimation::NotFound && chan._Weights[slot]*slotWeight!=0.0f)
+			TempPackedTrackIds.push_back(chan._TrackSamplePackIds[slot]);
+	}
+	if(TempPackedTrackIds.empty())
+		return NULL;
+
+	// Eval them at once
+	std::vector<CQuat>	&values= TempPackedValues[slot];
+	if(values.size()<TempPackedTrackIds.size())
+		values.resize(TempPackedTrackIds.size());
+	pack->evalTracks(_SlotArray[slot]._Time, &TempPackedTrackIds[0], TempPackedTrackIds.size(), &values[0]);
+
+	return &values[0];
+}
+
+
+// ***************************************************************************
+void CChannelMixer::evalSingleChannel(CChannel &chan, uint numActive, uint activeSlot[NumAnimationSlot], const CQuat *packedValues[NumAnimationSlot])
 {
 	// If the refPtr of the object handled has been deleted, then no-op
 	if(!chan._Object)
@@ -116,8 +148,16 @@ void CChannelMixer::evalSingleChannel(CChannel &chan, uint numActive, uint activ
 
 		if(blend!=0.0f)
 		{
-			// Eval the track at this time
-			const IAnimatedValue	&trackResult= ((ITrack*)chan._Tracks[slot])->eval (_SlotArray[slot]._Time, TempAnimatedValueBlock);
+			// Eval the track at this time, or get it if already evaluated with the packed tracks of the slot
+			const IAnimatedValue	*trackResultPtr;
+			if(packedValues && packedValues[slot] && chan._TrackSamplePackIds[slot]!=CAnimation::NotFound)
+			{
+				TempAnimatedValueBlock.ValQuat.Value= *(packedValues[slot]++);
+				trackResultPtr= &TempAnimatedValueBlock.ValQuat;
+			}
+			else
+				trackResultPtr= &((ITrack*)chan._Tracks[slot])->eval (_SlotArray[slot]._Time, TempAnimatedValueBlock);
+			const IAnimatedValue	&trackResult= *trackResultPtr;
 
 			// First track to be eval ?
 			if (bFirst)
@@ -233,6 +273,9 @@ void CChannelMixer::eval (bool detail, uint64 evalDetailDate)
 		// Slot time
 		TAnimationTime	slotTime= _SlotArray[slot]._Time;
 
+		// Eval at once the packed tracks
+		const CQuat	*packedValues= evalPackedTracks(slot, channelArrayPtr, numChans, false);
+
 		// For all channels
 		for(;numChans>0; numChans--, channelArrayPtr++)
 		{
@@ -248,7 +291,13 @@ void CChannelMixer::eval (bool detail, uint64 evalDetailDate)
 			if(chan._Weights[slot]!=0.0f)
 			{
 				// Eval the track and copy the interpolated value. HTimer: 1.4%
-				chan._Value->affect (((ITrack*)chan._Tracks[slot])->eval (slotTime, TempAnimatedValueBlock));
+				if(packedValues && chan._TrackSamplePackIds[slot]!=CAnimation::NotFound)
+				{
+					TempAnimatedValueBlock.ValQuat.Value= *(packedValues++);
+					chan._Value->affect (TempAnimatedValueBlock.ValQuat);
+				}
+				else
+					chan._Value->affect (((ITrack*)chan._Tracks[slot])->eval (slotTime, TempAnimatedValueBlock));
 
 				// Touch the animated value and its owner to recompute them later. HTimer: 0.6%
 				chan._Object->touch (chan._ValueId, chan._OwnerValueId);
@@ -258,10 +307,15 @@ void CChannelMixer::eval (bool detail, uint64 evalDetailDate)
 	// little bit slower Blend version
 	else
 	{
+		// Eval at once the packed tracks of each slot
+		const CQuat	*packedValues[NumAnimationSlot];
+		for (uint a=0; a<numActive; a++)
+			packedValues[activeSlot[a]]= evalPackedTracks(activeSlot[a], channelArrayPtr, numChans, true);
+
 		// For all channels
 		for(;numChans>0; numChans--, channelArrayPtr++)
 		{
-			evalSingleChannel(**channelArrayPtr, numActive, activeSlot);
+			evalSingleChannel(**channelArrayPtr, numActive, activeSlot, packedValues);
 		}
 	}
 }
@@ -309,7 +363,7 @@ void CChannelMixer::evalChannels(sint *channelIdArray, uint numID)
 		std::map<uint, CChannel>::iterator it = _Channels.find(channelIdArray[k]);
 		if (it != _Channels.end())
 		{
-			evalSingleChannel(it->second, numActive, activeSlot);
+			evalSingleChannel(it->second, numActive, activeSlot, NULL);
 		}
 	}
 }
@@ -368,6 +422,7 @@ sint CChannelMixer::addChannel (const string& channelName, IAnimatable* animatab
 		{
 			entry._Weights[s]= 1.0f;
 			entry._Tracks[s]= entry._DefaultTracks;
+			entry._TrackSamplePackIds[s]= CAnimation::NotFound;
 		}
 
 		// add (if not already done) the entry in the map.
@@ -693,6 +748,7 @@ void CChannelMixer::refreshList ()
 			{
 				// Set the track
 				channel._Tracks[addSlot[s]]=_SlotArray[addSlot[s]]._Animation->getTrack (iDTrack);
+				channel._TrackSamplePackIds[addSlot[s]]=_SlotArray[addSlot[s]]._Animation->getTrackSamplePackId (iDTrack);
 
 				// Add this channel to the list
 				add=true;
@@ -701,6 +757,7 @@ void CChannelMixer::refreshList ()
 			{
 				// Set the default track
 				channel._Tracks[addSlot[s]]=channel._DefaultTracks;
+				channel._TrackSamplePackIds[addSlot[s]]=CAnimation::NotFound;
 			}
 		}
 
@@ -41,6 +41,10 @@
 #include "nel/3d/skeleton_model.h"
 #include "nel/misc/fast_floor.h"
 
+#ifdef NL_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace NLMISC;
 
@@ -49,22 +53,55 @@ namespace	NL3D
 {
 
 
+// ***************************************************************************
+// Batches are split in chunks of this number of spheres, shared between the clip threads.
+#define	NL3D_CLIP_CHUNK_SIZE			1024
+// Under this number of spheres, the calling thread clips them alone.
+#define	NL3D_CLIP_PARALLEL_MIN_SPHERES	4096
+
+
+// ***************************************************************************
+/**
+ * A job of the sphere batch clip, run by the worker pool : it helps the calling thread of clipSphereBatches()
+ * to clip the chunks.
+ */
+class CClipTrav::CClipJob : public IWorkerJob
+{
+public:
+	CClipJob(CClipTrav *clipTrav) : _ClipTrav(clipTrav) {}
+
+	virtual void	run()
+	{
+		_ClipTrav->clipChunks();
+	}
+
+private:
+	CClipTrav		*_ClipTrav;
+};
+
+
 // ***************************************************************************
 CClipTrav::CClipTrav() : ViewPyramid(6), WorldPyramid(6)
 {
 	_VisibleList.resize(1024);
 	_CurrentNumVisibleModels= 0;
 	CurrentDate = 0;
+	ClusterSystemDate = 0;
 	Accel.create (64, 16.0f);
 
 	ForceNoFrustumClip= false;
 	_QuadGridClipManager= NULL;
 	_TrackClusterVisibility= false;
+
+	_NumChunksToClip= 0;
+	_NextChunkToClip= 0;
 }
 
 // ***************************************************************************
 CClipTrav::~CClipTrav()
 {
+	// release the clip jobs
+	enableParallelClip(0);
 }
 
 // ***************************************************************************
@@ -474,6 +511,154 @@ void CClipTrav::traverse()
 }
 
 
+// ***************************************************************************
+void CClipTrav::clipSpheres(const CPlane *planes, uint numPlanes, const CBSphere *spheres, uint numSpheres, uint8 *visible)
+{
+	uint	i= 0;
+
+#ifdef NL_HAS_SSE2
+	// A CBSphere is (x, y, z, r): 4 spheres are loaded in 4 registers, then transposed.
+	nlctassert(sizeof(CBSphere)==4*sizeof(float));
+	for(;i+4<=numSpheres;i+=4)
+	{
+		__m128	x= _mm_loadu_ps(&spheres[i].Center.x);
+		__m128	y= _mm_loadu_ps(&spheres[i+1].Center.x);
+		__m128	z= _mm_loadu_ps(&spheres[i+2].Center.x);
+		__m128	r= _mm_loadu_ps(&spheres[i+3].Center.x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+
+		// if out of only one plane, entirely out.
+		__m128	out= _mm_setzero_ps();
+		for(uint p=0;p<numPlanes;p++)
+		{
+			const CPlane	&plane= planes[p];
+			// Same operations, in the same order, than CPlane::operator*(CVector): results are the same than the scalar code.
+			__m128	d= _mm_mul_ps(_mm_set1_ps(plane.a), x);
+			d= _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.b), y));
+			d= _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.c), z));
+			d= _mm_add_ps(d, _mm_set1_ps(plane.d));
+			out= _mm_or_ps(out, _mm_cmpgt_ps(d, r));
+		}
+		uint	outMask= _mm_movemask_ps(out);
+		visible[i]=   (uint8)((~outMask)&1);
+		visible[i+1]= (uint8)((~outMask>>1)&1);
+		visible[i+2]= (uint8)((~outMask>>2)&1);
+		visible[i+3]= (uint8)((~outMask>>3)&1);
+	}
+#endif
+
+	for(;i<numSpheres;i++)
+	{
+		const CBSphere	&sphere= spheres[i];
+		visible[i]= 1;
+		for(uint p=0;p<numPlanes;p++)
+		{
+			// if SpherMax OUT return false.
+			float	d= planes[p]*sphere.Center;
+			if(d>sphere.Radius)
+			{
+				visible[i]= 0;
+				break;
+			}
+		}
+	}
+}
+
+
+// ***************************************************************************
+void CClipTrav::clipSphereBatches(const std::vector<CSphereClipBatch> &batches)
+{
+	H_AUTO( NL3D_TravClip_SphereBatches );
+
+	if(batches.empty() || WorldPyramid.empty())
+	{
+		// nothing to clip against: all visible.
+		for(uint i=0;i<batches.size();i++)
+			memset(batches[i].Visible, 1, batches[i].NumSpheres);
+		return;
+	}
+
+	// split the batches in chunks
+	_ClipChunks.clear();
+	uint	numSpheres= 0;
+	for(uint i=0;i<batches.size();i++)
+	{
+		const CSphereClipBatch	&batch= batches[i];
+		numSpheres+= batch.NumSpheres;
+		for(uint first=0;first<batch.NumSpheres;first+=NL3D_CLIP_CHUNK_SIZE)
+		{
+			CSphereClipBatch	chunk;
+			chunk.Spheres= batch.Spheres + first;
+			chunk.Visible= batch.Visible + first;
+			chunk.NumSpheres= min((uint)NL3D_CLIP_CHUNK_SIZE, batch.NumSpheres - first);
+			_ClipChunks.push_back(chunk);
+		}
+	}
+	const uint	numChunks= _ClipChunks.size();
+
+	// publish the chunks to the jobs, if worth it
+	_ClipMutex.enter();
+	_NumChunksToClip= numChunks;
+	_NextChunkToClip= 0;
+	_ClipMutex.leave();
+	bool	parallel= numSpheres>=NL3D_CLIP_PARALLEL_MIN_SPHERES && !_ClipJobs.empty();
+	if(parallel)
+	{
+		CWorkerPool	&workerPool= CWorkerPool::getInstance();
+		for(uint k=0;k<_ClipJobs.size();k++)
+			workerPool.addJob(_ClipJobs[k], _ClipGroup);
+	}
+
+	// help them
+	clipChunks();
+
+	// then wait for the chunks claimed by the jobs
+	if(parallel)
+		CWorkerPool::getInstance().wait(_ClipGroup);
+}
+
+
+// ***************************************************************************
+void CClipTrav::clipChunks()
+{
+	const CPlane	*planes= &WorldPyramid[0];
+	uint			numPlanes= WorldPyramid.size();
+	for(;;)
+	{
+		// claim the next chunk
+		_ClipMutex.enter();
+		if(_NextChunkToClip>=_NumChunksToClip)
+		{
+			_ClipMutex.leave();
+			return;
+		}
+		const CSphereClipBatch	&chunk= _ClipChunks[_NextChunkToClip++];
+		_ClipMutex.leave();
+
+		clipSpheres(planes, numPlanes, chunk.Spheres, chunk.NumSpheres, chunk.Visible);
+	}
+}
+
+
+// ***************************************************************************
+void CClipTrav::enableParallelClip(uint numThreads)
+{
+	if(numThreads==_ClipJobs.size())
+		return;
+
+	// NB: not called during clipSphereBatches(), the jobs are not in the pool.
+	uint	k;
+	for(k=0;k<_ClipJobs.size();k++)
+		delete _ClipJobs[k];
+	_ClipJobs.clear();
+
+	for(k=0;k<numThreads;k++)
+		_ClipJobs.push_back(new CClipJob(this));
+	if(numThreads)
+		CWorkerPool::getInstance().reserveThreads(numThreads);
+}
+
+
 // ***************************************************************************
 void CClipTrav::setQuadGridClipManager(CQuadGridClipManager *mgr)
 {
@@ -484,6 +669,7 @@ void CClipTrav::setQuadGridClipManager(CQuadGridClipManager *mgr)
 void CClipTrav::registerCluster (CCluster* pCluster)
 {
 	pCluster->AccelIt = Accel.insert (pCluster->getBBox().getMin(), pCluster->getBBox().getMax(), pCluster);
+	++ClusterSystemDate;
 }
 
 // ***************************************************************************
@@ -493,6 +679,7 @@ void CClipTrav::unregisterCluster (CCluster* pCluster)
 		return;
 
 	Accel.erase(pCluster->AccelIt);
+	++ClusterSystemDate;
 
 	// just ensure it point to NULL
 	pCluster->AccelIt= CQuadGrid<CCluster*>::CIterator();
@@ -171,6 +171,29 @@ const char	*EBadBind::what() const throw()
 }
 
 
+// ***************************************************************************
+/**
+ * The refine of the async refine mode, run by the CWorkerPool between startAsyncRefine() and waitAsyncRefine().
+ */
+class CLandscape::CAsyncRefineJob : public IWorkerJob
+{
+public:
+	CAsyncRefineJob(CLandscape *landscape) : _Landscape(landscape) {}
+
+	virtual void	run()
+	{
+		_Landscape->refineTesselation(_Landscape->_AsyncRefineCenter);
+	}
+
+private:
+	CLandscape		*_Landscape;
+};
+
+
+// ***************************************************************************
+CLandscape		*CLandscape::_AsyncRefineLandscape= NULL;
+
+
 // ***************************************************************************
 // Init BlockAllcoator with standard BlockMemory.
 CLandscape::CLandscape() :
@@ -269,6 +292,13 @@ CLandscape::CLandscape() :
 
 	_LockCount = 0;
 
+	// No async refine by default.
+	_AsyncRefineJob= NULL;
+	_AsyncRefineEnabled= false;
+	_AsyncRefineRunning= false;
+	_AsyncRefineDone= false;
+	_AsyncRefineCenter= CVector::Null;
+
 	_TextureTileCategory= new ITexture::CTextureCategory("LANDSCAPE TILES");
 	_TextureFarCategory= new ITexture::CTextureCategory("LANDSCAPE FAR");
 	_TextureNearCategory= new ITexture::CTextureCategory("LANDSCAPE LIGHTMAP NEAR");
@@ -277,6 +307,9 @@ CLandscape::CLandscape() :
 // ***************************************************************************
 CLandscape::~CLandscape()
 {
+	// stop the worker before anything else.
+	enableAsyncRefine(false);
+
 	clear();
 
 	// release the VegetableManager.
@@ -324,6 +357,8 @@ void			CLandscape::init()
 // ***************************************************************************
 void			CLandscape::setThreshold (float thre)
 {
+	waitAsyncRefine();
+
 	thre= max(thre, 0.f);
 	if(thre != _Threshold)
 	{
@@ -338,6 +373,8 @@ void			CLandscape::setThreshold (float thre)
 // ***************************************************************************
 void			CLandscape::setTileNear (float tileNear)
 {
+	waitAsyncRefine();
+
 	tileNear= max(tileNear, _FarTransition);
 
 	if(tileNear!=_TileDistNear)
@@ -354,6 +391,8 @@ void			CLandscape::setTileNear (float tileNear)
 // ***************************************************************************
 void			CLandscape::setTileMaxSubdivision (uint tileDiv)
 {
+	waitAsyncRefine();
+
 	nlassert(tileDiv<=4);
 
 	if(tileDiv!=_TileMaxSubdivision)
@@ -532,6 +571,8 @@ void			CLandscape::buildZoneName(sint zoneId, std::string &zoneName)
 // ***************************************************************************
 void			CLandscape::clear()
 {
+	waitAsyncRefine();
+
 	// Build the list of zoneId.
 	vector<uint16>	zoneIds;
 	getZoneList(zoneIds);
@@ -613,8 +654,10 @@ void			CLandscape::clip(const CVector &refineCenter, const std::vector<CPlane>	&
 	updateTessBlocksFaceVector();
 
 }
+
+
 // ***************************************************************************
-void			CLandscape::refine(const CVector &refineCenter)
+static inline void	resetRefineProfile()
 {
 	NL3D_PROFILE_LAND_SET(ProfNRefineFaces, 0);
 	NL3D_PROFILE_LAND_SET(ProfNRefineComputeFaces, 0);
@@ -624,9 +667,53 @@ void			CLandscape::refine(const CVector &refineCenter)
 	NL3D_PROFILE_LAND_SET(ProfNRefineInTileTransition, 0);
 	NL3D_PROFILE_LAND_SET(ProfNRefineWithLowDistance, 0);
 	NL3D_PROFILE_LAND_SET(ProfNSplitsPass, 0);
+}
+
+// ***************************************************************************
+void			CLandscape::refine(const CVector &refineCenter)
+{
+	// In async mode, the refine of this frame has been computed by the worker during the previous frame.
+	if(_AsyncRefineEnabled)
+	{
+		waitAsyncRefine();
+		if(_AsyncRefineDone)
+		{
+			// Just commit it. NB: _AsyncRefineDone is false at first frame, or if the worker was not started
+			// (eg: RefineMode was false). In this case, do a synchronous refine.
+			_AsyncRefineDone= false;
+			return;
+		}
+	}
 
 	if(!_RefineMode)
+	{
+		resetRefineProfile();
 		return;
+	}
+
+	// Update globals
+	updateGlobalsAndLockBuffers (refineCenter);
+	// NB: refine may change vertices in VB in visible patchs => buffers are locked.
+
+	// Update the priority lists and refine faces which may need it.
+	refineTesselation(refineCenter);
+
+	// Before unlockBuffers, test for vegetable IG creation.
+	refineVegetables(refineCenter);
+
+	// Must realase VB Buffers
+	unlockBuffers();
+
+	// refine() may cause change in faces in visible patchs.
+	updateTessBlocksFaceVector();
+
+}
+
+
+// ***************************************************************************
+void			CLandscape::refineTesselation(const CVector &refineCenter)
+{
+	resetRefineProfile();
 
 	// Update the priority list.
 	// ==========================
@@ -656,10 +743,6 @@ void			CLandscape::refine(const CVector &refineCenter)
 
 	// Refine Faces which may need it.
 	// ==========================
-	// Update globals
-	updateGlobalsAndLockBuffers (refineCenter);
-	// NB: refine may change vertices in VB in visible patchs => buffers are locked.
-
 	// Increment the update date.
 	CLandscapeGlobals::CurrentDate++;
 
@@ -712,36 +795,29 @@ void			CLandscape::refine(const CVector &refineCenter)
 
 	// Because CTessFacePriorityList::insert use it.
 	NLMISC::OptFastFloorEnd();
+}
 
 
-	// Before unlockBuffers, test for vegetable IG creation.
-	{
-		H_AUTO( NL3D_Vegetable_Update );
-
-		// Because CLandscapeVegetableBlock::update() use OptFastFloor..
-		NLMISC::OptFastFloorBegin();
-
-		// For each vegetableBlock, test IG creation
-		CLandscapeVegetableBlock	*vegetBlock= _VegetableBlockList.begin();
-		for(;vegetBlock!=NULL; vegetBlock= (CLandscapeVegetableBlock*)vegetBlock->Next)
-		{
-			vegetBlock->update(refineCenter, _VegetableManager);
-		}
+// ***************************************************************************
+void			CLandscape::refineVegetables(const CVector &refineCenter)
+{
+	H_AUTO( NL3D_Vegetable_Update );
 
-		// update lighting for vegetables
-		_VegetableManager->updateLighting();
+	// Because CLandscapeVegetableBlock::update() use OptFastFloor..
+	NLMISC::OptFastFloorBegin();
 
-		// Stop fastFloor optim.
-		NLMISC::OptFastFloorEnd();
+	// For each vegetableBlock, test IG creation
+	CLandscapeVegetableBlock	*vegetBlock= _VegetableBlockList.begin();
+	for(;vegetBlock!=NULL; vegetBlock= (CLandscapeVegetableBlock*)vegetBlock->Next)
+	{
+		vegetBlock->update(refineCenter, _VegetableManager);
 	}
 
+	// update lighting for vegetables
+	_VegetableManager->updateLighting();
 
-	// Must realase VB Buffers
-	unlockBuffers();
-
-	// refine() may cause change in faces in visible patchs.
-	updateTessBlocksFaceVector();
-
+	// Stop fastFloor optim.
+	NLMISC::OptFastFloorEnd();
 }
 
 
@@ -807,9 +883,102 @@ void			CLandscape::averageTesselationVertices()
 
 
 
+// ***************************************************************************
+void			CLandscape::enableAsyncRefine(bool enable)
+{
+	if(enable==_AsyncRefineEnabled)
+		return;
+
+	if(enable)
+	{
+		// The globals can be used by only one worker.
+		if(_AsyncRefineLandscape)
+		{
+			nlwarning("CLandscape::enableAsyncRefine: another landscape is already in async refine mode");
+			return;
+		}
+		_AsyncRefineLandscape= this;
+		_AsyncRefineJob= new CAsyncRefineJob(this);
+		CWorkerPool::getInstance().reserveThreads(1);
+	}
+	else
+	{
+		// commit the pending refine, if any
+		waitAsyncRefine();
+		_AsyncRefineDone= false;
+
+		delete _AsyncRefineJob;
+		_AsyncRefineJob= NULL;
+		_AsyncRefineLandscape= NULL;
+	}
+	_AsyncRefineEnabled= enable;
+
+	// VBs are locked during the whole frame in async mode: don't let the GPU read them directly.
+	CVertexBuffer::TPreferredMemory		vbMemory= enable?CVertexBuffer::RAMPreferred:CVertexBuffer::AGPPreferred;
+	_Far0VB.setPreferredMemory(vbMemory);
+	_Far1VB.setPreferredMemory(vbMemory);
+	_TileVB.setPreferredMemory(vbMemory);
+}
+
+
+// ***************************************************************************
+void			CLandscape::startAsyncRefine(const CVector &refineCenter)
+{
+	if(!_AsyncRefineEnabled || !_RefineMode)
+		return;
+
+	// commit the previous one (should not happen if refine() has been called in between).
+	waitAsyncRefine();
+
+	// Update globals and lock buffers here, because the driver may be involved.
+	updateGlobalsAndLockBuffers (refineCenter);
+
+	// then run the refine in the worker. The buffers remain locked until waitAsyncRefine().
+	_AsyncRefineCenter= refineCenter;
+	_AsyncRefineRunning= true;
+	CWorkerPool::getInstance().addJob(_AsyncRefineJob, _AsyncRefineGroup);
+}
+
+
+// ***************************************************************************
+void			CLandscape::waitAsyncRefine()
+{
+	if(!_AsyncRefineRunning)
+		return;
+
+	H_AUTO( NL3D_Landscape_WaitAsyncRefine );
+
+	// NB: if the pool has not started the refine yet, it is done here.
+	CWorkerPool::getInstance().wait(_AsyncRefineGroup);
+	_AsyncRefineRunning= false;
+
+	// The vegetable part is not thread safe, do it now. Globals are still those setuped in startAsyncRefine().
+	refineVegetables(_AsyncRefineCenter);
+
+	// release the VB Buffers locked in startAsyncRefine().
+	unlockBuffers();
+
+	// refine() may cause change in faces in visible patchs.
+	updateTessBlocksFaceVector();
+
+	_AsyncRefineDone= true;
+}
+
+
+// ***************************************************************************
+void			CLandscape::waitAsyncRefineGlobals()
+{
+	if(_AsyncRefineLandscape)
+		_AsyncRefineLandscape->waitAsyncRefine();
+}
+
+
 // ***************************************************************************
 void			CLandscape::updateGlobalsAndLockBuffers (const CVector &refineCenter)
 {
+	// Globals are used by the async refine, wait for it.
+	waitAsyncRefineGlobals();
+
 	// Setup CLandscapeGlobals static members...
 
 	// Far limits.
@@ -862,6 +1031,9 @@ void			CLandscape::updateGlobalsAndLockBuffers (const CVector &refineCenter)
 // ***************************************************************************
 void			CLandscape::lockBuffers ()
 {
+	// the buffers may be locked by the async refine, and it uses CLandscapeGlobals::VertexProgramEnabled: commit it first.
+	waitAsyncRefineGlobals();
+
 	// Already locked
 	if ((_LockCount++) == 0)
 	{
@@ -1031,6 +1203,9 @@ void			CLandscape::render(const CVector &refineCenter, const CVector &frontVecto
 		}
 	}
 
+	// Globals are used by the async refine, wait for it.
+	waitAsyncRefineGlobals();
+
 	// Increment the update date for preRender.
 	CLandscapeGlobals::CurrentRenderDate++;
 
@@ -2020,6 +2195,8 @@ CTileElement *CLandscape::getTileElement(const CPatchIdent &patchId, const CUV &
 // ***************************************************************************
 void			CLandscape::flushTiles(IDriver *drv, uint32 tileStart, uint32 nbTiles)
 {
+	waitAsyncRefine();
+
 	nlassert(nbTiles<=65536);
 	nlassert(tileStart+nbTiles<=65536);
 
@@ -2060,6 +2237,8 @@ void			CLandscape::flushTiles(IDriver *drv, uint32 tileStart, uint32 nbTiles)
 // ***************************************************************************
 void			CLandscape::releaseTiles(uint32 tileStart, uint32 nbTiles)
 {
+	waitAsyncRefine();
+
 	nlassert(nbTiles<=65536);
 	nlassert(tileStart+nbTiles<=65536);
 
@@ -2649,6 +2828,9 @@ void			CLandscape::buildCollideFaces(sint zoneId, sint patch, std::vector<CTrian
 // ***************************************************************************
 CVector			CLandscape::getTesselatedPos(const CPatchIdent &patchId, const CUV &uv) const
 {
+	// globals and tesselation are used by the async refine.
+	waitAsyncRefineGlobals();
+
 	// First, must update globals, for CTessFace::computeTesselatedPos() to work properly.
 
 	// VertexProgrma mode???
@@ -3052,6 +3234,8 @@ void		CLandscape::setHeightField(const CHeightMap &hf)
 // ***************************************************************************
 void		CLandscape::getTessellationLeaves(std::vector<const CTessFace*>  &leaves) const
 {
+	const_cast<CLandscape*>(this)->waitAsyncRefine();
+
 	leaves.clear();
 
 	std::map<uint16, CZone*>::const_iterator	it;
@@ -3253,6 +3437,8 @@ void				CLandscape::deleteTileFace(CTileFace *tf)
 // ***************************************************************************
 void			CLandscape::setNoiseMode(bool enable)
 {
+	waitAsyncRefine();
+
 	_NoiseEnabled= enable;
 }
 
@@ -3273,6 +3459,8 @@ bool			CLandscape::getNoiseMode() const
 // ***************************************************************************
 void		CLandscape::enableVegetable(bool enable)
 {
+	waitAsyncRefine();
+
 	_VegetableManagerEnabled= enable;
 
 	// if false, delete all Vegetable IGs.
@@ -3391,6 +3579,8 @@ void		CLandscape::setVegetableUpdateLightingFrequency(float freq)
 // ***************************************************************************
 void		CLandscape::setupColorsFromTileFlags(const NLMISC::CRGBA colors[4])
 {
+	waitAsyncRefine();
+
 	for (TZoneMap::iterator it = Zones.begin(); it != Zones.end(); ++it)
 	{
 		it->second->setupColorsFromTileFlags(colors);
@@ -3484,6 +3674,8 @@ void		CLandscape::appendTileLightInfluences(const CPatchIdent &patchId, const CU
 // ***************************************************************************
 void			CLandscape::removeAllPointLights()
 {
+	waitAsyncRefine();
+
 	for(ItZoneMap it= Zones.begin();it!=Zones.end();it++)
 	{
 		// for all patch.
@@ -3543,6 +3735,8 @@ void			CLandscape::updateLighting(double time)
 // ***************************************************************************
 void			CLandscape::updateLightingAll()
 {
+	waitAsyncRefine();
+
 	// Do it for near and far in 2 distinct ways.
 	//================
 	updateLightingTextureFar(1);
@@ -3862,6 +4056,9 @@ void			CLandscape::receiveShadowMap(IDriver *drv, CShadowMap *shadowMap, const C
 		1/ On NVidia, even with a simple matrix mul VP, the precision result is not the same
 		2/ Our Landscape VP is not a simple matrix mul. Lot of vertex mul/add are done fpr geomorphs
 	*/
+	// the ShadowPolyReceiver is modified by the refine.
+	waitAsyncRefine();
+
 	CMaterial	&sm= const_cast<CMaterial&>(shadowMat);
 	float	oldZBias= sm.getZBias();
 	sm.setZBias(-0.02f);
@@ -3899,6 +4096,7 @@ void CLandscape::invalidateAllTiles()
 // ***************************************************************************
 float CLandscape::getCameraCollision(const CVector &start, const CVector &end, float radius, bool cone)
 {
+	waitAsyncRefine();
 	return _ShadowPolyReceiver.getCameraCollision(start, end,
 		cone?CShadowPolyReceiver::CameraColCone:CShadowPolyReceiver::CameraColCylinder, radius);
 }
@@ -3906,6 +4104,7 @@ float CLandscape::getCameraCollision(const CVector &start, const CVector &end, f
 // ***************************************************************************
 float CLandscape::getRayCollision(const CVector &start, const CVector &end)
 {
+	waitAsyncRefine();
 	return _ShadowPolyReceiver.getCameraCollision(start, end,
 		CShadowPolyReceiver::CameraColSimpleRay, 0.f);
 }
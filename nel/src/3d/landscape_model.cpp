@@ -161,6 +161,9 @@ void	CLandscapeModel::clipAndRenderLandscape()
 	// The real Landscape clip is done here, after std clip
 	H_AUTO( NL3D_Landscape_Clip );
 
+	// In async refine mode, commit the refine computed during the previous frame. Buffers are unlocked.
+	Landscape.waitAsyncRefine();
+
 	// Should be unlocked
 	nlassert (!Landscape.isLocked());
 
@@ -253,6 +256,13 @@ void	CLandscapeModel::clipAndRenderLandscape()
 
 	// Should be unlocked by render
 	nlassert (!Landscape.isLocked());
+
+	// In async refine mode, compute the refine of the next frame while the rest of the scene is processed.
+	if(Landscape.isAsyncRefineEnabled())
+	{
+		H_AUTO( NL3D_Landscape_StartAsyncRefine );
+		Landscape.startAsyncRefine(refineCenter);
+	}
 }
 
 // ***************************************************************************
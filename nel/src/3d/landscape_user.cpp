@@ -396,6 +396,18 @@ void	CLandscapeUser::setTileMaxSubdivision (uint tileDiv)
 	_Landscape->Landscape.setTileMaxSubdivision(tileDiv);
 }
 //****************************************************************************
+void	CLandscapeUser::enableAsyncRefine(bool enable)
+{
+	NL3D_HAUTO_UI_LANDSCAPE;
+	_Landscape->Landscape.enableAsyncRefine(enable);
+}
+//****************************************************************************
+bool	CLandscapeUser::isAsyncRefineEnabled() const
+{
+	NL3D_HAUTO_UI_LANDSCAPE;
+	return _Landscape->Landscape.isAsyncRefineEnabled();
+}
+//****************************************************************************
 uint	CLandscapeUser::getTileMaxSubdivision ()
 {
 	NL3D_HAUTO_UI_LANDSCAPE;
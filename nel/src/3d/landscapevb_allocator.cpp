@@ -60,6 +60,7 @@ CLandscapeVBAllocator::CLandscapeVBAllocator(TType type, const std::string &vbNa
 	_ReallocationOccur= false;
 	_NumVerticesAllocated= 0;
 	_BufferLocked= false;
+	_PreferredMemory= CVertexBuffer::AGPPreferred;
 	_LastFarVB = NULL;
 	_LastNearVB = NULL;
 
@@ -117,6 +118,23 @@ void			CLandscapeVBAllocator::clear()
 }
 
 
+// ***************************************************************************
+void			CLandscapeVBAllocator::setPreferredMemory(CVertexBuffer::TPreferredMemory preferredMemory)
+{
+	if(preferredMemory!=_PreferredMemory)
+	{
+		_PreferredMemory= preferredMemory;
+
+		// must reallocate the VertexBuffer in the new memory.
+		if( _Driver && _NumVerticesAllocated>0 )
+		{
+			deleteVertexBuffer();
+			allocateVertexBuffer(_NumVerticesAllocated);
+		}
+	}
+}
+
+
 
 // ***************************************************************************
 void			CLandscapeVBAllocator::resetReallocation()
@@ -288,7 +306,7 @@ void				CLandscapeVBAllocator::allocateVertexBuffer(uint32 numVertices)
 	unlockBuffer();
 
 	// This always works.
-	_VB.setPreferredMemory(CVertexBuffer::AGPPreferred, false);
+	_VB.setPreferredMemory(_PreferredMemory, false);
 	_VB.setNumVertices(numVertices);
 	_VB.setName (_VBName);
 }
@@ -525,6 +525,15 @@ bool	CMeshGeom::clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMat
 	return true;
 }
 
+
+// ***************************************************************************
+bool	CMeshGeom::getClipSphere(CBSphere &localSphere) const
+{
+	localSphere.Center= _BBox.getCenter();
+	localSphere.Radius= _BBox.getRadius();
+	return true;
+}
+
 // ***************************************************************************
 void	CMeshGeom::render(IDriver *drv, CTransformShape *trans, float polygonCount, uint32 rdrFlags, float globalAlpha)
 {
@@ -2589,6 +2598,13 @@ bool	CMesh::clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatrix)
 }
 
 
+// ***************************************************************************
+bool	CMesh::getClipSphere(CBSphere &localSphere) const
+{
+	return _MeshGeom->getClipSphere(localSphere);
+}
+
+
 // ***************************************************************************
 void	CMesh::render(IDriver *drv, CTransformShape *trans, bool passOpaque)
 {
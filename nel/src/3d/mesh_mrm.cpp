@@ -874,6 +874,15 @@ bool	CMeshMRMGeom::clip(const std::vector<CPlane>	&pyramid, const CMatrix &world
 }
 
 
+// ***************************************************************************
+bool	CMeshMRMGeom::getClipSphere(CBSphere &localSphere) const
+{
+	localSphere.Center= _BBox.getCenter();
+	localSphere.Radius= _BBox.getRadius();
+	return true;
+}
+
+
 // ***************************************************************************
 inline sint	CMeshMRMGeom::chooseLod(float alphaMRM, float &alphaLod)
 {
@@ -2957,6 +2966,13 @@ bool	CMeshMRM::clip(const std::vector<CPlane>	&pyramid, const CMatrix &worldMatr
 }
 
 
+// ***************************************************************************
+bool	CMeshMRM::getClipSphere(CBSphere &localSphere) const
+{
+	return _MeshMRMGeom.getClipSphere(localSphere);
+}
+
+
 // ***************************************************************************
 void	CMeshMRM::render(IDriver *drv, CTransformShape *trans, bool passOpaque)
 {
@@ -556,6 +556,15 @@ bool	CMeshMRMSkinnedGeom::clip(const std::vector<CPlane>	&pyramid, const CMatrix
 }
 
 
+// ***************************************************************************
+bool	CMeshMRMSkinnedGeom::getClipSphere(CBSphere &localSphere) const
+{
+	localSphere.Center= _BBox.getCenter();
+	localSphere.Radius= _BBox.getRadius();
+	return true;
+}
+
+
 // ***************************************************************************
 inline sint	CMeshMRMSkinnedGeom::chooseLod(float alphaMRM, float &alphaLod)
 {
@@ -1538,6 +1547,13 @@ bool	CMeshMRMSkinned::clip(const std::vector<CPlane>	&pyramid, const CMatrix &wo
 }
 
 
+// ***************************************************************************
+bool	CMeshMRMSkinned::getClipSphere(CBSphere &localSphere) const
+{
+	return _MeshMRMGeom.getClipSphere(localSphere);
+}
+
+
 // ***************************************************************************
 void	CMeshMRMSkinned::render(IDriver *drv, CTransformShape *trans, bool passOpaque)
 {
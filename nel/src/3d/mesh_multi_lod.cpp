@@ -227,6 +227,20 @@ bool CMeshMultiLod::clip(const std::vector<CPlane>	&pyramid, const CMatrix &worl
 	return true;
 }
 
+
+// ***************************************************************************
+bool CMeshMultiLod::getClipSphere(CBSphere &localSphere) const
+{
+	// Same mesh than clip()
+	uint meshCount=_MeshVector.size();
+	for (uint i=0; i<meshCount; i++)
+	{
+		if (_MeshVector[i].MeshGeom)
+			return _MeshVector[i].MeshGeom->getClipSphere(localSphere);
+	}
+	return false;
+}
+
 // ***************************************************************************
 
 void CMeshMultiLod::render(IDriver *drv, CTransformShape *trans, bool passOpaque)
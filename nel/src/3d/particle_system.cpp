@@ -34,10 +34,11 @@
 #include "nel/3d/nelu.h"
 #include "nel/3d/ps_util.h"
 #include "nel/3d/ps_particle.h"
+#include "nel/3d/ps_mesh.h"
 #include "nel/3d/ps_emitter.h"
 #include "nel/3d/ps_sound.h"
 #include "nel/3d/particle_system_shape.h"
-#include "nel/3d/ps_located.h"
+#include "nel/3d/ps_sim_buffers.h"
 #include "nel/misc/aabbox.h"
 #include "nel/misc/file.h"
 #include "nel/misc/stream.h"
@@ -64,14 +65,13 @@ CParticleSystem::TGlobalValuesMap			CParticleSystem::_GlobalValuesMap;
 CParticleSystem::TGlobalVectorValuesMap		CParticleSystem::_GlobalVectorValuesMap;
 
 // sim step infos
-TAnimationTime CParticleSystem::EllapsedTime = 0.f;
-TAnimationTime CParticleSystem::InverseTotalEllapsedTime = 0.f;
-TAnimationTime CParticleSystem::RealEllapsedTime = 0.f;
-float CParticleSystem::RealEllapsedTimeRatio = 1.f;
-bool CParticleSystem::InsideSimLoop = false;
-bool CParticleSystem::InsideRemoveLoop = false;
-bool CParticleSystem::InsideNewElementsLoop = false;;
-std::vector<NLMISC::CVector> CParticleSystem::_SpawnPos;
+NL_THREAD_LOCAL TAnimationTime CParticleSystem::EllapsedTime = 0.f;
+NL_THREAD_LOCAL TAnimationTime CParticleSystem::InverseTotalEllapsedTime = 0.f;
+NL_THREAD_LOCAL TAnimationTime CParticleSystem::RealEllapsedTime = 0.f;
+NL_THREAD_LOCAL float CParticleSystem::RealEllapsedTimeRatio = 1.f;
+NL_THREAD_LOCAL bool CParticleSystem::InsideSimLoop = false;
+NL_THREAD_LOCAL bool CParticleSystem::InsideRemoveLoop = false;
+NL_THREAD_LOCAL bool CParticleSystem::InsideNewElementsLoop = false;
 
 
 
@@ -90,7 +90,8 @@ static const float PS_MIN_TIMEOUT = 1.f; // the test that check if there are no
 	bool CParticleSystem::_SerialIdentifiers = false;
 #endif
 bool CParticleSystem::_ForceDisplayBBox = false;
-CParticleSystemModel *CParticleSystem::OwnerModel = NULL;
+NL_THREAD_LOCAL CParticleSystemModel *CParticleSystem::OwnerModel = NULL;
+NL_THREAD_LOCAL CPSSimBuffers *CPSSimBuffers::_Current = NULL;
 
 
 
@@ -157,7 +158,9 @@ CParticleSystem::CParticleSystem() : _Driver(NULL),
 									 _AutoComputeDelayBeforeDeathTest(true),
 									 _AutoCount(false),
 									 _HiddenAtCurrentFrame(true),
-									 _HiddenAtPreviousFrame(true)
+									 _HiddenAtPreviousFrame(true),
+									 _BindablesCanStepConcurrently(false),
+									 _BindablesTouched(true)
 
 {
 	NL_PS_FUNC_MAIN(CParticleSystem_CParticleSystem)
@@ -169,9 +172,6 @@ CParticleSystem::CParticleSystem() : _Driver(NULL),
 }
 
 
-std::vector<NLMISC::CSmartPtr<CParticleSystem::CSpawnVect> > CParticleSystem::_Spawns; // spawns for the current system being processed
-std::vector<uint> CParticleSystem::_ParticleToRemove;
-std::vector<sint> CParticleSystem::_ParticleRemoveListIndex;
 
 
 
@@ -608,14 +608,16 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 			// nodes sorted by degree
 			InsideSimLoop = true;
 			// make enough room for spawns
+			CPSSimBuffers &simBuffers = CPSSimBuffers::get();
+			std::vector<NLMISC::CSmartPtr<CSpawnVect> > &spawns = simBuffers.Spawns;
 			uint numProcess = _ProcessVect.size();
-			if (numProcess > _Spawns.size())
+			if (numProcess > spawns.size())
 			{
-				uint oldSize = _Spawns.size();
-				_Spawns.resize(numProcess);
+				uint oldSize = spawns.size();
+				spawns.resize(numProcess);
 				for(uint k = oldSize; k < numProcess; ++k)
 				{
-					_Spawns[k] = new CSpawnVect;
+					spawns[k] = new CSpawnVect;
 				}
 			}
 			for(uint k = 0; k < numProcess; ++k)
@@ -626,7 +628,7 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 				{
 					loc->doLODDegradation();
 				}
-				_Spawns[k]->MaxNumSpawns = loc->getMaxSize();
+				spawns[k]->MaxNumSpawns = loc->getMaxSize();
 			}
 			do
 			{
@@ -644,9 +646,9 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 				{
 					if (!_ProcessVect[shape._ProcessOrder[k]]->isLocated()) continue;
 					CPSLocated *loc = static_cast<CPSLocated *>(_ProcessVect[shape._ProcessOrder[k]]);
-					if (_ParticleRemoveListIndex.size() < loc->getMaxSize())
+					if (simBuffers.ParticleRemoveListIndex.size() < loc->getMaxSize())
 					{
-						_ParticleRemoveListIndex.resize(loc->getMaxSize(), -1);
+						simBuffers.ParticleRemoveListIndex.resize(loc->getMaxSize(), -1);
 					}
 					if (loc->getSize() != 0)
 					{
@@ -666,7 +668,7 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 						loc->computeSpawns(0, false);
 						if (loc->hasCollisionInfos()) loc->updateCollisions();
 						// Remove too old particles, making room for new ones
-						if (!_ParticleToRemove.empty())
+						if (!simBuffers.ParticleToRemove.empty())
 						{
 							loc->removeOldParticles();
 						}
@@ -674,7 +676,7 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 							loc->checkLife();
 						#endif
 					}
-					if (!_Spawns[shape._ProcessOrder[k]]->SpawnInfos.empty())
+					if (!spawns[shape._ProcessOrder[k]]->SpawnInfos.empty())
 					{
 						uint insertionIndex = loc->getSize(); // index at which new particles will be inserted
 						// add new particles that where posted by ancestor emitters, and also mark those that must already be deleted
@@ -690,7 +692,7 @@ void CParticleSystem::step(TPass pass, TAnimationTime ellapsedTime, CParticleSys
 							loc->computeSpawns(insertionIndex, true);
 							if (loc->hasCollisionInfos()) loc->updateCollisions();
 							// Remove too old particles among the newly created ones.
-							if (!_ParticleToRemove.empty())
+							if (!simBuffers.ParticleToRemove.empty())
 							{
 								loc->removeOldParticles();
 							}
@@ -803,6 +805,7 @@ void CParticleSystem::serial(NLMISC::IStream &f) throw(NLMISC::EStream)
 		_ProcessVect.clear();
 
 		f.serialContPolyPtr(_ProcessVect);
+		bindablesChanged();
 
 		_FontGenerator = NULL;
 		_FontManager = NULL;
@@ -1050,6 +1053,7 @@ bool CParticleSystem::attach(CParticleSystemProcess *ptr)
 	_ProcessVect.push_back(ptr);
 	ptr->setOwner(this);
 	ptr->setIndex(_ProcessVect.size() - 1);
+	bindablesChanged();
 	//notifyMaxNumFacesChanged();
 	if (getBypassMaxNumIntegrationSteps())
 	{
@@ -1073,6 +1077,7 @@ void CParticleSystem::remove(CParticleSystemProcess *ptr)
 	ptr->setOwner(NULL);
 	_ProcessVect.erase(it);
 	delete ptr;
+	bindablesChanged();
 	systemDurationChanged();
 	updateProcessIndices();
 }
@@ -1227,6 +1232,38 @@ bool CParticleSystem::hasLightableObjects() const
 	return false;
 }
 
+///=======================================================================================
+bool CParticleSystem::canStepConcurrently() const
+{
+	NL_PS_FUNC_MAIN(CParticleSystem_canStepConcurrently)
+	// shared systems are animated once for all their models, global user params are shared between systems
+	if (_Sharing || _UserParamGlobalValue) return false;
+	if (_BindablesTouched)
+	{
+		_BindablesTouched = false;
+		_BindablesCanStepConcurrently = true;
+		/// for each process
+		for (TProcessVect::const_iterator it = _ProcessVect.begin(); it != _ProcessVect.end() && _BindablesCanStepConcurrently; ++it)
+		{
+			if ((*it)->isLocated())
+			{
+				const CPSLocated *loc = static_cast<const CPSLocated *>(*it);
+				for (uint k = 0; k < loc->getNbBoundObjects(); ++k)
+				{
+					const CPSLocatedBindable *lb = loc->getBoundObject(k);
+					// sounds, lights and meshs instances are created in the sound server or in the scene
+					if (lb->getType() == PSSound || lb->getType() == PSLight || dynamic_cast<const CPSMesh *>(lb))
+					{
+						_BindablesCanStepConcurrently = false;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return _BindablesCanStepConcurrently;
+}
+
 ///=======================================================================================
 void CParticleSystem::getLODVect(NLMISC::CVector &v, float &offset,  TPSMatrixMode matrixMode)
 {
@@ -1477,6 +1514,7 @@ CParticleSystemProcess *CParticleSystem::detach(uint index)
 	_ProcessVect.erase(_ProcessVect.begin() + index);
 	proc->setOwner(NULL);
 	//
+	bindablesChanged();
 	systemDurationChanged();
 	// not part of this system any more
 	return proc;
@@ -27,7 +27,9 @@
 #include "nel/3d/particle_system_model.h"
 #include "nel/3d/scene.h"
 #include "nel/3d/skeleton_model.h"
+#include "nel/3d/ps_sim_buffers.h"
 
+using namespace NLMISC;
 
 namespace NL3D
 {
@@ -50,10 +52,35 @@ void CParticleSystemManager::release()
 	if( ManagerList )
 		delete ManagerList;
 	ManagerList = NULL;
+	CPSSimBuffers::release();
 }
 
 ///=========================================================
-CParticleSystemManager::CParticleSystemManager() : _NumModels(0)
+/**
+ * A job of the parallel animation, run by the worker pool during flushAnimate() : it helps the main thread
+ * to step the deferred models. It uses its own sim buffers rather than those of the thread which runs it.
+ */
+class CParticleSystemManager::CAnimateJob : public IWorkerJob
+{
+public:
+	CAnimateJob(CParticleSystemManager *manager) : _Manager(manager) {}
+
+	virtual void	run()
+	{
+		CPSSimBuffers *previous = CPSSimBuffers::setCurrent(&_SimBuffers);
+		_Manager->stepDeferredModels();
+		CPSSimBuffers::setCurrent(previous);
+	}
+
+private:
+	CParticleSystemManager	*_Manager;
+	CPSSimBuffers			_SimBuffers;
+};
+
+///=========================================================
+CParticleSystemManager::CParticleSystemManager() : _NumModels(0),
+												   _NumModelsToStep(0),
+												   _NextModelToStep(0)
 {
 	NL_PS_FUNC(CParticleSystemManager_CParticleSystemManager)
 	_CurrListIterator = _ModelList.end();
@@ -65,8 +92,15 @@ CParticleSystemManager::CParticleSystemManager() : _NumModels(0)
 CParticleSystemManager::~CParticleSystemManager()
 {
 	NL_PS_FUNC(CParticleSystemManager_CParticleSystemManagerDtor)
+	// release the jobs
+	enableParallelAnimate(0);
 	// remove from global list
 	getManagerList().erase(_GlobalListHandle);
+	// the sim buffers of the main thread are no more needed
+	if (getManagerList().empty())
+	{
+		CPSSimBuffers::release();
+	}
 }
 
 ///=========================================================
@@ -229,20 +263,114 @@ void	CParticleSystemManager::processAnimate(TAnimationTime deltaT)
 				}
 			}
 			psm.doAnimate();
-			if (!psm.getEditionMode())
+		}
+		it = nextIt;
+	}
+
+	// step the systems that have been deferred by doAnimate()
+	flushAnimate();
+
+	for (TAlwaysAnimatedModelList::iterator it = _PermanentlyAnimatedModelList.begin(); it != _PermanentlyAnimatedModelList.end();)
+	{
+		CParticleSystemModel &psm = *(it->Model);
+		CParticleSystem		 *ps  = psm.getPS();
+		TAlwaysAnimatedModelList::iterator nextIt = it;
+		nextIt++;
+		if (ps && !psm.getEditionMode())
+		{
+			// test deletion condition (no more particle, no more particle and emitters)
+			if (ps->isDestroyConditionVerified())
 			{
-				// test deletion condition (no more particle, no more particle and emitters)
-				if (ps->isDestroyConditionVerified())
-				{
-					psm.releaseRscAndInvalidate();
-				}
+				psm.releaseRscAndInvalidate();
 			}
-
 		}
 		it = nextIt;
 	}
 }
 
+///=========================================================
+void	CParticleSystemManager::enableParallelAnimate(uint numThreads)
+{
+	NL_PS_FUNC(CParticleSystemManager_enableParallelAnimate)
+	#ifndef NL_HAS_THREAD_LOCAL
+		if (numThreads != 0)
+		{
+			nlwarning("CParticleSystemManager::enableParallelAnimate : no thread local storage, particle systems are stepped in the main thread");
+		}
+		numThreads = 0;
+	#endif
+	if (numThreads == _AnimateJobs.size()) return;
+
+	flushAnimate();
+	uint k;
+	for (k = 0; k < _AnimateJobs.size(); ++k)
+	{
+		delete _AnimateJobs[k];
+	}
+	_AnimateJobs.clear();
+
+	for (k = 0; k < numThreads; ++k)
+	{
+		_AnimateJobs.push_back(new CAnimateJob(this));
+	}
+	if (numThreads != 0)
+	{
+		CWorkerPool::getInstance().reserveThreads(numThreads);
+	}
+}
+
+///=========================================================
+void	CParticleSystemManager::stepDeferredModels()
+{
+	NL_PS_FUNC(CParticleSystemManager_stepDeferredModels)
+	for(;;)
+	{
+		// claim the next model
+		_AnimateMutex.enter();
+		if (_NextModelToStep >= _NumModelsToStep)
+		{
+			_AnimateMutex.leave();
+			return;
+		}
+		CParticleSystemModel *model = _DeferredModels[_NextModelToStep ++];
+		_AnimateMutex.leave();
+
+		model->stepAnimate();
+	}
+}
+
+///=========================================================
+void	CParticleSystemManager::flushAnimate()
+{
+	NL_PS_FUNC(CParticleSystemManager_flushAnimate)
+	if (_DeferredModels.empty()) return;
+	const uint numModels = (uint) _DeferredModels.size();
+
+	// publish the models to the jobs
+	_AnimateMutex.enter();
+	_NumModelsToStep = numModels;
+	_NextModelToStep = 0;
+	_AnimateMutex.leave();
+	CWorkerPool &workerPool = CWorkerPool::getInstance();
+	uint k;
+	for (k = 0; k < _AnimateJobs.size() && k + 1 < numModels; ++k)
+	{
+		workerPool.addJob(_AnimateJobs[k], _AnimateGroup);
+	}
+
+	// help them
+	stepDeferredModels();
+
+	// then wait for the models claimed by the jobs
+	workerPool.wait(_AnimateGroup);
+
+	for (k = 0; k < numModels; ++k)
+	{
+		_DeferredModels[k]->_AnimateDeferred = false;
+	}
+	_DeferredModels.clear();
+}
+
 ///=========================================================
 void CParticleSystemManager::stopSound()
 {
@@ -126,6 +126,7 @@ CParticleSystemModel::CParticleSystemModel() : _ParticleSystem(NULL),
 											   _InClusterAndVisible(false),
 											   _EmitterActive(true),
 											   _SoundActive(true),
+											   _AnimateDeferred(false),
 											   _BypassGlobalUserParam(0),
 											   _UserColor(CRGBA::White),
 											   _ZBias(0.f),
@@ -306,6 +307,11 @@ void CParticleSystemModel::releasePSPointer()
 	}
 	//
 	nlassert(_Scene);
+	// the system may be waiting to be stepped by the manager
+	if (_AnimateDeferred)
+	{
+		_Scene->getParticleSystemManager().flushAnimate();
+	}
 	_Scene->getParticleSystemManager().removeSystemModel(_ModelHandle);
 	if (_ParticleSystem->getAnimType() == CParticleSystem::AnimAlways)
 	{
@@ -673,17 +679,39 @@ void	CParticleSystemModel::doAnimate()
 	}
 	{
 		MINI_TIMER(PSStatsDoAnimatePart3)
-		TAnimationTime delay = getEllapsedTime();
-		// animate particles
 		CParticleSystemShape		*pss= NLMISC::safe_cast<CParticleSystemShape *>((IShape *)Shape);
 		if (_EditionMode)
 		{
 			pss->_ProcessOrder.clear(); // force to eval each frame because ps could be modified
 		}
-		ps->step(CParticleSystem::Anim, delay, *pss, *this);
+		else
+		{
+			CParticleSystemManager &psmgt = _Scene->getParticleSystemManager();
+			if (psmgt.isParallelAnimateEnabled() && ps->canStepConcurrently())
+			{
+				// The process order is shared by all the instances of the shape : compute it now rather than in concurrent steps
+				if (pss->_ProcessOrder.empty())
+				{
+					ps->getSortingByEmitterPrecedence(pss->_ProcessOrder);
+				}
+				// the step will be done by the manager, concurrently with other systems
+				_AnimateDeferred = true;
+				psmgt.deferAnimate(this);
+				return;
+			}
+		}
+		stepAnimate();
 	}
 }
 
+///=====================================================================================
+void	CParticleSystemModel::stepAnimate()
+{
+	// animate particles
+	CParticleSystemShape		*pss= NLMISC::safe_cast<CParticleSystemShape *>((IShape *)Shape);
+	getPS()->step(CParticleSystem::Anim, getEllapsedTime(), *pss, *this);
+}
+
 
 //////////////////////////////////////////////
 // CParticleSystem Render implementation  //
@@ -29,6 +29,7 @@
 #include "nel/misc/line.h"
 #include "nel/3d/dru.h"
 #include "nel/3d/particle_system.h"
+#include "nel/3d/ps_sim_buffers.h"
 
 namespace NL3D {
 
@@ -252,7 +253,7 @@ inline void CPSEmitter::processEmitConsistent(const NLMISC::CVector &emitterPos,
 											  TAnimationTime deltaT)
 {
 	NL_PS_FUNC(CPSEmitter_processEmitConsistent)
-	static NLMISC::CVector speed, pos; /// speed and pos of emittee
+	NLMISC::CVector speed, pos; /// speed and pos of emittee
 	nlassert(_Owner);
 	if (!_SpeedBasisEmission)
 	{
@@ -1029,8 +1030,8 @@ void CPSEmitter::processRegularEmissionConsistent(uint firstInstanceIndex, float
 	//
 
 
-	static std::vector<NLMISC::CVector> emitterPositions;
 	// Positions for the emitter. They are computed by using a parametric trajectory or by using integration
+	std::vector<NLMISC::CVector> &emitterPositions = CPSSimBuffers::get().EmitterPositions;
 
 	const uint size = _Owner->getSize();
 	nlassert(firstInstanceIndex < size);
@@ -1462,8 +1463,8 @@ void CPSEmitter::processRegularEmissionConsistentWithNoLOD(uint firstInstanceInd
 	//
 
 
-	static std::vector<NLMISC::CVector> emitterPositions;
 	// Positions for the emitter. They are computed by using a parametric trajectory or by using integration
+	std::vector<NLMISC::CVector> &emitterPositions = CPSSimBuffers::get().EmitterPositions;
 
 	const uint size = _Owner->getSize();
 	nlassert(firstInstanceIndex < size);
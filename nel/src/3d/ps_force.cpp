@@ -34,6 +34,7 @@
 #include "nel/misc/common.h"
 #include "nel/3d/ps_util.h"
 #include "nel/3d/ps_misc.h"
+#include "nel/3d/ps_simd.h"
 
 namespace NL3D {
 
@@ -271,25 +272,18 @@ void CPSDirectionnalForce::computeForces(CPSLocated &target)
 		}
 		toAddLocal = CParticleSystem::EllapsedTime * (_IntensityScheme ? _IntensityScheme->get(_Owner, k) : _K ) * dir;
 		toAdd = CPSLocated::getConversionMatrix(&target, this->_Owner).mulVector(toAddLocal); // express this in the target basis
-		TPSAttribVector::iterator it = target.getSpeed().begin(), itend = target.getSpeed().end();
+		uint32 size = target.getSize();
+		if (!size) continue;
 		// 1st case : non-constant mass
 		if (target.getMassScheme())
 		{
-			TPSAttribFloat::const_iterator invMassIt = target.getInvMass().begin();
-			for (;it != itend; ++it, ++invMassIt)
-			{
-				(*it) += *invMassIt * toAdd;
-
-			}
+			CPSSimd::addScaledVector(&target.getSpeed()[0], &target.getInvMass()[0], size, toAdd);
 		}
 		else
 		{
 			// the mass is constant
 			toAdd /= target.getInitialMass();
-			for (; it != itend; ++it)
-			{
-				(*it) += toAdd;
-			}
+			CPSSimd::addVector(&target.getSpeed()[0], size, toAdd);
 		}
 	}
 }
@@ -392,24 +386,10 @@ void CPSGravity::computeForces(CPSLocated &target)
 	{
 		CVector toAddLocal = CParticleSystem::EllapsedTime * CVector(0, 0, _IntensityScheme ? - _IntensityScheme->get(_Owner, k) : - _K);
 		toAdd = CPSLocated::getConversionMatrix(&target, this->_Owner).mulVector(toAddLocal); // express this in the target basis
-		TPSAttribVector::iterator it = target.getSpeed().begin(), itend = target.getSpeed().end();
-
-		if (toAdd.x && toAdd.y)
-		{
-			for (; it != itend; ++it)
-			{
-				(*it) += toAdd;
-
-			}
-		}
-		else // only the z component is not null, which should be the majority of cases ...
-		{
-			for (; it != itend; ++it)
-			{
-				it->z += toAdd.z;
-
-			}
-		}
+		uint32 size = target.getSize();
+		if (!size) continue;
+		// NB : the whole vector is added, adding x & y costs nothing more than z alone.
+		CPSSimd::addVector(&target.getSpeed()[0], size, toAdd);
 	}
 }
 
@@ -776,14 +756,10 @@ void CPSSpring::computeForces(CPSLocated &target)
 		const float ellapsedTimexK = CParticleSystem::EllapsedTime  * (_IntensityScheme ? _IntensityScheme->get(_Owner, k) : _K);
 		const CMatrix &m = CPSLocated::getConversionMatrix(&target, this->_Owner);
 		const CVector center = m * (_Owner->getPos()[k]);
-		TPSAttribVector::iterator it = target.getSpeed().begin(), itEnd = target.getSpeed().end();
-		TPSAttribFloat::const_iterator invMassIt = target.getInvMass().begin();
-		TPSAttribVector::const_iterator posIt = target.getPos().begin();
-		for (; it != itEnd; ++it, ++invMassIt, ++posIt)
-		{
-			// apply the spring equation
-			(*it) += (*invMassIt) * ellapsedTimexK * (center - *posIt);
-		}
+		uint32 targetSize = target.getSize();
+		if (!targetSize) continue;
+		// apply the spring equation
+		CPSSimd::addSpringForce(&target.getSpeed()[0], &target.getPos()[0], &target.getInvMass()[0], targetSize, center, ellapsedTimexK);
 	}
 }
 
@@ -1316,58 +1292,26 @@ void CPSBrownianForce::computeForces(CPSLocated &target)
 		float intensity = _IntensityScheme ? _IntensityScheme->get(_Owner, k) : _K;
 		uint32 size = target.getSize();
 		if (!size) continue;
-		TPSAttribVector::iterator it2 = target.getSpeed().begin(), it2End;
+		TPSAttribVector::iterator it2 = target.getSpeed().begin();
 		/// start at a random position in the precomp impulsion tab
 		uint startPos = (uint) ::rand() % BFNumPrecomputedImpulsions;
 		NLMISC::CVector *imp = PrecomputedImpulsions + startPos;
 
-		if (target.getMassScheme())
-		{
-			float intensityXtime = intensity * CParticleSystem::EllapsedTime;
-			TPSAttribFloat::const_iterator invMassIt = target.getInvMass().begin();
-			do
-			{
-				uint toProcess = std::min((uint) (BFNumPrecomputedImpulsions - startPos), (uint) size);
-				it2End = it2 + toProcess;
-				do
-				{
-					float factor = intensityXtime * *invMassIt;
-					it2->set(it2->x + factor * imp->x,
-							it2->y + factor * imp->y,
-							it2->z + factor * imp->x);
-					++invMassIt;
-					++imp;
-					++it2;
-				}
-				while (it2 != it2End);
-				startPos = 0;
-				imp = PrecomputedImpulsions;
-				size -= toProcess;
-			}
-			while (size != 0);
-		}
-		else
+		// the precomputed impulsions are read sequentially from startPos, and wrap at the end of the table
+		const float *invMass = target.getMassScheme() ? &target.getInvMass()[0] : NULL;
+		float factor = invMass ? intensity * CParticleSystem::EllapsedTime
+							   : intensity * CParticleSystem::EllapsedTime / target.getInitialMass();
+		do
 		{
-			do
-			{
-				uint toProcess = std::min((uint) (BFNumPrecomputedImpulsions - startPos) , (uint) size);
-				it2End = it2 + toProcess;
-				float factor = intensity * CParticleSystem::EllapsedTime / target.getInitialMass();
-				do
-				{
-					it2->set(it2->x + factor * imp->x,
-							it2->y + factor * imp->y,
-							it2->z + factor * imp->x);
-					++imp;
-					++it2;
-				}
-				while (it2 != it2End);
-				startPos = 0;
-				imp = PrecomputedImpulsions;
-				size -= toProcess;
-			}
-			while (size != 0);
+			uint toProcess = std::min((uint) (BFNumPrecomputedImpulsions - startPos), (uint) size);
+			CPSSimd::addScaledVectors(&*it2, imp, invMass, toProcess, factor);
+			it2 += toProcess;
+			if (invMass) invMass += toProcess;
+			startPos = 0;
+			imp = PrecomputedImpulsions;
+			size -= toProcess;
 		}
+		while (size != 0);
 	}
 }
 
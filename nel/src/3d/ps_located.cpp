@@ -40,6 +40,8 @@
 #include "nel/3d/ps_force.h"
 #include "nel/3d/ps_emitter.h"
 #include "nel/3d/ps_misc.h"
+#include "nel/3d/ps_simd.h"
+#include "nel/3d/ps_sim_buffers.h"
 
 #include "nel/misc/line.h"
 #include "nel/misc/system_info.h"
@@ -58,8 +60,7 @@
 namespace NL3D {
 
 
-std::vector<CPSCollisionInfo> CPSLocated::_Collisions;
-CPSCollisionInfo *CPSLocated::_FirstCollision = NULL;
+NL_THREAD_LOCAL CPSCollisionInfo *CPSLocated::_FirstCollision = NULL;
 
 
 
@@ -915,6 +916,7 @@ bool CPSLocated::bind(CPSLocatedBindable *lb)
 			// register in ID list
 			ps->registerLocatedBindableExternID(lb->getExternID(), lb);
 		}
+		_Owner->bindablesChanged();
 		_Owner->systemDurationChanged();
 	}
 
@@ -934,6 +936,7 @@ void CPSLocated::remove(const CPSLocatedBindable *p)
 	_LocatedBoundCont.erase(it);
 	if (_Owner)
 	{
+		_Owner->bindablesChanged();
 		_Owner->systemDurationChanged();
 	}
 	CHECK_PS_INTEGRITY
@@ -972,6 +975,7 @@ void CPSLocated::postNewElement(const NLMISC::CVector &pos,
 							    TAnimationTime lifeTime)
 {
 	NL_PS_FUNC(CPSLocated_postNewElement)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	nlassert(CParticleSystem::InsideSimLoop); // should be called only inside the sim loop!
 	// In the event loop life of emitter is updated just after particles are spawned, so we must check there if the particle wasn't emitted when the
 	// emitter was already destroyed
@@ -1008,7 +1012,7 @@ void CPSLocated::postNewElement(const NLMISC::CVector &pos,
 	// now check that the emitter didn't collide before it spawned a particle
 	if (emitterLocated.hasCollisionInfos())
 	{
-		const CPSCollisionInfo &ci = _Collisions[indexInEmitter];
+		const CPSCollisionInfo &ci = simBuffers.Collisions[indexInEmitter];
 		if (ci.Dist != -1.f)
 		{
 			// a collision occured, check time from collision to next time step
@@ -1018,7 +1022,7 @@ void CPSLocated::postNewElement(const NLMISC::CVector &pos,
 
 
 	// create a request to create a new element
-	CParticleSystem::CSpawnVect &sp = *CParticleSystem::_Spawns[getIndex()];
+	CParticleSystem::CSpawnVect &sp = *simBuffers.Spawns[getIndex()];
 	if (!_Owner->getAutoCountFlag() && sp.MaxNumSpawns == sp.SpawnInfos.size()) return; // no more place to spawn
 	if (getMaxSize() >= ((1 << 16) - 1)) return;
 	sp.SpawnInfos.resize(sp.SpawnInfos.size() + 1);
@@ -1039,6 +1043,7 @@ void CPSLocated::postNewElement(const NLMISC::CVector &pos,
 sint32 CPSLocated::newElement(const CPSSpawnInfo &si, bool doEmitOnce /* = false */, TAnimationTime ellapsedTime)
 {
 	NL_PS_FUNC(CPSLocated_newElement)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	CHECK_PS_INTEGRITY
 	sint32 creationIndex;
 
@@ -1053,7 +1058,7 @@ sint32 CPSLocated::newElement(const CPSSpawnInfo &si, bool doEmitOnce /* = false
 			uint maxSize = getMaxSize();
 			resize((uint32) std::min((uint) NLMISC::raiseToNextPowerOf2(maxSize + 1), (uint) ((1 << 16) - 1))); // force a reserve with next power of 2 (no important in edition mode)
 			resize(maxSize + 1);
-			CParticleSystem::_SpawnPos.resize(maxSize + 1);
+			simBuffers.SpawnPos.resize(maxSize + 1);
 		}
 		else
 		{
@@ -1170,7 +1175,7 @@ sint32 CPSLocated::newElement(const CPSSpawnInfo &si, bool doEmitOnce /* = false
 	_InvMass.insert(1.f / ((_MassScheme && si.EmitterInfo.Loc) ? _MassScheme->get(si.EmitterInfo) : _InitialMass ) );
 	if (CParticleSystem::InsideSimLoop)
 	{
-		CParticleSystem::_SpawnPos[creationIndex] = _Pos[creationIndex];
+		simBuffers.SpawnPos[creationIndex] = _Pos[creationIndex];
 	}
 	// compute age of particle when it has been created
 	if (getLastForever())
@@ -1643,137 +1648,6 @@ void CPSLocated::serial(NLMISC::IStream &f) throw(NLMISC::EStream)
 	CHECK_PS_INTEGRITY
 }
 
-///***************************************************************************************
-// integrate speed of particles. Makes eventually use of SSE instructions when present
-static void IntegrateSpeed(uint count, float *src1, const float *src2, float *dest, float ellapsedTime)
-{
-	NL_PS_FUNC(IntegrateSpeed)
-	#if 0 // this works, but is not enabled for now. The precision is not that good...
-	/*
-		#ifdef NL_OS_WINDOWS
-
-
-
-		if (NLMISC::CCpuInfo::hasSSE()
-			&& ((uint) src1 & 15) == ((uint) src2 & 15)
-			&& ! ((uint) src1 & 3)
-			&& ! ((uint) src2 & 3)
-		   )   // must must be sure that memory alignment is identical
-		{
-
-			// compute first datas in order to align to 16 byte boudary
-
-			uint alignCount =  ((uint) src1 >> 2) & 3; // number of float to process
-
-			while (alignCount --)
-			{
-				*src1++ += ellapsedTime * *src2 ++;
-			}
-
-
-
-			count -= alignCount;
-			if (count > 3)
-			{
-				float et[4] = { ellapsedTime, ellapsedTime, ellapsedTime, ellapsedTime};
-				// sse part of computation
-				__asm
-				{
-						mov  ecx, count
-						shr  ecx, 2
-
-
-						xor   edx, edx
-
-						mov    eax, src1
-						mov    ebx, src2
-						movups  xmm0, et[0]
-					myLoop:
-						movaps xmm2, [ebx + 8 * edx]
-						movaps xmm1, [eax + 8 * edx]
-						mulps  xmm2, xmm0
-						addps  xmm1, xmm2
-						movaps [eax + 8 * edx], xmm1
-						add edx, 2
-						dec ecx
-						jne myLoop
-				}
-			}
-			// proceed with left float
-			count &= 3;
-
-			if (count)
-			{
-				src1 += alignCount;
-				src2 += alignCount;
-				do
-				{
-					*src1 += ellapsedTime * *src2;
-
-					++src1;
-					++src2;
-				}
-				while (--count);
-			}
-
-		}
-		else
-		#endif
-		*/
-	#endif
-	{
-		// standard version
-
-		// standard version
-		uint countDiv8 = count>>3;
-		count &= 7; // takes count % 8
-
-		if (dest == src1)
-		{
-			while (countDiv8 --)
-			{
-				src1[0] += ellapsedTime * src2[0];
-				src1[1] += ellapsedTime * src2[1];
-				src1[2] += ellapsedTime * src2[2];
-				src1[3] += ellapsedTime * src2[3];
-
-				src1[4] += ellapsedTime * src2[4];
-				src1[5] += ellapsedTime * src2[5];
-				src1[6] += ellapsedTime * src2[6];
-				src1[7] += ellapsedTime * src2[7];
-
-				src2 += 8;
-				src1 += 8;
-			}
-			while (count--)
-			{
-				*src1++ += ellapsedTime * *src2++;
-			}
-		}
-		else
-		{
-			while (countDiv8 --)
-			{
-				dest[0] = src1[0] + ellapsedTime * src2[0];
-				dest[1] = src1[1] + ellapsedTime * src2[1];
-				dest[2] = src1[2] + ellapsedTime * src2[2];
-				dest[3] = src1[3] + ellapsedTime * src2[3];
-				dest[4] = src1[4] + ellapsedTime * src2[4];
-				dest[5] = src1[5] + ellapsedTime * src2[5];
-				dest[6] = src1[6] + ellapsedTime * src2[6];
-				dest[7] = src1[7] + ellapsedTime * src2[7];
-				src2 += 8;
-				src1 += 8;
-				dest += 8;
-			}
-			while (count--)
-			{
-				*dest++ = *src1++ + ellapsedTime * *src2++;
-			}
-		}
-	}
-}
-
 ///***************************************************************************************
 void CPSLocated::computeMotion()
 {
@@ -1785,7 +1659,7 @@ void CPSLocated::computeMotion()
 		{
 			MINI_TIMER(PSMotion3)
 			if (_Size != 0) // avoid referencing _Pos[0] if there's no size, causes STL vectors to assert...
-				IntegrateSpeed(_Size * 3, &_Pos[0].x, &_Speed[0].x, &_Pos[0].x, CParticleSystem::EllapsedTime);
+				CPSSimd::integrate(&_Pos[0].x, &_Pos[0].x, &_Speed[0].x, _Size * 3, CParticleSystem::EllapsedTime);
 		}
 	}
 	else
@@ -1793,8 +1667,8 @@ void CPSLocated::computeMotion()
 		{
 			MINI_TIMER(PSMotion4)
 			// compute new position after the timeStep
-			IntegrateSpeed(_Size * 3, &_Pos[0].x, &_Speed[0].x, &(*_CollisionNextPos)[0].x, CParticleSystem::EllapsedTime);
-			nlassert(CPSLocated::_Collisions.size() >= _Size);
+			CPSSimd::integrate(&(*_CollisionNextPos)[0].x, &_Pos[0].x, &_Speed[0].x, _Size * 3, CParticleSystem::EllapsedTime);
+			nlassert(CPSSimBuffers::get().Collisions.size() >= _Size);
 			computeCollisions(0, &_Pos[0], &(*_CollisionNextPos)[0]);
 			// update new poositions by just swapping the 2 vectors
 			_CollisionNextPos->swap(_Pos);
@@ -1808,15 +1682,17 @@ void CPSLocated::computeMotion()
 void CPSLocated::computeNewParticleMotion(uint firstInstanceIndex)
 {
 	NL_PS_FUNC(CPSLocated_computeNewParticleMotion)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	nlassert(_CollisionNextPos);
 	resetCollisions(_Size);
-	computeCollisions(firstInstanceIndex, &CParticleSystem::_SpawnPos[0], &_Pos[0]);
+	computeCollisions(firstInstanceIndex, &simBuffers.SpawnPos[0], &_Pos[0]);
 }
 
 ///***************************************************************************************
 void CPSLocated::resetCollisions(uint numInstances)
 {
 	NL_PS_FUNC(CPSLocated_resetCollisions)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	CPSCollisionInfo *currCollision = _FirstCollision;
 	while (currCollision)
 	{
@@ -1824,13 +1700,13 @@ void CPSLocated::resetCollisions(uint numInstances)
 		currCollision = currCollision->Next;
 	}
 	_FirstCollision = NULL;
-	if (numInstances > _Collisions.size())
+	if (numInstances > simBuffers.Collisions.size())
 	{
-		uint oldSize = (uint) _Collisions.size();
-		_Collisions.resize(numInstances);
+		uint oldSize = (uint) simBuffers.Collisions.size();
+		simBuffers.Collisions.resize(numInstances);
 		for(uint k = oldSize; k < numInstances; ++k)
 		{
-			_Collisions[k].Index = k;
+			simBuffers.Collisions[k].Index = k;
 		}
 	}
 }
@@ -1839,6 +1715,7 @@ void CPSLocated::resetCollisions(uint numInstances)
 void CPSLocated::updateCollisions()
 {
 	NL_PS_FUNC(CPSLocated_updateCollisions)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	CPSCollisionInfo *currCollision = _FirstCollision;
 	if (getLastForever())
 	{
@@ -1854,13 +1731,13 @@ void CPSLocated::updateCollisions()
 			if (currCollision->CollisionZone->getCollisionBehaviour() == CPSZone::destroy)
 			{
 				#ifdef NL_DEBUG
-					nlassert(CParticleSystem::_ParticleRemoveListIndex[currCollision->Index] == -1);
+					nlassert(simBuffers.ParticleRemoveListIndex[currCollision->Index] == -1);
 				#endif
-				CParticleSystem::_ParticleToRemove.push_back(currCollision->Index);
+				simBuffers.ParticleToRemove.push_back(currCollision->Index);
 				#ifdef NL_DEBUG
-					nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+					nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 				#endif
-				CParticleSystem::_ParticleRemoveListIndex[currCollision->Index] = CParticleSystem::_ParticleToRemove.size() - 1;
+				simBuffers.ParticleRemoveListIndex[currCollision->Index] = simBuffers.ParticleToRemove.size() - 1;
 
 			}
 			currCollision = currCollision->Next;
@@ -1900,13 +1777,13 @@ void CPSLocated::updateCollisions()
 				{
 					// insert particle only if not already dead
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleRemoveListIndex[currCollision->Index] == -1);
+						nlassert(simBuffers.ParticleRemoveListIndex[currCollision->Index] == -1);
 					#endif
-					CParticleSystem::_ParticleToRemove.push_back(currCollision->Index);
+					simBuffers.ParticleToRemove.push_back(currCollision->Index);
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+						nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 					#endif
-					CParticleSystem::_ParticleRemoveListIndex[currCollision->Index] = CParticleSystem::_ParticleToRemove.size() - 1;
+					simBuffers.ParticleRemoveListIndex[currCollision->Index] = simBuffers.ParticleToRemove.size() - 1;
 				}
 			}
 			currCollision = currCollision->Next;
@@ -2000,6 +1877,7 @@ void CPSLocated::step(TPSProcessPass pass)
 void CPSLocated::updateLife()
 {
 	NL_PS_FUNC(CPSLocated_updateLife)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	CHECK_PS_INTEGRITY
 	if (!_Size) return;
 	if (! _LastForever)
@@ -2013,13 +1891,13 @@ void CPSLocated::updateLife()
 				if (*itTime >= 1.0f)
 				{
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleRemoveListIndex[k] == -1);
+						nlassert(simBuffers.ParticleRemoveListIndex[k] == -1);
 					#endif
-					CParticleSystem::_ParticleToRemove.push_back(k);
+					simBuffers.ParticleToRemove.push_back(k);
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+						nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 					#endif
-					CParticleSystem::_ParticleRemoveListIndex[k] = CParticleSystem::_ParticleToRemove.size() - 1;
+					simBuffers.ParticleRemoveListIndex[k] = simBuffers.ParticleToRemove.size() - 1;
 				}
 				++itTime;
 				++itTimeInc;
@@ -2041,13 +1919,13 @@ void CPSLocated::updateLife()
 						if (*itTime >= 1.0f)
 						{
 							#ifdef NL_DEBUG
-								nlassert(CParticleSystem::_ParticleRemoveListIndex[k] == -1);
+								nlassert(simBuffers.ParticleRemoveListIndex[k] == -1);
 							#endif
-							CParticleSystem::_ParticleToRemove.push_back(k);
+							simBuffers.ParticleToRemove.push_back(k);
 							#ifdef NL_DEBUG
-								nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+								nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 							#endif
-							CParticleSystem::_ParticleRemoveListIndex[k] = CParticleSystem::_ParticleToRemove.size() - 1;
+							simBuffers.ParticleRemoveListIndex[k] = simBuffers.ParticleToRemove.size() - 1;
 						}
 						++ itTime;
 					}
@@ -2069,13 +1947,13 @@ void CPSLocated::updateLife()
 				for(uint k = 0; k < _Size; ++k)
 				{
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleRemoveListIndex[k] == -1);
+						nlassert(simBuffers.ParticleRemoveListIndex[k] == -1);
 					#endif
-					CParticleSystem::_ParticleToRemove.push_back(k);
+					simBuffers.ParticleToRemove.push_back(k);
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+						nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 					#endif
-					CParticleSystem::_ParticleRemoveListIndex[k] = CParticleSystem::_ParticleToRemove.size() - 1;
+					simBuffers.ParticleRemoveListIndex[k] = simBuffers.ParticleToRemove.size() - 1;
 				}
 			}
 		}
@@ -2096,43 +1974,44 @@ void CPSLocated::updateLife()
 ///***************************************************************************************
 // When a particle is deleted, it is replaced by the last particle in the array
 // if this particle is to be deleted to, must update its new index
-static inline void removeParticleFromRemoveList(uint indexToRemove, uint arraySize)
+static inline void removeParticleFromRemoveList(CPSSimBuffers &simBuffers, uint indexToRemove, uint arraySize)
 {
 	NL_PS_FUNC(removeParticleFromRemoveList)
 	if (indexToRemove != arraySize)
 	{
-		if (CParticleSystem::_ParticleRemoveListIndex[arraySize] != -1)
+		if (simBuffers.ParticleRemoveListIndex[arraySize] != -1)
 		{
 			// when a particle is deleted, it is replaced by the last particle in the array
 			// if this particle is to be deleted too, must update its new index (becomes the index of the particle that has just been deleted)
-			CParticleSystem::_ParticleToRemove[CParticleSystem::_ParticleRemoveListIndex[arraySize]] = indexToRemove;
-			CParticleSystem::_ParticleRemoveListIndex[indexToRemove] = CParticleSystem::_ParticleRemoveListIndex[arraySize];
-			CParticleSystem::_ParticleRemoveListIndex[arraySize] = -1; // not to remove any more
+			simBuffers.ParticleToRemove[simBuffers.ParticleRemoveListIndex[arraySize]] = indexToRemove;
+			simBuffers.ParticleRemoveListIndex[indexToRemove] = simBuffers.ParticleRemoveListIndex[arraySize];
+			simBuffers.ParticleRemoveListIndex[arraySize] = -1; // not to remove any more
 		}
 		else
 		{
-			CParticleSystem::_ParticleRemoveListIndex[indexToRemove] = -1;
+			simBuffers.ParticleRemoveListIndex[indexToRemove] = -1;
 		}
 	}
 	else
 	{
-		CParticleSystem::_ParticleRemoveListIndex[arraySize] = -1;
+		simBuffers.ParticleRemoveListIndex[arraySize] = -1;
 	}
 }
 
 void checkRemoveArray(uint size)
 {
 	NL_PS_FUNC(checkRemoveArray)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	for(uint k = 0; k < size; ++k)
 	{
-		if (CParticleSystem::_ParticleRemoveListIndex[k] != -1)
+		if (simBuffers.ParticleRemoveListIndex[k] != -1)
 		{
-			nlassert(std::find(CParticleSystem::_ParticleRemoveListIndex.begin(), CParticleSystem::_ParticleRemoveListIndex.end(), CParticleSystem::_ParticleRemoveListIndex[k]) != CParticleSystem::_ParticleRemoveListIndex.end());
+			nlassert(std::find(simBuffers.ParticleRemoveListIndex.begin(), simBuffers.ParticleRemoveListIndex.end(), simBuffers.ParticleRemoveListIndex[k]) != simBuffers.ParticleRemoveListIndex.end());
 		}
 	}
-	for(uint k = 0; k < CParticleSystem::_ParticleToRemove.size(); ++k)
+	for(uint k = 0; k < simBuffers.ParticleToRemove.size(); ++k)
 	{
-		nlassert(CParticleSystem::_ParticleRemoveListIndex[CParticleSystem::_ParticleToRemove[k]] == (sint) k);
+		nlassert(simBuffers.ParticleRemoveListIndex[simBuffers.ParticleToRemove[k]] == (sint) k);
 	}
 
 }
@@ -2145,13 +2024,14 @@ void checkRemoveArray(uint size)
 TAnimationTime CPSLocated::computeDateFromCollisionToNextSimStep(uint particleIndex, float particleAgeInSeconds)
 {
 	NL_PS_FUNC(	CPSLocated_computeDateFromCollisionToNextSimStep)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	// compute time from the start of the sim step to the birth of the particle (or 0 if already born)
 	float ageAtStart = CParticleSystem::RealEllapsedTime > particleAgeInSeconds ? CParticleSystem::RealEllapsedTime - particleAgeInSeconds : 0.f;
 	ageAtStart /= CParticleSystem::RealEllapsedTimeRatio;
 	// compute time to collision. The 'NewSpeed' field is swapped with speed of particle at the sim step start when 'updateCollision' is called, and thus contains the old speed.
-	float norm = _Collisions[particleIndex].NewSpeed.norm();
+	float norm = simBuffers.Collisions[particleIndex].NewSpeed.norm();
 	if (norm == 0.f) return 0.f;
-	float timeToCollision = _Collisions[particleIndex].Dist / norm;
+	float timeToCollision = simBuffers.Collisions[particleIndex].Dist / norm;
 	// So time from collision to end of sim step is :
 	TAnimationTime result = CParticleSystem::EllapsedTime - ageAtStart - timeToCollision;
 	return std::max(0.f, result);
@@ -2161,6 +2041,7 @@ TAnimationTime CPSLocated::computeDateFromCollisionToNextSimStep(uint particleIn
 void CPSLocated::removeOldParticles()
 {
 	NL_PS_FUNC(CPSLocated_removeOldParticles)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	nlassert(CParticleSystem::RealEllapsedTime > 0.f);
 	#ifdef NL_DEBUG
 		CParticleSystem::InsideRemoveLoop = true;
@@ -2174,9 +2055,9 @@ void CPSLocated::removeOldParticles()
 		// during the call to 'updateCollisions', the list of particles to remove will be updated so just test it
 		if (hasCollisionInfos())
 		{
-			for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+			for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 			{
-				if (_Collisions[*it].Dist != -1.f)
+				if (simBuffers.Collisions[*it].Dist != -1.f)
 				{
 					deleteElement(*it, computeDateFromCollisionToNextSimStep(*it, _Time[*it]));
 				}
@@ -2184,7 +2065,7 @@ void CPSLocated::removeOldParticles()
 				{
 					deleteElement(*it);
 				}
-				removeParticleFromRemoveList(*it, _Size);
+				removeParticleFromRemoveList(simBuffers, *it, _Size);
 			}
 		}
 	}
@@ -2192,10 +2073,10 @@ void CPSLocated::removeOldParticles()
 	if (hasCollisionInfos()) // particle has collision, and limited lifetime
 	{
 		float ellapsedTimeRatio = CParticleSystem::EllapsedTime / CParticleSystem::RealEllapsedTime;
-		for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+		for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 		{
 			TAnimationTime timeUntilNextSimStep;
-			if (_Collisions[*it].Dist == -1.f)
+			if (simBuffers.Collisions[*it].Dist == -1.f)
 			{
 				// no collision occured
 				if (_Time[*it] > 1.f)
@@ -2239,7 +2120,7 @@ void CPSLocated::removeOldParticles()
 
 			}
 			deleteElement(*it, timeUntilNextSimStep);
-			removeParticleFromRemoveList(*it, _Size);
+			removeParticleFromRemoveList(simBuffers, *it, _Size);
 		}
 	}
 	else // particle has no collisions, and limited lifetime
@@ -2249,10 +2130,10 @@ void CPSLocated::removeOldParticles()
 		{
 			if (_LifeScheme)
 			{
-				for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+				for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 				{
 					#ifdef NL_DEBUG
-						for(std::vector<uint>::iterator it2 = it; it2 != CParticleSystem::_ParticleToRemove.end(); ++it2)
+						for(std::vector<uint>::iterator it2 = it; it2 != simBuffers.ParticleToRemove.end(); ++it2)
 						{
 							nlassert(*it2 < _Size);
 						}
@@ -2272,9 +2153,9 @@ void CPSLocated::removeOldParticles()
 						timeUntilNextSimStep = 0.f;
 					}
 					deleteElement(*it, timeUntilNextSimStep);
-					removeParticleFromRemoveList(*it, _Size);
+					removeParticleFromRemoveList(simBuffers, *it, _Size);
 					#ifdef NL_DEBUG
-						for(std::vector<uint>::iterator it2 = it + 1; it2 != CParticleSystem::_ParticleToRemove.end(); ++it2)
+						for(std::vector<uint>::iterator it2 = it + 1; it2 != simBuffers.ParticleToRemove.end(); ++it2)
 						{
 							nlassert(*it2 < _Size);
 						}
@@ -2283,7 +2164,7 @@ void CPSLocated::removeOldParticles()
 			}
 			else
 			{
-				for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+				for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 				{
 					TAnimationTime timeUntilNextSimStep;
 					if (_Time[*it] > 1.f)
@@ -2299,7 +2180,7 @@ void CPSLocated::removeOldParticles()
 						timeUntilNextSimStep = 0.f;
 					}
 					deleteElement(*it, timeUntilNextSimStep);
-					removeParticleFromRemoveList(*it, _Size);
+					removeParticleFromRemoveList(simBuffers, *it, _Size);
 				}
 			}
 		}
@@ -2308,7 +2189,7 @@ void CPSLocated::removeOldParticles()
 			// parametric case
 			if (_LifeScheme)
 			{
-				for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+				for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 				{
 					TAnimationTime timeUntilNextSimStep;
 					if (_Time[*it] > 1.f)
@@ -2325,12 +2206,12 @@ void CPSLocated::removeOldParticles()
 						timeUntilNextSimStep = 0.f;
 					}
 					deleteElement(*it, timeUntilNextSimStep);
-					removeParticleFromRemoveList(*it, _Size);
+					removeParticleFromRemoveList(simBuffers, *it, _Size);
 				}
 			}
 			else
 			{
-				for(std::vector<uint>::iterator it = CParticleSystem::_ParticleToRemove.begin(); it != CParticleSystem::_ParticleToRemove.end(); ++it)
+				for(std::vector<uint>::iterator it = simBuffers.ParticleToRemove.begin(); it != simBuffers.ParticleToRemove.end(); ++it)
 				{
 					TAnimationTime timeUntilNextSimStep;
 					if (_Time[*it] > 1.f)
@@ -2347,7 +2228,7 @@ void CPSLocated::removeOldParticles()
 						timeUntilNextSimStep = 0.f;
 					}
 					deleteElement(*it, timeUntilNextSimStep);
-					removeParticleFromRemoveList(*it, _Size);
+					removeParticleFromRemoveList(simBuffers, *it, _Size);
 				}
 			}
 		}
@@ -2355,7 +2236,7 @@ void CPSLocated::removeOldParticles()
 	#ifdef NL_DEBUG
 		CParticleSystem::InsideRemoveLoop = false;
 	#endif
-	CParticleSystem::_ParticleToRemove.clear();
+	simBuffers.ParticleToRemove.clear();
 	#ifdef NL_DEBUG
 		if (!_LastForever)
 		{
@@ -2371,15 +2252,16 @@ void CPSLocated::removeOldParticles()
 void CPSLocated::addNewlySpawnedParticles()
 {
 	NL_PS_FUNC(CPSLocated_addNewlySpawnedParticles)
+	CPSSimBuffers &simBuffers = CPSSimBuffers::get();
 	#ifdef NL_DEBUG
 		CParticleSystem::InsideNewElementsLoop = true;
 	#endif
-		CParticleSystem::CSpawnVect &spawns = *CParticleSystem::_Spawns[getIndex()];
+		CParticleSystem::CSpawnVect &spawns = *simBuffers.Spawns[getIndex()];
 		if (spawns.SpawnInfos.empty()) return;
 		uint numSpawns = 0;
 		if (!_Owner->getAutoCountFlag())
 		{
-			CParticleSystem::_SpawnPos.resize(getMaxSize());
+			simBuffers.SpawnPos.resize(getMaxSize());
 			numSpawns = std::min((uint) (_MaxSize - _Size), (uint) spawns.SpawnInfos.size());
 		}
 		else
@@ -2408,13 +2290,13 @@ void CPSLocated::addNewlySpawnedParticles()
 				if (_Time[insertionIndex] >= 1.f)
 				{
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleRemoveListIndex[insertionIndex] == -1);
+						nlassert(simBuffers.ParticleRemoveListIndex[insertionIndex] == -1);
 					#endif
-					CParticleSystem::_ParticleToRemove.push_back(insertionIndex);
+					simBuffers.ParticleToRemove.push_back(insertionIndex);
 					#ifdef NL_DEBUG
-						nlassert(CParticleSystem::_ParticleToRemove.size() <= _Size);
+						nlassert(simBuffers.ParticleToRemove.size() <= _Size);
 					#endif
-					CParticleSystem::_ParticleRemoveListIndex[insertionIndex] = CParticleSystem::_ParticleToRemove.size() - 1;
+					simBuffers.ParticleRemoveListIndex[insertionIndex] = simBuffers.ParticleToRemove.size() - 1;
 				}
 			}
 			//CParticleSystem::InsideSimLoop = true;
@@ -2614,6 +2496,10 @@ CPSLocatedBindable *CPSLocated::unbind(uint index)
 	CPSLocatedBindable *lb = _LocatedBoundCont[index];
 	lb->setOwner(NULL);
 	_LocatedBoundCont.erase(_LocatedBoundCont.begin() + index);
+	if (_Owner)
+	{
+		_Owner->bindablesChanged();
+	}
 	return lb;
 	CHECK_PS_INTEGRITY
 }
@@ -0,0 +1,284 @@
+/** \file ps_simd.cpp
+ * Vector kernels used by the particle system simulation (integration, forces, zones).
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "std3d.h"
+
+#include "nel/3d/ps_simd.h"
+
+#ifdef NL_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+
+using NLMISC::CVector;
+using NLMISC::CPlane;
+
+
+namespace NL3D
+{
+
+
+#ifdef NL_HAS_SSE2
+
+/*	4 CVector are 12 floats, loaded in 3 registers :
+	r0= (x0, y0, z0, x1)
+	r1= (y1, z1, x2, y2)
+	r2= (z2, x3, y3, z3)
+*/
+
+// ***************************************************************************
+// a vector splatted with the same layout as 4 packed CVector
+static inline void	splatVector(const CVector &v, __m128 &r0, __m128 &r1, __m128 &r2)
+{
+	r0= _mm_setr_ps(v.x, v.y, v.z, v.x);
+	r1= _mm_setr_ps(v.y, v.z, v.x, v.y);
+	r2= _mm_setr_ps(v.z, v.x, v.y, v.z);
+}
+
+// ***************************************************************************
+// (s0, s1, s2, s3) => 1 scale per vector, with the same layout as 4 packed CVector
+static inline void	splatScales(__m128 s, __m128 &r0, __m128 &r1, __m128 &r2)
+{
+	r0= _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0));
+	r1= _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1));
+	r2= _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2));
+}
+
+// ***************************************************************************
+// 4 packed CVector => (x0, x1, x2, x3), (y0, y1, y2, y3), (z0, z1, z2, z3)
+static inline void	loadTransposed(const CVector *v, __m128 &x, __m128 &y, __m128 &z)
+{
+	const float *src= &v->x;
+	__m128	r0= _mm_loadu_ps(src);
+	__m128	r1= _mm_loadu_ps(src + 4);
+	__m128	r2= _mm_loadu_ps(src + 8);
+	__m128	tx= _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 1, 0, 2));	// (x2, -, x3, -)
+	__m128	ty0= _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 0, 0, 1));	// (y0, -, y1, -)
+	__m128	ty1= _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 2, 0, 3));	// (y2, -, y3, -)
+	__m128	tz= _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 1, 0, 2));	// (z0, -, z1, -)
+	x= _mm_shuffle_ps(r0, tx, _MM_SHUFFLE(2, 0, 3, 0));
+	y= _mm_shuffle_ps(ty0, ty1, _MM_SHUFFLE(2, 0, 2, 0));
+	z= _mm_shuffle_ps(tz, r2, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+// ***************************************************************************
+// append the index of the bits set in mask (4 bits) to dest
+static inline uint32	*appendMask(int mask, uint32 index, uint32 *dest)
+{
+	if (mask & 1) *dest++= index;
+	if (mask & 2) *dest++= index + 1;
+	if (mask & 4) *dest++= index + 2;
+	if (mask & 8) *dest++= index + 3;
+	return dest;
+}
+
+#endif // NL_HAS_SSE2
+
+
+// ***************************************************************************
+void	CPSSimd::integrate(float *dest, const float *src1, const float *src2, uint numFloats, float dt)
+{
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	dt4= _mm_set1_ps(dt);
+	for (; k + 8 <= numFloats; k+= 8)
+	{
+		__m128	a0= _mm_add_ps(_mm_loadu_ps(src1 + k), _mm_mul_ps(dt4, _mm_loadu_ps(src2 + k)));
+		__m128	a1= _mm_add_ps(_mm_loadu_ps(src1 + k + 4), _mm_mul_ps(dt4, _mm_loadu_ps(src2 + k + 4)));
+		_mm_storeu_ps(dest + k, a0);
+		_mm_storeu_ps(dest + k + 4, a1);
+	}
+#endif
+	for (; k < numFloats; ++k)
+	{
+		dest[k]= src1[k] + dt * src2[k];
+	}
+}
+
+// ***************************************************************************
+void	CPSSimd::addVector(CVector *dest, uint count, const CVector &v)
+{
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	v0, v1, v2;
+	splatVector(v, v0, v1, v2);
+	for (; k + 4 <= count; k+= 4)
+	{
+		float	*d= &dest[k].x;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), v0));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), v1));
+		_mm_storeu_ps(d + 8, _mm_add_ps(_mm_loadu_ps(d + 8), v2));
+	}
+#endif
+	for (; k < count; ++k)
+	{
+		dest[k]+= v;
+	}
+}
+
+// ***************************************************************************
+void	CPSSimd::addScaledVector(CVector *dest, const float *scale, uint count, const CVector &v)
+{
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	v0, v1, v2;
+	splatVector(v, v0, v1, v2);
+	for (; k + 4 <= count; k+= 4)
+	{
+		__m128	s0, s1, s2;
+		splatScales(_mm_loadu_ps(scale + k), s0, s1, s2);
+		float	*d= &dest[k].x;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(s0, v0)));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(s1, v1)));
+		_mm_storeu_ps(d + 8, _mm_add_ps(_mm_loadu_ps(d + 8), _mm_mul_ps(s2, v2)));
+	}
+#endif
+	for (; k < count; ++k)
+	{
+		dest[k]+= scale[k] * v;
+	}
+}
+
+// ***************************************************************************
+void	CPSSimd::addScaledVectors(CVector *dest, const CVector *src, const float *scale, uint count, float factor)
+{
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	factor4= _mm_set1_ps(factor);
+	for (; k + 4 <= count; k+= 4)
+	{
+		__m128	s0, s1, s2;
+		if (scale)
+			splatScales(_mm_mul_ps(factor4, _mm_loadu_ps(scale + k)), s0, s1, s2);
+		else
+			s0= s1= s2= factor4;
+		float		*d= &dest[k].x;
+		const float	*s= &src[k].x;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(s0, _mm_loadu_ps(s))));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(s1, _mm_loadu_ps(s + 4))));
+		_mm_storeu_ps(d + 8, _mm_add_ps(_mm_loadu_ps(d + 8), _mm_mul_ps(s2, _mm_loadu_ps(s + 8))));
+	}
+#endif
+	for (; k < count; ++k)
+	{
+		float	f= scale ? factor * scale[k] : factor;
+		dest[k].set(dest[k].x + f * src[k].x,
+					 dest[k].y + f * src[k].y,
+					 dest[k].z + f * src[k].z);
+	}
+}
+
+// ***************************************************************************
+void	CPSSimd::addSpringForce(CVector *speed, const CVector *pos, const float *invMass, uint count,
+								const CVector &center, float k)
+{
+	uint	i= 0;
+#ifdef NL_HAS_SSE2
+	__m128	c0, c1, c2;
+	splatVector(center, c0, c1, c2);
+	__m128	k4= _mm_set1_ps(k);
+	for (; i + 4 <= count; i+= 4)
+	{
+		__m128	s0, s1, s2;
+		splatScales(_mm_mul_ps(_mm_loadu_ps(invMass + i), k4), s0, s1, s2);
+		float		*d= &speed[i].x;
+		const float	*p= &pos[i].x;
+		_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(s0, _mm_sub_ps(c0, _mm_loadu_ps(p)))));
+		_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(s1, _mm_sub_ps(c1, _mm_loadu_ps(p + 4)))));
+		_mm_storeu_ps(d + 8, _mm_add_ps(_mm_loadu_ps(d + 8), _mm_mul_ps(s2, _mm_sub_ps(c2, _mm_loadu_ps(p + 8)))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		speed[i]+= invMass[i] * k * (center - pos[i]);
+	}
+}
+
+// ***************************************************************************
+uint	CPSSimd::selectPlaneCrossings(const CPlane &p, const CVector *before, const CVector *after,
+									  uint count, float epsilon, uint32 *dest)
+{
+	uint32	*destStart= dest;
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	a= _mm_set1_ps(p.a);
+	__m128	b= _mm_set1_ps(p.b);
+	__m128	c= _mm_set1_ps(p.c);
+	__m128	d= _mm_set1_ps(p.d);
+	__m128	posEpsilon= _mm_set1_ps(epsilon);
+	__m128	negEpsilon= _mm_set1_ps(-epsilon);
+	for (; k + 4 <= count; k+= 4)
+	{
+		__m128	x, y, z;
+		loadTransposed(before + k, x, y, z);
+		__m128	posSide= _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z)), d);
+		loadTransposed(after + k, x, y, z);
+		__m128	negSide= _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z)), d);
+		int	mask= _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(posSide, negEpsilon), _mm_cmple_ps(negSide, posEpsilon)));
+		if (mask)
+			dest= appendMask(mask, k, dest);
+	}
+#endif
+	for (; k < count; ++k)
+	{
+		if (p * before[k] >= - epsilon && p * after[k] <= epsilon)
+			*dest++= k;
+	}
+	return (uint) (dest - destStart);
+}
+
+// ***************************************************************************
+uint	CPSSimd::selectSphereEntries(const CVector &center, float r2, const CVector *before, const CVector *after,
+									 uint count, uint32 *dest)
+{
+	uint32	*destStart= dest;
+	uint	k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	cx= _mm_set1_ps(center.x);
+	__m128	cy= _mm_set1_ps(center.y);
+	__m128	cz= _mm_set1_ps(center.z);
+	__m128	r2x4= _mm_set1_ps(r2);
+	for (; k + 4 <= count; k+= 4)
+	{
+		__m128	x, y, z;
+		loadTransposed(before + k, x, y, z);
+		x= _mm_sub_ps(x, cx); y= _mm_sub_ps(y, cy); z= _mm_sub_ps(z, cz);
+		__m128	rOut= _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		loadTransposed(after + k, x, y, z);
+		x= _mm_sub_ps(x, cx); y= _mm_sub_ps(y, cy); z= _mm_sub_ps(z, cz);
+		__m128	rIn= _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		int	mask= _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(rOut, r2x4), _mm_cmple_ps(rIn, r2x4)));
+		if (mask)
+			dest= appendMask(mask, k, dest);
+	}
+#endif
+	for (; k < count; ++k)
+	{
+		if ((before[k] - center) * (before[k] - center) > r2 && (after[k] - center) * (after[k] - center) <= r2)
+			*dest++= k;
+	}
+	return (uint) (dest - destStart);
+}
+
+
+} // NL3D
@@ -30,6 +30,8 @@
 #include "nel/3d/ps_util.h"
 #include "nel/3d/dru.h"
 #include "nel/3d/particle_system.h"
+#include "nel/3d/ps_simd.h"
+#include "nel/3d/ps_sim_buffers.h"
 #include "nel/misc/plane.h"
 
 // tmp
@@ -41,6 +43,9 @@
 
 namespace NL3D {
 
+// number of particles tested at once by the zones before computing the collisions of the selected ones
+static const uint PSZoneBatchSize = 128;
+
 
 /*
  * Constructor
@@ -204,11 +209,13 @@ void CPSZonePlane::deleteElement(uint32 index)
 void CPSZonePlane::computeCollisions(CPSLocated &target, uint firstInstanceIndex, const NLMISC::CVector *posBefore, const NLMISC::CVector *posAfter)
 {
 	NL_PS_FUNC(CPSZonePlane_computeCollisions)
+	std::vector<CPSCollisionInfo> &collisions = CPSSimBuffers::get().Collisions;
 	MINI_TIMER(PSStatsZonePlane)
 	// for each target, we must check whether they are going through the plane
 	// if so they must bounce
 	TPSAttribVector::const_iterator planePosIt, planePosEnd, normalIt;
 	CPSCollisionInfo ci;
+	uint32 candidates[PSZoneBatchSize];
 	// cycle through the planes
 	planePosEnd = _Owner->getPos().end();
 	for (planePosIt = _Owner->getPos().begin(), normalIt = _Normal.begin(); planePosIt != planePosEnd; ++planePosIt, ++normalIt)
@@ -219,16 +226,17 @@ void CPSZonePlane::computeCollisions(CPSLocated &target, uint firstInstanceIndex
 		const float epsilon = 0.5f * PSCollideEpsilon;
 		NLMISC::CPlane p;
 		p.make(m.mulVector(*normalIt), m * (*planePosIt));
-		// deals with each particle
-		const NLMISC::CVector *itPosBefore = posBefore + firstInstanceIndex;
-		const NLMISC::CVector *itPosBeforeEnd = posBefore + target.getSize();
-		const NLMISC::CVector *itPosAfter = posAfter + firstInstanceIndex;
-		while (itPosBefore != itPosBeforeEnd)
+		// deals with each particle, by batch : select the particles that go through the plane, then make them bounce
+		for (uint batchStart = firstInstanceIndex; batchStart < target.getSize(); batchStart += PSZoneBatchSize)
 		{
-			float posSide = p * *itPosBefore;
-			float negSide = p * *itPosAfter;
-			if (posSide >= - epsilon && negSide <= epsilon)
+			uint batchSize = std::min((uint) PSZoneBatchSize, (uint) (target.getSize() - batchStart));
+			uint numCandidates = CPSSimd::selectPlaneCrossings(p, posBefore + batchStart, posAfter + batchStart, batchSize, epsilon, candidates);
+			for (uint k = 0; k < numCandidates; ++k)
 			{
+				const NLMISC::CVector *itPosBefore = posBefore + batchStart + candidates[k];
+				const NLMISC::CVector *itPosAfter = posAfter + batchStart + candidates[k];
+				float posSide = p * *itPosBefore;
+				float negSide = p * *itPosAfter;
 				float alpha;
 				if (fabsf(posSide - negSide) > std::numeric_limits<float>::min())
 				{
@@ -245,10 +253,8 @@ void CPSZonePlane::computeCollisions(CPSLocated &target, uint firstInstanceIndex
 				const CVector &speed = target.getSpeed()[itPosBefore - posBefore];
 				ci.NewSpeed = _BounceFactor * (speed - 2.0f * (speed * p.getNormal()) * p.getNormal());
 				ci.CollisionZone = this;
-				CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+				collisions[itPosBefore - posBefore].update(ci);
 			}
-			++ itPosBefore;
-			++ itPosAfter;
 		}
 	}
 
@@ -300,13 +306,14 @@ void CPSZonePlane::serial(NLMISC::IStream &f) throw(NLMISC::EStream)
 void CPSZoneSphere::computeCollisions(CPSLocated &target, uint firstInstanceIndex, const NLMISC::CVector *posBefore, const NLMISC::CVector *posAfter)
 {
 	NL_PS_FUNC(CPSZoneSphere_computeCollisions)
+	std::vector<CPSCollisionInfo> &collisions = CPSSimBuffers::get().Collisions;
 	MINI_TIMER(PSStatsZoneSphere)
 	// for each target, we must check whether they are going through the plane
 	// if so they must bounce
 	TPSAttribRadiusPair::const_iterator radiusIt = _Radius.begin();
 	TPSAttribVector::const_iterator spherePosIt, spherePosEnd;
 	CPSCollisionInfo ci;
-	float rOut, rIn;
+	uint32 candidates[PSZoneBatchSize];
 	// cycle through the spheres
 	spherePosEnd = _Owner->getPos().end();
 	for (spherePosIt = _Owner->getPos().begin(), radiusIt = _Radius.begin(); spherePosIt != spherePosEnd; ++spherePosIt, ++radiusIt)
@@ -314,54 +321,45 @@ void CPSZoneSphere::computeCollisions(CPSLocated &target, uint firstInstanceInde
 		// we must setup the sphere in the good basis
 		const CMatrix &m = CPSLocated::getConversionMatrix(&target, this->_Owner);
 		CVector center = m * *spherePosIt;
-		// deals with each particle
-		const NLMISC::CVector *itPosBefore = posBefore + firstInstanceIndex;
-		const NLMISC::CVector *itPosBeforeEnd = posBefore + target.getSize();
-		const NLMISC::CVector *itPosAfter = posAfter + firstInstanceIndex;
-		while (itPosBefore != itPosBeforeEnd)
+		// deals with each particle, by batch : select the particles that enter the sphere, then make them bounce
+		// we don't use raytracing for now because it is too slow ...
+		for (uint batchStart = firstInstanceIndex; batchStart < target.getSize(); batchStart += PSZoneBatchSize)
 		{
-			// check whether the located is going through the sphere
-			// we don't use raytracing for now because it is too slow ...
-			rOut = (*itPosBefore - center) * (*itPosBefore - center);
-			// initial position outside the sphere ?
-			if (rOut > radiusIt->R2)
+			uint batchSize = std::min((uint) PSZoneBatchSize, (uint) (target.getSize() - batchStart));
+			uint numCandidates = CPSSimd::selectSphereEntries(center, radiusIt->R2, posBefore + batchStart, posAfter + batchStart, batchSize, candidates);
+			for (uint k = 0; k < numCandidates; ++k)
 			{
-				rIn = (*itPosAfter - center) * (*itPosAfter - center);
+				const NLMISC::CVector *itPosBefore = posBefore + batchStart + candidates[k];
+				const NLMISC::CVector *itPosAfter = posAfter + batchStart + candidates[k];
 				const CVector &pos = *itPosBefore;
 				const CVector &dest = *itPosAfter;
 				const CVector D = dest - pos;
-				// final position inside the sphere ?
-				if ( rIn <= radiusIt->R2)
+				// discriminant of the intersection equation
+				const float b = 2.f * (pos * D - D * center), a = D * D
+							, c = (pos * pos) + (center * center) - 2.f * (pos * center) - radiusIt->R2;
+				float d = b * b - 4 * a * c;
+				if (d > 0.f)
 				{
-					// discriminant of the intersection equation
-					const float b = 2.f * (pos * D - D * center), a = D * D
-								, c = (pos * pos) + (center * center) - 2.f * (pos * center) - radiusIt->R2;
-					float d = b * b - 4 * a * c;
-					if (d > 0.f)
-					{
-						d = sqrtf(d);
-						// roots of the equation, we take the smallest
-						const float r1 = .5f * (-b + 2.f * d) * a,
-									r2 = .5f * (-b - 2.f * d) * a;
-						const float  r = std::min(r1, r2);
-						// collision point
-						const CVector C = pos  + r * D;
-						const float alpha = ((C - pos) * D) * a;
-						const CVector startEnd = alpha * (dest - pos);
-						CVector normal = C - center;
-						normal = normal * (1.f / radiusIt->R);
-						ci.Dist = startEnd.norm();
-						// we translate the particle from an epsilon so that it won't get hooked to the sphere
-						ci.NewPos = pos  + startEnd + PSCollideEpsilon * normal;
-						const CVector &speed = target.getSpeed()[itPosBefore - posBefore];
-						ci.NewSpeed = _BounceFactor * (speed - 2.0f * (speed * normal) * normal);
-						ci.CollisionZone = this;
-						CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
-					}
+					d = sqrtf(d);
+					// roots of the equation, we take the smallest
+					const float r1 = .5f * (-b + 2.f * d) * a,
+								r2 = .5f * (-b - 2.f * d) * a;
+					const float  r = std::min(r1, r2);
+					// collision point
+					const CVector C = pos  + r * D;
+					const float alpha = ((C - pos) * D) * a;
+					const CVector startEnd = alpha * (dest - pos);
+					CVector normal = C - center;
+					normal = normal * (1.f / radiusIt->R);
+					ci.Dist = startEnd.norm();
+					// we translate the particle from an epsilon so that it won't get hooked to the sphere
+					ci.NewPos = pos  + startEnd + PSCollideEpsilon * normal;
+					const CVector &speed = target.getSpeed()[itPosBefore - posBefore];
+					ci.NewSpeed = _BounceFactor * (speed - 2.0f * (speed * normal) * normal);
+					ci.CollisionZone = this;
+					collisions[itPosBefore - posBefore].update(ci);
 				}
 			}
-			++ itPosBefore;
-			++ itPosAfter;
 		}
 	}
 
@@ -460,12 +458,14 @@ void CPSZoneSphere::deleteElement(uint32 index)
 void CPSZoneDisc::computeCollisions(CPSLocated &target, uint firstInstanceIndex, const NLMISC::CVector *posBefore, const NLMISC::CVector *posAfter)
 {
 	NL_PS_FUNC(CPSZoneDisc_computeCollisions)
+	std::vector<CPSCollisionInfo> &collisions = CPSSimBuffers::get().Collisions;
 	MINI_TIMER(PSStatsZoneDisc)
 	// for each target, we must check whether they are going through the disc
 	// if so they must bounce
 	TPSAttribVector::const_iterator discPosIt, discPosEnd, normalIt;
 	TPSAttribRadiusPair::const_iterator radiusIt;
 	CPSCollisionInfo ci;
+	uint32 candidates[PSZoneBatchSize];
 	// the square of radius at the hit point
 	float hitRadius2;
 	// alpha is the ratio that gives the percent of endPos - startPos that hit the disc
@@ -480,19 +480,19 @@ void CPSZoneDisc::computeCollisions(CPSLocated &target, uint firstInstanceIndex,
 		center = m * (*discPosIt);
 		p.make(m.mulVector(*normalIt), center);
 
-		// deals with each particle
 		const float epsilon = 0.5f * PSCollideEpsilon;
 
-		// deals with each particle
-		const NLMISC::CVector *itPosBefore = posBefore + firstInstanceIndex;
-		const NLMISC::CVector *itPosBeforeEnd = posBefore + target.getSize();
-		const NLMISC::CVector *itPosAfter = posAfter + firstInstanceIndex;
-		while (itPosBefore != itPosBeforeEnd)
+		// deals with each particle, by batch : select the particles that go through the disc plane, then check the radius
+		for (uint batchStart = firstInstanceIndex; batchStart < target.getSize(); batchStart += PSZoneBatchSize)
 		{
-			float posSide = p * *itPosBefore;
-			float negSide = p * *itPosAfter;
-			if (posSide >= - epsilon && negSide <= epsilon)
+			uint batchSize = std::min((uint) PSZoneBatchSize, (uint) (target.getSize() - batchStart));
+			uint numCandidates = CPSSimd::selectPlaneCrossings(p, posBefore + batchStart, posAfter + batchStart, batchSize, epsilon, candidates);
+			for (uint k = 0; k < numCandidates; ++k)
 			{
+				const NLMISC::CVector *itPosBefore = posBefore + batchStart + candidates[k];
+				const NLMISC::CVector *itPosAfter = posAfter + batchStart + candidates[k];
+				float posSide = p * *itPosBefore;
+				float negSide = p * *itPosAfter;
 				float alpha;
 				if (fabsf(posSide - negSide) > std::numeric_limits<float>::min())
 				{
@@ -513,12 +513,9 @@ void CPSZoneDisc::computeCollisions(CPSLocated &target, uint firstInstanceIndex,
 					const CVector &speed = target.getSpeed()[itPosBefore - posBefore];
 					ci.NewSpeed = _BounceFactor * (speed - 2.0f * (speed * p.getNormal()) * p.getNormal());
 					ci.CollisionZone = this;
-					CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+					collisions[itPosBefore - posBefore].update(ci);
 				}
-
 			}
-			++ itPosBefore;
-			++ itPosAfter;
 		}
 	}
 }
@@ -857,6 +854,7 @@ void CPSZoneCylinder::performMotion(TAnimationTime ellapsedTime)
 void CPSZoneCylinder::computeCollisions(CPSLocated &target, uint firstInstanceIndex, const NLMISC::CVector *posBefore, const NLMISC::CVector *posAfter)
 {
 	NL_PS_FUNC(CPSZoneCylinder_computeCollisions)
+	std::vector<CPSCollisionInfo> &collisions = CPSSimBuffers::get().Collisions;
 	MINI_TIMER(PSStatsZoneCylinder)
 	TPSAttribVector::const_iterator dimIt;
 	CPSAttrib<CPlaneBasis>::const_iterator basisIt;
@@ -970,7 +968,7 @@ void CPSZoneCylinder::computeCollisions(CPSLocated &target, uint firstInstanceIn
 						ci.Dist = startEnd.norm();
 						ci.NewSpeed = (-2.f * (speed * K)) * K + speed;
 						ci.CollisionZone = this;
-						CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+						collisions[itPosBefore - posBefore].update(ci);
 					}
 					else
 						if (alphaBottom < alphaCyl)
@@ -981,7 +979,7 @@ void CPSZoneCylinder::computeCollisions(CPSLocated &target, uint firstInstanceIn
 							ci.Dist = startEnd.norm();
 							ci.NewSpeed = (-2.f * (speed * K)) * K + speed;
 							ci.CollisionZone = this;
-							CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+							collisions[itPosBefore - posBefore].update(ci);
 						}
 						else
 						{
@@ -998,7 +996,7 @@ void CPSZoneCylinder::computeCollisions(CPSLocated &target, uint firstInstanceIn
 							ci.Dist = startEnd.norm();
 							ci.NewSpeed = (-2.f * (speed * normal)) * normal + speed;
 							ci.CollisionZone = this;
-							CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+							collisions[itPosBefore - posBefore].update(ci);
 						}
 
 				}
@@ -1133,6 +1131,7 @@ void CPSZoneCylinder::deleteElement(uint32 index)
 void CPSZoneRectangle::computeCollisions(CPSLocated &target, uint firstInstanceIndex, const NLMISC::CVector *posBefore, const NLMISC::CVector *posAfter)
 {
 	NL_PS_FUNC(CPSZoneRectangle_computeCollisions)
+	std::vector<CPSCollisionInfo> &collisions = CPSSimBuffers::get().Collisions;
 	MINI_TIMER(PSStatsZoneRectangle)
 	// for each target, we must check whether they are going through the rectangle
 	// if so they must bounce
@@ -1185,7 +1184,7 @@ void CPSZoneRectangle::computeCollisions(CPSLocated &target, uint firstInstanceI
 					const CVector &speed = target.getSpeed()[itPosBefore - posBefore];
 					ci.NewSpeed = _BounceFactor * (speed - 2.0f * (speed * p.getNormal()) * p.getNormal());
 					ci.CollisionZone = this;
-					CPSLocated::_Collisions[itPosBefore - posBefore].update(ci);
+					collisions[itPosBefore - posBefore].update(ci);
 				}
 			}
 			++ itPosBefore;
@@ -26,8 +26,6 @@
 
 namespace NL3D
 {
-	NLMISC::CPolygon2D CQuadGridBase::_ScaledPoly;
-	NLMISC::CPolygon2D::TRasterVect CQuadGridBase::_PolyBorders;
 	std::vector<uint> CQuadGridBase::_AlreadySelected;
 	uint CQuadGridBase::_SelectStamp = 0;
 } // NL3D
@@ -38,7 +38,6 @@ namespace NL3D
 
 
 H_AUTO_DECL( NL3D_QuadClip_ClusterClip );
-H_AUTO_DECL( NL3D_QuadClip_SonsShowNoClip );
 
 
 // ***************************************************************************
@@ -73,10 +72,46 @@ void		CQuadGridClipClusterListDist::clipSons(uint minDistSetup)
 	}
 }
 
+// ***************************************************************************
+void		CQuadGridClipClusterListDist::clipSonsCulled(uint minDistSetup)
+{
+	for(uint i=minDistSetup; i<Models.size();i++)
+	{
+		CTransformShape	** pModel= Models[i].begin();
+		uint	nSons= Models[i].size();
+		nlassert(ClipVisible[i].size()==nSons);
+		const uint8		*visible= nSons ? &ClipVisible[i][0] : NULL;
+		for(;nSons>0;nSons--, pModel++, visible++)
+		{
+			if(*visible)
+				(*pModel)->traverseClip();
+			else
+				(*pModel)->traverseClipCulled();
+		}
+	}
+}
+
+// ***************************************************************************
+void		CQuadGridClipClusterListDist::updateClipSpheres(uint distSetup)
+{
+	uint	numModels= Models[distSetup].size();
+	std::vector<CBSphere>	&spheres= ClipSpheres[distSetup];
+	if(spheres.size()!=numModels)
+	{
+		spheres.resize(numModels);
+		CTransformShape	** pModel= Models[distSetup].begin();
+		for(uint i=0;i<numModels;i++)
+			spheres[i]= pModel[i]->_QuadClusterClipSphere;
+	}
+	ClipVisible[distSetup].resize(numModels);
+}
+
 // ***************************************************************************
 void		CQuadGridClipClusterListDist::insertModel(uint distSetup, CTransformShape *model)
 {
 	Models[distSetup].insert(model, &model->_QuadClusterListNode);
+	// must rebuild the packed spheres
+	ClipSpheres[distSetup].clear();
 }
 
 
@@ -95,6 +130,8 @@ void		CQuadGridClipClusterListDist::resetSons(CClipTrav *clipTrav)
 		}
 		// unlink all my sons from me
 		Models[i].clear();
+		ClipSpheres[i].clear();
+		ClipVisible[i].clear();
 	}
 }
 
@@ -164,7 +201,11 @@ void	CQuadGridClipClusterQTreeNode::init(CQuadGridClipCluster *owner, uint level
 
 	// Create the distMax list only if root or leaf. No models in interleaved branches.
 	if( LeafNode)
+	{
 		ListNode.Models.resize(Owner->_NumDistTotal);
+		ListNode.ClipSpheres.resize(Owner->_NumDistTotal);
+		ListNode.ClipVisible.resize(Owner->_NumDistTotal);
+	}
 }
 
 
@@ -188,7 +229,7 @@ CQuadGridClipClusterQTreeNode::~CQuadGridClipClusterQTreeNode()
 }
 
 // ***************************************************************************
-void		CQuadGridClipClusterQTreeNode::clip(CClipTrav *clipTrav)
+void		CQuadGridClipClusterQTreeNode::clip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs)
 {
 	// if empty (test important for branch and leave clusters)
 	if(Empty)
@@ -234,36 +275,33 @@ void		CQuadGridClipClusterQTreeNode::clip(CClipTrav *clipTrav)
 				// NB if too far, set _NumDist (ie will clip only the infinite objects ones)
 				clamp(minDistSetup, 0, (sint)Owner->_NumDist);
 
-				// clip the sons individually
-				H_AUTO( NL3D_QuadClip_SonsClip );
-				ListNode.clipSons(minDistSetup);
+				// the sons will be clipped individually
+				CQuadGridClipJob	job;
+				job.List= &ListNode;
+				job.MinDistSetup= minDistSetup;
+				job.FrustumClip= true;
+				jobs.push_back(job);
 			}
 			else
 			{
 				// clip cluster sons
-				Sons[0]->clip(clipTrav);
-				Sons[1]->clip(clipTrav);
-				Sons[2]->clip(clipTrav);
-				Sons[3]->clip(clipTrav);
+				Sons[0]->clip(clipTrav, jobs);
+				Sons[1]->clip(clipTrav, jobs);
+				Sons[2]->clip(clipTrav, jobs);
+				Sons[3]->clip(clipTrav, jobs);
 			}
 		}
 		else
 		{
-			// udpdate the sons, but don't clip, because we know they are fully visible.
-			clipTrav->ForceNoFrustumClip= true;
-
-			// show all cluster sons or sons
-			noFrustumClip(clipTrav);
-
-			// reset flag
-			clipTrav->ForceNoFrustumClip= false;
+			// show all cluster sons or sons. The sons will be updated, but not clipped, because we know they are fully visible.
+			noFrustumClip(clipTrav, jobs);
 		}
 	}
 }
 
 
 // ***************************************************************************
-void		CQuadGridClipClusterQTreeNode::noFrustumClip(CClipTrav *clipTrav)
+void		CQuadGridClipClusterQTreeNode::noFrustumClip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs)
 {
 	// if empty (test important for branch and leave clusters)
 	if(Empty)
@@ -280,17 +318,20 @@ void		CQuadGridClipClusterQTreeNode::noFrustumClip(CClipTrav *clipTrav)
 		// NB if too far, set _NumDist (ie will clip only the infinite objects ones)
 		clamp(minDistSetup, 0, (sint)Owner->_NumDist);
 
-		// clip the sons
-		H_AUTO_USE( NL3D_QuadClip_SonsShowNoClip );
-		ListNode.clipSons(minDistSetup);
+		// the sons will be traversed with ForceNoFrustumClip
+		CQuadGridClipJob	job;
+		job.List= &ListNode;
+		job.MinDistSetup= minDistSetup;
+		job.FrustumClip= false;
+		jobs.push_back(job);
 	}
 	else
 	{
 		// forceShow of cluster sons
-		Sons[0]->noFrustumClip(clipTrav);
-		Sons[1]->noFrustumClip(clipTrav);
-		Sons[2]->noFrustumClip(clipTrav);
-		Sons[3]->noFrustumClip(clipTrav);
+		Sons[0]->noFrustumClip(clipTrav, jobs);
+		Sons[1]->noFrustumClip(clipTrav, jobs);
+		Sons[2]->noFrustumClip(clipTrav, jobs);
+		Sons[3]->noFrustumClip(clipTrav, jobs);
 	}
 }
 
@@ -426,6 +467,19 @@ void		CQuadGridClipCluster::addModel(const NLMISC::CAABBox &worldBBox, CTransfor
 		clamp(distSetup, 0, (sint)_NumDist);
 	}
 
+	// compute the world sphere for the batch clip. NB: linked models are frozen, they don't move until unlinked.
+	CBSphere	localSphere;
+	if(model->Shape && model->Shape->getClipSphere(localSphere))
+	{
+		localSphere.applyTransform(model->getWorldMatrix(), model->_QuadClusterClipSphere);
+	}
+	else
+	{
+		// never culled by the batch clip.
+		model->_QuadClusterClipSphere.Center= CVector::Null;
+		model->_QuadClusterClipSphere.Radius= FLT_MAX;
+	}
+
 	// add / recurs to the quadtree
 	_Root.insertModel(worldBBox, distSetup, model);
 }
@@ -439,12 +493,12 @@ void		CQuadGridClipCluster::removeModel(CTransformShape *model)
 
 
 // ***************************************************************************
-void		CQuadGridClipCluster::clip(CClipTrav *clipTrav)
+void		CQuadGridClipCluster::clip(CClipTrav *clipTrav, std::vector<CQuadGridClipJob> &jobs)
 {
 	H_AUTO_USE( NL3D_QuadClip_ClusterClip );
 
 	// clip the quadtree
-	_Root.clip(clipTrav);
+	_Root.clip(clipTrav, jobs);
 }
 
 // ***************************************************************************
@@ -300,13 +300,58 @@ void				CQuadGridClipManager::traverseClip()
 {
 	CClipTrav *pClipTrav= &getOwnerScene()->getClipTrav();
 
-	// Run All NotEmpty Clusters,
+	// Run All NotEmpty Clusters, to know the leaves whose sons must be traversed
+	_ClipJobs.clear();
 	CQuadGridClipCluster	**it;
 	it= _NotEmptyQuadGridClipClusters.begin();
 	uint	numClusters= _NotEmptyQuadGridClipClusters.size();
 	for(;numClusters>0;numClusters--,it++)
 	{
-		(*it)->clip(pClipTrav);
+		(*it)->clip(pClipTrav, _ClipJobs);
+	}
+
+	// Clip in batch the world spheres of the sons of the leaves partially in the pyramid
+	uint	i;
+	_ClipBatches.clear();
+	for(i=0;i<_ClipJobs.size();i++)
+	{
+		const CQuadGridClipJob	&job= _ClipJobs[i];
+		if(job.FrustumClip)
+		{
+			CQuadGridClipClusterListDist	&list= *job.List;
+			for(uint d=job.MinDistSetup;d<list.Models.size();d++)
+			{
+				list.updateClipSpheres(d);
+				if(list.ClipSpheres[d].empty())
+					continue;
+				CClipTrav::CSphereClipBatch	batch;
+				batch.Spheres= &list.ClipSpheres[d][0];
+				batch.Visible= &list.ClipVisible[d][0];
+				batch.NumSpheres= list.ClipSpheres[d].size();
+				_ClipBatches.push_back(batch);
+			}
+		}
+	}
+	pClipTrav->clipSphereBatches(_ClipBatches);
+
+	// Then traverse the sons, in the order of the leaves. Models out of their sphere are not clipped.
+	for(i=0;i<_ClipJobs.size();i++)
+	{
+		const CQuadGridClipJob	&job= _ClipJobs[i];
+		if(job.FrustumClip)
+		{
+			H_AUTO( NL3D_QuadClip_SonsClip );
+			job.List->clipSonsCulled(job.MinDistSetup);
+		}
+		else
+		{
+			H_AUTO( NL3D_QuadClip_SonsShowNoClip );
+			// udpdate the sons, but don't clip, because we know they are fully visible.
+			pClipTrav->ForceNoFrustumClip= true;
+			job.List->clipSons(job.MinDistSetup);
+			// reset flag
+			pClipTrav->ForceNoFrustumClip= false;
+		}
 	}
 }
 
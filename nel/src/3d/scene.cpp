@@ -618,6 +618,8 @@ void	CScene::renderPart(UScene::TRenderPart rp, bool	doHrcPass)
 		ClipTrav.traverse();
 		// animDetail
 		AnimDetailTrav.traverse();
+		// step the particle systems deferred by the animDetail pass (parallel animation)
+		_ParticleSystemManager.flushAnimate();
 		// loadBalance
 		LoadBalancingTrav.traverse();
 		//
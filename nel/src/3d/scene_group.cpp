@@ -973,6 +973,7 @@ bool CInstanceGroup::linkToParent (CInstanceGroup *pFather)
 							// relink to the new father found
 							pFather->_ClusterInstances[i]->Children.push_back(this->_ClusterInstances[j]);
 							this->_ClusterInstances[j]->Father = pFather->_ClusterInstances[i];
+							++_ClipTrav->ClusterSystemDate;
 						}
 						ret = true;
 					}
@@ -971,6 +971,30 @@ uint		CSceneUser::getMaxSkeletonsInNotCLodForm() const
 	return _Scene.getMaxSkeletonsInNotCLodForm();
 }
 
+// ***************************************************************************
+void		CSceneUser::enableParallelParticleSystemAnimate(uint numThreads)
+{
+	_Scene.getParticleSystemManager().enableParallelAnimate(numThreads);
+}
+
+// ***************************************************************************
+uint		CSceneUser::getParallelParticleSystemAnimateThreads() const
+{
+	return _Scene.getParticleSystemManager().getParallelAnimateThreads();
+}
+
+// ***************************************************************************
+void		CSceneUser::enableParallelClip(uint numThreads)
+{
+	_Scene.getClipTrav().enableParallelClip(numThreads);
+}
+
+// ***************************************************************************
+uint		CSceneUser::getParallelClipThreads() const
+{
+	return _Scene.getClipTrav().getParallelClipThreads();
+}
+
 
 // ***************************************************************************
 void		CSceneUser::enableElementRender(TRenderFilter elt, bool state)
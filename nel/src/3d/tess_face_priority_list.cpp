@@ -29,6 +29,10 @@
 #include "nel/3d/tessellation.h"
 #include "nel/misc/fast_floor.h"
 
+#ifdef NL_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
 
 using	namespace NLMISC;
 using	namespace std;
@@ -166,6 +170,13 @@ void		CTessFacePriorityList::init(float distStep, uint numEntries, float distMax
 
 	// Build the Rolling tables.
 	_RollingTables.resize(1+_NumQuadrant);
+	// Padded to a multiple of 4 for computeQuadrantDots().
+	uint	numDirPadded= (_RollingTables.size()+3) & ~3;
+	_QuadrantDirX.clear();
+	_QuadrantDirY.clear();
+	_QuadrantDirX.resize(numDirPadded, 0.f);
+	_QuadrantDirY.resize(numDirPadded, 0.f);
+	_QuadrantDots.resize(numDirPadded);
 	for(i=0;i<_RollingTables.size();i++)
 	{
 		_RollingTables[i].init(_NEntries);
@@ -180,6 +191,10 @@ void		CTessFacePriorityList::init(float distStep, uint numEntries, float distMax
 			// setup the vector
 			_RollingTables[i].QuadrantDirection= mat.getJ();
 		}
+		else
+			_RollingTables[i].QuadrantDirection= CVector::Null;
+		_QuadrantDirX[i]= _RollingTables[i].QuadrantDirection.x;
+		_QuadrantDirY[i]= _RollingTables[i].QuadrantDirection.y;
 	}
 
 	// Build Quarter Selection. In is in CCW order. Out: see selectQuadrant()
@@ -213,7 +228,10 @@ uint		CTessFacePriorityList::selectQuadrant(const CVector &direction)
 
 	// select the quarter.
 	uint	quarterId;
-#if defined(NL_OS_WINDOWS) && !defined(NL_NO_ASM)
+#if defined(NL_HAS_SSE2)
+	// sign bits of x and y => bit0 and bit1
+	quarterId= _mm_movemask_ps(_mm_set_ps(0, 0, direction.y, direction.x));
+#elif defined(NL_OS_WINDOWS) && !defined(NL_NO_ASM)
 	__asm
 	{
 		mov		esi, direction
@@ -248,6 +266,8 @@ uint		CTessFacePriorityList::selectQuadrant(const CVector &direction)
 
 
 	// For all quadrants of the quarter, return the best direction
+	float	*dots= &_QuadrantDots[0];
+	computeQuadrantDots(direction, quadrantStart, quadrantEnd, dots);
 	float	bestDirPs= -FLT_MAX;
 	uint	bestQuadrant= 0;
 	for(uint i=quadrantStart;i<quadrantEnd;i++)
@@ -255,7 +275,7 @@ uint		CTessFacePriorityList::selectQuadrant(const CVector &direction)
 		// get the quadrant Id. Must mask for last (0). And Start at 1 in the _RollingTables.
 //		uint	quadrantId= (i&_MaskQuadrant)+1;
 		// Test with this quadrant
-		float	ps= direction*_RollingTables[i].QuadrantDirection;
+		float	ps= dots[i-quadrantStart];
 		if(ps>bestDirPs)
 		{
 			bestDirPs= ps;
@@ -267,6 +287,29 @@ uint		CTessFacePriorityList::selectQuadrant(const CVector &direction)
 }
 
 
+// ***************************************************************************
+void		CTessFacePriorityList::computeQuadrantDots(const CVector &direction, uint start, uint end, float *dots) const
+{
+	// NB: QuadrantDirection.z is always 0 (rotateZ of J), so only XY are used.
+	const float	*dirX= &_QuadrantDirX[0];
+	const float	*dirY= &_QuadrantDirY[0];
+	uint	i= start;
+#ifdef NL_HAS_SSE2
+	__m128	dx= _mm_set1_ps(direction.x);
+	__m128	dy= _mm_set1_ps(direction.y);
+	for(;i+4<=end;i+=4, dots+=4)
+	{
+		__m128	ps= _mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(dirX+i)), _mm_mul_ps(dy, _mm_loadu_ps(dirY+i)));
+		_mm_storeu_ps(dots, ps);
+	}
+#endif
+	for(;i<end;i++, dots++)
+	{
+		*dots= direction.x*dirX[i] + direction.y*dirY[i];
+	}
+}
+
+
 // ***************************************************************************
 void		CTessFacePriorityList::insert(uint quadrantId, float distance, CTessFace *value)
 {
@@ -316,6 +359,10 @@ void		CTessFacePriorityList::shift(const CVector &direction, CTessFacePListNode
 
 	pulledElements.unlinkInPList();
 
+	// Compute the distance run along each quadrant direction in one pass.
+	float	*dots= &_QuadrantDots[0];
+	computeQuadrantDots(direction, 0, _RollingTables.size(), dots);
+
 	// Shift all the rolling tables
 	for(uint i=0;i<_RollingTables.size();i++)
 	{
@@ -330,7 +377,7 @@ void		CTessFacePriorityList::shift(const CVector &direction, CTessFacePListNode
 		// Else compute the effective distance we run to the plane.
 		else
 		{
-			shiftDistance= direction*rollTable.QuadrantDirection;
+			shiftDistance= dots[i];
 			// For now, just clamp, but may be interesting to shift Back the rolling table !!
 			shiftDistance= max(0.f, shiftDistance);
 		}
@@ -346,21 +346,15 @@ ITrack	*CTrackSampledQuat::applyTrackQuatHeaderCompressionPass1(uint &globalKeyO
 	}
 
 	// OK! this track can be converted to a CTrackSampledQuatSmallHeader
-	uint	keyIndex= globalKeyOffset;
 
 	// increment the number of keys in the packed data
 	globalKeyOffset+= _Keys.size();
 
-	// **** fill the packer struct
-	uint	i;
-	for(i=0;i<_Keys.size();i++)
-	{
-		quatPacker.Times[keyIndex+i]= _TimeBlocks[0].Times[i];
-		quatPacker.Keys[keyIndex+i]= _Keys[i];
-	}
+	// **** add the keys to the packer struct
+	uint	trackIndex= quatPacker.addTrack(headerIndex, _Keys.empty()?NULL:&_TimeBlocks[0].Times[0], _Keys.empty()?NULL:&_Keys[0], _Keys.size());
 
 	// **** Build the compressed quat, and return it
-	return new CTrackSampledQuatSmallHeader(&quatPacker, (uint8)headerIndex, (uint8)_Keys.size(), keyIndex);
+	return new CTrackSampledQuatSmallHeader(&quatPacker, (uint8)headerIndex, (uint8)_Keys.size(), (uint16)trackIndex);
 }
 
 
@@ -26,6 +26,10 @@
 #include "nel/3d/track_sampled_quat_small_header.h"
 #include "nel/misc/algo.h"
 
+#if defined(NL_HAS_SSE2) && defined(NL3D_TSQ_ALLOW_QUAT_COMPRESS)
+#include <emmintrin.h>
+#endif
+
 
 using namespace std;
 using namespace NLMISC;
@@ -36,62 +40,205 @@ namespace NL3D
 
 
 // ***************************************************************************
-CTrackSampledQuatSmallHeader::CTrackSampledQuatSmallHeader(CTrackSamplePack *pack, uint8 headerIndex, uint8 numKeys, uint16 keyIndex)
-{
-	nlassert(pack);
-	_TrackSamplePack= pack;
-	_IndexTrackHeader= headerIndex;
-	_NumKeys= numKeys;
-	_KeyIndex= keyIndex;
-}
+// ***************************************************************************
+// Key decompression
+// ***************************************************************************
+// ***************************************************************************
+
+
+#if defined(NL_HAS_SSE2) && defined(NL3D_TSQ_ALLOW_QUAT_COMPRESS)
+
+// Same as in CQuatPack::unpack()
+static const double	NL3D_TSP_OO32767= 1.0f/32767;
 
 // ***************************************************************************
-CTrackSampledQuatSmallHeader::~CTrackSampledQuatSmallHeader()
+/* Unpack 2 keys at once. Same computation as CQuatPack::unpack(), in the same order and in double
+ *	precision, hence the same result. Return false if one of the keys is null (must be unpacked by CQuatPack)
+ */
+static inline bool	unpackQuat2(const CQuatPack &key0, const CQuatPack &key1, CQuat &quat0, CQuat &quat1)
 {
+	__m128d	oo= _mm_set1_pd(NL3D_TSP_OO32767);
+	__m128d	x= _mm_mul_pd(_mm_setr_pd(key0.x, key1.x), oo);
+	__m128d	y= _mm_mul_pd(_mm_setr_pd(key0.y, key1.y), oo);
+	__m128d	z= _mm_mul_pd(_mm_setr_pd(key0.z, key1.z), oo);
+	__m128d	w= _mm_mul_pd(_mm_setr_pd(key0.w, key1.w), oo);
+
+	// norm
+	__m128d	norm= _mm_mul_pd(x, x);
+	norm= _mm_add_pd(norm, _mm_mul_pd(y, y));
+	norm= _mm_add_pd(norm, _mm_mul_pd(z, z));
+	norm= _mm_add_pd(norm, _mm_mul_pd(w, w));
+	norm= _mm_sqrt_pd(norm);
+	if(_mm_movemask_pd(_mm_cmpeq_pd(norm, _mm_setzero_pd())))
+		return false;
+
+	// normalize
+	__m128d	oonorm= _mm_div_pd(_mm_set1_pd(1.0), norm);
+	__m128	xy= _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(x, oonorm)), _mm_cvtpd_ps(_mm_mul_pd(y, oonorm)));
+	__m128	zw= _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(z, oonorm)), _mm_cvtpd_ps(_mm_mul_pd(w, oonorm)));
+
+	// (x0, x1, y0, y1), (z0, z1, w0, w1) => (x0, y0, z0, w0), (x1, y1, z1, w1)
+	__m128	t0= _mm_unpacklo_ps(xy, zw);	// (x0, z0, x1, z1)
+	__m128	t1= _mm_unpackhi_ps(xy, zw);	// (y0, w0, y1, w1)
+	_mm_storeu_ps(&quat0.x, _mm_unpacklo_ps(t0, t1));
+	_mm_storeu_ps(&quat1.x, _mm_unpackhi_ps(t0, t1));
+
+	return true;
 }
 
+#endif
+
 
 // ***************************************************************************
-bool					CTrackSampledQuatSmallHeader::getLoopMode() const
+// Unpack an array of keys
+static void	unpackQuats(CQuatPack *const *keys, uint numKeys, CQuat *quats)
 {
-	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].LoopMode;
+	uint	i= 0;
+#if defined(NL_HAS_SSE2) && defined(NL3D_TSQ_ALLOW_QUAT_COMPRESS)
+	for(; i+2<=numKeys; i+= 2)
+	{
+		if(!unpackQuat2(*keys[i], *keys[i+1], quats[i], quats[i+1]))
+		{
+			keys[i]->unpack(quats[i]);
+			keys[i+1]->unpack(quats[i+1]);
+		}
+	}
+#endif
+	for(; i<numKeys; i++)
+	{
+		keys[i]->unpack(quats[i]);
+	}
 }
 
+
 // ***************************************************************************
-TAnimationTime			CTrackSampledQuatSmallHeader::getBeginTime () const
+// ***************************************************************************
+// CTrackSamplePack
+// ***************************************************************************
+// ***************************************************************************
+
+
+// ***************************************************************************
+uint	CTrackSamplePack::addTrack(uint headerIndex, const uint8 *times, const CQuatPack *keys, uint numKeys)
 {
-	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].BeginTime;
+	nlassert(headerIndex<TrackHeaders.size());
+	nlassert(numKeys<256);
+
+	// the index of the track in its header
+	uint	trackIndex= 0;
+	for(uint i=0; i<_BuildTracks.size(); i++)
+	{
+		if(_BuildTracks[i].HeaderIndex==headerIndex)
+			trackIndex++;
+	}
+	nlassert(trackIndex<65536);
+
+	_BuildTracks.push_back(CBuildTrack());
+	CBuildTrack	&track= _BuildTracks.back();
+	track.HeaderIndex= headerIndex;
+	track.Times.assign(times, times+numKeys);
+	track.Keys.assign(keys, keys+numKeys);
+
+	return trackIndex;
 }
 
 // ***************************************************************************
-TAnimationTime			CTrackSampledQuatSmallHeader::getEndTime () const
+void	CTrackSamplePack::build()
 {
-	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].EndTime;
+	uint	h, b, i, k;
+
+	// **** Count the tracks and the blocks of each header
+	HeaderTracks.resize(TrackHeaders.size());
+	for(h=0; h<HeaderTracks.size(); h++)
+	{
+		HeaderTracks[h].NumTracks= 0;
+		HeaderTracks[h].NumBlocks= 1;
+	}
+	for(i=0; i<_BuildTracks.size(); i++)
+	{
+		CBuildTrack		&track= _BuildTracks[i];
+		CHeaderTracks	&headerTracks= HeaderTracks[track.HeaderIndex];
+		headerTracks.NumTracks++;
+		if(!track.Times.empty())
+			headerTracks.NumBlocks= max(headerTracks.NumBlocks, (uint16)(track.Times.back()/BlockSize + 1));
+	}
+
+	// the tracks of each header, in the order they have been added
+	vector<vector<CBuildTrack*> >	tracksByHeader(HeaderTracks.size());
+	for(i=0; i<_BuildTracks.size(); i++)
+		tracksByHeader[_BuildTracks[i].HeaderIndex].push_back(&_BuildTracks[i]);
+
+	// **** Fill the blocks
+	uint	numBlockKeys= 0;
+	for(h=0; h<HeaderTracks.size(); h++)
+	{
+		HeaderTracks[h].BlockKeysIndex= numBlockKeys;
+		numBlockKeys+= HeaderTracks[h].NumBlocks * HeaderTracks[h].NumTracks;
+	}
+	BlockKeys.resize(numBlockKeys);
+
+	vector<uint8>		times;
+	vector<CQuatPack>	keys;
+	for(h=0; h<HeaderTracks.size(); h++)
+	{
+		CHeaderTracks	&headerTracks= HeaderTracks[h];
+		for(b=0; b<headerTracks.NumBlocks; b++)
+		{
+			uint	blockStart= b*BlockSize;
+			uint	blockEnd= blockStart+BlockSize;
+			for(i=0; i<headerTracks.NumTracks; i++)
+			{
+				CBuildTrack	&track= *tracksByHeader[h][i];
+				CBlockKeys	&blockKeys= BlockKeys[headerTracks.BlockKeysIndex + b*headerTracks.NumTracks + i];
+				blockKeys.KeyIndex= times.size();
+				blockKeys.NumKeys= 0;
+
+				for(k=0; k<track.Times.size(); k++)
+				{
+					uint	time= track.Times[k];
+					// the last key before the block, the keys in the block and the first key after the block
+					bool	lastBefore= time<blockStart && (k+1==track.Times.size() || track.Times[k+1]>=blockStart);
+					bool	firstAfter= time>=blockEnd && (k==0 || track.Times[k-1]<blockEnd);
+					if(lastBefore || firstAfter || (time>=blockStart && time<blockEnd))
+					{
+						times.push_back(track.Times[k]);
+						keys.push_back(track.Keys[k]);
+						blockKeys.NumKeys++;
+					}
+				}
+			}
+		}
+	}
+
+	// copy
+	Times.resize(times.size());
+	Keys.resize(keys.size());
+	for(k=0; k<times.size(); k++)
+	{
+		Times[k]= times[k];
+		Keys[k]= keys[k];
+	}
+
+	// the build data is no more needed
+	contReset(_BuildTracks);
 }
 
 // ***************************************************************************
-CTrackSampledQuatSmallHeader::TEvalType				CTrackSampledQuatSmallHeader::evalTime (const TAnimationTime& date, uint &keyId0, uint &keyId1, float &interpValue)
+void	CTrackSamplePack::evalHeaderTime(const CTrackSampleHeader &trackHeader, const TAnimationTime &date, float &localTime, uint8 &frame)
 {
 	/* IF YOU CHANGE THIS CODE, CHANGE too CTrackSampledQuatCommon
 	 */
 
-	// Empty? quit
-	if(_NumKeys==0)
-		return EvalDiscard;
-
-	// One Key? easy, and quit.
-	if(_NumKeys==1)
+	// Only tracks with one key have a null range: they always eval their key
+	if(trackHeader.TotalRange<=0)
 	{
-		keyId0= 0;
-		return EvalKey0;
+		localTime= 0;
+		frame= 0;
+		return;
 	}
 
-	// Get the Track header info
-	CTrackSampleHeader	&trackHeader= _TrackSamplePack->TrackHeaders[_IndexTrackHeader];
-
 	// manage Loop
 	//=====================
-	float	localTime;
 	if(trackHeader.LoopMode)
 	{
 		nlassert(trackHeader.TotalRange>0);
@@ -119,107 +266,191 @@ CTrackSampledQuatSmallHeader::TEvalType				CTrackSampledQuatSmallHeader::evalTim
 		localTime= date-trackHeader.BeginTime;
 	}
 
-	// get times ptr in packed data
-	uint8	*times= &_TrackSamplePack->Times[_KeyIndex];
-
-
-	// Find the first key before localTime
-	//=====================
 	// get the frame in the track.
-	sint	frame= (sint)floor(localTime*trackHeader.OODeltaTime);
+	sint	f= (sint)floor(localTime*trackHeader.OODeltaTime);
 	// clamp to uint8
-	clamp(frame, 0, 255);
-
-	// get the key.
-	keyId0= searchLowerBound(times, _NumKeys, (uint8)frame);
+	clamp(f, 0, 255);
+	frame= (uint8)f;
+}
 
-	// Get the Frame of Key0.
-	uint		frameKey0= times[keyId0];
+// ***************************************************************************
+void	CTrackSamplePack::evalTracks(const TAnimationTime &date, const uint32 *tracks, uint numTracks, CQuat *result)
+{
+	// The tracks are evaluated by packets: first find the keys of all the tracks, then unpack them, then interpolate
+	const uint	PacketSize= 64;
+	CQuatPack	*packetKeys[PacketSize*2];
+	CQuat		packetQuats[PacketSize*2];
+	float		packetInterp[PacketSize];
+	bool		packetSlerp[PacketSize];
+
+	// Time of the last header used. Typically, all the tracks of an animation have the same header.
+	uint	lastHeader= 0xffffffff;
+	const CTrackSampleHeader	*trackHeader= NULL;
+	const CHeaderTracks			*headerTracks= NULL;
+	float	localTime= 0;
+	uint8	frame= 0;
+	uint	block= 0;
+
+	for(uint packetStart=0; packetStart<numTracks; packetStart+= PacketSize)
+	{
+		uint	packetSize= min(PacketSize, numTracks-packetStart);
+		uint	numKeys= 0;
+		uint	i;
 
+		// **** Find the keys
+		for(i=0; i<packetSize; i++)
+		{
+			uint32	trackId= tracks[packetStart+i];
+			uint	headerIndex= trackId>>16;
+			uint	trackIndex= trackId&0xffff;
+
+			// Eval the time of the header
+			if(headerIndex!=lastHeader)
+			{
+				nlassert(headerIndex<HeaderTracks.size());
+				lastHeader= headerIndex;
+				trackHeader= &TrackHeaders[headerIndex];
+				headerTracks= &HeaderTracks[headerIndex];
+				evalHeaderTime(*trackHeader, date, localTime, frame);
+				block= min((uint)frame/BlockSize, (uint)headerTracks->NumBlocks-1);
+			}
+			nlassert(trackIndex<headerTracks->NumTracks);
+
+			// Get the keys of the track in the block
+			const CBlockKeys	&blockKeys= BlockKeys[headerTracks->BlockKeysIndex + block*headerTracks->NumTracks + trackIndex];
+			nlassert(blockKeys.NumKeys>0);
+			uint8		*times= &Times[blockKeys.KeyIndex];
+			CQuatPack	*keys= &Keys[blockKeys.KeyIndex];
+
+			// Find the first key before localTime
+			uint	keyId0= searchLowerBound(times, blockKeys.NumKeys, frame);
+			packetKeys[numKeys++]= &keys[keyId0];
+			packetSlerp[i]= false;
+
+			// If not the last Key, interpolate with next key
+			if(keyId0<(uint)blockKeys.NumKeys-1)
+			{
+				uint	keyId1= keyId0+1;
+
+				// If the 2 keys have same value, no need to interpolate
+				if(!(keys[keyId0] == keys[keyId1]))
+				{
+					uint	frameKey0= times[keyId0];
+					uint	frameKey1= times[keyId1];
+
+					// unpack time.
+					float	time0= frameKey0*trackHeader->DeltaTime;
+					float	time1= frameKey1*trackHeader->DeltaTime;
+
+					// interpolate.
+					float	t= (localTime-time0);
+					// If difference is one frame, optimize.
+					if(frameKey1-frameKey0==1)
+						t*= trackHeader->OODeltaTime;
+					else
+						t/= (time1-time0);
+					clamp(t, 0.f, 1.f);
+
+					packetInterp[i]= t;
+					packetSlerp[i]= true;
+					packetKeys[numKeys++]= &keys[keyId1];
+				}
+			}
+		}
 
-	// Interpolate with next key
-	//=====================
+		// **** Unpack the keys
+		unpackQuats(packetKeys, numKeys, packetQuats);
 
-	// If not the last Key
-	if(keyId0<(uint)_NumKeys-1)
-	{
-		// Get the next key.
-		keyId1= keyId0+1;
-		uint		frameKey1= times[keyId1];
-
-		// unpack time.
-		float	time0= frameKey0*trackHeader.DeltaTime;
-		float	time1= frameKey1*trackHeader.DeltaTime;
-
-		// interpolate.
-		float	t= (localTime-time0);
-		// If difference is one frame, optimize.
-		if(frameKey1-frameKey0==1)
-			t*= trackHeader.OODeltaTime;
-		else
-			t/= (time1-time0);
-		clamp(t, 0.f, 1.f);
-
-		// store this interp value.
-		interpValue= t;
-
-		return EvalInterpolate;
+		// **** Interpolate
+		CQuat	*quat= packetQuats;
+		for(i=0; i<packetSize; i++)
+		{
+			if(packetSlerp[i])
+			{
+				result[packetStart+i]= CQuat::slerp(quat[0], quat[1], packetInterp[i]);
+				quat+= 2;
+			}
+			else
+			{
+				result[packetStart+i]= quat[0];
+				quat++;
+			}
+		}
 	}
-	// else (last key of anim), just eval this key.
-	return EvalKey0;
 }
 
+
 // ***************************************************************************
-const IAnimatedValue	&CTrackSampledQuatSmallHeader::eval (const TAnimationTime& date, CAnimatedValueBlock &avBlock)
+// ***************************************************************************
+// CTrackSampledQuatSmallHeader
+// ***************************************************************************
+// ***************************************************************************
+
+
+// ***************************************************************************
+CTrackSampledQuatSmallHeader::CTrackSampledQuatSmallHeader(CTrackSamplePack *pack, uint8 headerIndex, uint8 numKeys, uint16 trackIndex)
 {
-	/* IF YOU CHANGE THIS CODE, CHANGE too CTrackSampledQuatSmallHeader
-	 */
+	nlassert(pack);
+	_TrackSamplePack= pack;
+	_IndexTrackHeader= headerIndex;
+	_NumKeys= numKeys;
+	_TrackIndex= trackIndex;
+}
 
-	// **** Eval time, and get key interpolation info
-	uint	keyId0;
-	uint	keyId1;
-	float	interpValue;
-	TEvalType	evalType= evalTime(date, keyId0, keyId1, interpValue);
+// ***************************************************************************
+CTrackSampledQuatSmallHeader::~CTrackSampledQuatSmallHeader()
+{
+}
 
-	// **** Eval Keys
-	// get starting keys
-	CQuatPack	*keys= &_TrackSamplePack->Keys[_KeyIndex];
 
-	// Discard?
-	if( evalType==EvalDiscard )
+// ***************************************************************************
+bool					CTrackSampledQuatSmallHeader::getLoopMode() const
+{
+	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].LoopMode;
+}
+
+// ***************************************************************************
+TAnimationTime			CTrackSampledQuatSmallHeader::getBeginTime () const
+{
+	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].BeginTime;
+}
+
+// ***************************************************************************
+TAnimationTime			CTrackSampledQuatSmallHeader::getEndTime () const
+{
+	return _TrackSamplePack->TrackHeaders[_IndexTrackHeader].EndTime;
+}
+
+// ***************************************************************************
+uint32					CTrackSampledQuatSmallHeader::getTrackSamplePackId() const
+{
+	if(_NumKeys==0)
+		return 0xffffffff;
+	return CTrackSamplePack::getTrackId(_IndexTrackHeader, _TrackIndex);
+}
+
+// ***************************************************************************
+const IAnimatedValue	&CTrackSampledQuatSmallHeader::eval (const TAnimationTime& date, CAnimatedValueBlock &avBlock)
+{
+	/* IF YOU CHANGE THIS CODE, CHANGE too CTrackSampledQuat
+	 */
+
+	// Empty? quit
+	if(_NumKeys==0)
 		return avBlock.ValQuat;
+
 	// One Key? easy, and quit.
-	else if( evalType==EvalKey0 )
+	if(_NumKeys==1)
 	{
-		keys[keyId0].unpack(avBlock.ValQuat.Value);
+		// it is the first key of the block 0
+		const CTrackSamplePack::CBlockKeys	&blockKeys= _TrackSamplePack->BlockKeys[_TrackSamplePack->HeaderTracks[_IndexTrackHeader].BlockKeysIndex + _TrackIndex];
+		_TrackSamplePack->Keys[blockKeys.KeyIndex].unpack(avBlock.ValQuat.Value);
+		return avBlock.ValQuat;
 	}
-	// interpolate
-	else if( evalType==EvalInterpolate )
-	{
-		CQuatPack	valueKey0= keys[keyId0];
-		CQuatPack	valueKey1= keys[keyId1];
 
-		// If the 2 keys have same value, just unpack.
-		if(valueKey0 == valueKey1)
-		{
-			valueKey0.unpack(avBlock.ValQuat.Value);
-		}
-		// else interpolate
-		else
-		{
-			// unpack key value.
-			CQuat	quat0, quat1;
-			valueKey0.unpack(quat0);
-			valueKey1.unpack(quat1);
-
-			// interpolate
-			avBlock.ValQuat.Value= CQuat::slerp(quat0, quat1, interpValue);
-		}
-	}
-	else
-	{
-		nlstop;
-	}
+	// Eval the keys in the pack
+	uint32	trackId= CTrackSamplePack::getTrackId(_IndexTrackHeader, _TrackIndex);
+	_TrackSamplePack->evalTracks(date, &trackId, 1, &avBlock.ValQuat.Value);
 
 	return avBlock.ValQuat;
 }
@@ -937,6 +937,27 @@ void	CTransform::traverseClip()
 }
 
 
+// ***************************************************************************
+void	CTransform::traverseClipCulled()
+{
+	// clip() is not called in those cases, or sons must be traversed.
+	if( (_StateFlags & UserClipping) || _AncestorSkeletonModel!=NULL || clipGetNumChildren()!=0 )
+	{
+		traverseClip();
+		return;
+	}
+
+	CClipTrav		&clipTrav= getOwnerScene()->getClipTrav();
+
+	if ((_ClipDate == clipTrav.CurrentDate) && _Visible)
+		return;
+	_ClipDate = clipTrav.CurrentDate;
+
+	// clip() would have returned false.
+	_Visible= false;
+}
+
+
 
 // ***************************************************************************
 // ***************************************************************************
@@ -48,6 +48,7 @@ class CFormElm : public UFormElm
 	friend class CForm;
 	friend class CType;
 	friend class CFormDfn;
+	friend class CFormElmPath;
 public:
 
 	// Contructor
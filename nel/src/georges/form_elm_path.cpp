@@ -0,0 +1,418 @@
+/** \file form_elm_path.cpp
+ * Georges form element path, compiled against a dfn
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdgeorges.h"
+
+#include "nel/georges/form_elm_path.h"
+
+#include "form.h"
+#include "form_elm.h"
+#include "form_dfn.h"
+#include "type.h"
+
+using namespace NLMISC;
+using namespace std;
+
+namespace NLGEORGES
+{
+
+// ***************************************************************************
+
+CFormElmPath::CFormElmPath ()
+{
+	_Compiled = false;
+	_ParentDfn = NULL;
+	_IndexDfn = 0xffffffff;
+	_NodeType = NULL;
+	_Type = UFormDfn::EntryDfn;
+}
+
+// ***************************************************************************
+
+CFormElmPath::~CFormElmPath ()
+{
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::compile (const UFormElm &uroot, const std::string &path)
+{
+	_Path = path;
+	_Steps.clear ();
+	_RootDfn = NULL;
+	_Compiled = false;
+	_ParentDfn = NULL;
+	_IndexDfn = 0xffffffff;
+	_NodeType = NULL;
+	_Type = UFormDfn::EntryDfn;
+
+	// Must be the root node of a form
+	const CFormElm *root = safe_cast<const CFormElm*> (&uroot);
+	if (root->ParentNode || !root->isStruct () || root->isVirtualStruct ())
+		return false;
+	_RootDfn = safe_cast<const CFormElmStruct*> (root)->FormDfn;
+
+	// Parse the path as CFormElm::getInternalNodeByName() does, but only with the dfn
+	const CFormDfn *parentDfn = NULL;
+	uint indexDfn = 0xffffffff;
+	const CFormDfn *nodeDfn = _RootDfn;
+	const CType *nodeType = NULL;
+	UFormDfn::TEntryType type = UFormDfn::EntryDfn;
+	bool array = false;
+	bool wantArrayIndex = false;
+	bool inArrayIndex = false;
+	uint arrayIndex = 0xffffffff;
+
+	const char *startToken = path.c_str ();
+	const char *endToken;
+	string token;
+	uint errorIndex;
+	uint code;
+	while ((endToken = CFormElm::tokenize (startToken, token, errorIndex, code)))
+	{
+		if (!inArrayIndex)
+		{
+			switch (code)
+			{
+			case CFormElm::TokenString:
+				{
+					// Only the struct of the dfn can be compiled, the dfn of a virtual struct depends on the form
+					if (wantArrayIndex || (type != UFormDfn::EntryDfn) || (nodeDfn == NULL))
+						return false;
+
+					// Look for the element in the dfn and its parents. The elements of the struct node are in the same order.
+					vector<const CFormDfn*> arrayDfn;
+					arrayDfn.reserve (nodeDfn->countParentDfn ());
+					nodeDfn->getParentDfn (arrayDfn);
+
+					bool found = false;
+					uint formElm = 0;
+					for (uint i=0; (i<arrayDfn.size ()) && !found; i++)
+					{
+						const CFormDfn &dfn = *(arrayDfn[i]);
+						for (uint element=0; element<dfn.getNumEntry (); element++)
+						{
+							const CFormDfn::CEntry &entry = dfn.getEntry (element);
+							if (entry.getName () == token)
+							{
+								parentDfn = &dfn;
+								indexDfn = element;
+								nodeDfn = entry.getDfnPtr ();
+								nodeType = entry.getTypePtr ();
+								type = entry.getType ();
+								array = entry.getArrayFlag ();
+								wantArrayIndex = array;
+								found = true;
+								break;
+							}
+							formElm++;
+						}
+					}
+					if (!found)
+						return false;
+
+					CStep step;
+					step.Index = formElm;
+					step.Array = false;
+					_Steps.push_back (step);
+				}
+				break;
+			case CFormElm::TokenPoint:
+				if (wantArrayIndex || (type != UFormDfn::EntryDfn))
+					return false;
+				break;
+			case CFormElm::TokenArrayBegin:
+				if (!array)
+					return false;
+				inArrayIndex = true;
+				arrayIndex = 0xffffffff;
+				break;
+			default:
+				return false;
+			}
+		}
+		else
+		{
+			switch (code)
+			{
+			case CFormElm::TokenString:
+				if (sscanf (token.c_str(), "%d", &arrayIndex)!=1)
+					return false;
+				break;
+			case CFormElm::TokenArrayEnd:
+				{
+					if (arrayIndex == 0xffffffff)
+						return false;
+
+					CStep step;
+					step.Index = arrayIndex;
+					step.Array = true;
+					_Steps.push_back (step);
+
+					// The array cell
+					const CFormDfn::CEntry &entry = parentDfn->getEntry (indexDfn);
+					nodeDfn = entry.getDfnPtr ();
+					nodeType = entry.getTypePtr ();
+					type = entry.getType ();
+					array = false;
+					wantArrayIndex = false;
+					inArrayIndex = false;
+				}
+				break;
+			default:
+				return false;
+			}
+		}
+		startToken = endToken;
+	}
+
+	if (inArrayIndex)
+		return false;
+
+	_ParentDfn = parentDfn;
+	_IndexDfn = indexDfn;
+	_NodeType = nodeType;
+	_Type = type;
+	_Compiled = true;
+	return true;
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::isCompiledFor (const UFormElm &uroot) const
+{
+	const CFormElm *root = safe_cast<const CFormElm*> (&uroot);
+	const CFormDfn *rootDfn = _RootDfn;
+	return rootDfn && !root->ParentNode && root->isStruct () && !root->isVirtualStruct () &&
+		((const CFormDfn*)safe_cast<const CFormElmStruct*> (root)->FormDfn == rootDfn);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::findNode (const CForm *form, const CFormElm **node, bool verbose, uint32 round) const
+{
+	const CFormElm *root = &form->Elements;
+
+	if (round > NLGEORGES_MAX_RECURSION)
+	{
+		CFormElm::warning (false, "", form->getFilename ().c_str(), "getInternalNodeByName", "Recursive call on the same node (%s), look for loop references or inheritances.", _Path.c_str ());
+		return false;
+	}
+
+	// Another dfn, look for the node by name
+	if (!isCompiledFor (*root))
+	{
+		const CFormDfn *parentDfn;
+		uint indexDfn;
+		const CFormDfn *nodeDfn;
+		const CType *nodeType;
+		CFormElm *result;
+		UFormDfn::TEntryType type;
+		bool array;
+		bool parentVDfnArray;
+		if (!root->getNodeByName (_Path.c_str (), &parentDfn, indexDfn, &nodeDfn, &nodeType, &result, type, array, parentVDfnArray, verbose, round))
+			return false;
+		*node = result;
+		return true;
+	}
+
+	// Walk the steps
+	const CFormElm *current = root;
+	for (uint i=0; (i<_Steps.size ()) && current; i++)
+	{
+		const CStep &step = _Steps[i];
+		if (step.Array)
+		{
+			const CFormElmArray *array = safe_cast<const CFormElmArray*> (current);
+			if (step.Index >= array->Elements.size ())
+			{
+				if (verbose)
+					CFormElm::warning (false, "", form->getFilename ().c_str(), "getInternalNodeByName", "Getting the node (%s) : Out of array bounds (%d >= %d).", _Path.c_str (), step.Index, array->Elements.size ());
+				return false;
+			}
+			current = array->Elements[step.Index].Element;
+		}
+		else
+		{
+			current = safe_cast<const CFormElmStruct*> (current)->Elements[step.Index].Element;
+		}
+	}
+
+	// Node not found ? Look in parents !
+	if (current == NULL)
+	{
+		for (uint parent=0; parent<form->getParentCount (); parent++)
+		{
+			const CFormElm *parentNode;
+			if (findNode (form->getParent (parent), &parentNode, false, round+1) && parentNode)
+			{
+				*node = parentNode;
+				return true;
+			}
+		}
+	}
+
+	*node = current;
+	return true;
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getNode (const UFormElm &uroot, const UFormElm **result, UFormElm::TWhereIsNode *where) const
+{
+	if (!_Compiled || !isCompiledFor (uroot))
+		return uroot.getNodeByName (result, _Path.c_str (), where, true);
+
+	const CFormElm *root = safe_cast<const CFormElm*> (&uroot);
+	const CFormElm *node;
+	if (findNode (root->getForm (), &node, true, NLGEORGES_FIRST_ROUND))
+	{
+		*result = node;
+		if (where && node)
+			*where = (node->getForm () == root->getForm ()) ? UFormElm::NodeForm : UFormElm::NodeParentForm;
+		return true;
+	}
+	return false;
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &uroot, std::string &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	if (!_Compiled || !isCompiledFor (uroot))
+		return uroot.getValueByName (result, _Path.c_str (), evaluate, where);
+
+	const CFormElm *root = safe_cast<const CFormElm*> (&uroot);
+	const CFormElm *node;
+	if (findNode (root->getForm (), &node, true, NLGEORGES_FIRST_ROUND))
+	{
+		if (_Type == UFormDfn::EntryType)
+		{
+			// The atom
+			const CFormElmAtom *atom = node ? safe_cast<const CFormElmAtom*> (node) : NULL;
+
+			// Evale
+			nlassert (_NodeType && _ParentDfn);
+			return (_NodeType->getValue (result, root->getForm (), atom, *_ParentDfn, _IndexDfn, evaluate, (uint32*)where, NLGEORGES_FIRST_ROUND, _Path.c_str ()));
+		}
+		else
+		{
+			root->warning (false, "getValueByName", "The node (%s) is not an atom element. Can't return a value.", _Path.c_str ());
+		}
+	}
+	else
+	{
+		root->warning (false, "getValueByName", "Can't find the node (%s).", _Path.c_str ());
+	}
+
+	return false;
+}
+
+// ***************************************************************************
+
+template <class T>
+bool CFormElmPath::getConvertedValue (const UFormElm &uroot, T &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	// Get the string value
+	string value;
+	if (getValue (uroot, value, evaluate, where))
+	{
+		return safe_cast<const CFormElm*> (&uroot)->convertValue (result, value.c_str ());
+	}
+
+	return false;
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, sint8 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, uint8 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, sint16 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, uint16 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, sint32 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, uint32 &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, float &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, double &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, bool &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+bool CFormElmPath::getValue (const UFormElm &root, NLMISC::CRGBA &result, UFormElm::TEval evaluate, UFormElm::TWhereIsValue *where) const
+{
+	return getConvertedValue (root, result, evaluate, where);
+}
+
+// ***************************************************************************
+
+} // NLGEORGES
@@ -0,0 +1,286 @@
+/** \file indexed_packed_sheets.cpp
+ * Packed sheets with an index by sheet id, whose sheets are deserialized on first access
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdgeorges.h"
+
+#include "nel/georges/indexed_packed_sheets.h"
+
+using namespace NLMISC;
+using namespace std;
+
+namespace NLGEORGES
+{
+
+
+// ***************************************************************************
+CIndexedPackedSheetsBase::CIndexedPackedSheetsBase()
+{
+	_Opened= false;
+}
+
+// ***************************************************************************
+CIndexedPackedSheetsBase::~CIndexedPackedSheetsBase()
+{
+	// The derived class has already released its sheets
+	closeFile();
+}
+
+// ***************************************************************************
+void	CIndexedPackedSheetsBase::closeFile()
+{
+	_File.close();
+	_MappedFile.close();
+}
+
+// ***************************************************************************
+void	CIndexedPackedSheetsBase::close()
+{
+	releaseSheets();
+	closeFile();
+	_Index.clear();
+	_Path.clear();
+	_Opened= false;
+}
+
+// ***************************************************************************
+void	CIndexedPackedSheetsBase::open(const std::string &path, uint32 dataVersion, bool useMMap,
+									   std::vector<std::string> *dictionnary, TDependencies *dependencies)
+{
+	close();
+
+	// The file is kept open to read the sheets, don't load it all in memory
+	_File.setCacheFileOnOpen(false);
+	_File.allowBNPCacheFileOnOpen(false);
+	if (!_File.open (path))
+		throw	NLMISC::Exception("can't open PackedSheet %s", path.c_str());
+
+	try
+	{
+		// read the header
+		_File.serialCheck(PACKED_SHEET_INDEXED_HEADER);
+		_File.serialCheck(PACKED_SHEET_INDEXED_VERSION);
+		_File.serialVersion(PACKED_SHEET_INDEXED_VERSION_COMPATIBLE);
+
+		// Read depend block size
+		uint32	dependBlockSize;
+		_File.serial(dependBlockSize);
+
+		// Read the dependencies only if asked
+		if (dictionnary && dependencies)
+		{
+			_File.serialCont(*dictionnary);
+			uint32 depSize;
+			_File.serial(depSize);
+			for (uint i=0; i<depSize; ++i)
+			{
+				CSheetId sheetId;
+
+				// Avoid copy, use []
+				_File.serial(sheetId);
+				_File.serialCont((*dependencies)[sheetId]);
+			}
+		}
+		else if (dependBlockSize>0)
+		{
+			_File.seek(dependBlockSize, IStream::current);
+		}
+
+		// read the index
+		uint32	nbEntries;
+		uint32	ver;
+		_File.serial (nbEntries);
+		_File.serial (ver);
+		if (ver != dataVersion)
+			throw NLMISC::Exception("The packed sheet version in stream is different of the code");
+
+		_Index.resize(nbEntries);
+		for (uint i=0; i<nbEntries; ++i)
+		{
+			_Index[i].serial(_File);
+			if (i>0 && !(_Index[i-1].SheetId.asInt() < _Index[i].SheetId.asInt()))
+				throw NLMISC::Exception("The index of the packed sheet %s is not sorted", path.c_str());
+			if (_Index[i].Offset + _Index[i].Size > _File.getFileSize())
+				throw NLMISC::Exception("The index of the packed sheet %s is corrupted", path.c_str());
+		}
+	}
+	catch (...)
+	{
+		closeFile();
+		_Index.clear();
+		throw;
+	}
+
+	// Map the file if possible. Files in a bnp can't be mapped, keep reading them with the CIFile
+	if (useMMap && path.find('@') == string::npos)
+	{
+		if (_MappedFile.open(path))
+			_File.close();
+		else
+			nlwarning ("Can't map the packed sheet %s, read it as a file", path.c_str());
+	}
+
+	_Path= path;
+	_Opened= true;
+
+	indexLoaded();
+}
+
+// ***************************************************************************
+sint	CIndexedPackedSheetsBase::find(const NLMISC::CSheetId &sheetId) const
+{
+	uint32	id= sheetId.asInt();
+	uint	first= 0;
+	uint	last= (uint)_Index.size();
+	while (first < last)
+	{
+		uint	middle= (first + last) / 2;
+		uint32	middleId= _Index[middle].SheetId.asInt();
+		if (middleId < id)
+			first= middle + 1;
+		else if (id < middleId)
+			last= middle;
+		else
+			return (sint)middle;
+	}
+	return -1;
+}
+
+// ***************************************************************************
+void	CIndexedPackedSheetsBase::readEntry(uint index, NLMISC::CMemStream &dest)
+{
+	nlassert(_Opened);
+	nlassert(index < _Index.size());
+	nlassert(dest.isReading());
+	const CEntry	&entry= _Index[index];
+
+	dest.clear();
+	if (_MappedFile.isOpen())
+	{
+		dest.fill(_MappedFile.getData() + entry.Offset, entry.Size);
+	}
+	else
+	{
+		uint8	*buffer= dest.bufferToFill(entry.Size);
+		if (entry.Size > 0)
+		{
+			_File.seek(entry.Offset, IStream::begin);
+			_File.serialBuffer(buffer, entry.Size);
+		}
+	}
+}
+
+// ***************************************************************************
+void	CIndexedPackedSheetsBase::rebuild(const std::string &path, uint32 dataVersion, bool useMMap,
+										  const std::vector<std::string> &dictionnary, const TDependencies &dependencies,
+										  const std::vector<NLMISC::CSheetId> &sheets, const std::vector<bool> &isNew)
+{
+	nlassert(sheets.size() == isNew.size());
+
+	// The new file is written in a temp file, renamed at close(): the sheets that didn't change are read from
+	// the current file meanwhile.
+	COFile ofile;
+	if (!ofile.open(path, false, false, true))
+		throw NLMISC::Exception("can't open the packed sheet %s for writing", path.c_str());
+
+	// write the header.
+	ofile.serialCheck(PACKED_SHEET_INDEXED_HEADER);
+	ofile.serialCheck(PACKED_SHEET_INDEXED_VERSION);
+	ofile.serialVersion(PACKED_SHEET_INDEXED_VERSION_COMPATIBLE);
+
+	// Write a dummy block size for now
+	sint32	posBlockSize= ofile.getPos();
+	uint32	dependBlockSize= 0;
+	ofile.serial(dependBlockSize);
+
+	// write the dictionnary
+	ofile.serialCont(const_cast<std::vector<std::string>&>(dictionnary));
+
+	// write the dependencies data
+	uint32 depSize = (uint32)dependencies.size();
+	ofile.serial(depSize);
+	TDependencies::const_iterator first(dependencies.begin()), last(dependencies.end());
+	for (; first != last; ++first)
+	{
+		NLMISC::CSheetId si = first->first;
+		ofile.serial(si);
+		ofile.serialCont(const_cast<std::vector<uint32>&>(first->second));
+	}
+
+	// Then get the dictionary + dependencies size, and write it back to posBlockSize
+	sint32	endBlockSize= ofile.getPos();
+	dependBlockSize= (endBlockSize - posBlockSize) - 4;
+	ofile.seek(posBlockSize, NLMISC::IStream::begin);
+	ofile.serial(dependBlockSize);
+	ofile.seek(endBlockSize, NLMISC::IStream::begin);
+
+	// write a dummy index for now
+	uint32 nbEntries = (uint32)sheets.size();
+	uint32 ver = dataVersion;
+	ofile.serial (nbEntries);
+	ofile.serial (ver);
+	sint32	posIndex= ofile.getPos();
+	vector<CEntry>	index(sheets.size());
+	uint i;
+	for (i=0; i<index.size(); ++i)
+	{
+		index[i].SheetId= sheets[i];
+		index[i].Offset= 0;
+		index[i].Size= 0;
+		index[i].serial(ofile);
+	}
+
+	// write the sheets
+	CMemStream	oldSheet(true);
+	for (i=0; i<index.size(); ++i)
+	{
+		index[i].Offset= ofile.getPos();
+		if (isNew[i])
+		{
+			serialNewSheet(sheets[i], ofile);
+		}
+		else
+		{
+			// copy the serialized sheet from the current file, it is not deserialized
+			sint	oldIndex= find(sheets[i]);
+			nlassert(oldIndex >= 0);
+			readEntry(oldIndex, oldSheet);
+			if (oldSheet.length() > 0)
+				ofile.serialBuffer(const_cast<uint8*>(oldSheet.buffer()), oldSheet.length());
+		}
+		index[i].Size= ofile.getPos() - index[i].Offset;
+	}
+
+	// write the index
+	ofile.seek(posIndex, NLMISC::IStream::begin);
+	for (i=0; i<index.size(); ++i)
+		index[i].serial(ofile);
+
+	// The current file must be closed before it is replaced by the temp file
+	close();
+	ofile.close();
+
+	open(path, dataVersion, useMMap);
+}
+
+
+} // NLGEORGES
@@ -21,3 +21,274 @@
  */
 
 #include "stdgeorges.h"
+
+#include "nel/misc/thread.h"
+#include "nel/misc/mutex.h"
+#include "nel/misc/time_nl.h"
+
+#include "nel/georges/load_form.h"
+
+using namespace NLMISC;
+using namespace std;
+
+namespace NLGEORGES
+{
+
+// ***************************************************************************
+
+// Number of worker threads used by loadPackedSheetForms()
+static uint	PackedSheetRebuildThreads= 0;
+
+// The sheets are given to the threads by blocks of consecutive sheets: they often share the same parents and dfn,
+// that stay in the cache of the form loader of the thread.
+static const uint	PackedSheetBlockSize= 32;
+
+// ***************************************************************************
+
+void setPackedSheetRebuildThreads(uint numThreads)
+{
+	PackedSheetRebuildThreads= numThreads;
+}
+
+// ***************************************************************************
+
+uint getPackedSheetRebuildThreads()
+{
+	return PackedSheetRebuildThreads;
+}
+
+// ***************************************************************************
+
+/* The sheets being loaded by loadPackedSheetForms(). Each thread loads the forms with its own form loader:
+ * the forms, dfn and types are ref counted and not thread safe, so they are never shared between threads.
+ */
+class CPackedSheetJob
+{
+public:
+	CPackedSheetJob(const vector<CSheetId> &sheets, IPackedSheetReader &reader)
+		: Sheets(sheets), Reader(reader)
+	{
+		DependFiles.resize(sheets.size());
+		Loaded.resize(sheets.size(), 0);
+		_NextSheet= 0;
+		_NumDone= 0;
+	}
+
+	// Load sheets until there are no more, with a new form loader.
+	void	process(bool logProgress)
+	{
+		UFormLoader	*formLoader = UFormLoader::createLoader ();
+		//	cache used to retain information (to optimize time).
+		vector<CSmartPtr<UForm> >	cacheFormList;
+
+		TTime	start = CTime::getLocalTime ();
+		TTime	last = start;
+		uint	first, end;
+		while (claimBlock(first, end))
+		{
+			for (uint i=first; i<end; i++)
+			{
+				// An exception must not escape from a worker thread: keep it for the main thread
+				try
+				{
+					// Load the form with given sheet id
+					const string	name= Sheets[i].toString();
+					CSmartPtr<UForm>	form = formLoader->loadForm (name.c_str ());
+					if (form)
+					{
+						cacheFormList.push_back (form);
+
+						// get the dependency files, the dictionnary is built after
+						set<string>	&dependFiles= DependFiles[i];
+						form->getDependencies (dependFiles);
+						nlassert(dependFiles.find(name) != dependFiles.end());
+						// remove the sheet itself from the container
+						dependFiles.erase(name);
+
+						Reader.readSheet (i, form, Sheets[i]);
+						Loaded[i]= 1;
+					}
+				}
+				catch (exception &e)
+				{
+					setError (e.what());
+				}
+				catch (...)
+				{
+					setError (("Unknown exception while loading the sheet " + Sheets[i].toString()).c_str());
+				}
+			}
+
+			uint	numDone= blockDone(end - first);
+			if (logProgress && CTime::getLocalTime () > last + 5000)
+			{
+				last = CTime::getLocalTime ();
+				nlinfo ("%.0f%% completed (%d/%d), %d seconds remaining", (float)numDone*100.0/Sheets.size(), numDone, Sheets.size(), (uint32)((Sheets.size()-numDone)*(last-start)/numDone/1000));
+			}
+		}
+
+		cacheFormList.clear();
+		UFormLoader::releaseLoader (formLoader);
+	}
+
+	// Claim the next block of sheets to load. Return false if there are no more sheets.
+	bool	claimBlock(uint &first, uint &end)
+	{
+		_Mutex.enter();
+		first= _NextSheet;
+		end= min(first + PackedSheetBlockSize, (uint)Sheets.size());
+		_NextSheet= end;
+		_Mutex.leave();
+		return first < end;
+	}
+
+	// A block of sheets has been loaded. Return the number of sheets loaded so far.
+	uint	blockDone(uint count)
+	{
+		_Mutex.enter();
+		_NumDone+= count;
+		uint	numDone= _NumDone;
+		_Mutex.leave();
+		return numDone;
+	}
+
+	// Keep the first error thrown while loading a sheet, it is thrown again by the main thread
+	void	setError(const char *error)
+	{
+		_Mutex.enter();
+		if (Error.empty())
+			Error= error;
+		_Mutex.leave();
+	}
+
+	const vector<CSheetId>		&Sheets;
+	IPackedSheetReader			&Reader;
+	// For each sheet, the files it depends on
+	vector<set<string> >		DependFiles;
+	// For each sheet, 1 if loaded. Not a vector<bool>, the threads write it concurrently.
+	vector<uint8>				Loaded;
+	string						Error;
+
+private:
+	CFastMutex			_Mutex;
+	uint				_NextSheet;
+	uint				_NumDone;
+};
+
+// ***************************************************************************
+
+class CPackedSheetWorker : public IRunnable
+{
+public:
+	CPackedSheetWorker(CPackedSheetJob &job) : _Job(job) {}
+
+	virtual void	run()
+	{
+		_Job.process(false);
+	}
+
+	virtual void	getName (std::string &result) const
+	{
+		result = "CPackedSheetWorker";
+	}
+
+private:
+	CPackedSheetJob		&_Job;
+};
+
+// ***************************************************************************
+
+void loadPackedSheetForms(const std::vector<NLMISC::CSheetId> &sheets, IPackedSheetReader &reader,
+						  std::vector<std::string> &dictionnary, std::map<std::string, uint> &dictionnaryIndex,
+						  std::map<NLMISC::CSheetId, std::vector<uint32> > &dependencies, std::vector<bool> &loaded)
+{
+	loaded.clear();
+	loaded.resize(sheets.size(), false);
+	if (sheets.empty())
+		return;
+
+	TTime start = CTime::getLocalTime ();
+	WarningLog->addNegativeFilter("CFormLoader: Can't open the form file");
+
+	CPackedSheetJob	job(sheets, reader);
+
+	// no need for more threads than blocks of sheets
+	uint	numBlocks= ((uint)sheets.size() + PackedSheetBlockSize - 1) / PackedSheetBlockSize;
+	uint	numThreads= min(PackedSheetRebuildThreads, numBlocks - 1);
+	vector<CPackedSheetWorker*>	workers;
+	vector<IThread*>			threads;
+	if (numThreads > 0)
+	{
+		// Must be initialized by the main thread
+		xmlInitParser();
+
+		for (uint i=0; i<numThreads; i++)
+		{
+			workers.push_back(new CPackedSheetWorker(job));
+			threads.push_back(IThread::create(workers.back()));
+			threads.back()->start();
+		}
+	}
+
+	// the main thread loads sheets too
+	job.process(true);
+
+	for (uint i=0; i<threads.size(); i++)
+	{
+		threads[i]->wait();
+		delete threads[i];
+		delete workers[i];
+	}
+
+	WarningLog->removeFilter ("CFormLoader: Can't open the form file");
+	nlinfo ("%d seconds to recompute %d sheets (%d threads)", (uint32)(CTime::getLocalTime()-start)/1000, sheets.size(), numThreads+1);
+
+	if (!job.Error.empty())
+		throw Exception ("%s", job.Error.c_str());
+
+	// index the dictionnary entries read from the packed sheet, if not already done
+	for (uint i=0; i<dictionnary.size(); i++)
+		dictionnaryIndex.insert(make_pair(dictionnary[i], i));
+
+	// build the dependency data, in the order of the sheets
+	for (uint i=0; i<sheets.size(); i++)
+	{
+		if (!job.Loaded[i])
+			continue;
+		loaded[i]= true;
+
+		std::vector<uint32>		depends;
+		const set<string>		&dependFiles= job.DependFiles[i];
+		set<string>::const_iterator first(dependFiles.begin()), last(dependFiles.end());
+		for (; first != last; ++first)
+		{
+			const	string filename = CFile::getFilename(*first);
+			map<string,uint>::iterator	findDicIt=dictionnaryIndex.find(filename);
+
+			if	(findDicIt!=dictionnaryIndex.end())
+			{
+				depends.push_back(findDicIt->second);
+				continue;
+			}
+
+			string p = CPath::lookup (*first, false, false);
+			if	(!p.empty())
+			{
+				uint dicIndex;
+				// add a new dictionnary entry
+				dicIndex = dictionnary.size();
+				dictionnaryIndex.insert(make_pair(filename, dictionnary.size()));
+				dictionnary.push_back(filename);
+
+				// add the dependency index
+				depends.push_back(dicIndex);
+			}
+		}
+		// store the dependency list with the sheet ID
+		dependencies[sheets[i]] = depends;
+	}
+}
+
+// ***************************************************************************
+
+} // NLGEORGES
@@ -26,8 +26,10 @@
 #include "nel/ligo/primitive.h"
 #include "nel/ligo/ligo_config.h"
 #include "nel/ligo/primitive_class.h"
+#include "nel/ligo/primitive_index.h"
 #include "nel/misc/i_xml.h"
 #include "nel/misc/path.h"
+#include "nel/misc/rope_stream.h"
 
 using namespace NLMISC;
 using namespace std;
@@ -1026,12 +1028,14 @@ void CPrimRegion::serial (NLMISC::IStream &f)
 IPrimitive::IPrimitive ()
 {
 	_Parent = NULL;
+	_Index = NULL;
 }
 
 
 IPrimitive::IPrimitive (const IPrimitive &node) : IStreamable()
 {
 	_Parent = NULL;
+	_Index = NULL;
 	IPrimitive::operator= (node);
 }
 
@@ -1205,6 +1209,15 @@ void IPrimitive::operator= (const IPrimitive &node)
 		ite++;
 	}
 
+	// Index the copy if this primitive is in an indexed tree
+	CPrimitiveIndex *index = getTreeIndex ();
+	if (index)
+	{
+		index->update (this);
+		for (uint child = 0; child < _Children.size (); child++)
+			index->addBranch (_Children[child]);
+	}
+
 #ifdef NLLIGO_DEBUG
 	_DebugClassName = node._DebugClassName;
 	_DebugPrimitiveName = node._DebugPrimitiveName;
@@ -1553,6 +1566,9 @@ bool IPrimitive::removeChild (uint childId)
 {
 	if (childId < _Children.size ())
 	{
+		CPrimitiveIndex *index = getTreeIndex ();
+		if (index)
+			index->removeBranch (_Children[childId]);
 		delete _Children[childId];
 		_Children.erase (_Children.begin()+childId);
 		updateChildId (childId);
@@ -1569,9 +1585,13 @@ bool IPrimitive::removeChild (uint childId)
 
 void IPrimitive::removeChildren ()
 {
+	CPrimitiveIndex *index = _Children.empty () ? NULL : getTreeIndex ();
+
 	// Erase children
 	for (uint i=0; i<_Children.size (); i++)
 	{
+		if (index)
+			index->removeBranch (_Children[i]);
 		delete _Children[i];
 	}
 	_Children.clear ();
@@ -1584,6 +1604,9 @@ bool IPrimitive::unlinkChild(IPrimitive *child)
 	uint childId;
 	if (getChildId(childId, child))
 	{
+		CPrimitiveIndex *index = getTreeIndex ();
+		if (index)
+			index->removeBranch (child);
 		child->onUnlinkFromParent();
 		child->branchUnlink();
 		_Children.erase (_Children.begin()+childId);
@@ -1624,11 +1647,26 @@ bool IPrimitive::insertChild (IPrimitive *primitive, uint index)
 	primitive->onLinkToParent();
 	primitive->branchLink();
 
+	// Index the new branch
+	CPrimitiveIndex *treeIndex = getTreeIndex ();
+	if (treeIndex)
+		treeIndex->addBranch (primitive);
+
 	return true;
 }
 
 // ***************************************************************************
 
+CPrimitiveIndex *IPrimitive::getTreeIndex () const
+{
+	const IPrimitive *root = this;
+	while (root->_Parent)
+		root = root->_Parent;
+	return root->_Index;
+}
+
+// ***************************************************************************
+
 IPrimitive::~IPrimitive ()
 {
 	// Remove children
@@ -2193,7 +2231,8 @@ void CPrimAlias::serial (NLMISC::IStream &f)
 // ***************************************************************************
 
 CPrimitives::CPrimitives () :
-	_LigoConfig(NULL)
+	_LigoConfig(NULL),
+	_Index(NULL)
 {
 	// init the alias generator
 	_LastGeneratedAlias = 0;
@@ -2207,7 +2246,8 @@ CPrimitives::CPrimitives () :
 
 // ***************************************************************************
 
-CPrimitives::CPrimitives (const CPrimitives &other)
+CPrimitives::CPrimitives (const CPrimitives &other) :
+	_Index(NULL)
 {
 	operator =(other);
 //	_LastGeneratedAlias = other._LastGeneratedAlias;
@@ -2227,11 +2267,35 @@ CPrimitives::CPrimitives (const CPrimitives &other)
 
 CPrimitives::~CPrimitives ()
 {
+	releaseIndex ();
 	delete RootNode;
 }
 
 // ***************************************************************************
 
+CPrimitiveIndex *CPrimitives::buildIndex(float cellSize, uint gridSize)
+{
+	releaseIndex ();
+	_Index = new CPrimitiveIndex (cellSize, gridSize);
+	RootNode->_Index = _Index;
+	_Index->build (RootNode);
+	return _Index;
+}
+
+// ***************************************************************************
+
+void CPrimitives::releaseIndex()
+{
+	if (_Index)
+	{
+		RootNode->_Index = NULL;
+		delete _Index;
+		_Index = NULL;
+	}
+}
+
+// ***************************************************************************
+
 uint32 CPrimitives::getAliasStaticPart()
 {
 	return _AliasStaticPart;
@@ -2459,6 +2523,13 @@ CPrimitives& CPrimitives::operator= (const CPrimitives &other)
 
 	CPrimitiveContext::instance().CurrentPrimitive = temp;
 
+	// index the new tree
+	if (_Index)
+	{
+		RootNode->_Index = _Index;
+		_Index->build (RootNode);
+	}
+
 	return *this;
 }
 
@@ -2589,6 +2660,466 @@ void CPrimitives::serial(NLMISC::IStream &f)
 	{
 		_AliasStaticPart = _LigoConfig->getFileStaticAliasMapping(_Filename);
 	}
+	if (f.isReading() && _Index)
+	{
+		RootNode->_Index = _Index;
+		_Index->build (RootNode);
+	}
+}
+
+// ***************************************************************************
+
+/* Binary primitive format, written by CPrimitives::writeBinary():
+ *
+ *	header 'PRMB', version
+ *	uint32	last generated alias
+ *	string	file name
+ *	uint32	string count
+ *	uint32	string pool size
+ *	char	string pool[size], the strings are zero terminated
+ *	uint32	node count
+ *	nodes, in depth first order, starting with the root node:
+ *		uint8	node kind (TBinaryPrimitiveKind)
+ *		uint32	class name (string id)
+ *		uint32	child count
+ *		uint32	unparsed properties (string id)
+ *		uint32	property count
+ *		properties, sorted by name:
+ *			uint32	name (string id)
+ *			uint8	property kind (TBinaryPropertyKind)
+ *			bool	default
+ *			string id, string id array or color
+ *		point, vertices or alias, depending on the node kind
+ */
+
+const uint32 NLLIGO_BINARY_PRIMITIVE_HEADER = 'PRMB';
+const uint32 NLLIGO_BINARY_PRIMITIVE_VERSION = 0;
+
+enum TBinaryPrimitiveKind
+{
+	BinaryPrimNode = 0,
+	BinaryPrimPoint,
+	BinaryPrimPath,
+	BinaryPrimZone,
+	BinaryPrimAlias,
+};
+
+enum TBinaryPropertyKind
+{
+	BinaryPropertyString = 0,
+	BinaryPropertyStringArray,
+	BinaryPropertyColor,
+};
+
+// String pool of the binary format, filled while the nodes are written
+class CBinaryStringPool
+{
+public:
+	uint32	add (const std::string &str)
+	{
+		std::map<std::string, uint32>::iterator ite = _Ids.find (str);
+		if (ite != _Ids.end ())
+			return ite->second;
+		uint32 id = (uint32)_Ids.size ();
+		_Ids.insert (std::map<std::string, uint32>::value_type (str, id));
+		_Pool.insert (_Pool.end (), str.begin (), str.end ());
+		_Pool.push_back (0);
+		return id;
+	}
+
+	void	serial (NLMISC::IStream &f)
+	{
+		nlassert (!f.isReading ());
+		uint32 count = (uint32)_Ids.size ();
+		uint32 size = (uint32)_Pool.size ();
+		f.serial (count);
+		f.serial (size);
+		if (size)
+			f.serialBuffer ((uint8*)&_Pool[0], size);
+	}
+
+private:
+	std::map<std::string, uint32>	_Ids;
+	std::vector<char>				_Pool;
+};
+
+// ***************************************************************************
+
+void CPrimitives::writeBinary(NLMISC::IStream &f) const
+{
+	nlassert (!f.isReading ());
+
+	// Write the nodes in a memory stream first: the string pool is complete once they are written
+	CBinaryStringPool pool;
+	CRopeStream nodes (false);
+	uint32 nodeCount = 0;
+
+	std::vector<const IPrimitive*> stack;
+	stack.push_back (RootNode);
+	while (!stack.empty ())
+	{
+		const IPrimitive *prim = stack.back ();
+		stack.pop_back ();
+		nodeCount++;
+
+		// Kind of primitive
+		uint8 kind = BinaryPrimNode;
+		const CPrimPoint *point = NULL;
+		const CPrimPath *path = NULL;
+		const CPrimZone *zone = NULL;
+		const CPrimAlias *alias = dynamic_cast<const CPrimAlias *>(prim);
+		if (alias)
+			kind = BinaryPrimAlias;
+		else if ((point = dynamic_cast<const CPrimPoint *>(prim)) != NULL)
+			kind = BinaryPrimPoint;
+		else if ((path = dynamic_cast<const CPrimPath *>(prim)) != NULL)
+			kind = BinaryPrimPath;
+		else if ((zone = dynamic_cast<const CPrimZone *>(prim)) != NULL)
+			kind = BinaryPrimZone;
+
+		uint32 className = pool.add (const_cast<IPrimitive*>(prim)->getClassName ());
+		uint32 childCount = (uint32)prim->_Children.size ();
+		uint32 unparsed = pool.add (prim->_UnparsedProperties);
+		nodes.serial (kind);
+		nodes.serial (className);
+		nodes.serial (childCount);
+		nodes.serial (unparsed);
+
+		// Properties
+		uint32 propertyCount = 0;
+		std::map<std::string, IProperty*>::const_iterator first (prim->_Properties.begin ()), last (prim->_Properties.end ());
+		for (; first != last; ++first)
+		{
+			if (dynamic_cast<const CPropertyString *>(first->second)
+				|| dynamic_cast<const CPropertyStringArray *>(first->second)
+				|| dynamic_cast<const CPropertyColor *>(first->second))
+				propertyCount++;
+			else
+				nlwarning ("CPrimitives::writeBinary : unknown type for the property '%s', not written", first->first.c_str ());
+		}
+		nodes.serial (propertyCount);
+		for (first = prim->_Properties.begin (); first != last; ++first)
+		{
+			uint32 name = pool.add (first->first);
+			bool def = first->second->Default;
+			if (const CPropertyString *propString = dynamic_cast<const CPropertyString *>(first->second))
+			{
+				uint8 propKind = BinaryPropertyString;
+				uint32 value = pool.add (propString->String);
+				nodes.serial (name);
+				nodes.serial (propKind);
+				nodes.serial (def);
+				nodes.serial (value);
+			}
+			else if (const CPropertyStringArray *propArray = dynamic_cast<const CPropertyStringArray *>(first->second))
+			{
+				uint8 propKind = BinaryPropertyStringArray;
+				uint32 size = (uint32)propArray->StringArray.size ();
+				nodes.serial (name);
+				nodes.serial (propKind);
+				nodes.serial (def);
+				nodes.serial (size);
+				for (uint i=0; i<size; i++)
+				{
+					uint32 value = pool.add (propArray->StringArray[i]);
+					nodes.serial (value);
+				}
+			}
+			else if (const CPropertyColor *propColor = dynamic_cast<const CPropertyColor *>(first->second))
+			{
+				uint8 propKind = BinaryPropertyColor;
+				CRGBA color = propColor->Color;
+				nodes.serial (name);
+				nodes.serial (propKind);
+				nodes.serial (def);
+				nodes.serial (color);
+			}
+		}
+
+		// Primitive specific data
+		switch (kind)
+		{
+		case BinaryPrimPoint:
+			{
+				CPrimVector pos = point->Point;
+				float angle = point->Angle;
+				nodes.serial (pos);
+				nodes.serial (angle);
+			}
+			break;
+		case BinaryPrimPath:
+			nodes.serialCont (const_cast<std::vector<CPrimVector>&>(path->VPoints));
+			break;
+		case BinaryPrimZone:
+			nodes.serialCont (const_cast<std::vector<CPrimVector>&>(zone->VPoints));
+			break;
+		case BinaryPrimAlias:
+			{
+				uint32 dynamicAlias = alias->getAlias ();
+				nodes.serial (dynamicAlias);
+			}
+			break;
+		}
+
+		// Children, the first one on the top of the stack
+		std::vector<IPrimitive*>::const_reverse_iterator child (prim->_Children.rbegin ()), lastChild (prim->_Children.rend ());
+		for (; child != lastChild; ++child)
+			stack.push_back (*child);
+	}
+
+	f.serialCheck (NLLIGO_BINARY_PRIMITIVE_HEADER);
+	f.serialVersion (NLLIGO_BINARY_PRIMITIVE_VERSION);
+	uint32 lastGeneratedAlias = _LastGeneratedAlias;
+	f.serial (lastGeneratedAlias);
+	f.serial (const_cast<std::string&>(_Filename));
+	pool.serial (f);
+	f.serial (nodeCount);
+	nodes.writeTo (f);
+}
+
+// ***************************************************************************
+
+bool CPrimitives::readBinary(NLMISC::IStream &f)
+{
+	nlassert (f.isReading ());
+
+	// Clear the primitives
+	RootNode->removeChildren ();
+	RootNode->removeProperties ();
+	RootNode->_UnparsedProperties.clear ();
+
+	// The nodes, in depth first order
+	std::vector<IPrimitive*> nodes;
+
+	try
+	{
+		f.serialCheck (NLLIGO_BINARY_PRIMITIVE_HEADER);
+		f.serialVersion (NLLIGO_BINARY_PRIMITIVE_VERSION);
+		f.serial (_LastGeneratedAlias);
+		f.serial (_Filename);
+
+		// Read the string pool at once, the strings are used in place
+		uint32 stringCount;
+		uint32 poolSize;
+		f.serial (stringCount);
+		f.serial (poolSize);
+		std::vector<char> pool (poolSize);
+		if (poolSize)
+			f.serialBuffer ((uint8*)&pool[0], poolSize);
+		if (poolSize && pool[poolSize-1] != 0)
+			throw EInvalidDataStream (f);
+		std::vector<const char*> strings;
+		strings.reserve (stringCount);
+		uint i;
+		for (i=0; i<poolSize; i += (uint)strlen (&pool[i])+1)
+			strings.push_back (&pool[i]);
+		if (strings.size () != stringCount)
+			throw EInvalidDataStream (f);
+
+		uint32 nodeCount;
+		f.serial (nodeCount);
+		if (nodeCount == 0)
+			throw EInvalidDataStream (f);
+
+		// The parents whose children are still to be read, with their remaining child count
+		std::vector<std::pair<IPrimitive*, uint32> > parents;
+		nodes.reserve (nodeCount);
+		for (uint node=0; node<nodeCount; node++)
+		{
+			uint8 kind;
+			uint32 className;
+			uint32 childCount;
+			uint32 unparsed;
+			f.serial (kind);
+			f.serial (className);
+			f.serial (childCount);
+			f.serial (unparsed);
+			if (className >= stringCount || unparsed >= stringCount)
+				throw EInvalidDataStream (f);
+
+			// Create the primitive, link it to its parent
+			IPrimitive *prim;
+			if (node == 0)
+			{
+				if (kind != BinaryPrimNode)
+					throw EInvalidDataStream (f);
+				prim = RootNode;
+			}
+			else
+			{
+				while (!parents.empty () && parents.back ().second == 0)
+					parents.pop_back ();
+				if (parents.empty ())
+					throw EInvalidDataStream (f);
+				IPrimitive *parent = parents.back ().first;
+				parents.back ().second--;
+
+				IClassable *classable = CClassRegistry::create (strings[className]);
+				prim = dynamic_cast<IPrimitive *>(classable);
+				if (prim == NULL)
+				{
+					delete classable;
+					nlwarning ("CPrimitives::readBinary : Unknown primitive type (%s)", strings[className]);
+					throw EInvalidDataStream (f);
+				}
+				prim->_Parent = parent;
+				prim->_ChildId = (uint32)parent->_Children.size ();
+				parent->_Children.push_back (prim);
+			}
+			nodes.push_back (prim);
+			prim->_Children.reserve (childCount);
+			prim->_UnparsedProperties = strings[unparsed];
+
+			// Properties, sorted by name
+			uint32 propertyCount;
+			f.serial (propertyCount);
+			for (uint prop=0; prop<propertyCount; prop++)
+			{
+				uint32 name;
+				uint8 propKind;
+				bool def;
+				f.serial (name);
+				f.serial (propKind);
+				f.serial (def);
+				if (name >= stringCount)
+					throw EInvalidDataStream (f);
+
+				IProperty *property;
+				if (propKind == BinaryPropertyString)
+				{
+					uint32 value;
+					f.serial (value);
+					if (value >= stringCount)
+						throw EInvalidDataStream (f);
+					property = new CPropertyString (strings[value], def);
+				}
+				else if (propKind == BinaryPropertyStringArray)
+				{
+					uint32 size;
+					f.serial (size);
+					CPropertyStringArray *propArray = new CPropertyStringArray;
+					propArray->Default = def;
+					property = propArray;
+					propArray->StringArray.resize (size);
+					for (uint j=0; j<size; j++)
+					{
+						uint32 value;
+						f.serial (value);
+						if (value >= stringCount)
+						{
+							delete propArray;
+							throw EInvalidDataStream (f);
+						}
+						propArray->StringArray[j] = strings[value];
+					}
+				}
+				else if (propKind == BinaryPropertyColor)
+				{
+					CPropertyColor *propColor = new CPropertyColor;
+					propColor->Default = def;
+					property = propColor;
+					f.serial (propColor->Color);
+				}
+				else
+				{
+					throw EInvalidDataStream (f);
+				}
+
+				// The properties are written in the map order
+				size_t size = prim->_Properties.size ();
+				prim->_Properties.insert (prim->_Properties.end (), std::map<std::string, IProperty*>::value_type (strings[name], property));
+				if (prim->_Properties.size () == size)
+				{
+					delete property;
+					throw EInvalidDataStream (f);
+				}
+			}
+
+			// Primitive specific data
+			switch (kind)
+			{
+			case BinaryPrimNode:
+				break;
+			case BinaryPrimPoint:
+				{
+					CPrimPoint *point = dynamic_cast<CPrimPoint *>(prim);
+					if (point == NULL)
+						throw EInvalidDataStream (f);
+					f.serial (point->Point);
+					f.serial (point->Angle);
+				}
+				break;
+			case BinaryPrimPath:
+				{
+					CPrimPath *path = dynamic_cast<CPrimPath *>(prim);
+					if (path == NULL)
+						throw EInvalidDataStream (f);
+					f.serialCont (path->VPoints);
+				}
+				break;
+			case BinaryPrimZone:
+				{
+					CPrimZone *zone = dynamic_cast<CPrimZone *>(prim);
+					if (zone == NULL)
+						throw EInvalidDataStream (f);
+					f.serialCont (zone->VPoints);
+				}
+				break;
+			case BinaryPrimAlias:
+				{
+					CPrimAlias *alias = dynamic_cast<CPrimAlias *>(prim);
+					if (alias == NULL)
+						throw EInvalidDataStream (f);
+					f.serial (alias->_Alias);
+				}
+				break;
+			default:
+				throw EInvalidDataStream (f);
+			}
+
+#ifdef NLLIGO_DEBUG
+			prim->getPropertyByName ("class", prim->_DebugClassName);
+			prim->getPropertyByName ("name", prim->_DebugPrimitiveName);
+#endif
+
+			if (childCount)
+				parents.push_back (std::pair<IPrimitive*, uint32> (prim, childCount));
+		}
+
+		// All the children must have been read
+		while (!parents.empty () && parents.back ().second == 0)
+			parents.pop_back ();
+		if (!parents.empty ())
+			throw EInvalidDataStream (f);
+	}
+	catch (const EStream &e)
+	{
+		nlwarning ("CPrimitives::readBinary : can't read the binary primitive (%s)", e.what ());
+
+		// The primitives are not linked yet, just delete them
+		RootNode->removeChildren ();
+		RootNode->removeProperties ();
+		RootNode->_UnparsedProperties.clear ();
+		return false;
+	}
+
+	if (_LigoConfig)
+	{
+		_AliasStaticPart = _LigoConfig->getFileStaticAliasMapping(_Filename);
+	}
+
+	// Signal the links once the whole tree is built
+	uint i;
+	for (i=1; i<nodes.size (); i++)
+		nodes[i]->onLinkToParent ();
+	for (i=0; i<RootNode->_Children.size (); i++)
+		RootNode->_Children[i]->branchLink ();
+
+	// Index the tree
+	if (_Index)
+		_Index->build (RootNode);
+
+	return true;
 }
 
 // ***************************************************************************
@@ -0,0 +1,328 @@
+/** \file primitive_index.cpp
+ * Spatial and property index over a ligo primitive tree
+ */
+
+/* Copyright, 2000-2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/common.h"
+#include "nel/ligo/primitive_index.h"
+#include "nel/ligo/primitive.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NLMISC;
+using namespace std;
+
+namespace NLLIGO
+{
+
+// ***************************************************************************
+
+CPrimitiveIndex::CPrimitiveIndex (float cellSize, uint gridSize)
+{
+	nlassert (cellSize > 0);
+	_CellSize = cellSize;
+	_OOCellSize = 1.f / cellSize;
+
+	// Round the grid size up to a power of 2
+	_GridSize = 1;
+	while (_GridSize < gridSize)
+		_GridSize <<= 1;
+	_GridMask = _GridSize - 1;
+	_Grid.resize (_GridSize * _GridSize);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::build (IPrimitive *root)
+{
+	clear ();
+	if (root)
+		addBranch (root);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::clear ()
+{
+	_Entries.clear ();
+	_ByClass.clear ();
+	_ByName.clear ();
+	for (uint i=0; i<_Grid.size (); i++)
+		contReset (_Grid[i]);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::addBranch (IPrimitive *primitive)
+{
+	// Walk the branch without recursion, the trees can be deep
+	vector<IPrimitive*> stack;
+	stack.push_back (primitive);
+	while (!stack.empty ())
+	{
+		IPrimitive *prim = stack.back ();
+		stack.pop_back ();
+		addPrimitive (prim);
+
+		uint numChildren = prim->getNumChildren ();
+		for (uint i=0; i<numChildren; i++)
+		{
+			IPrimitive *child;
+			if (prim->getChild (child, i))
+				stack.push_back (child);
+		}
+	}
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::removeBranch (IPrimitive *primitive)
+{
+	vector<IPrimitive*> stack;
+	stack.push_back (primitive);
+	while (!stack.empty ())
+	{
+		IPrimitive *prim = stack.back ();
+		stack.pop_back ();
+		removePrimitive (prim);
+
+		uint numChildren = prim->getNumChildren ();
+		for (uint i=0; i<numChildren; i++)
+		{
+			IPrimitive *child;
+			if (prim->getChild (child, i))
+				stack.push_back (child);
+		}
+	}
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::update (IPrimitive *primitive)
+{
+	removePrimitive (primitive);
+	addPrimitive (primitive);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::addPrimitive (IPrimitive *primitive)
+{
+	pair<TEntries::iterator, bool> res = _Entries.insert (TEntries::value_type (primitive, CEntry ()));
+	if (!res.second)
+		return;
+	CEntry &entry = res.first->second;
+
+	// Properties
+	if (primitive->getPropertyByName ("class", entry.Class))
+		_ByClass[entry.Class].insert (primitive);
+	if (primitive->getPropertyByName ("name", entry.Name))
+		_ByName[entry.Name].insert (primitive);
+
+	// Bounding box
+	entry.InGrid = false;
+	uint numVector = primitive->getNumVector ();
+	const CPrimVector *vectors = primitive->getPrimVector ();
+	if (numVector == 0 || vectors == NULL)
+		return;
+
+	entry.InGrid = true;
+	entry.MinX = entry.MaxX = vectors[0].x;
+	entry.MinY = entry.MaxY = vectors[0].y;
+	for (uint i=1; i<numVector; i++)
+	{
+		entry.MinX = min (entry.MinX, vectors[i].x);
+		entry.MinY = min (entry.MinY, vectors[i].y);
+		entry.MaxX = max (entry.MaxX, vectors[i].x);
+		entry.MaxY = max (entry.MaxY, vectors[i].y);
+	}
+
+	sint x0, y0, x1, y1;
+	getCellRange (entry.MinX, entry.MinY, entry.MaxX, entry.MaxY, x0, y0, x1, y1);
+	for (sint y=y0; y<=y1; y++)
+	for (sint x=x0; x<=x1; x++)
+		getCell (x, y).push_back (primitive);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::removePrimitive (IPrimitive *primitive)
+{
+	TEntries::iterator ite = _Entries.find (primitive);
+	if (ite == _Entries.end ())
+		return;
+	const CEntry &entry = ite->second;
+
+	// Properties
+	TPrimitiveByKey::iterator itKey = _ByClass.find (entry.Class);
+	if (itKey != _ByClass.end ())
+	{
+		itKey->second.erase (primitive);
+		if (itKey->second.empty ())
+			_ByClass.erase (itKey);
+	}
+	itKey = _ByName.find (entry.Name);
+	if (itKey != _ByName.end ())
+	{
+		itKey->second.erase (primitive);
+		if (itKey->second.empty ())
+			_ByName.erase (itKey);
+	}
+
+	// Grid
+	if (entry.InGrid)
+	{
+		sint x0, y0, x1, y1;
+		getCellRange (entry.MinX, entry.MinY, entry.MaxX, entry.MaxY, x0, y0, x1, y1);
+		for (sint y=y0; y<=y1; y++)
+		for (sint x=x0; x<=x1; x++)
+		{
+			TCell &cell = getCell (x, y);
+			TCell::iterator itCell = find (cell.begin (), cell.end (), primitive);
+			if (itCell != cell.end ())
+			{
+				*itCell = cell.back ();
+				cell.pop_back ();
+			}
+		}
+	}
+
+	_Entries.erase (ite);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::getCellRange (float minX, float minY, float maxX, float maxY, sint &x0, sint &y0, sint &x1, sint &y1) const
+{
+	x0 = (sint)floorf (minX * _OOCellSize);
+	y0 = (sint)floorf (minY * _OOCellSize);
+	x1 = (sint)floorf (maxX * _OOCellSize);
+	y1 = (sint)floorf (maxY * _OOCellSize);
+
+	// The grid wraps, a box larger than the grid covers all the cells once
+	if (x1 - x0 >= (sint)_GridSize)
+		x1 = x0 + _GridSize - 1;
+	if (y1 - y0 >= (sint)_GridSize)
+		y1 = y0 + _GridSize - 1;
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::select (const TPrimitiveByKey &index, const std::string &key, std::vector<IPrimitive*> &result)
+{
+	TPrimitiveByKey::const_iterator ite = index.find (key);
+	if (ite != index.end ())
+		result.insert (result.end (), ite->second.begin (), ite->second.end ());
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::selectByClass (const std::string &className, std::vector<IPrimitive*> &result) const
+{
+	select (_ByClass, className, result);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::selectByName (const std::string &name, std::vector<IPrimitive*> &result) const
+{
+	select (_ByName, name, result);
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::selectByClassAndName (const std::string &className, const std::string &name, std::vector<IPrimitive*> &result) const
+{
+	TPrimitiveByKey::const_iterator ite = _ByName.find (name);
+	if (ite == _ByName.end ())
+		return;
+
+	// The names are more selective than the classes
+	TPrimitiveSet::const_iterator first (ite->second.begin ()), last (ite->second.end ());
+	for (; first != last; ++first)
+	{
+		TEntries::const_iterator itEntry = _Entries.find (*first);
+		nlassert (itEntry != _Entries.end ());
+		if (itEntry->second.Class == className)
+			result.push_back (*first);
+	}
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::selectInBox (const NLMISC::CVector &cornerMin, const NLMISC::CVector &cornerMax, std::vector<IPrimitive*> &result) const
+{
+	// Candidates, a primitive can be in several cells
+	vector<IPrimitive*> candidates;
+	sint x0, y0, x1, y1;
+	getCellRange (cornerMin.x, cornerMin.y, cornerMax.x, cornerMax.y, x0, y0, x1, y1);
+	for (sint y=y0; y<=y1; y++)
+	for (sint x=x0; x<=x1; x++)
+	{
+		const TCell &cell = getCell (x, y);
+		candidates.insert (candidates.end (), cell.begin (), cell.end ());
+	}
+	sort (candidates.begin (), candidates.end ());
+	candidates.erase (unique (candidates.begin (), candidates.end ()), candidates.end ());
+
+	// Check the bounding boxes
+	for (uint i=0; i<candidates.size (); i++)
+	{
+		TEntries::const_iterator ite = _Entries.find (candidates[i]);
+		nlassert (ite != _Entries.end ());
+		const CEntry &entry = ite->second;
+		if (entry.MinX <= cornerMax.x && entry.MaxX >= cornerMin.x && entry.MinY <= cornerMax.y && entry.MaxY >= cornerMin.y)
+			result.push_back (candidates[i]);
+	}
+}
+
+// ***************************************************************************
+
+void CPrimitiveIndex::selectZonesContaining (const NLMISC::CVector &pos, std::vector<CPrimZone*> &result, const std::string *className) const
+{
+	// A position is in one cell only
+	sint x = (sint)floorf (pos.x * _OOCellSize);
+	sint y = (sint)floorf (pos.y * _OOCellSize);
+	const TCell &cell = getCell (x, y);
+
+	uint first = (uint)result.size ();
+	for (uint i=0; i<cell.size (); i++)
+	{
+		TEntries::const_iterator ite = _Entries.find (cell[i]);
+		nlassert (ite != _Entries.end ());
+		const CEntry &entry = ite->second;
+		if (pos.x < entry.MinX || pos.x > entry.MaxX || pos.y < entry.MinY || pos.y > entry.MaxY)
+			continue;
+		if (className && entry.Class != *className)
+			continue;
+
+		CPrimZone *zone = dynamic_cast<CPrimZone*> (cell[i]);
+		if (zone && zone->contains (pos))
+			result.push_back (zone);
+	}
+
+	sort (result.begin () + first, result.end ());
+}
+
+
+} // namespace NLLIGO
@@ -500,6 +500,54 @@ void CLogicConditionNode::read (xmlNodePtr node)
 	};
 }
 
+//-------------------------------------------------
+// CLogicConditionNode :
+//
+//-------------------------------------------------
+CLogicConditionNode::CLogicConditionNode( const CLogicConditionNode& node )
+{
+	_LogicStateMachine = 0;
+	Type = TERMINATOR;
+	*this = node;
+
+} // CLogicConditionNode //
+
+
+//-------------------------------------------------
+// operator= :
+//
+// the sub nodes are owned by the node, they are
+// copied, not shared
+//-------------------------------------------------
+CLogicConditionNode& CLogicConditionNode::operator=( const CLogicConditionNode& node )
+{
+	if( this == &node )
+	{
+		return *this;
+	}
+
+	vector<CLogicConditionNode *>::iterator itNodes;
+	for( itNodes = _Nodes.begin(); itNodes != _Nodes.end(); ++itNodes )
+	{
+		delete (*itNodes);
+	}
+	_Nodes.clear();
+
+	_LogicStateMachine = node._LogicStateMachine;
+	Type = node.Type;
+	LogicBlock = node.LogicBlock;
+
+	vector<CLogicConditionNode *>::const_iterator itSrc;
+	for( itSrc = node._Nodes.begin(); itSrc != node._Nodes.end(); ++itSrc )
+	{
+		_Nodes.push_back( new CLogicConditionNode(**itSrc) );
+	}
+
+	return *this;
+
+} // operator= //
+
+
 //-------------------------------------------------
 // ~CLogicConditionNode :
 //
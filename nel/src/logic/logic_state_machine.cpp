@@ -101,6 +101,10 @@ void CLogicStateMachine::setCurrentState( string stateName )
 		(*itStates).second.exitState();
 
 		_CurrentState = stateName;
+		if( _Compiled )
+		{
+			_CurrentStateIndex = (uint32)distance( _States.begin(), itStates );
+		}
 
 		(*itStates).second.enterState();
 
@@ -123,6 +127,7 @@ void CLogicStateMachine::addCondition( CLogicCondition condition )
 {
 	condition.setLogicStateMachine(this);
 	_Conditions.insert(make_pair(condition.getName(),condition));
+	_Compiled = false;
 
 } // addCondition //
 
@@ -136,6 +141,7 @@ void CLogicStateMachine::addState( CLogicState logicState )
 {
 	logicState.setLogicStateMachine( this );
 	_States.insert( std::make_pair(logicState.getName(),logicState) );
+	_Compiled = false;
 
 } // addState //
 
@@ -165,16 +171,42 @@ void CLogicStateMachine::addSIdMap( const TSIdMap& sIdMap )
 //---------------------------------------------------
 void CLogicStateMachine::processLogic()
 {
-	// call processLogic for the current state
-	map<string,CLogicState>::iterator itStates = _States.find( _CurrentState );
-	nlassert( itStates != _States.end() );
-	(*itStates).second.processLogic();
+	if( !_Compiled )
+	{
+		compile();
+	}
+
+	// test the conditions of the current state events
+	nlassert( _CurrentStateIndex != NoIndex );
+	CLogicState& state = *_StateTable[_CurrentStateIndex];
+	const CCompiledEvent *events = state._Events.empty() ? NULL : &_CompiledEvents[_StateFirstEvent[_CurrentStateIndex]];
+	uint i;
+	for( i = 0; i < state._Events.size(); ++i )
+	{
+		if( events[i].Condition != NoIndex && testCompiledCondition(events[i].Condition) )
+		{
+			if( state._Events[i].EventAction.IsStateChange )
+			{
+				if( events[i].State != NoIndex )
+				{
+					switchToState( events[i].State );
+				}
+			}
+			else
+			{
+				// this message will be sent as soon as the dest id will be given
+				state._Events[i].EventAction.enableSendMessage();
+
+				/// send the event messages that must and can be sent
+				state.trySendEventMessages();
+			}
+		}
+	}
 
 	// update the counters
-	map<string,CLogicCounter>::iterator itCount;
-	for( itCount = _Counters.begin(); itCount != _Counters.end(); ++itCount )
+	for( i = 0; i < _CounterTable.size(); ++i )
 	{
-		(*itCount).second.update();
+		_CounterTable[i]->update();
 	}
 
 } // processLogic //
@@ -187,6 +219,20 @@ void CLogicStateMachine::processLogic()
 //---------------------------------------------------
 void CLogicStateMachine::getMessagesToSend( multimap<CEntityId,CMessage>& msgs )
 {
+	if( _Compiled )
+	{
+		// only visit the states that have messages
+		vector<CLogicState *>::iterator itState;
+		for( itState = _StateTable.begin(); itState != _StateTable.end(); ++itState )
+		{
+			if( !(*itState)->_MessagesToSend.empty() )
+			{
+				(*itState)->getMessagesToSend( msgs );
+			}
+		}
+		return;
+	}
+
 	map<std::string, CLogicState>::iterator itState;
 	for( itState = _States.begin(); itState != _States.end(); ++itState )
 	{
@@ -197,6 +243,433 @@ void CLogicStateMachine::getMessagesToSend( multimap<CEntityId,CMessage>& msgs )
 
 
 
+//---------------------------------------------------
+// CLogicStateMachine :
+//
+//---------------------------------------------------
+CLogicStateMachine::CLogicStateMachine( const CLogicStateMachine& other )
+{
+	_Compiled = false;
+	_CurrentStateIndex = NoIndex;
+	*this = other;
+
+} // CLogicStateMachine //
+
+
+
+//---------------------------------------------------
+// operator= :
+//
+//---------------------------------------------------
+CLogicStateMachine& CLogicStateMachine::operator=( const CLogicStateMachine& other )
+{
+	if( this == &other )
+	{
+		return *this;
+	}
+
+	_Variables = other._Variables;
+	_Counters = other._Counters;
+	_Conditions = other._Conditions;
+	_States = other._States;
+	_CurrentState = other._CurrentState;
+	_Name = other._Name;
+
+	// the conditions and the states refer to their state machine
+	map<string,CLogicCondition>::iterator itCond;
+	for( itCond = _Conditions.begin(); itCond != _Conditions.end(); ++itCond )
+	{
+		(*itCond).second.setLogicStateMachine( this );
+	}
+	map<string,CLogicState>::iterator itState;
+	for( itState = _States.begin(); itState != _States.end(); ++itState )
+	{
+		(*itState).second.setLogicStateMachine( this );
+	}
+
+	// the compiled data point in the other state machine
+	_Compiled = false;
+	_CurrentStateIndex = NoIndex;
+	_VariableTable.clear();
+	_CounterTable.clear();
+	_StateTable.clear();
+	_StateFirstEvent.clear();
+	_CompiledEvents.clear();
+	_CompiledConditions.clear();
+	_CompiledNodes.clear();
+
+	return *this;
+
+} // operator= //
+
+
+
+//---------------------------------------------------
+// compile :
+//
+//---------------------------------------------------
+void CLogicStateMachine::compile()
+{
+	_VariableTable.clear();
+	_CounterTable.clear();
+	_StateTable.clear();
+	_StateFirstEvent.clear();
+	_CompiledEvents.clear();
+	_CompiledConditions.clear();
+	_CompiledNodes.clear();
+
+	// variables then counters, a variable hides a counter with the same name as in getVariable()
+	map<string,uint32> varIndex;
+	map<string,CLogicVariable>::iterator itVar;
+	for( itVar = _Variables.begin(); itVar != _Variables.end(); ++itVar )
+	{
+		varIndex.insert( make_pair((*itVar).first, (uint32)_VariableTable.size()) );
+		_VariableTable.push_back( &(*itVar).second );
+	}
+	map<string,CLogicCounter>::iterator itCount;
+	for( itCount = _Counters.begin(); itCount != _Counters.end(); ++itCount )
+	{
+		_CounterTable.push_back( &(*itCount).second );
+		if( varIndex.insert( make_pair((*itCount).first, (uint32)_VariableTable.size()) ).second )
+		{
+			_VariableTable.push_back( &(*itCount).second );
+		}
+	}
+
+	// conditions, indexed first as they refer to each other
+	map<string,uint32> condIndex;
+	map<string,CLogicCondition>::iterator itCond;
+	for( itCond = _Conditions.begin(); itCond != _Conditions.end(); ++itCond )
+	{
+		condIndex.insert( make_pair((*itCond).first, (uint32)condIndex.size()) );
+	}
+	_CompiledConditions.resize( _Conditions.size() );
+	uint32 cond = 0;
+	for( itCond = _Conditions.begin(); itCond != _Conditions.end(); ++itCond, ++cond )
+	{
+		const CLogicCondition& condition = (*itCond).second;
+		vector<const CLogicConditionNode *> nodes;
+		vector<CLogicConditionNode>::const_iterator itNode;
+		for( itNode = condition.Nodes.begin(); itNode != condition.Nodes.end(); ++itNode )
+		{
+			nodes.push_back( &(*itNode) );
+		}
+
+		CCompiledCondition& compiledCondition = _CompiledConditions[cond];
+		compiledCondition.FirstNode = (uint32)_CompiledNodes.size();
+		compiledCondition.NodeCount = (uint32)nodes.size();
+		_CompiledNodes.resize( compiledCondition.FirstNode + compiledCondition.NodeCount );
+		compileNodes( nodes, compiledCondition.FirstNode, varIndex, condIndex );
+		compiledCondition.EndNode = (uint32)_CompiledNodes.size();
+	}
+
+	// a sub condition cycle would never end
+	vector<uint8> visited( _CompiledConditions.size(), 0 );
+	for( cond = 0; cond < _CompiledConditions.size(); ++cond )
+	{
+		if( visited[cond] == 0 )
+		{
+			checkConditionCycle( cond, visited );
+		}
+	}
+
+	// states
+	map<string,uint32> stateIndex;
+	map<string,CLogicState>::iterator itState;
+	for( itState = _States.begin(); itState != _States.end(); ++itState )
+	{
+		stateIndex.insert( make_pair((*itState).first, (uint32)_StateTable.size()) );
+		_StateTable.push_back( &(*itState).second );
+	}
+
+	// events
+	for( itState = _States.begin(); itState != _States.end(); ++itState )
+	{
+		_StateFirstEvent.push_back( (uint32)_CompiledEvents.size() );
+
+		vector<CLogicEvent>::const_iterator itEvent;
+		for( itEvent = (*itState).second._Events.begin(); itEvent != (*itState).second._Events.end(); ++itEvent )
+		{
+			CCompiledEvent event;
+			event.Condition = NoIndex;
+			event.State = NoIndex;
+
+			map<string,uint32>::const_iterator itIndex = condIndex.find( (*itEvent).ConditionName );
+			if( itIndex != condIndex.end() )
+			{
+				event.Condition = (*itIndex).second;
+			}
+			else
+			{
+				nlwarning("(LOGIC)<CLogicStateMachine::compile> Condition %s not found in the state machine \"%s\"",(*itEvent).ConditionName.c_str(),_Name.c_str());
+			}
+
+			if( (*itEvent).EventAction.IsStateChange )
+			{
+				itIndex = stateIndex.find( (*itEvent).EventAction.StateChange );
+				if( itIndex != stateIndex.end() )
+				{
+					event.State = (*itIndex).second;
+				}
+				else
+				{
+					nlwarning("(LOGIC)<CLogicStateMachine::compile> The state \"%s\" is not in the state machine \"%s\"",(*itEvent).EventAction.StateChange.c_str(),_Name.c_str());
+				}
+			}
+
+			_CompiledEvents.push_back( event );
+		}
+	}
+
+	// current state
+	map<string,uint32>::const_iterator itCurrent = stateIndex.find( _CurrentState );
+	_CurrentStateIndex = (itCurrent != stateIndex.end()) ? (*itCurrent).second : (uint32)NoIndex;
+
+	_Compiled = true;
+
+} // compile //
+
+
+
+//---------------------------------------------------
+// compileNodes :
+//
+//---------------------------------------------------
+void CLogicStateMachine::compileNodes( const vector<const CLogicConditionNode *>& nodes, uint32 first,
+									   const map<string,uint32>& varIndex, const map<string,uint32>& condIndex )
+{
+	uint i;
+	for( i = 0; i < nodes.size(); ++i )
+	{
+		const CLogicConditionNode& src = *nodes[i];
+		const CLogicConditionLogicBlock& block = src.LogicBlock;
+
+		CCompiledNode node;
+		node.Block = BLOCK_FALSE;
+		node.Comparison = CMP_EQUAL;
+		node.Not = block.isNotBlock();
+		node.Index = 0;
+		node.Comparand = 0;
+
+		// the logic block is tested whatever the node type, as in CLogicConditionNode::testLogic()
+		switch( block.Type )
+		{
+			case CLogicConditionLogicBlock::NOT :
+			{
+				node.Block = BLOCK_TRUE;
+			}
+			break;
+
+			case CLogicConditionLogicBlock::COMPARISON :
+			{
+				const CLogicComparisonBlock& comparison = block.ComparisonBlock;
+				map<string,uint32>::const_iterator itVar = varIndex.find( comparison.VariableName );
+				if( itVar == varIndex.end() )
+				{
+					nlwarning("(LOGIC)<CLogicStateMachine::compile> The variable %s is unknown in the state machine \"%s\"",comparison.VariableName.c_str(),_Name.c_str());
+					break;
+				}
+
+				if( comparison.Operator == "<"  )		node.Comparison = CMP_LESS;
+				else if( comparison.Operator == "<=" )	node.Comparison = CMP_LESS_EQUAL;
+				else if( comparison.Operator == ">"  )	node.Comparison = CMP_GREATER;
+				else if( comparison.Operator == ">=" )	node.Comparison = CMP_GREATER_EQUAL;
+				else if( comparison.Operator == "==" )	node.Comparison = CMP_EQUAL;
+				else if( comparison.Operator == "!=" )	node.Comparison = CMP_NOT_EQUAL;
+				else
+				{
+					nlwarning("(LOGIC)<CLogicStateMachine::compile> The comparison block operator %s is unknown",comparison.Operator.c_str());
+					break;
+				}
+
+				node.Block = BLOCK_COMPARISON;
+				node.Index = (*itVar).second;
+				node.Comparand = comparison.Comparand;
+			}
+			break;
+
+			case CLogicConditionLogicBlock::SUB_CONDITION :
+			{
+				map<string,uint32>::const_iterator itCond = condIndex.find( block.SubCondition );
+				if( itCond == condIndex.end() )
+				{
+					nlwarning("(LOGIC)<CLogicStateMachine::compile> The subcondition \"%s\" is unknown in the state machine \"%s\"",block.SubCondition.c_str(),_Name.c_str());
+					break;
+				}
+
+				node.Block = BLOCK_CONDITION;
+				node.Index = (*itCond).second;
+			}
+			break;
+
+			default :
+				nlwarning("(LOGIC)<CLogicStateMachine::compile> logic block type %d is unknown",block.Type);
+		}
+
+		// the sub nodes are contiguous, after the nodes of this level
+		node.FirstChild = (uint32)_CompiledNodes.size();
+		node.ChildCount = (uint32)src._Nodes.size();
+		_CompiledNodes.resize( node.FirstChild + node.ChildCount );
+		_CompiledNodes[first + i] = node;
+
+		if( node.ChildCount != 0 )
+		{
+			vector<const CLogicConditionNode *> children( src._Nodes.begin(), src._Nodes.end() );
+			compileNodes( children, node.FirstChild, varIndex, condIndex );
+		}
+	}
+
+} // compileNodes //
+
+
+
+//---------------------------------------------------
+// checkConditionCycle :
+//
+//---------------------------------------------------
+void CLogicStateMachine::checkConditionCycle( uint32 condition, vector<uint8>& visited )
+{
+	// 1 : being visited, 2 : done
+	visited[condition] = 1;
+
+	const CCompiledCondition& compiledCondition = _CompiledConditions[condition];
+	uint32 i;
+	for( i = compiledCondition.FirstNode; i < compiledCondition.EndNode; ++i )
+	{
+		CCompiledNode& node = _CompiledNodes[i];
+		if( node.Block != BLOCK_CONDITION )
+		{
+			continue;
+		}
+
+		if( visited[node.Index] == 1 )
+		{
+			nlwarning("(LOGIC)<CLogicStateMachine::compile> The subconditions of the state machine \"%s\" loop, the loop is broken",_Name.c_str());
+			node.Block = BLOCK_FALSE;
+		}
+		else if( visited[node.Index] == 0 )
+		{
+			checkConditionCycle( node.Index, visited );
+		}
+	}
+
+	visited[condition] = 2;
+
+} // checkConditionCycle //
+
+
+
+//---------------------------------------------------
+// testCompiledCondition :
+//
+//---------------------------------------------------
+bool CLogicStateMachine::testCompiledCondition( uint32 condition ) const
+{
+	// all the top level nodes must be true
+	const CCompiledCondition& compiledCondition = _CompiledConditions[condition];
+	uint32 i;
+	for( i = 0; i < compiledCondition.NodeCount; ++i )
+	{
+		if( !testCompiledNode(_CompiledNodes[compiledCondition.FirstNode + i]) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+
+} // testCompiledCondition //
+
+
+
+//---------------------------------------------------
+// testCompiledNode :
+//
+//---------------------------------------------------
+bool CLogicStateMachine::testCompiledNode( const CCompiledNode& node ) const
+{
+	// test the logic block
+	switch( node.Block )
+	{
+		case BLOCK_TRUE :
+			break;
+
+		case BLOCK_COMPARISON :
+		{
+			sint64 value = _VariableTable[node.Index]->getValue();
+			bool result;
+			switch( node.Comparison )
+			{
+				case CMP_LESS :				result = ( value <  node.Comparand ); break;
+				case CMP_LESS_EQUAL :		result = ( value <= node.Comparand ); break;
+				case CMP_GREATER :			result = ( value >  node.Comparand ); break;
+				case CMP_GREATER_EQUAL :	result = ( value >= node.Comparand ); break;
+				case CMP_EQUAL :			result = ( value == node.Comparand ); break;
+				default :					result = ( value != node.Comparand ); break;
+			}
+			if( !result )
+			{
+				return false;
+			}
+		}
+		break;
+
+		case BLOCK_CONDITION :
+		{
+			if( !testCompiledCondition(node.Index) )
+			{
+				return false;
+			}
+		}
+		break;
+
+		default :
+			return false;
+	}
+
+	// if there's no subtree we assess the subtree is true
+	if( node.ChildCount == 0 )
+	{
+		return true;
+	}
+
+	// the subtree is true if at least one node is true, false for a NOT block
+	uint32 i;
+	for( i = 0; i < node.ChildCount; ++i )
+	{
+		if( testCompiledNode(_CompiledNodes[node.FirstChild + i]) )
+		{
+			return !node.Not;
+		}
+	}
+
+	return node.Not;
+
+} // testCompiledNode //
+
+
+
+//---------------------------------------------------
+// switchToState :
+//
+//---------------------------------------------------
+void CLogicStateMachine::switchToState( uint32 stateIndex )
+{
+	CLogicState& state = *_StateTable[stateIndex];
+
+	state.exitState();
+
+	_CurrentState = state._StateName;
+	_CurrentStateIndex = stateIndex;
+
+	state.enterState();
+
+	nlinfo("Switching to state \"%s\"",_CurrentState.c_str());
+
+} // switchToState //
+
+
+
 
 //---------------------------------------------------
 // getVariable :
@@ -269,6 +742,50 @@ void CLogicStateMachine::modifyVariable( string varName, string modifOperator, s
 
 
 
+//---------------------------------------------------
+// getVariableIndex :
+//
+//---------------------------------------------------
+sint32 CLogicStateMachine::getVariableIndex( const std::string& varName )
+{
+	if( !_Compiled )
+	{
+		compile();
+	}
+
+	uint i;
+	for( i = 0; i < _VariableTable.size(); ++i )
+	{
+		if( _VariableTable[i]->getName() == varName )
+		{
+			return (sint32)i;
+		}
+	}
+
+	return -1;
+
+} // getVariableIndex //
+
+
+
+//---------------------------------------------------
+// modifyVariable :
+//
+//---------------------------------------------------
+void CLogicStateMachine::modifyVariable( uint32 varIndex, CLogicVariable::TModifOperator modifOperator, sint64 value )
+{
+	if( !_Compiled || varIndex >= _VariableTable.size() )
+	{
+		nlwarning("(LOGIC)<CLogicStateMachine::modifyVariable> The variable index %d is not valid in the state machine \"%s\"",varIndex,_Name.c_str());
+		return;
+	}
+
+	_VariableTable[varIndex]->applyModification( modifOperator, value );
+
+} // modifyVariable //
+
+
+
 //---------------------------------------------------
 // serial :
 //
@@ -570,6 +1087,8 @@ void CLogicStateMachine::read (xmlNodePtr node)
 {
 	xmlCheckNodeName (node, "STATE_MACHINE");
 
+	_Compiled = false;
+
 	setName (getXMLProp (node, "Name"));
 
 	{
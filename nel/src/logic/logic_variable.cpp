@@ -64,42 +64,75 @@ void CLogicVariable::setValue( sint64 value )
 
 
 
+//---------------------------------------------------
+// getModifOperator :
+//
+//---------------------------------------------------
+CLogicVariable::TModifOperator CLogicVariable::getModifOperator( const string& op )
+{
+	if( op == "SET" || op == "set" )	return MODIF_SET;
+	if( op == "ADD" || op == "add" )	return MODIF_ADD;
+	if( op == "SUB" || op == "sub" )	return MODIF_SUB;
+	if( op == "MUL" || op == "mul" )	return MODIF_MUL;
+	if( op == "DIV" || op == "div" )	return MODIF_DIV;
+	return MODIF_UNKNOWN;
+
+} // getModifOperator //
+
+
+
 //---------------------------------------------------
 // applyModification :
 //
 //---------------------------------------------------
 void CLogicVariable::applyModification( string op, sint64 value )
 {
-	if( op == "SET" || op == "set" )
-	{
-		_Value = value;
-	}
-	else
-	if( op == "ADD" || op == "add" )
-	{
-		_Value += value;
-	}
-	else
-	if( op == "SUB" || op == "sub" )
-	{
-		_Value -= value;
-	}
-	else
-	if( op == "MUL" || op == "mul")
-	{
-		_Value *= value;
-	}
-	else
-	if( op == "DIV" || op == "div")
-	{
-		if( value != 0 ) _Value /= value;
-	}
-	else
+	TModifOperator modifOperator = getModifOperator( op );
+	if( modifOperator == MODIF_UNKNOWN )
 	{
 		nlwarning("(LGCS)<CLogicVariable::applyModification> The operator \"%s\" is unknown",op.c_str());
 		return;
 	}
 
+	applyModification( modifOperator, value );
+
+} // applyModification //
+
+
+
+//---------------------------------------------------
+// applyModification :
+//
+//---------------------------------------------------
+void CLogicVariable::applyModification( TModifOperator op, sint64 value )
+{
+	switch( op )
+	{
+		case MODIF_SET :
+			_Value = value;
+			break;
+
+		case MODIF_ADD :
+			_Value += value;
+			break;
+
+		case MODIF_SUB :
+			_Value -= value;
+			break;
+
+		case MODIF_MUL :
+			_Value *= value;
+			break;
+
+		case MODIF_DIV :
+			if( value != 0 ) _Value /= value;
+			break;
+
+		default :
+			nlwarning("(LGCS)<CLogicVariable::applyModification> The operator %d is unknown",op);
+			return;
+	}
+
 	if( _Verbose )
 	{
 		nlinfo("variable \"%s\" value is now %f",_Name.c_str(),(double)_Value);
@@ -24,6 +24,7 @@
 #include "nel/misc/file.h"
 #include "nel/misc/path.h"
 #include "nel/misc/async_file_manager.h"
+#include "nel/misc/batch_file_reader.h"
 
 
 using namespace std;
@@ -54,6 +55,28 @@ NLMISC_SAFE_SINGLETON_IMPL(CAsyncFileManager);
 */
 // ***************************************************************************
 
+CAsyncFileManager::~CAsyncFileManager()
+{
+	// The loading thread may still use the reader
+	{
+		CSynchronized<list<CWaitingTask> >::CAccessor acces(&_TaskQueue);
+		waitCurrentTaskToComplete ();
+	}
+	delete _Reader;
+}
+
+// ***************************************************************************
+
+CBatchFileReader &CAsyncFileManager::getReader ()
+{
+	// Only used by the loading thread
+	if (_Reader == NULL)
+		_Reader = new CBatchFileReader;
+	return *_Reader;
+}
+
+// ***************************************************************************
+
 void CAsyncFileManager::terminate ()
 {
 	if (_Instance != NULL)
@@ -208,26 +231,9 @@ CAsyncFileManager::CFileLoad::CFileLoad (const std::string& sFileName, uint8 **p
 // ***************************************************************************
 void CAsyncFileManager::CFileLoad::run (void)
 {
-	FILE *f = fopen (_FileName.c_str(), "rb");
-	if (f != NULL)
-	{
-		uint8 *ptr;
-		long filesize=CFile::getFileSize (f);
-		//fseek (f, 0, SEEK_END);
-		//long filesize = ftell (f);
-		//nlSleep(5);
-		//fseek (f, 0, SEEK_SET);
-		ptr = new uint8[filesize];
-		fread (ptr, filesize, 1, f);
-		fclose (f);
-
-		*_ppFile = ptr;
-	}
-	else
-	{
-		nlwarning ("AFM: Couldn't load '%s'", _FileName.c_str());
-		*_ppFile = (uint8*)-1;
-	}
+	CBatchFileReader &reader = CAsyncFileManager::getInstance().getReader ();
+	reader.addFile (_FileName, _ppFile);
+	reader.read ();
 }
 
 // ***************************************************************************
@@ -251,30 +257,11 @@ CAsyncFileManager::CMultipleFileLoad::CMultipleFileLoad (const std::vector<std::
 // ***************************************************************************
 void CAsyncFileManager::CMultipleFileLoad::run (void)
 {
+	// All the reads are in flight together, each pointer is set as soon as its file is read
+	CBatchFileReader &reader = CAsyncFileManager::getInstance().getReader ();
 	for (uint32 i = 0; i < _FileNames.size(); ++i)
-	{
-		FILE *f = fopen (_FileNames[i].c_str(), "rb");
-		if (f != NULL)
-		{
-			uint8 *ptr;
-			long filesize=CFile::getFileSize (f);
-			//fseek (f, 0, SEEK_END);
-			//long filesize = ftell (f);
-			//nlSleep(5);
-			//fseek (f, 0, SEEK_SET);
-			ptr = new uint8[filesize];
-			fread (ptr, filesize, 1, f);
-			fclose (f);
-
-			*_Ptrs[i] = ptr;
-		}
-		else
-		{
-			nlwarning ("AFM: Couldn't load '%s'", _FileNames[i].c_str());
-			*_Ptrs[i] = (uint8*)-1;
-		}
-	}
-
+		reader.addFile (_FileNames[i], _Ptrs[i]);
+	reader.read ();
 }
 
 // ***************************************************************************
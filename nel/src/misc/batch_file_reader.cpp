@@ -0,0 +1,810 @@
+/** \file batch_file_reader.cpp
+ * Read a batch of files with asynchronous reads
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdmisc.h"
+
+#include "nel/misc/batch_file_reader.h"
+#include "nel/misc/big_file.h"
+#include "nel/misc/lz4_block.h"
+#include "nel/misc/mutex.h"
+#include "nel/misc/time_nl.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef NL_OS_WINDOWS
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+#if defined(NL_OS_UNIX) && defined(__linux__)
+#	include <linux/version.h>
+#	if LINUX_VERSION_CODE >= KERNEL_VERSION(5,1,0)
+#		define NL_BATCH_FILE_READER_IO_URING
+#		include <linux/io_uring.h>
+#		include <sys/mman.h>
+#		include <sys/syscall.h>
+#		include <sys/uio.h>
+#	endif
+#endif
+
+using namespace std;
+
+namespace NLMISC
+{
+
+// ***************************************************************************
+// Bandwidth budget
+// ***************************************************************************
+
+// The budget is a bucket of bytes refilled at the bandwidth, it can hold a quarter of a second of reads
+struct CReadBandwidthBudget
+{
+	CMutex		Mutex;
+	uint32		BytesPerSecond;
+	double		Available;
+	TTime		LastTime;
+
+	CReadBandwidthBudget(uint32 bytesPerSecond) : BytesPerSecond(bytesPerSecond), Available(0), LastTime(0) { }
+
+	void setBandwidth (uint32 bytesPerSecond)
+	{
+		CAutoMutex<CMutex> lock (Mutex);
+		BytesPerSecond = bytesPerSecond;
+		Available = std::max (bytesPerSecond / 4.0, (double)CBatchFileReader::ReadSize);
+		LastTime = CTime::getLocalTime ();
+	}
+
+	uint32 getBandwidth ()
+	{
+		CAutoMutex<CMutex> lock (Mutex);
+		return BytesPerSecond;
+	}
+
+	void consume (uint32 size)
+	{
+		double wait;
+		{
+			CAutoMutex<CMutex> lock (Mutex);
+			if (BytesPerSecond == 0)
+				return;
+
+			// Refill the bucket, then take the read in it. A read larger than the bucket leaves a debt.
+			TTime now = CTime::getLocalTime ();
+			double available = Available + (now - LastTime) / 1000.0 * BytesPerSecond;
+			available = std::min (available, std::max (BytesPerSecond / 4.0, (double)CBatchFileReader::ReadSize));
+			Available = available - size;
+			LastTime = now;
+			wait = -Available / BytesPerSecond;
+		}
+
+		// Wait for the refill of the debt
+		if (wait > 0)
+			nlSleep ((uint32)(wait * 1000.0) + 1);
+	}
+};
+
+// Shared by the readers and the async loading of CIFile, no limit by default
+static CReadBandwidthBudget	ReadBandwidthBudget (0);
+// The async loading of CIFile only
+static CReadBandwidthBudget	CacheLoadBandwidthBudget (CBatchFileReader::DefaultCacheLoadBandwidth);
+
+// ***************************************************************************
+void CBatchFileReader::setBandwidth (uint32 bytesPerSecond)
+{
+	ReadBandwidthBudget.setBandwidth (bytesPerSecond);
+}
+
+// ***************************************************************************
+uint32 CBatchFileReader::getBandwidth ()
+{
+	return ReadBandwidthBudget.getBandwidth ();
+}
+
+// ***************************************************************************
+void CBatchFileReader::consumeBandwidth (uint32 size)
+{
+	ReadBandwidthBudget.consume (size);
+}
+
+// ***************************************************************************
+void CBatchFileReader::setCacheLoadBandwidth (uint32 bytesPerSecond)
+{
+	CacheLoadBandwidthBudget.setBandwidth (bytesPerSecond);
+}
+
+// ***************************************************************************
+uint32 CBatchFileReader::getCacheLoadBandwidth ()
+{
+	return CacheLoadBandwidthBudget.getBandwidth ();
+}
+
+// ***************************************************************************
+void CBatchFileReader::consumeCacheLoadBandwidth (uint32 size)
+{
+	CacheLoadBandwidthBudget.consume (size);
+	ReadBandwidthBudget.consume (size);
+}
+
+
+// ***************************************************************************
+// File handles
+// ***************************************************************************
+
+// ***************************************************************************
+static sint openHandle (const string &fileName)
+{
+#ifdef NL_OS_WINDOWS
+	return _open (fileName.c_str (), _O_RDONLY | _O_BINARY);
+#else
+	return open (fileName.c_str (), O_RDONLY);
+#endif
+}
+
+// ***************************************************************************
+static void closeHandle (sint handle)
+{
+#ifdef NL_OS_WINDOWS
+	_close (handle);
+#else
+	close (handle);
+#endif
+}
+
+// ***************************************************************************
+static bool getHandleSize (sint handle, uint64 &size)
+{
+#ifdef NL_OS_WINDOWS
+	__int64 length = _filelengthi64 (handle);
+	if (length < 0)
+		return false;
+	size = (uint64)length;
+#else
+	struct stat st;
+	if (fstat (handle, &st) != 0)
+		return false;
+	size = (uint64)st.st_size;
+#endif
+	return true;
+}
+
+// ***************************************************************************
+// Read at a position, return the number of bytes read or -1
+static sint readHandle (sint handle, uint8 *dest, uint32 size, uint64 pos)
+{
+#ifdef NL_OS_WINDOWS
+	if (_lseeki64 (handle, pos, SEEK_SET) < 0)
+		return -1;
+	return _read (handle, dest, size);
+#else
+	return (sint)pread (handle, dest, size, (off_t)pos);
+#endif
+}
+
+
+// ***************************************************************************
+// io_uring
+// ***************************************************************************
+
+#ifdef NL_BATCH_FILE_READER_IO_URING
+
+/*
+ * An io_uring used with the system calls directly, without liburing.
+ * The submission and completion queues are shared with the kernel: the application writes the tail
+ * of the submission queue and the head of the completion queue, the kernel writes the other ends.
+ */
+class CBatchFileReader::CRing
+{
+public:
+	// Return NULL if io_uring is not supported by the kernel
+	static CRing	*create (uint entries);
+	~CRing ();
+
+	// Queue a read, false if the queue is full
+	bool		queueRead (sint handle, uint8 *dest, uint32 size, uint64 pos, uint32 readIndex);
+	// Submit the queued reads and wait for a completion, false on an error
+	bool		submitAndWait ();
+	// Get a completion, false if none
+	bool		getCompletion (uint32 &readIndex, sint32 &result);
+
+private:
+	CRing () : _Fd (-1), _SqRing (NULL), _CqRing (NULL), _Sqes (NULL) { }
+
+	sint				_Fd;
+	io_uring_params		_Params;
+	uint8				*_SqRing;
+	uint8				*_CqRing;
+	size_t				_SqRingSize;
+	size_t				_CqRingSize;
+	io_uring_sqe		*_Sqes;
+	// Submission queue
+	uint32				*_SqHead;
+	uint32				*_SqTail;
+	uint32				*_SqMask;
+	uint32				*_SqArray;
+	// Completion queue
+	uint32				*_CqHead;
+	uint32				*_CqTail;
+	uint32				*_CqMask;
+	io_uring_cqe		*_Cqes;
+	// The iovec of the reads in flight, and the free ones
+	std::vector<iovec>	_Iovecs;
+	std::vector<uint32>	_FreeIovecs;
+};
+
+// ***************************************************************************
+CBatchFileReader::CRing *CBatchFileReader::CRing::create (uint entries)
+{
+	CRing *ring = new CRing;
+	memset (&ring->_Params, 0, sizeof (ring->_Params));
+	ring->_Fd = (sint)syscall (__NR_io_uring_setup, entries, &ring->_Params);
+	if (ring->_Fd < 0)
+	{
+		nlinfo ("BFR: io_uring is not available (%s), the files are read with pread()", strerror (errno));
+		delete ring;
+		return NULL;
+	}
+
+	const io_uring_params &params = ring->_Params;
+	ring->_SqRingSize = params.sq_off.array + params.sq_entries * sizeof (uint32);
+	ring->_CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap)
+		ring->_SqRingSize = ring->_CqRingSize = std::max (ring->_SqRingSize, ring->_CqRingSize);
+
+	void *sqRing = mmap (NULL, ring->_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->_Fd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED)
+	{
+		nlwarning ("BFR: Can't map the io_uring: %s", strerror (errno));
+		delete ring;
+		return NULL;
+	}
+	ring->_SqRing = (uint8*)sqRing;
+
+	if (singleMap)
+	{
+		ring->_CqRing = ring->_SqRing;
+	}
+	else
+	{
+		void *cqRing = mmap (NULL, ring->_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->_Fd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED)
+		{
+			nlwarning ("BFR: Can't map the io_uring: %s", strerror (errno));
+			delete ring;
+			return NULL;
+		}
+		ring->_CqRing = (uint8*)cqRing;
+	}
+
+	void *sqes = mmap (NULL, params.sq_entries * sizeof (io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->_Fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+	{
+		nlwarning ("BFR: Can't map the io_uring: %s", strerror (errno));
+		delete ring;
+		return NULL;
+	}
+	ring->_Sqes = (io_uring_sqe*)sqes;
+
+	ring->_SqHead = (uint32*)(ring->_SqRing + params.sq_off.head);
+	ring->_SqTail = (uint32*)(ring->_SqRing + params.sq_off.tail);
+	ring->_SqMask = (uint32*)(ring->_SqRing + params.sq_off.ring_mask);
+	ring->_SqArray = (uint32*)(ring->_SqRing + params.sq_off.array);
+	ring->_CqHead = (uint32*)(ring->_CqRing + params.cq_off.head);
+	ring->_CqTail = (uint32*)(ring->_CqRing + params.cq_off.tail);
+	ring->_CqMask = (uint32*)(ring->_CqRing + params.cq_off.ring_mask);
+	ring->_Cqes = (io_uring_cqe*)(ring->_CqRing + params.cq_off.cqes);
+
+	ring->_Iovecs.resize (entries);
+	for (uint i=0; i<entries; i++)
+		ring->_FreeIovecs.push_back (entries-1-i);
+	return ring;
+}
+
+// ***************************************************************************
+CBatchFileReader::CRing::~CRing ()
+{
+	if (_Sqes)
+		munmap (_Sqes, _Params.sq_entries * sizeof (io_uring_sqe));
+	if (_CqRing && _CqRing != _SqRing)
+		munmap (_CqRing, _CqRingSize);
+	if (_SqRing)
+		munmap (_SqRing, _SqRingSize);
+	// Closing the ring waits for the reads in flight
+	if (_Fd >= 0)
+		close (_Fd);
+}
+
+// ***************************************************************************
+bool CBatchFileReader::CRing::queueRead (sint handle, uint8 *dest, uint32 size, uint64 pos, uint32 readIndex)
+{
+	// Only this thread writes the tail, the kernel moves the head
+	uint32 tail = *_SqTail;
+	uint32 head = __atomic_load_n (_SqHead, __ATOMIC_ACQUIRE);
+	if (tail - head >= _Params.sq_entries || _FreeIovecs.empty ())
+		return false;
+
+	uint32 iovecIndex = _FreeIovecs.back ();
+	_FreeIovecs.pop_back ();
+	iovec &vec = _Iovecs[iovecIndex];
+	vec.iov_base = dest;
+	vec.iov_len = size;
+
+	uint32 index = tail & *_SqMask;
+	io_uring_sqe &sqe = _Sqes[index];
+	memset (&sqe, 0, sizeof (sqe));
+	sqe.opcode = IORING_OP_READV;
+	sqe.fd = handle;
+	sqe.off = pos;
+	sqe.addr = (uint64)(size_t)&vec;
+	sqe.len = 1;
+	sqe.user_data = ((uint64)iovecIndex << 32) | readIndex;
+	_SqArray[index] = index;
+
+	__atomic_store_n (_SqTail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+// ***************************************************************************
+bool CBatchFileReader::CRing::submitAndWait ()
+{
+	for (;;)
+	{
+		uint32 toSubmit = *_SqTail - __atomic_load_n (_SqHead, __ATOMIC_ACQUIRE);
+		long result = syscall (__NR_io_uring_enter, _Fd, toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (result >= 0)
+			return true;
+		if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			nlwarning ("BFR: io_uring_enter failed: %s", strerror (errno));
+			return false;
+		}
+		// EAGAIN and EBUSY: the kernel is short of resources, the completions free them
+		if (errno != EINTR && *_CqHead != __atomic_load_n (_CqTail, __ATOMIC_ACQUIRE))
+			return true;
+	}
+}
+
+// ***************************************************************************
+bool CBatchFileReader::CRing::getCompletion (uint32 &readIndex, sint32 &result)
+{
+	uint32 head = *_CqHead;
+	if (head == __atomic_load_n (_CqTail, __ATOMIC_ACQUIRE))
+		return false;
+
+	const io_uring_cqe &cqe = _Cqes[head & *_CqMask];
+	readIndex = (uint32)cqe.user_data;
+	_FreeIovecs.push_back ((uint32)(cqe.user_data >> 32));
+	result = cqe.res;
+	__atomic_store_n (_CqHead, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+#else // NL_BATCH_FILE_READER_IO_URING
+
+class CBatchFileReader::CRing
+{
+public:
+	static CRing	*create (uint entries) { return NULL; }
+	bool		queueRead (sint handle, uint8 *dest, uint32 size, uint64 pos, uint32 readIndex) { return false; }
+	bool		submitAndWait () { return false; }
+	bool		getCompletion (uint32 &readIndex, sint32 &result) { return false; }
+};
+
+#endif // NL_BATCH_FILE_READER_IO_URING
+
+
+// ***************************************************************************
+// CBatchFileReader
+// ***************************************************************************
+
+// The file is not using a handle
+static const uint	NoHandle = 0xffffffff;
+
+// ***************************************************************************
+CBatchFileReader::CBatchFileReader (bool useIOUring) : _NextFile (0), _Ring (NULL), _NumRead (0)
+{
+	if (useIOUring)
+		_Ring = CRing::create (QueueDepth);
+}
+
+// ***************************************************************************
+CBatchFileReader::~CBatchFileReader ()
+{
+	delete _Ring;
+	closeHandles ();
+}
+
+// ***************************************************************************
+void CBatchFileReader::addFile (const std::string &fileName, uint8 **ppFile)
+{
+	_Files.push_back (CFileToRead ());
+	CFileToRead &file = _Files.back ();
+	file.FileName = fileName;
+	file.PtrFile = ppFile;
+	file.Buffer = NULL;
+	file.Size = 0;
+	file.Handle = NoHandle;
+	file.Offset = 0;
+	file.Blocks = NULL;
+	file.PendingReads = 0;
+	file.Failed = false;
+}
+
+// ***************************************************************************
+void CBatchFileReader::closeHandles ()
+{
+	for (uint i=0; i<_Handles.size (); i++)
+	{
+		if (_Handles[i].Handle >= 0)
+			closeHandle (_Handles[i].Handle);
+	}
+	_Handles.clear ();
+}
+
+// ***************************************************************************
+bool CBatchFileReader::prepareNextFile (std::deque<CRead> &reads)
+{
+	if (_NextFile >= _Files.size ())
+		return false;
+	uint index = _NextFile++;
+	CFileToRead &file = _Files[index];
+
+	// Find the file, in a bnp or on the disk
+	string handleName;
+	string::size_type pos = file.FileName.find ('@');
+	bool inBigFile = pos != string::npos;
+	if (inBigFile)
+	{
+		// The files of the xml packs are not supported
+		if ((pos+1 < file.FileName.size () && file.FileName[pos+1] == '@') ||
+			!CBigFile::getInstance ().getFileLocation (file.FileName, handleName, file.Offset, file.Size, file.Blocks))
+		{
+			file.Failed = true;
+			completeFile (file);
+			return true;
+		}
+	}
+	else
+	{
+		handleName = file.FileName;
+	}
+
+	// The handle of a bnp is shared by its files
+	uint handle = (uint)_Handles.size ();
+	if (inBigFile)
+	{
+		for (uint i=0; i<_Handles.size (); i++)
+		{
+			if (_Handles[i].BigFile && _Handles[i].Name == handleName)
+			{
+				handle = i;
+				break;
+			}
+		}
+	}
+	if (handle == _Handles.size ())
+	{
+		_Handles.push_back (CHandle ());
+		_Handles.back ().Name = handleName;
+		_Handles.back ().Handle = openHandle (handleName);
+		_Handles.back ().Users = 0;
+		_Handles.back ().BigFile = inBigFile;
+	}
+	if (_Handles[handle].Handle < 0)
+	{
+		file.Failed = true;
+		completeFile (file);
+		return true;
+	}
+	file.Handle = handle;
+	_Handles[handle].Users++;
+
+	if (!inBigFile)
+	{
+		uint64 size;
+		if (!getHandleSize (_Handles[handle].Handle, size) || size > 0xffffffff)
+		{
+			file.Failed = true;
+			completeFile (file);
+			return true;
+		}
+		file.Size = (uint32)size;
+	}
+
+	file.Buffer = new uint8[file.Size];
+
+	// Cut the file in reads
+	CRead read;
+	read.File = index;
+	read.Done = 0;
+	read.Completed = false;
+	if (file.Blocks)
+	{
+		const CBigFileBlocks &blocks = *file.Blocks;
+		uint numBlocks = (file.Size + blocks.BlockSize - 1) / blocks.BlockSize;
+		if (numBlocks > blocks.NumBlocks)
+		{
+			file.Failed = true;
+			numBlocks = 0;
+		}
+		for (uint block=0; block<numBlocks; block++)
+		{
+			uint32 blockLength = std::min (blocks.BlockSize, file.Size - block * blocks.BlockSize);
+			uint32 storedSize = blocks.Sizes[block] & ~CBigFile::RawBlockFlag;
+			read.Pos = blocks.Positions[block];
+			read.Size = storedSize;
+			if (blocks.Sizes[block] & CBigFile::RawBlockFlag)
+			{
+				if (storedSize != blockLength)
+				{
+					file.Failed = true;
+					break;
+				}
+				read.Dest = file.Buffer + block * blocks.BlockSize;
+				read.Target = NULL;
+			}
+			else
+			{
+				// Read in Compressed when the read is submitted
+				read.Dest = NULL;
+				read.Target = file.Buffer + block * blocks.BlockSize;
+			}
+			read.BlockLength = blockLength;
+			reads.push_back (read);
+			file.PendingReads++;
+		}
+	}
+	else
+	{
+		read.Target = NULL;
+		read.BlockLength = 0;
+		for (uint32 offset=0; offset<file.Size; offset+=ReadSize)
+		{
+			read.Pos = file.Offset + offset;
+			read.Dest = file.Buffer + offset;
+			read.Size = std::min ((uint32)ReadSize, file.Size - offset);
+			reads.push_back (read);
+			file.PendingReads++;
+		}
+	}
+
+	// Empty file, or no read
+	if (file.PendingReads == 0)
+		completeFile (file);
+	return true;
+}
+
+// ***************************************************************************
+CBatchFileReader::CRead *CBatchFileReader::getRead (std::deque<CRead> &reads, uint index)
+{
+	while (index >= reads.size ())
+	{
+		if (!prepareNextFile (reads))
+			return NULL;
+	}
+	return &reads[index];
+}
+
+// ***************************************************************************
+void CBatchFileReader::complete (CRead &read, bool ok)
+{
+	CFileToRead &file = _Files[read.File];
+	read.Completed = true;
+	if (ok && read.Target)
+		ok = lz4Decompress (&read.Compressed[0], read.Size, read.Target, read.BlockLength);
+	std::vector<uint8>().swap (read.Compressed);
+	if (!ok)
+		file.Failed = true;
+
+	nlassert (file.PendingReads > 0);
+	if (--file.PendingReads == 0)
+		completeFile (file);
+}
+
+// ***************************************************************************
+void CBatchFileReader::completeFile (CFileToRead &file)
+{
+	// Close the handle of a disk file as soon as possible, a batch can have more files than the process can open
+	if (file.Handle != NoHandle)
+	{
+		CHandle &handle = _Handles[file.Handle];
+		nlassert (handle.Users > 0);
+		if (--handle.Users == 0 && !handle.BigFile)
+		{
+			closeHandle (handle.Handle);
+			handle.Handle = -1;
+		}
+	}
+
+	if (file.Failed)
+	{
+		nlwarning ("BFR: Couldn't load '%s'", file.FileName.c_str ());
+		delete [] file.Buffer;
+		*file.PtrFile = (uint8*)-1;
+	}
+	else
+	{
+		*file.PtrFile = file.Buffer;
+		_NumRead++;
+	}
+	file.Buffer = NULL;
+}
+
+// ***************************************************************************
+void CBatchFileReader::readWithPRead (std::deque<CRead> &reads)
+{
+	CRead *read;
+	for (uint i=0; (read = getRead (reads, i)) != NULL; i++)
+	{
+		if (read->Completed)
+			continue;
+		if (_Files[read->File].Failed)
+		{
+			complete (*read, false);
+			continue;
+		}
+
+		if (read->Target)
+		{
+			read->Compressed.resize (read->Size);
+			read->Dest = &read->Compressed[0];
+		}
+		consumeBandwidth (read->Size);
+
+		sint handle = _Handles[_Files[read->File].Handle].Handle;
+		bool ok = true;
+		while (ok && read->Done < read->Size)
+		{
+			sint result = readHandle (handle, read->Dest + read->Done, read->Size - read->Done, read->Pos + read->Done);
+			if (result < 0 && errno == EINTR)
+				continue;
+			ok = result > 0;
+			if (ok)
+				read->Done += result;
+		}
+		complete (*read, ok);
+	}
+}
+
+// ***************************************************************************
+void CBatchFileReader::readWithRing (std::deque<CRead> &reads)
+{
+	// The reads cut short are queued again before the next ones
+	std::vector<uint32> partialReads;
+	uint32 next = 0;
+	uint inFlight = 0;
+	for (;;)
+	{
+		// Keep the queue full
+		while (inFlight < QueueDepth)
+		{
+			uint32 index;
+			CRead *read;
+			if (!partialReads.empty ())
+			{
+				index = partialReads.back ();
+				read = &reads[index];
+			}
+			else
+			{
+				index = next;
+				read = getRead (reads, index);
+				if (read == NULL)
+					break;
+				if (_Files[read->File].Failed)
+				{
+					complete (*read, false);
+					next++;
+					continue;
+				}
+				if (read->Target)
+				{
+					read->Compressed.resize (read->Size);
+					read->Dest = &read->Compressed[0];
+				}
+			}
+
+			sint handle = _Handles[_Files[read->File].Handle].Handle;
+			if (!_Ring->queueRead (handle, read->Dest + read->Done, read->Size - read->Done, read->Pos + read->Done, index))
+				break;
+
+			if (partialReads.empty ())
+			{
+				consumeBandwidth (read->Size);
+				next++;
+			}
+			else
+			{
+				partialReads.pop_back ();
+			}
+			inFlight++;
+		}
+
+		// All the reads are completed
+		if (inFlight == 0)
+			break;
+
+		if (!_Ring->submitAndWait ())
+		{
+			// Closing the ring waits for the reads in flight, then the reads not completed are done again
+			nlwarning ("BFR: io_uring failed, the files are read with pread()");
+			delete _Ring;
+			_Ring = NULL;
+			for (uint i=0; i<reads.size (); i++)
+				reads[i].Done = 0;
+			readWithPRead (reads);
+			return;
+		}
+
+		uint32 index;
+		sint32 result;
+		while (_Ring->getCompletion (index, result))
+		{
+			inFlight--;
+			CRead &read = reads[index];
+			if (result == -EINTR || result == -EAGAIN)
+			{
+				partialReads.push_back (index);
+			}
+			else if (result <= 0)
+			{
+				complete (read, false);
+			}
+			else
+			{
+				read.Done += result;
+				if (read.Done < read.Size)
+					partialReads.push_back (index);
+				else
+					complete (read, true);
+			}
+		}
+	}
+}
+
+// ***************************************************************************
+uint CBatchFileReader::read ()
+{
+	// The files are opened and cut in reads while the reads are submitted. The reads in flight
+	// must not move: they can be read in their Compressed buffer.
+	std::deque<CRead> reads;
+	_NextFile = 0;
+	if (_Ring)
+		readWithRing (reads);
+	else
+		readWithPRead (reads);
+
+	uint numRead = _NumRead;
+	_Files.clear ();
+	_NextFile = 0;
+	_NumRead = 0;
+	closeHandles ();
+	return numRead;
+}
+
+
+} // NLMISC
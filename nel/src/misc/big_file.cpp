@@ -25,6 +25,7 @@
 
 #include "nel/misc/big_file.h"
 #include "nel/misc/path.h"
+#include "nel/misc/lz4_block.h"
 
 using namespace std;
 using namespace NLMISC;
@@ -142,76 +143,97 @@ bool CBigFile::add (const std::string &sBigFileName, uint32 nOptions)
 	handle.File = fopen (sBigFileName.c_str(), "rb");
 	if (handle.File == NULL)
 		return false;
-	uint32 nFileSize=CFile::getFileSize (handle.File);
-	//nlfseek64 (handle.File, 0, SEEK_END);
-	//uint32 nFileSize = ftell (handle.File);
 
-	// Result
-	if (nlfseek64 (handle.File, nFileSize-4, SEEK_SET) != 0)
+	// The file size, on 64 bits
+	sint64 nFileSize = -1;
+	if (nlfseek64 (handle.File, 0, SEEK_END) == 0)
+		nFileSize = nlftell64 (handle.File);
+	if (nFileSize < (sint64)sizeof(uint32))
 	{
 		fclose (handle.File);
 		handle.File = NULL;
 		return false;
 	}
 
-	uint32 nOffsetFromBegining;
-	if (fread (&nOffsetFromBegining, sizeof(uint32), 1, handle.File) != 1)
+	// A v2 bnp ends with a footer, whose directory ends at the footer
+	bool v2 = false;
+	CBNP2Footer footer;
+	if (nFileSize >= (sint64)sizeof(CBNP2Footer) &&
+		nlfseek64 (handle.File, nFileSize-sizeof(CBNP2Footer), SEEK_SET) == 0 &&
+		fread (&footer, sizeof(CBNP2Footer), 1, handle.File) == 1)
+	{
+		v2 = (footer.Magic == BNP2Magic) && (footer.DirOffset + footer.DirSize + sizeof(CBNP2Footer) == (uint64)nFileSize);
+	}
+
+	bool result;
+	if (v2)
+	{
+		result = (nlfseek64 (handle.File, footer.DirOffset, SEEK_SET) == 0) && readDirectory2 (handle.File, bnp, footer);
+	}
+	else
+	{
+		// A v1 bnp ends with the offset of the directory
+		uint32 nOffsetFromBegining;
+		result = (nlfseek64 (handle.File, nFileSize-4, SEEK_SET) == 0) &&
+			(fread (&nOffsetFromBegining, sizeof(uint32), 1, handle.File) == 1) &&
+			(nlfseek64 (handle.File, nOffsetFromBegining, SEEK_SET) == 0) &&
+			readDirectory1 (handle.File, bnp);
+	}
+
+	if (!result || nlfseek64 (handle.File, 0, SEEK_SET) != 0)
 	{
 		fclose (handle.File);
 		handle.File = NULL;
 		return false;
 	}
 
-	if (nlfseek64 (handle.File, nOffsetFromBegining, SEEK_SET) != 0)
+	if (nOptions&BF_CACHE_FILE_ON_OPEN)
+		bnp.CacheFileOnOpen = true;
+	else
+		bnp.CacheFileOnOpen = false;
+
+	if (!(nOptions&BF_ALWAYS_OPENED))
 	{
 		fclose (handle.File);
 		handle.File = NULL;
-		return false;
+		bnp.AlwaysOpened = false;
+	}
+	else
+	{
+		bnp.AlwaysOpened = true;
 	}
 
+	nldebug("BigFile : added bnp '%s' to the collection", bigfilenamealone.c_str());
+
+	return true;
+}
+
+// ***************************************************************************
+bool CBigFile::readDirectory1 (FILE *file, BNP &bnp)
+{
 	// Read the file count
 	uint32 nNbFile;
-	if (fread (&nNbFile, sizeof(uint32), 1, handle.File) != 1)
-	{
-		fclose (handle.File);
-		handle.File = NULL;
+	if (fread (&nNbFile, sizeof(uint32), 1, file) != 1)
 		return false;
-	}
 	map<string,BNPFile> tempMap;
 	for (uint32 i = 0; i < nNbFile; ++i)
 	{
 		char FileName[256];
 		uint8 nStringSize;
-		if (fread (&nStringSize, 1, 1, handle.File) != 1)
-		{
-			fclose (handle.File);
-			handle.File = NULL;
+		if (fread (&nStringSize, 1, 1, file) != 1)
 			return false;
-		}
 
-		if (fread (FileName, nStringSize, 1, handle.File) != 1)
-		{
-			fclose (handle.File);
-			handle.File = NULL;
+		if (fread (FileName, nStringSize, 1, file) != 1)
 			return false;
-		}
 
 		FileName[nStringSize] = 0;
 		uint32 nFileSize2;
-		if (fread (&nFileSize2, sizeof(uint32), 1, handle.File) != 1)
-		{
-			fclose (handle.File);
-			handle.File = NULL;
+		if (fread (&nFileSize2, sizeof(uint32), 1, file) != 1)
 			return false;
-		}
 
 		uint32 nFilePos;
-		if (fread (&nFilePos, sizeof(uint32), 1, handle.File) != 1)
-		{
-			fclose (handle.File);
-			handle.File = NULL;
+		if (fread (&nFilePos, sizeof(uint32), 1, file) != 1)
 			return false;
-		}
 
 		BNPFile bnpfTmp;
 		bnpfTmp.Pos = nFilePos;
@@ -219,13 +241,6 @@ bool CBigFile::add (const std::string &sBigFileName, uint32 nOptions)
 		tempMap.insert (make_pair(toLower(string(FileName)), bnpfTmp));
 	}
 
-	if (nlfseek64 (handle.File, 0, SEEK_SET) != 0)
-	{
-		fclose (handle.File);
-		handle.File = NULL;
-		return false;
-	}
-
 	// Convert temp map
 	if (nNbFile > 0)
 	{
@@ -260,27 +275,143 @@ bool CBigFile::add (const std::string &sBigFileName, uint32 nOptions)
 	}
 	// End of temp map conversion
 
-	if (nOptions&BF_CACHE_FILE_ON_OPEN)
-		bnp.CacheFileOnOpen = true;
-	else
-		bnp.CacheFileOnOpen = false;
+	return true;
+}
 
-	if (!(nOptions&BF_ALWAYS_OPENED))
+// ***************************************************************************
+bool CBigFile::readDirectory2 (FILE *file, BNP &bnp, const CBNP2Footer &footer)
+{
+	nlctassert (sizeof(CBNP2Header) == 32);
+	nlctassert (sizeof(CBNP2Entry) == 64);
+	nlctassert (sizeof(CBNP2Footer) == 16);
+
+	// The directory is used as it is read
+	if (footer.DirSize < sizeof(CBNP2Header))
+		return false;
+	uint8 *directory = new uint8[footer.DirSize];
+	if (fread (directory, footer.DirSize, 1, file) != 1)
 	{
-		fclose (handle.File);
-		handle.File = NULL;
-		bnp.AlwaysOpened = false;
+		delete [] directory;
+		return false;
 	}
-	else
+
+	const CBNP2Header *header = (const CBNP2Header*)directory;
+	uint64 expectedSize = sizeof(CBNP2Header) + (uint64)header->NumFiles*sizeof(CBNP2Entry) +
+		(uint64)header->HashSize*sizeof(uint32) + (uint64)header->NumBlocks*sizeof(uint32) + header->NamesSize;
+	if (header->Magic != BNP2Magic || header->Version != BNP2Version || expectedSize != footer.DirSize ||
+		header->HashSize <= header->NumFiles || (header->HashSize & (header->HashSize-1)) != 0 ||
+		header->BlockSize == 0 || header->NamesSize == 0 || directory[footer.DirSize-1] != 0)
 	{
-		bnp.AlwaysOpened = true;
+		nlwarning ("BF: Bad v2 directory in '%s'", bnp.BigFileName.c_str());
+		delete [] directory;
+		return false;
 	}
 
-	nldebug("BigFile : added bnp '%s' to the collection", bigfilenamealone.c_str());
+	const CBNP2Entry *entries = (const CBNP2Entry*)(header+1);
+	const uint32 *hashTable = (const uint32*)(entries+header->NumFiles);
+	const uint32 *blockSizes = hashTable+header->HashSize;
+	char *names = (char*)(blockSizes+header->NumBlocks);
+
+	// Check the hash table, a probe must end on an empty slot
+	bool valid = true;
+	uint32 used = 0;
+	for (uint32 i = 0; i < header->HashSize; ++i)
+	{
+		if (hashTable[i] > header->NumFiles)
+			valid = false;
+		if (hashTable[i] != 0)
+			used++;
+	}
+	valid &= (used == header->NumFiles);
+
+	// Check the entries and place their blocks
+	vector<uint64> blockPositions (header->NumBlocks);
+	vector<CBigFileBlocks> blocks (header->NumFiles);
+	for (uint32 i = 0; valid && (i < header->NumFiles); ++i)
+	{
+		const CBNP2Entry &entry = entries[i];
+		CBigFileBlocks &entryBlocks = blocks[i];
+		entryBlocks.BlockSize = header->BlockSize;
+		entryBlocks.NumBlocks = 0;
+		entryBlocks.Sizes = NULL;
+		entryBlocks.Positions = NULL;
+
+		valid &= (entry.NameOffset < header->NamesSize);
+		if (entry.FirstBlock == NoBlock)
+		{
+			valid &= (entry.Compression == Stored) && (entry.StoredSize == entry.Size);
+			continue;
+		}
+
+		uint64 numBlocks = (entry.Size + header->BlockSize - 1) / header->BlockSize;
+		valid &= (entry.Compression == LZ4Blocks) && (numBlocks != 0) && ((uint64)entry.FirstBlock + numBlocks <= header->NumBlocks);
+		if (!valid)
+			break;
+
+		uint64 pos = entry.Pos;
+		for (uint32 b = 0; b < numBlocks; ++b)
+		{
+			blockPositions[entry.FirstBlock+b] = pos;
+			pos += blockSizes[entry.FirstBlock+b] & ~RawBlockFlag;
+		}
+		valid &= (pos - entry.Pos == entry.StoredSize);
+		entryBlocks.NumBlocks = (uint32)numBlocks;
+		entryBlocks.Sizes = blockSizes + entry.FirstBlock;
+	}
+
+	if (!valid)
+	{
+		nlwarning ("BF: Bad v2 directory in '%s'", bnp.BigFileName.c_str());
+		delete [] directory;
+		return false;
+	}
 
+	bnp.Directory = directory;
+	bnp.Header2 = header;
+	bnp.Entries2 = entries;
+	bnp.HashTable2 = hashTable;
+	bnp.Names2 = names;
+	bnp.BlockPositions2.swap (blockPositions);
+	bnp.Blocks2.swap (blocks);
+	for (uint32 i = 0; i < header->NumFiles; ++i)
+	{
+		if (bnp.Blocks2[i].NumBlocks)
+			bnp.Blocks2[i].Positions = &bnp.BlockPositions2[entries[i].FirstBlock];
+	}
 	return true;
 }
 
+// ***************************************************************************
+uint64 CBigFile::hashFileName (const char *name)
+{
+	// FNV-1a
+	uint64 hash = UINT64_CONSTANT(14695981039346656037);
+	while (*name)
+	{
+		hash ^= (uint8)*(name++);
+		hash *= UINT64_CONSTANT(1099511628211);
+	}
+	return hash;
+}
+
+// ***************************************************************************
+sint CBigFile::findEntry2 (const BNP &bnp, const std::string &lwrFileName)
+{
+	uint64 hash = hashFileName (lwrFileName.c_str());
+	uint32 mask = bnp.Header2->HashSize-1;
+	uint32 slot = (uint32)hash & mask;
+	for(;;)
+	{
+		uint32 index = bnp.HashTable2[slot];
+		if (index == 0)
+			return -1;
+		const CBNP2Entry &entry = bnp.Entries2[index-1];
+		if (entry.NameHash == hash && strcmp (bnp.Names2+entry.NameOffset, lwrFileName.c_str()) == 0)
+			return (sint)(index-1);
+		slot = (slot+1) & mask;
+	}
+}
+
 // ***************************************************************************
 void CBigFile::remove (const std::string &sBigFileName)
 {
@@ -297,6 +428,7 @@ void CBigFile::remove (const std::string &sBigFileName)
 			handle.File= NULL;
 		}
 		delete [] rbnp.FileNames;
+		delete [] rbnp.Directory;
 		_BNPs.erase (it);
 	}
 }
@@ -317,6 +449,12 @@ void CBigFile::list (const std::string &sBigFileName, std::vector<std::string> &
 		return;
 	vAllFiles.clear ();
 	BNP &rbnp = _BNPs.find (lwrFileName)->second;
+	if (rbnp.Directory)
+	{
+		for (uint32 i = 0; i < rbnp.Header2->NumFiles; ++i)
+			vAllFiles.push_back (string(rbnp.Names2+rbnp.Entries2[i].NameOffset));
+		return;
+	}
 	vector<BNPFile>::iterator it = rbnp.Files.begin();
 	while (it != rbnp.Files.end())
 	{
@@ -335,7 +473,7 @@ void CBigFile::removeAll ()
 }
 
 // ***************************************************************************
-bool CBigFile::getFileInternal (const std::string &sFileName, BNP *&zeBnp, BNPFile *&zeBnpFile)
+bool CBigFile::getFileInternal (const std::string &sFileName, BNP *&zeBnp, CFileInfo &zeFileInfo)
 {
 	string zeFileName, zeBigFileName, lwrFileName = toLower(sFileName);
 	string::size_type i, nPos = sFileName.find ('@');
@@ -356,6 +494,21 @@ bool CBigFile::getFileInternal (const std::string &sFileName, BNP *&zeBnp, BNPFi
 	}
 
 	BNP &rbnp = _BNPs.find (zeBigFileName)->second;
+
+	// v2, in the hash directory
+	if (rbnp.Directory)
+	{
+		sint index = findEntry2 (rbnp, zeFileName);
+		if (index < 0)
+			return false;
+
+		zeBnp= &rbnp;
+		zeFileInfo.Pos = rbnp.Entries2[index].Pos;
+		zeFileInfo.Size = rbnp.Entries2[index].Size;
+		zeFileInfo.Blocks = rbnp.Blocks2[index].NumBlocks ? &rbnp.Blocks2[index] : NULL;
+		return true;
+	}
+
 	if (rbnp.Files.size() == 0)
 	{
 		return false;
@@ -383,23 +536,32 @@ bool CBigFile::getFileInternal (const std::string &sFileName, BNP *&zeBnp, BNPFi
 
 	// set ptr on found bnp/bnpFile
 	zeBnp= &rbnp;
-	zeBnpFile= &rbnpfile;
+	zeFileInfo.Pos = rbnpfile.Pos;
+	zeFileInfo.Size = rbnpfile.Size;
+	zeFileInfo.Blocks = NULL;
 
 	return true;
 }
 
 // ***************************************************************************
 FILE* CBigFile::getFile (const std::string &sFileName, uint32 &rFileSize,
-						 uint32 &rBigFileOffset, bool &rCacheFileOnOpen, bool &rAlwaysOpened)
+						 uint64 &rBigFileOffset, bool &rCacheFileOnOpen, bool &rAlwaysOpened, const CBigFileBlocks *&rBlocks)
 {
 	BNP		*bnp= NULL;
-	BNPFile	*bnpFile= NULL;
-	if(!getFileInternal(sFileName, bnp, bnpFile))
+	CFileInfo	fileInfo;
+	if(!getFileInternal(sFileName, bnp, fileInfo))
 	{
 		nlwarning ("BF: Couldn't load '%s'", sFileName.c_str());
 		return NULL;
 	}
-	nlassert(bnp && bnpFile);
+	nlassert(bnp);
+
+	// CIFile sizes are 32 bits
+	if (fileInfo.Size > 0xffffffff)
+	{
+		nlwarning ("BF: '%s' is larger than 4 GB", sFileName.c_str());
+		return NULL;
+	}
 
 	// Get a ThreadSafe handle on the file
 	CHandleFile		&handle= _ThreadFileArray.get(bnp->ThreadFileId);
@@ -415,8 +577,9 @@ FILE* CBigFile::getFile (const std::string &sFileName, uint32 &rFileSize,
 
 	rCacheFileOnOpen = bnp->CacheFileOnOpen;
 	rAlwaysOpened = bnp->AlwaysOpened;
-	rBigFileOffset = bnpFile->Pos;
-	rFileSize = bnpFile->Size;
+	rBigFileOffset = fileInfo.Pos;
+	rFileSize = (uint32)fileInfo.Size;
+	rBlocks = fileInfo.Blocks;
 	return handle.File;
 }
 
@@ -424,17 +587,111 @@ FILE* CBigFile::getFile (const std::string &sFileName, uint32 &rFileSize,
 bool CBigFile::getFileInfo (const std::string &sFileName, uint32 &rFileSize, uint32 &rBigFileOffset)
 {
 	BNP		*bnp= NULL;
-	BNPFile	*bnpFile= NULL;
-	if(!getFileInternal(sFileName, bnp, bnpFile))
+	CFileInfo	fileInfo;
+	if(!getFileInternal(sFileName, bnp, fileInfo))
 	{
 		nlwarning ("BF: Couldn't find '%s' for info", sFileName.c_str());
 		return false;
 	}
-	nlassert(bnp && bnpFile);
+	nlassert(bnp);
+
+	// The file must be read directly in the bnp
+	if (fileInfo.Blocks || fileInfo.Pos + fileInfo.Size > 0xffffffff)
+	{
+		nlwarning ("BF: '%s' is compressed or beyond 4 GB, it can't be read directly", sFileName.c_str());
+		return false;
+	}
 
 	// get infos
-	rBigFileOffset = bnpFile->Pos;
-	rFileSize = bnpFile->Size;
+	rBigFileOffset = (uint32)fileInfo.Pos;
+	rFileSize = (uint32)fileInfo.Size;
+	return true;
+}
+
+// ***************************************************************************
+bool CBigFile::getFileLocation (const std::string &sFileName, std::string &rBigFilePath, uint64 &rBigFileOffset,
+								uint32 &rFileSize, const CBigFileBlocks *&rBlocks)
+{
+	BNP		*bnp= NULL;
+	CFileInfo	fileInfo;
+	if(!getFileInternal(sFileName, bnp, fileInfo))
+	{
+		nlwarning ("BF: Couldn't find '%s'", sFileName.c_str());
+		return false;
+	}
+	nlassert(bnp);
+
+	// File sizes are 32 bits
+	if (fileInfo.Size > 0xffffffff)
+	{
+		nlwarning ("BF: '%s' is larger than 4 GB", sFileName.c_str());
+		return false;
+	}
+
+	rBigFilePath = bnp->BigFileName;
+	rBigFileOffset = fileInfo.Pos;
+	rFileSize = (uint32)fileInfo.Size;
+	rBlocks = fileInfo.Blocks;
+	return true;
+}
+
+// ***************************************************************************
+// Read a whole block in dest
+static bool readBlock (FILE *file, const CBigFileBlocks &blocks, uint32 index, uint32 blockLength, uint8 *dest, vector<uint8> &compressed)
+{
+	uint32 storedSize = blocks.Sizes[index] & ~CBigFile::RawBlockFlag;
+	if (nlfseek64 (file, blocks.Positions[index], SEEK_SET) != 0)
+		return false;
+
+	if (blocks.Sizes[index] & CBigFile::RawBlockFlag)
+		return (storedSize == blockLength) && (fread (dest, blockLength, 1, file) == 1);
+
+	if (storedSize == 0)
+		return false;
+	compressed.resize (storedSize);
+	return (fread (&compressed[0], storedSize, 1, file) == 1) && lz4Decompress (&compressed[0], storedSize, dest, blockLength);
+}
+
+// ***************************************************************************
+bool CBigFile::readBlocks (FILE *file, const CBigFileBlocks &blocks, uint32 fileSize, uint32 pos, uint8 *dest, uint32 len,
+						   std::vector<uint8> &block, uint32 &blockIndex)
+{
+	if ((uint64)pos + len > fileSize)
+		return false;
+
+	vector<uint8> compressed;
+	while (len > 0)
+	{
+		uint32 index = pos / blocks.BlockSize;
+		uint32 offset = pos - index * blocks.BlockSize;
+		uint32 blockLength = std::min (blocks.BlockSize, fileSize - index * blocks.BlockSize);
+		if (index >= blocks.NumBlocks)
+			return false;
+
+		// Whole block, decompress it directly in dest
+		if (offset == 0 && len >= blockLength && index != blockIndex)
+		{
+			if (!readBlock (file, blocks, index, blockLength, dest, compressed))
+				return false;
+		}
+		else
+		{
+			if (index != blockIndex)
+			{
+				blockIndex = NoBlock;
+				block.resize (blockLength);
+				if (!readBlock (file, blocks, index, blockLength, &block[0], compressed))
+					return false;
+				blockIndex = index;
+			}
+			memcpy (dest, &block[offset], std::min (len, blockLength - offset));
+		}
+
+		uint32 n = std::min (len, blockLength - offset);
+		dest += n;
+		pos += n;
+		len -= n;
+	}
 	return true;
 }
 
@@ -445,10 +702,16 @@ char *CBigFile::getFileNamePtr(const std::string &sFileName, const std::string &
 	if (_BNPs.find(bigfilenamealone) != _BNPs.end())
 	{
 		BNP &rbnp = _BNPs.find (bigfilenamealone)->second;
+		string lwrFileName = toLower(sFileName);
+		if (rbnp.Directory)
+		{
+			sint index = findEntry2 (rbnp, lwrFileName);
+			return (index < 0) ? NULL : rbnp.Names2+rbnp.Entries2[index].NameOffset;
+		}
+
 		vector<BNPFile>::iterator itNBPFile;
 		if (rbnp.Files.size() == 0)
 			return NULL;
-		string lwrFileName = toLower(sFileName);
 
 		BNPFile temp_bnp_file;
 		temp_bnp_file.Name = (char*)lwrFileName.c_str();
@@ -813,33 +813,9 @@ int	nlfseek64( FILE *stream, sint64 offset, int origin )
 
 #else // NL_OS_WINDOWS
 
-	// This code doesn't work under windows : fseek() implementation uses a signed 32 bits offset. What ever we do, it can't seek more than 2 Go.
-	// For the moment, i don't know if it works under linux for seek of more than 2 Go.
-
-	nlassert ((offset < SINT64_CONSTANT(2147483647)) && (offset > SINT64_CONSTANT(-2147483648)));
-
-	bool first = true;
-	do
-	{
-		// Get the size of the next fseek
-		sint nextSeek;
-		if (offset > 0)
-			nextSeek = (sint)std::min ((sint64)SINT64_CONSTANT(2147483647), offset);
-		else
-			nextSeek = (sint)std::max ((sint64)-SINT64_CONSTANT(2147483648), offset);
-
-		// Make a seek
-		int result = fseek ( stream, nextSeek, first?origin:SEEK_CUR );
-		if (result != 0)
-			return result;
-
-		// Remaining
-		offset -= nextSeek;
-		first = false;
-	}
-	while (offset);
-
-	return 0;
+	// This code doesn't work under windows : fseek() implementation uses a signed 32 bits offset.
+	// fseeko() uses off_t, which is 64 bits on 64 bits systems and with _FILE_OFFSET_BITS=64.
+	return fseeko (stream, (off_t)offset, origin);
 
 #endif // NL_OS_WINDOWS
 }
@@ -854,8 +830,7 @@ sint64 nlftell64(FILE *stream)
 	}
 	else return -1;
 #else
-	nlerror("Not implemented");
-	return -1;
+	return (sint64)ftello (stream);
 #endif
 }
 
@@ -32,8 +32,18 @@
 #include "nel/misc/path.h"
 #include "nel/misc/i18n.h"
 #include "nel/misc/mem_stream.h"
+#include "nel/misc/sha1.h"
 #include "locale.h"
 
+#if defined(NL_OS_UNIX) && defined(__linux__)
+#	define NL_CONFIG_FILE_INOTIFY
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#	include <fcntl.h>
+#	include <set>
+#	include <map>
+#endif
+
 using namespace std;
 using namespace NLMISC;
 
@@ -367,6 +377,122 @@ uint32 CConfigFile::getVarCount()
 }
 
 
+// ***************************************************************************
+
+// Read a config file, preprocessed and in UTF-8
+static string readConfigFile (const string &fileName, ucstring &content)
+{
+	CI18N::readTextFile(fileName, content, true, true, true);
+	return content.toUtf8();
+}
+
+// A parse result, for the files with the same content
+struct CParsedConfigFile
+{
+	vector<string>					FileNames;
+	vector<CHashKey>				FileHashes;
+	vector<CConfigFile::CVar>		Vars;
+};
+typedef map<string, CParsedConfigFile>	TParsedConfigFiles;
+static TParsedConfigFiles	ParsedConfigFiles;
+
+// Return true if two variables have the same value
+static bool sameValue (const CConfigFile::CVar &a, const CConfigFile::CVar &b)
+{
+	if (a.Type != b.Type || a.Comp != b.Comp)
+		return false;
+	switch (a.Type)
+	{
+	case CConfigFile::CVar::T_INT: return a.IntValues == b.IntValues;
+	case CConfigFile::CVar::T_REAL: return a.RealValues == b.RealValues;
+	case CConfigFile::CVar::T_STRING: return a.StrValues == b.StrValues;
+	default: return true;
+	}
+}
+
+#ifdef NL_CONFIG_FILE_INOTIFY
+
+// The directories of the config files are watched, the editors often replace the files
+static int						NotifyFd = -1;
+static bool						NotifyInitialized = false;
+static map<int, string>			NotifyWatches;
+static set<string>				NotifyDirectories;
+
+// Watch the directory of a file, return false if the file can't be watched
+static bool watchConfigFile (const string &fileName)
+{
+	if (fileName.find('@') != string::npos)
+		return false;
+
+	if (!NotifyInitialized)
+	{
+		NotifyInitialized = true;
+		NotifyFd = inotify_init ();
+		if (NotifyFd != -1)
+			fcntl (NotifyFd, F_SETFL, fcntl (NotifyFd, F_GETFL) | O_NONBLOCK);
+		else
+			nlwarning ("CF: Can't initialize inotify, the config files will be polled");
+	}
+	if (NotifyFd == -1)
+		return false;
+
+	string directory = CFile::getPath (fileName);
+	if (NotifyDirectories.find (directory) != NotifyDirectories.end ())
+		return true;
+
+	int wd = inotify_add_watch (NotifyFd, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+	if (wd == -1)
+	{
+		nlwarning ("CF: Can't watch the directory of '%s', it will be polled", fileName.c_str());
+		return false;
+	}
+	NotifyWatches[wd] = directory;
+	NotifyDirectories.insert (directory);
+	return true;
+}
+
+// Return true if the changes of a file are notified
+static bool isConfigFileWatched (const string &fileName)
+{
+	return fileName.find('@') == string::npos && NotifyDirectories.find (CFile::getPath (fileName)) != NotifyDirectories.end ();
+}
+
+// Read the pending notifications. Return true if all the files must be checked.
+static bool readConfigFileChanges (set<string> &modifiedFiles)
+{
+	if (NotifyFd == -1)
+		return false;
+
+	bool overflow = false;
+	char buffer[4096];
+	for(;;)
+	{
+		ssize_t size = read (NotifyFd, buffer, sizeof(buffer));
+		if (size <= 0)
+			break;
+		for (ssize_t pos = 0; pos < size; )
+		{
+			const inotify_event *event = (const inotify_event *)(buffer + pos);
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				overflow = true;
+			}
+			else if (event->len != 0)
+			{
+				map<int, string>::const_iterator it = NotifyWatches.find (event->wd);
+				if (it != NotifyWatches.end ())
+					modifiedFiles.insert (it->second + event->name);
+			}
+			pos += sizeof(inotify_event) + event->len;
+		}
+	}
+	return overflow;
+}
+
+#endif // NL_CONFIG_FILE_INOTIFY
+
+// ***************************************************************************
+
 void CConfigFile::reparse (bool lookupPaths)
 {
 	if (FileNames.empty())
@@ -379,8 +505,11 @@ void CConfigFile::reparse (bool lookupPaths)
 
 	FileNames.clear ();
 	LastModified.clear ();
+	FileHashes.clear ();
 
-//	clearVars ();
+	// the files are parsed in new variables, the current ones are updated after
+	vector<CVar> vars;
+	bool cached = false;
 
 	while (!fn.empty())
 	{
@@ -395,12 +524,51 @@ void CConfigFile::reparse (bool lookupPaths)
 		nldebug ("CF: Adding config file '%s' in the config file", fn.c_str());
 		FileNames.push_back (fn);
 		LastModified.push_back (CFile::getFileModificationDate(fn));
+#ifdef NL_CONFIG_FILE_INOTIFY
+		watchConfigFile (fn);
+#endif
 
 		if (!CPath::lookup(fn, false).empty())
 		{
 			ucstring content;
-			CI18N::readTextFile(fn, content, true, true, true);
-			string utf8 = content.toUtf8();
+			string utf8 = readConfigFile (fn, content);
+			FileHashes.push_back (getSHA1((const uint8*)utf8.data(), (uint32)utf8.size()));
+
+			// same files as a previous parse?
+			if (FileNames.size() == 1)
+			{
+				TParsedConfigFiles::const_iterator it = ParsedConfigFiles.find (fn);
+				if (it != ParsedConfigFiles.end() && it->second.FileHashes[0] == FileHashes[0])
+				{
+					const CParsedConfigFile &parsed = it->second;
+					uint i;
+					for (i = 1; i < parsed.FileNames.size(); ++i)
+					{
+						if (!CFile::fileExists (parsed.FileNames[i]))
+							break;
+						ucstring rootContent;
+						string rootUtf8 = readConfigFile (parsed.FileNames[i], rootContent);
+						if (!(getSHA1((const uint8*)rootUtf8.data(), (uint32)rootUtf8.size()) == parsed.FileHashes[i]))
+							break;
+					}
+					if (i == parsed.FileNames.size())
+					{
+						nldebug ("CF: '%s' and its root config files are not modified since the last parse", fn.c_str());
+						for (i = 1; i < parsed.FileNames.size(); ++i)
+						{
+							FileNames.push_back (parsed.FileNames[i]);
+							LastModified.push_back (CFile::getFileModificationDate(parsed.FileNames[i]));
+#ifdef NL_CONFIG_FILE_INOTIFY
+							watchConfigFile (parsed.FileNames[i]);
+#endif
+						}
+						FileHashes = parsed.FileHashes;
+						vars = parsed.Vars;
+						cached = true;
+						break;
+					}
+				}
+			}
 
 			CMemStream stream;
 			stream.serialBuffer((uint8*)(utf8.data()), utf8.size());
@@ -416,7 +584,7 @@ void CConfigFile::reparse (bool lookupPaths)
 			cf_Ignore = false;
 			cf_OverwriteExistingVariable = (FileNames.size()==1);
 			LoadRoot = (FileNames.size()>1);
-			bool parsingOK = (cfparse (&(_Vars)) == 0);
+			bool parsingOK = (cfparse (&vars) == 0);
 //			cf_ifile.close();
 			if (!parsingOK)
 			{
@@ -437,9 +605,9 @@ void CConfigFile::reparse (bool lookupPaths)
 				free(cf_CurrentFile);
 
 			// reset all 'FromLocalFile' flag on created vars before reading next root cfg
-			for (uint i=0; i<_Vars.size(); ++i)
+			for (uint i=0; i<vars.size(); ++i)
 			{
-				_Vars[i].FromLocalFile = false;
+				vars[i].FromLocalFile = false;
 			}
 		}
 		else
@@ -451,7 +619,15 @@ void CConfigFile::reparse (bool lookupPaths)
 		cf_ifile.clear();
 
 		// If we find a linked config file, load it but don't overload already existing variable
-		CVar *var = getVarPtr ("RootConfigFilename");
+		CVar *var = NULL;
+		for (uint i=0; i<vars.size(); ++i)
+		{
+			if (vars[i].Name == "RootConfigFilename")
+			{
+				var = &vars[i];
+				break;
+			}
+		}
 		if (var)
 		{
 			string RootConfigFilename = var->asString();
@@ -477,71 +653,73 @@ void CConfigFile::reparse (bool lookupPaths)
 			fn.clear ();
 	}
 
-	if (_Callback != NULL)
-		_Callback();
-
-/*	if (filename == NULL)
+	if (!cached)
 	{
-		_LastModified = getLastModified ();
+		CParsedConfigFile &parsed = ParsedConfigFiles[FileNames[0]];
+		parsed.FileNames = FileNames;
+		parsed.FileHashes = FileHashes;
+		parsed.Vars = vars;
+	}
 
-		nlassert (!_FileName.empty());
+	updateVars (vars);
 
-		if (cf_ifile.open (_FileName[0]))
-		{
-			// if we clear all the array, we'll lost the callback on variable and all information
-			//		_Vars.clear();
-			cfrestart (NULL);
-			cf_CurrentLine = 1;
-			cf_Ignore = false;
-			cf_OverwriteExistingVariable = true;
-			LoadRoot = false;
-			bool parsingOK = (cfparse (&(_Vars)) == 0);
-			cf_ifile.close();
-			if (!parsingOK)
-			{
-				nlwarning ("Parsing error in file %s line %d", _FileName.c_str(), cf_CurrentLine);
-				throw EParseError (_FileName, cf_CurrentLine);
-			}
-		}
-		else
-		{
-			nlwarning ("ConfigFile '%s' not found in the path '%s'", _FileName.c_str(), CPath::getCurrentPath().c_str());
-			throw EFileNotFound (_FileName);
-		}
-	}
-	else
-	{
-		nlassert (strlen(filename)>0);
+	if (_Callback != NULL)
+		_Callback();
+}
 
-		// load external config filename, don't overwrite existing variable
-		if (cf_ifile.open (filename))
+void CConfigFile::updateVars (vector<CVar> &vars)
+{
+	vector<uint> modified;
+	for (uint i=0; i<vars.size(); ++i)
+	{
+		CVar &var = vars[i];
+		var.Callback = NULL;
+		sint index = findVar (var.Name);
+		if (index == -1)
 		{
-			cfrestart (NULL);
-			cf_CurrentLine = 1;
-			cf_Ignore = false;
-			cf_OverwriteExistingVariable = false;
-			LoadRoot = true;
-			bool parsingOK = (cfparse (&(_Vars)) == 0);
-			cf_ifile.close ();
-			if (!parsingOK)
-			{
-				nlwarning ("Parsing error in file %s line %d", filename, cf_CurrentLine);
-				throw EParseError (filename, cf_CurrentLine);
-			}
+			addVar (var);
 		}
 		else
 		{
-			nlwarning ("RootConfigFilename '%s' not found", _FileName.c_str());
+			// the variables are updated in place, they can be referenced
+			CVar &current = _Vars[index];
+			var.Callback = current.Callback;
+			if (!sameValue (current, var) && var.Callback != NULL)
+				modified.push_back (index);
+			current = var;
 		}
 	}
 
-	if (callingCallback)
+	// call the callbacks once all the variables are up to date, a callback can read the other variables
+	for (uint i=0; i<modified.size(); ++i)
 	{
-		if (_Callback != NULL)
-			_Callback();
+		CVar &var = _Vars[modified[i]];
+		if (var.Callback != NULL)
+			var.Callback (var);
 	}
-*/
+}
 
+bool CConfigFile::isFileModified (uint fileIndex) const
+{
+	if (fileIndex >= FileHashes.size())
+		return true;
+	if (!CFile::fileExists (FileNames[fileIndex]))
+		return true;
+	ucstring content;
+	string utf8 = readConfigFile (FileNames[fileIndex], content);
+	return !(getSHA1((const uint8*)utf8.data(), (uint32)utf8.size()) == FileHashes[fileIndex]);
+}
+
+sint CConfigFile::findVar (const std::string &varName) const
+{
+	TVarIndex::const_iterator it = _VarIndex.find (varName);
+	return it == _VarIndex.end() ? -1 : (sint)it->second;
+}
+
+void CConfigFile::addVar (const CVar &var)
+{
+	_VarIndex[var.Name] = (uint)_Vars.size();
+	_Vars.push_back (var);
 }
 
 
@@ -558,13 +736,12 @@ CConfigFile::CVar &CConfigFile::getVar (const std::string &varName)
 
 CConfigFile::CVar *CConfigFile::getVarPtr (const std::string &varName)
 {
+	sint index = findVar (varName);
+	// the type could be T_UNKNOWN if we add a callback on this name but this var is not in the config file
+	if (index != -1 && (_Vars[index].Type != CVar::T_UNKNOWN || _Vars[index].Comp))
+		return &(_Vars[index]);
+
 	uint i;
-	for (i = 0; i < _Vars.size(); i++)
-	{
-		// the type could be T_UNKNOWN if we add a callback on this name but this var is not in the config file
-		if (_Vars[i].Name == varName && (_Vars[i].Type != CVar::T_UNKNOWN || _Vars[i].Comp))
-			return &(_Vars[i]);
-	}
 
 	// if not found, add it in the array if necessary
 	for (i = 0; i < UnknownVariables.size(); i++)
@@ -578,15 +755,9 @@ CConfigFile::CVar *CConfigFile::getVarPtr (const std::string &varName)
 
 bool CConfigFile::exists (const std::string &varName)
 {
-	for (uint i = 0; i < _Vars.size(); i++)
-	{
-		// the type could be T_UNKNOWN if we add a callback on this name but this var is not in the config file
-		if (_Vars[i].Name == varName && (_Vars[i].Type != CVar::T_UNKNOWN || _Vars[i].Comp))
-		{
-			return true;
-		}
-	}
-	return false;
+	sint index = findVar (varName);
+	// the type could be T_UNKNOWN if we add a callback on this name but this var is not in the config file
+	return index != -1 && (_Vars[index].Type != CVar::T_UNKNOWN || _Vars[index].Comp);
 }
 
 void CConfigFile::save () const
@@ -781,14 +952,12 @@ void CConfigFile::setCallback (void (*cb)())
 
 void CConfigFile::setCallback (const string &VarName, void (*cb)(CConfigFile::CVar &var))
 {
-	for (vector<CVar>::iterator it = _Vars.begin (); it != _Vars.end (); it++)
+	sint index = findVar (VarName);
+	if (index != -1)
 	{
-		if (VarName == (*it).Name)
-		{
-			(*it).Callback = cb;
-			//nldebug("CF: Setting callback to reload the variable '%s' in the file '%s' when modified externally", VarName.c_str(), getFilename().c_str());
-			return;
-		}
+		_Vars[index].Callback = cb;
+		//nldebug("CF: Setting callback to reload the variable '%s' in the file '%s' when modified externally", VarName.c_str(), getFilename().c_str());
+		return;
 	}
 	// VarName doesn't exist, add it now for the future
 	CVar Var;
@@ -796,7 +965,7 @@ void CConfigFile::setCallback (const string &VarName, void (*cb)(CConfigFile::CV
 	Var.Callback = cb;
 	Var.Type = CVar::T_UNKNOWN;
 	Var.Comp = false;
-	_Vars.push_back (Var);
+	addVar (Var);
 	//nldebug("CF: Setting callback to reload the variable '%s' in the file '%s' when modified externally (currently unknown)", VarName.c_str(), getFilename().c_str());
 }
 
@@ -816,6 +985,11 @@ void CConfigFile::checkConfigFiles ()
 
 	LastCheckTime = time (NULL);
 
+#ifdef NL_CONFIG_FILE_INOTIFY
+	set<string> notifiedFiles;
+	bool checkAll = readConfigFileChanges (notifiedFiles);
+#endif
+
 	bool needReparse;
 	for (vector<CConfigFile *>::iterator it = (*_ConfigFiles).begin (); it != (*_ConfigFiles).end (); it++)
 	{
@@ -823,10 +997,29 @@ void CConfigFile::checkConfigFiles ()
 		nlassert ((*it)->FileNames.size() == (*it)->LastModified.size());
 		for (uint i = 0; i < (*it)->FileNames.size(); i++)
 		{
-			if ((*it)->LastModified[i] != CFile::getFileModificationDate((*it)->FileNames[i]))
+			const string &fileName = (*it)->FileNames[i];
+			uint32 date = 0;
+			bool changed;
+#ifdef NL_CONFIG_FILE_INOTIFY
+			if (isConfigFileWatched (fileName))
+			{
+				// a notified file is checked even if its date didn't change, the dates are in seconds
+				changed = checkAll || notifiedFiles.find (fileName) != notifiedFiles.end ();
+				if (changed)
+					date = CFile::getFileModificationDate(fileName);
+			}
+			else
+#endif
 			{
-				needReparse = true;
-				(*it)->LastModified[i] = CFile::getFileModificationDate((*it)->FileNames[i]);
+				date = CFile::getFileModificationDate(fileName);
+				changed = (*it)->LastModified[i] != date;
+			}
+			if (changed)
+			{
+				(*it)->LastModified[i] = date;
+				// don't parse again a file saved without modification
+				if ((*it)->isFileModified (i))
+					needReparse = true;
 			}
 		}
 		if (needReparse)
@@ -851,11 +1044,12 @@ void CConfigFile::setTimeout (uint32 timeout)
 void CConfigFile::clear()
 {
 	_Vars.clear ();
+	_VarIndex.clear ();
 }
 
 void CConfigFile::clearVars ()
 {
-	for (vector<CVar>::iterator it = _Vars.begin (); it != _Vars.end (); it++)
+	for (deque<CVar>::iterator it = _Vars.begin (); it != _Vars.end (); it++)
 	{
 		(*it).Type = CVar::T_UNKNOWN;
 	}
@@ -877,8 +1071,20 @@ CConfigFile::CVar *CConfigFile::insertVar (const std::string &varName, const CVa
 	CVar *var = getVarPtr (varName);
 	if (!var)
 	{
-		_Vars.push_back (varToCopy);
-		var = &(_Vars.back ());
+		sint index = findVar (varName);
+		if (index != -1)
+		{
+			// a variable with only a callback, keep the callback
+			void (*callback)(CVar &var) = _Vars[index].Callback;
+			_Vars[index] = varToCopy;
+			_Vars[index].Callback = callback;
+			var = &(_Vars[index]);
+		}
+		else
+		{
+			addVar (varToCopy);
+			var = &(_Vars.back ());
+		}
 		var->Root = false;
 		var->Name = varName;
 	}
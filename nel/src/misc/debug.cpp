@@ -979,6 +979,9 @@ void force_exception_frame(...) {std::cout.flush();}
 
 static void exceptionTranslator(unsigned, EXCEPTION_POINTERS *pexp)
 {
+	// the asynchronous log lines would be lost
+	CLog::flushAsync (true);
+
 #ifndef NL_NO_DEBUG_FILES
 	FILE *file = fopen ("exception_catched", "wb");
 	fclose (file);
@@ -1133,6 +1136,9 @@ void changeLogDirectory(const std::string &dir)
 // or there will be various issues when static destructors call nldebug etc...
 void destroyDebug()
 {
+	// the writer must not use the displayers and the logs anymore
+	CLog::stopAsyncWriter();
+
 	delete sd; sd = NULL;
 	delete DefaultMsgBoxDisplayer; DefaultMsgBoxDisplayer = NULL;
 	delete fd; fd = NULL;
@@ -142,6 +142,23 @@ void IDisplayer::display ( const CLog::TDisplayInfo& args, const char *message )
 	_Mutex->leave();
 }
 
+/*
+ * Flush the output buffered by the displayer
+ */
+void IDisplayer::flush ()
+{
+	_Mutex->enter();
+	try
+	{
+		doFlush();
+	}
+	catch (Exception &)
+	{
+		// silence
+	}
+	_Mutex->leave();
+}
+
 
 // Log format : "<LogType> <ThreadNo> <FileName> <Line> <ProcessName> : <Msg>"
 void CStdDisplayer::doDisplay ( const CLog::TDisplayInfo& args, const char *message )
@@ -238,7 +255,9 @@ void CStdDisplayer::doDisplay ( const CLog::TDisplayInfo& args, const char *mess
 		if (!args.CallstackAndLog.empty())
 			printf (args.CallstackAndLog.c_str());
 
-		fflush(stdout);
+		// the asynchronous log writer flushes once per batch
+		if (!args.Deferred)
+			fflush(stdout);
 	}
 
 #ifdef NL_OS_WINDOWS
@@ -340,6 +359,11 @@ void CStdDisplayer::doDisplay ( const CLog::TDisplayInfo& args, const char *mess
 #endif
 }
 
+void CStdDisplayer::doFlush ()
+{
+	fflush(stdout);
+}
+
 CFileDisplayer::CFileDisplayer (const std::string &filename, bool eraseLastLog, const char *displayerName, bool raw) :
 	IDisplayer (displayerName), _NeedHeader(true), _LastLogSizeChecked(0), _Raw(raw)
 {
@@ -508,10 +532,18 @@ void CFileDisplayer::doDisplay ( const CLog::TDisplayInfo& args, const char *mes
 		if(!args.CallstackAndLog.empty())
 			fwrite (args.CallstackAndLog.c_str(), args.CallstackAndLog.size (), 1, _FilePointer);
 
-		fflush (_FilePointer);
+		// the asynchronous log writer flushes once per batch
+		if (!args.Deferred)
+			fflush (_FilePointer);
 	}
 }
 
+void CFileDisplayer::doFlush ()
+{
+	if (_FilePointer > (FILE*)1)
+		fflush (_FilePointer);
+}
+
 // Log format in clipboard: "2000/01/15 12:05:30 <LogType> <ProcessName> <FileName> <Line>: <Msg>"
 // Log format on the screen: in debug   "<ProcessName> <FileName> <Line>: <Msg>"
 //                           in release "<Msg>"
@@ -360,7 +360,7 @@ void CEntityIdTranslator::unregisterEntity (const CEntityId &eid)
 
 	nldebug ("EIT: Unregister EId %s EntityName '%s' UId %d UserName '%s'", reid.toString().c_str(), entity.EntityName.toString().c_str(), entity.UId, entity.UserName.c_str());
 	NameIndex.erase(toLower(entity.EntityName));
-	RegisteredEntities.erase (reid);
+	RegisteredEntities.erase (it);
 }
 
 bool CEntityIdTranslator::isEntityRegistered(const CEntityId &eid)
@@ -385,7 +385,7 @@ void CEntityIdTranslator::checkEntity (const CEntityId &eid, const ucstring &ent
 	reid.setCreatorId(0);
 	reid.setDynamicId(0);
 
-	map<CEntityId, CEntityIdTranslator::CEntity>::iterator it = RegisteredEntities.find (reid);
+	TEntityCont::iterator it = RegisteredEntities.find (reid);
 
 	nlinfo ("EIT: Checking EId %s EntityName '%s' UId %d UserName '%s'", reid.toString().c_str(), entityName.toString().c_str(), uid, userName.c_str());
 
@@ -814,9 +814,9 @@ NLMISC_CATEGORISED_COMMAND(nel,playerInfo,"Get informations about a player or al
 {
 	if (args.size () == 0)
 	{
-		const map<CEntityId, CEntityIdTranslator::CEntity>	&res = CEntityIdTranslator::getInstance()->getRegisteredEntities ();
+		const CEntityIdTranslator::TEntityCont	&res = CEntityIdTranslator::getInstance()->getRegisteredEntities ();
 		log.displayNL("%d result(s) for 'all players informations'", res.size());
-		for (map<CEntityId, CEntityIdTranslator::CEntity>::const_iterator it = res.begin(); it != res.end(); it++)
+		for (CEntityIdTranslator::TEntityCont::const_iterator it = res.begin(); it != res.end(); it++)
 		{
 			const CEntityIdTranslator::CEntity &entity = it->second;
 			log.displayNL("UId %d UserName '%s' EId %s EntityName '%s' EntitySlot %hd %s", entity.UId, entity.UserName.c_str(), it->first.toString().c_str(), entity.EntityName.toString().c_str(), (sint16)(entity.EntitySlot), (entity.Online?"Online":"Offline"));
@@ -28,6 +28,7 @@
 #include "nel/misc/file.h"
 #include "nel/misc/debug.h"
 #include "nel/misc/big_file.h"
+#include "nel/misc/batch_file_reader.h"
 #include "nel/misc/path.h"
 #include "nel/misc/command.h"
 #include "nel/misc/sstring.h"
@@ -49,7 +50,6 @@ static bool IFileAccessLoggingEnabled= false;
 static uint64 IFileAccessLogStartTime= 0;
 
 uint32 CIFile::_NbBytesSerialized = 0;
-uint32 CIFile::_NbBytesLoaded = 0;
 uint32 CIFile::_ReadFromFile = 0;
 uint32 CIFile::_ReadingFromFile = 0;
 uint32 CIFile::_FileOpened = 0;
@@ -64,6 +64,8 @@ CIFile::CIFile() : IStream(true)
 	_ReadPos = 0;
 	_FileSize = 0;
 	_BigFileOffset = 0;
+	_BigFileBlocks = NULL;
+	_BigFileBlockIndex = CBigFile::NoBlock;
 	_IsInBigFile = false;
 	_IsInXMLPackFile = false;
 	_CacheFileOnOpen = false;
@@ -79,6 +81,8 @@ CIFile::CIFile(const std::string &path, bool text) : IStream(true)
 	_ReadPos = 0;
 	_FileSize = 0;
 	_BigFileOffset = 0;
+	_BigFileBlocks = NULL;
+	_BigFileBlockIndex = CBigFile::NoBlock;
 	_IsInBigFile = false;
 	_IsInXMLPackFile = false;
 	_CacheFileOnOpen = false;
@@ -98,10 +102,19 @@ CIFile::~CIFile()
 void		CIFile::loadIntoCache()
 {
 	const uint32 READPACKETSIZE = 64 * 1024;
-	const uint32 INTERPACKETSLEEP = 5;
 
 	_Cache = new uint8[_FileSize];
-	if(!_IsAsyncLoading)
+	if (_BigFileBlocks)
+	{
+		// Compressed in a bnp, the blocks are decompressed in the cache
+		_ReadingFromFile += _FileSize;
+		if (!CBigFile::readBlocks (_F, *_BigFileBlocks, _FileSize, 0, _Cache, _FileSize, _BigFileBlock, _BigFileBlockIndex))
+			nlwarning ("FILE: Can't read the compressed file '%s'", _FileName.c_str());
+		_FileRead++;
+		_ReadingFromFile -= _FileSize;
+		_ReadFromFile += _FileSize;
+	}
+	else if(!_IsAsyncLoading)
 	{
 		_ReadingFromFile += _FileSize;
 		int read = fread (_Cache, _FileSize, 1, _F);
@@ -111,34 +124,18 @@ void		CIFile::loadIntoCache()
 	}
 	else
 	{
+		// Read by packets in the bandwidth budget of the async loading, and in the one shared with the async file manager
 		uint	index= 0;
 		while(index<_FileSize)
 		{
-			if( _NbBytesLoaded + (_FileSize-index) > READPACKETSIZE )
-			{
-				sint	n= READPACKETSIZE-_NbBytesLoaded;
-				n= max(n, 1);
-				_ReadingFromFile += n;
-				int read = fread (_Cache+index, n, 1, _F);
-				_FileRead++;
-				_ReadingFromFile -= n;
-				_ReadFromFile += read * n;
-				index+= n;
-
-				nlSleep (INTERPACKETSLEEP);
-				_NbBytesLoaded= 0;
-			}
-			else
-			{
-				uint	n= _FileSize-index;
-				_ReadingFromFile += n;
-				int read = fread (_Cache+index, n, 1, _F);
-				_FileRead++;
-				_ReadingFromFile -= n;
-				_ReadFromFile += read * n;
-				_NbBytesLoaded+= n;
-				index+= n;
-			}
+			uint	n= min(READPACKETSIZE, _FileSize-index);
+			CBatchFileReader::consumeCacheLoadBandwidth (n);
+			_ReadingFromFile += n;
+			int read = fread (_Cache+index, n, 1, _F);
+			_FileRead++;
+			_ReadingFromFile -= n;
+			_ReadFromFile += read * n;
+			index+= n;
 		}
 	}
 }
@@ -194,15 +191,17 @@ bool		CIFile::open(const std::string &path, bool text)
 			// xml pack file
 			_IsInXMLPackFile = true;
 
+			uint32	offset = 0;
 			if(_AllowBNPCacheFileOnOpen)
 			{
-				_F = CXMLPack::getInstance().getFile(path, _FileSize, _BigFileOffset, _CacheFileOnOpen, _AlwaysOpened);
+				_F = CXMLPack::getInstance().getFile(path, _FileSize, offset, _CacheFileOnOpen, _AlwaysOpened);
 			}
 			else
 			{
 				bool	dummy;
-				_F = CXMLPack::getInstance().getFile (path, _FileSize, _BigFileOffset, dummy, _AlwaysOpened);
+				_F = CXMLPack::getInstance().getFile (path, _FileSize, offset, dummy, _AlwaysOpened);
 			}
+			_BigFileOffset = offset;
 		}
 		else
 		{
@@ -210,12 +209,12 @@ bool		CIFile::open(const std::string &path, bool text)
 			_IsInBigFile = true;
 			if(_AllowBNPCacheFileOnOpen)
 			{
-				_F = CBigFile::getInstance().getFile (path, _FileSize, _BigFileOffset, _CacheFileOnOpen, _AlwaysOpened);
+				_F = CBigFile::getInstance().getFile (path, _FileSize, _BigFileOffset, _CacheFileOnOpen, _AlwaysOpened, _BigFileBlocks);
 			}
 			else
 			{
 				bool	dummy;
-				_F = CBigFile::getInstance().getFile (path, _FileSize, _BigFileOffset, dummy, _AlwaysOpened);
+				_F = CBigFile::getInstance().getFile (path, _FileSize, _BigFileOffset, dummy, _AlwaysOpened, _BigFileBlocks);
 			}
 		}
 		if(_F != NULL)
@@ -334,6 +333,9 @@ void		CIFile::close()
 		}
 	}
 	nlassert(_Cache == NULL);
+	_BigFileBlocks = NULL;
+	contReset (_BigFileBlock);
+	_BigFileBlockIndex = CBigFile::NoBlock;
 	resetPtrTable();
 }
 
@@ -430,6 +432,18 @@ void		CIFile::serialBuffer(uint8 *buf, uint len) throw(EReadError)
 		memcpy (buf, _Cache + _ReadPos, len);
 		_ReadPos += len;
 	}
+	else if (_BigFileBlocks)
+	{
+		// Compressed in a bnp, only the blocks read are decompressed
+		_ReadingFromFile += len;
+		bool ok = CBigFile::readBlocks (_F, *_BigFileBlocks, _FileSize, _ReadPos, buf, len, _BigFileBlock, _BigFileBlockIndex);
+		_FileRead++;
+		_ReadingFromFile -= len;
+		_ReadFromFile += len;
+		if (!ok)
+			throw EReadError(_FileName);
+		_ReadPos += len;
+	}
 	else
 	{
 		int read;
@@ -476,7 +490,7 @@ bool		CIFile::seek (sint32 offset, IStream::TSeekOrigin origin) const throw(EStr
 			nlstop;
 	}
 
-	if (_CacheFileOnOpen)
+	if (_CacheFileOnOpen || _BigFileBlocks)
 		return true;
 
 	// seek in the file. NB: if not in bigfile, _BigFileOffset==0.
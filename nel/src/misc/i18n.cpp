@@ -51,15 +51,43 @@ void CI18N::load (const string &languageCode, const string &fallbackLanguageCode
 	if (_StrMapLoaded)	_StrMap.clear ();
 	else				_StrMapLoaded = true;
 	_SelectedLanguageCode = languageCode;
-	loadFileIntoMap(languageCode + ".uxt", _StrMap);
+	loadLanguage(languageCode, _StrMap);
 
 	_StrMapFallback.clear();
 	if(!fallbackLanguageCode.empty())
 	{
-		loadFileIntoMap(fallbackLanguageCode + ".uxt", _StrMapFallback);
+		loadLanguage(fallbackLanguageCode, _StrMapFallback);
 	}
 }
 
+bool CI18N::loadLanguage(const string &languageCode, StrMapContainer &dest)
+{
+	// the proxy works on the text, the compiled file is not used with it
+	if (!_LoadProxy)
+	{
+		string compiled = CPath::lookup(languageCode + ".uxb", false, false);
+		// a file in a bnp can't be mapped
+		if (!compiled.empty() && compiled.find('@') == string::npos)
+		{
+			string source = CPath::lookup(languageCode + ".uxt", false, false);
+			if (!source.empty() && source.find('@') == string::npos && CFile::getFileModificationDate(source) > CFile::getFileModificationDate(compiled))
+			{
+				nlwarning("I18N: %s is older than %s, it is not used", compiled.c_str(), source.c_str());
+			}
+			else if (dest.map(compiled))
+			{
+				return true;
+			}
+			else
+			{
+				nlwarning("I18N: %s is not a valid compiled language file", compiled.c_str());
+			}
+		}
+	}
+
+	return loadFileIntoMap(languageCode + ".uxt", dest);
+}
+
 bool CI18N::loadFileIntoMap(const string &fileName, StrMapContainer &destMap)
 {
 	ucstring text;
@@ -74,38 +102,49 @@ bool CI18N::loadFileIntoMap(const string &fileName, StrMapContainer &destMap)
 
 	ucstring::const_iterator first(text.begin()), last(text.end());
 	string lastReadLabel("nothing");
+	bool ok = true;
 
+	destMap.clear();
+	string label;
+	ucstring ucs;
 	while (first != last)
 	{
 		skipWhiteSpace(first, last);
-		string label;
-		ucstring ucs;
+		label.clear();
+		ucs.clear();
 		if (!parseLabel(first, last, label))
 		{
 			nlwarning("I18N: Error reading label field in %s. Stop reading after %s.", fileName.c_str(), lastReadLabel.c_str());
-			return false;
+			ok = false;
+			break;
 		}
 		lastReadLabel = label;
 		skipWhiteSpace(first, last);
 		if (!parseMarkedString('[', ']', first, last, ucs))
 		{
 			nlwarning("I18N: Error reading text for label %s in %s. Stop reading.", label.c_str(), fileName.c_str());
-			return false;
+			ok = false;
+			break;
 		}
 
 		// ok, a line read.
-		pair<map<string, ucstring>::iterator, bool> ret;
-		ret = destMap.insert(make_pair(label, ucs));
-		if (!ret.second)
-		{
-			nlwarning("I18N: Error in %s, the label %s exists twice !", fileName.c_str(), label.c_str());
-		}
+		destMap.add(label, ucs.data(), (uint)ucs.size());
 		skipWhiteSpace(first, last);
 	}
 
+	// the first text of a label is kept
+	vector<string> duplicates;
+	destMap.buildIndex(false, &duplicates);
+	for (uint i=0; i<duplicates.size(); ++i)
+	{
+		nlwarning("I18N: Error in %s, the label %s exists twice !", fileName.c_str(), duplicates[i].c_str());
+	}
+
+	if (!ok)
+		return false;
+
 	// a little check to ensure that the lang name has been set.
-	StrMapContainer::iterator it(destMap.find("LanguageName"));
-	if (it == destMap.end())
+	if (destMap.find("LanguageName") < 0)
 	{
 		nlwarning("I18N: In file %s, missing LanguageName translation (should be first in file)", fileName.c_str());
 	}
@@ -119,20 +158,29 @@ void CI18N::loadFromFilename(const string &filename, bool reload)
 	{
 		return;
 	}
-	// merge with existing map
-	for(StrMapContainer::iterator it = destMap.begin(); it != destMap.end(); ++it)
+	// merge with existing map, the new texts replace the old ones
+	for (uint i=0; i<destMap.size(); ++i)
 	{
-		if (!reload)
-		{
-			if (_StrMap.count(it->first))
-			{
-				nlwarning("I18N: Error in %s, the label %s exist twice !", filename.c_str(), it->first.c_str());
-			}
-		}
-		_StrMap[it->first] = it->second;
+		uint size;
+		const ucchar *text = destMap.getText(i, size);
+		_StrMap.add(destMap.getLabel(i), text, size);
+	}
+	vector<string> duplicates;
+	_StrMap.buildIndex(true, reload ? NULL : &duplicates);
+	for (uint i=0; i<duplicates.size(); ++i)
+	{
+		nlwarning("I18N: Error in %s, the label %s exist twice !", filename.c_str(), duplicates[i].c_str());
 	}
 }
 
+bool CI18N::compileStringFile(const string &filename, const string &outputFilename)
+{
+	StrMapContainer table;
+	if (!loadFileIntoMap(filename, table))
+		return false;
+	return table.save(outputFilename);
+}
+
 const ucstring &CI18N::get (const string &label)
 {
 	if (label.empty())
@@ -141,10 +189,9 @@ const ucstring &CI18N::get (const string &label)
 		return emptyString;
 	}
 
-	StrMapContainer::iterator it(_StrMap.find(label));
-
-	if (it != _StrMap.end())
-		return it->second;
+	sint index = _StrMap.find(label);
+	if (index >= 0)
+		return _StrMap.getString(index);
 
 	static CHashSet<string>	missingStrings;
 	if (missingStrings.find(label) == missingStrings.end())
@@ -154,9 +201,9 @@ const ucstring &CI18N::get (const string &label)
 	}
 
 	// use the fall back language if it exists
-	it = _StrMapFallback.find(label);
-	if (it != _StrMapFallback.end())
-		return it->second;
+	index = _StrMapFallback.find(label);
+	if (index >= 0)
+		return _StrMapFallback.getString(index);
 
 	static ucstring	badString;
 
@@ -165,15 +212,30 @@ const ucstring &CI18N::get (const string &label)
 	return badString;
 }
 
+const ucchar *CI18N::getBuffer (const string &label, uint &size)
+{
+	sint index = _StrMap.find(label);
+	if (index >= 0)
+		return _StrMap.getText(index, size);
+
+	// use the fall back language if it exists
+	index = _StrMapFallback.find(label);
+	if (index >= 0)
+		return _StrMapFallback.getText(index, size);
+
+	size = 0;
+	return NULL;
+}
+
 bool CI18N::hasTranslation(const string &label)
 {
 	if (label.empty()) return true;
 
-	if(_StrMap.find(label) != _StrMap.end())
+	if(_StrMap.find(label) >= 0)
 			return true;
 
 	// use the fall back language if it exists
-	if (_StrMapFallback.find(label) != _StrMapFallback.end())
+	if (_StrMapFallback.find(label) >= 0)
 		return true;
 
 	return false;
@@ -1124,4 +1186,293 @@ uint64 CI18N::stringToHash(const string &str)
 	return hash;
 }
 
+// ***************************************************************************
+// CStringTable
+// ***************************************************************************
+
+CI18N::CStringTable::CStringTable()
+{
+	updatePointers();
+}
+
+// ***************************************************************************
+void CI18N::CStringTable::clear()
+{
+	_File.close();
+	_EntryVector.clear();
+	_SlotVector.clear();
+	_TextVector.clear();
+	_LabelVector.clear();
+	_Strings.clear();
+	updatePointers();
+}
+
+// ***************************************************************************
+void CI18N::CStringTable::updatePointers()
+{
+	_NumEntries = (uint32)_EntryVector.size();
+	_NumSlots = (uint32)_SlotVector.size();
+	_NumTextChars = (uint32)_TextVector.size();
+	_NumLabelChars = (uint32)_LabelVector.size();
+	_Entries = _EntryVector.empty() ? NULL : &_EntryVector[0];
+	_Slots = _SlotVector.empty() ? NULL : &_SlotVector[0];
+	_Texts = _TextVector.empty() ? NULL : &_TextVector[0];
+	_Labels = _LabelVector.data();
+}
+
+// ***************************************************************************
+uint32 CI18N::CStringTable::hash(const char *label, uint size)
+{
+	// FNV-1a
+	uint32 h = 2166136261U;
+	for (uint i=0; i<size; ++i)
+	{
+		h ^= (uint8)label[i];
+		h *= 16777619U;
+	}
+	return h;
+}
+
+// ***************************************************************************
+void CI18N::CStringTable::makeEditable()
+{
+	if (!_File.isOpen())
+		return;
+
+	_EntryVector.assign(_Entries, _Entries+_NumEntries);
+	_SlotVector.assign(_Slots, _Slots+_NumSlots);
+	_TextVector.assign(_Texts, _Texts+_NumTextChars);
+	_LabelVector.assign(_Labels, _NumLabelChars);
+	_File.close();
+	updatePointers();
+}
+
+// ***************************************************************************
+void CI18N::CStringTable::add(const string &label, const ucchar *text, uint size)
+{
+	makeEditable();
+
+	CEntry entry;
+	entry.Hash = hash(label.data(), (uint)label.size());
+	entry.Label = (uint32)_LabelVector.size();
+	entry.LabelSize = (uint32)label.size();
+	entry.Text = (uint32)_TextVector.size();
+	entry.TextSize = size;
+	_LabelVector += label;
+	_TextVector.insert(_TextVector.end(), text, text+size);
+	_EntryVector.push_back(entry);
+
+	// no lookup till the index is rebuilt
+	_SlotVector.clear();
+	updatePointers();
+}
+
+// ***************************************************************************
+void CI18N::CStringTable::buildIndex(bool replace, vector<string> *duplicates)
+{
+	makeEditable();
+
+	uint32 numSlots = raiseToNextPowerOf2(max((uint)16, (uint)_EntryVector.size()*2));
+	uint32 mask = numSlots-1;
+	_SlotVector.clear();
+	_SlotVector.resize(numSlots, 0);
+
+	// the duplicated entries are removed
+	vector<CEntry> entries;
+	entries.reserve(_EntryVector.size());
+	for (uint i=0; i<_EntryVector.size(); ++i)
+	{
+		const CEntry &entry = _EntryVector[i];
+		uint32 slot = entry.Hash & mask;
+		for (;;)
+		{
+			if (_SlotVector[slot] == 0)
+			{
+				entries.push_back(entry);
+				_SlotVector[slot] = (uint32)entries.size();
+				break;
+			}
+			CEntry &other = entries[_SlotVector[slot]-1];
+			if (other.Hash == entry.Hash && other.LabelSize == entry.LabelSize &&
+				memcmp(_LabelVector.data()+other.Label, _LabelVector.data()+entry.Label, entry.LabelSize) == 0)
+			{
+				if (duplicates)
+					duplicates->push_back(_LabelVector.substr(entry.Label, entry.LabelSize));
+				if (replace)
+					other = entry;
+				break;
+			}
+			slot = (slot+1) & mask;
+		}
+	}
+	_EntryVector.swap(entries);
+
+	// keep only the labels and the texts of the entries left, the block must not grow at each reload
+	uint numTextChars = 0;
+	uint numLabelChars = 0;
+	uint i;
+	for (i=0; i<_EntryVector.size(); ++i)
+	{
+		numTextChars += _EntryVector[i].TextSize;
+		numLabelChars += _EntryVector[i].LabelSize;
+	}
+	if (numTextChars != _TextVector.size() || numLabelChars != _LabelVector.size())
+	{
+		vector<ucchar> texts;
+		string labels;
+		texts.reserve(numTextChars);
+		labels.reserve(numLabelChars);
+		for (i=0; i<_EntryVector.size(); ++i)
+		{
+			CEntry &entry = _EntryVector[i];
+			uint32 text = (uint32)texts.size();
+			texts.insert(texts.end(), _TextVector.begin()+entry.Text, _TextVector.begin()+entry.Text+entry.TextSize);
+			entry.Text = text;
+			uint32 label = (uint32)labels.size();
+			labels.append(_LabelVector, entry.Label, entry.LabelSize);
+			entry.Label = label;
+		}
+		_TextVector.swap(texts);
+		_LabelVector.swap(labels);
+	}
+	updatePointers();
+
+	_Strings.clear();
+	_Strings.resize(_NumEntries);
+}
+
+// ***************************************************************************
+bool CI18N::CStringTable::map(const string &filename)
+{
+	clear();
+	if (!_File.open(filename))
+		return false;
+
+	const uint8 *data = _File.getData();
+	uint32 size = _File.getSize();
+	const CHeader *header = (const CHeader*)data;
+	if (size < sizeof(CHeader) || header->Magic != Magic || header->Version != Version ||
+		header->NumSlots == 0 || (header->NumSlots & (header->NumSlots-1)) != 0 ||
+		(uint64)sizeof(CHeader) + (uint64)header->NumEntries*sizeof(CEntry) + (uint64)header->NumSlots*sizeof(uint32) +
+		(uint64)header->NumTextChars*sizeof(ucchar) + header->NumLabelChars != size)
+	{
+		clear();
+		return false;
+	}
+
+	_NumEntries = header->NumEntries;
+	_NumSlots = header->NumSlots;
+	_NumTextChars = header->NumTextChars;
+	_NumLabelChars = header->NumLabelChars;
+	_Entries = (const CEntry*)(data + sizeof(CHeader));
+	_Slots = (const uint32*)(_Entries + _NumEntries);
+	_Texts = (const ucchar*)(_Slots + _NumSlots);
+	_Labels = (const char*)(_Texts + _NumTextChars);
+
+	// check the offsets, a bad file must not make the lookups read out of the block
+	bool valid = true;
+	uint i;
+	for (i=0; valid && i<_NumEntries; ++i)
+	{
+		const CEntry &entry = _Entries[i];
+		valid = (uint64)entry.Text + entry.TextSize <= _NumTextChars && (uint64)entry.Label + entry.LabelSize <= _NumLabelChars;
+	}
+	for (i=0; valid && i<_NumSlots; ++i)
+	{
+		valid = _Slots[i] <= _NumEntries;
+	}
+	if (!valid)
+	{
+		clear();
+		return false;
+	}
+
+	_Strings.resize(_NumEntries);
+	return true;
+}
+
+// ***************************************************************************
+bool CI18N::CStringTable::save(const string &filename) const
+{
+	nlassert(_NumSlots != 0);
+
+	COFile file;
+	if (!file.open(filename))
+		return false;
+
+	try
+	{
+		CHeader header;
+		header.Magic = Magic;
+		header.Version = Version;
+		header.NumEntries = _NumEntries;
+		header.NumSlots = _NumSlots;
+		header.NumTextChars = _NumTextChars;
+		header.NumLabelChars = _NumLabelChars;
+		file.serialBuffer((uint8*)&header, sizeof(header));
+		if (_NumEntries)
+			file.serialBuffer((uint8*)_Entries, _NumEntries*sizeof(CEntry));
+		file.serialBuffer((uint8*)_Slots, _NumSlots*sizeof(uint32));
+		if (_NumTextChars)
+			file.serialBuffer((uint8*)_Texts, _NumTextChars*sizeof(ucchar));
+		if (_NumLabelChars)
+			file.serialBuffer((uint8*)_Labels, _NumLabelChars);
+	}
+	catch (const EStream &e)
+	{
+		nlwarning("I18N: Can't write %s: %s", filename.c_str(), e.what());
+		return false;
+	}
+	return true;
+}
+
+// ***************************************************************************
+sint CI18N::CStringTable::find(const string &label) const
+{
+	if (_NumSlots == 0)
+		return -1;
+
+	uint32 h = hash(label.data(), (uint)label.size());
+	uint32 mask = _NumSlots-1;
+	uint32 slot = h & mask;
+	// the table is never full, but a mapped file may be
+	for (uint i=0; i<_NumSlots; ++i)
+	{
+		uint32 index = _Slots[slot];
+		if (index == 0)
+			return -1;
+		const CEntry &entry = _Entries[index-1];
+		if (entry.Hash == h && entry.LabelSize == label.size() && memcmp(_Labels+entry.Label, label.data(), entry.LabelSize) == 0)
+			return (sint)(index-1);
+		slot = (slot+1) & mask;
+	}
+	return -1;
+}
+
+// ***************************************************************************
+string CI18N::CStringTable::getLabel(uint index) const
+{
+	nlassert(index < _NumEntries);
+	return string(_Labels+_Entries[index].Label, _Entries[index].LabelSize);
+}
+
+// ***************************************************************************
+const ucchar *CI18N::CStringTable::getText(uint index, uint &size) const
+{
+	nlassert(index < _NumEntries);
+	size = _Entries[index].TextSize;
+	return _Texts+_Entries[index].Text;
+}
+
+// ***************************************************************************
+const ucstring &CI18N::CStringTable::getString(uint index) const
+{
+	nlassert(index < _NumEntries);
+	ucstring &str = _Strings[index];
+	const CEntry &entry = _Entries[index];
+	if (str.empty() && entry.TextSize != 0)
+		str.assign(_Texts+entry.Text, entry.TextSize);
+	return str;
+}
+
 } // namespace NLMISC
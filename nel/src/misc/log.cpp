@@ -27,6 +27,7 @@
 #	define NOMINMAX
 #	include <process.h>
 #	include <windows.h>
+#	include <intrin.h>
 #else
 #	include <unistd.h>
 #endif
@@ -38,6 +39,7 @@
 #include "nel/misc/log.h"
 #include "nel/misc/debug.h"
 #include "nel/misc/path.h"
+#include "nel/misc/thread.h"
 
 using namespace std;
 
@@ -47,10 +49,18 @@ namespace NLMISC
 
 string *CLog::_ProcessName = NULL;
 
-CLog::CLog( TLogType logType) : _LogType (logType), _FileName(NULL), _Line(-1), _FuncName(NULL), _Mutex("LOG"+toString((uint)logType)), _PosSet(false)
+CLog::CLog( TLogType logType) : _LogType (logType), _FileName(NULL), _Line(-1), _FuncName(NULL), _Mutex("LOG"+toString((uint)logType)), _PosSet(false),
+	_Async(false), _DisplayersMutex("LOGDISP"+toString((uint)logType))
 {
 }
 
+CLog::~CLog()
+{
+	// The writer must not use the log anymore
+	if (_Async)
+		flushAsync ();
+}
+
 void CLog::setDefaultProcessName ()
 {
 	if (_ProcessName == NULL)
@@ -130,6 +140,8 @@ void CLog::addDisplayer (IDisplayer *displayer, bool bypassFilter)
 		return;
 	}
 
+	CAutoMutex<CMutex> lock (_DisplayersMutex);
+
 	if (bypassFilter)
 	{
 		CDisplayers::iterator idi = std::find (_BypassFilterDisplayers.begin (), _BypassFilterDisplayers.end (), displayer);
@@ -164,6 +176,12 @@ void CLog::removeDisplayer (IDisplayer *displayer)
 		return;
 	}
 
+	// The displayer can be deleted after, don't keep lines for it
+	if (_Async)
+		flushAsync ();
+
+	CAutoMutex<CMutex> lock (_DisplayersMutex);
+
 	CDisplayers::iterator idi = std::find (_Displayers.begin (), _Displayers.end (), displayer);
 	if (idi != _Displayers.end ())
 	{
@@ -186,6 +204,11 @@ void CLog::removeDisplayer (const char *displayerName)
 		return;
 	}
 
+	if (_Async)
+		flushAsync ();
+
+	CAutoMutex<CMutex> lock (_DisplayersMutex);
+
 	CDisplayers::iterator idi;
 	for (idi = _Displayers.begin (); idi != _Displayers.end ();)
 	{
@@ -220,6 +243,8 @@ IDisplayer *CLog::getDisplayer (const char *displayerName)
 		return NULL;
 	}
 
+	CAutoMutex<CMutex> lock (_DisplayersMutex);
+
 	CDisplayers::iterator idi;
 	for (idi = _Displayers.begin (); idi != _Displayers.end (); idi++)
 	{
@@ -300,6 +325,21 @@ void CLog::displayString (const char *str)
 		}
 	}
 
+	if (_Async)
+	{
+		// The errors and the asserts are displayed synchronously, after the pending lines
+		if (_LogType == LOG_ERROR || _LogType == LOG_ASSERT || args->LogType == LOG_ERROR || args->LogType == LOG_ASSERT)
+		{
+			flushAsync ();
+		}
+		else if (pushAsync (*args, disp, passFilter (disp)))
+		{
+			TempString = "";
+			unsetPosition();
+			return;
+		}
+	}
+
 	// send to all bypass filter displayers
 	for (CDisplayers::iterator idi=_BypassFilterDisplayers.begin(); idi!=_BypassFilterDisplayers.end(); idi++ )
 	{
@@ -420,6 +460,21 @@ void CLog::displayRawString (const char *str)
 		}
 	}
 
+	if (_Async)
+	{
+		// The errors and the asserts are displayed synchronously, after the pending lines
+		if (_LogType == LOG_ERROR || _LogType == LOG_ASSERT || args->LogType == LOG_ERROR || args->LogType == LOG_ASSERT)
+		{
+			flushAsync ();
+		}
+		else if (pushAsync (*args, disp, passFilter (disp)))
+		{
+			TempString = "";
+			unsetPosition();
+			return;
+		}
+	}
+
 	// send to all bypass filter displayers
 	for (CDisplayers::iterator idi=_BypassFilterDisplayers.begin(); idi!=_BypassFilterDisplayers.end(); idi++ )
 	{
@@ -625,5 +680,617 @@ void CLog::releaseProcessName()
 	_ProcessName = NULL;
 }
 
-} // NLMISC
+// ***************************************************************************
+// Asynchronous mode
+// ***************************************************************************
+
+/* The indices and the flags read by a thread while another one changes them, outside of the condition.
+ * asyncStore() makes the previous stores visible before the new value (release), asyncLoad() is done
+ * before the next loads (acquire). asyncFence() orders a store before a load of another variable.
+ */
+#ifdef NL_OS_WINDOWS
+template <class T> static inline T asyncLoad (const volatile T &value)
+{
+	// x86 doesn't reorder the loads, the barrier stops the compiler
+	T result = value;
+	_ReadWriteBarrier ();
+	return result;
+}
+template <class T> static inline void asyncStore (volatile T &value, T newValue)
+{
+	_ReadWriteBarrier ();
+	value = newValue;
+}
+static inline void asyncFence ()
+{
+	MemoryBarrier ();
+}
+// Returns the previous value, with a full barrier
+static inline uint32 asyncCompareAndSwap (volatile uint32 &value, uint32 expected, uint32 newValue)
+{
+	return (uint32)InterlockedCompareExchange ((volatile LONG *)&value, (LONG)newValue, (LONG)expected);
+}
+#else
+template <class T> static inline T asyncLoad (const volatile T &value)
+{
+	return __atomic_load_n (&value, __ATOMIC_ACQUIRE);
+}
+template <class T> static inline void asyncStore (volatile T &value, T newValue)
+{
+	__atomic_store_n (&value, newValue, __ATOMIC_RELEASE);
+}
+static inline void asyncFence ()
+{
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+}
+// Returns the previous value, with a full barrier
+static inline uint32 asyncCompareAndSwap (volatile uint32 &value, uint32 expected, uint32 newValue)
+{
+	__atomic_compare_exchange_n (&value, &expected, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+#endif
+
+// A line pushed by a thread
+struct CAsyncLogLine
+{
+	CLog				*Log;
+	time_t				Date;
+	CLog::TLogType		LogType;
+	bool				HasProcessName;
+	uint				ThreadId;
+	const char			*FileName;
+	sint				Line;
+	const char			*FuncName;
+	bool				FilterPassed;
+	// The message, in Message if it fits, else in LongMessage allocated by the thread and deleted by the writer
+	char				*LongMessage;
+	char				Message[256];
+};
+
+/* The lines of a thread, a single producer single consumer ring. The indices are never wrapped.
+ * The thread only writes the lines between Write and Read + size and publishes them with Write, the writer
+ * only reads the lines between Read and Write and releases them with Read.
+ */
+struct CAsyncLogRing
+{
+	CAsyncLogLine		*Lines;
+	uint32				Mask;
+	// The next ring, the rings are never released
+	CAsyncLogRing		*Next;
+
+	// Changed by the thread
+	volatile uint32		Write;
+	volatile uint32		Dropped;
+	// 1 while the thread pushes a line, see CAsyncLogWriter::stop()
+	volatile uint32		Pushing;
+
+	// Changed by the writer, on another cache line
+	char				Padding[64];
+	volatile uint32		Read;
+	// Dropped lines already reported
+	uint32				DroppedReported;
+};
+
+/**
+ * The writer thread. It displays the lines of the rings with the displayers of their log, and flushes
+ * the displayers used in a pass at its end.
+ *
+ * A thread pushes its lines without lock. The condition is only taken to register the ring of a new
+ * thread, to wake up the writer when it sleeps (_WriterWaiting), and by the threads waiting for the
+ * writer (_NumWaiting), blocked on a full ring or in flush(). The side that changes a flag and the side
+ * that changes the rings both use asyncFence() before reading the other one, so a wake up can't be lost.
+ *
+ * crashFlush() can be called in a signal handler: it doesn't wait for the condition and doesn't
+ * allocate. The lines are shared with the writer through _Owner, changed by a compare and swap.
+ */
+class CAsyncLogWriter : public IRunnable
+{
+public:
+
+	CAsyncLogWriter ()
+	{
+		_RingSize = 2;
+		_Overflow = CLog::AsyncDrop;
+		_Running = 0;
+		_Exit = false;
+		_Crashed = 0;
+		_WriterWaiting = 0;
+		_NumWaiting = 0;
+		_InPass = 0;
+		_Passes = 0;
+		_Owner = OwnerNone;
+		_CurrentRing = NULL;
+		_CurrentIndex = 0;
+		_FirstRing = NULL;
+	}
+
+	// Prepare the start of the thread, false if the writer crashed
+	bool start (uint ringSize, CLog::TAsyncOverflow overflow)
+	{
+		CAutoMutex<CCondition> lock (_Condition);
+		if (_Crashed)
+			return false;
+
+		// The size of the new rings, the existing ones are not resized
+		_RingSize = 2;
+		while (_RingSize < ringSize)
+			_RingSize <<= 1;
+		_Overflow = overflow;
+		_Exit = false;
+		// crashFlush() must not allocate
+		_CrashDisplayers.reserve (64);
+		asyncStore (_Running, (uint32)1);
+		return true;
+	}
+
+	// Ask the thread to display the pending lines and exit, false if it was not running
+	bool stop ()
+	{
+		CAutoMutex<CCondition> lock (_Condition);
+		if (!_Running)
+			return false;
+
+		// The new lines are displayed synchronously, the writer waits for the lines being pushed
+		asyncStore (_Running, (uint32)0);
+		_Exit = true;
+		_Condition.notifyAll ();
+		return true;
+	}
+
+	bool isRunning ()
+	{
+		return asyncLoad (_Running) != 0;
+	}
+
+	virtual void run ()
+	{
+		IsAsyncWriterThread = true;
+
+		while (!asyncLoad (_Crashed))
+		{
+			if (displayPass ())
+				continue;
+
+			_Condition.enter ();
+			asyncStore (_WriterWaiting, (uint32)1);
+			asyncFence ();
+			bool exit = _Exit;
+			if (!exit && !hasPendingLines () && !asyncLoad (_Crashed))
+				_Condition.wait ();
+			asyncStore (_WriterWaiting, (uint32)0);
+			_Condition.leave ();
+
+			if (exit)
+			{
+				// A thread may have seen _Running before stop(), its line must be displayed
+				if (!hasPendingLines () && !isPushing ())
+					break;
+				nlSleep (0);
+			}
+		}
+	}
+
+	virtual void getName (std::string &result) const
+	{
+		result = "CAsyncLogWriter";
+	}
+
+	// Push a line in the ring of the calling thread, returns false if it must be displayed synchronously
+	bool push (CLog *log, const CLog::TDisplayInfo &args, const char *str, bool filterPassed)
+	{
+		if (!asyncLoad (_Running))
+			return false;
+
+		CAsyncLogRing *ring = getThreadRing ();
+		asyncStore (ring->Pushing, (uint32)1);
+		asyncFence ();
+		if (!asyncLoad (_Running))
+		{
+			asyncStore (ring->Pushing, (uint32)0);
+			return false;
+		}
+
+		uint32 write = ring->Write;
+		if (write - asyncLoad (ring->Read) > ring->Mask)
+		{
+			switch (_Overflow)
+			{
+			case CLog::AsyncDrop:
+				asyncStore (ring->Dropped, ring->Dropped + 1);
+				asyncStore (ring->Pushing, (uint32)0);
+				wakeWriter ();
+				return true;
+			case CLog::AsyncBlock:
+				if (waitForRead (ring, write))
+					break;
+				// The writer is stopped
+			default:
+				asyncStore (ring->Pushing, (uint32)0);
+				return false;
+			}
+		}
+
+		uint size = (uint)strlen (str) + 1;
+		CAsyncLogLine &line = ring->Lines[write & ring->Mask];
+		line.Log = log;
+		line.Date = args.Date;
+		line.LogType = args.LogType;
+		line.HasProcessName = !args.ProcessName.empty ();
+		line.ThreadId = args.ThreadId;
+		line.FileName = args.FileName;
+		line.Line = args.Line;
+		line.FuncName = args.FuncName;
+		line.FilterPassed = filterPassed;
+		if (size > sizeof (line.Message))
+		{
+			line.LongMessage = new char[size];
+			memcpy (line.LongMessage, str, size);
+		}
+		else
+		{
+			line.LongMessage = NULL;
+			memcpy (line.Message, str, size);
+		}
+
+		asyncStore (ring->Write, write + 1);
+		asyncStore (ring->Pushing, (uint32)0);
+		wakeWriter ();
+		return true;
+	}
+
+	// Wait until the lines pushed before the call are displayed and flushed
+	void flush ()
+	{
+		if (!asyncLoad (_Running))
+			return;
+
+		CAutoMutex<CCondition> lock (_Condition);
+		asyncStore (_NumWaiting, _NumWaiting + 1);
+		asyncFence ();
+
+		// The rings of the threads registered later have no line pushed before the call
+		for (CAsyncLogRing *ring = asyncLoad (_FirstRing); ring != NULL; ring = ring->Next)
+		{
+			uint32 write = asyncLoad (ring->Write);
+			while ((sint32)(asyncLoad (ring->Read) - write) < 0 && !asyncLoad (_Crashed))
+				_Condition.wait ();
+		}
+
+		// The pass that displayed the last lines may not have flushed the displayers yet
+		uint32 passes = asyncLoad (_Passes);
+		if (asyncLoad (_InPass))
+		{
+			while (asyncLoad (_Passes) == passes && !asyncLoad (_Crashed))
+				_Condition.wait ();
+		}
+		asyncStore (_NumWaiting, _NumWaiting - 1);
+	}
+
+	/* Display the pending lines in the calling thread, when the process is dying.
+	 * The writer stops after its current line, which is left to it. The calling thread may be in a signal
+	 * handler: the condition is only tried, to wake up the waiting threads, and nothing is allocated.
+	 */
+	void crashFlush ()
+	{
+		if (!asyncLoad (_Running))
+			return;
+		asyncStore (_Running, (uint32)0);
+		asyncStore (_Crashed, (uint32)1);
+
+		// Take the lines from the writer, only once
+		uint32 owner = _Owner;
+		for (;;)
+		{
+			if (owner == OwnerCrash)
+				return;
+			uint32 previous = asyncCompareAndSwap (_Owner, owner, OwnerCrash);
+			if (previous == owner)
+				break;
+			owner = previous;
+		}
+
+		if (_Condition.tryEnter ())
+		{
+			_Condition.notifyAll ();
+			_Condition.leave ();
+		}
+
+		_CrashDisplayers.clear ();
+		for (CAsyncLogRing *ring = asyncLoad (_FirstRing); ring != NULL; ring = ring->Next)
+		{
+			uint32 read = asyncLoad (ring->Read);
+			if (owner == OwnerWriter && ring == _CurrentRing)
+				read = _CurrentIndex + 1;
+			uint32 write = asyncLoad (ring->Write);
+			for (; (sint32)(write - read) > 0; read++)
+				displayLine (ring->Lines[read & ring->Mask], _CrashDisplayers);
+			asyncStore (ring->Read, write);
+		}
+
+		for (uint i=0; i<_CrashDisplayers.size (); i++)
+			_CrashDisplayers[i]->flush ();
+	}
+
+	static NL_THREAD_LOCAL bool				IsAsyncWriterThread;
+
+private:
+
+	static NL_THREAD_LOCAL CAsyncLogRing	*ThreadRing;
+
+	// The thread which displays the lines
+	enum { OwnerNone, OwnerWriter, OwnerCrash };
+
+	// Get the ring of the calling thread
+	CAsyncLogRing *getThreadRing ()
+	{
+		if (ThreadRing == NULL)
+		{
+			CAsyncLogRing *ring = new CAsyncLogRing;
+			CAutoMutex<CCondition> lock (_Condition);
+			ring->Lines = new CAsyncLogLine[_RingSize];
+			ring->Mask = _RingSize - 1;
+			ring->Write = 0;
+			ring->Dropped = 0;
+			ring->Pushing = 0;
+			ring->Read = 0;
+			ring->DroppedReported = 0;
+
+			ring->Next = _FirstRing;
+			asyncStore (_FirstRing, ring);
+			ThreadRing = ring;
+		}
+		return ThreadRing;
+	}
+
+	// Wake up the writer if it sleeps, called after a line is pushed
+	void wakeWriter ()
+	{
+		asyncFence ();
+		if (asyncLoad (_WriterWaiting))
+		{
+			CAutoMutex<CCondition> lock (_Condition);
+			_Condition.notifyAll ();
+		}
+	}
+
+	// Wake up the threads waiting for the writer, called after lines are displayed
+	void wakeWaiting ()
+	{
+		asyncFence ();
+		if (asyncLoad (_NumWaiting) != 0)
+		{
+			CAutoMutex<CCondition> lock (_Condition);
+			_Condition.notifyAll ();
+		}
+	}
+
+	// Wait until the writer has displayed the line before write, returns false if it is stopped
+	bool waitForRead (CAsyncLogRing *ring, uint32 write)
+	{
+		CAutoMutex<CCondition> lock (_Condition);
+		asyncStore (_NumWaiting, _NumWaiting + 1);
+		asyncFence ();
+		while (write - asyncLoad (ring->Read) > ring->Mask && asyncLoad (_Running))
+			_Condition.wait ();
+		asyncStore (_NumWaiting, _NumWaiting - 1);
+		return asyncLoad (_Running) != 0;
+	}
+
+	// True if there are lines to display or drops to report
+	bool hasPendingLines () const
+	{
+		for (CAsyncLogRing *ring = asyncLoad (_FirstRing); ring != NULL; ring = ring->Next)
+		{
+			if (asyncLoad (ring->Read) != asyncLoad (ring->Write) || asyncLoad (ring->Dropped) != ring->DroppedReported)
+				return true;
+		}
+		return false;
+	}
+
+	// True if a thread is pushing a line
+	bool isPushing () const
+	{
+		for (CAsyncLogRing *ring = asyncLoad (_FirstRing); ring != NULL; ring = ring->Next)
+		{
+			if (asyncLoad (ring->Pushing))
+				return true;
+		}
+		return false;
+	}
+
+	// Display the pending lines of all the rings, returns false if there was nothing to do
+	bool displayPass ()
+	{
+		bool displayed = false;
+		asyncStore (_InPass, (uint32)1);
+		for (CAsyncLogRing *ring = asyncLoad (_FirstRing); ring != NULL; ring = ring->Next)
+		{
+			// The lines pushed during the pass are displayed with it
+			for (uint32 read = ring->Read; read != asyncLoad (ring->Write); read++)
+			{
+				// The line can't be overwritten until Read is incremented, crashFlush() skips it if it is taken
+				_CurrentRing = ring;
+				_CurrentIndex = read;
+				if (asyncCompareAndSwap (_Owner, OwnerNone, OwnerWriter) != OwnerNone)
+					return true;
+				displayLine (ring->Lines[read & ring->Mask], _UsedDisplayers);
+				asyncStore (ring->Read, read + 1);
+				if (asyncCompareAndSwap (_Owner, OwnerWriter, OwnerNone) != OwnerWriter)
+					return true;
+
+				displayed = true;
+				wakeWaiting ();
+			}
+
+			uint32 dropped = asyncLoad (ring->Dropped) - ring->DroppedReported;
+			if (dropped != 0)
+			{
+				ring->DroppedReported += dropped;
+				nlwarning ("LOG: %u lines dropped, the asynchronous log ring of a thread was full", dropped);
+				displayed = true;
+			}
+		}
+
+		// One flush per pass
+		for (uint i=0; i<_UsedDisplayers.size (); i++)
+			_UsedDisplayers[i]->flush ();
+		_UsedDisplayers.clear ();
 
+		asyncStore (_Passes, _Passes + 1);
+		asyncStore (_InPass, (uint32)0);
+		wakeWaiting ();
+		return displayed;
+	}
+
+	// Display a line and release it
+	static void displayLine (CAsyncLogLine &line, std::vector<IDisplayer *> &usedDisplayers)
+	{
+		CLog::TDisplayInfo args;
+		args.Date = line.Date;
+		args.LogType = line.LogType;
+		if (line.HasProcessName && CLog::_ProcessName != NULL)
+			args.ProcessName = *CLog::_ProcessName;
+		args.ThreadId = line.ThreadId;
+		args.FileName = line.FileName;
+		args.Line = line.Line;
+		args.FuncName = line.FuncName;
+		args.Deferred = true;
+
+		line.Log->displayDeferred (args, line.LongMessage ? line.LongMessage : line.Message, line.FilterPassed, usedDisplayers);
+
+		delete [] line.LongMessage;
+		line.LongMessage = NULL;
+	}
+
+	CCondition					_Condition;
+
+	// Set by start() before _Running
+	uint						_RingSize;
+	CLog::TAsyncOverflow		_Overflow;
+	// 1 between start() and stop() or crashFlush(), the lines are pushed in the rings
+	volatile uint32				_Running;
+	// Protected by the condition
+	bool						_Exit;
+	volatile uint32				_Crashed;
+	// 1 if the writer sleeps in the condition
+	volatile uint32				_WriterWaiting;
+	// Number of threads waiting for the writer, changed in the condition
+	volatile uint32				_NumWaiting;
+	// 1 while the writer displays a pass, _Passes is incremented after the flush of the displayers
+	volatile uint32				_InPass;
+	volatile uint32				_Passes;
+	// The thread displaying the lines, and the line displayed by the writer
+	volatile uint32				_Owner;
+	CAsyncLogRing *volatile		_CurrentRing;
+	volatile uint32				_CurrentIndex;
+
+	// The list of the rings, new rings are added in the condition
+	CAsyncLogRing *volatile		_FirstRing;
+
+	// Used by the writer thread only
+	std::vector<IDisplayer*>	_UsedDisplayers;
+	// Used by crashFlush() only
+	std::vector<IDisplayer*>	_CrashDisplayers;
+};
+
+NL_THREAD_LOCAL bool			CAsyncLogWriter::IsAsyncWriterThread = false;
+NL_THREAD_LOCAL CAsyncLogRing	*CAsyncLogWriter::ThreadRing = NULL;
+
+// The writer is created by the first startAsyncWriter() and never released, the threads keep a pointer on their ring
+static CAsyncLogWriter	*AsyncLogWriter = NULL;
+static IThread			*AsyncLogWriterThread = NULL;
+
+static void asyncLogAtExit ()
+{
+	CLog::flushAsync ();
+}
+
+void CLog::startAsyncWriter (uint ringSize, TAsyncOverflow overflow)
+{
+#ifndef NL_HAS_THREAD_LOCAL
+	nlwarning ("LOG: No thread local storage, the asynchronous logs are displayed synchronously");
+#else
+	if (AsyncLogWriterThread != NULL)
+	{
+		nlwarning ("LOG: The asynchronous log writer is already started");
+		return;
+	}
+
+	if (AsyncLogWriter == NULL)
+	{
+		AsyncLogWriter = new CAsyncLogWriter;
+		atexit (asyncLogAtExit);
+	}
+
+	if (!AsyncLogWriter->start (ringSize, overflow))
+		return;
+
+	AsyncLogWriterThread = IThread::create (AsyncLogWriter);
+	AsyncLogWriterThread->start ();
+#endif
+}
+
+void CLog::stopAsyncWriter ()
+{
+	if (AsyncLogWriterThread == NULL)
+		return;
+
+	// After a crash, the writer may be stuck: the thread is left as it is, not terminated
+	if (AsyncLogWriter->stop ())
+	{
+		AsyncLogWriterThread->wait ();
+		delete AsyncLogWriterThread;
+	}
+	AsyncLogWriterThread = NULL;
+}
+
+bool CLog::isAsyncWriterRunning ()
+{
+	return AsyncLogWriter != NULL && AsyncLogWriter->isRunning ();
+}
+
+void CLog::flushAsync (bool crash)
+{
+	if (AsyncLogWriter == NULL || CAsyncLogWriter::IsAsyncWriterThread)
+		return;
+
+	if (crash)
+		AsyncLogWriter->crashFlush ();
+	else
+		AsyncLogWriter->flush ();
+}
+
+bool CLog::pushAsync (const TDisplayInfo &args, const char *str, bool filterPassed)
+{
+	// The writer displays its own lines (ie. the dropped lines warnings) synchronously
+	if (AsyncLogWriter == NULL || CAsyncLogWriter::IsAsyncWriterThread)
+		return false;
+
+	return AsyncLogWriter->push (this, args, str, filterPassed);
+}
+
+void CLog::displayDeferred (const TDisplayInfo &args, const char *str, bool filterPassed, std::vector<IDisplayer *> &usedDisplayers)
+{
+	CAutoMutex<CMutex> lock (_DisplayersMutex);
+
+	CDisplayers::iterator idi;
+	for (idi=_BypassFilterDisplayers.begin(); idi!=_BypassFilterDisplayers.end(); idi++ )
+	{
+		(*idi)->display( args, str );
+		if (std::find (usedDisplayers.begin (), usedDisplayers.end (), *idi) == usedDisplayers.end ())
+			usedDisplayers.push_back (*idi);
+	}
+
+	if (filterPassed)
+	{
+		for (idi=_Displayers.begin(); idi!=_Displayers.end(); idi++ )
+		{
+			(*idi)->display( args, str );
+			if (std::find (usedDisplayers.begin (), usedDisplayers.end (), *idi) == usedDisplayers.end ())
+				usedDisplayers.push_back (*idi);
+		}
+	}
+}
+
+} // NLMISC
@@ -0,0 +1,239 @@
+/** \file lz4_block.cpp
+ * Compression of memory blocks in the LZ4 block format
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdmisc.h"
+
+#include "nel/misc/lz4_block.h"
+
+
+namespace NLMISC
+{
+
+// ***************************************************************************
+
+// Rules of the format: the last 5 bytes are always literals, and the last match starts 12 bytes before the end at least
+static const uint32	LZ4MinMatch = 4;
+static const uint32	LZ4LastLiterals = 5;
+static const uint32	LZ4MatchFindLimit = 12;
+static const uint32	LZ4MaxOffset = 65535;
+static const uint32	LZ4HashLog = 12;
+
+// ***************************************************************************
+static inline uint32	lz4Read32 (const uint8 *ptr)
+{
+	uint32	value;
+	memcpy (&value, ptr, sizeof(uint32));
+	return value;
+}
+
+// ***************************************************************************
+static inline uint32	lz4Hash (uint32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - LZ4HashLog);
+}
+
+// ***************************************************************************
+// Write a length extension: a run of 255 and the remainder
+static inline uint8	*lz4WriteLength (uint8 *op, uint32 length)
+{
+	while (length >= 255)
+	{
+		*(op++) = 255;
+		length -= 255;
+	}
+	*(op++) = (uint8)length;
+	return op;
+}
+
+// ***************************************************************************
+// Write a sequence: the literals since the anchor, then a match if matchLength != 0
+static inline uint8	*lz4WriteSequence (uint8 *op, const uint8 *oend, const uint8 *literals, uint32 literalLength, uint32 offset, uint32 matchLength, bool lastSequence)
+{
+	// Check the worst size of the sequence
+	uint32	worstSize = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+	if (worstSize > (uint32)(oend - op))
+		return NULL;
+
+	uint8	*token = op++;
+	uint8	tokenValue;
+	if (literalLength >= 15)
+	{
+		tokenValue = 15 << 4;
+		op = lz4WriteLength (op, literalLength - 15);
+	}
+	else
+	{
+		tokenValue = (uint8)(literalLength << 4);
+	}
+	memcpy (op, literals, literalLength);
+	op += literalLength;
+
+	if (!lastSequence)
+	{
+		*(op++) = (uint8)(offset & 0xff);
+		*(op++) = (uint8)(offset >> 8);
+		uint32	length = matchLength - LZ4MinMatch;
+		if (length >= 15)
+		{
+			tokenValue |= 15;
+			op = lz4WriteLength (op, length - 15);
+		}
+		else
+		{
+			tokenValue |= (uint8)length;
+		}
+	}
+
+	*token = tokenValue;
+	return op;
+}
+
+// ***************************************************************************
+uint32			lz4Compress (const uint8 *src, uint32 srcSize, uint8 *dest, uint32 destCapacity)
+{
+	const uint8	*ip = src;
+	const uint8	*anchor = src;
+	const uint8	*iend = src + srcSize;
+	uint8		*op = dest;
+	const uint8	*oend = dest + destCapacity;
+
+	if (srcSize > LZ4MatchFindLimit)
+	{
+		// Position + 1 of the last sequence of each hash, 0 if none
+		uint32	table[1 << LZ4HashLog];
+		memset (table, 0, sizeof(table));
+
+		const uint8	*matchFindLimit = iend - LZ4MatchFindLimit;
+		const uint8	*matchLimit = iend - LZ4LastLiterals;
+		while (ip < matchFindLimit)
+		{
+			uint32	sequence = lz4Read32 (ip);
+			uint32	&entry = table[lz4Hash (sequence)];
+			uint32	candidate = entry;
+			entry = (uint32)(ip - src) + 1;
+			if (candidate == 0 || entry - candidate > LZ4MaxOffset || lz4Read32 (src + candidate - 1) != sequence)
+			{
+				ip++;
+				continue;
+			}
+			const uint8	*match = src + candidate - 1;
+
+			// Extend the match backward over the pending literals
+			while (ip > anchor && match > src && ip[-1] == match[-1])
+			{
+				ip--;
+				match--;
+			}
+
+			// And forward
+			const uint8	*matchEnd = ip + LZ4MinMatch;
+			const uint8	*ref = match + LZ4MinMatch;
+			while (matchEnd < matchLimit && *matchEnd == *ref)
+			{
+				matchEnd++;
+				ref++;
+			}
+
+			op = lz4WriteSequence (op, oend, anchor, (uint32)(ip - anchor), (uint32)(ip - match), (uint32)(matchEnd - ip), false);
+			if (op == NULL)
+				return 0;
+			ip = matchEnd;
+			anchor = ip;
+		}
+	}
+
+	// Last literals
+	op = lz4WriteSequence (op, oend, anchor, (uint32)(iend - anchor), 0, 0, true);
+	if (op == NULL)
+		return 0;
+	return (uint32)(op - dest);
+}
+
+// ***************************************************************************
+// Read a length extension, false if the block is truncated
+static inline bool	lz4ReadLength (const uint8 *&ip, const uint8 *iend, uint32 &length)
+{
+	uint8	value;
+	do
+	{
+		if (ip >= iend)
+			return false;
+		value = *(ip++);
+		length += value;
+	}
+	while (value == 255);
+	return true;
+}
+
+// ***************************************************************************
+bool			lz4Decompress (const uint8 *src, uint32 srcSize, uint8 *dest, uint32 destSize)
+{
+	const uint8	*ip = src;
+	const uint8	*iend = src + srcSize;
+	uint8		*op = dest;
+	uint8		*oend = dest + destSize;
+
+	for(;;)
+	{
+		if (ip >= iend)
+			return false;
+		uint8	token = *(ip++);
+
+		// Literals
+		uint32	literalLength = token >> 4;
+		if (literalLength == 15 && !lz4ReadLength (ip, iend, literalLength))
+			return false;
+		if (literalLength > (uint32)(iend - ip) || literalLength > (uint32)(oend - op))
+			return false;
+		memcpy (op, ip, literalLength);
+		op += literalLength;
+		ip += literalLength;
+
+		// The last sequence has no match
+		if (ip == iend)
+			return op == oend;
+
+		// Match
+		if (iend - ip < 2)
+			return false;
+		uint32	offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (uint32)(op - dest))
+			return false;
+		uint32	matchLength = token & 15;
+		if (matchLength == 15 && !lz4ReadLength (ip, iend, matchLength))
+			return false;
+		matchLength += LZ4MinMatch;
+		if (matchLength > (uint32)(oend - op))
+			return false;
+
+		// The match can overlap the output, copy byte per byte
+		const uint8	*match = op - offset;
+		for (uint32 i=0; i<matchLength; i++)
+			op[i] = match[i];
+		op += matchLength;
+	}
+}
+
+
+} // NLMISC
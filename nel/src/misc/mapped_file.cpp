@@ -0,0 +1,154 @@
+/** \file mapped_file.cpp
+ * Read only memory mapping of a file
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdmisc.h"
+#include "nel/misc/mapped_file.h"
+
+#ifdef NL_OS_WINDOWS
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+using namespace std;
+
+
+namespace NLMISC {
+
+
+/*
+ * Constructor
+ */
+CMappedFile::CMappedFile() : _Data(NULL), _Size(0)
+{
+#ifdef NL_OS_WINDOWS
+	_File= NULL;
+	_Mapping= NULL;
+#endif
+}
+
+
+/*
+ * Destructor
+ */
+CMappedFile::~CMappedFile()
+{
+	close();
+}
+
+
+/*
+ * Map a file
+ */
+bool			CMappedFile::open(const std::string &path)
+{
+	close();
+
+#ifdef NL_OS_WINDOWS
+
+	HANDLE file= CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	DWORD size= GetFileSize(file, NULL);
+	if (size == INVALID_FILE_SIZE || size == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping= CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		nlwarning("MAPFILE: Cannot create file mapping for %s: error %u", path.c_str(), GetLastError());
+		CloseHandle(file);
+		return false;
+	}
+	void *data= MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL)
+	{
+		nlwarning("MAPFILE: Cannot map %s: error %u", path.c_str(), GetLastError());
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	_File= file;
+	_Mapping= mapping;
+	_Data= (const uint8*)data;
+	_Size= size;
+
+#else
+
+	int fd= ::open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void *data= mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// the mapping stays valid once the file descriptor is closed
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		nlwarning("MAPFILE: Cannot map %s: %s", path.c_str(), strerror(errno));
+		return false;
+	}
+	_Data= (const uint8*)data;
+	_Size= (uint32)st.st_size;
+
+#endif
+
+	return true;
+}
+
+
+/*
+ * Unmap the file
+ */
+void			CMappedFile::close()
+{
+	if (_Data == NULL)
+		return;
+
+#ifdef NL_OS_WINDOWS
+	UnmapViewOfFile(_Data);
+	CloseHandle((HANDLE)_Mapping);
+	CloseHandle((HANDLE)_File);
+	_File= NULL;
+	_Mapping= NULL;
+#else
+	munmap((void*)_Data, _Size);
+#endif
+
+	_Data= NULL;
+	_Size= 0;
+}
+
+
+} // NLMISC
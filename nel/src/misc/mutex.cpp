@@ -299,6 +299,100 @@ void CFairMutex::leave()
 	debugLeave();
 }
 
+
+/////////////////////////// CCondition
+
+
+/*
+ * Windows version
+ */
+CCondition::CCondition()
+{
+	nlassert( sizeof(TNelRtlCriticalSection)==sizeof(CRITICAL_SECTION) );
+	InitializeCriticalSection( (CRITICAL_SECTION*)&_Cs );
+}
+
+
+/*
+ * Windows version
+ */
+CCondition::~CCondition()
+{
+	nlassert( _Waiters.empty() );
+	DeleteCriticalSection( (CRITICAL_SECTION*)&_Cs );
+}
+
+
+/*
+ * Windows version
+ */
+void CCondition::enter()
+{
+	EnterCriticalSection( (CRITICAL_SECTION*)&_Cs );
+}
+
+
+/*
+ * Windows version
+ */
+bool CCondition::tryEnter()
+{
+	return TryEnterCriticalSection( (CRITICAL_SECTION*)&_Cs ) != FALSE;
+}
+
+
+/*
+ * Windows version
+ */
+void CCondition::leave()
+{
+	LeaveCriticalSection( (CRITICAL_SECTION*)&_Cs );
+}
+
+
+/*
+ * Windows version
+ * Each waiting thread waits on its own event, so a notification can't be taken by a thread which
+ * starts to wait after it.
+ */
+void CCondition::wait()
+{
+	HANDLE event = CreateEvent( NULL, FALSE, FALSE, NULL );
+	nlassert( event != NULL );
+	_Waiters.push_back( event );
+
+	LeaveCriticalSection( (CRITICAL_SECTION*)&_Cs );
+	WaitForSingleObject( event, INFINITE );
+	EnterCriticalSection( (CRITICAL_SECTION*)&_Cs );
+
+	// the notifier has removed the event from the waiters
+	CloseHandle( event );
+}
+
+
+/*
+ * Windows version
+ */
+void CCondition::notifyOne()
+{
+	if ( ! _Waiters.empty() )
+	{
+		SetEvent( (HANDLE)_Waiters.front() );
+		_Waiters.erase( _Waiters.begin() );
+	}
+}
+
+
+/*
+ * Windows version
+ */
+void CCondition::notifyAll()
+{
+	for ( uint i=0; i!=_Waiters.size(); ++i )
+		SetEvent( (HANDLE)_Waiters[i] );
+	_Waiters.clear();
+}
+
 /*************
  * Unix code *
  *************/
@@ -448,6 +542,85 @@ void CFairMutex::leave()
 }
 
 
+/////////////////////////// CCondition
+
+
+/*
+ * Unix version
+ */
+CCondition::CCondition()
+{
+	pthread_mutex_init( &_Mutex, NULL );
+	pthread_cond_init( &_Cond, NULL );
+}
+
+
+/*
+ * Unix version
+ */
+CCondition::~CCondition()
+{
+	pthread_cond_destroy( &_Cond );
+	pthread_mutex_destroy( &_Mutex );
+}
+
+
+/*
+ * Unix version
+ */
+void CCondition::enter()
+{
+	if ( pthread_mutex_lock( &_Mutex ) != 0 )
+		nlerror( "Error locking a condition mutex" );
+}
+
+
+/*
+ * Unix version
+ */
+bool CCondition::tryEnter()
+{
+	return pthread_mutex_trylock( &_Mutex ) == 0;
+}
+
+
+/*
+ * Unix version
+ */
+void CCondition::leave()
+{
+	if ( pthread_mutex_unlock( &_Mutex ) != 0 )
+		nlerror( "Error unlocking a condition mutex" );
+}
+
+
+/*
+ * Unix version
+ */
+void CCondition::wait()
+{
+	pthread_cond_wait( &_Cond, &_Mutex );
+}
+
+
+/*
+ * Unix version
+ */
+void CCondition::notifyOne()
+{
+	pthread_cond_signal( &_Cond );
+}
+
+
+/*
+ * Unix version
+ */
+void CCondition::notifyAll()
+{
+	pthread_cond_broadcast( &_Cond );
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /*
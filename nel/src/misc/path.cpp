@@ -1199,32 +1199,19 @@ void CFileContainer::addSearchBigFile (const string &sBigFilename, bool recurse,
 		nlwarning ("PATH: CPath::addSearchBigFile(%s, %d, %d): '%s' is not a file, skip it", sBigFilename.c_str(), recurse, alternative, sBigFilename.c_str());
 		return;
 	}
-	// Open and read the big file header
 	nlassert(!_MemoryCompressed);
 
-	FILE *Handle = fopen (sBigFilename.c_str(), "rb");
-	if (Handle == NULL)
-	{
-		nlwarning ("PATH: CPath::addSearchBigFile(%s, %d, %d): can't open file, skip it", sBigFilename.c_str(), recurse, alternative);
-		return;
-	}
-
-	// add the link with the CBigFile singleton
+	// add the link with the CBigFile singleton, it reads the directory of the v1 and v2 formats
 	if (CBigFile::getInstance().add (sBigFilename, BF_ALWAYS_OPENED | BF_CACHE_FILE_ON_OPEN))
 	{
 		// also add the bigfile name in the map to retrieve the full path of a .bnp when we want modification date of the bnp for example
 		insertFileInMap (CFile::getFilename (sBigFilename), sBigFilename, false, CFile::getExtension(sBigFilename));
 
-		// parse the big file to add file in the map
-		uint32 nFileSize=CFile::getFileSize (Handle);
-		//nlfseek64 (Handle, 0, SEEK_END);
-		//uint32 nFileSize = ftell (Handle);
-		nlfseek64 (Handle, nFileSize-4, SEEK_SET);
-		uint32 nOffsetFromBegining;
-		fread (&nOffsetFromBegining, sizeof(uint32), 1, Handle);
-		nlfseek64 (Handle, nOffsetFromBegining, SEEK_SET);
-		uint32 nNbFile;
-		fread (&nNbFile, sizeof(uint32), 1, Handle);
+		// add the files of the big file in the map
+		string bigfilenamealone = CFile::getFilename (sBigFilename);
+		vector<string> filenames;
+		CBigFile::getInstance().list (bigfilenamealone, filenames);
+		uint32 nNbFile = (uint32)filenames.size();
 		for (uint32 i = 0; i < nNbFile; ++i)
 		{
 			// Progress bar
@@ -1234,22 +1221,12 @@ void CFileContainer::addSearchBigFile (const string &sBigFilename, bool recurse,
 				progressCallBack->pushCropedValues ((float)i/(float)nNbFile, (float)(i+1)/(float)nNbFile);
 			}
 
-			char FileName[256];
-			uint8 nStringSize;
-			fread (&nStringSize, 1, 1, Handle);
-			fread (FileName, 1, nStringSize, Handle);
-			FileName[nStringSize] = 0;
-			uint32 nFileSize2;
-			fread (&nFileSize2, sizeof(uint32), 1, Handle);
-			uint32 nFilePos;
-			fread (&nFilePos, sizeof(uint32), 1, Handle);
-			string sTmp = toLower(string(FileName));
+			string sTmp = toLower(filenames[i]);
 			if (sTmp.empty())
 			{
 				nlwarning ("PATH: CPath::addSearchBigFile(%s, %d, %d): can't add empty file, skip it", sBigFilename.c_str(), recurse, alternative);
 				continue;
 			}
-			string bigfilenamealone = CFile::getFilename (sBigFilename);
 			string filenamewoext = CFile::getFilenameWithoutExtension (sTmp);
 			string ext = toLower(CFile::getExtension(sTmp));
 
@@ -1278,8 +1255,6 @@ void CFileContainer::addSearchBigFile (const string &sBigFilename, bool recurse,
 	{
 		nlwarning ("PATH: CPath::addSearchBigFile(%s, %d, %d): can't add the big file", sBigFilename.c_str(), recurse, alternative);
 	}
-
-	fclose (Handle);
 }
 
 // WARNING : recurse is not used
@@ -1801,9 +1776,11 @@ uint32	CFile::getFileSize (const std::string &filename)
 	}
 	else if (filename.find('@') != string::npos)
 	{
-		uint32 fs = 0, bfo;
+		uint32 fs = 0;
+		uint64 bfo;
 		bool c, d;
-		CBigFile::getInstance().getFile (filename, fs, bfo, c, d);
+		const CBigFileBlocks *blocks;
+		CBigFile::getInstance().getFile (filename, fs, bfo, c, d, blocks);
 		return fs;
 	}
 	else
@@ -0,0 +1,308 @@
+/** \file rope_stream.cpp
+ * CRopeStream class
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdmisc.h"
+
+#include "nel/misc/rope_stream.h"
+#include "nel/misc/mutex.h"
+
+using namespace std;
+
+namespace NLMISC
+{
+
+// ***************************************************************************
+// The free chunks, shared by all the threads
+struct CRopeChunkPool
+{
+	// Keep at most 4 MB of free chunks
+	enum { MaxFreeChunks = 256 };
+
+	CMutex			Mutex;
+	vector<void*>	FreeChunks;
+
+	~CRopeChunkPool()
+	{
+		for (uint i=0; i<FreeChunks.size(); ++i)
+			::operator delete (FreeChunks[i]);
+	}
+};
+
+static CRopeChunkPool	RopeChunkPool;
+
+// ***************************************************************************
+void *CRopeChunk::operator new (size_t size)
+{
+	nlassert (size == sizeof(CRopeChunk));
+	{
+		CAutoMutex<CMutex> lock (RopeChunkPool.Mutex);
+		if (!RopeChunkPool.FreeChunks.empty ())
+		{
+			void *p = RopeChunkPool.FreeChunks.back ();
+			RopeChunkPool.FreeChunks.pop_back ();
+			return p;
+		}
+	}
+	return ::operator new (size);
+}
+
+// ***************************************************************************
+void CRopeChunk::operator delete (void *p)
+{
+	if (p == NULL)
+		return;
+	{
+		CAutoMutex<CMutex> lock (RopeChunkPool.Mutex);
+		if (RopeChunkPool.FreeChunks.size () < CRopeChunkPool::MaxFreeChunks)
+		{
+			RopeChunkPool.FreeChunks.push_back (p);
+			return;
+		}
+	}
+	::operator delete (p);
+}
+
+
+// ***************************************************************************
+CRopeStream::CRopeStream( bool inputStream ) :
+	NLMISC::IStream( inputStream ), _Offset( 0 ), _Length( 0 ), _Pos( 0 )
+{
+}
+
+// ***************************************************************************
+CRopeStream::CRopeStream( const CRopeStream& other ) :
+	IStream (other)
+{
+	operator=( other );
+}
+
+// ***************************************************************************
+CRopeStream& CRopeStream::operator=( const CRopeStream& other )
+{
+	IStream::operator= (other);
+	_Chunks = other._Chunks;
+	_Offset = other._Offset;
+	_Length = other._Length;
+	_Pos = other._Pos;
+	return *this;
+}
+
+// ***************************************************************************
+void CRopeStream::swap( CRopeStream &other )
+{
+	IStream::swap(other);
+	_Chunks.swap(other._Chunks);
+	std::swap(_Offset, other._Offset);
+	std::swap(_Length, other._Length);
+	std::swap(_Pos, other._Pos);
+}
+
+// ***************************************************************************
+void CRopeStream::grow( uint32 length )
+{
+	uint numChunks = (_Offset + length + CRopeChunk::Size - 1) / CRopeChunk::Size;
+	while (_Chunks.size() < numChunks)
+		_Chunks.push_back(new CRopeChunk);
+}
+
+// ***************************************************************************
+void CRopeStream::write( uint32 pos, const uint8 *buf, uint32 len )
+{
+	uint32 offset = _Offset + pos;
+	while (len != 0)
+	{
+		TChunkPtr &chunk = _Chunks[offset / CRopeChunk::Size];
+		uint32 inChunk = offset % CRopeChunk::Size;
+		uint32 size = std::min(len, (uint32)CRopeChunk::Size - inChunk);
+
+		// Copy the chunk if another stream shares it
+		if (chunk->getRefCount() > 1)
+			chunk = new CRopeChunk(*chunk);
+
+		CFastMem::memcpy( chunk->Data + inChunk, buf, size );
+		buf += size;
+		offset += size;
+		len -= size;
+	}
+}
+
+// ***************************************************************************
+void CRopeStream::serialBuffer(uint8 *buf, uint len)
+{
+	if (len == 0)
+		return;
+
+	nlassert (buf != NULL);
+
+	if ( isReading() )
+	{
+		if ( _Pos+len > _Length )
+		{
+			throw EStreamOverflow( "CRopeStream serialBuffer overflow: Read past %u bytes", _Length );
+		}
+
+		uint32 offset = _Offset + _Pos;
+		_Pos += len;
+		while (len != 0)
+		{
+			const CRopeChunk *chunk = _Chunks[offset / CRopeChunk::Size];
+			uint32 inChunk = offset % CRopeChunk::Size;
+			uint32 size = std::min((uint32)len, (uint32)CRopeChunk::Size - inChunk);
+			CFastMem::memcpy( buf, chunk->Data + inChunk, size );
+			buf += size;
+			offset += size;
+			len -= size;
+		}
+	}
+	else
+	{
+		grow( _Pos+len );
+		write( _Pos, buf, len );
+		_Pos += len;
+		_Length = std::max(_Length, _Pos);
+	}
+}
+
+// ***************************************************************************
+void CRopeStream::serialBit(bool &bit)
+{
+	uint8 u;
+	if ( isReading() )
+	{
+		serial( u );
+		bit = (u!=0);
+	}
+	else
+	{
+		u = (uint8)bit;
+		serial( u );
+	}
+}
+
+// ***************************************************************************
+bool CRopeStream::seek (sint32 offset, TSeekOrigin origin) const throw(EStream)
+{
+	switch (origin)
+	{
+	case begin:
+		if (offset > (sint)_Length)
+			return false;
+		if (offset < 0)
+			return false;
+		_Pos = offset;
+		break;
+	case current:
+		if (getPos ()+offset > (sint)_Length)
+			return false;
+		if (getPos ()+offset < 0)
+			return false;
+		_Pos += offset;
+		break;
+	case end:
+		if (offset < -(sint)_Length)
+			return false;
+		if (offset > 0)
+			return false;
+		_Pos = _Length+offset;
+		break;
+	}
+	return true;
+}
+
+// ***************************************************************************
+sint32 CRopeStream::reserve( uint len )
+{
+	sint32 pos = sint32(_Pos);
+	if ( ! isReading() )
+	{
+		grow( _Pos+len );
+		_Pos += len;
+		_Length = std::max(_Length, _Pos);
+	}
+	return pos;
+}
+
+// ***************************************************************************
+void CRopeStream::clear()
+{
+	resetPtrTable();
+	_Chunks.clear();
+	_Offset = 0;
+	_Length = 0;
+	_Pos = 0;
+}
+
+// ***************************************************************************
+void CRopeStream::invert()
+{
+	resetPtrTable();
+	if ( isReading() )
+	{
+		// In->Out: append to what we have read
+		setInOut( false );
+		_Pos = _Length;
+	}
+	else
+	{
+		// Out->In: read what we have written
+		setInOut( true );
+		_Pos = 0;
+	}
+}
+
+// ***************************************************************************
+CRopeStream CRopeStream::slice( uint32 pos, uint32 len ) const
+{
+	nlassert( pos <= _Length && len <= _Length - pos );
+
+	CRopeStream result( true );
+	if (len != 0)
+	{
+		uint32 offset = _Offset + pos;
+		uint first = offset / CRopeChunk::Size;
+		uint last = (offset + len - 1) / CRopeChunk::Size;
+		result._Chunks.assign(_Chunks.begin() + first, _Chunks.begin() + last + 1);
+		result._Offset = offset % CRopeChunk::Size;
+		result._Length = len;
+	}
+	return result;
+}
+
+// ***************************************************************************
+void CRopeStream::writeTo( IStream &dest ) const
+{
+	uint32 offset = _Offset;
+	uint32 len = _Length;
+	while (len != 0)
+	{
+		const CRopeChunk *chunk = _Chunks[offset / CRopeChunk::Size];
+		uint32 inChunk = offset % CRopeChunk::Size;
+		uint32 size = std::min(len, (uint32)CRopeChunk::Size - inChunk);
+		dest.serialBuffer( const_cast<uint8*>(chunk->Data + inChunk), size );
+		offset += size;
+		len -= size;
+	}
+}
+
+
+} // NLMISC
@@ -24,9 +24,167 @@
 #include "stdmisc.h"
 #include "nel/misc/ucstring.h"
 
+#ifdef NL_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace	NLMISC
 {
 
+// ***************************************************************************
+
+uint		convertUtf8ToUtf16 (const char *src, uint size, ucchar *dest)
+{
+	const uint8	*first = (const uint8*)src;
+	const uint8	*last = first + size;
+	ucchar		*out = dest;
+
+	while (first != last)
+	{
+		// ASCII run
+#ifdef NL_HAS_SSE2
+		const __m128i	zero = _mm_setzero_si128();
+		while (last - first >= 16)
+		{
+			__m128i	chars = _mm_loadu_si128((const __m128i*)first);
+			if (_mm_movemask_epi8(chars) != 0)
+				break;
+			_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(chars, zero));
+			_mm_storeu_si128((__m128i*)(out+8), _mm_unpackhi_epi8(chars, zero));
+			first += 16;
+			out += 16;
+		}
+#else
+		while (last - first >= 8)
+		{
+			uint64	chars;
+			memcpy(&chars, first, sizeof(chars));
+			if ((chars & UINT64_CONSTANT(0x8080808080808080)) != 0)
+				break;
+			for (uint i=0; i<8; ++i)
+				out[i] = first[i];
+			first += 8;
+			out += 8;
+		}
+#endif
+		if (first == last)
+			break;
+
+		// One character
+		ucchar	code = *first++;
+		uint	iterations;
+		if (code < 0x80)
+		{
+			*out++ = code;
+			continue;
+		}
+		else if ((code & 0xFE) == 0xFC)
+		{
+			code &= 0x01;
+			iterations = 5;
+		}
+		else if ((code & 0xFC) == 0xF8)
+		{
+			code &= 0x03;
+			iterations = 4;
+		}
+		else if ((code & 0xF8) == 0xF0)
+		{
+			code &= 0x07;
+			iterations = 3;
+		}
+		else if ((code & 0xF0) == 0xE0)
+		{
+			code &= 0x0F;
+			iterations = 2;
+		}
+		else if ((code & 0xE0) == 0xC0)
+		{
+			code &= 0x1F;
+			iterations = 1;
+		}
+		else
+		{
+			return InvalidUtf8;
+		}
+
+		if ((uint)(last - first) < iterations)
+			return InvalidUtf8;
+		for (uint i=0; i<iterations; ++i)
+		{
+			uint8	ch = *first++;
+			if ((ch & 0xC0) != 0x80)
+				return InvalidUtf8;
+			code <<= 6;
+			code |= (ucchar)(ch & 0x3F);
+		}
+		*out++ = code;
+	}
+
+	return (uint)(out - dest);
+}
+
+// ***************************************************************************
+
+uint		convertUtf16ToUtf8 (const ucchar *src, uint size, char *dest)
+{
+	const ucchar	*first = src;
+	const ucchar	*last = src + size;
+	uint8			*out = (uint8*)dest;
+
+	while (first != last)
+	{
+		// ASCII run
+#ifdef NL_HAS_SSE2
+		const __m128i	zero = _mm_setzero_si128();
+		const __m128i	highBits = _mm_set1_epi16((short)0xFF80);
+		while (last - first >= 8)
+		{
+			__m128i	chars = _mm_loadu_si128((const __m128i*)first);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, highBits), zero)) != 0xFFFF)
+				break;
+			_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(chars, chars));
+			first += 8;
+			out += 8;
+		}
+#else
+		while (last - first >= 4)
+		{
+			uint64	chars;
+			memcpy(&chars, first, sizeof(chars));
+			if ((chars & UINT64_CONSTANT(0xFF80FF80FF80FF80)) != 0)
+				break;
+			for (uint i=0; i<4; ++i)
+				out[i] = (uint8)first[i];
+			first += 4;
+			out += 4;
+		}
+#endif
+		if (first == last)
+			break;
+
+		// One character
+		ucchar	c = *first++;
+		if (c < 0x80)
+		{
+			*out++ = (uint8)c;
+		}
+		else if (c < 0x800)
+		{
+			*out++ = (uint8)(0xC0 | (c >> 6));
+			*out++ = (uint8)(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			*out++ = (uint8)(0xE0 | (c >> 12));
+			*out++ = (uint8)(0x80 | ((c >> 6) & 0x3F));
+			*out++ = (uint8)(0x80 | (c & 0x3F));
+		}
+	}
+
+	return (uint)(out - (uint8*)dest);
+}
+
 // Uppercase to lowercase 16 bits unicode. This table must be sorted. First entry must be unique.
 static const ucchar UnicodeUpperToLower[]=
 {
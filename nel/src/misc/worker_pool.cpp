@@ -0,0 +1,192 @@
+/** \file worker_pool.cpp
+ * A pool of threads which run jobs
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdmisc.h"
+
+#include "nel/misc/worker_pool.h"
+#include "nel/misc/thread.h"
+
+using namespace std;
+
+namespace NLMISC
+{
+
+NLMISC_SAFE_SINGLETON_IMPL(CWorkerPool);
+
+
+// ***************************************************************************
+class CWorkerPool::CWorkerThread : public IRunnable
+{
+public:
+	CWorkerThread (CWorkerPool *pool) : _Pool (pool) { }
+
+	virtual void	run ()
+	{
+		_Pool->runJobs ();
+	}
+
+	virtual void	getName (std::string &result) const
+	{
+		result = "CWorkerPool::CWorkerThread";
+	}
+
+private:
+	CWorkerPool		*_Pool;
+};
+
+
+// ***************************************************************************
+CWorkerPool::CWorkerPool () : _NumWaiting (0), _Exit (false)
+{
+}
+
+// ***************************************************************************
+CWorkerPool::~CWorkerPool ()
+{
+	_Condition.enter ();
+	nlassert (_Jobs.empty ());
+	_Exit = true;
+	_Condition.notifyAll ();
+	_Condition.leave ();
+
+	for (uint i=0; i<_Threads.size (); i++)
+	{
+		_Threads[i]->wait ();
+		delete _Threads[i];
+		delete _Workers[i];
+	}
+}
+
+// ***************************************************************************
+void CWorkerPool::terminate ()
+{
+	if (_Instance != NULL)
+	{
+		INelContext::getInstance ().releaseSingletonPointer ("CWorkerPool", _Instance);
+		delete _Instance;
+		_Instance = NULL;
+	}
+}
+
+// ***************************************************************************
+void CWorkerPool::reserveThreads (uint numThreads)
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	while (_Threads.size () < numThreads)
+	{
+		_Workers.push_back (new CWorkerThread (this));
+		_Threads.push_back (IThread::create (_Workers.back ()));
+		_Threads.back ()->start ();
+	}
+}
+
+// ***************************************************************************
+uint CWorkerPool::getNumThreads ()
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	return (uint)_Threads.size ();
+}
+
+// ***************************************************************************
+void CWorkerPool::addJob (IWorkerJob *job, CWorkerJobGroup &group)
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	CJob newJob;
+	newJob.Job = job;
+	newJob.Group = &group;
+	_Jobs.push_back (newJob);
+	group._NumPending++;
+
+	// Only the workers wait for a job: wake one of them, unless a thread in wait() could get the notification
+	if (_NumWaiting == 0)
+		_Condition.notifyOne ();
+	else
+		_Condition.notifyAll ();
+}
+
+// ***************************************************************************
+void CWorkerPool::wait (CWorkerJobGroup &group)
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	while (group._NumPending != 0)
+	{
+		// Run the jobs of the group not started yet
+		std::deque<CJob>::iterator it;
+		for (it = _Jobs.begin (); it != _Jobs.end (); ++it)
+		{
+			if (it->Group == &group)
+				break;
+		}
+		if (it != _Jobs.end ())
+		{
+			CJob job = *it;
+			_Jobs.erase (it);
+			runJob (job);
+			continue;
+		}
+
+		// Wait for the jobs run by the workers
+		_NumWaiting++;
+		_Condition.wait ();
+		_NumWaiting--;
+	}
+}
+
+// ***************************************************************************
+bool CWorkerPool::isFinished (const CWorkerJobGroup &group)
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	return group._NumPending == 0;
+}
+
+// ***************************************************************************
+void CWorkerPool::runJob (const CJob &job)
+{
+	_Condition.leave ();
+	job.Job->run ();
+	_Condition.enter ();
+
+	job.Group->_NumPending--;
+	if (job.Group->_NumPending == 0 && _NumWaiting != 0)
+		_Condition.notifyAll ();
+}
+
+// ***************************************************************************
+void CWorkerPool::runJobs ()
+{
+	CAutoMutex<CCondition> lock (_Condition);
+	for (;;)
+	{
+		while (_Jobs.empty () && !_Exit)
+			_Condition.wait ();
+		if (_Jobs.empty ())
+			break;
+
+		CJob job = _Jobs.front ();
+		_Jobs.pop_front ();
+		runJob (job);
+	}
+}
+
+
+} // NLMISC
@@ -216,6 +216,7 @@ static void sigHandler(int Sig)
 				else
 				{
 					nlinfo ("SERVICE: Signal already received, launch the brutal exit");
+					CLog::flushAsync (true);
 					exit (EXIT_FAILURE);
 				}
 				break;
@@ -732,6 +733,32 @@ sint IService::main (const char *serviceShortName, const char *serviceLongName,
 			CommandLog.addDisplayer (&fd, true);
 		}
 
+		//
+		// Asynchronous logs: the debug, info and warning lines are displayed by a writer thread
+		//
+
+		if ((var = ConfigFile.getVarPtr ("AsyncLog")) != NULL && var->asInt() == 1)
+		{
+			uint ringSize = 1024;
+			if ((var = ConfigFile.getVarPtr ("AsyncLogRingSize")) != NULL)
+				ringSize = var->asInt();
+
+			// "drop" (default), "block" or "display"
+			CLog::TAsyncOverflow overflow = CLog::AsyncDrop;
+			if ((var = ConfigFile.getVarPtr ("AsyncLogOverflow")) != NULL)
+			{
+				if (var->asString() == "block")
+					overflow = CLog::AsyncBlock;
+				else if (var->asString() == "display")
+					overflow = CLog::AsyncDisplay;
+			}
+
+			DebugLog->setAsync (true);
+			InfoLog->setAsync (true);
+			WarningLog->setAsync (true);
+			CLog::startAsyncWriter (ringSize, overflow);
+		}
+
 		bool dontUseStdIn= (ConfigFile.exists ("DontUseStdIn")) && (ConfigFile.getVar("DontUseStdIn").asInt() == 1);
 		if (!dontUseStdIn)
 		{
@@ -1608,6 +1635,9 @@ sint IService::main (const char *serviceShortName, const char *serviceLongName,
 
 	nlinfo ("SERVICE: Service ends");
 
+	// display the last asynchronous lines
+	CLog::stopAsyncWriter ();
+
 	return ExitSignalAsked?100+ExitSignalAsked:getExitStatus ();
 }
 
@@ -28,6 +28,7 @@
 #include "nel/misc/async_file_manager.h"
 #include "driver/buffer.h"
 #include "audio_mixer_user.h"
+#include "sample_bank.h"
 
 using namespace NLMISC;
 
@@ -64,6 +65,12 @@ void	CAsyncFileManagerSound::loadWavFile(IBuffer *pdestBuffer, const std::string
 }
 
 
+void	CAsyncFileManagerSound::loadSampleBankSample(CSampleBank *bank, uint index)
+{
+	CAsyncFileManager::getInstance().addLoadTask(new CLoadSampleBankSample(bank, index));
+}
+
+
 class CCancelLoadWavFile : public CAsyncFileManager::ICancelCallback
 {
 	std::string	_Filename;
@@ -213,5 +220,10 @@ void CAsyncFileManagerSound::CLoadWavFile::run (void)
 }
 
 
+void CAsyncFileManagerSound::CLoadSampleBankSample::run (void)
+{
+	_Bank->loadSampleData(_Index);
+}
+
 
 } // NLSOUND
@@ -27,6 +27,7 @@ namespace NLSOUND
 {
 
 class IBuffer;
+class CSampleBank;
 
 
 /**
@@ -48,6 +49,9 @@ public:
 	void	loadWavFile(IBuffer *pdestBuffer, const std::string &filename);
 	void	cancelLoadWaveFile(const std::string &filename);
 
+	/// Load the data of a sample of a sample bank, see CSampleBank::loadSampleData()
+	void	loadSampleBankSample(CSampleBank *bank, uint index);
+
 	// Do not use these methods with the bigfile manager
 	void loadFile (const std::string &fileName, uint8 **pPtr);
 	void loadFiles (const std::vector<std::string> &vFileNames, const std::vector<uint8**> &vPtrs);
@@ -78,6 +82,17 @@ private:
 		void run (void);
 	};
 
+	// Load task for a sample of a sample bank.
+	class CLoadSampleBankSample : public NLMISC::IRunnable
+	{
+		CSampleBank	*_Bank;
+		uint		_Index;
+
+	public:
+		CLoadSampleBankSample (CSampleBank *bank, uint index) : _Bank(bank), _Index(index) {}
+		void run (void);
+	};
+
 };
 
 } // NLSOUND
@@ -347,9 +347,6 @@ void CAudioMixerUser::init(uint maxTrack, bool useEax, bool useADPCM, IProgressC
 		{
 			_profile(( "AM: DRIVER: %s", _SoundDriver->getDllName().c_str() ));
 			
-			// the device to use, default for now
-			string driverDevice = "";
-			
 			// the options to init the driver
 			sint driverOptions = ISoundDriver::OptionHasBufferStreaming;
 			if (_UseEax) driverOptions |= ISoundDriver::OptionEnvironmentEffects;
@@ -359,7 +356,7 @@ void CAudioMixerUser::init(uint maxTrack, bool useEax, bool useADPCM, IProgressC
 			if (_AutoLoadSample) driverOptions |= ISoundDriver::OptionLocalBufferCopy;
 			
 			// init the driver with selected device and needed options
-			_SoundDriver->init(driverDevice, (ISoundDriver::TSoundOptions)driverOptions);
+			_SoundDriver->init(_DriverDevice, (ISoundDriver::TSoundOptions)driverOptions);
 			
 			// verify the options, OptionHasBufferStreaming not checked
 			if (_UseEax && !_SoundDriver->getOption(ISoundDriver::OptionEnvironmentEffects))
@@ -1148,6 +1145,18 @@ void	CAudioMixerUser::bufferUnloaded(IBuffer *buffer)
 	}
 }
 
+// ******************************************************************
+bool	CAudioMixerUser::isBufferPlaying(IBuffer *buffer) const
+{
+	for (uint i = 0; i < _Tracks.size(); ++i)
+	{
+		CTrack *track = _Tracks[i];
+		if (track && track->getSource() && track->getSource()->getBuffer() == buffer)
+			return true;
+	}
+	return false;
+}
+
 
 // ******************************************************************
 
@@ -2109,6 +2118,12 @@ void			CAudioMixerUser::getLoadedSampleBankInfo(std::vector<std::pair<std::strin
 	CSampleBank::getLoadedSampleBankInfo(result);
 }
 
+void			CAudioMixerUser::setSampleBankBudget(uint32 budget, bool decodeADPCM)
+{
+	CSampleBank::setDecodeADPCM(decodeADPCM);
+	CSampleBank::setResidentBudget(budget);
+}
+
 
 
 void CAudioMixerUser::setListenerPos (const NLMISC::CVector &pos)
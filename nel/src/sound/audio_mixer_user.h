@@ -181,6 +181,7 @@ public:
 	virtual void				reloadSampleBanks(bool async);
 	virtual uint32				getLoadedSampleSize();
 	virtual void				getLoadedSampleBankInfo(std::vector<std::pair<std::string, uint> > &result);
+	virtual void				setSampleBankBudget(uint32 budget, bool decodeADPCM);
 
 
 
@@ -267,6 +268,7 @@ public:
 	/// Set the global path to the sample banks
 	virtual void				setSamplePath(const std::string& path);
 	virtual void				setPackedSheetOption(const std::string &path, bool update);
+	virtual void				setDriverDevice(const std::string &device)	{ _DriverDevice = device; }
 	std::string					&getPackedSheetPath()						{return _PackedSheetPath; }
 	bool						getPackedSheetUpdate()						{return _UpdatePackedSheet; }
 
@@ -298,6 +300,8 @@ public:
 	void						unregisterBufferAssoc(CSound *sound, IBuffer *buffer);
 
 	void						bufferUnloaded(IBuffer *buffer);
+	/// Return true if a track is playing the buffer.
+	bool						isBufferPlaying(IBuffer *buffer) const;
 
 	void						setBackgroundFlags(const TBackgroundFlags &backgroundFlags);
 	void						setBackgroundFilterFades(const TBackgroundFilterFades &backgroundFilterFades);
@@ -542,6 +546,8 @@ private:
 	std::string					_PackedSheetPath;
 	/// A flag to update or not the packed sheet
 	bool						_UpdatePackedSheet;
+	/// The device the driver is initialized with
+	std::string					_DriverDevice;
 
 	/// Assoc between buffer and source. Used when buffers are unloaded.
 	TBufferToSourceContainer	_BufferToSources;
@@ -174,6 +174,9 @@ std::map<std::string, CSoundGroupSerializer> Container;
 CClusteredSound::CClusteredSound()
 :	_Scene(0),
 	_RootCluster(0),
+	_ClusterSystemDate(0),
+	_TraversalValid(false),
+	_RetraverseDistance(0.5f),
 	_LastEnv(CStringMapper::emptyId()),
 	_LastEnvSize(-1.0f) // size goes from 0.0f to 100.0f
 {
@@ -207,6 +210,9 @@ void CClusteredSound::init(NL3D::CScene *scene, float portalInterpolate, float m
 	}
 	else
 		_RootCluster = 0;
+
+	// the graph has changed
+	_TraversalValid = false;
 }
 
 void CClusteredSound::update(const CVector &listenerPos, const CVector &/* view */, const CVector &/* up */)
@@ -227,25 +233,39 @@ void CClusteredSound::update(const CVector &listenerPos, const CVector &/* view
 	CClipTrav	&clipTrav = _Scene->getClipTrav ();
 
 	// Retreive the list of cluster where the listener is
-	vector<CCluster*> vCluster;
-	clipTrav.fullSearch (vCluster, listenerPos);
-
+	_ClusterSearch.clear();
+	clipTrav.fullSearch (_ClusterSearch, listenerPos);
+
+	// the audible clusters only change when the listener enter or leave a cluster, when
+	// the cluster system is modified, or when the listener moves enough inside its clusters
+	if (!_TraversalValid
+		|| _ClusterSearch != _ListenerClusters
+		|| clipTrav.ClusterSystemDate != _ClusterSystemDate
+		|| (listenerPos - _TraversalPos).sqrnorm() > _RetraverseDistance*_RetraverseDistance)
+	{
+		_ListenerClusters.swap(_ClusterSearch);
+		_TraversalPos = listenerPos;
+		_ClusterSystemDate = clipTrav.ClusterSystemDate;
+		_TraversalValid = true;
 
-	// reset the audible cluster map
-	_AudibleClusters.clear();
+		// reset the audible cluster map
+		_AudibleClusters.clear();
 
-	// create the initial travesal context
-	CSoundTravContext stc(listenerPos, false, false);
+		// create the initial travesal context
+		CSoundTravContext stc(listenerPos, false, false);
 
-	// and start the cluster traversal to find out what cluster is audible and how we ear it
-	soundTraverse(vCluster, stc);
+		// and start the cluster traversal to find out what cluster is audible and how we ear it
+		soundTraverse(_ListenerClusters, stc);
+	}
+	const vector<CCluster*> &vCluster = _ListenerClusters;
 
 	//-----------------------------------------------------
 	// update the clustered sound (create and stop sound)
 	//-----------------------------------------------------
 
 //	std::hash_map<uint, CClusterSound>		newSources;
-	TClusterSoundCont		newSources;
+	TClusterSoundCont		&newSources = _NewSources;
+	nlassert(newSources.empty());
 
 	{
 		// fake the distance for all playing source
@@ -322,7 +342,7 @@ void CClusteredSound::update(const CVector &listenerPos, const CVector &/* view
 	}
 	// check for source to stop
 	{
-		TClusterSoundCont	oldSources;
+		TClusterSoundCont	&oldSources = _OldSources;
 		oldSources.swap(_Sources);
 
 		TClusterSoundCont::iterator first(newSources.begin()), last(newSources.end());
@@ -341,6 +361,7 @@ void CClusteredSound::update(const CVector &listenerPos, const CVector &/* view
 			delete cs.Source;
 			oldSources.erase(oldSources.begin());
 		}
+		newSources.clear();
 	}
 
 	// update the environment effect (if any)
@@ -402,7 +423,8 @@ void CClusteredSound::soundTraverse(const std::vector<CCluster *> &clusters, CSo
 {
 	H_AUTO(NLSOUND_soundTraverse)
 //	std::map<CCluster*, CSoundTravContext>	nextTraverse;
-	std::vector<std::pair<const CCluster*, CSoundTravContext> >	curClusters;
+	TClusterTravContextVector	&curClusters = _CurrentTraversalStep;
+	nlassert(curClusters.empty());
 	CVector		realListener (travContext.ListenerPos);
 
 	_AudioPath.clear();
@@ -170,6 +170,8 @@ public:
 
 	/// Container for the next traversal step
 	typedef std::map<NL3D::CCluster*, CSoundTravContext>	TClusterTravContextMap;
+	/// Container for the current traversal step
+	typedef std::vector<std::pair<const NL3D::CCluster*, CSoundTravContext> >	TClusterTravContextVector;
 
 
 	/// Constructor
@@ -184,9 +186,18 @@ public:
 	void		init(NL3D::CScene *scene, float portalInterpolate, float maxEarDistance, float minGain);
 
 	/** Update the cluster sound system.
+	 *	The cluster graph is traversed again only if the listener has entered or left a cluster, if the
+	 *	cluster system has changed or if the listener has moved more than the retraverse distance since
+	 *	the last traversal. Else, the audible clusters of the last traversal are kept.
 	 */
 	void		update(const NLMISC::CVector &listenerPos, const NLMISC::CVector &view, const NLMISC::CVector &up);
 
+	/** Set the distance the listener must move inside the same clusters before the graph is traversed again.
+	 *	0 to traverse it again each time the listener moves. Default is 0.5 meter.
+	 */
+	void		setRetraverseDistance(float distance) { _RetraverseDistance = distance; }
+	float		getRetraverseDistance() const { return _RetraverseDistance; }
+
 	NL3D::CCluster	*getRootCluster();
 
 
@@ -249,6 +260,24 @@ private:
 	TClusterStatusMap		_AudibleClusters;
 	/// The cluster for the next travesal step
 	TClusterTravContextMap	_NextTraversalStep;
+	/// The cluster of the current traversal step, kept to reuse its memory
+	TClusterTravContextVector	_CurrentTraversalStep;
+
+	/// \name Last traversal state
+	//@{
+	/// The clusters the listener was in
+	std::vector<NL3D::CCluster*>	_ListenerClusters;
+	/// The clusters the listener is in, kept to reuse its memory
+	std::vector<NL3D::CCluster*>	_ClusterSearch;
+	/// The listener position
+	NLMISC::CVector			_TraversalPos;
+	/// The cluster system date (see CClipTrav::ClusterSystemDate)
+	uint32					_ClusterSystemDate;
+	/// False if the graph must be traversed at next update
+	bool					_TraversalValid;
+	/// The distance to move before a new traversal
+	float					_RetraverseDistance;
+	//@}
 	/// The last setted environement.
 	NLMISC::TStringId				_LastEnv;
 	/// The last set environment size.
@@ -259,6 +288,9 @@ private:
 	typedef CHashMap<NLMISC::TStringId, CClusterSound, NLMISC::CStringIdHashMapTraits>	TClusterSoundCont;
 	/// The current cluster playing source indexed with sound group id
 	TClusterSoundCont		_Sources;
+	/// Temporary containers of update(), kept to reuse their memory
+	TClusterSoundCont		_NewSources;
+	TClusterSoundCont		_OldSources;
 
 	typedef CHashMap<NLMISC::TStringId, NLMISC::TStringId, NLMISC::CStringIdHashMapTraits> TStringStringMap;
 	/// The sound_group to sound assoc
@@ -24,6 +24,7 @@
 #include "buffer.h"
 #include <nel/misc/fast_mem.h>
 #include <nel/misc/stream.h>
+#include <algorithm>
 
 namespace NLSOUND {
 	
@@ -269,78 +270,74 @@ void IBuffer::encodeADPCM(const sint16 *indata, uint8 *outdata, uint nbSample, T
 	state.StepIndex = uint8(index);
 }
 
-void IBuffer::decodeADPCM(const uint8 *indata, sint16 *outdata, uint nbSample, TADPCMState &state)
+sint32 IBuffer::_DecodeDiffTable[89 * 16];
+uint8 IBuffer::_DecodeIndexTable[89 * 16];
+bool IBuffer::_DecodeTablesInitialized = IBuffer::initDecodeTables();
+
+bool IBuffer::initDecodeTables()
 {
-    const uint8 *inp = indata;				/* Input buffer pointer */
-    sint16 *outp = outdata;				/* output buffer pointer */
-    int sign;							/* Current adpcm sign bit */
-    int delta;							/* Current adpcm output value */
-    int valpred = state.PreviousSample;	/* Predicted value */
-    int vpdiff;							/* Current change to valpred */
-    int index = state.StepIndex;		/* Current step change index */
-    int step = _StepsizeTable[index];	/* Stepsize */
-    uint8 inputbuffer = 0;				/* place to keep next 4-bit value */
-    int bufferstep = 0;					/* toggle between inputbuffer/input */
-
-    for ( ; nbSample > 0 ; nbSample-- )
+	// The difference and the next index only depend on the current index and the 4-bit code,
+	// so the per sample work of the decoder is two table lookups and a clamp.
+	for (uint index = 0; index < 89; ++index)
 	{
-
-		/* Step 1 - get the delta value */
-		if ( bufferstep )
-		{
-			delta = inputbuffer & 0xf;
-		}
-		else
+		const sint step = (sint)_StepsizeTable[index];
+		for (uint delta = 0; delta < 16; ++delta)
 		{
-			inputbuffer = *inp++;
-			delta = (inputbuffer >> 4) & 0xf;
+			/* Computes 'vpdiff = (delta+0.5)*step/4', see the encoder */
+			sint vpdiff = step >> 3;
+			if (delta & 4) vpdiff += step;
+			if (delta & 2) vpdiff += step >> 1;
+			if (delta & 1) vpdiff += step >> 2;
+			_DecodeDiffTable[index * 16 + delta] = (delta & 8) ? -vpdiff : vpdiff;
+
+			sint nextIndex = (sint)index + _IndexTable[delta];
+			if (nextIndex < 0) nextIndex = 0;
+			if (nextIndex > 88) nextIndex = 88;
+			_DecodeIndexTable[index * 16 + delta] = (uint8)nextIndex;
 		}
-		bufferstep = !bufferstep;
-
-		/* Step 2 - Find new index value (for later) */
-		index += _IndexTable[delta];
-		if ( index < 0 )
-			index = 0;
-		if ( index > 88 )
-			index = 88;
-
-		/* Step 3 - Separate sign and magnitude */
-		sign = delta & 8;
-		delta = delta & 7;
-
-		/* Step 4 - Compute difference and new predicted value */
-		/*
-		** Computes 'vpdiff = (delta+0.5)*step/4', but see comment
-		** in adpcm_coder.
-		*/
-		vpdiff = step >> 3;
-		if ( delta & 4 )
-			vpdiff += step;
-		if ( delta & 2 )
-			vpdiff += step>>1;
-		if ( delta & 1 )
-			vpdiff += step>>2;
+	}
+	return true;
+}
 
-		if ( sign )
-			valpred -= vpdiff;
-		else
-			valpred += vpdiff;
+void IBuffer::decodeADPCM(const uint8 *indata, sint16 *outdata, uint nbSample, TADPCMState &state)
+{
+	// Each sample depends on the previous one, the decoding can't be done in parallel
+	// inside a stream: it is table driven instead, without branches but the clamp.
+	const uint8 *inp = indata;
+	sint16 *outp = outdata;
+	sint valpred = state.PreviousSample;
+	uint index = state.StepIndex;
+
+	// two samples per input byte, high nibble first
+	for (; nbSample >= 2; nbSample -= 2)
+	{
+		const uint8 inputbuffer = *inp++;
 
-		/* Step 5 - clamp output value */
-		if ( valpred > 32767 )
-			valpred = 32767;
-		else if ( valpred < -32768 )
-			valpred = -32768;
+		uint code = index * 16 + (inputbuffer >> 4);
+		valpred += _DecodeDiffTable[code];
+		valpred = std::max(-32768, std::min(32767, valpred));
+		index = _DecodeIndexTable[code];
+		*outp++ = sint16(valpred);
 
-		/* Step 6 - Update step value */
-		step = _StepsizeTable[index];
+		code = index * 16 + (inputbuffer & 0xf);
+		valpred += _DecodeDiffTable[code];
+		valpred = std::max(-32768, std::min(32767, valpred));
+		index = _DecodeIndexTable[code];
+		*outp++ = sint16(valpred);
+	}
 
-		/* Step 7 - Output value */
+	// odd sample count, the low nibble of the last byte is not used
+	if (nbSample)
+	{
+		const uint code = index * 16 + (*inp >> 4);
+		valpred += _DecodeDiffTable[code];
+		valpred = std::max(-32768, std::min(32767, valpred));
+		index = _DecodeIndexTable[code];
 		*outp++ = sint16(valpred);
-    }
+	}
 
-    state.PreviousSample = sint16(valpred);
-    state.StepIndex = uint8(index);
+	state.PreviousSample = sint16(valpred);
+	state.StepIndex = uint8(index);
 }
 
 static bool checkFourCC(const uint8 *left, const char *right)
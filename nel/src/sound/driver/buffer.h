@@ -130,7 +130,10 @@ public:
 	};
 	/// Encode 16bit Mono PCM buffer into Mono ADPCM.
 	static void encodeADPCM(const sint16 *indata, uint8 *outdata, uint nbSample, TADPCMState &state);
-	/// Decode Mono ADPCM into 16bit Mono PCM.
+	/** Decode Mono ADPCM into 16bit Mono PCM.
+	 *	The samples can be decoded in several calls with the same state, each call must then decode
+	 *	an even number of samples (but the last one) as a call starts on a byte boundary.
+	 */
 	static void decodeADPCM(const uint8 *indata, sint16 *outdata, uint nbSample, TADPCMState &state);	
 	/// Read a wav file. Data type uint8 is used as unspecified buffer format.
 	static bool readWav(const uint8 *wav, uint size, std::vector<uint8> &result, TBufferFormat &bufferFormat, uint8 &channels, uint8 &bitsPerSample, uint32 &frequency);
@@ -145,6 +148,11 @@ public:
 private:
 	static const sint _IndexTable[16];
 	static const uint _StepsizeTable[89];
+	/// Decoding tables, indexed by (step index * 16 + code): difference with the previous sample and next step index
+	static sint32 _DecodeDiffTable[89 * 16];
+	static uint8 _DecodeIndexTable[89 * 16];
+	static bool _DecodeTablesInitialized;
+	static bool initDecodeTables();
 	//@}
 	
 protected:
@@ -0,0 +1,195 @@
+/** \file buffer_software.cpp
+ * Software sound driver buffer
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdsoftware.h"
+#include "buffer_software.h"
+
+#include <nel/misc/fast_mem.h>
+
+#include "sound_driver_software.h"
+
+using namespace NLMISC;
+
+namespace NLSOUND {
+
+CBufferSoftware::CBufferSoftware() :
+	IBuffer(), _Name(NULL), _Format(FormatUnknown), _Channels(0), _BitsPerSample(0), _Frequency(0),
+	_StorageMode(IBuffer::StorageAuto), _Size(0), _NbFrame(0)
+{
+	
+}
+
+CBufferSoftware::~CBufferSoftware()
+{
+	
+}
+
+void CBufferSoftware::setName(NLMISC::TStringId bufferName)
+{
+	_Name = bufferName;
+}
+
+NLMISC::TStringId CBufferSoftware::getName() const
+{
+	return _Name;
+}
+
+void CBufferSoftware::setFormat(TBufferFormat format, uint8 channels, uint8 bitsPerSample, uint32 frequency)
+{
+	_Format = format;
+	_Channels = channels;
+	_BitsPerSample = bitsPerSample;
+	_Frequency = frequency;
+}
+
+void CBufferSoftware::getFormat(TBufferFormat &format, uint8 &channels, uint8 &bitsPerSample, uint32 &frequency) const
+{
+	format = _Format;
+	channels = _Channels;
+	bitsPerSample = _BitsPerSample;
+	frequency = _Frequency;
+}
+
+void CBufferSoftware::setStorageMode(TStorageMode storageMode)
+{
+	_StorageMode = storageMode;
+}
+
+IBuffer::TStorageMode CBufferSoftware::getStorageMode()
+{
+	return _StorageMode;
+}
+
+uint8 *CBufferSoftware::lock(uint capacity)
+{
+	nlassert((_Format != FormatUnknown) && (_Frequency != 0));
+
+	_Data.resize(capacity);
+	if (_Size > capacity) _Size = capacity;
+	return _Data.empty() ? NULL : &_Data[0];
+}
+
+bool CBufferSoftware::unlock(uint size)
+{
+	if (size > _Data.size())
+	{
+		_Size = (uint)_Data.size();
+		return false;
+	}
+
+	bool ok = convert(_Data.empty() ? NULL : &_Data[0], size);
+	
+	if (_StorageMode != IBuffer::StorageSoftware && !CSoundDriverSoftware::getInstance()->getOption(ISoundDriver::OptionLocalBufferCopy))
+		contReset(_Data);
+
+	return ok;
+}
+
+bool CBufferSoftware::fill(const uint8 *src, uint size)
+{
+	nlassert((_Format != FormatUnknown) && (_Frequency != 0));
+
+	if (CSoundDriverSoftware::getInstance()->getOption(ISoundDriver::OptionLocalBufferCopy))
+	{
+		_Data.resize(size);
+		if (size) CFastMem::memcpy(&_Data[0], src, size);
+	}
+	else
+	{
+		contReset(_Data);
+	}
+
+	return convert(src, size);
+}
+
+bool CBufferSoftware::convert(const uint8 *src, uint size)
+{
+	_Size = size;
+	_NbFrame = 0;
+	contReset(_Samples);
+	if (!size) return true;
+
+	uint nbSample;
+	if (_Format == FormatDviAdpcm && _Channels == 1)
+	{
+		nbSample = size * 2;
+		_Samples.resize(nbSample);
+		TADPCMState state;
+		state.PreviousSample = 0;
+		state.StepIndex = 0;
+		decodeADPCM(src, &_Samples[0], nbSample, state);
+	}
+	else if (_Format == FormatPcm && _BitsPerSample == 16)
+	{
+		nbSample = size / 2;
+		_Samples.resize(nbSample);
+		CFastMem::memcpy(&_Samples[0], src, nbSample * 2);
+	}
+	else if (_Format == FormatPcm && _BitsPerSample == 8)
+	{
+		nbSample = size;
+		_Samples.resize(nbSample);
+		for (uint i = 0; i < nbSample; ++i)
+			_Samples[i] = (sint16)(((sint)src[i] - 128) << 8);
+	}
+	else
+	{
+		nlwarning("SOFT: Unsupported buffer format %u, %u channels, %u bits", (uint32)_Format, (uint32)_Channels, (uint32)_BitsPerSample);
+		return false;
+	}
+
+	if (_Channels != 1 && _Channels != 2)
+	{
+		nlwarning("SOFT: Unsupported number of channels %u", (uint32)_Channels);
+		contReset(_Samples);
+		return false;
+	}
+	_NbFrame = nbSample / _Channels;
+	return true;
+}
+
+uint CBufferSoftware::getSize() const
+{
+	return _Size;
+}
+
+float CBufferSoftware::getDuration() const
+{
+	if (_Frequency == 0)
+		return 0.0f;
+	return (float)_NbFrame * 1000.0f / (float)_Frequency;
+}
+
+bool CBufferSoftware::isStereo() const
+{
+	return _Channels > 1;
+}
+
+bool CBufferSoftware::isBufferLoaded() const
+{
+	return _NbFrame > 0;
+}
+
+} // NLSOUND
+
+/* end of file */
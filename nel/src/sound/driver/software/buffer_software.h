@@ -0,0 +1,114 @@
+/** \file buffer_software.h
+ * Software sound driver buffer
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_BUFFER_SOFTWARE_H
+#define NL_BUFFER_SOFTWARE_H
+#include <nel/misc/types_nl.h>
+
+namespace NLSOUND {
+
+/**
+ * Software buffer.
+ *
+ * The data is converted to 16 bits PCM when the buffer is filled, so the mixer only reads
+ * one format. ADPCM buffers are decoded at that time with IBuffer::decodeADPCM().
+ * The original data is kept only for StorageSoftware buffers or with OptionLocalBufferCopy.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CBufferSoftware : public IBuffer
+{
+public:
+	/// Constructor
+	CBufferSoftware();
+	/// Destructor
+	virtual ~CBufferSoftware();
+
+	/// Set the name of the buffer
+	virtual void setName(NLMISC::TStringId bufferName);
+	/// Return the name of this buffer
+	virtual NLMISC::TStringId getName() const;
+
+	/// Set the sample format. (channels = 1, 2; bitsPerSample = 8, 16 or 4 for ADPCM; frequency = samples per second, 44100, ...)
+	virtual void setFormat(TBufferFormat format, uint8 channels, uint8 bitsPerSample, uint32 frequency);
+	/// Return the sample format informations.
+	virtual void getFormat(TBufferFormat &format, uint8 &channels, uint8 &bitsPerSample, uint32 &frequency) const;
+	/// Set the storage mode of this buffer, call before filling this buffer.
+	virtual void setStorageMode(TStorageMode storageMode = IBuffer::StorageAuto);
+	/// Get the storage mode of this buffer.
+	virtual TStorageMode getStorageMode();
+
+	/// Get a writable pointer to the buffer of specified size. Call setStorageMode() and setFormat() first.
+	virtual uint8 *lock(uint capacity);
+	/// Notify that you are done writing to this buffer, the data is converted. Returns true if ok.
+	virtual bool unlock(uint size);
+	/// Copy the data with specified size into the buffer. Returns true if ok.
+	virtual bool fill(const uint8 *src, uint size);
+
+	/// Return the size of the buffer, in bytes, in the format it has been filled with.
+	virtual uint getSize() const;
+	/// Return the duration (in ms) of the sample in the buffer.
+	virtual float getDuration() const;
+	/// Return true if the buffer is stereo, false if mono.
+	virtual bool isStereo() const;
+	/// Return true if the buffer is loaded. Used for async load/unload.
+	virtual bool isBufferLoaded() const;
+
+	/// \name Mixer access
+	//@{
+	/// The 16 bits PCM samples, interleaved if stereo. NULL if the buffer is empty.
+	const sint16 *getSamples() const { return _Samples.empty() ? NULL : &_Samples[0]; }
+	/// Number of frames (one sample per channel)
+	uint getNbFrame() const { return _NbFrame; }
+	uint8 getChannels() const { return _Channels; }
+	uint32 getFrequency() const { return _Frequency; }
+	//@}
+
+private:
+
+	/// Convert the data to 16 bits PCM
+	bool convert(const uint8 *src, uint size);
+
+	NLMISC::TStringId		_Name;
+	TBufferFormat			_Format;
+	uint8					_Channels;
+	uint8					_BitsPerSample;
+	uint32					_Frequency;
+	TStorageMode			_StorageMode;
+
+	/// The original data, for lock() and the local copy
+	std::vector<uint8>		_Data;
+	/// Size of the original data
+	uint					_Size;
+
+	/// The converted data
+	std::vector<sint16>		_Samples;
+	uint					_NbFrame;
+};
+
+} // NLSOUND
+
+#endif // NL_BUFFER_SOFTWARE_H
+
+/* End of buffer_software.h */
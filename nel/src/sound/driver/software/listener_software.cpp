@@ -0,0 +1,99 @@
+/** \file listener_software.cpp
+ * Software sound driver listener
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdsoftware.h"
+#include "listener_software.h"
+
+using namespace NLMISC;
+
+namespace NLSOUND {
+
+CListenerSoftware::CListenerSoftware() : IListener(), 
+	_Pos(CVector::Null), _Velocity(CVector::Null), _Front(CVector::J), _Up(CVector::K), _Right(CVector::I), 
+	_Gain(1.0f), _DopplerFactor(1.0f), _RolloffFactor(1.0f)
+{
+	
+}
+
+CListenerSoftware::~CListenerSoftware()
+{
+	
+}
+
+void CListenerSoftware::setPos( const NLMISC::CVector& pos )
+{
+	_Pos = pos;
+}
+
+const NLMISC::CVector &CListenerSoftware::getPos() const
+{
+	return _Pos;
+}
+
+void CListenerSoftware::setVelocity( const NLMISC::CVector& vel )
+{
+	_Velocity = vel;
+}
+
+void CListenerSoftware::getVelocity( NLMISC::CVector& vel ) const
+{
+	vel = _Velocity;
+}
+
+void CListenerSoftware::setOrientation( const NLMISC::CVector& front, const NLMISC::CVector& up )
+{
+	_Front = front;
+	_Up = up;
+	_Right = front ^ up;
+	_Right.normalize();
+}
+
+void CListenerSoftware::getOrientation( NLMISC::CVector& front, NLMISC::CVector& up ) const
+{
+	front = _Front;
+	up = _Up;
+}
+
+void CListenerSoftware::setGain( float gain )
+{
+	_Gain = gain;
+}
+
+float CListenerSoftware::getGain() const
+{
+	return _Gain;
+}
+
+void CListenerSoftware::setDopplerFactor( float f )
+{
+	_DopplerFactor = f;
+}
+
+void CListenerSoftware::setRolloffFactor( float f )
+{
+	_RolloffFactor = f;
+}
+
+} // NLSOUND
+
+/* end of file */
@@ -0,0 +1,96 @@
+/** \file listener_software.h
+ * Software sound driver listener
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_LISTENER_SOFTWARE_H
+#define NL_LISTENER_SOFTWARE_H
+#include <nel/misc/types_nl.h>
+
+#include <nel/misc/singleton.h>
+
+namespace NLSOUND {
+
+/**
+ * Software sound listener. It only keeps the values, the sources read them when they are mixed.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CListenerSoftware : public IListener, public NLMISC::CManualSingleton<CListenerSoftware>
+{
+public:
+	/// Constructor
+	CListenerSoftware();
+	/// Destructor
+	virtual ~CListenerSoftware();
+
+	/// \name Listener properties
+	//@{
+	/// Set the position vector (default: (0,0,0)) (3D mode only)
+	virtual void			setPos( const NLMISC::CVector& pos );
+	/// Get the position vector
+	virtual const NLMISC::CVector	&getPos() const;
+	/// Set the velocity vector (3D mode only) (default: (0,0,0))
+	virtual void			setVelocity( const NLMISC::CVector& vel );
+	/// Get the velocity vector
+	virtual void			getVelocity( NLMISC::CVector& vel ) const;
+	/// Set the orientation vectors (3D mode only) (default: (0,1,0), (0,0,1))
+	virtual void			setOrientation( const NLMISC::CVector& front, const NLMISC::CVector& up );
+	/// Get the orientation vectors
+	virtual void			getOrientation( NLMISC::CVector& front, NLMISC::CVector& up ) const;
+	/// Set the gain (volume value inside [0 , 1]). (default: 1)
+	virtual void			setGain( float gain );
+	/// Get the gain
+	virtual float			getGain() const;
+	//@}
+
+	/// \name Global properties
+	//@{
+	/// Set the doppler factor (default: 1). The doppler effect is not rendered by this driver.
+	virtual void			setDopplerFactor( float f );
+	/// Set the rolloff factor (default: 1) to scale the distance attenuation effect
+	virtual void			setRolloffFactor( float f );
+	//@}
+
+	/// \name Mixer access
+	//@{
+	/// The right vector, front ^ up
+	const NLMISC::CVector	&getRight() const { return _Right; }
+	float					getRolloffFactor() const { return _RolloffFactor; }
+	//@}
+
+private:
+	NLMISC::CVector			_Pos;
+	NLMISC::CVector			_Velocity;
+	NLMISC::CVector			_Front;
+	NLMISC::CVector			_Up;
+	NLMISC::CVector			_Right;
+	float					_Gain;
+	float					_DopplerFactor;
+	float					_RolloffFactor;
+};
+
+} // NLSOUND
+
+#endif // NL_LISTENER_SOFTWARE_H
+
+/* End of listener_software.h */
@@ -0,0 +1,144 @@
+/** \file mix_software.cpp
+ * Mixing kernels of the software sound driver
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdsoftware.h"
+#include "mix_software.h"
+
+#ifdef NL_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace NLSOUND {
+
+// ***************************************************************************
+void CMixSoftware::clear(float *left, float *right, uint nbFrame)
+{
+	uint k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	zero= _mm_setzero_ps();
+	for (; k + 4 <= nbFrame; k+= 4)
+	{
+		_mm_storeu_ps(left + k, zero);
+		_mm_storeu_ps(right + k, zero);
+	}
+#endif
+	for (; k < nbFrame; ++k)
+	{
+		left[k]= 0.f;
+		right[k]= 0.f;
+	}
+}
+
+// ***************************************************************************
+void CMixSoftware::pcm16ToFloat(const sint16 *src, float *dest, uint nbSample)
+{
+	const float	scale= 1.f / 32768.f;
+	uint k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	s= _mm_set1_ps(scale);
+	for (; k + 8 <= nbSample; k+= 8)
+	{
+		__m128i	v= _mm_loadu_si128((const __m128i *)(src + k));
+		// sign extend the 8 samples to 32 bits
+		__m128i	lo= _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i	hi= _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dest + k, _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+		_mm_storeu_ps(dest + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+	}
+#endif
+	for (; k < nbSample; ++k)
+		dest[k]= (float)src[k] * scale;
+}
+
+// ***************************************************************************
+void CMixSoftware::mixMono(const float *src, float *left, float *right, uint nbFrame, float gainLeft, float gainRight)
+{
+	uint k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	gl= _mm_set1_ps(gainLeft);
+	__m128	gr= _mm_set1_ps(gainRight);
+	for (; k + 4 <= nbFrame; k+= 4)
+	{
+		__m128	s= _mm_loadu_ps(src + k);
+		_mm_storeu_ps(left + k, _mm_add_ps(_mm_loadu_ps(left + k), _mm_mul_ps(gl, s)));
+		_mm_storeu_ps(right + k, _mm_add_ps(_mm_loadu_ps(right + k), _mm_mul_ps(gr, s)));
+	}
+#endif
+	for (; k < nbFrame; ++k)
+	{
+		left[k]+= gainLeft * src[k];
+		right[k]+= gainRight * src[k];
+	}
+}
+
+// ***************************************************************************
+void CMixSoftware::mixStereo(const float *srcLeft, const float *srcRight, float *left, float *right, uint nbFrame, float gain)
+{
+	uint k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	g= _mm_set1_ps(gain);
+	for (; k + 4 <= nbFrame; k+= 4)
+	{
+		_mm_storeu_ps(left + k, _mm_add_ps(_mm_loadu_ps(left + k), _mm_mul_ps(g, _mm_loadu_ps(srcLeft + k))));
+		_mm_storeu_ps(right + k, _mm_add_ps(_mm_loadu_ps(right + k), _mm_mul_ps(g, _mm_loadu_ps(srcRight + k))));
+	}
+#endif
+	for (; k < nbFrame; ++k)
+	{
+		left[k]+= gain * srcLeft[k];
+		right[k]+= gain * srcRight[k];
+	}
+}
+
+// ***************************************************************************
+void CMixSoftware::floatToPcm16(const float *left, const float *right, sint16 *dest, uint nbFrame)
+{
+	uint k= 0;
+#ifdef NL_HAS_SSE2
+	__m128	s= _mm_set1_ps(32768.f);
+	__m128	vmin= _mm_set1_ps(-32768.f);
+	__m128	vmax= _mm_set1_ps(32767.f);
+	for (; k + 4 <= nbFrame; k+= 4)
+	{
+		__m128	l= _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(left + k), s), vmin), vmax);
+		__m128	r= _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(right + k), s), vmin), vmax);
+		// (l0, r0, l1, r1), (l2, r2, l3, r3)
+		__m128i	lr0= _mm_cvttps_epi32(_mm_unpacklo_ps(l, r));
+		__m128i	lr1= _mm_cvttps_epi32(_mm_unpackhi_ps(l, r));
+		_mm_storeu_si128((__m128i *)(dest + 2 * k), _mm_packs_epi32(lr0, lr1));
+	}
+#endif
+	for (; k < nbFrame; ++k)
+	{
+		float	l= left[k] * 32768.f;
+		float	r= right[k] * 32768.f;
+		NLMISC::clamp(l, -32768.f, 32767.f);
+		NLMISC::clamp(r, -32768.f, 32767.f);
+		dest[2 * k]= (sint16)(sint32)l;
+		dest[2 * k + 1]= (sint16)(sint32)r;
+	}
+}
+
+} // NLSOUND
+
+/* end of file */
@@ -0,0 +1,65 @@
+/** \file mix_software.h
+ * Mixing kernels of the software sound driver
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_MIX_SOFTWARE_H
+#define NL_MIX_SOFTWARE_H
+#include <nel/misc/types_nl.h>
+
+namespace NLSOUND {
+
+/**
+ * Mixing kernels of the software driver. The mix is done in float, in two separate
+ * left and right blocks, and converted to interleaved 16 bits at the end.
+ * 4 frames at a time when NL_HAS_SSE2 is defined, one by one otherwise. No alignment is required.
+ *
+ * All the kernels do the same float operations, in the same order, than the scalar code,
+ * so the output doesn't depend on whether SSE2 is used or not.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+struct CMixSoftware
+{
+	/// left[k]= right[k]= 0
+	static void	clear(float *left, float *right, uint nbFrame);
+
+	/// dest[k]= src[k] / 32768
+	static void	pcm16ToFloat(const sint16 *src, float *dest, uint nbSample);
+
+	/// left[k]+= gainLeft * src[k], right[k]+= gainRight * src[k]
+	static void	mixMono(const float *src, float *left, float *right, uint nbFrame, float gainLeft, float gainRight);
+
+	/// left[k]+= gain * srcLeft[k], right[k]+= gain * srcRight[k]
+	static void	mixStereo(const float *srcLeft, const float *srcRight, float *left, float *right, uint nbFrame, float gain);
+
+	/** Interleave and convert to 16 bits: dest[2k]= left[k] * 32768, dest[2k+1]= right[k] * 32768.
+	  * The values are clamped, then truncated.
+	  */
+	static void	floatToPcm16(const float *left, const float *right, sint16 *dest, uint nbFrame);
+};
+
+} // NLSOUND
+
+#endif // NL_MIX_SOFTWARE_H
+
+/* End of mix_software.h */
@@ -0,0 +1,427 @@
+/** \file sound_driver_software.cpp
+ * Software sound driver
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdsoftware.h"
+#include "sound_driver_software.h"
+
+#include <nel/misc/dynloadlib.h>
+#include <nel/misc/hierarchical_timer.h>
+#include <nel/misc/path.h>
+#include <nel/misc/stream.h>
+
+#include "buffer_software.h"
+#include "listener_software.h"
+#include "source_software.h"
+#include "mix_software.h"
+
+using namespace std;
+using namespace NLMISC;
+
+namespace NLSOUND {
+
+// Frames mixed at a time
+#define MIX_BLOCK_SIZE 512
+// Max duration rendered by a commit3DChanges() in real time
+#define MAX_ELAPSED_TIME 250
+#define DEFAULT_OUTPUT_RATE 44100
+
+#ifndef NL_STATIC
+
+class CSoundDriverSoftwareNelLibrary : public NLMISC::INelLibrary {
+	void onLibraryLoaded(bool /* firstTime */) { }
+	void onLibraryUnloaded(bool /* lastTime */) { }
+};
+NLMISC_DECL_PURE_LIB(CSoundDriverSoftwareNelLibrary)
+
+#endif /* #ifndef NL_STATIC */
+
+/*
+ * Sound driver instance creation
+ */
+#ifdef NL_OS_WINDOWS
+
+// ******************************************************************
+
+#ifdef NL_STATIC
+ISoundDriver* createISoundDriverInstanceSoftware
+#else
+__declspec(dllexport) ISoundDriver *NLSOUND_createISoundDriverInstance
+#endif
+	(ISoundDriver::IStringMapperProvider *stringMapper)
+{
+	return new CSoundDriverSoftware(stringMapper);
+}
+
+// ******************************************************************
+
+#ifdef NL_STATIC
+uint32 interfaceVersionSoftware()
+#else
+__declspec(dllexport) uint32 NLSOUND_interfaceVersion()
+#endif
+{
+	return ISoundDriver::InterfaceVersion;
+}
+
+// ******************************************************************
+
+#ifdef NL_STATIC
+void outputProfileSoftware
+#else
+__declspec(dllexport) void NLSOUND_outputProfile
+#endif
+	(string &out)
+{
+	CSoundDriverSoftware::getInstance()->writeProfile(out);
+}
+
+// ******************************************************************
+
+#ifdef NL_STATIC
+ISoundDriver::TDriver getDriverTypeSoftware()
+#else
+__declspec(dllexport) ISoundDriver::TDriver NLSOUND_getDriverType()
+#endif
+{
+	return ISoundDriver::DriverSoftware;
+}
+
+// ******************************************************************
+
+#elif defined (NL_OS_UNIX)
+
+#ifdef NL_STATIC
+
+ISoundDriver* createISoundDriverInstanceSoftware(ISoundDriver::IStringMapperProvider *stringMapper)
+{
+	return new CSoundDriverSoftware(stringMapper);
+}
+
+uint32 interfaceVersionSoftware()
+{
+	return ISoundDriver::InterfaceVersion;
+}
+
+void outputProfileSoftware(string &out)
+{
+	CSoundDriverSoftware::getInstance()->writeProfile(out);
+}
+
+ISoundDriver::TDriver getDriverTypeSoftware()
+{
+	return ISoundDriver::DriverSoftware;
+}
+
+#else
+
+extern "C"
+{
+ISoundDriver* NLSOUND_createISoundDriverInstance(ISoundDriver::IStringMapperProvider *stringMapper)
+{
+	return new CSoundDriverSoftware(stringMapper);
+}
+
+uint32 NLSOUND_interfaceVersion ()
+{
+	return ISoundDriver::InterfaceVersion;
+}
+}
+
+#endif // NL_STATIC
+
+#endif // NL_OS_UNIX
+
+/*
+ * Constructor
+ */
+CSoundDriverSoftware::CSoundDriverSoftware(ISoundDriver::IStringMapperProvider *stringMapper) 
+: _StringMapper(stringMapper), _Options((TSoundOptions)0), _OutputRate(DEFAULT_OUTPUT_RATE), _Step(0), 
+_LastTime(0), _PendingFrames(0), _File(NULL), _DataSize(0), 
+_RenderedFrames(0), _RenderTicks(0), _SourceFrames(0), _Peak(0)
+{
+	
+}
+
+/*
+ * Destructor
+ */
+CSoundDriverSoftware::~CSoundDriverSoftware()
+{
+	if (!_Sources.empty())
+	{
+		nlwarning("SOFT: _Sources.size(): '%u'", (uint32)_Sources.size());
+		_Sources.clear();
+	}
+
+	if (_File)
+	{
+		// patch the sizes in the header
+		writeWavHeader();
+		fclose(_File);
+		_File = NULL;
+	}
+}
+
+/// Initialize the driver. See the class documentation for the device options.
+void CSoundDriverSoftware::init(std::string device, ISoundDriver::TSoundOptions options)
+{
+	// list of supported options in this driver
+	const sint supportedOptions = 
+		OptionAllowADPCM
+		| OptionSoftwareBuffer
+		| OptionManualRolloff
+		| OptionLocalBufferCopy
+		| OptionHasBufferStreaming;
+
+	// list of forced options in this driver
+	const sint forcedOptions = 
+		OptionSoftwareBuffer;
+
+	// set the options
+	_Options = (TSoundOptions)(((sint)options & supportedOptions) | forcedOptions);
+
+	// parse the device options
+	string outputFile;
+	vector<string> deviceOptions;
+	explode(device, string(";"), deviceOptions, true);
+	for (uint i = 0; i < deviceOptions.size(); ++i)
+	{
+		const string &option = deviceOptions[i];
+		if (option.find("rate=") == 0)
+			fromString(option.substr(5), _OutputRate);
+		else if (option.find("step=") == 0)
+			fromString(option.substr(5), _Step);
+		else if (toLower(CFile::getExtension(option)) == "wav")
+			outputFile = option;
+		else
+			nlwarning("SOFT: Unknown device option '%s'", option.c_str());
+	}
+	if (!_OutputRate) _OutputRate = DEFAULT_OUTPUT_RATE;
+
+	if (!outputFile.empty())
+	{
+		_File = fopen(outputFile.c_str(), "wb");
+		if (!_File) throw ESoundDriver("SOFT: Can't open " + outputFile);
+		writeWavHeader();
+	}
+
+	_Left.resize(MIX_BLOCK_SIZE);
+	_Right.resize(MIX_BLOCK_SIZE);
+	_TempLeft.resize(MIX_BLOCK_SIZE);
+	_TempRight.resize(MIX_BLOCK_SIZE);
+	_Output.resize(MIX_BLOCK_SIZE * 2);
+
+	_LastTime = CTime::getLocalTime();
+
+	nldebug("SOFT: Mixing at %u Hz to %s, %s", _OutputRate, 
+		_File ? outputFile.c_str() : "memory", 
+		_Step ? toString("%u ms per commit", _Step).c_str() : "real time");
+}
+
+/// Return options that are enabled (including those that cannot be disabled on this driver).
+ISoundDriver::TSoundOptions CSoundDriverSoftware::getOptions()
+{
+	return _Options;
+}
+
+/// Return if an option is enabled (including those that cannot be disabled on this driver).
+bool CSoundDriverSoftware::getOption(ISoundDriver::TSoundOptions option)
+{
+	return ((uint)_Options & (uint)option) == (uint)option;
+}
+
+/*
+ * Create a sound buffer
+ */
+IBuffer *CSoundDriverSoftware::createBuffer()
+{
+	return new CBufferSoftware();
+}
+
+/*
+ * Create the listener instance
+ */
+IListener *CSoundDriverSoftware::createListener()
+{
+	if (CListenerSoftware::isInitialized()) 
+		return CListenerSoftware::getInstance();
+	return new CListenerSoftware();
+}
+
+/*
+ * Create a source
+ */
+ISource *CSoundDriverSoftware::createSource()
+{
+	CSourceSoftware *source = new CSourceSoftware(this);
+	_Sources.insert(source);
+	return source;
+}
+
+/// Remove a source
+void CSoundDriverSoftware::removeSource(CSourceSoftware *source)
+{
+	_Sources.erase(source);
+}
+
+/*
+ * Return the maximum number of sources that can created
+ */
+uint CSoundDriverSoftware::countMaxSources()
+{
+	// the only limit is the cpu, keep it high for the benchmarks
+	return 4096;
+}
+
+/*
+ * Mix the sources for the elapsed time, or the fixed step
+ */
+void CSoundDriverSoftware::commit3DChanges()
+{
+	uint64 elapsed;
+	if (_Step)
+	{
+		elapsed = _Step;
+	}
+	else
+	{
+		TTime now = CTime::getLocalTime();
+		elapsed = min((uint64)(now - _LastTime), (uint64)MAX_ELAPSED_TIME);
+		_LastTime = now;
+	}
+
+	// keep the fractions of frames for the next call
+	_PendingFrames += elapsed * _OutputRate;
+	uint nbFrame = (uint)(_PendingFrames / 1000);
+	_PendingFrames %= 1000;
+
+	render(nbFrame);
+}
+
+/*
+ * Mix nbFrame frames
+ */
+void CSoundDriverSoftware::render(uint nbFrame)
+{
+	H_AUTO(NLSOUND_SoftwareRender)
+
+	TTicks startTicks = CTime::getPerformanceTime();
+	while (nbFrame)
+	{
+		uint blockSize = min(nbFrame, (uint)MIX_BLOCK_SIZE);
+		CMixSoftware::clear(&_Left[0], &_Right[0], blockSize);
+
+		set<CSourceSoftware *>::iterator it(_Sources.begin()), end(_Sources.end());
+		for (; it != end; ++it)
+		{
+			if ((*it)->isPlaying())
+			{
+				(*it)->render(&_Left[0], &_Right[0], &_TempLeft[0], &_TempRight[0], blockSize);
+				_SourceFrames += blockSize;
+			}
+		}
+
+		CMixSoftware::floatToPcm16(&_Left[0], &_Right[0], &_Output[0], blockSize);
+		for (uint i = 0; i < blockSize * 2; ++i)
+		{
+			sint16 value = _Output[i] < 0 ? (sint16)min(-(sint)_Output[i], 32767) : _Output[i];
+			if (value > _Peak) _Peak = value;
+		}
+
+		if (_File)
+		{
+#ifdef NL_BIG_ENDIAN
+			for (uint i = 0; i < blockSize * 2; ++i)
+				NLMISC_BSWAP16(_Output[i]);
+#endif
+			fwrite(&_Output[0], sizeof(sint16), blockSize * 2, _File);
+			_DataSize += blockSize * 2 * sizeof(sint16);
+		}
+
+		_RenderedFrames += blockSize;
+		nbFrame -= blockSize;
+	}
+	_RenderTicks += CTime::getPerformanceTime() - startTicks;
+}
+
+/*
+ * Write the header of the wav file, with the current data size
+ */
+void CSoundDriverSoftware::writeWavHeader()
+{
+	// stereo 16 bits pcm, little endian
+	uint8 header[44];
+	uint32 values[] = { 0x46464952 /* RIFF */, 36 + _DataSize, 0x45564157 /* WAVE */, 0x20746d66 /* fmt  */, 16, 
+		1 | (2 << 16), _OutputRate, _OutputRate * 4, 4 | (16 << 16), 0x61746164 /* data */, _DataSize };
+	for (uint i = 0; i < 11; ++i)
+	{
+		header[i * 4] = (uint8)(values[i] & 0xff);
+		header[i * 4 + 1] = (uint8)((values[i] >> 8) & 0xff);
+		header[i * 4 + 2] = (uint8)((values[i] >> 16) & 0xff);
+		header[i * 4 + 3] = (uint8)((values[i] >> 24) & 0xff);
+	}
+	long pos = ftell(_File);
+	fseek(_File, 0, SEEK_SET);
+	fwrite(header, 1, sizeof(header), _File);
+	if (pos > (long)sizeof(header)) fseek(_File, pos, SEEK_SET);
+}
+
+/*
+ * Write information about the driver to the output stream.
+ */
+void CSoundDriverSoftware::writeProfile(std::string& out)
+{
+	double renderedTime = (double)_RenderedFrames / (double)_OutputRate;
+	double renderTime = CTime::ticksToSecond(_RenderTicks);
+	out = "Software"
+		+ toString("\n\tOutputRate: %u", _OutputRate)
+		+ toString("\n\tSources: %u", (uint32)_Sources.size())
+		+ toString("\n\tRenderedTime: %.3f s", renderedTime)
+		+ toString("\n\tMixingTime: %.3f s", renderTime)
+		+ toString("\n\tMixingCost: %.3f ms per rendered second", renderedTime > 0.0 ? renderTime * 1000.0 / renderedTime : 0.0)
+		+ toString("\n\tAverageSources: %.1f", _RenderedFrames ? (double)_SourceFrames / (double)_RenderedFrames : 0.0)
+		+ toString("\n\tPeak: %d", (sint)_Peak)
+		+ "\n";
+}
+
+void CSoundDriverSoftware::startBench()
+{
+	NLMISC::CHTimer::startBench();
+}
+
+void CSoundDriverSoftware::endBench()
+{
+	NLMISC::CHTimer::endBench();
+}
+
+void CSoundDriverSoftware::displayBench(NLMISC::CLog *log)
+{
+	NLMISC::CHTimer::displayHierarchicalByExecutionPathSorted(log, CHTimer::TotalTime, true, 48, 2);
+	NLMISC::CHTimer::displayHierarchical(log, true, 48, 2);
+	NLMISC::CHTimer::displayByExecutionPath(log, CHTimer::TotalTime);
+	NLMISC::CHTimer::display(log, CHTimer::TotalTime);
+}
+
+} // NLSOUND
+
+/* end of file */
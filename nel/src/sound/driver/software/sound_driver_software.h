@@ -0,0 +1,151 @@
+/** \file sound_driver_software.h
+ * Software sound driver
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_SOUND_DRIVER_SOFTWARE_H
+#define NL_SOUND_DRIVER_SOFTWARE_H
+#include <nel/misc/types_nl.h>
+
+namespace NLSOUND {
+	class CBufferSoftware;
+	class CListenerSoftware;
+	class CSourceSoftware;
+
+/**
+ * Software sound driver. It doesn't need any sound device: the sources are mixed by the CPU,
+ * to a wav file or to memory where the mix is discarded. It makes the audio mixer usable
+ * on servers, for tests and benchmarks.
+ *
+ * The sources are mixed in commit3DChanges(), in stereo 16 bits. The device given to init()
+ * is a list of options separated by ';' :
+ *	- "<file>.wav" : write the mix in a wav file, else it is only rendered in memory.
+ *	- "rate=<hz>" : output frequency, default 44100.
+ *	- "step=<ms>" : each commit3DChanges() renders this duration, for reproducible outputs.
+ *	  By default, commit3DChanges() renders the time elapsed since the previous call (250 ms max).
+ *
+ * writeProfile() and the bench functions report the mixing cost.
+ *
+ * The caller of the create methods is responsible for the deletion of the created objects.
+ * These objects must be deleted before deleting the ISoundDriver instance.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CSoundDriverSoftware : public ISoundDriver, public NLMISC::CManualSingleton<CSoundDriverSoftware>
+{
+public:
+
+	/// Constructor
+	CSoundDriverSoftware(ISoundDriver::IStringMapperProvider *stringMapper);
+	/// Destructor
+	virtual ~CSoundDriverSoftware();
+
+	/// Initialize the driver. See the class documentation for the device options.
+	virtual void init(std::string device, TSoundOptions options);
+
+	/// Return options that are enabled (including those that cannot be disabled on this driver).
+	virtual TSoundOptions getOptions();
+	/// Return if an option is enabled (including those that cannot be disabled on this driver).
+	virtual bool getOption(TSoundOptions option);
+
+	/// Create a sound buffer
+	virtual	IBuffer *createBuffer();
+	/// Create the listener instance
+	virtual	IListener *createListener();
+	/// Create a source
+	virtual	ISource *createSource();
+	/// Return the maximum number of sources that can created
+	virtual uint countMaxSources();
+
+	/// Mix the sources for the elapsed time, or the fixed step
+	virtual void commit3DChanges();
+
+	/// Write information about the driver to the output stream.
+	virtual void writeProfile(std::string& out);
+
+	virtual void startBench();
+	virtual void endBench();
+	virtual void displayBench(NLMISC::CLog *log);
+
+	/// Get audio/container extensions that are supported natively by the driver implementation.
+	virtual void getMusicExtensions(std::vector<std::string> & /* extensions */) const { }
+	/// Return if a music extension is supported by the driver's music channel.
+	virtual bool isMusicExtensionSupported(const std::string & /* extension */) const { return false; }
+
+	/// Mix nbFrame frames
+	void render(uint nbFrame);
+
+	/// Output frequency
+	uint32 getOutputRate() const { return _OutputRate; }
+
+	/// Remove a source
+	void removeSource(CSourceSoftware *source);
+
+private:
+
+	/// Write the header of the wav file, with the current data size
+	void writeWavHeader();
+
+	/// The string mapper provided by client code.
+	IStringMapperProvider		*_StringMapper;
+	/// Driver options
+	TSoundOptions				_Options;
+
+	/// Allocated sources
+	std::set<CSourceSoftware *>	_Sources;
+
+	/// \name Output
+	//@{
+	uint32						_OutputRate;
+	/// Fixed step in ms, 0 to render the elapsed time
+	uint32						_Step;
+	NLMISC::TTime				_LastTime;
+	/// Frames to render not rendered yet, in 1/1000 frame
+	uint64						_PendingFrames;
+	/// The wav file, NULL when rendering to memory
+	FILE						*_File;
+	uint32						_DataSize;
+	//@}
+
+	/// \name Mix buffers
+	//@{
+	std::vector<float>			_Left;
+	std::vector<float>			_Right;
+	std::vector<float>			_TempLeft;
+	std::vector<float>			_TempRight;
+	std::vector<sint16>			_Output;
+	//@}
+
+	/// \name Statistics
+	//@{
+	uint64						_RenderedFrames;
+	NLMISC::TTicks				_RenderTicks;
+	uint64						_SourceFrames;
+	sint16						_Peak;
+	//@}
+};
+
+} // NLSOUND
+
+#endif // NL_SOUND_DRIVER_SOFTWARE_H
+
+/* End of sound_driver_software.h */
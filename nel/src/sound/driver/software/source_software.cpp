@@ -0,0 +1,574 @@
+/** \file source_software.cpp
+ * Software sound driver source
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "stdsoftware.h"
+#include "source_software.h"
+
+#include <limits>
+
+#include "sound_driver_software.h"
+#include "buffer_software.h"
+#include "listener_software.h"
+#include "mix_software.h"
+
+using namespace std;
+using namespace NLMISC;
+
+namespace NLSOUND {
+
+CSourceSoftware::CSourceSoftware(CSoundDriverSoftware *soundDriver) : 
+_SoundDriver(soundDriver), _StaticBuffer(NULL), _Streaming(false), 
+_State(Stopped), _Looping(false), _Frame(0), _Frac(0), _PlayedFrames(0), 
+_Pos(0.0f, 0.0f, 0.0f), _Velocity(0.0f, 0.0f, 0.0f), _Direction(0.0f, 0.0f, 0.0f), 
+_Gain(NLSOUND_DEFAULT_GAIN), _Pitch(NLSOUND_DEFAULT_PITCH), _Relative(false), 
+_MinDistance(1.0f), _MaxDistance(numeric_limits<float>::max()), 
+_ConeInner((float)(NLMISC::Pi * 2)), _ConeOuter((float)(NLMISC::Pi * 2)), _ConeOuterGain(0.0f), _Alpha(1.0), 
+_Direct(true), _DirectGain(NLSOUND_DEFAULT_DIRECT_GAIN), _DirectFilterEnabled(false), _DirectFilterType(ISource::FilterLowPass), 
+_DirectFilterLowFrequency(NLSOUND_DEFAULT_FILTER_PASS_LF), _DirectFilterHighFrequency(NLSOUND_DEFAULT_FILTER_PASS_HF), 
+_DirectFilterPassGain(NLSOUND_DEFAULT_FILTER_PASS_GAIN), 
+_Effect(NULL), _EffectGain(NLSOUND_DEFAULT_EFFECT_GAIN), _EffectFilterEnabled(false), _EffectFilterType(ISource::FilterLowPass), 
+_EffectFilterLowFrequency(NLSOUND_DEFAULT_FILTER_PASS_LF), _EffectFilterHighFrequency(NLSOUND_DEFAULT_FILTER_PASS_HF), 
+_EffectFilterPassGain(NLSOUND_DEFAULT_FILTER_PASS_GAIN)
+{
+	
+}
+
+CSourceSoftware::~CSourceSoftware()
+{
+	_SoundDriver->removeSource(this);
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::render(float *left, float *right, float *tempLeft, float *tempRight, uint nbFrame)
+{
+	if (_State != Playing) return;
+
+	// Resample the buffers, the streaming buffers of a source have the same format
+	uint done = 0;
+	bool stereo = false;
+	while (done < nbFrame)
+	{
+		CBufferSoftware *buffer = getCurrentBuffer();
+		if (!buffer) break;
+		stereo = buffer->isStereo();
+		done += resample(buffer, tempLeft + done, tempRight + done, nbFrame - done);
+		if (_Frame >= buffer->getNbFrame() && !nextBuffer(buffer))
+			break;
+	}
+	_PlayedFrames += nbFrame;
+	if (!done) return;
+
+	// Mix
+	float gainLeft, gainRight;
+	computeGains(stereo, gainLeft, gainRight);
+	if (gainLeft <= 0.0f && gainRight <= 0.0f) return;
+	if (stereo)
+		CMixSoftware::mixStereo(tempLeft, tempRight, left, right, done, gainLeft);
+	else
+		CMixSoftware::mixMono(tempLeft, left, right, done, gainLeft, gainRight);
+}
+
+CBufferSoftware *CSourceSoftware::getCurrentBuffer()
+{
+	if (_Streaming)
+	{
+		CAutoMutex<CMutex> lock(_StreamingMutex);
+		// skip the empty buffers
+		while (!_StreamingQueue.empty() && !_StreamingQueue.front()->getNbFrame())
+			_StreamingQueue.pop_front();
+		// starving, play silence until a buffer is submitted
+		return _StreamingQueue.empty() ? NULL : _StreamingQueue.front();
+	}
+	else
+	{
+		if (!_StaticBuffer || !_StaticBuffer->getNbFrame())
+		{
+			_State = Stopped;
+			return NULL;
+		}
+		return _StaticBuffer;
+	}
+}
+
+bool CSourceSoftware::nextBuffer(CBufferSoftware *buffer)
+{
+	uint32 nbFrame = buffer->getNbFrame();
+	if (_Streaming)
+	{
+		CAutoMutex<CMutex> lock(_StreamingMutex);
+		_StreamingQueue.pop_front();
+		_Frame = 0;
+		return !_StreamingQueue.empty();
+	}
+	else if (_Looping)
+	{
+		_Frame %= nbFrame;
+		return true;
+	}
+	else
+	{
+		_State = Stopped;
+		_Frame = 0;
+		_Frac = 0;
+		return false;
+	}
+}
+
+uint CSourceSoftware::resample(const CBufferSoftware *buffer, float *tempLeft, float *tempRight, uint nbFrame)
+{
+	const sint16 *samples = buffer->getSamples();
+	uint32 bufferFrames = buffer->getNbFrame();
+	bool stereo = buffer->isStereo();
+	nlassert(_Frame < bufferFrames);
+
+	// 16.16 fixed point step
+	double step = (double)buffer->getFrequency() * (double)_Pitch * 65536.0 / (double)_SoundDriver->getOutputRate();
+	uint32 step32 = max((uint32)1, (uint32)(step + 0.5));
+
+	const float scale = 1.0f / 32768.0f;
+	uint k = 0;
+	if (step32 == 0x10000 && _Frac == 0)
+	{
+		// same rate, copy
+		k = min(nbFrame, (uint)(bufferFrames - _Frame));
+		if (!stereo)
+		{
+			CMixSoftware::pcm16ToFloat(samples + _Frame, tempLeft, k);
+		}
+		else
+		{
+			const sint16 *src = samples + _Frame * 2;
+			for (uint i = 0; i < k; ++i)
+			{
+				tempLeft[i] = (float)src[i * 2] * scale;
+				tempRight[i] = (float)src[i * 2 + 1] * scale;
+			}
+		}
+		_Frame += k;
+		return k;
+	}
+
+	// linear interpolation, the last sample is interpolated with the first one when looping
+	bool wrap = _Looping && !_Streaming;
+	const float fracScale = 1.0f / 65536.0f;
+	for (; k < nbFrame && _Frame < bufferFrames; ++k)
+	{
+		uint32 next = _Frame + 1;
+		if (next >= bufferFrames) next = wrap ? 0 : _Frame;
+		float t = (float)_Frac * fracScale;
+		if (!stereo)
+		{
+			float a = (float)samples[_Frame];
+			float b = (float)samples[next];
+			tempLeft[k] = (a + (b - a) * t) * scale;
+		}
+		else
+		{
+			float al = (float)samples[_Frame * 2], ar = (float)samples[_Frame * 2 + 1];
+			float bl = (float)samples[next * 2], br = (float)samples[next * 2 + 1];
+			tempLeft[k] = (al + (bl - al) * t) * scale;
+			tempRight[k] = (ar + (br - ar) * t) * scale;
+		}
+		_Frac += step32;
+		_Frame += _Frac >> 16;
+		_Frac &= 0xffff;
+	}
+	return k;
+}
+
+void CSourceSoftware::computeGains(bool stereo, float &gainLeft, float &gainRight) const
+{
+	float gain = _Gain;
+	if (_Direct) gain *= _DirectGain;
+	else gain = 0.0f;
+	if (_DirectFilterEnabled) gain *= _DirectFilterPassGain;
+
+	CListenerSoftware *listener = CListenerSoftware::isInitialized() ? CListenerSoftware::getInstance() : NULL;
+	if (listener) gain *= listener->getGain();
+
+	// stereo buffers are not positioned
+	if (stereo)
+	{
+		gainLeft = gainRight = gain;
+		return;
+	}
+
+	CVector relative = (_Relative || !listener) ? _Pos : _Pos - listener->getPos();
+	float sqrdist = relative.sqrnorm();
+
+	// distance rolloff
+	if (_SoundDriver->getOption(ISoundDriver::OptionManualRolloff))
+	{
+		gain *= ISource::computeManualRolloff(_Alpha, sqrdist, _MinDistance, _MaxDistance);
+	}
+	else if (_MinDistance > 0.0f)
+	{
+		// inverse distance clamped
+		float dist = sqrtf(sqrdist);
+		clamp(dist, _MinDistance, _MaxDistance);
+		float rolloffFactor = listener ? listener->getRolloffFactor() : 1.0f;
+		gain *= _MinDistance / (_MinDistance + rolloffFactor * (dist - _MinDistance));
+	}
+
+	// cone, the angles are the full angles of the cones
+	if (_ConeInner < (float)(NLMISC::Pi * 2) && !_Direction.isNull() && sqrdist > 0.0f)
+	{
+		float cosAngle = -(_Direction * relative) / (_Direction.norm() * sqrtf(sqrdist));
+		clamp(cosAngle, -1.0f, 1.0f);
+		float angle = 2.0f * acosf(cosAngle);
+		if (angle >= _ConeOuter)
+			gain *= _ConeOuterGain;
+		else if (angle > _ConeInner)
+			gain *= 1.0f + (_ConeOuterGain - 1.0f) * (angle - _ConeInner) / (_ConeOuter - _ConeInner);
+	}
+
+	// equal power panning on the right axis of the listener
+	float pan = 0.0f;
+	if (sqrdist > 0.0f)
+	{
+		const CVector &rightAxis = listener ? listener->getRight() : CVector::I;
+		pan = (relative * rightAxis) / sqrtf(sqrdist);
+		clamp(pan, -1.0f, 1.0f);
+	}
+	float angle = (pan + 1.0f) * (float)(NLMISC::Pi / 4);
+	gainLeft = gain * cosf(angle);
+	gainRight = gain * sinf(angle);
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::setStreaming(bool streaming)
+{
+	nlassert(isStopped());
+
+	CAutoMutex<CMutex> lock(_StreamingMutex);
+	_StreamingQueue.clear();
+	_StaticBuffer = NULL;
+	_Streaming = streaming;
+}
+
+void CSourceSoftware::setStaticBuffer(IBuffer *buffer)
+{
+	_StaticBuffer = static_cast<CBufferSoftware *>(buffer);
+	_Streaming = false;
+	_Frame = 0;
+	_Frac = 0;
+}
+
+IBuffer *CSourceSoftware::getStaticBuffer()
+{
+	return _StaticBuffer;
+}
+
+void CSourceSoftware::submitStreamingBuffer(IBuffer *buffer)
+{
+	nlassert(_Streaming);
+
+	CAutoMutex<CMutex> lock(_StreamingMutex);
+	_StreamingQueue.push_back(static_cast<CBufferSoftware *>(buffer));
+}
+
+uint CSourceSoftware::countStreamingBuffers() const
+{
+	CAutoMutex<CMutex> lock(_StreamingMutex);
+	return (uint)_StreamingQueue.size();
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::setLooping(bool l)
+{
+	_Looping = l;
+}
+
+bool CSourceSoftware::getLooping() const
+{
+	return _Looping;
+}
+
+bool CSourceSoftware::play()
+{
+	if (!_Streaming && !_StaticBuffer) return false;
+	if (_State == Stopped)
+	{
+		_Frame = 0;
+		_Frac = 0;
+		_PlayedFrames = 0;
+	}
+	_State = Playing;
+	return true;
+}
+
+void CSourceSoftware::stop()
+{
+	_State = Stopped;
+	_Frame = 0;
+	_Frac = 0;
+	if (_Streaming)
+	{
+		CAutoMutex<CMutex> lock(_StreamingMutex);
+		_StreamingQueue.clear();
+	}
+}
+
+void CSourceSoftware::pause()
+{
+	if (_State == Playing) _State = Paused;
+}
+
+bool CSourceSoftware::isPlaying() const
+{
+	return _State == Playing;
+}
+
+bool CSourceSoftware::isStopped() const
+{
+	return _State == Stopped;
+}
+
+bool CSourceSoftware::isPaused() const
+{
+	return _State == Paused;
+}
+
+uint32 CSourceSoftware::getTime()
+{
+	if (_State == Stopped) return 0;
+	return (uint32)((uint64)_PlayedFrames * 1000 / _SoundDriver->getOutputRate());
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::setPos(const NLMISC::CVector& pos, bool /* deffered */)
+{
+	_Pos = pos;
+}
+
+const NLMISC::CVector &CSourceSoftware::getPos() const
+{
+	return _Pos;
+}
+
+void CSourceSoftware::setVelocity(const NLMISC::CVector& vel, bool /* deferred */)
+{
+	_Velocity = vel;
+}
+
+void CSourceSoftware::getVelocity(NLMISC::CVector& vel) const
+{
+	vel = _Velocity;
+}
+
+void CSourceSoftware::setDirection(const NLMISC::CVector& dir)
+{
+	_Direction = dir;
+}
+
+void CSourceSoftware::getDirection(NLMISC::CVector& dir) const
+{
+	dir = _Direction;
+}
+
+void CSourceSoftware::setGain(float gain)
+{
+	_Gain = min(max(gain, NLSOUND_MIN_GAIN), NLSOUND_MAX_GAIN);
+}
+
+float CSourceSoftware::getGain() const
+{
+	return _Gain;
+}
+
+void CSourceSoftware::setPitch(float pitch)
+{
+	_Pitch = min(max(pitch, NLSOUND_MIN_PITCH), NLSOUND_MAX_PITCH);
+}
+
+float CSourceSoftware::getPitch() const
+{
+	return _Pitch;
+}
+
+void CSourceSoftware::setSourceRelativeMode(bool mode)
+{
+	_Relative = mode;
+}
+
+bool CSourceSoftware::getSourceRelativeMode() const
+{
+	return _Relative;
+}
+
+void CSourceSoftware::setMinMaxDistances(float mindist, float maxdist, bool /* deferred */)
+{
+	nlassert((mindist >= 0.0f) && (maxdist >= 0.0f));
+	_MinDistance = mindist;
+	_MaxDistance = maxdist;
+}
+
+void CSourceSoftware::getMinMaxDistances(float& mindist, float& maxdist) const
+{
+	mindist = _MinDistance;
+	maxdist = _MaxDistance;
+}
+
+void CSourceSoftware::setCone(float innerAngle, float outerAngle, float outerGain)
+{
+	nlassert((outerGain >= 0.0f) && (outerGain <= 1.0f));
+	_ConeInner = innerAngle;
+	_ConeOuter = outerAngle;
+	_ConeOuterGain = outerGain;
+}
+
+void CSourceSoftware::getCone(float& innerAngle, float& outerAngle, float& outerGain) const
+{
+	innerAngle = _ConeInner;
+	outerAngle = _ConeOuter;
+	outerGain = _ConeOuterGain;
+}
+
+void CSourceSoftware::setAlpha(double a)
+{
+	_Alpha = a;
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::setDirect(bool enable)
+{
+	_Direct = enable;
+}
+
+bool CSourceSoftware::getDirect() const
+{
+	return _Direct;
+}
+
+void CSourceSoftware::setDirectGain(float gain)
+{
+	_DirectGain = min(max(gain, NLSOUND_MIN_GAIN), NLSOUND_MAX_GAIN);
+}
+
+float CSourceSoftware::getDirectGain() const
+{
+	return _DirectGain;
+}
+
+void CSourceSoftware::enableDirectFilter(bool enable)
+{
+	_DirectFilterEnabled = enable;
+}
+
+bool CSourceSoftware::isDirectFilterEnabled() const
+{
+	return _DirectFilterEnabled;
+}
+
+void CSourceSoftware::setDirectFilter(TFilter filterType, float lowFrequency, float highFrequency, float passGain)
+{
+	_DirectFilterType = filterType;
+	_DirectFilterLowFrequency = lowFrequency;
+	_DirectFilterHighFrequency = highFrequency;
+	_DirectFilterPassGain = passGain;
+}
+
+void CSourceSoftware::getDirectFilter(TFilter &filterType, float &lowFrequency, float &highFrequency, float &passGain) const
+{
+	filterType = _DirectFilterType;
+	lowFrequency = _DirectFilterLowFrequency;
+	highFrequency = _DirectFilterHighFrequency;
+	passGain = _DirectFilterPassGain;
+}
+
+void CSourceSoftware::setDirectFilterPassGain(float passGain)
+{
+	_DirectFilterPassGain = min(max(passGain, NLSOUND_MIN_GAIN), NLSOUND_MAX_GAIN);
+}
+
+float CSourceSoftware::getDirectFilterPassGain() const
+{
+	return _DirectFilterPassGain;
+}
+
+// ***************************************************************************
+
+void CSourceSoftware::setEffect(IReverbEffect *reverbEffect)
+{
+	_Effect = reverbEffect;
+}
+
+IEffect *CSourceSoftware::getEffect() const
+{
+	return NULL;
+}
+
+void CSourceSoftware::setEffectGain(float gain)
+{
+	_EffectGain = min(max(gain, NLSOUND_MIN_GAIN), NLSOUND_MAX_GAIN);
+}
+
+float CSourceSoftware::getEffectGain() const
+{
+	return _EffectGain;
+}
+
+void CSourceSoftware::enableEffectFilter(bool enable)
+{
+	_EffectFilterEnabled = enable;
+}
+
+bool CSourceSoftware::isEffectFilterEnabled() const
+{
+	return _EffectFilterEnabled;
+}
+
+void CSourceSoftware::setEffectFilter(TFilter filterType, float lowFrequency, float highFrequency, float passGain)
+{
+	_EffectFilterType = filterType;
+	_EffectFilterLowFrequency = lowFrequency;
+	_EffectFilterHighFrequency = highFrequency;
+	_EffectFilterPassGain = passGain;
+}
+
+void CSourceSoftware::getEffectFilter(TFilter &filterType, float &lowFrequency, float &highFrequency, float &passGain) const
+{
+	filterType = _EffectFilterType;
+	lowFrequency = _EffectFilterLowFrequency;
+	highFrequency = _EffectFilterHighFrequency;
+	passGain = _EffectFilterPassGain;
+}
+
+void CSourceSoftware::setEffectFilterPassGain(float passGain)
+{
+	_EffectFilterPassGain = min(max(passGain, NLSOUND_MIN_GAIN), NLSOUND_MAX_GAIN);
+}
+
+float CSourceSoftware::getEffectFilterPassGain() const
+{
+	return _EffectFilterPassGain;
+}
+
+} // NLSOUND
+
+/* end of file */
@@ -0,0 +1,254 @@
+/** \file source_software.h
+ * Software sound driver source
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#ifndef NL_SOURCE_SOFTWARE_H
+#define NL_SOURCE_SOFTWARE_H
+#include <nel/misc/types_nl.h>
+
+namespace NLSOUND {
+	class CSoundDriverSoftware;
+	class CBufferSoftware;
+
+/**
+ * Software sound source.
+ *
+ * The source is mixed by the driver in commit3DChanges(). Mono buffers are positioned in 3D:
+ * distance rolloff (inverse distance clamped, or the manual rolloff curve), cone and equal
+ * power panning on the right axis of the listener. Stereo buffers are played as is.
+ * The pitch and the buffer frequency are applied by linear interpolation.
+ *
+ * The filters are approximated by their pass gain, the effects and the doppler are not rendered.
+ *
+ * \author Nevrax France
+ * \date 2002
+ */
+class CSourceSoftware : public ISource
+{
+public:
+	/// Constructor
+	CSourceSoftware(CSoundDriverSoftware *soundDriver);
+	/// Destructor
+	virtual ~CSourceSoftware();
+
+	/// Mix the source in left and right. tempLeft and tempRight must have room for nbFrame floats.
+	void render(float *left, float *right, float *tempLeft, float *tempRight, uint nbFrame);
+
+	/// \name Initialization
+	//@{
+	/// Enable or disable streaming mode. Source must be stopped to call this.
+	virtual void setStreaming(bool streaming = true);
+	/// Set the buffer that will be played (no streaming)
+	virtual void setStaticBuffer(IBuffer *buffer);
+	/// Return the buffer, or NULL if streaming is used.
+	virtual IBuffer *getStaticBuffer();
+	/// Add a buffer to the streaming queue. Thread safe.
+	virtual void submitStreamingBuffer(IBuffer *buffer);
+	/// Return the amount of buffers in the queue (playing and waiting). Thread safe.
+	virtual uint countStreamingBuffers() const;
+	//@}
+
+	/// \name Playback control
+	//@{
+	/// Set looping on/off for future playbacks (default: off), not available for streaming
+	virtual void setLooping(bool l = true);
+	/// Return the looping state
+	virtual bool getLooping() const;
+
+	/// Play the static buffer (or stream in and play).
+	virtual bool play();
+	/// Stop playing
+	virtual void stop();
+	/// Pause. Call play() to resume.
+	virtual void pause();
+	/// Return true if play() or pause(), false if stop().
+	virtual bool isPlaying() const;
+	/// Return true if playing is finished or stop() has been called.
+	virtual bool isStopped() const;
+	/// Return true if the playing source is paused
+	virtual bool isPaused() const;
+	/// Returns the number of milliseconds the source has been playing
+	virtual uint32 getTime();
+	//@}
+
+	/// \name Source properties
+	//@{
+	/// Set the position vector (default: (0,0,0)).
+	virtual void setPos(const NLMISC::CVector& pos, bool deffered = true);
+	/// Get the position vector.
+	virtual const NLMISC::CVector &getPos() const;
+	/// Set the velocity vector (3D mode only, ignored in stereo mode) (default: (0,0,0))
+	virtual void setVelocity(const NLMISC::CVector& vel, bool deferred = true);
+	/// Get the velocity vector
+	virtual void getVelocity(NLMISC::CVector& vel) const;
+	/// Set the direction vector (3D mode only, ignored in stereo mode) (default: (0,0,0) as non-directional)
+	virtual void setDirection(const NLMISC::CVector& dir);
+	/// Get the direction vector
+	virtual void getDirection(NLMISC::CVector& dir) const;
+	/// Set the gain (volume value inside [0 , 1]).
+	virtual void setGain(float gain = NLSOUND_DEFAULT_GAIN);
+	/// Get the gain
+	virtual float getGain() const;
+	/// Shift the frequency. 1.0f equals identity, each reduction of 50% equals a pitch shift of one octave.
+	virtual void setPitch(float pitch = NLSOUND_DEFAULT_PITCH);
+	/// Get the pitch
+	virtual float getPitch() const;
+	/// Set the source relative mode. If true, positions are interpreted relative to the listener position
+	virtual void setSourceRelativeMode(bool mode = true);
+	/// Get the source relative mode
+	virtual bool getSourceRelativeMode() const;
+	/// Set the min and max distances (default: 1, MAX_FLOAT) (3D mode only)
+	virtual void setMinMaxDistances(float mindist, float maxdist, bool deferred = true);
+	/// Get the min and max distances
+	virtual void getMinMaxDistances(float& mindist, float& maxdist) const;
+	/// Set the cone angles (in radian) and gain (in [0 , 1]) (default: 2PI, 2PI, 0)
+	virtual void setCone(float innerAngle, float outerAngle, float outerGain);
+	/// Get the cone angles (in radian)
+	virtual void getCone(float& innerAngle, float& outerAngle, float& outerGain) const;
+	/// Set the alpha value for the volume-distance curve, used with OptionManualRolloff.
+	virtual void setAlpha(double a);
+	//@}
+
+	/// \name Direct output
+	//@{
+	/// Enable or disable direct output [true/false], default: true
+	virtual void setDirect(bool enable = true);
+	/// Return if the direct output is enabled
+	virtual bool getDirect() const;
+	/// Set the gain for the direct path
+	virtual void setDirectGain(float gain = NLSOUND_DEFAULT_DIRECT_GAIN);
+	/// Get the gain for the direct path
+	virtual float getDirectGain() const;
+
+	/// Enable or disable the filter for the direct channel
+	virtual void enableDirectFilter(bool enable = true);
+	/// Check if the filter on the direct channel is enabled
+	virtual bool isDirectFilterEnabled() const;
+	/// Set the filter parameters for the direct channel
+	virtual void setDirectFilter(TFilter filter, float lowFrequency = NLSOUND_DEFAULT_FILTER_PASS_LF, float highFrequency = NLSOUND_DEFAULT_FILTER_PASS_HF, float passGain = NLSOUND_DEFAULT_FILTER_PASS_GAIN);
+	/// Get the filter parameters for the direct channel
+	virtual void getDirectFilter(TFilter &filterType, float &lowFrequency, float &highFrequency, float &passGain) const;
+	/// Set the direct filter gain
+	virtual void setDirectFilterPassGain(float passGain = NLSOUND_DEFAULT_FILTER_PASS_GAIN);
+	/// Get the direct filter gain
+	virtual float getDirectFilterPassGain() const;
+	//@}
+
+	/// \name Effect output, kept but not rendered
+	//@{
+	/// Set the effect send for this source, NULL to disable.
+	virtual void setEffect(IReverbEffect *reverbEffect);
+	/// Get the effect send for this source
+	virtual IEffect *getEffect() const;
+	/// Set the gain for the effect path
+	virtual void setEffectGain(float gain = NLSOUND_DEFAULT_EFFECT_GAIN);
+	/// Get the gain for the effect path
+	virtual float getEffectGain() const;
+
+	/// Enable or disable the filter for the effect channel
+	virtual void enableEffectFilter(bool enable = true);
+	/// Check if the filter on the effect channel is enabled
+	virtual bool isEffectFilterEnabled() const;
+	/// Set the filter parameters for the effect channel
+	virtual void setEffectFilter(TFilter filter, float lowFrequency = NLSOUND_DEFAULT_FILTER_PASS_LF, float highFrequency = NLSOUND_DEFAULT_FILTER_PASS_HF, float passGain = NLSOUND_DEFAULT_FILTER_PASS_GAIN);
+	/// Get the filter parameters for the effect channel
+	virtual void getEffectFilter(TFilter &filterType, float &lowFrequency, float &highFrequency, float &passGain) const;
+	/// Set the effect filter gain
+	virtual void setEffectFilterPassGain(float passGain = NLSOUND_DEFAULT_FILTER_PASS_GAIN);
+	/// Get the effect filter gain
+	virtual float getEffectFilterPassGain() const;
+	//@}
+
+private:
+
+	enum TState { Stopped, Playing, Paused };
+
+	/// The buffer being played, NULL if none
+	CBufferSoftware *getCurrentBuffer();
+	/// The buffer is finished, go to the next one. Return false if the source stops.
+	bool nextBuffer(CBufferSoftware *buffer);
+	/// Compute the left and right gains
+	void computeGains(bool stereo, float &gainLeft, float &gainRight) const;
+	/// Resample up to nbFrame frames of the buffer from the current position. Return the number of frames written.
+	uint resample(const CBufferSoftware *buffer, float *tempLeft, float *tempRight, uint nbFrame);
+
+	CSoundDriverSoftware		*_SoundDriver;
+
+	/// \name Buffers
+	//@{
+	CBufferSoftware				*_StaticBuffer;
+	bool						_Streaming;
+	std::deque<CBufferSoftware *>	_StreamingQueue;
+	mutable NLMISC::CMutex		_StreamingMutex;
+	//@}
+
+	/// \name Playback
+	//@{
+	TState						_State;
+	bool						_Looping;
+	/// Position in the current buffer, in frames, and fraction of frame (16 bits)
+	uint32						_Frame;
+	uint32						_Frac;
+	/// Number of output frames played since play()
+	uint32						_PlayedFrames;
+	//@}
+
+	/// \name Properties
+	//@{
+	NLMISC::CVector				_Pos;
+	NLMISC::CVector				_Velocity;
+	NLMISC::CVector				_Direction;
+	float						_Gain;
+	float						_Pitch;
+	bool						_Relative;
+	float						_MinDistance;
+	float						_MaxDistance;
+	float						_ConeInner;
+	float						_ConeOuter;
+	float						_ConeOuterGain;
+	double						_Alpha;
+	//@}
+
+	/// \name Direct and effect paths
+	//@{
+	bool						_Direct;
+	float						_DirectGain;
+	bool						_DirectFilterEnabled;
+	TFilter						_DirectFilterType;
+	float						_DirectFilterLowFrequency;
+	float						_DirectFilterHighFrequency;
+	float						_DirectFilterPassGain;
+	IReverbEffect				*_Effect;
+	float						_EffectGain;
+	bool						_EffectFilterEnabled;
+	TFilter						_EffectFilterType;
+	float						_EffectFilterLowFrequency;
+	float						_EffectFilterHighFrequency;
+	float						_EffectFilterPassGain;
+	//@}
+};
+
+} // NLSOUND
+
+#endif // NL_SOURCE_SOFTWARE_H
+
+/* End of source_software.h */
@@ -41,16 +41,19 @@ using namespace NLMISC;
 #	define NL_OPENAL_AVAILABLE 0
 #	define NL_DSOUND_AVAILABLE 0
 #	define NL_XAUDIO2_AVAILABLE 0
+#	define NL_SOFTWARE_AVAILABLE 1
 #elif defined( NL_OS_UNIX )
 #	define NL_FMOD_AVAILABLE 1
 #	define NL_OPENAL_AVAILABLE 1
 #	define NL_DSOUND_AVAILABLE 0
 #	define NL_XAUDIO2_AVAILABLE 0
+#	define NL_SOFTWARE_AVAILABLE 1
 #else
 #	define NL_FMOD_AVAILABLE 0
 #	define NL_OPENAL_AVAILABLE 0
 #	define NL_DSOUND_AVAILABLE 0
 #	define NL_XAUDIO2_AVAILABLE 0
+#	define NL_SOFTWARE_AVAILABLE 0
 #endif
 
 namespace NLSOUND
@@ -81,6 +84,9 @@ const uint32 ISoundDriver::InterfaceVersion = 0x15; // Kaetemi
 #if NL_XAUDIO2_AVAILABLE
 	NLSOUND_DECLARE_DRIVER(XAudio2)
 #endif
+#if NL_SOFTWARE_AVAILABLE
+	NLSOUND_DECLARE_DRIVER(Software)
+#endif
 
 #else
 
@@ -102,6 +108,7 @@ const char *ISoundDriver::getDriverName(TDriver driverType)
 		case DriverOpenAl: return "OpenAL";
 		case DriverDSound: return "DSound";
 		case DriverXAudio2: return "XAudio2";
+		case DriverSoftware: return "Software";
 		default: return "UNKNOWN";
 	}
 }
@@ -130,6 +137,9 @@ ISoundDriver *ISoundDriver::createDriver(IStringMapperProvider *stringMapper, TD
 #	endif
 #	if NL_XAUDIO2_AVAILABLE
 		case DriverXAudio2: result = createISoundDriverInstanceXAudio2(stringMapper); break;
+#	endif
+#	if NL_SOFTWARE_AVAILABLE
+		case DriverSoftware: result = createISoundDriverInstanceSoftware(stringMapper); break;
 #	endif
 		// auto driver = first available in this order: FMod, OpenAl, XAudio2, DSound
 #	if NL_FMOD_AVAILABLE
@@ -192,6 +202,15 @@ ISoundDriver *ISoundDriver::createDriver(IStringMapperProvider *stringMapper, TD
 		nlerror("DriverXAudio2 doesn't exist on Unix because it requires DirectX");
 #else
 #		error "Driver name not define for this platform"
+#endif
+		break;
+	case DriverSoftware:
+#ifdef NL_OS_WINDOWS
+		dllName = "nel_drv_software_win";
+#elif defined (NL_OS_UNIX)
+		dllName = "nel_drv_software";
+#else
+#		error "Driver name not define for this platform"
 #endif
 		break;
 	default:
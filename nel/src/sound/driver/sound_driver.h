@@ -78,6 +78,8 @@ public:
 		DriverDSound,
 		/// DriverXAudio2 runs on a fully software-based audio processing API without artificial limits.
 		DriverXAudio2,
+		/// DriverSoftware mixes in software without any sound device, to a wav file or to memory. For servers, tests and benchmarks.
+		DriverSoftware,
 		NumDrivers
 	};
 
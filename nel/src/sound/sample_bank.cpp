@@ -39,11 +39,16 @@ using namespace NLMISC;
 
 namespace NLSOUND {
 
-/// Constante for the number of file to load asynchronously at a time.
-uint32		ASYNC_LOADING_SPLIT = 10;		// 10 file by 10 file
+/// Number of ADPCM bytes read and decoded at a time.
+const uint	ADPCM_CHUNK_SIZE = 4096;
 
 CSampleBank::TSampleBankContainer	CSampleBank::_Banks;
 uint	CSampleBank::_LoadedSize = 0;
+uint	CSampleBank::_ResidentBudget = 0;
+uint	CSampleBank::_StreamedSize = 0;
+bool	CSampleBank::_DecodeADPCM = false;
+CSampleBank::TSampleLRU	CSampleBank::_SampleLRU;
+uint	CSampleBank::_PendingCount = 0;
 
 CSampleBank::TVirtualBankCont		CSampleBank::_VirtualBanks;
 
@@ -168,6 +173,62 @@ void CSampleBank::getLoadedSampleBankInfo(std::vector<std::pair<std::string, uin
 	}
 }
 
+// ********************************************************
+
+void CSampleBank::setResidentBudget(uint budget)
+{
+	_ResidentBudget = budget;
+	evictSamples();
+}
+
+// ********************************************************
+
+bool CSampleBank::makeResident(IBuffer *buffer, bool async)
+{
+	// Nothing to do if the sample is loaded. Without budget, the streamed banks still reload the samples evicted before.
+	if (_ResidentBudget == 0 && _PendingCount == 0 && buffer->isBufferLoaded())
+		return true;
+
+	const NLMISC::TStringId &name = buffer->getName();
+	TSampleBankContainer::iterator first(_Banks.begin()), last(_Banks.end());
+	for (; first != last; ++first)
+	{
+		CSampleBank *bank = first->second;
+		CHashMap<NLMISC::TStringId, uint, NLMISC::CStringIdHashMapTraits>::iterator it(bank->_SampleIndex.find(name));
+		if (it != bank->_SampleIndex.end() && bank->_SampleInfos[it->second].Buffer == buffer)
+			return bank->makeSampleResident(it->second, async);
+	}
+
+	// not a sample of a bank
+	return buffer->isBufferLoaded();
+}
+
+// ********************************************************
+
+void CSampleBank::evictSamples(CSampleBank *keepBank, uint keepIndex)
+{
+	if (_ResidentBudget == 0)
+		return;
+
+	CAudioMixerUser *mixer = CAudioMixerUser::instance();
+
+	// from the least recently played sample
+	TSampleLRU::iterator it(_SampleLRU.end());
+	while (_StreamedSize > _ResidentBudget && it != _SampleLRU.begin())
+	{
+		--it;
+		CSampleBank *bank = it->first;
+		uint index = it->second;
+		const TSampleInfo &info = bank->_SampleInfos[index];
+		if (info.State != SampleResident || mixer->isBufferPlaying(info.Buffer) || (bank == keepBank && index == keepIndex))
+			continue;
+
+		// unloadSample() removes the sample from the list
+		++it;
+		bank->unloadSample(index);
+	}
+}
+
 
 
 
@@ -175,7 +236,7 @@ void CSampleBank::getLoadedSampleBankInfo(std::vector<std::pair<std::string, uin
 // ********************************************************
 
 CSampleBank::CSampleBank(const std::string& name, ISoundDriver *sd)
-: _SoundDriver(sd), _Name(CStringMapper::map(name)), _Loaded(false), _LoadingDone(true), _ByteSize(0)
+: _SoundDriver(sd), _Name(CStringMapper::map(name)), _Loaded(false), _LoadingDone(true), _ByteSize(0), _DataStart(0), _Streamed(false)
 {
 //	_Name = CFile::getFilenameWithoutExtension(_Path);
 	_Banks.insert(make_pair(_Name, this));
@@ -187,11 +248,16 @@ CSampleBank::CSampleBank(const std::string& name, ISoundDriver *sd)
 CSampleBank::~CSampleBank()
 {
 	CAudioMixerUser::instance()->unregisterUpdate(this);
-	while (!_LoadingDone)
+	for (uint i=0; i<_SampleInfos.size(); ++i)
 	{
-		// need to wait for loading end.
-		nlSleep(100);
+		while (_SampleInfos[i].Pending)
+		{
+			// need to wait for loading end.
+			nlSleep(100);
+		}
 	}
+	updateLoadingSamples();
+	_LoadingDone = true;
 
 	if (_Loaded)
 		unload();
@@ -224,8 +290,6 @@ CSampleBank::~CSampleBank()
 
 void				CSampleBank::load(bool async)
 {
-	// TODO : add async loading support !
-
 	TVirtualBankCont::iterator it(_VirtualBanks.find(_Name));
 	if (it != _VirtualBanks.end())
 	{
@@ -248,9 +312,6 @@ void				CSampleBank::load(bool async)
 
 	//nlinfo("Loading sample bank %s %", CStringMapper::unmap(_Name).c_str(), async?"":"Asynchronously");
 
-	vector<string> filenames;
-//	vector<string>::iterator iter;
-
 	if (_Loaded)
 	{
 		nlwarning("Trying to load an already loaded bank : %s", CStringMapper::unmap(_Name).c_str ());
@@ -276,10 +337,15 @@ void				CSampleBank::load(bool async)
 		sampleBank.serial(sbh);
 		_LoadingDone = false;
 
-		sint32 seekStart = sampleBank.getPos();
+		_FileName = filename;
+		_DataStart = sampleBank.getPos();
+		_Streamed = (_ResidentBudget != 0);
 
+		// Read the ADPCM data if the driver plays it, or if it is decoded
+		CAudioMixerUser *mixer = CAudioMixerUser::instance();
+		bool adpcm = mixer->useAPDCM() || _DecodeADPCM;
 
-		uint8	*data = 0;
+		_SampleInfos.resize(sbh.Name.size());
 		uint	i;
 		for (i=0; i<sbh.Name.size(); ++i)
 		{
@@ -289,66 +355,42 @@ void				CSampleBank::load(bool async)
 			TStringId	nameId = CStringMapper::map(CFile::getFilenameWithoutExtension(sbh.Name[i]));
 			ibuffer->setName(nameId);
 
-	/*		{
-				sint16 *data16 = new sint16[sbh.NbSample[i]];
-				IBuffer::TADPCMState	state;
-				state.PreviousSample = 0;
-				state.StepIndex = 0;
-				uint count =0;
-				for (count=0; count+1024<sbh.NbSample[i]; count+=1024)
+			TSampleInfo &info = _SampleInfos[i];
+			info.Name = nameId;
+			info.Buffer = ibuffer;
+			info.NbSample = sbh.NbSample[i];
+			info.Frequency = sbh.Freq[i];
+			info.Adpcm = adpcm;
+			info.Offset = adpcm ? sbh.OffsetAdpcm[i] : sbh.OffsetMono16[i];
+			info.Size = adpcm ? sbh.SizeAdpcm[i] : sbh.SizeMono16[i];
+			info.State = SampleUnloaded;
+			info.Pending = false;
+			info.ResidentSize = 0;
+			info.LRUIt = _SampleLRU.end();
+
+			_SampleIndex[nameId] = i;
+			_Samples[nameId] = ibuffer;
+
+			if (!_Streamed)
+			{
+				if (async)
 				{
-					IBuffer::decodeADPCM(data+count/2, data16+count, 1024, state);
+					// filled by the async file manager, see onUpdate()
+					info.State = SampleLoading;
+					info.Pending = true;
+					++_PendingCount;
+					CAsyncFileManagerSound::getInstance().loadSampleBankSample(this, i);
 				}
-				IBuffer::decodeADPCM(data+count/2, data16+count, sbh.NbSample[i]-count, state);
-
-				state.PreviousSample = 0;
-				state.StepIndex = 0;
-				sint16	*data16_2 = new sint16[sbh.NbSample[i]];
- 				IBuffer::decodeADPCM(data, data16_2, sbh.NbSample[i], state);
-
-				for (uint j=0; j<sbh.NbSample[i]; ++j)
+				else
 				{
-					if (data16[j] != data16_2[j])
-					{
-						nlwarning("Sample differ at %u", j);
-					}
+					fillSample(sampleBank, info);
+					sampleLoaded(i);
 				}
-
-				_SoundDriver->readRawBuffer(ibuffer, sbh.Name[i], (uint8*)data16, sbh.NbSample[i]*2, Mono16, sbh.Freq[i]);
-				delete [] data16;
-				delete [] data16_2;
-			}
-	*/
-
-			if (CAudioMixerUser::instance()->useAPDCM())
-			{
-				data = (uint8*) realloc(data, sbh.SizeAdpcm[i]);
-				sampleBank.seek(seekStart + sbh.OffsetAdpcm[i], CIFile::begin);
-				sampleBank.serialBuffer(data, sbh.SizeAdpcm[i]);
-				ibuffer->setFormat(IBuffer::FormatDviAdpcm, 1, 16, sbh.Freq[i]);
-				if (!ibuffer->fill(data, sbh.SizeAdpcm[i]))
-					nlwarning("AM: ibuffer->fill returned false with FormatADPCM");
 			}
-			else
-			{
-				data = (uint8*) realloc(data, sbh.SizeMono16[i]);
-				sampleBank.seek(seekStart + sbh.OffsetMono16[i], CIFile::begin);
-				sampleBank.serialBuffer(data, sbh.SizeMono16[i]);
-				ibuffer->setFormat(IBuffer::FormatPcm, 1, 16, sbh.Freq[i]);
-				if (!ibuffer->fill(data, sbh.SizeMono16[i]))
-					nlwarning("AM: ibuffer->fill returned false with FormatPCM");
-			}
-
-			_ByteSize += ibuffer->getSize();
-
-			_Samples[nameId] = ibuffer;
 
 			// Warn the sound bank that the sample are available.
 			CSoundBank::instance()->bufferLoaded(nameId, ibuffer);
 		}
-		free(data);
-
-		_LoadedSize += _ByteSize;
 	}
 	catch(Exception &e)
 	{
@@ -364,120 +406,226 @@ void				CSampleBank::load(bool async)
 	}
 
 	_Loaded = true;
-	_LoadingDone = true;
 
+	if (hasPendingLoads())
+	{
+		// wait for the async file manager in onUpdate()
+		CAudioMixerUser::instance()->registerUpdate(this);
+	}
+	else
+	{
+		_LoadingDone = true;
+	}
+}
 
+// ********************************************************
 
-///////////////////////////////////////// OLD Version //////////////////////////////////////
-/*
+void CSampleBank::fillSample(NLMISC::IStream &bankFile, TSampleInfo &info)
+{
+	IBuffer *ibuffer = info.Buffer;
+	bankFile.seek(_DataStart + info.Offset, NLMISC::IStream::begin);
 
-	std::string list = CPath::lookup(CStringMapper::unmap(_Name)+CAudioMixerUser::SampleBankListExt, false);
-	if (list.empty())
+	if (info.Adpcm && CAudioMixerUser::instance()->useAPDCM())
 	{
-		nlwarning("File %s not found to load sample bank %s", (CStringMapper::unmap(_Name)+CAudioMixerUser::SampleBankListExt).c_str(), CStringMapper::unmap(_Name).c_str());
-		return;
+		vector<uint8>	data(info.Size);
+		if (!data.empty())
+			bankFile.serialBuffer(&data[0], info.Size);
+		ibuffer->setFormat(IBuffer::FormatDviAdpcm, 1, 16, info.Frequency);
+		if (!ibuffer->fill(data.empty() ? NULL : &data[0], info.Size))
+			nlwarning("AM: ibuffer->fill returned false with FormatADPCM");
+	}
+	else if (info.Adpcm)
+	{
+		// The driver doesn't play ADPCM, decode it chunk by chunk
+		vector<sint16>	data(info.NbSample);
+		uint8	chunk[ADPCM_CHUNK_SIZE];
+		IBuffer::TADPCMState	state;
+		state.PreviousSample = 0;
+		state.StepIndex = 0;
+		uint	decoded = 0;
+		while (decoded < info.NbSample)
+		{
+			uint nbSample = min(info.NbSample - decoded, ADPCM_CHUNK_SIZE * 2);
+			uint nbByte = (nbSample + 1) / 2;
+			bankFile.serialBuffer(chunk, nbByte);
+			IBuffer::decodeADPCM(chunk, &data[decoded], nbSample, state);
+			decoded += nbSample;
+		}
+		ibuffer->setFormat(IBuffer::FormatPcm, 1, 16, info.Frequency);
+		if (!ibuffer->fill(data.empty() ? NULL : (const uint8*)&data[0], info.NbSample * 2))
+			nlwarning("AM: ibuffer->fill returned false with decoded FormatADPCM");
+	}
+	else
+	{
+		vector<uint8>	data(info.Size);
+		if (!data.empty())
+			bankFile.serialBuffer(&data[0], info.Size);
+		ibuffer->setFormat(IBuffer::FormatPcm, 1, 16, info.Frequency);
+		if (!ibuffer->fill(data.empty() ? NULL : &data[0], info.Size))
+			nlwarning("AM: ibuffer->fill returned false with FormatPCM");
+	}
+}
+
+// ********************************************************
+
+void CSampleBank::loadSampleData(uint index)
+{
+	TSampleInfo &info = _SampleInfos[index];
+	try
+	{
+		CIFile	sampleBank(_FileName);
+		fillSample(sampleBank, info);
 	}
+	catch(Exception &e)
+	{
+		nlwarning("Exception %s during loading of sample %s from bank %s", e.what(), CStringMapper::unmap(info.Name).c_str(), _FileName.c_str());
+	}
+
+	// the main thread accounts the sample in onUpdate()
+	info.Pending = false;
+}
+
+// ********************************************************
 
+void CSampleBank::sampleLoaded(uint index)
+{
+	TSampleInfo &info = _SampleInfos[index];
+	info.State = SampleResident;
+	info.ResidentSize = info.Buffer->getSize();
+	_ByteSize += info.ResidentSize;
+	_LoadedSize += info.ResidentSize;
+	if (_Streamed)
+		_StreamedSize += info.ResidentSize;
+}
 
-	NLMISC::CIFile sampleBankList(list);
-	sampleBankList.serialCont(filenames);
+// ********************************************************
 
-	for (iter = filenames.begin(); iter != filenames.end(); iter++)
+bool CSampleBank::makeSampleResident(uint index, bool async)
+{
+	TSampleInfo &info = _SampleInfos[index];
+	switch (info.State)
 	{
-		IBuffer* ibuffer = NULL;
-		try
-		{
-			ibuffer = _SoundDriver->createBuffer();
-			nlassert(ibuffer);
+	case SampleResident:
+		// mark as the most recently played
+		if (info.LRUIt != _SampleLRU.end())
+			_SampleLRU.splice(_SampleLRU.begin(), _SampleLRU, info.LRUIt);
+		return true;
+	case SampleLoading:
+		return false;
+	default:
+		break;
+	}
 
-//			std::string sampleName(CFile::getFilenameWithoutExtension(*iter));
-			NLMISC::TStringId sampleName(CStringMapper::map(CFile::getFilenameWithoutExtension(*iter)));
+	// an unloaded sample of a bank not streamed has been unloaded with its bank
+	if (!_Streamed)
+		return false;
 
-			if (async)
-			{
-				ibuffer->presetName(sampleName);
-				nldebug("Preloading sample [%s]", CStringMapper::unmap(sampleName).c_str());
-			}
-			else
-			{
-				std::string fullName = NLMISC::CPath::lookup(*iter, false);
-				if (!fullName.empty())
-				{
-					NLMISC::CIFile	ifile(fullName);
-					uint size = ifile.getFileSize();
-					uint8 *buffer = new uint8[ifile.getFileSize()];
-					ifile.serialBuffer(buffer, size);
+	_SampleLRU.push_front(make_pair(this, index));
+	info.LRUIt = _SampleLRU.begin();
 
-					_SoundDriver->readWavBuffer(ibuffer, fullName, buffer, size);
-					_ByteSize += ibuffer->getSize();
+	if (async)
+	{
+		info.State = SampleLoading;
+		info.Pending = true;
+		++_PendingCount;
+		CAsyncFileManagerSound::getInstance().loadSampleBankSample(this, index);
+		CAudioMixerUser::instance()->registerUpdate(this);
+		return false;
+	}
 
-					delete [] buffer;
-				}
-			}
-			_Samples[sampleName] = ibuffer ;
+	loadSampleData(index);
+	sampleLoaded(index);
+	// the sample is played now, even if it is larger than the budget
+	evictSamples(this, index);
+	return true;
+}
 
-			// Warn the sound bank that the sample are available.
-			CSoundBank::instance()->bufferLoaded(sampleName, ibuffer);
-		}
-		catch (ESoundDriver &e)
-		{
-			if (ibuffer != NULL) {
-				delete ibuffer;
-				ibuffer = NULL;
-			}
-			nlwarning("Problem with file '%s': %s", (*iter).c_str(), e.what());
-		}
+// ********************************************************
+
+void CSampleBank::unloadSample(uint index)
+{
+	TSampleInfo &info = _SampleInfos[index];
+	nlassert(info.State == SampleResident);
+
+	IBuffer *buffer = info.Buffer;
+
+	// Warn the mixer to stop any track playing this buffer.
+	CAudioMixerUser::instance()->bufferUnloaded(buffer);
+	// Warn the sound banks abount this buffer.
+	CSoundBank::instance()->bufferUnloaded(info.Name);
+
+	_ByteSize -= info.ResidentSize;
+	_LoadedSize -= info.ResidentSize;
+	_StreamedSize -= info.ResidentSize;
+	info.ResidentSize = 0;
+	delete buffer;
+
+	// The drivers can't empty a buffer, replace it by an empty one for the sounds to find it
+	info.Buffer = _SoundDriver->createBuffer();
+	nlassert(info.Buffer);
+	info.Buffer->setName(info.Name);
+	_Samples[info.Name] = info.Buffer;
+	CSoundBank::instance()->bufferLoaded(info.Name, info.Buffer);
+
+	info.State = SampleUnloaded;
+	if (info.LRUIt != _SampleLRU.end())
+	{
+		_SampleLRU.erase(info.LRUIt);
+		info.LRUIt = _SampleLRU.end();
 	}
+}
 
-	_Loaded = true;
+// ********************************************************
 
-	if (!async)
+bool CSampleBank::hasPendingLoads() const
+{
+	for (uint i=0; i<_SampleInfos.size(); ++i)
 	{
-		_LoadingDone = true;
-		// compute the sample bank size.
-		_LoadedSize += _ByteSize;
+		if (_SampleInfos[i].State == SampleLoading)
+			return true;
 	}
-	else
+	return false;
+}
+
+// ********************************************************
+
+bool CSampleBank::updateLoadingSamples()
+{
+	bool	pending = false;
+	for (uint i=0; i<_SampleInfos.size(); ++i)
 	{
-		// fill the loading list.
-		TSampleTable::iterator first(_Samples.begin()), last(_Samples.end());
-		for (; first != last; ++first)
+		TSampleInfo &info = _SampleInfos[i];
+		if (info.State != SampleLoading)
+			continue;
+
+		if (info.Pending)
 		{
-			_LoadList.push_back(make_pair(first->second, first->first));
+			pending = true;
 		}
-		_SplitLoadDone = false;
-		// send the first files
-		for (uint i=0; i<ASYNC_LOADING_SPLIT && !_LoadList.empty(); ++i)
+		else
 		{
-			CAsyncFileManagerSound::getInstance().loadWavFile(_LoadList.front().first, CStringMapper::unmap(_LoadList.front().second)+".wav");
-			_LoadList.pop_front();
+			sampleLoaded(i);
+			--_PendingCount;
+			// the sample has been asked by a play, keep it for the next one
+			evictSamples(this, i);
 		}
-		// add a end loading event...
-		CAsyncFileManagerSound::getInstance().signal(&_SplitLoadDone);
-		// and register for update on the mixer
-		CAudioMixerUser::instance()->registerUpdate(this);
 	}
-	*/
+	return pending;
 }
 
+// ********************************************************
+
 void CSampleBank::onUpdate()
 {
-	if (_SplitLoadDone)
-	{
-		nldebug("Some samples have been loaded");
-		if (_LoadList.empty())
-		{
-			// all the samples are loaded, we can compute the bank size.
-			TSampleTable::iterator	first(_Samples.begin()), last(_Samples.end());
-			for (; first != last; ++first)
-			{
-				_ByteSize += first->second->getSize();
-			}
+	bool	pending = updateLoadingSamples();
 
-			_LoadedSize += _ByteSize;
+	if (!pending)
+	{
+		// stop the update.
+		CAudioMixerUser::instance()->unregisterUpdate(this);
 
-			// stop the update.
-			CAudioMixerUser::instance()->unregisterUpdate(this);
+		if (!_LoadingDone)
+		{
 			_LoadingDone = true;
 
 			// Force an update in the background manager (can restar stoped sound).
@@ -485,17 +633,6 @@ void CSampleBank::onUpdate()
 
 			nlinfo("Sample bank %s loaded.", CStringMapper::unmap(_Name).c_str());
 		}
-		else
-		{
-			_SplitLoadDone = false;
-			for (uint i=0; i<ASYNC_LOADING_SPLIT && !_LoadList.empty(); ++i)
-			{
-				CAsyncFileManagerSound::getInstance().loadWavFile(_LoadList.front().first, CStringMapper::unmap(_LoadList.front().second)+".wav");
-				_LoadList.pop_front();
-			}
-			// add a end loading event...
-			CAsyncFileManagerSound::getInstance().signal(&_SplitLoadDone);
-		}
 	}
 }
 
@@ -503,9 +640,6 @@ void CSampleBank::onUpdate()
 
 bool				CSampleBank::unload()
 {
-	vector<IBuffer*> vec;
-	TSampleTable::iterator it;
-
 	if (!_Loaded)
 	{
 		nlwarning("Trying to unload an already unloaded bank : %s", CStringMapper::unmap(_Name).c_str ());
@@ -513,32 +647,38 @@ bool				CSampleBank::unload()
 	}
 
 	// need to wait end of load ?
-	if (!_LoadingDone)
+	if (!_LoadingDone || hasPendingLoads())
 		return false;
 
 	//nlinfo("Unloading sample bank %s", CStringMapper::unmap(_Name).c_str());
 
-	for (it = _Samples.begin(); it != _Samples.end(); ++it)
+	for (uint i=0; i<_SampleInfos.size(); ++i)
 	{
-		IBuffer *buffer = it->second;
+		TSampleInfo &info = _SampleInfos[i];
+		IBuffer *buffer = info.Buffer;
 		if (buffer)
 		{
-			const NLMISC::TStringId & bufferName = buffer->getName();
-
 			// Warn the mixer to stop any track playing this buffer.
 			CAudioMixerUser::instance()->bufferUnloaded(buffer);
 			// Warn the sound banks abount this buffer.
-			CSoundBank::instance()->bufferUnloaded(bufferName);
+			CSoundBank::instance()->bufferUnloaded(info.Name);
 
 			// delete
-			it->second = NULL;
+			_Samples[info.Name] = NULL;
 			delete buffer;
 		}
+
+		if (info.LRUIt != _SampleLRU.end())
+			_SampleLRU.erase(info.LRUIt);
 	}
+	_SampleInfos.clear();
+	_SampleIndex.clear();
 
 	_Loaded = false;
 
 	_LoadedSize -= _ByteSize;
+	if (_Streamed)
+		_StreamedSize -= _ByteSize;
 	_ByteSize = 0;
 
 	return true;
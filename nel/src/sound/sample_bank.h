@@ -31,6 +31,7 @@
 #include "nel/sound/u_source.h"
 #include "audio_mixer_user.h"
 #include <string>
+#include <list>
 
 namespace NLSOUND {
 
@@ -85,6 +86,31 @@ public:
 	/// Fill a vector with current loaded sample banks.
 	static void			getLoadedSampleBankInfo(std::vector<std::pair<std::string, uint> > &result);
 
+	/** Set the memory budget of the samples, in bytes.
+	 *	With a budget, the banks loaded afterward only read their header: a sample is loaded on its
+	 *	first play, and the least recently played samples are unloaded when the samples loaded by
+	 *	these banks exceed the budget. The samples being played are never unloaded, and the samples
+	 *	of the banks loaded with all their samples are not counted in the budget.
+	 *	With 0 (the default), all the samples of a bank are loaded with the bank.
+	 */
+	static void			setResidentBudget(uint budget);
+
+	/// Return the memory budget of the samples, 0 if the samples are loaded with their bank.
+	static uint			getResidentBudget()				{	return _ResidentBudget; }
+
+	/** When the driver can't play ADPCM, read the ADPCM samples of the banks loaded afterward and
+	 *	decode them in 16 bits PCM, instead of reading the 16 bits PCM samples.
+	 *	Four times less data is read from the banks, with the ADPCM quality.
+	 */
+	static void			setDecodeADPCM(bool decode)		{	_DecodeADPCM = decode; }
+
+	/** Make the sample of a buffer loaded before playing it, and mark it as recently played.
+	 *	Return true if the buffer can be played now.
+	 *	Else the sample is loaded in background if async is true (return false, it will be available
+	 *	for a next play), or now if async is false.
+	 */
+	static bool			makeResident(IBuffer *buffer, bool async);
+
 
 
 	/// Constructor
@@ -128,11 +154,72 @@ public:
 	/// Delete all the loaded banks.
 	static	void		releaseAll();
 
+	/// Load the data of a sample in its buffer. Called by the async file manager thread.
+	void				loadSampleData(uint index);
+
 
 private:
 	/// The update method. Used when waiting for async sample loading.
 	void onUpdate();
 
+	/// State of a sample
+	enum TSampleState
+	{
+		/// The buffer is empty
+		SampleUnloaded,
+		/// The buffer is being filled by the async file manager
+		SampleLoading,
+		/// The buffer is filled
+		SampleResident
+	};
+
+	/// A sample in the LRU list: bank and index of the sample in the bank
+	typedef std::list<std::pair<CSampleBank*, uint> >	TSampleLRU;
+
+	/// A sample of the bank file
+	struct TSampleInfo
+	{
+		NLMISC::TStringId	Name;
+		IBuffer				*Buffer;
+		uint32				NbSample;
+		uint32				Frequency;
+		/// Position of the data in the bank file, after the header
+		uint32				Offset;
+		/// Size of the data in the bank file
+		uint32				Size;
+		/// The data in the bank file is ADPCM
+		bool				Adpcm;
+		TSampleState		State;
+		/// Set by the loading thread when the buffer is filled
+		volatile bool		Pending;
+		/// Size of the filled buffer, counted in the bank size
+		uint				ResidentSize;
+		/// Position in the LRU list, when streamed and not unloaded
+		TSampleLRU::iterator	LRUIt;
+	};
+
+	/// Read the data of a sample from an open bank file and fill the buffer
+	void				fillSample(NLMISC::IStream &bankFile, TSampleInfo &info);
+
+	/// Make a sample of this bank loaded, see makeResident()
+	bool				makeSampleResident(uint index, bool async);
+
+	/// Account a filled sample
+	void				sampleLoaded(uint index);
+
+	/// Account the samples filled by the async file manager, return true if some are still being filled
+	bool				updateLoadingSamples();
+
+	/// Unload a streamed sample. Its buffer is replaced by an empty one.
+	void				unloadSample(uint index);
+
+	/// Return true if some samples are being loaded by the async file manager
+	bool				hasPendingLoads() const;
+
+	/// Unload the least recently played samples to stay in the budget, except the sample keepIndex of keepBank
+	static void			evictSamples(CSampleBank *keepBank = NULL, uint keepIndex = 0);
+
+
 //	typedef std::hash_map<std::string, CSampleBank*>				TSampleBankContainer;
 	typedef CHashMap<NLMISC::TStringId, CSampleBank*, NLMISC::CStringIdHashMapTraits>			TSampleBankContainer;
 
@@ -140,6 +227,16 @@ private:
 	static TSampleBankContainer			_Banks;
 	// The total size of loaded samples.
 	static	uint						_LoadedSize;
+	// The budget of the loaded samples, 0 for no streaming.
+	static	uint						_ResidentBudget;
+	// The size of the loaded samples of the streamed banks, compared with the budget.
+	static	uint						_StreamedSize;
+	// Read the ADPCM data when the driver plays PCM.
+	static	bool						_DecodeADPCM;
+	// The streamed samples, the most recently played first.
+	static	TSampleLRU					_SampleLRU;
+	// Number of samples being loaded in all the banks.
+	static	uint						_PendingCount;
 
 	// Sound driver
 	ISoundDriver		*_SoundDriver;
@@ -158,11 +255,15 @@ private:
 	// The size of the samples in the bank
 	uint				_ByteSize;
 
-	/// Flag for splitted load.
-	bool				_SplitLoadDone;
+	// The bank file and the position of the sample data in it
+	std::string			_FileName;
+	uint32				_DataStart;
+	// The samples are loaded on their first play
+	bool				_Streamed;
 
-	/// List of sample that need to be loaded asynchronously.
-	std::list<std::pair<IBuffer *, NLMISC::TStringId> >	_LoadList;
+	// The samples of the bank file, and their index by name
+	std::vector<TSampleInfo>	_SampleInfos;
+	CHashMap<NLMISC::TStringId, uint, NLMISC::CStringIdHashMapTraits>	_SampleIndex;
 
 	struct TFilteredBank
 	{
@@ -29,6 +29,7 @@
 #include "mixing_track.h"
 #include "simple_sound.h"
 #include "clustered_sound.h"
+#include "sample_bank.h"
 
 using namespace NLMISC;
 
@@ -132,10 +133,12 @@ void					CSimpleSource::play()
 
 	// -- Some test to scheck if we can play the source
 
-	// Check if sample buffer is available and if the sound source is not too far
+	// Check if sample buffer is available and if the sound source is not too far.
+	// A streamed sample is loaded on the first play, in background unless the source can't be discarded.
 	if (_Sound->getBuffer() == 0
-		|| !_Sound->getBuffer()->isBufferLoaded()
-		|| (mixer->getListenPosVector() - _Position).sqrnorm() > _Sound->getMaxDistance()*_Sound->getMaxDistance())
+		|| (mixer->getListenPosVector() - _Position).sqrnorm() > _Sound->getMaxDistance()*_Sound->getMaxDistance()
+		|| !CSampleBank::makeResident(_Sound->getBuffer(), _Priority != HighestPri)
+		|| !_Sound->getBuffer()->isBufferLoaded())
 	{
 		// The sample buffer is not available, don't play (we don't know the lenght)
 		if (_Spawn)
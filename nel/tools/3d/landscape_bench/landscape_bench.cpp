@@ -0,0 +1,211 @@
+/** \file landscape_bench.cpp
+ * landscape_bench.cpp : Headless landscape micro benchmark (patch evaluation, refine, refineAll)
+ *
+ * $Id$
+ */
+
+/* Copyright, 2000 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/file.h"
+#include "nel/misc/vector.h"
+#include "nel/misc/aabbox.h"
+#include "nel/misc/time_nl.h"
+#include "nel/3d/zone.h"
+#include "nel/3d/patch.h"
+#include "nel/3d/landscape.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+using namespace std;
+using namespace NLMISC;
+using namespace NL3D;
+
+
+// ***************************************************************************
+static double	getMilliSeconds(TTicks start)
+{
+	return CTime::ticksToSecond(CTime::getPerformanceTime() - start) * 1000.0;
+}
+
+
+// ***************************************************************************
+// Evaluate all the patchs of all the zones on a 4*order grid. Return the number of vertices computed.
+static uint	benchComputeVertex(const CLandscape &landscape, const vector<uint16> &zoneIds, uint numLoops, double &timeMs)
+{
+	uint	numVertices= 0;
+	float	dummy= 0;
+	TTicks	start= CTime::getPerformanceTime();
+	for(uint loop=0;loop<numLoops;loop++)
+	{
+		for(uint z=0;z<zoneIds.size();z++)
+		{
+			const CZone	*zone= landscape.getZone(zoneIds[z]);
+			if(!zone)
+				continue;
+			for(sint p=0;p<zone->getNumPatchs();p++)
+			{
+				const CPatch	*pa= zone->getPatch(p);
+				uint	ordS= 4*pa->getOrderS();
+				uint	ordT= 4*pa->getOrderT();
+				float	OOS= 1.0f/ordS;
+				float	OOT= 1.0f/ordT;
+				for(uint t=0;t<=ordT;t++)
+				{
+					for(uint s=0;s<=ordS;s++)
+					{
+						CVector	v= pa->computeVertex(s*OOS, t*OOT);
+						dummy+= v.z;
+					}
+				}
+				numVertices+= (ordS+1)*(ordT+1);
+			}
+		}
+	}
+	timeMs= getMilliSeconds(start);
+
+	// Avoid the compiler to optimize out the loop.
+	if(dummy==FLT_MAX)
+		printf(" ");
+
+	return numVertices;
+}
+
+
+// ***************************************************************************
+int main(int argc, char* argv[])
+{
+	try
+	{
+		// Parse the options
+		uint	numFrames= 1000;
+		uint	numLoops= 10;
+		float	threshold= 0.001f;
+		float	height= 2.f;
+		vector<string>	zoneFiles;
+		for(sint i=1;i<argc;i++)
+		{
+			if(strcmp(argv[i], "-frames")==0 && i+1<argc)
+				numFrames= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-loops")==0 && i+1<argc)
+				numLoops= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-threshold")==0 && i+1<argc)
+				threshold= (float)atof(argv[++i]);
+			else if(strcmp(argv[i], "-height")==0 && i+1<argc)
+				height= (float)atof(argv[++i]);
+			else
+				zoneFiles.push_back(argv[i]);
+		}
+
+		// Good number of args ?
+		if (zoneFiles.empty())
+		{
+			// Help message
+			printf ("landscape_bench [-frames n] [-loops n] [-threshold t] [-height h] zone0.zone [zone1.zone ...]\n");
+			printf ("Load the zones in a landscape without driver and time:\n");
+			printf ("\t- the patch vertex computation on a 4*order grid, done \"loops\" times\n");
+			printf ("\t- refine() for \"frames\" frames, on a camera path crossing the zones diagonaly at \"height\" meters\n");
+			printf ("\t- refineAll()\n");
+			return -1;
+		}
+
+		// Create the landscape
+		CLandscape		landscape;
+		landscape.init();
+		landscape.setThreshold(threshold);
+
+		// Load the zones
+		vector<uint16>	zoneIds;
+		CAABBox			bbox;
+		uint			numPatchs= 0;
+		for(uint i=0;i<zoneFiles.size();i++)
+		{
+			CIFile	input;
+			if (!input.open(zoneFiles[i]))
+			{
+				fprintf (stderr, "Can't open the file %s\n", zoneFiles[i].c_str());
+				continue;
+			}
+
+			CZone	zone;
+			zone.serial(input);
+			if (!landscape.addZone(zone))
+			{
+				fprintf (stderr, "Can't add the zone %s (already loaded?)\n", zoneFiles[i].c_str());
+				continue;
+			}
+
+			if(zoneIds.empty())
+				bbox= zone.getZoneBB().getAABBox();
+			else
+				bbox= CAABBox::computeAABBoxUnion(bbox, zone.getZoneBB().getAABBox());
+			zoneIds.push_back(zone.getZoneId());
+			numPatchs+= zone.getNumPatchs();
+		}
+		if (zoneIds.empty())
+		{
+			fprintf (stderr, "No zone loaded\n");
+			return -1;
+		}
+		printf ("%d zones loaded, %d patchs\n", (uint)zoneIds.size(), numPatchs);
+
+		// Patch vertex computation
+		double	timeMs;
+		uint	numVertices= benchComputeVertex(landscape, zoneIds, numLoops, timeMs);
+		printf ("computeVertex: %d vertices in %.2f ms (%.1f ns/vertex)\n", numVertices, timeMs,
+			numVertices ? timeMs*1000000.0/numVertices : 0.0);
+
+		// Refine along the diagonal of the zones, with the camera at some meters over the ground.
+		CVector	pathStart= bbox.getMin();
+		CVector	pathEnd= bbox.getMax();
+		pathStart.z= pathEnd.z= bbox.getCenter().z + height;
+		TTicks	start= CTime::getPerformanceTime();
+		double	maxFrameMs= 0;
+		for(uint frame=0;frame<numFrames;frame++)
+		{
+			TTicks	frameStart= CTime::getPerformanceTime();
+			float	f= numFrames>1 ? float(frame)/(numFrames-1) : 0.f;
+			landscape.refine(pathStart*(1-f) + pathEnd*f);
+			maxFrameMs= max(maxFrameMs, getMilliSeconds(frameStart));
+		}
+		timeMs= getMilliSeconds(start);
+		vector<const CTessFace*>	leaves;
+		landscape.getTessellationLeaves(leaves);
+		printf ("refine: %d frames in %.2f ms (%.3f ms/frame, max %.3f ms), %d faces at end\n", numFrames, timeMs,
+			numFrames ? timeMs/numFrames : 0.0, maxFrameMs, (uint)leaves.size());
+
+		// Refine all
+		start= CTime::getPerformanceTime();
+		landscape.refineAll(pathEnd);
+		timeMs= getMilliSeconds(start);
+		landscape.getTessellationLeaves(leaves);
+		printf ("refineAll: %.2f ms, %d faces\n", timeMs, (uint)leaves.size());
+	}
+	catch (Exception& e)
+	{
+		fprintf (stderr, "%s\n", e.what ());
+		return -1;
+	}
+
+	return 0;
+}
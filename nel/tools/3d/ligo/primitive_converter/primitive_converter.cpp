@@ -0,0 +1,129 @@
+/** \file primitive_converter.cpp
+ * Convert ligo primitive files between the xml and the binary formats
+ */
+
+/* Copyright, 2000-2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/path.h"
+#include "nel/misc/file.h"
+#include "nel/ligo/ligo_config.h"
+#include "nel/ligo/primitive.h"
+#include "nel/ligo/primitive_utils.h"
+#include <string>
+#include <vector>
+#include "stdio.h"
+
+using namespace NLLIGO;
+using namespace NLMISC;
+using namespace std;
+
+// Extension of the binary primitive files
+static const char	*BinaryExtension = "binprim";
+
+// ***************************************************************************
+
+static bool convertFile (const string &input, const string &output, CLigoConfig &config)
+{
+	CPrimitives primDoc;
+	CPrimitiveContext::instance().CurrentPrimitive = &primDoc;
+
+	bool toXml = (CFile::getExtension (input) == BinaryExtension);
+	bool ok;
+	if (toXml)
+		ok = loadBinaryPrimitiveFile (primDoc, input);
+	else
+		ok = loadXmlPrimitiveFile (primDoc, input, config);
+
+	CPrimitiveContext::instance().CurrentPrimitive = NULL;
+
+	if (!ok)
+	{
+		printf ("unable to read %s\n", input.c_str ());
+		return false;
+	}
+
+	if (toXml)
+		ok = saveXmlPrimitiveFile (primDoc, output);
+	else
+		ok = saveBinaryPrimitiveFile (primDoc, output);
+
+	if (!ok)
+	{
+		printf ("unable to write %s\n", output.c_str ());
+		return false;
+	}
+
+	printf ("%s -> %s\n", input.c_str (), output.c_str ());
+	return true;
+}
+
+// ***************************************************************************
+
+int main(int argc, char **argv)
+{
+	if (argc != 4)
+	{
+		printf ("usage : %s ligo_class.xml input output\n", argv[0]);
+		printf ("  file.primitive file.%s : convert a xml primitive file to binary\n", BinaryExtension);
+		printf ("  file.%s file.primitive : convert a binary primitive file to xml\n", BinaryExtension);
+		printf ("  input_dir output_dir : convert all the .primitive files of input_dir to binary\n");
+		return -1;
+	}
+
+	// Init ligo
+	NLLIGO::Register ();
+	CLigoConfig config;
+	CPrimitiveContext::instance().CurrentLigoConfig = &config;
+	if (!config.readPrimitiveClass (argv[1], false))
+	{
+		printf ("unable to read the primitive classes %s\n", argv[1]);
+		return -1;
+	}
+
+	string input = argv[2];
+	string output = argv[3];
+	if (!CFile::isDirectory (input))
+		return convertFile (input, output, config) ? 0 : -1;
+
+	// Convert a directory
+	vector<string> files;
+	CPath::getPathContent (input, false, false, true, files);
+	if (!CFile::isExists (output))
+		CFile::createDirectoryTree (output);
+	output = CPath::standardizePath (output);
+
+	uint errors = 0;
+	for (uint i=0; i<files.size (); i++)
+	{
+		if (CFile::getExtension (files[i]) != "primitive")
+			continue;
+		string outputFile = output + CFile::getFilenameWithoutExtension (files[i]) + "." + BinaryExtension;
+		if (!convertFile (files[i], outputFile, config))
+			errors++;
+	}
+
+	if (errors)
+	{
+		printf ("%d files not converted\n", errors);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,224 @@
+/** \file ps_bench.cpp
+ * ps_bench.cpp : Headless particle system benchmark (serial and parallel animation of N instances)
+ *
+ * $Id$
+ */
+
+/* Copyright, 2000 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/file.h"
+#include "nel/misc/path.h"
+#include "nel/misc/time_nl.h"
+#include "nel/3d/register_3d.h"
+#include "nel/3d/scene.h"
+#include "nel/3d/shape.h"
+#include "nel/3d/shape_bank.h"
+#include "nel/3d/particle_system.h"
+#include "nel/3d/particle_system_shape.h"
+#include "nel/3d/particle_system_model.h"
+#include "nel/3d/particle_system_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+using namespace NLMISC;
+using namespace NL3D;
+
+
+// ***************************************************************************
+static double	getMilliSeconds(TTicks start)
+{
+	return CTime::ticksToSecond(CTime::getPerformanceTime() - start) * 1000.0;
+}
+
+
+// ***************************************************************************
+// Load the shapes in the shape bank of the scene. Return the names of the particle system shapes.
+static void	loadShapes(CScene &scene, CShapeBank &shapeBank, const vector<string> &psFiles, vector<string> &shapeNames)
+{
+	shapeNames.clear();
+	for(uint i=0;i<psFiles.size();i++)
+	{
+		CIFile	input;
+		if (!input.open(psFiles[i]))
+		{
+			fprintf (stderr, "Can't open the file %s\n", psFiles[i].c_str());
+			continue;
+		}
+		CShapeStream	shapeStream;
+		shapeStream.serial(input);
+		CParticleSystemShape	*shape= dynamic_cast<CParticleSystemShape*>(shapeStream.getShapePointer());
+		if (!shape)
+		{
+			fprintf (stderr, "%s is not a particle system\n", psFiles[i].c_str());
+			delete shapeStream.getShapePointer();
+			continue;
+		}
+
+		// There is no clip in this bench, so the instances must be animated by the manager whatever their visibility:
+		// rebuild the shape from a system that is always animated, and never destroyed.
+		CParticleSystem	*ps= shape->instanciatePS(scene);
+		ps->setAnimType(CParticleSystem::AnimAlways);
+		ps->setDestroyCondition(CParticleSystem::none);
+		CParticleSystemShape	*animatedShape= new CParticleSystemShape;
+		animatedShape->buildFromPS(*ps);
+		delete ps;
+		delete shape;
+
+		string	name= CFile::getFilename(psFiles[i]);
+		shapeBank.add(name, animatedShape);
+		shapeNames.push_back(name);
+	}
+}
+
+
+// ***************************************************************************
+// Step numInstances systems for numFrames frames, with numThreads worker threads. Return the time in ms.
+static double	benchAnimate(const vector<string> &psFiles, uint numInstances, uint numFrames, float deltaT, uint numThreads,
+							 uint &numConcurrent, uint &numParticles, uint &numAlive)
+{
+	CScene		scene(false);
+	scene.initDefaultRoots();
+	scene.initQuadGridClipManager();
+	CShapeBank	shapeBank;
+	scene.setShapeBank(&shapeBank);
+
+	vector<string>	shapeNames;
+	loadShapes(scene, shapeBank, psFiles, shapeNames);
+	if (shapeNames.empty())
+		return 0;
+
+	// Create the instances
+	vector<CParticleSystemModel*>	models;
+	numConcurrent= 0;
+	for(uint i=0;i<numInstances;i++)
+	{
+		CParticleSystemModel	*model= dynamic_cast<CParticleSystemModel*>(scene.createInstance(shapeNames[i % shapeNames.size()]));
+		if (!model)
+			continue;
+		model->enableAutoGetEllapsedTime(false);
+		model->setEllapsedTime(deltaT);
+		model->forceInstanciate();
+		models.push_back(model);
+		if (model->getPS() && model->getPS()->canStepConcurrently())
+			numConcurrent++;
+	}
+
+	CParticleSystemManager	&manager= scene.getParticleSystemManager();
+	manager.enableParallelAnimate(numThreads);
+
+	TTicks	start= CTime::getPerformanceTime();
+	for(uint frame=0;frame<numFrames;frame++)
+	{
+		manager.processAnimate(deltaT);
+	}
+	double	timeMs= getMilliSeconds(start);
+
+	numParticles= 0;
+	numAlive= 0;
+	for(uint i=0;i<models.size();i++)
+	{
+		const CParticleSystem	*ps= models[i]->getPS();
+		if (ps)
+		{
+			numParticles+= ps->getCurrNumParticles();
+			numAlive++;
+		}
+	}
+
+	manager.enableParallelAnimate(0);
+	for(uint i=0;i<models.size();i++)
+		scene.deleteInstance(models[i]);
+
+	return timeMs;
+}
+
+
+// ***************************************************************************
+int main(int argc, char* argv[])
+{
+	try
+	{
+		// Parse the options
+		uint	numInstances= 100;
+		uint	numFrames= 300;
+		float	deltaT= 0.03f;
+		uint	numThreads= 3;
+		vector<string>	psFiles;
+		for(sint i=1;i<argc;i++)
+		{
+			if(strcmp(argv[i], "-instances")==0 && i+1<argc)
+				numInstances= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-frames")==0 && i+1<argc)
+				numFrames= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-dt")==0 && i+1<argc)
+				deltaT= (float)atof(argv[++i]);
+			else if(strcmp(argv[i], "-threads")==0 && i+1<argc)
+				numThreads= atoi(argv[++i]);
+			else
+				psFiles.push_back(argv[i]);
+		}
+
+		// Good number of args ?
+		if (psFiles.empty())
+		{
+			// Help message
+			printf ("ps_bench [-instances n] [-frames n] [-dt seconds] [-threads n] fx0.ps [fx1.ps ...]\n");
+			printf ("Create \"instances\" instances of the particle systems in a scene without driver,\n");
+			printf ("and time \"frames\" animation steps of \"dt\" seconds:\n");
+			printf ("\t- in the main thread only\n");
+			printf ("\t- with \"threads\" worker threads, in parallel with the main thread\n");
+			return -1;
+		}
+
+		registerSerial3d();
+		CScene::registerBasics();
+
+		uint	numConcurrent, numParticles, numAlive;
+		double	serialMs= benchAnimate(psFiles, numInstances, numFrames, deltaT, 0, numConcurrent, numParticles, numAlive);
+		if (numAlive==0 && serialMs==0)
+		{
+			fprintf (stderr, "No particle system loaded\n");
+			return -1;
+		}
+		printf ("%d instances, %d can be stepped concurrently\n", numInstances, numConcurrent);
+		printf ("serial: %d frames in %.2f ms (%.3f ms/frame), %d systems alive, %d particles at end\n", numFrames, serialMs,
+			numFrames ? serialMs/numFrames : 0.0, numAlive, numParticles);
+
+		if (numThreads)
+		{
+			double	parallelMs= benchAnimate(psFiles, numInstances, numFrames, deltaT, numThreads, numConcurrent, numParticles, numAlive);
+			printf ("parallel (%d threads): %d frames in %.2f ms (%.3f ms/frame), %d systems alive, %d particles at end\n", numThreads,
+				numFrames, parallelMs, numFrames ? parallelMs/numFrames : 0.0, numAlive, numParticles);
+			if (parallelMs > 0)
+				printf ("speedup: %.2f\n", serialMs/parallelMs);
+		}
+	}
+	catch (Exception& e)
+	{
+		fprintf (stderr, "%s\n", e.what ());
+		return -1;
+	}
+
+	return 0;
+}
@@ -11,12 +11,17 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <set>
 
 #include "nel/misc/debug.h"
 #include "nel/misc/file.h"
 #include "nel/misc/path.h"
 #include "nel/misc/algo.h"
 #include "nel/misc/common.h"
+#include "nel/misc/big_file.h"
+#include "nel/misc/lz4_block.h"
+#include "nel/misc/sha1.h"
 
 
 using namespace std;
@@ -31,6 +36,14 @@ public:
 	bool		Not;
 };
 std::vector<CWildCard>	WildCards;
+// Files stored even if the compression is on
+std::vector<string>		StoreWildCards;
+
+// Write a v1 bnp
+bool					WriteV1 = false;
+// Compress the files of a v2 bnp
+bool					Compress = false;
+const uint32			BlockSize = 64 * 1024;
 
 // ---------------------------------------------------------------------------
 
@@ -64,17 +77,30 @@ struct BNPFile
 {
 	string Name;
 	uint32 Size;
-	uint32 Pos;
+	uint64 Pos;
+	// v2
+	uint64 StoredSize;
+	uint8 Compression;
+	vector<uint32> BlockSizes;
+	CHashKey ContentHash;
 };
 
 struct BNPHeader
 {
 	vector<BNPFile>			Files;
-	uint32					OffsetFromBeginning;
+	uint64					OffsetFromBeginning;
+	// Block size of the bnp read
+	uint32					ReadBlockSize;
 
-	// Append the header to the big file
+	// Append the v1 header to the big file
 	bool append (const string &filename)
 	{
+		if (OffsetFromBeginning > 0xffffffff)
+		{
+			printf ("error the files are larger than 4 GB, a v1 bnp can't hold them\n");
+			return false;
+		}
+
 		FILE *f = fopen (filename.c_str(), "ab");
 		if (f == NULL) return false;
 
@@ -83,25 +109,119 @@ struct BNPHeader
 		for (uint32 i = 0; i < nNbFile; ++i)
 		{
 			uint8 nStringSize = Files[i].Name.size();
+			uint32 nFilePos = (uint32)Files[i].Pos;
 			fwrite (&nStringSize, 1, 1, f);
 			fwrite (Files[i].Name.c_str(), 1, nStringSize, f);
 			fwrite (&Files[i].Size, sizeof(uint32), 1, f);
-			fwrite (&Files[i].Pos, sizeof(uint32), 1, f);
+			fwrite (&nFilePos, sizeof(uint32), 1, f);
 		}
-		fwrite (&OffsetFromBeginning, sizeof(uint32), 1, f);
+		uint32 nOffsetFromBeginning = (uint32)OffsetFromBeginning;
+		fwrite (&nOffsetFromBeginning, sizeof(uint32), 1, f);
 
 		fclose (f);
 		return true;
 	}
 
-	// Read the header from a big file
+	// Append the v2 directory and footer to the big file
+	bool append2 (const string &filename)
+	{
+		FILE *f = fopen (filename.c_str(), "ab");
+		if (f == NULL) return false;
+
+		// Names, blocks and hash table
+		string names;
+		vector<uint32> blockSizes;
+		vector<CBigFile::CBNP2Entry> entries (Files.size());
+		uint32 hashSize = 1;
+		while (hashSize <= Files.size()*2)
+			hashSize <<= 1;
+		vector<uint32> hashTable (hashSize, 0);
+		for (uint32 i = 0; i < Files.size(); ++i)
+		{
+			BNPFile &file = Files[i];
+			CBigFile::CBNP2Entry &entry = entries[i];
+			memset (&entry, 0, sizeof(entry));
+			string name = toLower (file.Name);
+			entry.NameHash = CBigFile::hashFileName (name.c_str());
+			entry.Pos = file.Pos;
+			entry.Size = file.Size;
+			entry.StoredSize = file.StoredSize;
+			entry.NameOffset = names.size();
+			names += name;
+			names += '\0';
+			entry.Compression = file.Compression;
+			if (file.Compression == CBigFile::Stored)
+			{
+				entry.FirstBlock = CBigFile::NoBlock;
+			}
+			else
+			{
+				entry.FirstBlock = blockSizes.size();
+				blockSizes.insert (blockSizes.end(), file.BlockSizes.begin(), file.BlockSizes.end());
+			}
+			memcpy (entry.ContentHash, file.ContentHash.HashKeyString.data(), sizeof(entry.ContentHash));
+
+			uint32 slot = (uint32)entry.NameHash & (hashSize-1);
+			while (hashTable[slot] != 0)
+				slot = (slot+1) & (hashSize-1);
+			hashTable[slot] = i+1;
+		}
+
+		CBigFile::CBNP2Header header;
+		memset (&header, 0, sizeof(header));
+		header.Magic = CBigFile::BNP2Magic;
+		header.Version = CBigFile::BNP2Version;
+		header.NumFiles = Files.size();
+		header.HashSize = hashSize;
+		header.BlockSize = BlockSize;
+		header.NumBlocks = blockSizes.size();
+		header.NamesSize = names.size();
+		if (names.empty())
+		{
+			// The names end with a 0
+			names += '\0';
+			header.NamesSize = 1;
+		}
+
+		fwrite (&header, sizeof(header), 1, f);
+		if (!entries.empty())
+			fwrite (&entries[0], sizeof(CBigFile::CBNP2Entry), entries.size(), f);
+		fwrite (&hashTable[0], sizeof(uint32), hashTable.size(), f);
+		if (!blockSizes.empty())
+			fwrite (&blockSizes[0], sizeof(uint32), blockSizes.size(), f);
+		fwrite (names.data(), 1, names.size(), f);
+
+		CBigFile::CBNP2Footer footer;
+		footer.DirOffset = OffsetFromBeginning;
+		footer.DirSize = sizeof(header) + entries.size()*sizeof(CBigFile::CBNP2Entry) + (hashTable.size()+blockSizes.size())*sizeof(uint32) + names.size();
+		footer.Magic = CBigFile::BNP2Magic;
+		fwrite (&footer, sizeof(footer), 1, f);
+
+		bool ok = ferror (f) == 0;
+		fclose (f);
+		return ok;
+	}
+
+	// Read the header from a big file, v1 or v2
 	bool read (const string &filename)
 	{
 		FILE *f = fopen (filename.c_str(), "rb");
 		if (f == NULL) return false;
 
 		nlfseek64 (f, 0, SEEK_END);
-		uint32 nFileSize=CFile::getFileSize (filename);
+		sint64 nFileSize = nlftell64 (f);
+
+		// v2 ?
+		CBigFile::CBNP2Footer footer;
+		if (nFileSize >= (sint64)sizeof(footer) && nlfseek64 (f, nFileSize-sizeof(footer), SEEK_SET) == 0 &&
+			fread (&footer, sizeof(footer), 1, f) == 1 && footer.Magic == CBigFile::BNP2Magic &&
+			footer.DirOffset + footer.DirSize + sizeof(footer) == (uint64)nFileSize)
+		{
+			bool ok = read2 (f, footer);
+			fclose (f);
+			return ok;
+		}
+
 		nlfseek64 (f, nFileSize-sizeof(uint32), SEEK_SET);
 		uint32 nOffsetFromBegining;
 		fread (&nOffsetFromBegining, sizeof(uint32), 1, f);
@@ -124,18 +244,70 @@ struct BNPHeader
 			tmpBNPFile.Name = sName;
 			if (fread (&tmpBNPFile.Size, sizeof(uint32), 1, f) != 1)
 				return false;
-			if (fread (&tmpBNPFile.Pos, sizeof(uint32), 1, f) != 1)
+			uint32 nFilePos;
+			if (fread (&nFilePos, sizeof(uint32), 1, f) != 1)
 				return false;
+			tmpBNPFile.Pos = nFilePos;
+			tmpBNPFile.StoredSize = tmpBNPFile.Size;
+			tmpBNPFile.Compression = CBigFile::Stored;
 			Files.push_back (tmpBNPFile);
 		}
 
 		fclose (f);
 		return true;
 	}
+
+	// Read a v2 directory
+	bool read2 (FILE *f, const CBigFile::CBNP2Footer &footer)
+	{
+		CBigFile::CBNP2Header header;
+		if (nlfseek64 (f, footer.DirOffset, SEEK_SET) != 0 || fread (&header, sizeof(header), 1, f) != 1)
+			return false;
+		if (header.Version != CBigFile::BNP2Version || header.BlockSize == 0)
+			return false;
+		ReadBlockSize = header.BlockSize;
+
+		vector<CBigFile::CBNP2Entry> entries (header.NumFiles);
+		vector<uint32> hashTable (header.HashSize);
+		vector<uint32> blockSizes (header.NumBlocks);
+		vector<char> names (header.NamesSize+1, 0);
+		if ((!entries.empty() && fread (&entries[0], sizeof(CBigFile::CBNP2Entry), entries.size(), f) != entries.size()) ||
+			(!hashTable.empty() && fread (&hashTable[0], sizeof(uint32), hashTable.size(), f) != hashTable.size()) ||
+			(!blockSizes.empty() && fread (&blockSizes[0], sizeof(uint32), blockSizes.size(), f) != blockSizes.size()) ||
+			fread (&names[0], 1, header.NamesSize, f) != header.NamesSize)
+			return false;
+
+		for (uint32 i = 0; i < entries.size(); ++i)
+		{
+			const CBigFile::CBNP2Entry &entry = entries[i];
+			BNPFile tmpBNPFile;
+			if (entry.NameOffset >= header.NamesSize || entry.Size > 0xffffffff)
+				return false;
+			tmpBNPFile.Name = &names[entry.NameOffset];
+			tmpBNPFile.Size = (uint32)entry.Size;
+			tmpBNPFile.Pos = entry.Pos;
+			tmpBNPFile.StoredSize = entry.StoredSize;
+			tmpBNPFile.Compression = entry.Compression;
+			tmpBNPFile.ContentHash = CHashKey (entry.ContentHash);
+			if (entry.Compression != CBigFile::Stored)
+			{
+				uint32 numBlocks = (tmpBNPFile.Size + header.BlockSize - 1) / header.BlockSize;
+				if ((uint64)entry.FirstBlock + numBlocks > blockSizes.size())
+					return false;
+				tmpBNPFile.BlockSizes.assign (blockSizes.begin()+entry.FirstBlock, blockSizes.begin()+entry.FirstBlock+numBlocks);
+			}
+			Files.push_back (tmpBNPFile);
+		}
+		return true;
+	}
 };
 
 string gDestBNPFile;
 BNPHeader gBNPHeader;
+// v2 files already added, by content
+map<CHashKey, uint32> gContents;
+// v2 files already added, by name
+set<string> gNames;
 
 // ---------------------------------------------------------------------------
 void append(const string &filename1, const string &filename2, uint32 sizeToRead)
@@ -154,6 +326,108 @@ void append(const string &filename1, const string &filename2, uint32 sizeToRead)
 	fclose(f1);
 }
 
+// ---------------------------------------------------------------------------
+bool appendBuffer(const string &filename, const uint8 *buffer, uint32 size)
+{
+	FILE *f = fopen(filename.c_str(), "ab");
+	if (f == NULL) return false;
+	bool ok = (size == 0) || (fwrite (buffer, size, 1, f) == 1);
+	fclose(f);
+	return ok;
+}
+
+// ---------------------------------------------------------------------------
+bool storeFile(const string &name)
+{
+	string file = toLower(name);
+	for (uint i=0; i<StoreWildCards.size(); i++)
+	{
+		if (testWildCard(file.c_str(), StoreWildCards[i].c_str()))
+			return true;
+	}
+	return false;
+}
+
+// ---------------------------------------------------------------------------
+// Compress a file by blocks. Return false if it doesn't gain anything.
+bool compressFile(const vector<uint8> &content, vector<uint8> &stored, vector<uint32> &blockSizes)
+{
+	uint32 size = content.size();
+	vector<uint8> block (lz4CompressBound (BlockSize));
+	for (uint32 pos = 0; pos < size; pos += BlockSize)
+	{
+		uint32 length = min (BlockSize, size - pos);
+		// Keep the compressed block only if it is smaller
+		uint32 compressedSize = lz4Compress (&content[pos], length, &block[0], length-1);
+		if (compressedSize == 0)
+		{
+			blockSizes.push_back (length | CBigFile::RawBlockFlag);
+			stored.insert (stored.end(), content.begin()+pos, content.begin()+pos+length);
+		}
+		else
+		{
+			blockSizes.push_back (compressedSize);
+			stored.insert (stored.end(), block.begin(), block.begin()+compressedSize);
+		}
+	}
+	return stored.size() < size;
+}
+
+// ---------------------------------------------------------------------------
+// Add a file to a v2 bnp
+bool addFile2(const string &filename, BNPFile &ftmp)
+{
+	if (!gNames.insert (toLower (ftmp.Name)).second)
+	{
+		printf("error %s is already in the bnp\n", ftmp.Name.c_str());
+		return false;
+	}
+
+	vector<uint8> content (ftmp.Size);
+	FILE *f = fopen (filename.c_str(), "rb");
+	if (f == NULL) return false;
+	bool ok = (ftmp.Size == 0) || (fread (&content[0], ftmp.Size, 1, f) == 1);
+	fclose (f);
+	if (!ok) return false;
+
+	ftmp.ContentHash = getSHA1 (content.empty() ? NULL : &content[0], ftmp.Size);
+
+	// Same content as a file already added, share its data
+	map<CHashKey, uint32>::iterator it = gContents.find (ftmp.ContentHash);
+	if (it != gContents.end())
+	{
+		const BNPFile &same = gBNPHeader.Files[it->second];
+		ftmp.Pos = same.Pos;
+		ftmp.StoredSize = same.StoredSize;
+		ftmp.Compression = same.Compression;
+		ftmp.BlockSizes = same.BlockSizes;
+		printf("sharing %s with %s\n", ftmp.Name.c_str(), same.Name.c_str());
+		return true;
+	}
+
+	vector<uint8> stored;
+	ftmp.Pos = gBNPHeader.OffsetFromBeginning;
+	if (Compress && ftmp.Size > 0 && !storeFile (ftmp.Name) && compressFile (content, stored, ftmp.BlockSizes))
+	{
+		ftmp.Compression = CBigFile::LZ4Blocks;
+		ftmp.StoredSize = stored.size();
+	}
+	else
+	{
+		ftmp.Compression = CBigFile::Stored;
+		ftmp.StoredSize = ftmp.Size;
+		ftmp.BlockSizes.clear();
+		stored.swap (content);
+	}
+
+	if (!appendBuffer (gDestBNPFile, stored.empty() ? NULL : &stored[0], stored.size()))
+		return false;
+
+	gContents.insert (make_pair (ftmp.ContentHash, (uint32)gBNPHeader.Files.size()));
+	gBNPHeader.OffsetFromBeginning += ftmp.StoredSize;
+	return true;
+}
+
 // ---------------------------------------------------------------------------
 bool i_comp(const string &s0, const string &s1)
 {
@@ -185,10 +459,24 @@ void packSubRecurse ()
 				fclose (f);
 				ftmp.Name = CFile::getFilename(pathContent[i]);
 				ftmp.Size = CFile::getFileSize(pathContent[i]);
-				ftmp.Pos = gBNPHeader.OffsetFromBeginning;
-				gBNPHeader.Files.push_back(ftmp);
-				gBNPHeader.OffsetFromBeginning += ftmp.Size;
-				append(gDestBNPFile, pathContent[i].c_str(), ftmp.Size);
+				if (WriteV1)
+				{
+					ftmp.Pos = gBNPHeader.OffsetFromBeginning;
+					ftmp.StoredSize = ftmp.Size;
+					ftmp.Compression = CBigFile::Stored;
+					gBNPHeader.Files.push_back(ftmp);
+					gBNPHeader.OffsetFromBeginning += ftmp.Size;
+					append(gDestBNPFile, pathContent[i].c_str(), ftmp.Size);
+				}
+				else
+				{
+					if (!addFile2(pathContent[i], ftmp))
+					{
+						printf("error cannot add %s\n", pathContent[i].c_str());
+						continue;
+					}
+					gBNPHeader.Files.push_back(ftmp);
+				}
 				printf("adding %s\n", pathContent[i].c_str());
 			}
 			else
@@ -212,7 +500,31 @@ void unpack (const string &dirName)
 		BNPFile &rBNPFile = gBNPHeader.Files[i];
 		string filename = dirName + "/" + rBNPFile.Name;
 		out = fopen (filename.c_str(), "wb");
-		if (out != NULL)
+		if (out != NULL && rBNPFile.Compression != CBigFile::Stored)
+		{
+			// Decompress the blocks
+			vector<uint64> positions (rBNPFile.BlockSizes.size());
+			uint64 pos = rBNPFile.Pos;
+			for (uint32 b = 0; b < positions.size(); ++b)
+			{
+				positions[b] = pos;
+				pos += rBNPFile.BlockSizes[b] & ~CBigFile::RawBlockFlag;
+			}
+			CBigFileBlocks blocks;
+			blocks.BlockSize = gBNPHeader.ReadBlockSize;
+			blocks.NumBlocks = positions.size();
+			blocks.Sizes = &rBNPFile.BlockSizes[0];
+			blocks.Positions = &positions[0];
+
+			vector<uint8> content (rBNPFile.Size), block;
+			uint32 blockIndex = CBigFile::NoBlock;
+			if (CBigFile::readBlocks (bnp, blocks, rBNPFile.Size, 0, &content[0], rBNPFile.Size, block, blockIndex))
+				fwrite (&content[0], rBNPFile.Size, 1, out);
+			else
+				printf ("error cannot decompress %s\n", rBNPFile.Name.c_str());
+			fclose (out);
+		}
+		else if (out != NULL)
 		{
 			nlfseek64 (bnp, rBNPFile.Pos, SEEK_SET);
 			uint8 *ptr = new uint8[rBNPFile.Size];
@@ -233,6 +545,9 @@ void usage()
 	printf ("   option : \n");
 	printf ("      -if wildcard : add the file if it matches the wilcard (at least one 'if' conditions must be met for a file to be adding)\n");
 	printf ("      -ifnot wildcard : add the file if it doesn't match the wilcard (all the 'ifnot' conditions must be met for a file to be adding)\n");
+	printf ("      -z : compress the files by blocks\n");
+	printf ("      -store wildcard : don't compress the files matching the wildcard (ie. streamed sounds)\n");
+	printf ("      -v1 : write the old format, limited to 4 GB and without compression\n");
 	printf (" Pack the directory to a bnp file\n");
 	printf ("   bnp_make /u <bnp_file>\n");
 	printf (" Unpack the bnp file to a directory\n");
@@ -266,6 +581,24 @@ uint readOptions (int nNbArg, char **ppArgs)
 			WildCards.push_back (card);
 			optionCount += 2;
 		}
+		// Compress ?
+		if (strcmp (ppArgs[i], "-z") == 0)
+		{
+			Compress = true;
+			optionCount++;
+		}
+		// Don't compress ?
+		if ((strcmp (ppArgs[i], "-store") == 0) && ((i+1)<(uint)nNbArg))
+		{
+			StoreWildCards.push_back (strlwr(string(ppArgs[i+1])));
+			optionCount += 2;
+		}
+		// Old format ?
+		if (strcmp (ppArgs[i], "-v1") == 0)
+		{
+			WriteV1 = true;
+			optionCount++;
+		}
 	}
 	return optionCount;
 }
@@ -358,7 +691,10 @@ int main (int nNbArg, char **ppArgs)
 		remove (gDestBNPFile.c_str());
 		gBNPHeader.OffsetFromBeginning = 0;	
 		packSubRecurse();
-		gBNPHeader.append (gDestBNPFile);
+		if (WriteV1)
+			gBNPHeader.append (gDestBNPFile);
+		else
+			gBNPHeader.append2 (gDestBNPFile);
 		return 1;
 	}
 
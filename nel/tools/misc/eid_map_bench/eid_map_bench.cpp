@@ -0,0 +1,172 @@
+/** \file eid_map_bench.cpp
+ * eid_map_bench.cpp : Compare CEntityIdMap with CHashMap and std::map keyed by CEntityId
+ *
+ * $Id$
+ */
+
+/* Copyright, 2001 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/app_context.h"
+#include "nel/misc/entity_id.h"
+#include "nel/misc/entity_id_map.h"
+#include "nel/misc/random.h"
+#include "nel/misc/time_nl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+
+using namespace std;
+using namespace NLMISC;
+
+
+// The value of a bench entity, the size of a small service record
+struct CBenchEntity
+{
+	uint32	Data[8];
+};
+
+typedef CHashMap<CEntityId, CBenchEntity, CEntityIdHashMapTraits>	THashMap;
+typedef std::map<CEntityId, CBenchEntity>							TStdMap;
+typedef CEntityIdMap<CBenchEntity>									TEntityIdMap;
+
+
+// ***************************************************************************
+static double	getMilliSeconds(TTicks start)
+{
+	return CTime::ticksToSecond(CTime::getPerformanceTime() - start) * 1000.0;
+}
+
+// ***************************************************************************
+// Ids like the ones of a shard: a few types and creators, increasing short ids with holes
+static void	makeIds(uint count, vector<CEntityId> &ids)
+{
+	CRandom rnd;
+	rnd.srand(1234);
+	ids.resize(count);
+	uint64 shortId = 0;
+	for (uint i=0; i<count; ++i)
+	{
+		shortId += 1 + (rnd.rand() & 3);
+		ids[i] = CEntityId((uint8)(rnd.rand() & 7), shortId, (uint8)(rnd.rand() & 3), (uint8)(rnd.rand() & 15));
+	}
+}
+
+// ***************************************************************************
+// Lookups in a random order, to miss the cache like the per tick updates
+static void	makeLookups(const vector<CEntityId> &ids, uint count, vector<CEntityId> &lookups)
+{
+	CRandom rnd;
+	rnd.srand(5678);
+	lookups.resize(count);
+	for (uint i=0; i<count; ++i)
+	{
+		uint index = ((uint)rnd.rand() << 15 | (uint)rnd.rand()) % ids.size();
+		lookups[i] = ids[index];
+	}
+}
+
+// ***************************************************************************
+template <class TMap>
+static void	bench(const char *name, const vector<CEntityId> &ids, const vector<CEntityId> &lookups, uint ticks)
+{
+	TMap container;
+	CBenchEntity entity;
+	memset(&entity, 0, sizeof(entity));
+
+	TTicks start = CTime::getPerformanceTime();
+	for (uint i=0; i<ids.size(); ++i)
+	{
+		entity.Data[0] = i;
+		container.insert(make_pair(ids[i], entity));
+	}
+	double insertTime = getMilliSeconds(start);
+
+	uint32 sum = 0;
+	start = CTime::getPerformanceTime();
+	for (uint tick=0; tick<ticks; ++tick)
+	{
+		for (uint i=0; i<lookups.size(); ++i)
+		{
+			typename TMap::iterator it = container.find(lookups[i]);
+			if (it != container.end())
+				sum += it->second.Data[0]++;
+		}
+	}
+	double findTime = getMilliSeconds(start);
+
+	start = CTime::getPerformanceTime();
+	for (uint tick=0; tick<ticks; ++tick)
+	{
+		typename TMap::iterator it(container.begin()), last(container.end());
+		for (; it != last; ++it)
+			sum += it->second.Data[1]++;
+	}
+	double iterateTime = getMilliSeconds(start);
+
+	// Remove and insert again half of the entities, like the disconnections and connections
+	start = CTime::getPerformanceTime();
+	for (uint i=0; i<ids.size(); i+=2)
+		container.erase(ids[i]);
+	for (uint i=0; i<ids.size(); i+=2)
+		container.insert(make_pair(ids[i], entity));
+	double churnTime = getMilliSeconds(start);
+
+	uint numLookups = (uint)lookups.size() * ticks;
+	printf("%-14s insert %8.2f ms   find %8.2f ms (%6.1f ns/find)   iterate %8.2f ms   churn %8.2f ms   (%u)\n",
+		name, insertTime, findTime, findTime * 1000000.0 / numLookups, iterateTime, churnTime, sum);
+}
+
+
+// ***************************************************************************
+int main(int argc, char **argv)
+{
+	CApplicationContext applicationContext;
+
+	uint numEntities = 100000;
+	uint numLookups = 100000;
+	uint ticks = 20;
+	if (argc > 1)
+		numEntities = atoi(argv[1]);
+	if (argc > 2)
+		numLookups = atoi(argv[2]);
+	if (argc > 3)
+		ticks = atoi(argv[3]);
+	if (argc > 4 || numEntities == 0)
+	{
+		printf("usage: eid_map_bench [<entities> [<lookups per tick> [<ticks>]]]\n");
+		return 1;
+	}
+
+	printf("%u entities, %u lookups per tick, %u ticks\n", numEntities, numLookups, ticks);
+
+	vector<CEntityId> ids;
+	vector<CEntityId> lookups;
+	makeIds(numEntities, ids);
+	makeLookups(ids, numLookups, lookups);
+
+	bench<TStdMap>("std::map", ids, lookups, ticks);
+	bench<THashMap>("CHashMap", ids, lookups, ticks);
+	bench<TEntityIdMap>("CEntityIdMap", ids, lookups, ticks);
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+/** \file file_load_bench.cpp
+ * file_load_bench.cpp : Compare the loading of a batch of files with CIFile, pread() and io_uring
+ *
+ * $Id$
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/app_context.h"
+#include "nel/misc/batch_file_reader.h"
+#include "nel/misc/big_file.h"
+#include "nel/misc/common.h"
+#include "nel/misc/file.h"
+#include "nel/misc/path.h"
+#include "nel/misc/thread.h"
+#include "nel/misc/time_nl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(NL_OS_UNIX) && defined(__linux__)
+#	define FILE_LOAD_BENCH_DROP_CACHE
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+using namespace std;
+using namespace NLMISC;
+
+
+// The files to load, the loading thread sets the pointers
+static vector<string>	FileNames;
+static vector<uint8*>	Ptrs;
+// The files on the disk, the bnps included
+static vector<string>	DiskFiles;
+
+// ***************************************************************************
+// The loading before CBatchFileReader: each file read with a CIFile, one after another
+class CIFileLoad : public IRunnable
+{
+public:
+	void run ()
+	{
+		for (uint i=0; i<FileNames.size (); i++)
+		{
+			CIFile f;
+			if (f.open (FileNames[i]))
+			{
+				uint8 *ptr = new uint8[f.getFileSize ()];
+				f.serialBuffer (ptr, f.getFileSize ());
+				Ptrs[i] = ptr;
+			}
+			else
+			{
+				Ptrs[i] = (uint8*)-1;
+			}
+		}
+	}
+};
+
+// ***************************************************************************
+class CBatchLoad : public IRunnable
+{
+public:
+	CBatchLoad (bool useIOUring) : UseIOUring (useIOUring) { }
+
+	void run ()
+	{
+		CBatchFileReader reader (UseIOUring);
+		for (uint i=0; i<FileNames.size (); i++)
+			reader.addFile (FileNames[i], &Ptrs[i]);
+		reader.read ();
+	}
+
+	bool	UseIOUring;
+};
+
+// ***************************************************************************
+// Remove the files from the page cache, to measure the reads from the disk
+static void	dropCache ()
+{
+#ifdef FILE_LOAD_BENCH_DROP_CACHE
+	for (uint i=0; i<DiskFiles.size (); i++)
+	{
+		int fd = open (DiskFiles[i].c_str (), O_RDONLY);
+		if (fd >= 0)
+		{
+			posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+			close (fd);
+		}
+	}
+#endif
+}
+
+// ***************************************************************************
+// Run a loading in a thread, and poll the pointers like the streaming of the client
+static void	bench (const char *name, IRunnable *loading, bool cold)
+{
+	if (cold)
+		dropCache ();
+
+	Ptrs.assign (FileNames.size (), (uint8*)NULL);
+	vector<double> loadTimes (FileNames.size (), 0);
+	vector<bool> loaded (FileNames.size (), false);
+	uint numLoaded = 0;
+	uint numErrors = 0;
+	uint64 size = 0;
+
+	TTime start = CTime::getLocalTime ();
+	IThread *thread = IThread::create (loading);
+	thread->start ();
+	while (numLoaded < FileNames.size ())
+	{
+		for (uint i=0; i<FileNames.size (); i++)
+		{
+			if (!loaded[i] && Ptrs[i] != NULL)
+			{
+				loadTimes[i] = (double)(CTime::getLocalTime () - start);
+				loaded[i] = true;
+				numLoaded++;
+			}
+		}
+		nlSleep (0);
+	}
+	double totalTime = (double)(CTime::getLocalTime () - start);
+	thread->wait ();
+	delete thread;
+
+	for (uint i=0; i<FileNames.size (); i++)
+	{
+		if (Ptrs[i] == (uint8*)-1)
+		{
+			numErrors++;
+			continue;
+		}
+		size += CFile::getFileSize (FileNames[i]);
+		delete [] Ptrs[i];
+	}
+
+	sort (loadTimes.begin (), loadTimes.end ());
+	printf ("%-6s %8.1f ms  %8.1f MB/s   first %7.1f ms   median %7.1f ms   p99 %7.1f ms   (%u errors)\n",
+		name, totalTime, size / (1024.0 * 1024.0) / (totalTime / 1000.0), loadTimes.front (),
+		loadTimes[loadTimes.size () / 2], loadTimes[loadTimes.size () * 99 / 100], numErrors);
+}
+
+// ***************************************************************************
+int main (int argc, char **argv)
+{
+	CApplicationContext applicationContext;
+
+	bool cold = false;
+	uint32 bandwidth = 0;
+	vector<string> sources;
+	for (int i=1; i<argc; i++)
+	{
+		if (strcmp (argv[i], "-cold") == 0)
+			cold = true;
+		else if (strcmp (argv[i], "-bandwidth") == 0 && i+1 < argc)
+			bandwidth = atoi (argv[++i]) * 1024 * 1024;
+		else
+			sources.push_back (argv[i]);
+	}
+	if (sources.empty ())
+	{
+		printf ("usage: file_load_bench [-cold] [-bandwidth <MB/s>] <directory or bnp> ...\n");
+		printf ("  Load all the files of the directories (ie. the shapes and the textures) and of the bnps\n");
+		printf ("  -cold: remove the files from the page cache before each loading (Linux only)\n");
+		return 1;
+	}
+
+	// The files, in a random order like the requests of the streaming
+	for (uint i=0; i<sources.size (); i++)
+	{
+		if (toLower (CFile::getExtension (sources[i])) == "bnp")
+		{
+			CBigFile::getInstance ().add (sources[i], BF_ALWAYS_OPENED);
+			string bnpName = CFile::getFilename (sources[i]);
+			vector<string> files;
+			CBigFile::getInstance ().list (bnpName, files);
+			for (uint j=0; j<files.size (); j++)
+				FileNames.push_back (bnpName + "@" + files[j]);
+			DiskFiles.push_back (sources[i]);
+		}
+		else
+		{
+			vector<string> files;
+			CPath::getPathContent (sources[i], true, false, true, files);
+			FileNames.insert (FileNames.end (), files.begin (), files.end ());
+			DiskFiles.insert (DiskFiles.end (), files.begin (), files.end ());
+		}
+	}
+	if (FileNames.empty ())
+	{
+		printf ("no file to load\n");
+		return 1;
+	}
+	srand (1234);
+	random_shuffle (FileNames.begin (), FileNames.end ());
+
+	CBatchFileReader::setBandwidth (bandwidth);
+	printf ("%u files%s, bandwidth %s\n", (uint)FileNames.size (), cold ? ", cold" : "",
+		bandwidth ? toString ("%u MB/s", bandwidth / (1024*1024)).c_str () : "unlimited");
+
+	CIFileLoad cifileLoad;
+	CBatchLoad preadLoad (false);
+	CBatchLoad ringLoad (true);
+	bench ("cifile", &cifileLoad, cold);
+	bench ("pread", &preadLoad, cold);
+	if (CBatchFileReader (true).getBackend () == CBatchFileReader::IOUring)
+		bench ("uring", &ringLoad, cold);
+	else
+		printf ("io_uring is not available\n");
+
+	return 0;
+}
@@ -15,6 +15,7 @@ using namespace std;
 #include "ut_misc.h"
 #include "ut_net.h"
 #include "ut_ligo.h"
+#include "ut_3d.h"
 // Add a line here when adding a new test MODULE
 
 #ifdef _MSC_VER
@@ -106,6 +107,7 @@ int main(int argc, char *argv[])
 		ts.add(auto_ptr<Test::Suite>(new CUTMisc));
 		ts.add(auto_ptr<Test::Suite>(new CUTNet));
 		ts.add(auto_ptr<Test::Suite>(new CUTLigo));
+		ts.add(auto_ptr<Test::Suite>(new CUT3D));
 		// Add a line here when adding a new test MODULE
 
 		auto_ptr<Test::Output> output(cmdline(argc, argv));
@@ -0,0 +1,22 @@
+#ifndef UT_3D
+#define UT_3D
+
+#include <nel/3d/landscape.h>
+#include <nel/3d/zone.h>
+#include <nel/3d/tessellation.h>
+
+using namespace NL3D;
+
+#include "ut_3d_landscape.h"
+// Add a line here when adding a new test CLASS
+
+struct CUT3D : public Test::Suite
+{
+	CUT3D()
+	{
+		add(auto_ptr<Test::Suite>(new CUT3DLandscape));
+		// Add a line here when adding a new test CLASS
+	}
+};
+
+#endif
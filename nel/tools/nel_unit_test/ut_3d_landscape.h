@@ -0,0 +1,174 @@
+#ifndef UT_3D_LANDSCAPE
+#define UT_3D_LANDSCAPE
+
+// Test suite for the landscape refine, without driver
+class CUT3DLandscape : public Test::Suite
+{
+public:
+	CUT3DLandscape ()
+	{
+		TEST_ADD(CUT3DLandscape::asyncRefineSameAsSync);
+		TEST_ADD(CUT3DLandscape::asyncRefineSingleLandscape);
+		TEST_ADD(CUT3DLandscape::asyncRefineWaitedByReads);
+	}
+
+	// A zone of patchCount*patchCount bumpy patchs of 16m, not binded
+	static void buildZone(CZone &zone, uint16 zoneId, uint patchCount)
+	{
+		CZoneInfo	zoneInfo;
+		zoneInfo.ZoneId= zoneId;
+		for(uint y=0;y<patchCount;y++)
+		{
+			for(uint x=0;x<patchCount;x++)
+			{
+				CPatchInfo	pi;
+				CVector		o((float)x*16, (float)y*16, 0);
+				CBezierPatch	&p= pi.Patch;
+				p.Vertices[0]= o + CVector(0, 0, 0);
+				p.Vertices[1]= o + CVector(0, 16, 0);
+				p.Vertices[2]= o + CVector(16, 16, 0);
+				p.Vertices[3]= o + CVector(16, 0, 0);
+				for(uint i=0;i<4;i++)
+				{
+					const CVector	&a= p.Vertices[i];
+					const CVector	&b= p.Vertices[(i+1)%4];
+					p.Tangents[i*2]= a + (b-a)/3 + CVector(0, 0, 4.f*((x+y+i)%3));
+					p.Tangents[i*2+1]= b + (a-b)/3 - CVector(0, 0, 3.f*((x*y+i)%2));
+				}
+				p.makeInteriors();
+				pi.OrderS= 4;
+				pi.OrderT= 4;
+				pi.Flags= 0;
+				for(uint i=0;i<4;i++)
+					pi.BaseVertices[i]= (uint16)((y*patchCount+x)*4+i);
+				pi.Tiles.resize(pi.OrderS*pi.OrderT);
+				for(uint i=0;i<pi.Tiles.size();i++)
+				{
+					pi.Tiles[i].setTileOrient(0, 0);
+					pi.Tiles[i].setTile256Info(false);
+					pi.Tiles[i].setTileSubNoise(0);
+					pi.Tiles[i].Tile[0]= NL_TILE_ELM_LAYER_EMPTY;
+					pi.Tiles[i].Tile[1]= NL_TILE_ELM_LAYER_EMPTY;
+					pi.Tiles[i].Tile[2]= NL_TILE_ELM_LAYER_EMPTY;
+				}
+				pi.TileColors.resize((pi.OrderS+1)*(pi.OrderT+1));
+				zoneInfo.Patchs.push_back(pi);
+			}
+		}
+		zone.build(zoneInfo);
+	}
+
+	static void initLandscape(CLandscape &landscape)
+	{
+		CZone	zone;
+		buildZone(zone, 0, 4);
+		landscape.init();
+		landscape.setThreshold(0.005f);
+		landscape.addZone(zone);
+	}
+
+	// The refine centers of a frame, crossing the zone
+	static CVector getRefineCenter(uint frame)
+	{
+		return CVector(frame*1.3f, frame*0.7f, 2.f + (frame%5));
+	}
+
+	// The positions of the leaves of the tesselation, in the order of the patchs
+	static void getLeaves(const CLandscape &landscape, std::vector<CVector> &positions)
+	{
+		std::vector<const CTessFace*>	leaves;
+		landscape.getTessellationLeaves(leaves);
+		positions.clear();
+		for(uint i=0;i<leaves.size();i++)
+		{
+			positions.push_back(leaves[i]->VBase->EndPos);
+			positions.push_back(leaves[i]->VLeft->EndPos);
+			positions.push_back(leaves[i]->VRight->EndPos);
+		}
+	}
+
+	void asyncRefineSameAsSync()
+	{
+		CLandscape	syncLandscape;
+		CLandscape	asyncLandscape;
+		initLandscape(syncLandscape);
+		initLandscape(asyncLandscape);
+		asyncLandscape.enableAsyncRefine(true);
+		TEST_ASSERT(asyncLandscape.isAsyncRefineEnabled());
+
+		// The refine computed by the pool between startAsyncRefine() and refine() must give the same tesselation
+		std::vector<CVector>	syncLeaves, asyncLeaves;
+		for(uint frame=0;frame<50;frame++)
+		{
+			CVector	center= getRefineCenter(frame);
+			syncLandscape.refine(center);
+			asyncLandscape.startAsyncRefine(center);
+			asyncLandscape.refine(center);
+
+			getLeaves(syncLandscape, syncLeaves);
+			getLeaves(asyncLandscape, asyncLeaves);
+			TEST_ASSERT(syncLeaves.size() > 32*3);
+			TEST_ASSERT(syncLeaves == asyncLeaves);
+		}
+
+		asyncLandscape.enableAsyncRefine(false);
+	}
+
+	void asyncRefineSingleLandscape()
+	{
+		CLandscape	landscape0;
+		CLandscape	landscape1;
+		initLandscape(landscape0);
+		initLandscape(landscape1);
+
+		// Only one landscape can use the globals in the pool
+		landscape0.enableAsyncRefine(true);
+		landscape1.enableAsyncRefine(true);
+		TEST_ASSERT(landscape0.isAsyncRefineEnabled());
+		TEST_ASSERT(!landscape1.isAsyncRefineEnabled());
+
+		// Until it leaves the async mode
+		landscape0.enableAsyncRefine(false);
+		landscape1.enableAsyncRefine(true);
+		TEST_ASSERT(landscape1.isAsyncRefineEnabled());
+
+		// And a landscape deleted in async mode leaves it
+		{
+			CLandscape	landscape2;
+			initLandscape(landscape2);
+			landscape1.enableAsyncRefine(false);
+			landscape2.enableAsyncRefine(true);
+			TEST_ASSERT(landscape2.isAsyncRefineEnabled());
+			landscape2.startAsyncRefine(getRefineCenter(0));
+		}
+		landscape0.enableAsyncRefine(true);
+		TEST_ASSERT(landscape0.isAsyncRefineEnabled());
+		landscape0.enableAsyncRefine(false);
+	}
+
+	void asyncRefineWaitedByReads()
+	{
+		CLandscape	syncLandscape;
+		CLandscape	asyncLandscape;
+		initLandscape(syncLandscape);
+		initLandscape(asyncLandscape);
+		asyncLandscape.enableAsyncRefine(true);
+
+		// A refine of another landscape and the reads of the tesselation wait for the pending refine
+		std::vector<CVector>	syncLeaves, asyncLeaves;
+		for(uint frame=0;frame<20;frame++)
+		{
+			CVector	center= getRefineCenter(frame);
+			asyncLandscape.startAsyncRefine(center);
+			syncLandscape.refine(center);
+			getLeaves(asyncLandscape, asyncLeaves);
+			getLeaves(syncLandscape, syncLeaves);
+			TEST_ASSERT(syncLeaves == asyncLeaves);
+			asyncLandscape.refine(center);
+		}
+
+		asyncLandscape.enableAsyncRefine(false);
+	}
+};
+
+#endif
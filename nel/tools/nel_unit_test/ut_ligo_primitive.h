@@ -3,6 +3,7 @@
 
 #include <nel/ligo/ligo_config.h>
 #include <nel/ligo/primitive_utils.h>
+#include <nel/ligo/primitive_index.h>
 
 class CUTLigoPrimitive : public Test::Suite
 {
@@ -10,6 +11,8 @@ public:
 	CUTLigoPrimitive()
 	{
 		TEST_ADD(CUTLigoPrimitive::testAliasGenerator)
+		TEST_ADD(CUTLigoPrimitive::testBinaryPrimitive)
+		TEST_ADD(CUTLigoPrimitive::testPrimitiveIndex)
 	}
 
 private:
@@ -149,6 +152,118 @@ private:
 		}
 	}
 
+	void testBinaryPrimitive()
+	{
+		const char	*BINARY_FILE_NAME = "__test_prim.binprim";
+
+		// load the xml file and save it in binary
+		uint32 lastGeneratedAlias;
+		uint32 alias;
+		{
+			CPrimitives primDoc;
+
+			CPrimitiveContext::instance().CurrentPrimitive = &primDoc;
+			TEST_ASSERT(loadXmlPrimitiveFile(primDoc, _RefPrimFileName, _LigoConfig));
+			CPrimitiveContext::instance().CurrentPrimitive = NULL;
+
+			lastGeneratedAlias = primDoc.getLastGeneratedAlias();
+
+			IPrimitive *prim = NULL;
+			IPrimitive *child = NULL;
+			TEST_ASSERT(primDoc.RootNode->getChild(prim, 0));
+			TEST_ASSERT(prim != NULL && prim->getChild(child, 0));
+			CPrimAlias *pa = dynamic_cast<CPrimAlias*>(child);
+			TEST_ASSERT(pa != NULL);
+			alias = pa ? pa->getAlias() : 0;
+
+			TEST_ASSERT(saveBinaryPrimitiveFile(primDoc, BINARY_FILE_NAME));
+		}
+
+		// reload the binary file and check the primitive tree
+		{
+			CPrimitives primDoc;
+
+			CPrimitiveContext::instance().CurrentPrimitive = &primDoc;
+			TEST_ASSERT(loadBinaryPrimitiveFile(primDoc, BINARY_FILE_NAME));
+			CPrimitiveContext::instance().CurrentPrimitive = NULL;
+
+			TEST_ASSERT(lastGeneratedAlias == primDoc.getLastGeneratedAlias());
+			TEST_ASSERT(primDoc.RootNode->getNumChildren() == 1);
+
+			IPrimitive *prim = NULL;
+			IPrimitive *child = NULL;
+			TEST_ASSERT(primDoc.RootNode->getChild(prim, 0));
+			TEST_ASSERT(prim != NULL && prim->getName() == "test_root");
+			TEST_ASSERT(prim != NULL && prim->getChild(child, 0));
+			TEST_ASSERT(child != NULL && child->getParent() == prim);
+			CPrimAlias *pa = dynamic_cast<CPrimAlias*>(child);
+			TEST_ASSERT(pa != NULL && pa->getAlias() == alias);
+			TEST_ASSERT(primDoc.getPrimitiveByAlias(primDoc.buildFullAlias(alias)) == prim);
+		}
+
+		// a xml file is not a binary primitive
+		{
+			CPrimitives primDoc;
+			TEST_ASSERT(!loadBinaryPrimitiveFile(primDoc, _RefPrimFileName));
+		}
+
+		CFile::deleteFile(BINARY_FILE_NAME);
+	}
+
+	void testPrimitiveIndex()
+	{
+		CPrimitives primDoc;
+		CPrimitiveContext::instance().CurrentPrimitive = &primDoc;
+		TEST_ASSERT(loadXmlPrimitiveFile(primDoc, _RefPrimFileName, _LigoConfig));
+
+		CPrimitiveIndex *index = primDoc.buildIndex(10.f, 16);
+		TEST_ASSERT(index != NULL);
+
+		vector<IPrimitive*> result;
+		index->selectByName("test_root", result);
+		TEST_ASSERT(result.size() == 1);
+		IPrimitive *root = result.empty() ? primDoc.RootNode : result[0];
+
+		// add a zone, far from the origin to check the grid wrapping
+		CPrimZone *zone = dynamic_cast<CPrimZone *> (CClassRegistry::create ("CPrimZone"));
+		zone->addPropertyByName("class", new CPropertyString("spawn"));
+		zone->addPropertyByName("name", new CPropertyString("zone"));
+		zone->VPoints.push_back(CVector(1000.f, 1000.f, 0.f));
+		zone->VPoints.push_back(CVector(1030.f, 1000.f, 0.f));
+		zone->VPoints.push_back(CVector(1030.f, 1030.f, 0.f));
+		zone->VPoints.push_back(CVector(1000.f, 1030.f, 0.f));
+		root->insertChild(zone);
+
+		result.clear();
+		index->selectByClassAndName("spawn", "zone", result);
+		TEST_ASSERT(result.size() == 1);
+
+		vector<CPrimZone*> zones;
+		index->selectZonesContaining(CVector(1015.f, 1015.f, 0.f), zones);
+		TEST_ASSERT(zones.size() == 1 && zones[0] == zone);
+		zones.clear();
+		string otherClass = "other";
+		index->selectZonesContaining(CVector(1015.f, 1015.f, 0.f), zones, &otherClass);
+		TEST_ASSERT(zones.empty());
+		index->selectZonesContaining(CVector(1015.f - 160.f, 1015.f, 0.f), zones);
+		TEST_ASSERT(zones.empty());
+
+		result.clear();
+		index->selectInBox(CVector(1020.f, 1020.f, 0.f), CVector(2000.f, 2000.f, 0.f), result);
+		TEST_ASSERT(result.size() == 1);
+
+		// remove it
+		root->removeChild(zone);
+		result.clear();
+		index->selectByClass("spawn", result);
+		TEST_ASSERT(result.empty());
+		zones.clear();
+		index->selectZonesContaining(CVector(1015.f, 1015.f, 0.f), zones);
+		TEST_ASSERT(zones.empty());
+
+		CPrimitiveContext::instance().CurrentPrimitive = NULL;
+	}
+
 	CLigoConfig		_LigoConfig;
 };
 
@@ -0,0 +1,199 @@
+#ifndef UT_MISC_BATCH_FILE_READER
+#define UT_MISC_BATCH_FILE_READER
+
+#include <nel/misc/batch_file_reader.h>
+#include <nel/misc/big_file.h>
+#include <nel/misc/file.h>
+
+#ifndef NEL_UNIT_BASE
+#define NEL_UNIT_BASE ""
+#endif // NEL_UNIT_BASE
+
+// Test suite for CBatchFileReader, with the io_uring and the pread() backends
+class CUTMiscBatchFileReader : public Test::Suite
+{
+	string		_WorkingPath;
+	string		_OldPath;
+public:
+	CUTMiscBatchFileReader ()
+	{
+		TEST_ADD(CUTMiscBatchFileReader::readDiskFilesIOUring);
+		TEST_ADD(CUTMiscBatchFileReader::readDiskFilesPRead);
+		TEST_ADD(CUTMiscBatchFileReader::readBnpFilesIOUring);
+		TEST_ADD(CUTMiscBatchFileReader::readBnpFilesPRead);
+		TEST_ADD(CUTMiscBatchFileReader::reuseReader);
+	}
+
+	void setup()
+	{
+		_OldPath = CPath::getCurrentPath();
+		CPath::setCurrentPath(_WorkingPath.c_str());
+	}
+
+	void tear_down()
+	{
+		CPath::setCurrentPath(_OldPath.c_str());
+	}
+
+	static void writeFile(const string &fileName, const string &content)
+	{
+		FILE *fp = fopen(fileName.c_str(), "wb");
+		nlverify(fp != NULL);
+		if (!content.empty())
+			nlverify(fwrite(content.data(), 1, content.size(), fp) == content.size());
+		fclose(fp);
+	}
+
+	// Some content of size bytes, different for each seed
+	static string fileContent(uint size, uint32 seed)
+	{
+		string content(size, ' ');
+		for (uint i=0; i<size; i++)
+		{
+			seed = seed*1103515245 + 12345;
+			content[i] = (char)((seed>>16) & 0xff);
+		}
+		return content;
+	}
+
+	// Read a whole file with a CIFile, the reference
+	static string readWithCIFile(const string &fileName)
+	{
+		CIFile file;
+		if (!file.open(fileName))
+			return "<not found>";
+		string content(file.getFileSize(), ' ');
+		if (!content.empty())
+			file.serialBuffer((uint8*)&content[0], (uint)content.size());
+		return content;
+	}
+
+	// The content loaded by the reader, "<failed>" if the pointer is set to -1. Delete the buffer.
+	static string takeContent(uint8 *&ptr, uint size)
+	{
+		if (ptr == NULL)
+			return "<not loaded>";
+		if (ptr == (uint8*)-1)
+			return "<failed>";
+		string content((const char*)ptr, size);
+		delete [] ptr;
+		ptr = NULL;
+		return content;
+	}
+
+	void readDiskFiles(bool useIOUring)
+	{
+		// an empty file, a small one, and some files of several reads in flight together
+		vector<string> names;
+		vector<string> contents;
+		contents.push_back("");
+		contents.push_back("small");
+		contents.push_back(fileContent(CBatchFileReader::ReadSize, 1));
+		contents.push_back(fileContent(CBatchFileReader::ReadSize*3 + 17, 2));
+		for (uint i=0; i<40; i++)
+			contents.push_back(fileContent(1000 + i*5000, i+3));
+		for (uint i=0; i<contents.size(); i++)
+		{
+			names.push_back(toString("ut_misc_batch_file_%u.bin", i));
+			writeFile(names[i], contents[i]);
+		}
+
+		CBatchFileReader reader(useIOUring);
+		if (!useIOUring)
+			TEST_ASSERT(reader.getBackend() == CBatchFileReader::PRead);
+
+		vector<uint8*> ptrs(contents.size() + 1, (uint8*)NULL);
+		for (uint i=0; i<contents.size(); i++)
+			reader.addFile(names[i], &ptrs[i]);
+		reader.addFile("ut_misc_batch_file_missing.bin", &ptrs.back());
+		TEST_ASSERT(reader.read() == contents.size());
+
+		bool same = true;
+		for (uint i=0; i<contents.size(); i++)
+			same = same && takeContent(ptrs[i], (uint)contents[i].size()) == contents[i];
+		TEST_ASSERT(same);
+		TEST_ASSERT(ptrs.back() == (uint8*)-1);
+
+		for (uint i=0; i<names.size(); i++)
+			CFile::deleteFile(names[i]);
+	}
+
+	void readDiskFilesIOUring()
+	{
+		// read with pread() if io_uring is not available
+		readDiskFiles(true);
+	}
+
+	void readDiskFilesPRead()
+	{
+		readDiskFiles(false);
+	}
+
+	void readBnpFiles(bool useIOUring)
+	{
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2.bnp", BF_ALWAYS_OPENED));
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2_z.bnp", BF_ALWAYS_OPENED));
+
+		// a file compressed by blocks, stored files in two bnps, a missing file, and a disk file between them
+		vector<string> names;
+		names.push_back("files_v2_z.bnp@big_in_bnp.txt");
+		names.push_back("files_v2_z.bnp@random_in_bnp.bin");
+		names.push_back("files_v2.bnp@file1_in_bnp.txt");
+		names.push_back(NEL_UNIT_BASE "ut_misc_files/file1_in_bnp.txt");
+		names.push_back("files_v2_z.bnp@file1_in_bnp.txt");
+		names.push_back("files_v2.bnp@file2_in_bnp.txt");
+		vector<string> contents;
+		for (uint i=0; i<names.size(); i++)
+			contents.push_back(readWithCIFile(names[i]));
+		TEST_ASSERT(contents[0].size() > 2*64*1024);
+		TEST_ASSERT(contents[2] == "The content of the first file");
+
+		CBatchFileReader reader(useIOUring);
+		vector<uint8*> ptrs(names.size() + 2, (uint8*)NULL);
+		for (uint i=0; i<names.size(); i++)
+			reader.addFile(names[i], &ptrs[i]);
+		reader.addFile("files_v2_z.bnp@missing_in_bnp.txt", &ptrs[names.size()]);
+		reader.addFile("missing.bnp@file1_in_bnp.txt", &ptrs[names.size()+1]);
+		TEST_ASSERT(reader.read() == names.size());
+
+		for (uint i=0; i<names.size(); i++)
+			TEST_ASSERT(takeContent(ptrs[i], (uint)contents[i].size()) == contents[i]);
+		TEST_ASSERT(ptrs[names.size()] == (uint8*)-1);
+		TEST_ASSERT(ptrs[names.size()+1] == (uint8*)-1);
+
+		CBigFile::getInstance().remove("files_v2.bnp");
+		CBigFile::getInstance().remove("files_v2_z.bnp");
+	}
+
+	void readBnpFilesIOUring()
+	{
+		readBnpFiles(true);
+	}
+
+	void readBnpFilesPRead()
+	{
+		readBnpFiles(false);
+	}
+
+	void reuseReader()
+	{
+		// the reader is emptied by read(), it can read other batches
+		CBatchFileReader reader;
+		for (uint batch=0; batch<3; batch++)
+		{
+			const string name = toString("ut_misc_batch_reuse_%u.bin", batch);
+			const string content = fileContent(CBatchFileReader::ReadSize + batch*1000, batch);
+			writeFile(name, content);
+
+			uint8 *ptr = NULL;
+			reader.addFile(name, &ptr);
+			TEST_ASSERT(reader.read() == 1);
+			TEST_ASSERT(takeContent(ptr, (uint)content.size()) == content);
+			TEST_ASSERT(reader.read() == 0);
+
+			CFile::deleteFile(name);
+		}
+	}
+};
+
+#endif
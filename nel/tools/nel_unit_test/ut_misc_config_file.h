@@ -21,6 +21,10 @@ public:
 		TEST_ADD(CUTMiscConfigFile::configWithBadTest);
 		TEST_ADD(CUTMiscConfigFile::configIncludeAndOptional);
 		TEST_ADD(CUTMiscConfigFile::reportErrorInSubFiles);
+		TEST_ADD(CUTMiscConfigFile::reloadCallbacksOnlyChanged);
+		TEST_ADD(CUTMiscConfigFile::reloadKeepsReferences);
+		TEST_ADD(CUTMiscConfigFile::reloadAddAssign);
+		TEST_ADD(CUTMiscConfigFile::parseCache);
 	}
 
 	void setup()
@@ -159,6 +163,227 @@ public:
 		// the first error is in the subfile
 		TEST_ASSERT(warnings.Lines[0].find(string("CF: Parsing error in file ")+subfullName+" line 18") != string::npos);
 	}
+	// Write a config file in the working path, for the reload tests
+	static void writeConfigFile(const string &fileName, const string &content)
+	{
+		FILE *fp = fopen(fileName.c_str(), "wb");
+		nlverify(fp != NULL);
+		nlverify(fwrite(content.data(), 1, content.size(), fp) == content.size());
+		fclose(fp);
+	}
+
+	// The calls of the callbacks of the reload tests
+	static CConfigFile	*ReloadedFile;
+	static uint			NumACallbacks;
+	static uint			NumBCallbacks;
+	static uint			NumDCallbacks;
+	static uint			NumFileCallbacks;
+	static string		BSeenByA;
+
+	static void aCallback(CConfigFile::CVar &var)
+	{
+		NumACallbacks++;
+		BSeenByA = ReloadedFile->getVar("B").asString();
+	}
+
+	static void bCallback(CConfigFile::CVar &var)
+	{
+		NumBCallbacks++;
+	}
+
+	static void dCallback(CConfigFile::CVar &var)
+	{
+		NumDCallbacks++;
+	}
+
+	static void fileCallback()
+	{
+		NumFileCallbacks++;
+	}
+
+	void reloadCallbacksOnlyChanged()
+	{
+		const string fileName = "ut_misc_reload_callbacks.cfg";
+		writeConfigFile(fileName, "A = 1;\nB = \"one\";\nC = { 1, 2 };\n");
+
+		CConfigFile configFile;
+		TEST_THROWS_NOTHING(configFile.load(fileName));
+		ReloadedFile = &configFile;
+		NumACallbacks = NumBCallbacks = NumDCallbacks = NumFileCallbacks = 0;
+		configFile.setCallback("A", aCallback);
+		configFile.setCallback("B", bCallback);
+		// not in the file yet
+		configFile.setCallback("D", dCallback);
+		configFile.setCallback(fileCallback);
+
+		// only the callbacks of the variables whose value changed are called, once all the variables are updated
+		writeConfigFile(fileName, "A = 2;\nB = \"two\";\nC = { 1, 2 };\nD = 4;\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(NumACallbacks == 1);
+		TEST_ASSERT(NumBCallbacks == 1);
+		TEST_ASSERT(NumDCallbacks == 1);
+		TEST_ASSERT(NumFileCallbacks == 1);
+		TEST_ASSERT(BSeenByA == "two");
+		TEST_ASSERT(configFile.getVar("D").asInt() == 4);
+
+		writeConfigFile(fileName, "A = 2;\nB = \"three\";\nC = { 1, 2 };\nD = 4;\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(NumACallbacks == 1);
+		TEST_ASSERT(NumBCallbacks == 2);
+		TEST_ASSERT(NumDCallbacks == 1);
+		TEST_ASSERT(NumFileCallbacks == 2);
+
+		// the same values written differently
+		writeConfigFile(fileName, "// comment\nA = 1 + 1;\nB = \"three\";\nC = { 1, 2 };\nD = 4;\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(NumACallbacks == 1);
+		TEST_ASSERT(NumBCallbacks == 2);
+		TEST_ASSERT(NumDCallbacks == 1);
+		TEST_ASSERT(NumFileCallbacks == 3);
+
+		// the type is a part of the value
+		writeConfigFile(fileName, "A = 2.0;\nB = \"three\";\nC = { 1, 2 };\nD = 4;\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(NumACallbacks == 2);
+		TEST_ASSERT(configFile.getVar("A").asFloat() == 2.f);
+
+		ReloadedFile = NULL;
+		CFile::deleteFile(fileName);
+	}
+
+	void reloadKeepsReferences()
+	{
+		const string fileName = "ut_misc_reload_references.cfg";
+		writeConfigFile(fileName, "A = 1;\nB = { \"one\", \"two\" };\n");
+
+		CConfigFile configFile;
+		TEST_THROWS_NOTHING(configFile.load(fileName));
+		CConfigFile::CVar &a = configFile.getVar("A");
+		CConfigFile::CVar &b = configFile.getVar("B");
+
+		// the variables are updated in place, even when a lot of variables are added
+		string content = "A = 10;\nB = { \"three\" };\n";
+		for (uint i=0; i<200; i++)
+			content += toString("Added%u = %u;\n", i, i);
+		writeConfigFile(fileName, content);
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(&configFile.getVar("A") == &a);
+		TEST_ASSERT(&configFile.getVar("B") == &b);
+		TEST_ASSERT(a.asInt() == 10);
+		TEST_ASSERT(b.size() == 1 && b.asString(0) == "three");
+		TEST_ASSERT(configFile.getVar("Added199").asInt() == 199);
+
+		// a variable removed from the file keeps its last value
+		writeConfigFile(fileName, "B = { \"four\" };\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(&configFile.getVar("A") == &a);
+		TEST_ASSERT(a.asInt() == 10);
+		TEST_ASSERT(b.asString(0) == "four");
+		TEST_ASSERT(configFile.getVar("Added0").asInt() == 0);
+
+		CFile::deleteFile(fileName);
+	}
+
+	void reloadAddAssign()
+	{
+		const string fileName = "ut_misc_reload_add_assign.cfg";
+		writeConfigFile(fileName, "L = { 1 };\nL += { 2 };\nS = { \"a\" };\nS += { \"b\" };\n");
+
+		CConfigFile configFile;
+		TEST_THROWS_NOTHING(configFile.load(fileName));
+		TEST_ASSERT(configFile.getVar("L").size() == 2);
+
+		// each parse starts from the values of the files, += doesn't add to the values of the previous parse
+		writeConfigFile(fileName, "L = { 1 };\nL += { 2 };\nS = { \"a\" };\nS += { \"b\" };\n// modified\n");
+		TEST_THROWS_NOTHING(configFile.reparse());
+		CConfigFile::CVar &l = configFile.getVar("L");
+		TEST_ASSERT(l.size() == 2 && l.asInt(0) == 1 && l.asInt(1) == 2);
+		CConfigFile::CVar &s = configFile.getVar("S");
+		TEST_ASSERT(s.size() == 2 && s.asString(0) == "a" && s.asString(1) == "b");
+
+		// the same with a content from the parse cache
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(l.size() == 2);
+		TEST_ASSERT(s.size() == 2);
+
+		CFile::deleteFile(fileName);
+	}
+
+	// Return true if the debug lines tell that a file was taken from the parse cache
+	static bool fromParseCache(const CMyDisplayer &debug, const string &fileName)
+	{
+		string fullName = CPath::getFullPath(fileName, false);
+		for (uint i=0; i<debug.Lines.size(); i++)
+		{
+			if (debug.Lines[i].find(string("CF: '")+fullName+"' and its root config files are not modified since the last parse") != string::npos)
+				return true;
+		}
+		return false;
+	}
+
+	void parseCache()
+	{
+		const string fileName = "ut_misc_parse_cache.cfg";
+		const string rootFileName = "ut_misc_parse_cache_root.cfg";
+		writeConfigFile(fileName, "RootConfigFilename = \"ut_misc_parse_cache_root.cfg\";\nA = 1;\n");
+		writeConfigFile(rootFileName, "A = 100;\nR = 5;\n");
+
+		CMyDisplayer debug;
+		CLog logger;
+		logger.addDisplayer(&debug);
+		CNLDebugOverride	override(&logger);
+
+		CConfigFile configFile;
+		TEST_THROWS_NOTHING(configFile.load(fileName));
+		TEST_ASSERT(!fromParseCache(debug, fileName));
+		TEST_ASSERT(configFile.getVar("A").asInt() == 1);
+		TEST_ASSERT(configFile.getVar("R").asInt() == 5);
+
+		// another config file with the same files uses the result of the first parse
+		debug.Lines.clear();
+		CConfigFile sameFile;
+		TEST_THROWS_NOTHING(sameFile.load(fileName));
+		TEST_ASSERT(fromParseCache(debug, fileName));
+		TEST_ASSERT(sameFile.getVar("A").asInt() == 1);
+		TEST_ASSERT(sameFile.getVar("R").asInt() == 5);
+
+		// a root file modified, the files are parsed again
+		writeConfigFile(rootFileName, "A = 100;\nR = 6;\n");
+		debug.Lines.clear();
+		TEST_THROWS_NOTHING(sameFile.reparse());
+		TEST_ASSERT(!fromParseCache(debug, fileName));
+		TEST_ASSERT(sameFile.getVar("R").asInt() == 6);
+
+		// the first config file gets the new parse
+		debug.Lines.clear();
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(fromParseCache(debug, fileName));
+		TEST_ASSERT(configFile.getVar("R").asInt() == 6);
+
+		// the main file modified
+		writeConfigFile(fileName, "RootConfigFilename = \"ut_misc_parse_cache_root.cfg\";\nA = 2;\n");
+		debug.Lines.clear();
+		TEST_THROWS_NOTHING(configFile.reparse());
+		TEST_ASSERT(!fromParseCache(debug, fileName));
+		TEST_ASSERT(configFile.getVar("A").asInt() == 2);
+
+		// a parse error is not cached
+		writeConfigFile(fileName, "A = ;\n");
+		TEST_THROWS(configFile.reparse(), EParseError);
+		TEST_THROWS(sameFile.reparse(), EParseError);
+		TEST_ASSERT(configFile.getVar("A").asInt() == 2);
+
+		CFile::deleteFile(fileName);
+		CFile::deleteFile(rootFileName);
+		CFile::deleteFile("debug_"+fileName);
+	}
 };
 
+CConfigFile		*CUTMiscConfigFile::ReloadedFile = NULL;
+uint			CUTMiscConfigFile::NumACallbacks = 0;
+uint			CUTMiscConfigFile::NumBCallbacks = 0;
+uint			CUTMiscConfigFile::NumDCallbacks = 0;
+uint			CUTMiscConfigFile::NumFileCallbacks = 0;
+string			CUTMiscConfigFile::BSeenByA;
+
 #endif
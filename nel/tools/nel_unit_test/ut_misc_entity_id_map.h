@@ -0,0 +1,284 @@
+#ifndef UT_MISC_ENTITY_ID_MAP
+#define UT_MISC_ENTITY_ID_MAP
+
+#include <nel/misc/entity_id_map.h>
+#include <nel/misc/mem_stream.h>
+#include <map>
+
+// Test suite for CEntityIdMap
+class CUTMiscEntityIdMap : public Test::Suite
+{
+public:
+	CUTMiscEntityIdMap()
+	{
+		TEST_ADD(CUTMiscEntityIdMap::insertFindErase);
+		TEST_ADD(CUTMiscEntityIdMap::eraseColliding);
+		TEST_ADD(CUTMiscEntityIdMap::sameAsStdMap);
+		TEST_ADD(CUTMiscEntityIdMap::rehash);
+		TEST_ADD(CUTMiscEntityIdMap::serialCont);
+	}
+
+	// The slot where an id is inserted first in a map of 16 slots, like CEntityIdMap::hash()
+	static uint32 idealSlot(const CEntityId &id)
+	{
+		uint64 key = id.getRawId() & ~CEntityId(0, 0, 0, 0xff).getRawId();
+		key ^= key >> 33;
+		key *= UINT64_CONSTANT(0xff51afd7ed558ccd);
+		key ^= key >> 33;
+		key *= UINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+		key ^= key >> 33;
+		return (uint32)key & 15;
+	}
+
+	// Add count ids of an ideal slot, searched from nextId
+	static void addIds(uint32 slot, uint count, vector<CEntityId> &ids, uint64 &nextId)
+	{
+		while (count != 0)
+		{
+			CEntityId id(1, nextId++, 2, 0);
+			if (idealSlot(id) == slot)
+			{
+				ids.push_back(id);
+				count--;
+			}
+		}
+	}
+
+	// Check that the map holds the ids of the reference, with their values
+	template <class T>
+	static bool sameContent(const CEntityIdMap<T> &m, const std::map<CEntityId, T> &reference)
+	{
+		if (m.size() != reference.size())
+			return false;
+		typename std::map<CEntityId, T>::const_iterator it;
+		for (it = reference.begin(); it != reference.end(); ++it)
+		{
+			typename CEntityIdMap<T>::const_iterator found = m.find(it->first);
+			if (found == m.end() || !(found->first == it->first) || !(found->second == it->second))
+				return false;
+		}
+		// the iteration visits each element once
+		std::map<CEntityId, T> visited;
+		for (typename CEntityIdMap<T>::const_iterator itm = m.begin(); itm != m.end(); ++itm)
+			visited.insert(*itm);
+		return visited.size() == reference.size();
+	}
+
+	void insertFindErase()
+	{
+		CEntityIdMap<string> m;
+		TEST_ASSERT(m.empty());
+		TEST_ASSERT(m.find(CEntityId(1, 1, 2, 0)) == m.end());
+		TEST_ASSERT(m.erase(CEntityId(1, 1, 2, 0)) == 0);
+
+		TEST_ASSERT(m.insert(make_pair(CEntityId(1, 1, 2, 0), string("one"))).second);
+		m[CEntityId(1, 2, 2, 0)] = "two";
+		TEST_ASSERT(m.size() == 2);
+
+		// the value of a key already inserted is kept
+		pair<CEntityIdMap<string>::iterator, bool> res = m.insert(make_pair(CEntityId(1, 1, 2, 0), string("other")));
+		TEST_ASSERT(!res.second);
+		TEST_ASSERT(res.first->second == "one");
+		TEST_ASSERT(m[CEntityId(1, 2, 2, 0)] == "two");
+		TEST_ASSERT(m.size() == 2);
+
+		// the dynamic id is not a part of the key
+		TEST_ASSERT(m.count(CEntityId(1, 1, 2, 7)) == 1);
+		TEST_ASSERT(*m.findValue(CEntityId(1, 2, 2, 9)) == "two");
+		// but the creator and the type are
+		TEST_ASSERT(m.count(CEntityId(1, 1, 3, 0)) == 0);
+		TEST_ASSERT(m.findValue(CEntityId(2, 1, 2, 0)) == NULL);
+
+		// a default value is inserted by operator []
+		TEST_ASSERT(m[CEntityId(1, 3, 2, 0)].empty());
+		TEST_ASSERT(m.size() == 3);
+
+		TEST_ASSERT(m.erase(CEntityId(1, 1, 2, 5)) == 1);
+		TEST_ASSERT(m.count(CEntityId(1, 1, 2, 0)) == 0);
+		TEST_ASSERT(*m.findValue(CEntityId(1, 2, 2, 0)) == "two");
+		TEST_ASSERT(m.size() == 2);
+
+		m.clear();
+		TEST_ASSERT(m.empty());
+		TEST_ASSERT(m.count(CEntityId(1, 2, 2, 0)) == 0);
+		m[CEntityId(1, 2, 2, 0)] = "again";
+		TEST_ASSERT(*m.findValue(CEntityId(1, 2, 2, 0)) == "again");
+	}
+
+	void eraseColliding()
+	{
+		// clusters of keys of the same ideal slot in a map of 16 slots, wrapping at the end of the slots
+		vector<CEntityId> ids;
+		uint64 nextId = 1;
+		addIds(15, 4, ids, nextId);
+		addIds(0, 3, ids, nextId);
+		addIds(1, 2, ids, nextId);
+		addIds(14, 2, ids, nextId);
+		vector<CEntityId> absent;
+		addIds(15, 1, absent, nextId);
+		addIds(0, 1, absent, nextId);
+
+		// erase in several orders: the head, the middle and the tail of the clusters
+		for (uint order=0; order<3; order++)
+		{
+			CEntityIdMap<uint32> m;
+			std::map<CEntityId, uint32> reference;
+			for (uint i=0; i<ids.size(); i++)
+			{
+				m[ids[i]] = i;
+				reference[ids[i]] = i;
+			}
+			TEST_ASSERT(sameContent(m, reference));
+			TEST_ASSERT(m.count(absent[0]) == 0 && m.count(absent[1]) == 0);
+
+			vector<CEntityId> toErase = ids;
+			if (order == 1)
+				std::reverse(toErase.begin(), toErase.end());
+			else if (order == 2)
+				std::rotate(toErase.begin(), toErase.begin() + 5, toErase.end());
+
+			bool same = true;
+			for (uint i=0; i<toErase.size(); i++)
+			{
+				if (m.erase(toErase[i]) != 1)
+					same = false;
+				reference.erase(toErase[i]);
+				same = same && sameContent(m, reference) && m.count(absent[0]) == 0 && m.count(absent[1]) == 0;
+
+				// the erased key can be inserted again
+				if (i == 2)
+				{
+					m[toErase[i]] = 100;
+					reference[toErase[i]] = 100;
+					same = same && sameContent(m, reference);
+					m.erase(toErase[i]);
+					reference.erase(toErase[i]);
+				}
+			}
+			TEST_ASSERT(same);
+			TEST_ASSERT(m.empty());
+		}
+
+		// erase while iterating, the last element is moved in the erased one
+		CEntityIdMap<uint32> m;
+		std::map<CEntityId, uint32> reference;
+		for (uint i=0; i<ids.size(); i++)
+		{
+			m[ids[i]] = i;
+			if (i % 3 != 0)
+				reference[ids[i]] = i;
+		}
+		uint visited = 0;
+		for (CEntityIdMap<uint32>::iterator it = m.begin(); it != m.end(); )
+		{
+			visited++;
+			if (it->second % 3 == 0)
+				it = m.erase(it);
+			else
+				++it;
+		}
+		TEST_ASSERT(visited == ids.size());
+		TEST_ASSERT(sameContent(m, reference));
+	}
+
+	void sameAsStdMap()
+	{
+		// random operations on a small set of ids, the map stays small and full of clusters
+		CEntityIdMap<uint32> m;
+		std::map<CEntityId, uint32> reference;
+		uint32 seed = 12345;
+		bool same = true;
+		for (uint i=0; i<20000 && same; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			uint32 r = seed >> 16;
+			CEntityId id(1, (r >> 2) % 40, 0, (uint8)i);
+			switch (r & 3)
+			{
+			case 0:
+			case 1:
+				m[id] = i;
+				reference[id] = i;
+				break;
+			case 2:
+				same = m.erase(id) == reference.erase(id);
+				break;
+			default:
+				same = (m.findValue(id) == NULL) == (reference.find(id) == reference.end());
+				break;
+			}
+			if (i % 97 == 0)
+				same = same && sameContent(m, reference);
+		}
+		TEST_ASSERT(same);
+		TEST_ASSERT(sameContent(m, reference));
+	}
+
+	void rehash()
+	{
+		// grown several times
+		CEntityIdMap<uint32> m;
+		std::map<CEntityId, uint32> reference;
+		for (uint i=0; i<1000; i++)
+		{
+			CEntityId id(3, i*7919, 1, 0);
+			m[id] = i;
+			reference[id] = i;
+		}
+		TEST_ASSERT(sameContent(m, reference));
+
+		// reserved: the elements are moved to the new slots
+		m.reserve(5000);
+		TEST_ASSERT(sameContent(m, reference));
+		for (uint i=1000; i<5000; i++)
+		{
+			CEntityId id(3, i*7919, 1, 0);
+			m[id] = i;
+			reference[id] = i;
+		}
+		TEST_ASSERT(sameContent(m, reference));
+
+		CEntityIdMap<uint32> other;
+		other.swap(m);
+		TEST_ASSERT(m.empty());
+		TEST_ASSERT(sameContent(other, reference));
+	}
+
+	void serialCont()
+	{
+		CEntityIdMap<string> m;
+		std::map<CEntityId, string> reference;
+		for (uint i=0; i<100; i++)
+		{
+			CEntityId id(2, i*31 + 1, 4, 0);
+			m[id] = toString("entity %u", i);
+			reference[id] = m[id];
+		}
+
+		// round trip
+		CMemStream stream;
+		stream.serialCont(m);
+		stream.invert();
+		CEntityIdMap<string> m2;
+		m2[CEntityId(2, 9999, 4, 0)] = "erased by the read";
+		stream.serialCont(m2);
+		TEST_ASSERT(sameContent(m2, reference));
+
+		// the format is the one of std::map, to read the files written before
+		CMemStream mapStream;
+		mapStream.serialCont(reference);
+		mapStream.invert();
+		CEntityIdMap<string> m3;
+		mapStream.serialCont(m3);
+		TEST_ASSERT(sameContent(m3, reference));
+
+		CMemStream stream2;
+		stream2.serialCont(m);
+		stream2.invert();
+		std::map<CEntityId, string> reference2;
+		stream2.serialCont(reference2);
+		TEST_ASSERT(reference2 == reference);
+	}
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef UT_MISC_I18N
+#define UT_MISC_I18N
+
+#include <nel/misc/i18n.h>
+#include <nel/misc/path.h>
+
+// Test suite for the string tables of CI18N, loaded from the text or from the compiled file
+class CUTMiscI18N : public Test::Suite
+{
+public:
+	CUTMiscI18N ()
+	{
+		TEST_ADD(CUTMiscI18N::loadCompiled);
+		TEST_ADD(CUTMiscI18N::badCompiledFile);
+		TEST_ADD(CUTMiscI18N::duplicatedLabels);
+		TEST_ADD(CUTMiscI18N::reload);
+		// Add a line here when adding a new test METHOD
+	}
+
+	static ucstring fromUtf8(const string &str)
+	{
+		ucstring res;
+		res.fromUtf8(str);
+		return res;
+	}
+
+	static void writeLanguageFile(const string &filename, const string &utf8Content)
+	{
+		CI18N::writeTextFile(filename, fromUtf8(utf8Content), true);
+	}
+
+	static void deleteFiles(const string &languageCode)
+	{
+		if (CFile::fileExists(languageCode+".uxt"))
+			CFile::deleteFile(languageCode+".uxt");
+		if (CFile::fileExists(languageCode+".uxb"))
+			CFile::deleteFile(languageCode+".uxb");
+	}
+
+	void loadCompiled()
+	{
+		writeLanguageFile("ut_i18n_compiled.uxt",
+			"LanguageName [Compiled]\n"
+			"hello [Hello]\n"
+			"accent [\xc3\xa9t\xc3\xa9 \xe2\x82\xac]\n"
+			"empty []\n");
+		TEST_ASSERT(CI18N::compileStringFile("ut_i18n_compiled.uxt", "ut_i18n_compiled.uxb"));
+
+		// only the compiled file is left
+		CFile::deleteFile("ut_i18n_compiled.uxt");
+		CI18N::load("ut_i18n_compiled");
+		TEST_ASSERT(CI18N::get("LanguageName") == ucstring("Compiled"));
+		TEST_ASSERT(CI18N::get("hello") == ucstring("Hello"));
+		TEST_ASSERT(CI18N::get("accent") == fromUtf8("\xc3\xa9t\xc3\xa9 \xe2\x82\xac"));
+		TEST_ASSERT(CI18N::hasTranslation("empty"));
+		TEST_ASSERT(CI18N::get("empty").empty());
+
+		uint size = 0;
+		const ucchar *text = CI18N::getBuffer("hello", size);
+		TEST_ASSERT(text != NULL && ucstring(ucstringbase(text, size)) == ucstring("Hello"));
+
+		// a missing label
+		TEST_ASSERT(!CI18N::hasTranslation("missing"));
+		TEST_ASSERT(CI18N::getBuffer("missing", size) == NULL && size == 0);
+		TEST_ASSERT(CI18N::get("missing") == ucstring("<NotExist:missing>"));
+
+		deleteFiles("ut_i18n_compiled");
+	}
+
+	void badCompiledFile()
+	{
+		writeLanguageFile("ut_i18n_bad.uxt",
+			"LanguageName [Bad]\n"
+			"hello [From the text]\n");
+		FILE *fp = fopen("ut_i18n_bad.uxb", "wb");
+		nlverify(fp != NULL);
+		fputs("not a string table", fp);
+		fclose(fp);
+
+		// the text is loaded instead
+		CI18N::load("ut_i18n_bad");
+		TEST_ASSERT(CI18N::get("hello") == ucstring("From the text"));
+
+		deleteFiles("ut_i18n_bad");
+	}
+
+	void duplicatedLabels()
+	{
+		writeLanguageFile("ut_i18n_dup.uxt",
+			"LanguageName [Duplicated]\n"
+			"dup [first]\n"
+			"other [other]\n"
+			"dup [second]\n");
+
+		// the first text is kept, from the text or the compiled file
+		CI18N::load("ut_i18n_dup");
+		TEST_ASSERT(CI18N::get("dup") == ucstring("first"));
+		TEST_ASSERT(CI18N::get("other") == ucstring("other"));
+
+		TEST_ASSERT(CI18N::compileStringFile("ut_i18n_dup.uxt", "ut_i18n_dup.uxb"));
+		CFile::deleteFile("ut_i18n_dup.uxt");
+		CI18N::load("ut_i18n_dup");
+		TEST_ASSERT(CI18N::get("dup") == ucstring("first"));
+		TEST_ASSERT(CI18N::get("other") == ucstring("other"));
+
+		deleteFiles("ut_i18n_dup");
+	}
+
+	void reload()
+	{
+		writeLanguageFile("ut_i18n_base.uxt",
+			"LanguageName [Base]\n"
+			"a [A]\n"
+			"b [B]\n");
+		writeLanguageFile("ut_i18n_patch.uxt",
+			"b [B2]\n"
+			"c [C]\n");
+
+		// the mapped table is merged with the patch, the texts of the patch replace the old ones
+		TEST_ASSERT(CI18N::compileStringFile("ut_i18n_base.uxt", "ut_i18n_base.uxb"));
+		CI18N::load("ut_i18n_base");
+		TEST_ASSERT(CI18N::get("b") == ucstring("B"));
+		CI18N::loadFromFilename("ut_i18n_patch.uxt", false);
+		TEST_ASSERT(CI18N::get("a") == ucstring("A"));
+		TEST_ASSERT(CI18N::get("b") == ucstring("B2"));
+		TEST_ASSERT(CI18N::get("c") == ucstring("C"));
+
+		// the file is reloaded when it changes
+		writeLanguageFile("ut_i18n_patch.uxt",
+			"b [B3]\n"
+			"c [C3]\n");
+		for (uint i=0; i<20; i++)
+			CI18N::loadFromFilename("ut_i18n_patch.uxt", true);
+		TEST_ASSERT(CI18N::get("LanguageName") == ucstring("Base"));
+		TEST_ASSERT(CI18N::get("a") == ucstring("A"));
+		TEST_ASSERT(CI18N::get("b") == ucstring("B3"));
+		TEST_ASSERT(CI18N::get("c") == ucstring("C3"));
+
+		// the texts replaced are not kept, the texts left fill the block
+		const char *labels[] = { "LanguageName", "a", "b", "c" };
+		const ucchar *first = NULL;
+		const ucchar *last = NULL;
+		uint numChars = 0;
+		for (uint i=0; i<sizeof(labels)/sizeof(labels[0]); i++)
+		{
+			uint size;
+			const ucchar *text = CI18N::getBuffer(labels[i], size);
+			numChars += size;
+			if (first == NULL || text < first)
+				first = text;
+			if (last == NULL || text+size > last)
+				last = text+size;
+		}
+		TEST_ASSERT(last - first == (sint)numChars);
+
+		deleteFiles("ut_i18n_base");
+		CFile::deleteFile("ut_i18n_patch.uxt");
+	}
+};
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef UT_MISC_LOG
+#define UT_MISC_LOG
+
+#include <nel/misc/log.h>
+#include <nel/misc/displayer.h>
+#include <nel/misc/mutex.h>
+#include <nel/misc/thread.h>
+
+// A displayer which keeps the lines, and holds the thread which displays a line beginning with "hold" until release()
+class CUTLogDisplayer : public IDisplayer
+{
+public:
+	CUTLogDisplayer() : IDisplayer("UTLog"), NumFlushes(0), NumFlushedLines(0), _Hold(true), _Holding(false) { }
+
+	vector<string> getLines()
+	{
+		CAutoMutex<CCondition> lock(_Gate);
+		return _Lines;
+	}
+
+	// Wait until a thread is held
+	void waitHolding()
+	{
+		CAutoMutex<CCondition> lock(_Gate);
+		while (!_Holding)
+			_Gate.wait();
+	}
+
+	void release()
+	{
+		CAutoMutex<CCondition> lock(_Gate);
+		_Hold = false;
+		_Gate.notifyAll();
+	}
+
+	// Number of calls of doFlush(), and number of lines displayed at the last one
+	uint	NumFlushes;
+	uint	NumFlushedLines;
+
+protected:
+	virtual void doDisplay(const CLog::TDisplayInfo &args, const char *message)
+	{
+		CAutoMutex<CCondition> lock(_Gate);
+		string line(message);
+		if (!line.empty() && line[line.size()-1] == '\n')
+			line.resize(line.size()-1);
+		if (line.substr(0, 4) == "hold")
+		{
+			_Holding = true;
+			_Gate.notifyAll();
+			while (_Hold)
+				_Gate.wait();
+		}
+		_Lines.push_back(line);
+	}
+
+	virtual void doFlush()
+	{
+		CAutoMutex<CCondition> lock(_Gate);
+		NumFlushes++;
+		NumFlushedLines = (uint)_Lines.size();
+	}
+
+private:
+	CCondition		_Gate;
+	bool			_Hold;
+	bool			_Holding;
+	vector<string>	_Lines;
+};
+
+// A thread which logs lines, it has its own ring in the asynchronous writer
+class CUTLogThread : public IRunnable
+{
+public:
+	CUTLogThread(CLog &log, uint numLines) : HoldDisplayer(NULL), ErrorLog(NULL), FlushedLinesAtFlush(0), _Log(log), _NumLines(numLines) { }
+
+	// If set, a line "hold" is logged first, then the thread waits for the writer to hold on it
+	CUTLogDisplayer	*HoldDisplayer;
+	// If set, the lines are flushed then an error is logged in it
+	CLog			*ErrorLog;
+	// Set if ErrorLog: the lines of the log displayer when flushAsync() returns
+	vector<string>	LinesAtFlush;
+	uint			FlushedLinesAtFlush;
+
+	virtual void run()
+	{
+		if (HoldDisplayer != NULL)
+		{
+			_Log.displayNL("hold");
+			HoldDisplayer->waitHolding();
+		}
+		for (uint i=0; i<_NumLines; i++)
+			_Log.displayNL("line %u", i);
+		if (ErrorLog != NULL)
+		{
+			CUTLogDisplayer *displayer = (CUTLogDisplayer*)_Log.getDisplayer("UTLog");
+			CLog::flushAsync();
+			LinesAtFlush = displayer->getLines();
+			FlushedLinesAtFlush = displayer->NumFlushedLines;
+			ErrorLog->displayNL("error");
+		}
+	}
+
+	virtual void getName(std::string &result) const
+	{
+		result = "CUTLogThread";
+	}
+
+private:
+	CLog	&_Log;
+	uint	_NumLines;
+};
+
+// Test suite for the asynchronous mode of CLog. The rings of the threads are allocated with the size
+// given to the first startAsyncWriter(), so the lines are logged by new threads.
+class CUTMiscLog : public Test::Suite
+{
+public:
+	CUTMiscLog()
+	{
+		TEST_ADD(CUTMiscLog::asyncFlushOrder);
+		TEST_ADD(CUTMiscLog::asyncDrop);
+		TEST_ADD(CUTMiscLog::asyncBlock);
+		// stops the writer for good, must be the last one
+		TEST_ADD(CUTMiscLog::asyncCrashFlush);
+	}
+
+	static vector<string> expectedLines(uint numLines, bool hold)
+	{
+		vector<string> lines;
+		if (hold)
+			lines.push_back("hold");
+		for (uint i=0; i<numLines; i++)
+			lines.push_back(toString("line %u", i));
+		return lines;
+	}
+
+	static void runThread(CUTLogThread &logThread)
+	{
+		IThread *thread = IThread::create(&logThread);
+		thread->start();
+		thread->wait();
+		delete thread;
+	}
+
+	void asyncFlushOrder()
+	{
+		CUTLogDisplayer displayer;
+		CLog log(CLog::LOG_INFO);
+		CLog errorLog(CLog::LOG_ERROR);
+		log.addDisplayer(&displayer);
+		errorLog.addDisplayer(&displayer);
+		log.setAsync(true);
+		errorLog.setAsync(true);
+		displayer.release();
+
+		CLog::startAsyncWriter(4, CLog::AsyncBlock);
+		TEST_ASSERT(CLog::isAsyncWriterRunning());
+
+		// flushAsync() returns when the lines are displayed and flushed, an error is displayed after them
+		CUTLogThread logThread(log, 100);
+		logThread.ErrorLog = &errorLog;
+		runThread(logThread);
+		TEST_ASSERT(logThread.LinesAtFlush == expectedLines(100, false));
+		TEST_ASSERT(logThread.FlushedLinesAtFlush == 100);
+		vector<string> lines = displayer.getLines();
+		TEST_ASSERT(lines.size() == 101);
+		TEST_ASSERT(lines.back() == "error");
+
+		CLog::stopAsyncWriter();
+		TEST_ASSERT(!CLog::isAsyncWriterRunning());
+
+		// displayed synchronously
+		log.displayNL("sync");
+		TEST_ASSERT(displayer.getLines().back() == "sync");
+
+		log.removeDisplayer(&displayer);
+		errorLog.removeDisplayer(&displayer);
+	}
+
+	void asyncDrop()
+	{
+		CUTLogDisplayer displayer;
+		CUTLogDisplayer warnings;
+		CLog log(CLog::LOG_INFO);
+		log.addDisplayer(&displayer);
+		log.setAsync(true);
+		warnings.release();
+		createDebug();
+		WarningLog->addDisplayer(&warnings);
+
+		CLog::startAsyncWriter(4, CLog::AsyncDrop);
+
+		// the writer holds the first line, so 3 lines fit in the ring and the others are dropped
+		CUTLogThread logThread(log, 10);
+		logThread.HoldDisplayer = &displayer;
+		runThread(logThread);
+		displayer.release();
+		CLog::flushAsync();
+		TEST_ASSERT(displayer.getLines() == expectedLines(3, true));
+		// the lines pushed while the writer held the first one are displayed in the same pass, with one flush
+		TEST_ASSERT(displayer.NumFlushes == 1);
+		TEST_ASSERT(displayer.NumFlushedLines == 4);
+
+		vector<string> warningLines = warnings.getLines();
+		bool reported = false;
+		for (uint i=0; i<warningLines.size(); i++)
+			reported = reported || warningLines[i].find("7 lines dropped") != string::npos;
+		TEST_ASSERT(reported);
+
+		CLog::stopAsyncWriter();
+		WarningLog->removeDisplayer(&warnings);
+		log.removeDisplayer(&displayer);
+	}
+
+	void asyncBlock()
+	{
+		CUTLogDisplayer displayer;
+		CLog log(CLog::LOG_INFO);
+		log.addDisplayer(&displayer);
+		log.setAsync(true);
+
+		CLog::startAsyncWriter(4, CLog::AsyncBlock);
+
+		// the thread waits for the writer when its ring is full
+		CUTLogThread logThread(log, 10);
+		logThread.HoldDisplayer = &displayer;
+		IThread *thread = IThread::create(&logThread);
+		thread->start();
+		displayer.waitHolding();
+		nlSleep(100);
+		TEST_ASSERT(thread->isRunning());
+
+		// no line lost
+		displayer.release();
+		thread->wait();
+		delete thread;
+		CLog::flushAsync();
+		TEST_ASSERT(displayer.getLines() == expectedLines(10, true));
+
+		CLog::stopAsyncWriter();
+		log.removeDisplayer(&displayer);
+	}
+
+	void asyncCrashFlush()
+	{
+		// the writer may still use them at the exit of the process, they are never deleted
+		CUTLogDisplayer &holdDisplayer = *new CUTLogDisplayer;
+		CLog &holdLog = *new CLog(CLog::LOG_INFO);
+		CUTLogDisplayer displayer;
+		CLog log(CLog::LOG_INFO);
+		holdLog.addDisplayer(&holdDisplayer);
+		log.addDisplayer(&displayer);
+		holdLog.setAsync(true);
+		log.setAsync(true);
+		displayer.release();
+
+		CLog::startAsyncWriter(4, CLog::AsyncBlock);
+
+		// the writer is stuck on a line, the pending lines are displayed by the calling thread
+		CUTLogThread holdThread(holdLog, 0);
+		holdThread.HoldDisplayer = &holdDisplayer;
+		runThread(holdThread);
+		CUTLogThread logThread(log, 3);
+		runThread(logThread);
+		TEST_ASSERT(displayer.getLines().empty());
+		CLog::flushAsync(true);
+		TEST_ASSERT(displayer.getLines() == expectedLines(3, false));
+		TEST_ASSERT(!CLog::isAsyncWriterRunning());
+
+		// the line held is left to the writer
+		holdDisplayer.release();
+		CLog::stopAsyncWriter();
+		while (holdDisplayer.getLines().empty())
+			nlSleep(1);
+		TEST_ASSERT(holdDisplayer.getLines() == expectedLines(0, true));
+
+		// the writer can't be started again
+		CLog::startAsyncWriter(4, CLog::AsyncBlock);
+		TEST_ASSERT(!CLog::isAsyncWriterRunning());
+		log.displayNL("sync");
+		TEST_ASSERT(displayer.getLines().back() == "sync");
+
+		log.setAsync(false);
+		log.removeDisplayer(&displayer);
+	}
+};
+
+#endif
@@ -1,6 +1,10 @@
 #ifndef UT_MISC_PACK_FILE
 #define UT_MISC_PACK_FILE
 
+#include <nel/misc/big_file.h>
+#include <nel/misc/file.h>
+#include <nel/misc/path.h>
+#include <algorithm>
 
 // Commenting out the ifdef since the files are authored on Windows
 // and therefore always have a Windows-style newline.
@@ -35,6 +39,51 @@ public:
 		TEST_ADD(CUTMiscPackFile::loadFromBnpUncompressed);
 		TEST_ADD(CUTMiscPackFile::loadFromXmlpackUncompressed);
 		TEST_ADD(CUTMiscPackFile::loadXmlpackWithSameName);
+		TEST_ADD(CUTMiscPackFile::loadFromBnpV2);
+		TEST_ADD(CUTMiscPackFile::loadFromBnpV2Compressed);
+		TEST_ADD(CUTMiscPackFile::seekInBnpV2Compressed);
+		TEST_ADD(CUTMiscPackFile::readBlocksV2);
+		TEST_ADD(CUTMiscPackFile::searchBnpV2);
+	}
+
+	// Read a whole file with a CIFile
+	static string readFile(const string &filename, bool cacheFileOnOpen = false)
+	{
+		CIFile file;
+		if (cacheFileOnOpen)
+		{
+			file.allowBNPCacheFileOnOpen(false);
+			file.setCacheFileOnOpen(true);
+		}
+		if (!file.open(filename))
+			return "<not found>";
+		string content;
+		content.resize(file.getFileSize());
+		if (!content.empty())
+			file.serialBuffer((uint8*)&content[0], (uint)content.size());
+		return content;
+	}
+
+	// The content of big_in_bnp.txt in files_v2_z.bnp: 3 blocks of 64 KB, compressed
+	static string bigFileContent()
+	{
+		string content;
+		for (uint i=0; i<3000; i++)
+			content += toString("%06u the quick brown fox jumps over the lazy dog %u\n", i, i%13);
+		return content;
+	}
+
+	// The content of random_in_bnp.bin in files_v2_z.bnp: not compressible, so stored
+	static string randomFileContent()
+	{
+		string content;
+		uint32 x = 1;
+		for (uint i=0; i<2000; i++)
+		{
+			x = x*1103515245 + 12345;
+			content += (char)((x>>16) & 0xff);
+		}
+		return content;
 	}
 
 	void setup()
@@ -224,6 +273,186 @@ public:
 
 	}
 
+	void loadFromBnpV2()
+	{
+		// a v2 bnp with stored files, found in the hashed directory
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2.bnp", BF_ALWAYS_OPENED));
+
+		vector<string> files;
+		CBigFile::getInstance().list("files_v2.bnp", files);
+		sort(files.begin(), files.end());
+		TEST_ASSERT(files.size() == 3);
+		if (files.size() == 3)
+		{
+			TEST_ASSERT(files[0] == "copy_of_file1_in_bnp.txt");
+			TEST_ASSERT(files[1] == "file1_in_bnp.txt");
+			TEST_ASSERT(files[2] == "file2_in_bnp.txt");
+		}
+
+		TEST_ASSERT(readFile("files_v2.bnp@file1_in_bnp.txt") == "The content of the first file");
+		TEST_ASSERT(readFile("files_v2.bnp@file2_in_bnp.txt") == "Another content but for the second file");
+		// the names are not case sensitive
+		TEST_ASSERT(readFile("FILES_V2.BNP@File2_In_Bnp.txt") == "Another content but for the second file");
+		TEST_ASSERT(readFile("files_v2.bnp@file3_in_bnp.txt") == "<not found>");
+
+		// the copy has the same content, it is stored once
+		TEST_ASSERT(readFile("files_v2.bnp@copy_of_file1_in_bnp.txt") == "The content of the first file");
+		uint32 size1, offset1, sizeCopy, offsetCopy;
+		TEST_ASSERT(CBigFile::getInstance().getFileInfo("files_v2.bnp@file1_in_bnp.txt", size1, offset1));
+		TEST_ASSERT(CBigFile::getInstance().getFileInfo("files_v2.bnp@copy_of_file1_in_bnp.txt", sizeCopy, offsetCopy));
+		TEST_ASSERT(size1 == 29 && sizeCopy == 29);
+		TEST_ASSERT(offset1 == offsetCopy);
+
+		CBigFile::getInstance().remove("files_v2.bnp");
+	}
+
+	void loadFromBnpV2Compressed()
+	{
+		// a v2 bnp with a file compressed by blocks, and the files which don't compress stored
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2_z.bnp", BF_ALWAYS_OPENED));
+
+		const string bigContent = bigFileContent();
+		TEST_ASSERT(bigContent.size() > 2*64*1024);
+		TEST_ASSERT(readFile("files_v2_z.bnp@big_in_bnp.txt") == bigContent);
+		// decompressed at once in the cache
+		TEST_ASSERT(readFile("files_v2_z.bnp@big_in_bnp.txt", true) == bigContent);
+		TEST_ASSERT(readFile("files_v2_z.bnp@random_in_bnp.bin") == randomFileContent());
+		TEST_ASSERT(readFile("files_v2_z.bnp@file1_in_bnp.txt") == "The content of the first file");
+
+		// a compressed file can't be read directly in the bnp
+		uint32 size, offset;
+		TEST_ASSERT(!CBigFile::getInstance().getFileInfo("files_v2_z.bnp@big_in_bnp.txt", size, offset));
+		TEST_ASSERT(CBigFile::getInstance().getFileInfo("files_v2_z.bnp@random_in_bnp.bin", size, offset));
+
+		CBigFile::getInstance().remove("files_v2_z.bnp");
+	}
+
+	void seekInBnpV2Compressed()
+	{
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2_z.bnp", BF_ALWAYS_OPENED));
+
+		const string bigContent = bigFileContent();
+		const uint32 fileSize = (uint32)bigContent.size();
+		CIFile file;
+		TEST_ASSERT(file.open("files_v2_z.bnp@big_in_bnp.txt"));
+		TEST_ASSERT(file.getFileSize() == fileSize);
+
+		// partial reads in a block, across one and two block boundaries, backward and up to the end
+		const uint32 reads[][2] =
+		{
+			{ 10, 100 },
+			{ 65536-10, 20 },
+			{ 65536, 65536 },
+			{ 100, 65536*2 },
+			{ 65536*2+5, 30 },
+			{ 0, 65536 },
+			{ 65536-1, 1 },
+			{ fileSize-50, 50 },
+			{ 20, 3 },
+		};
+		for (uint i=0; i<sizeof(reads)/sizeof(reads[0]); i++)
+		{
+			string content(reads[i][1], ' ');
+			TEST_ASSERT(file.seek(reads[i][0], IStream::begin));
+			file.serialBuffer((uint8*)&content[0], reads[i][1]);
+			TEST_ASSERT(content == bigContent.substr(reads[i][0], reads[i][1]));
+			TEST_ASSERT(file.getPos() == (sint32)(reads[i][0] + reads[i][1]));
+		}
+
+		// sequential reads go on after the last one
+		TEST_ASSERT(file.seek(65536-3, IStream::begin));
+		string content(3, ' ');
+		file.serialBuffer((uint8*)&content[0], 3);
+		TEST_ASSERT(content == bigContent.substr(65536-3, 3));
+		file.serialBuffer((uint8*)&content[0], 3);
+		TEST_ASSERT(content == bigContent.substr(65536, 3));
+
+		// no read beyond the end
+		TEST_ASSERT(file.seek(-10, IStream::end));
+		content.resize(11);
+		TEST_THROWS(file.serialBuffer((uint8*)&content[0], 11), EReadError);
+		file.close();
+
+		CBigFile::getInstance().remove("files_v2_z.bnp");
+	}
+
+	void readBlocksV2()
+	{
+		TEST_ASSERT(CBigFile::getInstance().add(NEL_UNIT_BASE "ut_misc_files/files_v2_z.bnp", BF_ALWAYS_OPENED));
+
+		uint32 fileSize;
+		uint64 offset;
+		bool cacheFileOnOpen, alwaysOpened;
+		const CBigFileBlocks *blocks;
+		FILE *f = CBigFile::getInstance().getFile("files_v2_z.bnp@file1_in_bnp.txt", fileSize, offset, cacheFileOnOpen, alwaysOpened, blocks);
+		TEST_ASSERT(f != NULL);
+		TEST_ASSERT(blocks == NULL);
+
+		const string bigContent = bigFileContent();
+		f = CBigFile::getInstance().getFile("files_v2_z.bnp@big_in_bnp.txt", fileSize, offset, cacheFileOnOpen, alwaysOpened, blocks);
+		TEST_ASSERT(f != NULL);
+		TEST_ASSERT(blocks != NULL);
+		if (f == NULL || blocks == NULL)
+			return;
+		TEST_ASSERT(fileSize == bigContent.size());
+		TEST_ASSERT(blocks->BlockSize == 64*1024);
+		TEST_ASSERT(blocks->NumBlocks == 3);
+
+		vector<uint8> block;
+		uint32 blockIndex = CBigFile::NoBlock;
+		string content;
+
+		// a read in the middle of a block keeps it decompressed
+		content.resize(100);
+		TEST_ASSERT(CBigFile::readBlocks(f, *blocks, fileSize, 1000, (uint8*)&content[0], 100, block, blockIndex));
+		TEST_ASSERT(content == bigContent.substr(1000, 100));
+		TEST_ASSERT(blockIndex == 0);
+
+		// a read across the 3 blocks
+		content.resize(150000);
+		TEST_ASSERT(CBigFile::readBlocks(f, *blocks, fileSize, 1000, (uint8*)&content[0], 150000, block, blockIndex));
+		TEST_ASSERT(content == bigContent.substr(1000, 150000));
+		TEST_ASSERT(blockIndex == 2);
+
+		// the whole file, the last block is taken in the buffer
+		content.resize(fileSize);
+		TEST_ASSERT(CBigFile::readBlocks(f, *blocks, fileSize, 0, (uint8*)&content[0], fileSize, block, blockIndex));
+		TEST_ASSERT(content == bigContent);
+
+		// beyond the end
+		content.resize(2);
+		TEST_ASSERT(!CBigFile::readBlocks(f, *blocks, fileSize, fileSize-1, (uint8*)&content[0], 2, block, blockIndex));
+
+		CBigFile::getInstance().remove("files_v2_z.bnp");
+	}
+
+	void searchBnpV2()
+	{
+		// the files of the v2 bnp are added in the path
+		CPath::addSearchBigFile(NEL_UNIT_BASE "ut_misc_files/files_v2.bnp", false, false);
+		CPath::addSearchBigFile(NEL_UNIT_BASE "ut_misc_files/files_v2_z.bnp", false, false);
+
+		string filename = CPath::lookup("copy_of_file1_in_bnp.txt", false, true, false);
+		TEST_ASSERT(filename == "files_v2.bnp@copy_of_file1_in_bnp.txt");
+		TEST_ASSERT(readFile(filename) == "The content of the first file");
+
+		filename = CPath::lookup("big_in_bnp.txt", false, true, false);
+		TEST_ASSERT(filename == "files_v2_z.bnp@big_in_bnp.txt");
+		TEST_ASSERT(readFile(filename) == bigFileContent());
+
+		filename = CPath::lookup("RANDOM_IN_BNP.BIN", false, true, false);
+		TEST_ASSERT(filename == "files_v2_z.bnp@random_in_bnp.bin");
+		TEST_ASSERT(readFile(filename) == randomFileContent());
+
+		// the bnp itself is found for its modification date
+		TEST_ASSERT(!CPath::lookup("files_v2_z.bnp", false, true, false).empty());
+
+		vector<string> bnps;
+		bnps.push_back("files_v2.bnp");
+		bnps.push_back("files_v2_z.bnp");
+		CPath::removeBigFiles(bnps);
+		TEST_ASSERT(CPath::lookup("big_in_bnp.txt", false, false, false).empty());
+	}
 };
 
 #endif
@@ -3,6 +3,11 @@
 
 #include <nel/misc/stream.h>
 #include <nel/misc/bit_mem_stream.h>
+#include <nel/misc/rope_stream.h>
+#include <nel/misc/object_vector.h>
+#include <nel/misc/o_xml.h>
+#include <nel/misc/vector.h>
+#include <nel/misc/rgba.h>
 
 // The following line is known to crash in a Ryzom service
 CBitMemStream globalBms( false, 2048 ); // global to avoid reallocation
@@ -18,6 +23,37 @@ public:
 		TEST_ADD(CUTMiscStream::memStreamSwap);
 		TEST_ADD(CUTMiscStream::copyOnWrite);
 		TEST_ADD(CUTMiscStream::preallocatedBitStream);
+		TEST_ADD(CUTMiscStream::ropeStream);
+		TEST_ADD(CUTMiscStream::podVector);
+		TEST_ADD(CUTMiscStream::podVectorSlowPath);
+	}
+
+	// A mem stream which counts the calls to serialBuffer()
+	class CCountingMemStream : public CMemStream
+	{
+	public:
+		CCountingMemStream(bool inputStream=false, bool stringmode=false) : CMemStream(inputStream, stringmode), NumBuffers(0) { }
+		virtual void	serialBuffer(uint8 *buf, uint len)
+		{
+			NumBuffers++;
+			CMemStream::serialBuffer(buf, len);
+		}
+		uint	NumBuffers;
+	};
+
+	// Serialize a vector element by element, like serialCont() without the fast path
+	template <class T>
+	static void serialElements(IStream &f, vector<T> &cont)
+	{
+		sint32 len = (sint32)cont.size();
+		f.serial(len);
+		for (uint i=0; i<cont.size(); i++)
+			f.serial(cont[i]);
+	}
+
+	static bool sameBuffer(const CMemStream &s0, const CMemStream &s1)
+	{
+		return s0.length() == s1.length() && memcmp(s0.buffer(), s1.buffer(), s0.length()) == 0;
 	}
 
 	void preallocatedBitStream()
@@ -65,6 +101,201 @@ public:
 
 	}
 
+	void ropeStream()
+	{
+		// write across several chunks, with a value poked over a chunk boundary
+		CRopeStream rope;
+		sint32 countPos = rope.reserve(2);
+		uint32 i;
+		for (i=0; i<CRopeChunk::Size; ++i)
+			rope.serial(i);
+		uint32 pokePos = CRopeChunk::Size - 2;
+		rope.seek(pokePos, IStream::begin);
+		rope.reserve(sizeof(uint32));
+		rope.poke((uint32)0xdeadbeef, pokePos);
+		rope.seek(0, IStream::end);
+		string str("end");
+		rope.serial(str);
+		rope.poke((uint16)0x1234, countPos);
+		TEST_ASSERT(rope.length() == 2 + CRopeChunk::Size*4 + 4 + 3);
+		TEST_ASSERT(rope.getNumChunks() == 5);
+
+		// the copies and the slices share the chunks until they are modified
+		CRopeStream copy = rope;
+		CRopeStream slice = rope.slice(2 + 4*4, 8);
+		rope.poke((uint32)0, 2 + 4*4);
+
+		CMemStream mem;
+		copy.writeTo(mem);
+		TEST_ASSERT(mem.length() == copy.length());
+		mem.invert();
+		uint16 count;
+		mem.serial(count);
+		TEST_ASSERT(count == 0x1234);
+		uint32 value;
+		for (i=0; i<CRopeChunk::Size; ++i)
+		{
+			mem.serial(value);
+			if (2 + i*4 + 4 <= pokePos || 2 + i*4 >= pokePos + 4)
+				TEST_ASSERT(value == i);
+		}
+		mem.seek(pokePos, IStream::begin);
+		mem.serial(value);
+		TEST_ASSERT(value == 0xdeadbeef);
+
+		uint32 a, b;
+		slice.serial(a);
+		slice.serial(b);
+		TEST_ASSERT(a == 4 && b == 5);
+		TEST_THROWS(slice.serial(a), NLMISC::EStreamOverflow);
+
+		rope.invert();
+		rope.seek(-3 - 4, IStream::end);
+		rope.serial(str);
+		TEST_ASSERT(str == "end");
+	}
+
+	void podVector()
+	{
+		vector<uint16> shorts;
+		vector<uint32> ints;
+		vector<float> floats;
+		vector<CVector> vectors;
+		vector<CRGBA> colors;
+		for (uint i=0; i<100; i++)
+		{
+			shorts.push_back((uint16)(i*661));
+			ints.push_back(i*0x01020305);
+			floats.push_back(i*0.37f - 10.f);
+			vectors.push_back(CVector(i*1.f, -i*2.f, i*0.5f));
+			colors.push_back(CRGBA((uint8)i, (uint8)(i*3), (uint8)(i*7), (uint8)(255-i)));
+		}
+		CObjectVector<CVector> objectVectors;
+		objectVectors.resize((uint32)vectors.size());
+		for (uint i=0; i<vectors.size(); i++)
+			objectVectors[i] = vectors[i];
+		vector<uint32> empty;
+
+		// the fast path writes the same bytes as the serial of each element
+		CCountingMemStream fast;
+		CMemStream slow;
+		fast.serialCont(shorts);
+		fast.serialCont(ints);
+		fast.serialCont(floats);
+		fast.serialCont(vectors);
+		fast.serialCont(colors);
+		objectVectors.serial(fast);
+		fast.serialCont(empty);
+		serialElements(slow, shorts);
+		serialElements(slow, ints);
+		serialElements(slow, floats);
+		serialElements(slow, vectors);
+		serialElements(slow, colors);
+		serialElements(slow, vectors);
+		serialElements(slow, empty);
+		TEST_ASSERT(sameBuffer(fast, slow));
+#ifdef NL_LITTLE_ENDIAN
+		// one buffer per vector, not per element
+		TEST_ASSERT(fast.NumBuffers < 2*7);
+#endif
+
+		// and reads them back
+		vector<uint16> shorts2;
+		vector<uint32> ints2;
+		vector<float> floats2;
+		vector<CVector> vectors2;
+		vector<CRGBA> colors2;
+		CObjectVector<CVector> objectVectors2;
+		vector<uint32> empty2(3);
+		fast.invert();
+		fast.serialCont(shorts2);
+		fast.serialCont(ints2);
+		fast.serialCont(floats2);
+		fast.serialCont(vectors2);
+		fast.serialCont(colors2);
+		objectVectors2.serial(fast);
+		fast.serialCont(empty2);
+		TEST_ASSERT(shorts2 == shorts);
+		TEST_ASSERT(ints2 == ints);
+		TEST_ASSERT(floats2 == floats);
+		TEST_ASSERT(vectors2 == vectors);
+		TEST_ASSERT(colors2 == colors);
+		TEST_ASSERT(objectVectors2.size() == vectors.size());
+		bool sameObjects = true;
+		for (uint i=0; i<objectVectors2.size(); i++)
+			sameObjects = sameObjects && objectVectors2[i] == vectors[i];
+		TEST_ASSERT(sameObjects);
+		TEST_ASSERT(empty2.empty());
+
+		// a length beyond the stream is detected before the read
+		CMemStream truncated;
+		sint32 len = 1000;
+		truncated.serial(len);
+		truncated.invert();
+		TEST_THROWS(truncated.serialCont(ints2), NLMISC::EStream);
+	}
+
+	void podVectorSlowPath()
+	{
+		vector<uint32> ints;
+		vector<CVector> vectors;
+		for (uint i=0; i<20; i++)
+		{
+			ints.push_back(i*1001);
+			vectors.push_back(CVector(i*1.f, i*2.f, -i*3.f));
+		}
+
+		// string mode: the base types are serialized as text, element by element
+		CCountingMemStream stringMode(false, true);
+		TEST_ASSERT(!stringMode.canSerialPODBuffer());
+		stringMode.serialCont(ints);
+		stringMode.serialCont(vectors);
+		CMemStream stringModeSlow(false, true);
+		serialElements(stringModeSlow, ints);
+		serialElements(stringModeSlow, vectors);
+		TEST_ASSERT(sameBuffer(stringMode, stringModeSlow));
+		vector<uint32> ints2;
+		vector<CVector> vectors2;
+		stringMode.invert();
+		stringMode.serialCont(ints2);
+		stringMode.serialCont(vectors2);
+		TEST_ASSERT(ints2 == ints);
+		TEST_ASSERT(vectors2 == vectors);
+
+		// bit stream: the values are serialized bit per bit
+		CBitMemStream bits;
+		TEST_ASSERT(!bits.canSerialPODBuffer());
+		bits.serialCont(ints);
+		bits.serialCont(vectors);
+		CBitMemStream bitsSlow;
+		serialElements(bitsSlow, ints);
+		serialElements(bitsSlow, vectors);
+		TEST_ASSERT(sameBuffer(bits, bitsSlow));
+		ints2.clear();
+		vectors2.clear();
+		bits.invert();
+		bits.serialCont(ints2);
+		bits.serialCont(vectors2);
+		TEST_ASSERT(ints2 == ints);
+		TEST_ASSERT(vectors2 == vectors);
+
+		// xml: each element is in its own node
+		CMemStream xmlBuffer;
+		{
+			COXml xml;
+			TEST_ASSERT(xml.init(&xmlBuffer));
+			TEST_ASSERT(!xml.canSerialPODBuffer());
+			xml.serialCont(ints);
+			xml.flush();
+		}
+		string xmlText((const char*)xmlBuffer.buffer(), xmlBuffer.length());
+		uint numElements = 0;
+		for (string::size_type pos = xmlText.find("<ELM"); pos != string::npos; pos = xmlText.find("<ELM", pos+1))
+			numElements++;
+		TEST_ASSERT(numElements == ints.size());
+		TEST_ASSERT(xmlText.find("19019") != string::npos);
+	}
+
 	enum TEnum
 	{
 		e_a,
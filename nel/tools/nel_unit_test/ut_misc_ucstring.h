@@ -0,0 +1,234 @@
+#ifndef UT_MISC_UCSTRING
+#define UT_MISC_UCSTRING
+
+#include <nel/misc/ucstring.h>
+
+// Test suite for the UTF-8 conversions of ucstring, compared with the conversion character by character
+class CUTMiscUCString : public Test::Suite
+{
+public:
+	CUTMiscUCString ()
+	{
+		TEST_ADD(CUTMiscUCString::asciiRuns);
+		TEST_ADD(CUTMiscUCString::multiByteSequences);
+		TEST_ADD(CUTMiscUCString::invalidSequences);
+		TEST_ADD(CUTMiscUCString::randomStrings);
+		// Add a line here when adding a new test METHOD
+	}
+
+	// The conversion to UTF-8 before the ASCII runs, character by character
+	static string refToUtf8(const ucstring &str)
+	{
+		string res;
+		for (uint i=0; i<str.size(); i++)
+		{
+			ucchar c = str[i];
+			if (c < 0x80)
+			{
+				res += char(c);
+			}
+			else if (c < 0x800)
+			{
+				res += char(0xC0 | (c >> 6));
+				res += char(0x80 | (c & 0x3F));
+			}
+			else
+			{
+				res += char(0xE0 | (c >> 12));
+				res += char(0x80 | ((c >> 6) & 0x3F));
+				res += char(0x80 | (c & 0x3F));
+			}
+		}
+		return res;
+	}
+
+	// The conversion from UTF-8 before the ASCII runs, character by character. An invalid string is copied byte by byte.
+	static ucstring refFromUtf8(const string &str)
+	{
+		ucstring res;
+		uint i = 0;
+		while (i < str.size())
+		{
+			ucchar code = (uint8)str[i++];
+			uint iterations;
+			if (code < 0x80)
+			{
+				res += code;
+				continue;
+			}
+			else if ((code & 0xFE) == 0xFC) { code &= 0x01; iterations = 5; }
+			else if ((code & 0xFC) == 0xF8) { code &= 0x03; iterations = 4; }
+			else if ((code & 0xF8) == 0xF0) { code &= 0x07; iterations = 3; }
+			else if ((code & 0xF0) == 0xE0) { code &= 0x0F; iterations = 2; }
+			else if ((code & 0xE0) == 0xC0) { code &= 0x1F; iterations = 1; }
+			else return rawCopy(str);
+
+			for (uint j=0; j<iterations; j++)
+			{
+				if (i == str.size() || ((uint8)str[i] & 0xC0) != 0x80)
+					return rawCopy(str);
+				code = (ucchar)((code << 6) | ((uint8)str[i++] & 0x3F));
+			}
+			res += code;
+		}
+		return res;
+	}
+
+	static ucstring rawCopy(const string &str)
+	{
+		ucstring res;
+		for (uint i=0; i<str.size(); i++)
+			res += (ucchar)(uint8)str[i];
+		return res;
+	}
+
+	static ucstring fromUtf8(const string &str)
+	{
+		ucstring res;
+		res.fromUtf8(str);
+		return res;
+	}
+
+	// An ASCII string of size characters, all the printable ones and the controls are used
+	static ucstring asciiString(uint size, uint seed)
+	{
+		ucstring res;
+		for (uint i=0; i<size; i++)
+			res += (ucchar)((i*7 + seed) & 0x7F);
+		return res;
+	}
+
+	// Convert str both ways and check the results against the references
+	bool checkBothWays(const ucstring &str)
+	{
+		string utf8 = str.toUtf8();
+		if (utf8 != refToUtf8(str))
+			return false;
+		ucstring back = fromUtf8(utf8);
+		return back == str && back == refFromUtf8(utf8);
+	}
+
+	void asciiRuns()
+	{
+		// the runs shorter and longer than a block, with a character of 2 or 3 bytes at every offset
+		const ucchar others[] = { 0x80, 0xE9, 0x7FF, 0x800, 0x20AC, 0xFFFF };
+		bool same = true;
+		for (uint size=0; size<=40; size++)
+		{
+			ucstring ascii = asciiString(size, size);
+			same = same && checkBothWays(ascii);
+			for (uint offset=0; offset<size; offset++)
+			{
+				for (uint i=0; i<sizeof(others)/sizeof(others[0]); i++)
+				{
+					ucstring str = ascii;
+					str[offset] = others[i];
+					same = same && checkBothWays(str);
+				}
+			}
+		}
+		TEST_ASSERT(same);
+
+		// the source is not aligned
+		string utf8 = refToUtf8(asciiString(64, 3)) + "\xc3\xa9" + refToUtf8(asciiString(40, 5));
+		vector<ucchar> dest(utf8.size());
+		bool aligned = true;
+		for (uint start=0; start<16; start++)
+		{
+			string part = utf8.substr(start);
+			uint length = convertUtf8ToUtf16(utf8.data()+start, (uint)part.size(), &dest[0]);
+			aligned = aligned && length != InvalidUtf8 && ucstring(ucstringbase(&dest[0], length)) == refFromUtf8(part);
+		}
+		TEST_ASSERT(aligned);
+	}
+
+	void multiByteSequences()
+	{
+		// only 2 or 3 bytes characters, and ASCII between them
+		ucstring str;
+		for (uint c=0x80; c<0x10000; c+=0x3F)
+			str += (ucchar)c;
+		TEST_ASSERT(checkBothWays(str));
+
+		ucstring mixed;
+		for (uint i=0; i<str.size(); i++)
+		{
+			mixed += str[i];
+			mixed += asciiString(i%20, i);
+		}
+		TEST_ASSERT(checkBothWays(mixed));
+
+		TEST_ASSERT(fromUtf8("\xc3\xa9t\xc3\xa9") == refFromUtf8("\xc3\xa9t\xc3\xa9"));
+		TEST_ASSERT(fromUtf8("\xe2\x82\xac").size() == 1 && fromUtf8("\xe2\x82\xac")[0] == 0x20AC);
+
+		// the characters out of the 16 bits range are truncated, as before
+		TEST_ASSERT(fromUtf8("a\xf0\x9f\x98\x80z") == refFromUtf8("a\xf0\x9f\x98\x80z"));
+	}
+
+	void invalidSequences()
+	{
+		// the invalid strings are copied byte by byte, in the ASCII runs or after them
+		vector<string> invalids;
+		invalids.push_back("\x80");
+		invalids.push_back("abc\xbf");
+		invalids.push_back("\xc3\x28");
+		invalids.push_back("\xff");
+		invalids.push_back("\xfe\x80\x80\x80\x80\x80\x80");
+		// truncated sequences
+		invalids.push_back("\xc3");
+		invalids.push_back("abc\xe2\x82");
+		invalids.push_back("\xf0\x9f\x98");
+		string run = refToUtf8(asciiString(37, 1));
+		for (uint i=0, size=(uint)invalids.size(); i<size; i++)
+		{
+			invalids.push_back(run + invalids[i]);
+			invalids.push_back(invalids[i] + run);
+			invalids.push_back(run + "\xc3\xa9" + run + invalids[i]);
+		}
+
+		bool invalid = true;
+		bool same = true;
+		for (uint i=0; i<invalids.size(); i++)
+		{
+			const string &str = invalids[i];
+			vector<ucchar> dest(str.size());
+			invalid = invalid && convertUtf8ToUtf16(str.data(), (uint)str.size(), &dest[0]) == InvalidUtf8;
+			same = same && fromUtf8(str) == rawCopy(str) && fromUtf8(str) == refFromUtf8(str);
+		}
+		TEST_ASSERT(invalid);
+		TEST_ASSERT(same);
+
+		TEST_ASSERT(fromUtf8("").empty());
+	}
+
+	void randomStrings()
+	{
+		uint32 seed = 1;
+		bool same = true;
+		for (uint i=0; i<2000; i++)
+		{
+			string bytes;
+			ucstring str;
+			uint size = i % 70;
+			for (uint j=0; j<size; j++)
+			{
+				seed = seed*1103515245 + 12345;
+				uint r = seed >> 8;
+				bytes += (char)(r & 0xff);
+				str += (ucchar)((r%10 < 6) ? (r>>4) % 0x80 : (r%10 < 8) ? (r>>4) % 0x800 : (r>>4) % 0x10000);
+			}
+			same = same && checkBothWays(str) && fromUtf8(bytes) == refFromUtf8(bytes);
+
+			// a truncated valid string
+			string utf8 = refToUtf8(str);
+			if (!utf8.empty())
+			{
+				string truncated = utf8.substr(0, (seed >> 4) % utf8.size());
+				same = same && fromUtf8(truncated) == refFromUtf8(truncated);
+			}
+		}
+		TEST_ASSERT(same);
+	}
+};
+
+#endif
@@ -32,6 +32,9 @@
 #include "nel/misc/time_nl.h"
 #include "nel/misc/polygon.h"
 #include "nel/misc/smart_ptr.h"
+#include "nel/misc/mutex.h"
+#include "nel/misc/thread.h"
+#include "nel/misc/sha1.h"
 
 #include "nel/3d/scene_group.h"
 #include "nel/3d/transform_shape.h"
@@ -56,6 +59,12 @@
 #include <deque>
 #include <map>
 
+#ifdef NL_OS_WINDOWS
+#	include <windows.h>
+#else
+#	include <unistd.h>
+#endif
+
 using namespace std;
 using namespace NLMISC;
 using namespace NL3D;
@@ -111,6 +120,9 @@ uint32	getIdByCoord(uint x, uint y)
 	return y*256+x;
 }
 
+// The landscape tessellation uses the NL3D landscape globals, only one zone can be tessellated at a time
+static CMutex	LandscapeMutex;
+
 string	changeExt(string name, const string &ext)
 {
 	string::iterator	it, last;
@@ -128,7 +140,8 @@ string	changeExt(string name, const string &ext)
 
 
 
-void processAllPasses(string &zoneName)
+// Build the .lr of a zone, return false if it is not written
+bool processAllPasses(string &zoneName)
 {
 	uint	/*i,*/ j;
 
@@ -137,6 +150,12 @@ void processAllPasses(string &zoneName)
 	string							name;
 	string							filename;
 
+	// never leave the .lr of a previous run, it would be taken for the result of this one
+	name = changeExt(zoneName, string("lr"));
+	filename = OutputPath+name;
+	if (CFile::fileExists(filename))
+		CFile::deleteFile(filename);
+
 	try
 	{
 		uint16	zid = getZoneIdByName(zoneName);
@@ -145,7 +164,10 @@ void processAllPasses(string &zoneName)
 		CVector		translation = -box.getCenter();
 		if (tessellation.setup(zid, 4, translation))
 		{
-			tessellation.build();
+			{
+				CAutoMutex<CMutex>	lock(LandscapeMutex);
+				tessellation.build();
+			}
 
 			CAABBox	tbox = tessellation.computeBBox();
 
@@ -216,17 +238,187 @@ void processAllPasses(string &zoneName)
 			}
 
 			COFile	outputRetriever;
-			name = changeExt(zoneName, string("lr"));
-			filename = OutputPath+name;
 			if (Verbose)
 				nlinfo("save file %s", filename.c_str());
-			outputRetriever.open(filename);
+			if (!outputRetriever.open(filename))
+				return false;
 			retriever.serial(outputRetriever);
+			outputRetriever.close();
+			return true;
 		}
 	}
 	catch(Exception &e)
 	{
 		printf(e.what ());
+		// a partial file
+		CFile::deleteFile(filename);
+	}
+	return false;
+}
+
+
+
+// Version of the zone processing, change it to invalidate the cached .lr
+static const char	*ZoneCacheVersion = "BRB_LR_2";
+
+// Compute the key of the cached .lr of a zone, from all the inputs of processAllPasses()
+// The cliffs found by a zone are kept in its tessellation, a zone doesn't depend on the zones processed before
+// Returns false if the zone doesn't exist
+static bool	computeZoneCacheKey(const string &zoneName, string &key)
+{
+	string	zoneNameCopy = zoneName;
+	uint16	zid = getZoneIdByName(zoneNameCopy);
+	if (CPath::lookup(getZoneNameById(zid)+ZoneExt, false, false).empty())
+		return false;
+
+	string	data = toString("%s %s %s %f %d %d %d %d %d\n", ZoneCacheVersion, ZoneExt.c_str(), ZoneNHExt.c_str(), WaterThreshold, TessellateLevel, ReduceSurfaces, SmoothBorders, ComputeElevation, ComputeLevels);
+
+	// the 9 zones around
+	sint	zx, zy;
+	for (zy=(zid/256)-1; zy<=(zid/256)+1; ++zy)
+	{
+		for (zx=(zid%256)-1; zx<=(zid%256)+1; ++zx)
+		{
+			if (zx < 0 || zx > 255 || zy < 0 || zy > 255)
+				continue;
+
+			uint	neighbour = (zy<<8) + zx;
+			string	filename = CPath::lookup(getZoneNameById(neighbour)+ZoneExt, false, false);
+			string	filenameNH = CPath::lookup(getZoneNameById(neighbour)+ZoneNHExt, false, false);
+			data += toString("%d ", neighbour);
+			data += filename.empty() ? string("none") : getSHA1(filename, true).toString();
+			data += " ";
+			data += filenameNH.empty() ? string("none") : getSHA1(filenameNH, true).toString();
+			data += "\n";
+		}
+	}
+
+	// the primitives over the 9 zones
+	sint	x0 = (sint)(zid%256)*160,
+			y0 = -(sint)(zid/256)*160;
+	data += PrimChecker.hashArea(x0-160, y0-320, x0+320, y0+160).toString();
+
+	key = getSHA1((const uint8*)data.c_str(), (uint32)data.size()).toString();
+	return true;
+}
+
+// The number of threads to use when NumThreads is 0
+static uint	getNumProcessors()
+{
+#ifdef NL_OS_WINDOWS
+	SYSTEM_INFO	info;
+	GetSystemInfo(&info);
+	return (uint)info.dwNumberOfProcessors;
+#else
+	long	num = sysconf(_SC_NPROCESSORS_ONLN);
+	return num > 0 ? (uint)num : 1;
+#endif
+}
+
+// A worker that processes the zones of a shared list
+class CZoneWorker : public IRunnable
+{
+public:
+	CZoneWorker(vector<string> &zoneNames, vector<string> &cacheKeys, uint &nextZone, CMutex &mutex)
+		: _ZoneNames(zoneNames), _CacheKeys(cacheKeys), _NextZone(nextZone), _Mutex(mutex)
+	{
+	}
+
+	virtual void	run()
+	{
+		for(;;)
+		{
+			uint	zone;
+			{
+				CAutoMutex<CMutex>	lock(_Mutex);
+				if (_NextZone >= _ZoneNames.size())
+					break;
+				zone = _NextZone++;
+			}
+
+			string	zoneName = _ZoneNames[zone];
+			nlinfo("Generate final .lr for zone %s", zoneName.c_str());
+			bool	written = processAllPasses(zoneName);
+
+			// put the .lr in the cache through a temporary file, a concurrent build must never read a partial file
+			const string	&key = _CacheKeys[zone];
+			if (written && !key.empty())
+			{
+				string	filename = OutputPath+changeExt(zoneName, string("lr"));
+				string	cached = CPath::standardizePath(CacheDirectory)+key+".lr";
+				string	tmp = cached+toString(".%u.tmp", zone);
+				if (CFile::fileExists(filename) && CFile::copyFile(tmp.c_str(), filename.c_str()) && !CFile::moveFile(cached.c_str(), tmp.c_str()))
+					CFile::deleteFile(tmp);
+			}
+		}
+	}
+
+	virtual void	getName(std::string &result) const
+	{
+		result = "CZoneWorker";
+	}
+
+private:
+	vector<string>	&_ZoneNames;
+	vector<string>	&_CacheKeys;
+	uint			&_NextZone;
+	CMutex			&_Mutex;
+};
+
+void processZones(vector<string> &zoneNames)
+{
+	uint	i;
+
+	// look for the zones already in the cache, the other ones are processed
+	vector<string>	toProcess;
+	vector<string>	cacheKeys;
+	if (!CacheDirectory.empty())
+		CFile::createDirectoryTree(CacheDirectory);
+	for (i=0; i<zoneNames.size(); ++i)
+	{
+		string	key;
+		if (!CacheDirectory.empty() && computeZoneCacheKey(zoneNames[i], key))
+		{
+			string	cached = CPath::standardizePath(CacheDirectory)+key+".lr";
+			string	filename = OutputPath+changeExt(zoneNames[i], string("lr"));
+			if (CFile::fileExists(cached) && CFile::copyFile(filename.c_str(), cached.c_str()))
+			{
+				if (Verbose)
+					nlinfo("zone %s is up to date, use %s", zoneNames[i].c_str(), cached.c_str());
+				continue;
+			}
+		}
+		toProcess.push_back(zoneNames[i]);
+		cacheKeys.push_back(key);
+	}
+
+	nlinfo("%d zones up to date, %d zones to process", (uint)(zoneNames.size()-toProcess.size()), (uint)toProcess.size());
+	if (toProcess.empty())
+		return;
+
+	// process the zones on a pool of threads
+	uint	numThreads = NumThreads != 0 ? NumThreads : getNumProcessors();
+	numThreads = std::min(numThreads, (uint)toProcess.size());
+
+	uint			nextZone = 0;
+	CMutex			mutex;
+	CZoneWorker		worker(toProcess, cacheKeys, nextZone, mutex);
+	if (numThreads <= 1)
+	{
+		worker.run();
+		return;
+	}
+
+	vector<IThread*>	threads;
+	for (i=0; i<numThreads; ++i)
+	{
+		threads.push_back(IThread::create(&worker));
+		threads.back()->start();
+	}
+	for (i=0; i<threads.size(); ++i)
+	{
+		threads[i]->wait();
+		delete threads[i];
 	}
 }
 
@@ -27,8 +27,10 @@
 #define NL_MOULINETTE_H
 
 #include <string>
+#include <vector>
 
-void		processAllPasses(std::string &zoneName);
+bool		processAllPasses(std::string &zoneName);
+void		processZones(std::vector<std::string> &zoneNames);
 /*
 void		tessellateAndMoulineZone(std::string &zoneName);
 void		processRetriever(std::string &zoneName);
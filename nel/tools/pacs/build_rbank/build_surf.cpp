@@ -314,9 +314,9 @@ void	NLPACS::CSurfElement::computeQuantas(CZoneTessellation *zoneTessel)
 
 	IsValid = (Normal.z > 0.707f);
 
-	uint8	bits0 = PrimChecker.get((uint)v0.x, (uint)v0.y);
-	uint8	bits1 = PrimChecker.get((uint)v1.x, (uint)v1.y);
-	uint8	bits2 = PrimChecker.get((uint)v2.x, (uint)v2.y);
+	uint8	bits0 = zoneTessel->getPrimBits((uint)v0.x, (uint)v0.y);
+	uint8	bits1 = zoneTessel->getPrimBits((uint)v1.x, (uint)v1.y);
+	uint8	bits2 = zoneTessel->getPrimBits((uint)v2.x, (uint)v2.y);
 
 	uint16	ws0 = PrimChecker.index((uint)v0.x, (uint)v0.y);
 	uint16	ws1 = PrimChecker.index((uint)v1.x, (uint)v1.y);
@@ -1333,7 +1333,10 @@ void	NLPACS::CZoneTessellation::compile()
 				if (minz <= wh)
 				{
 					CPolygon	p(v0, v1, v2);
-					PrimChecker.renderBits(p, CPrimChecker::Cliff);
+					vector<pair<sint, sint> >	points;
+					CPrimChecker::rasterize(p, points);
+					for (i=0; i<points.size(); ++i)
+						CliffPoints.insert(((uint32)(points[i].first & 0xffff) << 16) | (uint32)(points[i].second & 0xffff));
 
 					HasInvertedUnderWater = true;
 				}
@@ -1730,6 +1733,16 @@ void	NLPACS::CZoneTessellation::clear()
 	Elements.clear();
 	Surfaces.clear();
 	Borders.clear();
+	CliffPoints.clear();
+}
+
+uint8	NLPACS::CZoneTessellation::getPrimBits(uint x, uint y) const
+{
+	uint8	bits = PrimChecker.get(x, y);
+	// the grid only uses the 16 lower bits of the coordinates
+	if (!CliffPoints.empty() && CliffPoints.find(((x & 0xffff) << 16) | (y & 0xffff)) != CliffPoints.end())
+		bits |= CPrimChecker::Cliff;
+	return bits;
 }
 
 CAABBox	NLPACS::CZoneTessellation::computeBBox() const
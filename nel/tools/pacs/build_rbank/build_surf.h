@@ -27,6 +27,7 @@
 #define NL_BUILD_SURF_H
 
 #include <vector>
+#include <set>
 
 #include "nel/misc/debug.h"
 #include "nel/misc/file.h"
@@ -86,6 +87,8 @@ extern std::string				GlobalUL;
 extern std::string				GlobalDR;
 extern bool						ProcessGlobal;
 extern bool						Verbose;
+extern std::string				CacheDirectory;
+extern uint						NumThreads;
 
 extern CPrimChecker				PrimChecker;
 
@@ -523,6 +526,13 @@ public:
 	std::vector<NLMISC::CPolygon>			WaterShapes;
 	NL3D::CQuadGrid<uint32>					WaterGrid;
 
+	/**
+	 * The cliffs under water found by compile(), in the coordinates of the PrimChecker grid.
+	 * They are kept in the zone instead of the shared PrimChecker, so the zones give the same
+	 * result in any order and can be processed in parallel.
+	 */
+	std::set<uint32>						CliffPoints;
+
 	/** 
 	 * The tessellation refinement. The size of the tessellation is equal to 2m/Refinement
 	 * (say, for instance, a refinement of 2 means a 1m large tessellation.)
@@ -591,6 +601,11 @@ public:
 	 */
 	void	compile();
 
+	/**
+	 * The PrimChecker bits at a position, with the cliffs of the zone.
+	 */
+	uint8	getPrimBits(uint x, uint y) const;
+
 	/**
 	 * Generates a CMesh from the tessellation.
 	 */
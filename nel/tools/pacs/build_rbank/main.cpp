@@ -95,6 +95,8 @@ string												LevelDesignWorldPath;
 string												IgLandPath;
 string												IgVillagePath;
 bool												Verbose = false;
+string												CacheDirectory;
+uint												NumThreads = 0;
 
 CPrimChecker										PrimChecker;
 
@@ -192,6 +194,8 @@ void	initMoulinette()
 		ProcessGlobal = getBool(cf, "ProcessGlobal", false);
 
 		OutputRootPath = getString(cf, "OutputRootPath");
+		CacheDirectory = getString(cf, "CacheDirectory");
+		NumThreads = getInt(cf, "NumThreads", 0);
 		UseZoneSquare = getBool(cf, "UseZoneSquare", false);
 
 		WaterThreshold = getFloat(cf, "WaterThreshold", 1.0);
@@ -275,8 +279,6 @@ void	initMoulinette()
 \****************************************************************/
 void	moulineZones(vector<string> &zoneNames)
 {
-	uint	i;
-
 	if (CheckPrims)
 	{
 		PrimChecker.build(LevelDesignWorldPath, IgLandPath, IgVillagePath);
@@ -287,11 +289,7 @@ void	moulineZones(vector<string> &zoneNames)
 	if (ProcessAllPasses)
 	{
 
-		for (i=0; i<zoneNames.size(); ++i)
-		{
-			nlinfo("Generate final .lr for zone %s", zoneNames[i].c_str());
-			processAllPasses(zoneNames[i]);
-		}
+		processZones(zoneNames);
 
 	}
 
@@ -364,6 +362,9 @@ int main(int argc, char **argv)
 					case 'g':
 						ProcessGlobal = false;
 						break;
+					case 'j':
+						NumThreads = atoi(argv[i]+2);
+						break;
 					case 'T':
 					case 't':
 					case 'M':
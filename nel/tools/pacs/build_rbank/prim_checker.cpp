@@ -228,6 +228,38 @@ bool	CPrimChecker::load(const string &outputDirectory)
 
 
 
+/*
+ *		hashArea()
+ */
+CHashKey	CPrimChecker::hashArea(sint x0, sint y0, sint x1, sint y1) const
+{
+	vector<uint8>	data;
+	data.reserve((x1-x0)*(y1-y0)*3 + _WaterHeight.size()*sizeof(float));
+
+	sint	x, y;
+	for (y=y0; y<y1; ++y)
+	{
+		for (x=x0; x<x1; ++x)
+		{
+			uint16	idx = index((uint)x, (uint)y);
+			data.push_back(get((uint)x, (uint)y));
+			data.push_back((uint8)(idx & 0xff));
+			data.push_back((uint8)(idx >> 8));
+		}
+	}
+
+	// water heights are all hashed, the water shape indices are global
+	if (!_WaterHeight.empty())
+	{
+		const uint8	*heights = (const uint8*)&(_WaterHeight[0]);
+		data.insert(data.end(), heights, heights+_WaterHeight.size()*sizeof(float));
+	}
+
+	return getSHA1(data.empty() ? NULL : &(data[0]), (uint32)data.size());
+}
+
+
+
 /*
  *		readFile()
  */
@@ -391,6 +423,17 @@ void	CPrimChecker::render(const CPolygon &poly, uint16 value)
  * Render a CPolygon of bit value
  */
 void	CPrimChecker::renderBits(const CPolygon &poly, uint8 bits)
+{
+	vector<pair<sint, sint> >	points;
+	rasterize(poly, points);
+	for (uint i=0; i<points.size(); ++i)
+		_Grid.set((uint)points[i].first, (uint)points[i].second, bits);
+}
+
+/*
+ * rasterize()
+ */
+void	CPrimChecker::rasterize(const CPolygon &poly, vector<pair<sint, sint> > &points)
 {
 	list<CPolygon>		convex;
 
@@ -421,7 +464,7 @@ void	CPrimChecker::renderBits(const CPolygon &poly, uint8 bits)
 
 			for (x=rasterized[dy].first; x<=rasterized[dy].second; ++x)
 			{
-				_Grid.set((uint)x, (uint)(ymin+dy), bits);
+				points.push_back(make_pair(x, ymin+dy));
 			}
 		}
 	}
@@ -30,6 +30,7 @@
 #include "nel/misc/stream.h"
 
 #include <nel/misc/polygon.h>
+#include <nel/misc/sha1.h>
 
 namespace NLMISC
 {
@@ -92,9 +93,15 @@ public:
 		return _WaterHeight[index];
 	}
 
+	/// Hash the bits and the indices in an area, and the water heights
+	CHashKey	hashArea(sint x0, sint y0, sint x1, sint y1) const;
+
 	/// Render a CPolygon of bit value
 	void	renderBits(const NLMISC::CPolygon &poly, uint8 bits);
 
+	/// Get the points of the grid covered by a CPolygon
+	static void	rasterize(const NLMISC::CPolygon &poly, std::vector<std::pair<sint, sint> > &points);
+
 private:
 
 	/// \name Grid management
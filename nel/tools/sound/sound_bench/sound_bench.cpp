@@ -0,0 +1,294 @@
+/** \file sound_bench.cpp
+ * sound_bench.cpp : Headless benchmark of the sound mixing, with the software sound driver
+ *
+ * $Id$
+ */
+
+/* Copyright, 2002 Nevrax Ltd.
+ *
+ * This file is part of NEVRAX NEL.
+ * NEVRAX NEL is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+
+ * NEVRAX NEL is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with NEVRAX NEL; see the file COPYING. If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330, Boston,
+ * MA 02111-1307, USA.
+ */
+
+#include "nel/misc/types_nl.h"
+#include "nel/misc/common.h"
+#include "nel/misc/path.h"
+#include "nel/misc/time_nl.h"
+#include "nel/misc/vector.h"
+#include "nel/misc/string_mapper.h"
+#include "nel/sound/u_audio_mixer.h"
+#include "nel/sound/u_listener.h"
+#include "nel/sound/u_source.h"
+
+#include "sound/driver/sound_driver.h"
+#include "sound/driver/buffer.h"
+#include "sound/driver/source.h"
+#include "sound/driver/listener.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+using namespace std;
+using namespace NLMISC;
+using namespace NLSOUND;
+
+
+// ***************************************************************************
+static double	getMilliSeconds(TTicks start)
+{
+	return CTime::ticksToSecond(CTime::getPerformanceTime() - start) * 1000.0;
+}
+
+// ***************************************************************************
+static float	frand(float min, float max)
+{
+	return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+// ***************************************************************************
+class CBenchStringMapper : public ISoundDriver::IStringMapperProvider
+{
+public:
+	virtual TStringId			map(const std::string &str) { return CStringMapper::map(str); }
+	virtual const std::string	&unmap(const TStringId &stringId) { return CStringMapper::unmap(stringId); }
+};
+
+// ***************************************************************************
+// Generated sounds: 0 is mono 16 bits, 1 is mono ADPCM, 2 is stereo 16 bits
+static void	fillBuffer(IBuffer *buffer, uint type)
+{
+	uint	frequency= (type == 2) ? 44100 : 22050;
+	uint	nbFrame= frequency;
+	uint	channels= (type == 2) ? 2 : 1;
+
+	vector<sint16>	pcm(nbFrame * channels);
+	for(uint i=0;i<nbFrame;i++)
+	{
+		float	t= (float)i / (float)frequency;
+		float	v= 0.5f * sinf(2.f * (float)Pi * (220.f + 110.f * type) * t) + frand(-0.1f, 0.1f);
+		for(uint c=0;c<channels;c++)
+			pcm[i * channels + c]= (sint16)(v * 32767.f);
+	}
+
+	buffer->setName(CStringMapper::map(toString("bench_%u", type)));
+	if (type == 1)
+	{
+		vector<uint8>	adpcm(nbFrame / 2);
+		IBuffer::TADPCMState	state;
+		state.PreviousSample= 0;
+		state.StepIndex= 0;
+		IBuffer::encodeADPCM(&pcm[0], &adpcm[0], nbFrame, state);
+		buffer->setFormat(IBuffer::FormatDviAdpcm, 1, 4, frequency);
+		buffer->fill(&adpcm[0], (uint)adpcm.size());
+	}
+	else
+	{
+		buffer->setFormat(IBuffer::FormatPcm, (uint8)channels, 16, frequency);
+		buffer->fill((const uint8*)&pcm[0], (uint)pcm.size() * sizeof(sint16));
+	}
+}
+
+// ***************************************************************************
+// The listener goes round in circle
+static CVector	getListenerPos(uint frame)
+{
+	float	angle= (float)frame * 0.01f;
+	return CVector(20.f * cosf(angle), 20.f * sinf(angle), 0.f);
+}
+
+// ***************************************************************************
+// Mix numSources driver sources for numFrames frames of frameMs. Return the time in ms.
+static double	benchDriver(uint numSources, uint numFrames, uint frameMs, const string &output, string &profile)
+{
+	CBenchStringMapper	stringMapper;
+	ISoundDriver	*driver= ISoundDriver::createDriver(&stringMapper, ISoundDriver::DriverSoftware);
+	string	device= toString("step=%u", frameMs);
+	if (!output.empty())
+		device+= ";" + output;
+	driver->init(device, (ISoundDriver::TSoundOptions)(ISoundDriver::OptionAllowADPCM | ISoundDriver::OptionManualRolloff));
+	IListener	*listener= driver->createListener();
+
+	vector<IBuffer*>	buffers;
+	for(uint i=0;i<3;i++)
+	{
+		buffers.push_back(driver->createBuffer());
+		fillBuffer(buffers.back(), i);
+	}
+
+	srand(0);
+	vector<ISource*>	sources;
+	for(uint i=0;i<numSources;i++)
+	{
+		ISource	*source= driver->createSource();
+		source->setStaticBuffer(buffers[i % buffers.size()]);
+		source->setLooping(true);
+		source->setPos(CVector(frand(-100.f, 100.f), frand(-100.f, 100.f), frand(-5.f, 5.f)));
+		source->setMinMaxDistances(2.f, 100.f);
+		source->setAlpha(1.0);
+		source->setPitch(frand(0.8f, 1.2f));
+		source->setGain(1.f / 16.f);
+		source->play();
+		sources.push_back(source);
+	}
+
+	TTicks	start= CTime::getPerformanceTime();
+	for(uint frame=0;frame<numFrames;frame++)
+	{
+		listener->setPos(getListenerPos(frame));
+		// move some sources, like the entities of a scene
+		for(uint i=frame % 8;i<sources.size();i+=8)
+			sources[i]->setPos(sources[i]->getPos() + CVector(frand(-0.5f, 0.5f), frand(-0.5f, 0.5f), 0.f));
+		driver->commit3DChanges();
+	}
+	double	timeMs= getMilliSeconds(start);
+
+	driver->writeProfile(profile);
+
+	for(uint i=0;i<sources.size();i++)
+		delete sources[i];
+	for(uint i=0;i<buffers.size();i++)
+		delete buffers[i];
+	delete listener;
+	delete driver;
+
+	return timeMs;
+}
+
+// ***************************************************************************
+// Update an audio mixer with numSources sources for numFrames frames of frameMs. Return the time in ms.
+static double	benchMixer(const string &dataPath, uint numSources, uint numTracks, uint numFrames, uint frameMs, const string &output, string &profile)
+{
+	CPath::addSearchPath(dataPath, true, false);
+
+	UAudioMixer	*mixer= UAudioMixer::createAudioMixer();
+	mixer->setSamplePath(dataPath);
+	mixer->setPackedSheetOption(dataPath, true);
+	string	device= toString("step=%u", frameMs);
+	if (!output.empty())
+		device+= ";" + output;
+	mixer->setDriverDevice(device);
+	mixer->init(numTracks, false, true, NULL, true, UAudioMixer::DriverSoftware, true, true);
+
+	vector<TStringId>	soundNames;
+	mixer->getSoundNames(soundNames);
+	if (soundNames.empty())
+	{
+		fprintf (stderr, "No sound found in %s\n", dataPath.c_str());
+		delete mixer;
+		return 0;
+	}
+
+	srand(0);
+	vector<USource*>	sources;
+	for(uint i=0;i<numSources;i++)
+	{
+		USource	*source= mixer->createSource(soundNames[i % soundNames.size()]);
+		if (!source)
+			continue;
+		source->setPos(CVector(frand(-100.f, 100.f), frand(-100.f, 100.f), frand(-5.f, 5.f)));
+		source->setLooping(true);
+		source->play();
+		sources.push_back(source);
+	}
+	printf ("mixer: %u sources created with %u sounds\n", (uint)sources.size(), (uint)soundNames.size());
+
+	TTicks	start= CTime::getPerformanceTime();
+	for(uint frame=0;frame<numFrames;frame++)
+	{
+		mixer->setListenerPos(getListenerPos(frame));
+		for(uint i=frame % 8;i<sources.size();i+=8)
+			sources[i]->setPos(sources[i]->getPos() + CVector(frand(-0.5f, 0.5f), frand(-0.5f, 0.5f), 0.f));
+		mixer->update();
+	}
+	double	timeMs= getMilliSeconds(start);
+
+	mixer->writeProfile(profile);
+
+	for(uint i=0;i<sources.size();i++)
+		delete sources[i];
+	delete mixer;
+
+	return timeMs;
+}
+
+
+// ***************************************************************************
+int main(int argc, char* argv[])
+{
+	try
+	{
+		// Parse the options
+		uint	numSources= 2000;
+		uint	numTracks= 256;
+		uint	numFrames= 500;
+		uint	frameMs= 20;
+		string	output;
+		string	dataPath;
+		bool	verbose= false;
+		for(sint i=1;i<argc;i++)
+		{
+			if(strcmp(argv[i], "-sources")==0 && i+1<argc)
+				numSources= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-tracks")==0 && i+1<argc)
+				numTracks= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-frames")==0 && i+1<argc)
+				numFrames= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-step")==0 && i+1<argc)
+				frameMs= atoi(argv[++i]);
+			else if(strcmp(argv[i], "-wav")==0 && i+1<argc)
+				output= argv[++i];
+			else if(strcmp(argv[i], "-mixer")==0 && i+1<argc)
+				dataPath= argv[++i];
+			else if(strcmp(argv[i], "-v")==0)
+				verbose= true;
+			else
+			{
+				// Help message
+				printf ("sound_bench [-sources n] [-frames n] [-step ms] [-wav file.wav] [-mixer data_path [-tracks n]] [-v]\n");
+				printf ("Mix \"sources\" sources for \"frames\" frames of \"step\" ms with the software sound driver:\n");
+				printf ("\t- by default, driver sources playing generated sounds\n");
+				printf ("\t- with -mixer, audio mixer sources playing the sounds found in data_path, on \"tracks\" tracks\n");
+				printf ("The mix is written in a wav file with -wav. -v displays the driver profile.\n");
+				return -1;
+			}
+		}
+		if (!frameMs)
+			frameMs= 20;
+
+		string	profile;
+		double	timeMs;
+		if (dataPath.empty())
+			timeMs= benchDriver(numSources, numFrames, frameMs, output, profile);
+		else
+			timeMs= benchMixer(dataPath, numSources, numTracks, numFrames, frameMs, output, profile);
+
+		double	renderedMs= (double)numFrames * frameMs;
+		printf ("%s: %d sources, %d frames of %d ms in %.2f ms (%.3f ms/frame), %.1fx real time\n", 
+			dataPath.empty() ? "driver" : "mixer", numSources, numFrames, frameMs, timeMs, 
+			numFrames ? timeMs/numFrames : 0.0, timeMs > 0 ? renderedMs/timeMs : 0.0);
+		if (verbose)
+			printf ("%s", profile.c_str());
+	}
+	catch (Exception& e)
+	{
+		fprintf (stderr, "%s\n", e.what ());
+		return -1;
+	}
+
+	return 0;
+}